@@ -8,11 +8,14 @@
 
 #include "ASTBinaryOperator.hpp"
 #include "ASTLiterals.hpp"
+#include "Analysis/ConstantEvaluator.hpp"
 #include "Analysis/FunctionAnalyser.hpp"
 #include "Compiler.hpp"
 #include "MemoryFlowAnalysis/MFFunctionAnalyser.hpp"
 #include "Types/TypeExpectation.hpp"
 #include "Types/ValueType.hpp"
+#include <cmath>
+#include <limits>
 
 namespace EmojicodeCompiler {
 
@@ -54,6 +57,11 @@ std::pair<bool, ASTBinaryOperator::BuiltIn> ASTBinaryOperator::builtInPrimitiveO
     auto type = btype.unboxed();
     if ((type.type() == TypeType::ValueType || type.type() == TypeType::Enum) &&
         type.valueType()->isPrimitive()) {
+        auto compiler = analyser->compiler();
+        if (type.valueType() == compiler->sRealVector || type.valueType() == compiler->sIntegerVector ||
+            type.valueType() == compiler->sByteVector) {
+            return builtInVectorOperator(analyser, type);
+        }
         if (type.valueType() == analyser->compiler()->sReal) {
             switch (operator_) {
                 case OperatorType::Multiplication:
@@ -91,9 +99,10 @@ std::pair<bool, ASTBinaryOperator::BuiltIn> ASTBinaryOperator::builtInPrimitiveO
             }
         }
         else if (type.valueType() == analyser->compiler()->sInteger ||
-                 type.valueType() == analyser->compiler()->sByte) {
+                 type.valueType() == analyser->compiler()->sByte || compiler->isUnsignedInteger(type.valueType())) {
             auto returnType = type.unboxed();
             returnType.setReference(false);
+            auto isUnsigned = compiler->isUnsignedInteger(type.valueType());
             switch (operator_) {
                 case OperatorType::Multiplication:
                     builtIn_ = BuiltInType::IntegerMultiply;
@@ -108,16 +117,16 @@ std::pair<bool, ASTBinaryOperator::BuiltIn> ASTBinaryOperator::builtInPrimitiveO
                     builtIn_ = BuiltInType::IntegerXor;
                     return std::make_pair(true, BuiltIn(returnType));
                 case OperatorType::Less:
-                    builtIn_ = BuiltInType::IntegerLess;
+                    builtIn_ = isUnsigned ? BuiltInType::UnsignedLess : BuiltInType::IntegerLess;
                     return std::make_pair(true, BuiltIn(analyser->boolean()));
                 case OperatorType::Greater:
-                    builtIn_ = BuiltInType::IntegerGreater;
+                    builtIn_ = isUnsigned ? BuiltInType::UnsignedGreater : BuiltInType::IntegerGreater;
                     return std::make_pair(true, BuiltIn(analyser->boolean()));
                 case OperatorType::LessOrEqual:
-                    builtIn_ = BuiltInType::IntegerLessOrEqual;
+                    builtIn_ = isUnsigned ? BuiltInType::UnsignedLessOrEqual : BuiltInType::IntegerLessOrEqual;
                     return std::make_pair(true, BuiltIn(analyser->boolean()));
                 case OperatorType::GreaterOrEqual:
-                    builtIn_ = BuiltInType::IntegerGreaterOrEqual;
+                    builtIn_ = isUnsigned ? BuiltInType::UnsignedGreaterOrEqual : BuiltInType::IntegerGreaterOrEqual;
                     return std::make_pair(true, BuiltIn(analyser->boolean()));
                 case OperatorType::ShiftLeft:
                     builtIn_ = BuiltInType::IntegerLeftShift;
@@ -126,7 +135,7 @@ std::pair<bool, ASTBinaryOperator::BuiltIn> ASTBinaryOperator::builtInPrimitiveO
                     builtIn_ = BuiltInType::IntegerRightShift;
                     return std::make_pair(true, BuiltIn(returnType));
                 case OperatorType::Division:
-                    builtIn_ = BuiltInType::IntegerDivide;
+                    builtIn_ = isUnsigned ? BuiltInType::UnsignedDivide : BuiltInType::IntegerDivide;
                     return std::make_pair(true, BuiltIn(returnType));
                 case OperatorType::Plus:
                     builtIn_ = BuiltInType::IntegerAdd;
@@ -135,7 +144,7 @@ std::pair<bool, ASTBinaryOperator::BuiltIn> ASTBinaryOperator::builtInPrimitiveO
                     builtIn_ = BuiltInType::IntegerSubstract;
                     return std::make_pair(true, BuiltIn(returnType));
                 case OperatorType::Remainder:
-                    builtIn_ = BuiltInType::IntegerRemainder;
+                    builtIn_ = isUnsigned ? BuiltInType::UnsignedRemainder : BuiltInType::IntegerRemainder;
                     return std::make_pair(true, BuiltIn(returnType));
                 default:
                     break;
@@ -174,14 +183,215 @@ std::pair<bool, ASTBinaryOperator::BuiltIn> ASTBinaryOperator::builtInPrimitiveO
     return std::make_pair(false, BuiltIn(Type::noReturn()));
 }
 
+std::pair<bool, ASTBinaryOperator::BuiltIn> ASTBinaryOperator::builtInVectorOperator(ExpressionAnalyser *analyser,
+                                                                                     const Type &type) {
+    auto real = type.valueType() == analyser->compiler()->sRealVector;
+    auto returnType = type.unboxed();
+    returnType.setReference(false);
+    // The same operations as on the lane types are generated, which LLVM applies to every lane of the vectors.
+    switch (operator_) {
+        case OperatorType::Plus:
+            builtIn_ = real ? BuiltInType::DoubleAdd : BuiltInType::IntegerAdd;
+            return std::make_pair(true, BuiltIn(returnType));
+        case OperatorType::Minus:
+            builtIn_ = real ? BuiltInType::DoubleSubstract : BuiltInType::IntegerSubstract;
+            return std::make_pair(true, BuiltIn(returnType));
+        case OperatorType::Multiplication:
+            builtIn_ = real ? BuiltInType::DoubleMultiply : BuiltInType::IntegerMultiply;
+            return std::make_pair(true, BuiltIn(returnType));
+        case OperatorType::Division:
+            builtIn_ = real ? BuiltInType::DoubleDivide : BuiltInType::IntegerDivide;
+            return std::make_pair(true, BuiltIn(returnType));
+        case OperatorType::Less:
+            builtIn_ = real ? BuiltInType::DoubleLess : BuiltInType::IntegerLess;
+            return std::make_pair(true, BuiltIn(returnType));
+        case OperatorType::Greater:
+            builtIn_ = real ? BuiltInType::DoubleGreater : BuiltInType::IntegerGreater;
+            return std::make_pair(true, BuiltIn(returnType));
+        case OperatorType::LessOrEqual:
+            builtIn_ = real ? BuiltInType::DoubleLessOrEqual : BuiltInType::IntegerLessOrEqual;
+            return std::make_pair(true, BuiltIn(returnType));
+        case OperatorType::GreaterOrEqual:
+            builtIn_ = real ? BuiltInType::DoubleGreaterOrEqual : BuiltInType::IntegerGreaterOrEqual;
+            return std::make_pair(true, BuiltIn(returnType));
+        case OperatorType::Equal:
+            builtIn_ = real ? BuiltInType::DoubleEqual : BuiltInType::Equal;
+            return std::make_pair(true, BuiltIn(analyser->boolean()));
+        case OperatorType::BitwiseAnd:
+            if (real) break;
+            builtIn_ = BuiltInType::IntegerAnd;
+            return std::make_pair(true, BuiltIn(returnType));
+        case OperatorType::BitwiseOr:
+            if (real) break;
+            builtIn_ = BuiltInType::IntegerOr;
+            return std::make_pair(true, BuiltIn(returnType));
+        case OperatorType::BitwiseXor:
+            if (real) break;
+            builtIn_ = BuiltInType::IntegerXor;
+            return std::make_pair(true, BuiltIn(returnType));
+        default:
+            break;
+    }
+    return std::make_pair(false, BuiltIn(Type::noReturn()));
+}
+
 void ASTBinaryOperator::analyseMemoryFlow(MFFunctionAnalyser *analyser, MFFlowCategory type) {
     if (builtIn_ != BuiltInType::None) {
         left_->analyseMemoryFlow(analyser, MFFlowCategory::Borrowing);
-        right_->analyseMemoryFlow(analyser, MFFlowCategory::Borrowing);
+        if (builtIn_ == BuiltInType::BooleanAnd || builtIn_ == BuiltInType::BooleanOr) {
+            // The right operand is only evaluated conditionally and must not move values out of variables.
+            analyser->enterBlock();
+            right_->analyseMemoryFlow(analyser, MFFlowCategory::Borrowing);
+            analyser->exitBlock();
+        }
+        else {
+            right_->analyseMemoryFlow(analyser, MFFlowCategory::Borrowing);
+        }
     }
     else {
         analyser->analyseFunctionCall(&args_, left_.get(), method_);
     }
 }
 
+bool ASTBinaryOperator::evaluate(ConstantEvaluator *evaluator, ConstantValue *value) const {
+    ConstantValue left, right;
+    if (builtIn_ == BuiltInType::None || !left_->evaluate(evaluator, &left)) {
+        return false;
+    }
+    if (builtIn_ == BuiltInType::BooleanAnd || builtIn_ == BuiltInType::BooleanOr) {
+        if (left.kind != ConstantValue::Kind::Boolean) {
+            return false;
+        }
+        if (left.boolean == (builtIn_ == BuiltInType::BooleanOr)) {
+            *value = left;
+            return true;
+        }
+        return right_->evaluate(evaluator, value) && value->kind == ConstantValue::Kind::Boolean;
+    }
+    if (!right_->evaluate(evaluator, &right) || left.kind != right.kind) {
+        return false;
+    }
+    switch (left.kind) {
+        case ConstantValue::Kind::Integer:
+        case ConstantValue::Kind::Byte:
+            return evaluateInteger(left, right, value);
+        case ConstantValue::Kind::Real:
+            return evaluateReal(left.real, right.real, value);
+        case ConstantValue::Kind::Boolean:
+            if (builtIn_ != BuiltInType::Equal) {
+                return false;
+            }
+            *value = ConstantValue(left.boolean == right.boolean);
+            return true;
+        case ConstantValue::Kind::String:
+            return false;
+    }
+}
+
+bool ASTBinaryOperator::evaluateInteger(const ConstantValue &left, const ConstantValue &right,
+                                        ConstantValue *value) const {
+    auto byte = left.kind == ConstantValue::Kind::Byte;
+    auto bits = byte ? 8 : 64;
+    auto min = byte ? std::numeric_limits<int8_t>::min() : std::numeric_limits<int64_t>::min();
+    auto l = static_cast<uint64_t>(left.integer), r = static_cast<uint64_t>(right.integer);
+    uint64_t result;
+    switch (builtIn_) {
+        case BuiltInType::IntegerAdd:
+            result = l + r;
+            break;
+        case BuiltInType::IntegerSubstract:
+            result = l - r;
+            break;
+        case BuiltInType::IntegerMultiply:
+            result = l * r;
+            break;
+        case BuiltInType::IntegerDivide:
+        case BuiltInType::IntegerRemainder:
+            if (right.integer == 0 || (left.integer == min && right.integer == -1)) {
+                return false;
+            }
+            result = builtIn_ == BuiltInType::IntegerDivide ? left.integer / right.integer
+                                                             : left.integer % right.integer;
+            break;
+        case BuiltInType::IntegerLeftShift:
+        case BuiltInType::IntegerRightShift:
+            if (right.integer < 0 || right.integer >= bits) {
+                return false;
+            }
+            if (builtIn_ == BuiltInType::IntegerLeftShift) {
+                result = l << r;
+            }
+            else {
+                result = (byte ? l & 0xFF : l) >> r;
+            }
+            break;
+        case BuiltInType::IntegerAnd:
+            result = l & r;
+            break;
+        case BuiltInType::IntegerOr:
+            result = l | r;
+            break;
+        case BuiltInType::IntegerXor:
+            result = l ^ r;
+            break;
+        case BuiltInType::IntegerLess:
+            *value = ConstantValue(left.integer < right.integer);
+            return true;
+        case BuiltInType::IntegerLessOrEqual:
+            *value = ConstantValue(left.integer <= right.integer);
+            return true;
+        case BuiltInType::IntegerGreater:
+            *value = ConstantValue(left.integer > right.integer);
+            return true;
+        case BuiltInType::IntegerGreaterOrEqual:
+            *value = ConstantValue(left.integer >= right.integer);
+            return true;
+        case BuiltInType::Equal:
+            *value = ConstantValue(left.integer == right.integer);
+            return true;
+        default:
+            return false;
+    }
+    *value = ConstantValue(left.kind, byte ? static_cast<int8_t>(result) : static_cast<int64_t>(result));
+    return true;
+}
+
+bool ASTBinaryOperator::evaluateReal(double left, double right, ConstantValue *value) const {
+    // The comparisons are unordered like the generated ones, i.e. they hold if an operand is NaN.
+    switch (builtIn_) {
+        case BuiltInType::DoubleAdd:
+            *value = ConstantValue(left + right);
+            return true;
+        case BuiltInType::DoubleSubstract:
+            *value = ConstantValue(left - right);
+            return true;
+        case BuiltInType::DoubleMultiply:
+            *value = ConstantValue(left * right);
+            return true;
+        case BuiltInType::DoubleDivide:
+            *value = ConstantValue(left / right);
+            return true;
+        case BuiltInType::DoubleRemainder:
+            *value = ConstantValue(std::fmod(left, right));
+            return true;
+        case BuiltInType::DoubleLess:
+            *value = ConstantValue(!(left >= right));
+            return true;
+        case BuiltInType::DoubleLessOrEqual:
+            *value = ConstantValue(!(left > right));
+            return true;
+        case BuiltInType::DoubleGreater:
+            *value = ConstantValue(!(left <= right));
+            return true;
+        case BuiltInType::DoubleGreaterOrEqual:
+            *value = ConstantValue(!(left < right));
+            return true;
+        case BuiltInType::DoubleEqual:
+            *value = ConstantValue(!(left < right) && !(left > right));
+            return true;
+        default:
+            return false;
+    }
+}
+
 }  // namespace EmojicodeCompiler
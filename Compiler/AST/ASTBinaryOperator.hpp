@@ -28,9 +28,14 @@ public:
     Value* generate(FunctionCodeGenerator *fg) const override;
     void toCode(PrettyStream &pretty) const override;
     void analyseMemoryFlow(MFFunctionAnalyser *analyser, MFFlowCategory type) override;
+    bool evaluate(ConstantEvaluator *evaluator, ConstantValue *value) const override;
     
 private:
     Value* generateLogical(FunctionCodeGenerator *fg) const;
+    /// Evaluates the built-in operator on two 🔢 or two 💧. Operations whose result is undefined, like division by zero,
+    /// are not evaluated.
+    bool evaluateInteger(const ConstantValue &left, const ConstantValue &right, ConstantValue *value) const;
+    bool evaluateReal(double left, double right, ConstantValue *value) const;
 
     struct BuiltIn {
         explicit BuiltIn(Type type) : returnType(std::move(type)) {}
@@ -38,6 +43,8 @@ private:
     };
 
     std::pair<bool, BuiltIn> builtInPrimitiveOperator(ExpressionAnalyser *analyser, const Type &type);
+    /// Lane-wise arithmetic and comparisons of the vector types. Comparisons result in masks of the operand type.
+    std::pair<bool, BuiltIn> builtInVectorOperator(ExpressionAnalyser *analyser, const Type &type);
     void printBinaryOperand(int precedence, const std::shared_ptr<ASTExpr> &expr, PrettyStream &pretty) const;
     Type analyseIsNoValue(ExpressionAnalyser *analyser, std::shared_ptr<ASTExpr> &expr,
                               BuiltInType builtInType);
@@ -12,6 +12,28 @@
 
 namespace EmojicodeCompiler {
 
+/// Returns *comparison* or, if the operands are vectors, a mask of the operand type whose lanes have all bits set
+/// where *comparison* holds.
+static llvm::Value* buildComparison(FunctionCodeGenerator *fg, llvm::Value *comparison, llvm::Type *operandType) {
+    if (!operandType->isVectorTy()) {
+        return comparison;
+    }
+    auto mask = fg->builder().CreateSExt(comparison,
+                                         llvm::VectorType::getInteger(llvm::cast<llvm::VectorType>(operandType)));
+    return fg->builder().CreateBitCast(mask, operandType);
+}
+
+/// Returns *comparison* or, if the operands are vectors, whether it holds for all lanes.
+static llvm::Value* buildEquality(FunctionCodeGenerator *fg, llvm::Value *comparison) {
+    auto type = llvm::dyn_cast<llvm::VectorType>(comparison->getType());
+    if (type == nullptr) {
+        return comparison;
+    }
+    auto bits = llvm::Type::getIntNTy(fg->ctx(), type->getNumElements());
+    return fg->builder().CreateICmpEQ(fg->builder().CreateBitCast(comparison, bits),
+                                      llvm::Constant::getAllOnesValue(bits));
+}
+
 Value* ASTBinaryOperator::generate(FunctionCodeGenerator *fg) const {
     if (BuiltInType::BooleanOr == builtIn_ || BuiltInType::BooleanAnd == builtIn_) {
         return generateLogical(fg);
@@ -32,15 +54,15 @@ Value* ASTBinaryOperator::generate(FunctionCodeGenerator *fg) const {
             case BuiltInType::DoubleMultiply:
                 return fg->builder().CreateFMul(left, right);
             case BuiltInType::DoubleLessOrEqual:
-                return fg->builder().CreateFCmpULE(left, right);
+                return buildComparison(fg, fg->builder().CreateFCmpULE(left, right), left->getType());
             case BuiltInType::DoubleLess:
-                return fg->builder().CreateFCmpULT(left, right);
+                return buildComparison(fg, fg->builder().CreateFCmpULT(left, right), left->getType());
             case BuiltInType::DoubleGreaterOrEqual:
-                return fg->builder().CreateFCmpUGE(left, right);
+                return buildComparison(fg, fg->builder().CreateFCmpUGE(left, right), left->getType());
             case BuiltInType::DoubleGreater:
-                return fg->builder().CreateFCmpUGT(left, right);
+                return buildComparison(fg, fg->builder().CreateFCmpUGT(left, right), left->getType());
             case BuiltInType::DoubleEqual:
-                return fg->builder().CreateFCmpUEQ(left, right);
+                return buildEquality(fg, fg->builder().CreateFCmpUEQ(left, right));
             case BuiltInType::IntegerAdd:
                 return fg->builder().CreateAdd(left, right);
             case BuiltInType::IntegerMultiply:
@@ -50,13 +72,13 @@ Value* ASTBinaryOperator::generate(FunctionCodeGenerator *fg) const {
             case BuiltInType::IntegerSubstract:
                 return fg->builder().CreateSub(left, right);
             case BuiltInType::IntegerLess:
-                return fg->builder().CreateICmpSLT(left, right);
+                return buildComparison(fg, fg->builder().CreateICmpSLT(left, right), left->getType());
             case BuiltInType::IntegerLessOrEqual:
-                return fg->builder().CreateICmpSLE(left, right);
+                return buildComparison(fg, fg->builder().CreateICmpSLE(left, right), left->getType());
             case BuiltInType::IntegerGreater:
-                return fg->builder().CreateICmpSGT(left, right);
+                return buildComparison(fg, fg->builder().CreateICmpSGT(left, right), left->getType());
             case BuiltInType::IntegerGreaterOrEqual:
-                return fg->builder().CreateICmpSGE(left, right);
+                return buildComparison(fg, fg->builder().CreateICmpSGE(left, right), left->getType());
             case BuiltInType::IntegerRightShift:
                 return fg->builder().CreateLShr(left, right);
             case BuiltInType::IntegerLeftShift:
@@ -69,8 +91,20 @@ Value* ASTBinaryOperator::generate(FunctionCodeGenerator *fg) const {
                 return fg->builder().CreateSRem(left, right);
             case BuiltInType::IntegerAnd:
                 return fg->builder().CreateAnd(left, right);
+            case BuiltInType::UnsignedDivide:
+                return fg->builder().CreateUDiv(left, right);
+            case BuiltInType::UnsignedRemainder:
+                return fg->builder().CreateURem(left, right);
+            case BuiltInType::UnsignedLess:
+                return fg->builder().CreateICmpULT(left, right);
+            case BuiltInType::UnsignedLessOrEqual:
+                return fg->builder().CreateICmpULE(left, right);
+            case BuiltInType::UnsignedGreater:
+                return fg->builder().CreateICmpUGT(left, right);
+            case BuiltInType::UnsignedGreaterOrEqual:
+                return fg->builder().CreateICmpUGE(left, right);
             case BuiltInType::Equal:
-                return fg->builder().CreateICmpEQ(left, right);
+                return buildEquality(fg, fg->builder().CreateICmpEQ(left, right));
             case BuiltInType::IsNoValueLeft:
                 return left_->expressionType().storageType() == StorageType::Box
                         ? fg->buildHasNoValueBox(left)
@@ -20,6 +20,10 @@ class ASTBoxing : public ASTUnaryMFForwarding {
 public:
     ASTBoxing(std::shared_ptr<ASTExpr> expr, const SourcePosition &p, const Type &exprType);
     Type analyse(ExpressionAnalyser *) final { return expressionType(); }
+    /// Boxing does not change the value, which is therefore evaluated by evaluating ::expr_.
+    bool evaluate(ConstantEvaluator *evaluator, ConstantValue *value) const override {
+        return expr_->evaluate(evaluator, value);
+    }
     
 protected:
     /// Gets a pointer to the value area of box and bit-casts it to the type matching the ASTExpr::expressionType()
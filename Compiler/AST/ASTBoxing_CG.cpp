@@ -129,6 +129,7 @@ Value* ASTSimpleOptionalToBox::generate(FunctionCodeGenerator *fg) const {
 Value* ASTToBox::buildStoreAddress(Value *box, FunctionCodeGenerator *fg) const {
     auto containedType = expr_->expressionType().unboxed().unoptionalized();
     if (fg->typeHelper().isRemote(containedType)) {
+        fg->generator()->noteHeapBoxing(containedType, position());
         auto containedTypeLlvm = fg->typeHelper().llvmTypeFor(containedType);
         auto mngType = fg->typeHelper().managable(containedTypeLlvm);
         auto ctPtrPtr = containedTypeLlvm->getPointerTo()->getPointerTo();
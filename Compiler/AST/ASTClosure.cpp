@@ -77,7 +77,7 @@ void ASTClosure::applyBoxingFromExpectation(ExpressionAnalyser *analyser, const
         if (returnType.storageType() != expReturn.storageType()) {
             switch (expReturn.storageType()) {
                 case StorageType::SimpleOptional:
-                case StorageType::PointerOptional:
+                case StorageType::NicheOptional:
                     assert(returnType.storageType() == StorageType::Simple);
                     closure_->setReturnType(std::make_unique<ASTLiteralType>(returnType.optionalized()));
                     break;
@@ -103,7 +103,7 @@ void ASTClosure::applyBoxingFromExpectation(ExpressionAnalyser *analyser, const
             if (paramType.storageType() != expParam.storageType()) {
                 switch (expParam.storageType()) {
                     case StorageType::SimpleOptional:
-                    case StorageType::PointerOptional:
+                    case StorageType::NicheOptional:
                         assert(paramType.storageType() == StorageType::Simple);
                         closure_->setParameterType(i, std::make_unique<ASTLiteralType>(paramType.optionalized()));
                         break;
@@ -39,7 +39,13 @@ Value* ASTClosure::generate(FunctionCodeGenerator *fg) const {
     auto i8ptr = fg->builder().CreateBitCast(closure_->unspecificReification().function,
                                              llvm::Type::getInt8PtrTy(fg->ctx()));
     auto callable = fg->builder().CreateInsertValue(llvm::UndefValue::get(fg->typeHelper().callable()), i8ptr, 0);
-    return handleResult(fg, fg->builder().CreateInsertValue(callable, alloc, 1));
+    callable = fg->builder().CreateInsertValue(callable, alloc, 1);
+    if (allocatesOnStack() && !isEscaping_) {
+        // The captured values were not retained and the capture dies with the stack frame, so there is nothing to
+        // release.
+        return callable;
+    }
+    return handleResult(fg, callable);
 }
 
 llvm::Value* ASTClosure::createDeinit(CodeGenerator *cg, const Capture &capture) const {
@@ -6,6 +6,7 @@
 //
 
 #include "ASTConditionalAssignment.hpp"
+#include "ASTVariables.hpp"
 #include "Generation/FunctionCodeGenerator.hpp"
 #include "CompilerError.hpp"
 #include "Analysis/ExpressionAnalyser.hpp"
@@ -37,6 +38,11 @@ Type ASTConditionalAssignment::analyse(ExpressionAnalyser *analyser) {
 
     t = t.optionalType();
 
+    if (auto get = dynamic_cast<ASTGetVariable *>(expr_.get())) {
+        auto var = analyser->scoper().getVariable(get->name(), position());
+        borrows_ = !var.inInstanceScope && var.variable.constant();
+    }
+
     auto &variable = analyser->scoper().currentScope().declareVariable(varName_, t, true, position());
     analyser->pathAnalyser().record(PathAnalyserIncident(false, variable.id()));
     varId_ = variable.id();
@@ -45,6 +51,12 @@ Type ASTConditionalAssignment::analyse(ExpressionAnalyser *analyser) {
 }
 
 void ASTConditionalAssignment::analyseMemoryFlow(MFFunctionAnalyser *analyser, MFFlowCategory type) {
+    if (borrows_) {
+        auto get = static_cast<ASTGetVariable *>(expr_.get());
+        expr_->analyseMemoryFlow(analyser, MFFlowCategory::Borrowing);
+        analyser->recordVariableBorrow(varId_, get->id(), expr_->expressionType().optionalType());
+        return;
+    }
     analyser->recordVariableSet(varId_, expr_.get(), expr_->expressionType().optionalType());
     analyser->take(expr_.get());
 }
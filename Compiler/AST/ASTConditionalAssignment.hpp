@@ -27,6 +27,9 @@ private:
     std::u32string varName_;
     std::shared_ptr<ASTExpr> expr_;
     VariableID varId_;
+    /// Whether the optional is a constant local variable, whose value the variable then borrows instead of retaining
+    /// it. The constant is not released before the variable goes out of scope and cannot change in the meantime.
+    bool borrows_ = false;
 };
 
 }
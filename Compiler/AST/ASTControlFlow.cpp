@@ -8,8 +8,13 @@
 
 #include "ASTControlFlow.hpp"
 #include "AST/ASTNode.hpp"
+#include "ASTBinaryOperator.hpp"
+#include "ASTInitialization.hpp"
+#include "ASTLiterals.hpp"
 #include "ASTMethod.hpp"
+#include "ASTUnsafeBlock.hpp"
 #include "ASTVariables.hpp"
+#include "Analysis/ConstantEvaluator.hpp"
 #include "Analysis/FunctionAnalyser.hpp"
 #include "Compiler.hpp"
 #include "Emojis.h"
@@ -18,6 +23,8 @@
 #include "Types/Class.hpp"
 #include "Types/Protocol.hpp"
 #include "Types/TypeExpectation.hpp"
+#include "Types/ValueType.hpp"
+#include <set>
 
 namespace EmojicodeCompiler {
 
@@ -29,6 +36,10 @@ void ASTIf::analyse(FunctionAnalyser *analyser) {
         blocks_[i].block.analyse(analyser);
         blocks_[i].block.popScope(analyser);
         analyser->pathAnalyser().endBranch();
+        // Raising an error is the exception, so the block is moved out of the hot path.
+        if (blocks_[i].speed == BranchSpeed::Unknown && dynamic_cast<ASTRaise *>(blocks_[i].block.getReturn())) {
+            blocks_[i].speed = BranchSpeed::Slow;
+        }
     }
 
     if (hasElse()) {
@@ -56,6 +67,114 @@ void ASTIf::analyseMemoryFlow(MFFunctionAnalyser *analyser) {
     }
 }
 
+/// Evaluates *condition* and stores the resulting 👌 in *holds*.
+static bool evaluateCondition(ConstantEvaluator *evaluator, const ASTExpr *condition, bool *holds) {
+    ConstantValue value;
+    if (!condition->evaluate(evaluator, &value) || value.kind != ConstantValue::Kind::Boolean) {
+        return false;
+    }
+    *holds = value.boolean;
+    return true;
+}
+
+bool ASTIf::evaluate(ConstantEvaluator *evaluator) const {
+    for (size_t i = 0; i < conditions_.size(); i++) {
+        bool holds;
+        if (!evaluateCondition(evaluator, conditions_[i].get(), &holds)) {
+            return false;
+        }
+        if (holds) {
+            return blocks_[i].block.evaluate(evaluator);
+        }
+    }
+    return !hasElse() || blocks_.back().block.evaluate(evaluator);
+}
+
+void ASTMatch::analyse(FunctionAnalyser *analyser) {
+    auto type = analyser->expect(TypeExpectation(false, false), &subject_);
+    auto compiler = analyser->compiler();
+    string_ = type.type() == TypeType::Class && type.klass() == compiler->sString;
+    auto integer = type.type() == TypeType::ValueType &&
+                   (type.valueType() == compiler->sInteger || type.valueType() == compiler->sByte);
+    if (type.storageType() != StorageType::Simple || !(string_ || integer || type.type() == TypeType::Enum)) {
+        throw CompilerError(position(), "🎚 can only be used with 🔢, 💧, 🔡 and enumerations but ",
+                            type.toString(analyser->typeContext()), " was provided.");
+    }
+
+    std::set<int64_t> integers;
+    std::set<std::u32string> strings;
+    for (auto &arm : cases_) {
+        for (auto &value : arm.values) {
+            analyser->expectType(type, &value);
+            auto constant = caseConstant(analyser, value);
+            if (string_ ? !strings.emplace(constant.string).second : !integers.emplace(constant.integer).second) {
+                throw CompilerError(value->position(), "Value is matched by another case already.");
+            }
+            arm.constants.emplace_back(std::move(constant));
+        }
+
+        analyser->pathAnalyser().beginBranch();
+        analyser->scoper().pushScope();
+        arm.block.analyse(analyser);
+        arm.block.popScope(analyser);
+        analyser->pathAnalyser().endBranch();
+    }
+
+    if (hasDefault()) {
+        analyser->pathAnalyser().beginBranch();
+        analyser->scoper().pushScope();
+        default_->analyse(analyser);
+        default_->popScope(analyser);
+        analyser->pathAnalyser().endBranch();
+
+        analyser->pathAnalyser().finishMutualExclusiveBranches();
+    }
+    else {
+        analyser->pathAnalyser().finishUncertainBranches();
+    }
+}
+
+ConstantValue ASTMatch::caseConstant(FunctionAnalyser *analyser, const std::shared_ptr<ASTExpr> &value) const {
+    if (auto init = std::dynamic_pointer_cast<ASTInitialization>(value)) {
+        if (init->initType() == ASTInitialization::InitType::Enum) {
+            return ConstantValue(ConstantValue::Kind::Integer, init->enumValue());
+        }
+    }
+    ConstantValue constant;
+    if (!ConstantEvaluator(analyser->compiler()).evaluate(value.get(), &constant) ||
+        (string_ != (constant.kind == ConstantValue::Kind::String))) {
+        throw CompilerError(value->position(), "The value of a 🎚 case must be a constant.");
+    }
+    return constant;
+}
+
+void ASTMatch::analyseMemoryFlow(MFFunctionAnalyser *analyser) {
+    subject_->analyseMemoryFlow(analyser, MFFlowCategory::Borrowing);
+    for (auto &arm : cases_) {
+        arm.block.analyseMemoryFlow(analyser);
+        analyser->popScope(&arm.block);
+    }
+    if (hasDefault()) {
+        default_->analyseMemoryFlow(analyser);
+        analyser->popScope(default_.get());
+    }
+}
+
+bool ASTMatch::evaluate(ConstantEvaluator *evaluator) const {
+    ConstantValue value;
+    if (!subject_->evaluate(evaluator, &value)) {
+        return false;
+    }
+    for (auto &arm : cases_) {
+        for (auto &constant : arm.constants) {
+            if (string_ ? constant.string == value.string : constant.integer == value.integer) {
+                return arm.block.evaluate(evaluator);
+            }
+        }
+    }
+    return !hasDefault() || default_->evaluate(evaluator);
+}
+
 void ASTRepeatWhile::analyse(FunctionAnalyser *analyser) {
     analyser->pathAnalyser().beginBranch();
     analyser->scoper().pushScope();
@@ -74,6 +193,24 @@ void ASTRepeatWhile::analyseMemoryFlow(MFFunctionAnalyser *analyser) {
     analyser->popScope(&block_);
 }
 
+bool ASTRepeatWhile::evaluate(ConstantEvaluator *evaluator) const {
+    while (true) {
+        bool holds;
+        if (!evaluator->step() || !evaluateCondition(evaluator, condition_.get(), &holds)) {
+            return false;
+        }
+        if (!holds) {
+            return true;
+        }
+        if (!block_.evaluate(evaluator)) {
+            return false;
+        }
+        if (evaluator->returned()) {
+            return true;
+        }
+    }
+}
+
 void ASTErrorHandler::analyse(FunctionAnalyser *analyser) {
     auto call = dynamic_cast<ASTCall *>(value_.get());
     if (call == nullptr) {
@@ -132,11 +269,42 @@ void ASTErrorHandler::analyseMemoryFlow(MFFunctionAnalyser *analyser) {
 void ASTForIn::analyse(FunctionAnalyser *analyser) {
     analyser->scoper().pushScope();
 
+    ASTBlock newBlock(position());
+    auto append = [analyser, &newBlock](std::unique_ptr<ASTStatement> node) {
+        node->analyse(analyser);
+        newBlock.appendNode(std::move(node));
+    };
+
+    auto iterateeVar = U"iteratee" + varName_;
+    append(std::make_unique<ASTConstantVariable>(iterateeVar, std::move(iteratee_), position()));
+    auto type = analyser->scoper().getVariable(iterateeVar, position()).variable.type();
+
+    if (type.type() == TypeType::ValueType && type.valueType() == analyser->compiler()->sDictionary) {
+        append(dictionaryLoop(iterateeVar));
+    }
+    else if (!valueVarName_.empty()) {
+        throw CompilerError(position(), "Only 🍯 can be iterated with a value variable.");
+    }
+    else if (type.type() == TypeType::ValueType && (type.valueType() == analyser->compiler()->sList ||
+                                                    type.valueType() == analyser->compiler()->sRange ||
+                                                    type.valueType() == analyser->compiler()->sSlice)) {
+        append(countedLoop(iterateeVar));
+    }
+    else {
+        append(iteratorLoop(iterateeVar));
+    }
+
+    block_ = std::move(newBlock);
+    block_.popScope(analyser);
+}
+
+std::unique_ptr<ASTStatement> ASTForIn::iteratorLoop(const std::u32string &iterateeVar) {
     ASTBlock newBlock(position());
 
     auto iteratorVar = U"iterator" + varName_;
 
-    auto getIterator = std::make_shared<ASTMethod>(std::u32string(1, E_DANGO), std::move(iteratee_),
+    auto getIterator = std::make_shared<ASTMethod>(std::u32string(1, E_DANGO),
+                                                   std::make_shared<ASTGetVariable>(iterateeVar, position()),
                                                    ASTArguments(position()), position());
     newBlock.appendNode(std::make_unique<ASTConstantVariable>(iteratorVar, getIterator, position()));
     auto getNext = std::make_shared<ASTMethod>(std::u32string(1, 0x1F53D),
@@ -148,9 +316,83 @@ void ASTForIn::analyse(FunctionAnalyser *analyser) {
                                                std::make_shared<ASTGetVariable>(iteratorVar, position()),
                                                ASTArguments(position(), Mood::Interogative), position());
     newBlock.appendNode(std::make_unique<ASTRepeatWhile>(hasNext, std::move(block_), position()));
-    block_ = std::move(newBlock);
-    block_.analyse(analyser);
-    block_.popScope(analyser);
+    return std::make_unique<ASTBlock>(std::move(newBlock));
+}
+
+std::unique_ptr<ASTStatement> ASTForIn::countedLoop(const std::u32string &iterateeVar) {
+    ASTBlock newBlock(position());
+
+    auto countVar = U"count" + varName_;
+    auto indexVar = U"index" + varName_;
+
+    auto getCount = std::make_shared<ASTMethod>(std::u32string(1, 0x1F4CF),
+                                                std::make_shared<ASTGetVariable>(iterateeVar, position()),
+                                                ASTArguments(position(), Mood::Interogative), position());
+    newBlock.appendNode(std::make_unique<ASTConstantVariable>(countVar, getCount, position()));
+    newBlock.appendNode(std::make_unique<ASTVariableDeclareAndAssign>(indexVar,
+            std::make_shared<ASTNumberLiteral>(static_cast<int64_t>(0), U"0", position()), position()));
+
+    // The index is always less than the count of the iteratee, which cannot change as the iteratee is a copy, so
+    // 🐽🔸🙈 can retrieve the element without checking the index again.
+    auto getElement = std::make_shared<ASTUnsafeExpr>(std::make_shared<ASTMethod>(U"🐽🔸🙈",
+            std::make_shared<ASTGetVariable>(iterateeVar, position()),
+            ASTArguments(position(), { std::make_shared<ASTGetVariable>(indexVar, position()) }), position()),
+                                                      position());
+    block_.prependNode(std::make_unique<ASTOperatorAssignment>(indexVar,
+            std::make_shared<ASTNumberLiteral>(static_cast<int64_t>(1), U"1", position()), position(),
+            OperatorType::Plus));
+    block_.prependNode(std::make_unique<ASTConstantVariable>(varName_, getElement, position()));
+
+    auto hasNext = std::make_shared<ASTBinaryOperator>(OperatorType::Less,
+                                                       std::make_shared<ASTGetVariable>(indexVar, position()),
+                                                       std::make_shared<ASTGetVariable>(countVar, position()),
+                                                       position());
+    newBlock.appendNode(std::make_unique<ASTRepeatWhile>(hasNext, std::move(block_), position()));
+    return std::make_unique<ASTBlock>(std::move(newBlock));
+}
+
+std::unique_ptr<ASTStatement> ASTForIn::dictionaryLoop(const std::u32string &iterateeVar) {
+    ASTBlock newBlock(position());
+
+    auto slotsVar = U"slots" + varName_;
+    auto indexVar = U"index" + varName_;
+
+    auto slotCall = [this, &iterateeVar, &indexVar](const char32_t *name) {
+        return std::make_shared<ASTUnsafeExpr>(std::make_shared<ASTMethod>(name,
+                std::make_shared<ASTGetVariable>(iterateeVar, position()),
+                ASTArguments(position(), { std::make_shared<ASTGetVariable>(indexVar, position()) }), position()),
+                                               position());
+    };
+
+    auto getSlots = std::make_shared<ASTUnsafeExpr>(std::make_shared<ASTMethod>(U"🐴🔸🙈",
+            std::make_shared<ASTGetVariable>(iterateeVar, position()),
+            ASTArguments(position(), Mood::Interogative), position()), position());
+    newBlock.appendNode(std::make_unique<ASTConstantVariable>(slotsVar, getSlots, position()));
+    newBlock.appendNode(std::make_unique<ASTVariableDeclareAndAssign>(indexVar,
+            std::make_shared<ASTNumberLiteral>(static_cast<int64_t>(0), U"0", position()), position()));
+
+    // The iteratee is a copy, so its slots cannot change and the index is always less than their number.
+    if (!valueVarName_.empty()) {
+        block_.prependNode(std::make_unique<ASTConstantVariable>(valueVarName_, slotCall(U"🐽🔸🙈"), position()));
+    }
+    block_.prependNode(std::make_unique<ASTConstantVariable>(varName_, slotCall(U"🔑🔸🙈"), position()));
+
+    auto ifOccupied = std::make_unique<ASTIf>(position());
+    ifOccupied->addCondition(slotCall(U"🈵🔸🙈"));
+    ifOccupied->addBlock(std::move(block_));
+
+    ASTBlock loopBlock(position());
+    loopBlock.appendNode(std::move(ifOccupied));
+    loopBlock.appendNode(std::make_unique<ASTOperatorAssignment>(indexVar,
+            std::make_shared<ASTNumberLiteral>(static_cast<int64_t>(1), U"1", position()), position(),
+            OperatorType::Plus));
+
+    auto hasNext = std::make_shared<ASTBinaryOperator>(OperatorType::Less,
+                                                       std::make_shared<ASTGetVariable>(indexVar, position()),
+                                                       std::make_shared<ASTGetVariable>(slotsVar, position()),
+                                                       position());
+    newBlock.appendNode(std::make_unique<ASTRepeatWhile>(hasNext, std::move(loopBlock), position()));
+    return std::make_unique<ASTBlock>(std::move(newBlock));
 }
 
 void ASTForIn::analyseMemoryFlow(MFFunctionAnalyser *analyser) {
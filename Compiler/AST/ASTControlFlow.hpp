@@ -11,8 +11,13 @@
 
 #include <utility>
 #include "ASTStatements.hpp"
+#include "Analysis/ConstantEvaluator.hpp"
 #include "Scoping/Variable.hpp"
 
+namespace llvm {
+class BasicBlock;
+}  // namespace llvm
+
 namespace EmojicodeCompiler {
 
 class ASTIf final : public ASTStatement {
@@ -32,6 +37,7 @@ public:
 
     void toCode(PrettyStream &pretty) const override;
     void analyseMemoryFlow(MFFunctionAnalyser *analyser) override;
+    bool evaluate(ConstantEvaluator *evaluator) const override;
 
     bool hasElse() const { return conditions_.size() < blocks_.size(); }
 private:
@@ -44,6 +50,51 @@ private:
     std::vector<Branch> blocks_;
 };
 
+/// A 🎚 statement, which executes the block of the case one of whose values equals the value of an expression.
+///
+/// The expression must be a 🔢, 💧, 🔡 or an enumeration value and the values of the cases must be constants. Matching
+/// 🔢, 💧 and enumerations is compiled to a `switch` instruction. Strings are dispatched on their length and the bytes
+/// at a few positions, which are chosen at compile time so that they distinguish all cases of the same length, and are
+/// then compared with the only candidate.
+class ASTMatch final : public ASTStatement {
+public:
+    ASTMatch(std::shared_ptr<ASTExpr> subject, const SourcePosition &p)
+        : ASTStatement(p), subject_(std::move(subject)) {}
+
+    void addCase(std::vector<std::shared_ptr<ASTExpr>> values, ASTBlock block) {
+        cases_.emplace_back(std::move(values), std::move(block));
+    }
+    void setDefault(ASTBlock block) { default_ = std::make_unique<ASTBlock>(std::move(block)); }
+    bool hasDefault() const { return default_ != nullptr; }
+
+    void analyse(FunctionAnalyser *) override;
+    void generate(FunctionCodeGenerator *) const override;
+
+    void toCode(PrettyStream &pretty) const override;
+    void analyseMemoryFlow(MFFunctionAnalyser *analyser) override;
+    bool evaluate(ConstantEvaluator *evaluator) const override;
+
+private:
+    struct Case {
+        Case(std::vector<std::shared_ptr<ASTExpr>> values, ASTBlock block)
+            : values(std::move(values)), block(std::move(block)) {}
+        std::vector<std::shared_ptr<ASTExpr>> values;
+        /// The values as determined during semantic analysis. Enumeration values are stored as integers.
+        std::vector<ConstantValue> constants;
+        ASTBlock block;
+    };
+
+    std::shared_ptr<ASTExpr> subject_;
+    std::vector<Case> cases_;
+    std::unique_ptr<ASTBlock> default_;
+    bool string_ = false;
+
+    /// Returns the constant value of *value*, which was analysed to be of the type of the subject.
+    ConstantValue caseConstant(FunctionAnalyser *analyser, const std::shared_ptr<ASTExpr> &value) const;
+    /// Returns the index of the case whose string equals the 🔡 *value* or the number of cases if there is none.
+    llvm::Value* matchString(FunctionCodeGenerator *fg, llvm::Value *value) const;
+};
+
 class ASTRepeatWhile final : public ASTStatement {
 public:
     ASTRepeatWhile(std::shared_ptr<ASTExpr> condition, ASTBlock block, const SourcePosition &p)
@@ -54,6 +105,7 @@ public:
 
     void toCode(PrettyStream &pretty) const override;
     void analyseMemoryFlow(MFFunctionAnalyser *analyser) override;
+    bool evaluate(ConstantEvaluator *evaluator) const override;
 
 protected:
     std::shared_ptr<ASTExpr> condition_;
@@ -66,6 +118,9 @@ public:
              const SourcePosition &p)
     : ASTStatement(p), iteratee_(std::move(iteratee)), block_(std::move(block)), varName_(std::move(varName)) {}
 
+    /// Makes the loop also bind the value of every entry of the 🍯 to a variable named *varName*.
+    void setValueVariable(std::u32string varName) { valueVarName_ = std::move(varName); }
+
     void analyse(FunctionAnalyser *) override;
     void generate(FunctionCodeGenerator *) const override;
 
@@ -76,6 +131,16 @@ private:
     std::shared_ptr<ASTExpr> iteratee_;
     ASTBlock block_;
     std::u32string varName_;
+    std::u32string valueVarName_;
+
+    /// Returns a loop that iterates over the value of the variable named *iterateeVar* using the 🍡 protocol.
+    std::unique_ptr<ASTStatement> iteratorLoop(const std::u32string &iterateeVar);
+    /// Returns a loop that counts from 0 to 📏 and retrieves every element with 🐽🔸🙈, which does not check the index.
+    /// Used for 🍨, 🍰 and ⏩, which would otherwise require an iterator object and a protocol call per element.
+    std::unique_ptr<ASTStatement> countedLoop(const std::u32string &iterateeVar);
+    /// Returns a loop that scans the slots of the store of a 🍯 and binds the key, and the value if requested, of
+    /// every occupied slot. Neither iterator objects nor optionals are created.
+    std::unique_ptr<ASTStatement> dictionaryLoop(const std::u32string &iterateeVar);
 };
 
 class ASTErrorHandler final : public ASTStatement, public ErrorHandling {
@@ -10,8 +10,15 @@
 #include "Compiler.hpp"
 #include "Generation/CallCodeGenerator.hpp"
 #include "Generation/FunctionCodeGenerator.hpp"
+#include "Generation/RunTimeHelper.hpp"
+#include "Generation/StringPool.hpp"
+#include "Types/Class.hpp"
+#include "Utils/StringUtils.hpp"
+#include <algorithm>
 #include <llvm/IR/Metadata.h>
 #include <llvm/IR/MDBuilder.h>
+#include <map>
+#include <set>
 
 namespace EmojicodeCompiler {
 
@@ -64,6 +71,189 @@ void ASTIf::generate(FunctionCodeGenerator *fg) const {
     }
 }
 
+void ASTMatch::generate(FunctionCodeGenerator *fg) const {
+    auto *function = fg->builder().GetInsertBlock()->getParent();
+
+    auto afterBlock = llvm::BasicBlock::Create(fg->ctx(), "afterMatch");
+    std::vector<llvm::BasicBlock *> blocks;
+    for (size_t i = 0; i < cases_.size(); i++) {
+        blocks.emplace_back(llvm::BasicBlock::Create(fg->ctx(), "case", function));
+    }
+    auto defaultBlock = hasDefault() ? llvm::BasicBlock::Create(fg->ctx(), "default", function) : afterBlock;
+
+    auto value = subject_->generate(fg);
+    if (string_) {
+        auto index = matchString(fg, value);
+        fg->releaseTemporaryObjects();
+        auto switchInst = fg->builder().CreateSwitch(index, defaultBlock, cases_.size());
+        for (size_t i = 0; i < cases_.size(); i++) {
+            switchInst->addCase(fg->int64(i), blocks[i]);
+        }
+    }
+    else {
+        fg->releaseTemporaryObjects();
+        auto type = llvm::cast<llvm::IntegerType>(value->getType());
+        auto switchInst = fg->builder().CreateSwitch(value, defaultBlock);
+        for (size_t i = 0; i < cases_.size(); i++) {
+            for (auto &constant : cases_[i].constants) {
+                switchInst->addCase(llvm::ConstantInt::get(type, constant.integer, true), blocks[i]);
+            }
+        }
+    }
+
+    bool addAfter = !hasDefault();
+    auto generateBlock = [&](const ASTBlock &block, llvm::BasicBlock *llvmBlock) {
+        fg->builder().SetInsertPoint(llvmBlock);
+        block.generate(fg);
+        if (!block.returnedCertainly()) {
+            fg->builder().CreateBr(afterBlock);
+            addAfter = true;
+        }
+    };
+    for (size_t i = 0; i < cases_.size(); i++) {
+        generateBlock(cases_[i].block, blocks[i]);
+    }
+    if (hasDefault()) {
+        generateBlock(*default_, defaultBlock);
+    }
+
+    if (addAfter) {
+        function->getBasicBlockList().push_back(afterBlock);
+        fg->builder().SetInsertPoint(afterBlock);
+    }
+}
+
+/// Selects up to eight byte positions at which the values of *strings*, which all have the same length, differ from
+/// each other so that the bytes at these positions identify each string. The positions are chosen greedily like gperf
+/// does.
+/// @returns False if no such positions were found.
+static bool distinguishingPositions(const std::vector<std::string> &strings, std::vector<size_t> *positions) {
+    auto length = strings.front().size();
+    auto keys = std::vector<uint64_t>(strings.size(), 0);
+    while (std::set<uint64_t>(keys.begin(), keys.end()).size() < strings.size()) {
+        if (positions->size() == 8) {
+            return false;
+        }
+        size_t bestPosition = 0, bestDistinct = 0;
+        for (size_t position = 0; position < length; position++) {
+            std::set<uint64_t> distinct;
+            for (size_t i = 0; i < strings.size(); i++) {
+                distinct.emplace(keys[i] | static_cast<uint64_t>(static_cast<uint8_t>(strings[i][position]))
+                                 << (8 * positions->size()));
+            }
+            if (distinct.size() > bestDistinct) {
+                bestDistinct = distinct.size();
+                bestPosition = position;
+            }
+        }
+        for (size_t i = 0; i < strings.size(); i++) {
+            keys[i] |= static_cast<uint64_t>(static_cast<uint8_t>(strings[i][bestPosition])) << (8 * positions->size());
+        }
+        positions->emplace_back(bestPosition);
+    }
+    return true;
+}
+
+llvm::Value* ASTMatch::matchString(FunctionCodeGenerator *fg, llvm::Value *value) const {
+    auto *function = fg->builder().GetInsertBlock()->getParent();
+    auto sString = fg->compiler()->sString;
+
+    auto loadInstanceVariable = [&](const std::u32string &name) {
+        auto &ivars = sString->instanceVariables();
+        auto it = std::find_if(ivars.begin(), ivars.end(), [&name](auto &ivar) { return ivar.name == name; });
+        auto type = llvm::cast<llvm::PointerType>(value->getType())->getElementType();
+        return fg->builder().CreateLoad(fg->builder().CreateConstInBoundsGEP2_32(type, value, 0,
+                                                                                 2 + (it - ivars.begin())));
+    };
+    auto count = loadInstanceVariable(U"count");
+    auto start = fg->builder().CreateAdd(loadInstanceVariable(U"start"),
+                                         fg->sizeOf(llvm::Type::getInt8PtrTy(fg->ctx())));
+    auto bytes = fg->builder().CreateInBoundsGEP(loadInstanceVariable(U"bytes"), start);
+
+    struct Candidate {
+        std::u32string string;
+        std::string bytes;
+        size_t index;
+    };
+    std::map<size_t, std::vector<Candidate>> byLength;
+    for (size_t i = 0; i < cases_.size(); i++) {
+        for (auto &constant : cases_[i].constants) {
+            auto bytes = utf8(constant.string);
+            byLength[bytes.size()].emplace_back(Candidate{ constant.string, bytes, i });
+        }
+    }
+
+    auto noMatch = llvm::BasicBlock::Create(fg->ctx(), "noMatch", function);
+    auto matched = llvm::BasicBlock::Create(fg->ctx(), "matched", function);
+    std::vector<std::pair<llvm::Value *, llvm::BasicBlock *>> incoming;
+    incoming.emplace_back(fg->int64(cases_.size()), noMatch);
+
+    // Compares the bytes of the subject with those of the candidate and continues with matched or *next*.
+    auto compare = [&](const Candidate &candidate, llvm::BasicBlock *next) {
+        incoming.emplace_back(fg->int64(candidate.index), fg->builder().GetInsertBlock());
+        if (candidate.bytes.empty()) {
+            fg->builder().CreateBr(matched);
+            return;
+        }
+        auto result = fg->builder().CreateCall(fg->generator()->runTime().memcmp(), {
+            bytes, fg->generator()->stringPool().poolBytes(candidate.string), fg->int64(candidate.bytes.size())
+        });
+        fg->builder().CreateCondBr(fg->builder().CreateICmpEQ(result, fg->builder().getInt32(0)), matched, next);
+    };
+
+    auto lengthSwitch = fg->builder().CreateSwitch(count, noMatch, byLength.size());
+    for (auto &pair : byLength) {
+        auto lengthBlock = llvm::BasicBlock::Create(fg->ctx(), "length", function);
+        lengthSwitch->addCase(fg->int64(pair.first), lengthBlock);
+        fg->builder().SetInsertPoint(lengthBlock);
+
+        auto &candidates = pair.second;
+        std::vector<std::string> strings;
+        for (auto &candidate : candidates) {
+            strings.emplace_back(candidate.bytes);
+        }
+        std::vector<size_t> positions;
+        if (candidates.size() > 1 && distinguishingPositions(strings, &positions)) {
+            llvm::Value *key = fg->int64(0);
+            for (size_t j = 0; j < positions.size(); j++) {
+                auto byte = fg->builder().CreateLoad(fg->builder().CreateConstInBoundsGEP1_64(bytes, positions[j]));
+                auto shifted = fg->builder().CreateShl(fg->builder().CreateZExt(byte, fg->builder().getInt64Ty()),
+                                                       8 * j);
+                key = fg->builder().CreateOr(key, shifted);
+            }
+            auto keySwitch = fg->builder().CreateSwitch(key, noMatch, candidates.size());
+            for (auto &candidate : candidates) {
+                uint64_t candidateKey = 0;
+                for (size_t j = 0; j < positions.size(); j++) {
+                    candidateKey |= static_cast<uint64_t>(static_cast<uint8_t>(candidate.bytes[positions[j]]))
+                                    << (8 * j);
+                }
+                auto candidateBlock = llvm::BasicBlock::Create(fg->ctx(), "candidate", function);
+                keySwitch->addCase(fg->int64(candidateKey), candidateBlock);
+                fg->builder().SetInsertPoint(candidateBlock);
+                compare(candidate, noMatch);
+            }
+            continue;
+        }
+
+        for (size_t i = 0; i < candidates.size(); i++) {
+            auto next = i + 1 < candidates.size() ? llvm::BasicBlock::Create(fg->ctx(), "next", function) : noMatch;
+            compare(candidates[i], next);
+            fg->builder().SetInsertPoint(next);
+        }
+    }
+
+    fg->builder().SetInsertPoint(noMatch);
+    fg->builder().CreateBr(matched);
+
+    fg->builder().SetInsertPoint(matched);
+    auto phi = fg->builder().CreatePHI(fg->builder().getInt64Ty(), incoming.size());
+    for (auto &pair : incoming) {
+        phi->addIncoming(pair.first, pair.second);
+    }
+    return phi;
+}
+
 void ASTRepeatWhile::generate(FunctionCodeGenerator *fg) const {
     auto *function = fg->builder().GetInsertBlock()->getParent();
 
@@ -100,7 +290,8 @@ void ASTErrorHandler::generate(FunctionCodeGenerator *fg) const {
     auto value = value_->generate(fg);
     auto tom = fg->takeTemporaryObjectsManager();
 
-    fg->builder().CreateCondBr(isError(fg, errorDest), errorBlock, noError);
+    fg->builder().CreateCondBr(isError(fg, errorDest), errorBlock, noError,
+                               llvm::MDBuilder(fg->ctx()).createBranchWeights(1, 99));
 
     fg->builder().SetInsertPoint(errorBlock);
     tom.releaseTemporaryObjects(fg, false, value_->producesTemporaryObject());
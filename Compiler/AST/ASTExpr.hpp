@@ -32,6 +32,8 @@ class MFFunctionAnalyser;
 class ASTCall;
 class ASTType;
 class ASTReturn;
+class ConstantEvaluator;
+struct ConstantValue;
 
 /// The superclass of all syntax tree nodes representing an expression.
 ///
@@ -54,6 +56,12 @@ public:
     virtual Value* generate(FunctionCodeGenerator *fg) const = 0;
     virtual void analyseMemoryFlow(MFFunctionAnalyser *analyser, MFFlowCategory type) = 0;
 
+    /// Evaluates the expression at compile time. Subclasses whose value can be computed without side effects
+    /// override this method. ASTExpr’s implementation returns false.
+    /// @returns True and sets *value* if the expression was evaluated, false if it is not constant.
+    /// @pre Call only after Memory Flow Analysis.
+    virtual bool evaluate(ConstantEvaluator *evaluator, ConstantValue *value) const { return false; }
+
     /// Informs this expression that if it creates a temporary object the object must not be released after the
     /// statement is executed. This method is called by MFFunctionAnalyser.
     void unsetIsTemporary() { isTemporary_ = false; unsetIsTemporaryPost(); }
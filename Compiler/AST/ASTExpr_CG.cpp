@@ -63,10 +63,14 @@ Value* ASTCallableCall::generate(FunctionCodeGenerator *fg) const {
     for (auto &arg : args_.args()) {
         args.emplace_back(arg->generate(fg));
     }
-    if (isErrorProne()) {
-        args.emplace_back(errorPointer());
+    if (!isErrorProne()) {
+        return handleResult(fg, fg->builder().CreateCall(functionType, function, args));
     }
-    return handleResult(fg, fg->builder().CreateCall(functionType, function, args));
+    // Callables always call closures, which take their error pointer as swifterror.
+    args.emplace_back(fg->errorPointerArgument(errorPointer(), true));
+    auto call = fg->builder().CreateCall(functionType, function, args);
+    call->addParamAttr(args.size() - 1, llvm::Attribute::SwiftError);
+    return handleResult(fg, call);
 }
 
 }  // namespace EmojicodeCompiler
@@ -63,6 +63,10 @@ bool ASTInitialization::isErrorProne() const {
     return initializer_->errorProne();
 }
 
+long ASTInitialization::enumValue() const {
+    return typeExpr_->expressionType().enumeration()->getValueFor(name_).second;
+}
+
 Type ASTInitialization::analyseEnumInit(ExpressionAnalyser *analyser, Type &type) {
     initType_ = InitType::Enum;
 
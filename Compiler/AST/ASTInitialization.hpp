@@ -42,6 +42,9 @@ public:
     void setDestination(llvm::Value *dest) { vtDestination_ = dest; }
     /// Returns the type of type which is initialized.
     InitType initType() { return initType_; }
+    /// Returns the value of the enumeration case that is initialized.
+    /// @pre initType() must return InitType::Enum.
+    long enumValue() const;
 
     void allocateOnStack() override;
 
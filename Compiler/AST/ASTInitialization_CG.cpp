@@ -24,8 +24,7 @@ Value* ASTInitialization::generate(FunctionCodeGenerator *fg) const {
         case InitType::ClassStack:
             return generateClassInit(fg);
         case InitType::Enum:
-            return llvm::ConstantInt::get(llvm::Type::getInt64Ty(fg->ctx()),
-                                          typeExpr_->expressionType().enumeration()->getValueFor(name_).second);
+            return llvm::ConstantInt::get(llvm::Type::getInt64Ty(fg->ctx()), enumValue());
         case InitType::ValueType:
             return generateInitValueType(fg);
         case InitType::MemoryAllocation:
@@ -79,7 +78,18 @@ Value* ASTInitialization::initObject(FunctionCodeGenerator *fg, const ASTArgumen
                                      const Type &type, llvm::Value *errorPointer, bool stackInit,
                                      llvm::Value *gArgsDescs) {
     auto llvmType = llvm::dyn_cast<llvm::PointerType>(fg->typeHelper().llvmTypeFor(type));
-    auto obj = stackInit ? fg->stackAlloc(llvmType) : fg->alloc(llvmType);
+    llvm::Value *obj;
+    if (stackInit) {
+        obj = fg->stackAlloc(llvmType);
+    }
+    else if (type.klass()->pooled()) {
+        auto alloc = fg->builder().CreateCall(fg->generator()->runTime().poolAlloc(), type.klass()->classInfo(),
+                                              "alloc");
+        obj = fg->builder().CreateBitCast(alloc, llvmType);
+    }
+    else {
+        obj = fg->alloc(llvmType);
+    }
     fg->builder().CreateStore(type.klass()->classInfo(), fg->buildGetClassInfoPtrFromObject(obj));
     auto suppl = gArgsDescs != nullptr ? std::vector<llvm::Value*> { gArgsDescs } : std::vector<llvm::Value*>();
     return CallCodeGenerator(fg, CallType::StaticDispatch).generate(obj, type, args, function, errorPointer, suppl);
@@ -12,6 +12,7 @@
 #include "Generation/CallCodeGenerator.hpp"
 #include "ASTInitialization.hpp"
 #include "ASTLiterals.hpp"
+#include "Analysis/ConstantEvaluator.hpp"
 #include "Analysis/FunctionAnalyser.hpp"
 #include "Analysis/SemanticAnalyser.hpp"
 #include "Compiler.hpp"
@@ -32,14 +33,29 @@ Type ASTStringLiteral::analyse(ExpressionAnalyser *analyser) {
     return type;
 }
 
+bool ASTStringLiteral::evaluate(ConstantEvaluator *evaluator, ConstantValue *value) const {
+    *value = ConstantValue(value_);
+    return true;
+}
+
 Type ASTBooleanTrue::analyse(ExpressionAnalyser *analyser) {
     return analyser->boolean();
 }
 
+bool ASTBooleanTrue::evaluate(ConstantEvaluator *evaluator, ConstantValue *value) const {
+    *value = ConstantValue(true);
+    return true;
+}
+
 Type ASTBooleanFalse::analyse(ExpressionAnalyser *analyser) {
     return analyser->boolean();
 }
 
+bool ASTBooleanFalse::evaluate(ConstantEvaluator *evaluator, ConstantValue *value) const {
+    *value = ConstantValue(false);
+    return true;
+}
+
 Type ASTNumberLiteral::analyse(ExpressionAnalyser *analyser) {
     if (type_ == NumberType::Integer) {
         return Type::integerLiteral();
@@ -64,9 +80,35 @@ Type ASTNumberLiteral::comply(ExpressionAnalyser *analyser, const TypeExpectatio
         type_ = NumberType::Byte;
         return analyser->byte();
     }
+    auto compiler = analyser->compiler();
+    if (expectation.type() == TypeType::ValueType && compiler->isUnsignedInteger(expectation.valueType())) {
+        auto type = expectation.valueType();
+        width_ = type == compiler->sUInt8 ? 8 : type == compiler->sUInt16 ? 16 : 32;
+        if (integerValue_ < 0 || integerValue_ >> width_ != 0) {
+            compiler->warn(position(), "Literal does not fit into ", width_, "-bit unsigned integer type.");
+        }
+        type_ = NumberType::Unsigned;
+        return Type(type);
+    }
     return analyser->integer();
 }
 
+bool ASTNumberLiteral::evaluate(ConstantEvaluator *evaluator, ConstantValue *value) const {
+    switch (type_) {
+        case NumberType::Integer:
+            *value = ConstantValue(ConstantValue::Kind::Integer, integerValue_);
+            return true;
+        case NumberType::Byte:
+            *value = ConstantValue(ConstantValue::Kind::Byte, static_cast<int8_t>(integerValue_));
+            return true;
+        case NumberType::Double:
+            *value = ConstantValue(doubleValue_);
+            return true;
+        case NumberType::Unsigned:
+            return false;
+    }
+}
+
 Type ASTThis::analyse(ExpressionAnalyser *analyser) {
     analyser->checkThisUse(position());
 
@@ -169,20 +211,29 @@ Type ASTCollectionLiteral::comply(ExpressionAnalyser *analyser, const TypeExpect
             { analyser->compiler()->sMemory->type(), analyser->integer() }, type_, analyser->typeContext(),
             analyser->semanticAnalyser());
     initializer_->createUnspecificReification();
+
+    if (type_.typeDefinition() == analyser->compiler()->sList) {
+        storageType_ = type_.typeDefinition()->instanceVariables().front().type->type().resolveOn(TypeContext(type_));
+        storageInitializer_ = type_.typeDefinition()->inits().lookup(U"🥫", Mood::Imperative, { storageType_ },
+                                                                     type_, analyser->typeContext(),
+                                                                     analyser->semanticAnalyser());
+        if (storageInitializer_ != nullptr) {
+            storageInitializer_->createUnspecificReification();
+        }
+    }
     return type_;
 }
 
 Type ASTInterpolationLiteral::analyse(ExpressionAnalyser *analyser) {
-    Type sb = analyser->package()->getRawType(TypeIdentifier(U"🔠", kDefaultNamespace, position()));
-    init_ = sb.typeDefinition()->inits().lookup(U"🆕", Mood::Imperative, { Type(analyser->compiler()->sInteger) },
-                                                Type(sb), analyser->typeContext(), analyser->semanticAnalyser());
-
-    append_ = sb.typeDefinition()->methods().lookup(U"🐻", Mood::Imperative,
-                                                    {Type(analyser->compiler()->sString)}, Type(sb),
-                                                    analyser->typeContext(), analyser->semanticAnalyser());
-
-    get_ = sb.typeDefinition()->methods().lookup(U"🔡", Mood::Imperative, {}, Type(sb),
-                                                 analyser->typeContext(), analyser->semanticAnalyser());
+    auto string = Type(analyser->compiler()->sString);
+    init_ = string.typeDefinition()->inits().lookup(U"🍪", Mood::Imperative,
+                                                    { analyser->compiler()->sMemory->type(), analyser->integer() },
+                                                    string, analyser->typeContext(), analyser->semanticAnalyser());
+    size_ = string.typeDefinition()->methods().lookup(U"📐", Mood::Imperative, {}, string, analyser->typeContext(),
+                                                      analyser->semanticAnalyser());
+    copy_ = string.typeDefinition()->methods().lookup(U"🚚", Mood::Imperative,
+                                                      { analyser->compiler()->sMemory->type(), analyser->integer() },
+                                                      string, analyser->typeContext(), analyser->semanticAnalyser());
 
     auto magnet = Type(analyser->compiler()->sInterpolateable).applyMinimalBoxing().referenced();
     toString_ = magnet.typeDefinition()->methods().lookup(U"🔡", Mood::Imperative, {}, magnet,
@@ -200,4 +251,28 @@ void ASTInterpolationLiteral::analyseMemoryFlow(MFFunctionAnalyser *analyser, MF
     }
 }
 
+bool ASTInterpolationLiteral::evaluate(ConstantEvaluator *evaluator, ConstantValue *value) const {
+    auto literalsIt = literals_.begin();
+    std::u32string string = *literalsIt++;
+    for (auto &valueNode : values_) {
+        ConstantValue part;
+        if (!valueNode->evaluate(evaluator, &part)) {
+            return false;
+        }
+        if (part.kind == ConstantValue::Kind::String) {
+            string.append(part.string);
+        }
+        else if (part.kind == ConstantValue::Kind::Integer) {
+            auto digits = std::to_string(part.integer);
+            string.append(digits.begin(), digits.end());
+        }
+        else {
+            return false;
+        }
+        string.append(*literalsIt++);
+    }
+    *value = ConstantValue(std::move(string));
+    return true;
+}
+
 }  // namespace EmojicodeCompiler
@@ -13,6 +13,10 @@
 #include <utility>
 #include <llvm/IR/Type.h>
 
+namespace llvm {
+class Constant;
+}  // namespace llvm
+
 namespace EmojicodeCompiler {
 
 class FunctionAnalyser;
@@ -23,6 +27,7 @@ public:
     ASTStringLiteral(std::u32string value, const SourcePosition &p) : ASTExpr(p), value_(std::move(value)) {}
     Type analyse(ExpressionAnalyser *analyser) override;
     Value* generate(FunctionCodeGenerator *fg) const override;
+    bool evaluate(ConstantEvaluator *evaluator, ConstantValue *value) const override;
 
     void toCode(PrettyStream &pretty) const override;
     void analyseMemoryFlow(MFFunctionAnalyser *analyser, MFFlowCategory type) override {}
@@ -49,6 +54,7 @@ public:
     Type analyse(ExpressionAnalyser *analyser) override;
     explicit ASTBooleanFalse(const SourcePosition &p) : ASTExpr(p) {}
     Value* generate(FunctionCodeGenerator *fg) const override;
+    bool evaluate(ConstantEvaluator *evaluator, ConstantValue *value) const override;
 
     void toCode(PrettyStream &pretty) const override;
     void analyseMemoryFlow(MFFunctionAnalyser *, MFFlowCategory) override {}
@@ -59,6 +65,7 @@ public:
     Type analyse(ExpressionAnalyser *analyser) override;
     explicit ASTBooleanTrue(const SourcePosition &p) : ASTExpr(p) {}
     Value* generate(FunctionCodeGenerator *fg) const override;
+    bool evaluate(ConstantEvaluator *evaluator, ConstantValue *value) const override;
 
     void toCode(PrettyStream &pretty) const override;
     void analyseMemoryFlow(MFFunctionAnalyser *, MFFlowCategory) override {}
@@ -74,19 +81,22 @@ public:
     Type analyse(ExpressionAnalyser *analyser) override;
     Value* generate(FunctionCodeGenerator *fg) const override;
     Type comply(ExpressionAnalyser *analyser, const TypeExpectation &expectation) override;
+    bool evaluate(ConstantEvaluator *evaluator, ConstantValue *value) const override;
 
     void toCode(PrettyStream &pretty) const override;
     void analyseMemoryFlow(MFFunctionAnalyser *, MFFlowCategory) override {}
 
 private:
     enum class NumberType {
-        Double, Integer, Byte
+        Double, Integer, Byte, Unsigned
     };
 
     std::u32string string_;
     double doubleValue_ = 0;
     int64_t integerValue_ = 0;
     NumberType type_;
+    /// The number of bits of the unsigned integer type if type_ is NumberType::Unsigned.
+    unsigned int width_ = 0;
 };
 
 class ASTCollectionLiteral : public ASTExpr {
@@ -111,11 +121,22 @@ protected:
     std::vector<std::shared_ptr<ASTExpr>> values_;
     Type type_ = Type::noReturn();
     Initializer *initializer_ = nullptr;
-    Value *init(FunctionCodeGenerator *fg, std::vector<llvm::Value *> args) const;
+    /// The ▶️🥫 initializer of 🍨, which adopts a constant storage, or nullptr if the literal is no list literal.
+    Initializer *storageInitializer_ = nullptr;
+    /// The type of the storage that is passed to storageInitializer_.
+    Type storageType_ = Type::noReturn();
+    Value *init(FunctionCodeGenerator *fg, Initializer *initializer, std::vector<llvm::Value *> args) const;
     bool pairs_ = false;
     std::unique_ptr<CommonTypeFinder> finder_;
     Value* generatePairs(FunctionCodeGenerator *fg) const;
     Type complyPairs(ExpressionAnalyser *analyser, const TypeExpectation &expectation);
+    /// Evaluates the values with ConstantEvaluator and returns a constant memory area laid out like the one of
+    /// prepareValueArray() that contains them, or nullptr if not all values are constant. The values from index
+    /// *first* on are taken, skipping *stride* - 1 values after each, and are stored as boxes if *boxes* is true.
+    llvm::Constant* constantValueArray(FunctionCodeGenerator *fg, size_t first, size_t stride, bool boxes) const;
+    /// Returns a constant instance of storageType_ that holds the *items* returned by constantValueArray(). The
+    /// instance is not reference counted, so that the list copies it when it is mutated the first time.
+    llvm::Constant* constantStorage(FunctionCodeGenerator *fg, llvm::Constant *items) const;
 };
 
 class ASTInterpolationLiteral final : public ASTExpr {
@@ -125,6 +146,8 @@ public:
     void addLiteral(const std::u32string &literal) { literals_.emplace_back(literal); }
     void addValue(const std::shared_ptr<ASTExpr> &value) { values_.emplace_back(value); }
     Value* generate(FunctionCodeGenerator *fg) const override;
+    /// Evaluates the literal if all values are constant 🔡 or 🔢.
+    bool evaluate(ConstantEvaluator *evaluator, ConstantValue *value) const override;
 
     void toCode(PrettyStream &pretty) const override;
     void analyseMemoryFlow(MFFunctionAnalyser *, MFFlowCategory) override;
@@ -132,12 +155,15 @@ public:
 private:
     std::vector<std::shared_ptr<ASTExpr>> values_;
     std::vector<std::u32string> literals_;
+    /// The initializer of 🔡 that takes ownership of a memory area.
     Initializer *init_ = nullptr;
-    Function *append_ = nullptr;
-    Function *get_ = nullptr;
+    Function *size_ = nullptr;
+    Function *copy_ = nullptr;
     Function *toString_ = nullptr;
-    void append(FunctionCodeGenerator *fg, llvm::Value *value, llvm::Value *builder) const;
-    void append(FunctionCodeGenerator *fg, const std::u32string &literal, llvm::Value *builder) const;
+    /// Copies the UTF-8 bytes of the literal from the string pool to `memory` at `offset`.
+    /// @returns The offset after the copied bytes.
+    llvm::Value* copy(FunctionCodeGenerator *fg, const std::u32string &literal, llvm::Value *memory,
+                      llvm::Value *offset) const;
 };
 
 class ASTThis : public ASTExpr {
@@ -9,6 +9,7 @@
 #include <utility>
 #include "ASTInitialization.hpp"
 #include "ASTLiterals.hpp"
+#include "Analysis/ConstantEvaluator.hpp"
 #include "Generation/TypeDescriptionGenerator.hpp"
 #include "Compiler.hpp"
 #include "Generation/CallCodeGenerator.hpp"
@@ -16,6 +17,7 @@
 #include "Generation/FunctionCodeGenerator.hpp"
 #include "Generation/StringPool.hpp"
 #include "Types/Class.hpp"
+#include "Utils/StringUtils.hpp"
 
 namespace EmojicodeCompiler {
 
@@ -39,6 +41,8 @@ Value* ASTNumberLiteral::generate(FunctionCodeGenerator *fg) const {
     switch (type_) {
         case NumberType::Byte:
             return fg->int8(integerValue_);
+        case NumberType::Unsigned:
+            return llvm::ConstantInt::get(llvm::Type::getIntNTy(fg->ctx(), width_), integerValue_);
         case NumberType::Integer:
             return fg->int64(integerValue_);
         case NumberType::Double:
@@ -61,12 +65,13 @@ Value* ASTNoValue::generate(FunctionCodeGenerator *fg) const {
     return fg->buildSimpleOptionalWithoutValue(type_);
 }
 
-Value* ASTCollectionLiteral::init(FunctionCodeGenerator *fg, std::vector<llvm::Value*> args) const {
+Value* ASTCollectionLiteral::init(FunctionCodeGenerator *fg, Initializer *initializer,
+                                  std::vector<llvm::Value*> args) const {
     auto td = TypeDescriptionGenerator(fg, TypeDescriptionUser::ValueTypeOrValue).generate(type_.genericArguments());
     auto value = fg->createEntryAlloca(fg->typeHelper().llvmTypeFor(type_));
     args.emplace_back(td);
     CallCodeGenerator(fg, CallType::StaticDispatch).generate(value, type_, ASTArguments(position()),
-                                                             initializer_, nullptr, args);
+                                                             initializer, nullptr, args);
     handleResult(fg, nullptr, value);
     return fg->builder().CreateLoad(value);
 }
@@ -85,19 +90,89 @@ std::pair<llvm::Value *, llvm::Value *> EmojicodeCompiler::ASTCollectionLiteral:
 }
 
 
+llvm::Constant* ASTCollectionLiteral::constantValueArray(FunctionCodeGenerator *fg, size_t first, size_t stride,
+                                                        bool boxes) const {
+    if (values_.empty()) {
+        return nullptr;
+    }
+    auto generator = fg->generator();
+    std::vector<llvm::Constant *> elements { generator->runTime().ignoreBlockPtr() };
+    for (size_t i = first; i < values_.size(); i += stride) {
+        auto &type = values_[i]->expressionType();
+        ConstantValue value;
+        if (!ConstantEvaluator(fg->compiler()).evaluate(values_[i].get(), &value)) {
+            return nullptr;
+        }
+        if (!boxes) {
+            elements.emplace_back(generator->constantFor(value, type));
+        }
+        else if (type.type() == TypeType::Box && type.boxedFor().type() != TypeType::Protocol &&
+                 type.boxedFor().type() != TypeType::MultiProtocol &&
+                 generator->constantFor(value, type.unboxed()) != nullptr) {
+            elements.emplace_back(generator->constantBox(value));
+        }
+        else {
+            return nullptr;
+        }
+        if (elements.back() == nullptr) {
+            return nullptr;
+        }
+    }
+    auto area = generator->constantVariable(llvm::ConstantStruct::getAnon(elements));
+    return llvm::ConstantExpr::getBitCast(area, fg->builder().getInt8PtrTy());
+}
+
+llvm::Constant* ASTCollectionLiteral::constantStorage(FunctionCodeGenerator *fg, llvm::Constant *items) const {
+    auto klass = storageType_.klass();
+    if (klass->storesGenericArgs() || klass->classInfo() == nullptr) {
+        return nullptr;
+    }
+    auto structType = llvm::cast<llvm::StructType>(
+            llvm::cast<llvm::PointerType>(fg->typeHelper().llvmTypeFor(storageType_))->getElementType());
+    std::vector<llvm::Constant *> fields { fg->generator()->runTime().ignoreBlockPtr(), klass->classInfo() };
+    for (auto &ivar : klass->instanceVariables()) {
+        auto type = structType->getElementType(fields.size());
+        if (ivar.name == U"data") {
+            fields.emplace_back(llvm::ConstantExpr::getBitCast(items, type));
+        }
+        else if (ivar.name == U"count" || ivar.name == U"size") {
+            fields.emplace_back(llvm::ConstantInt::get(type, values_.size()));
+        }
+        else {
+            fields.emplace_back(llvm::Constant::getNullValue(type));
+        }
+    }
+    return fg->generator()->constantVariable(llvm::ConstantStruct::get(structType, fields));
+}
+
 Value* ASTCollectionLiteral::generate(FunctionCodeGenerator *fg) const {
     if (pairs_) return generatePairs(fg);
+    // The storage of a literal whose values are all constant is emitted as constant, so that creating the list
+    // allocates nothing. Lists without such storage copy the constant items instead of building them on the stack.
+    if (auto items = constantValueArray(fg, 0, 1, true)) {
+        if (storageInitializer_ != nullptr) {
+            if (auto storage = constantStorage(fg, items)) {
+                return init(fg, storageInitializer_, { storage });
+            }
+        }
+        return init(fg, initializer_, { items, fg->int64(values_.size()) });
+    }
     llvm::Value *current, *structure;
     std::tie(current, structure) = prepareValueArray(fg, fg->typeHelper().box(), values_.size(), "items");
     for (auto &value : values_) {
         fg->builder().CreateStore(value->generate(fg), current);
         current = fg->builder().CreateConstInBoundsGEP1_32(fg->typeHelper().box(), current, 1);
     }
-    return init(fg, { fg->builder().CreateBitCast(structure, fg->builder().getInt8PtrTy()),
-                      fg->int64(values_.size()) });
+    return init(fg, initializer_, { fg->builder().CreateBitCast(structure, fg->builder().getInt8PtrTy()),
+                                    fg->int64(values_.size()) });
 }
 
 Value *ASTCollectionLiteral::generatePairs(FunctionCodeGenerator *fg) const {
+    auto constantKeys = constantValueArray(fg, 0, 2, false);
+    auto constantValues = constantKeys != nullptr ? constantValueArray(fg, 1, 2, true) : nullptr;
+    if (constantValues != nullptr) {
+        return init(fg, initializer_, { constantKeys, constantValues, fg->int64(values_.size() / 2) });
+    }
     llvm::Value *keys, *values, *currentKey, *currentValue;
     auto string = fg->typeHelper().llvmTypeFor(Type(fg->compiler()->sString));
     std::tie(currentKey, keys) = prepareValueArray(fg, string, values_.size() / 2, "keys");
@@ -109,49 +184,69 @@ Value *ASTCollectionLiteral::generatePairs(FunctionCodeGenerator *fg) const {
         currentKey = fg->builder().CreateConstInBoundsGEP1_32(string, currentKey, 1);
         currentValue = fg->builder().CreateConstInBoundsGEP1_32(fg->typeHelper().box(), currentValue, 1);
     }
-    return init(fg, {fg->builder().CreateBitCast(keys, fg->builder().getInt8PtrTy()),
-                     fg->builder().CreateBitCast(values, fg->builder().getInt8PtrTy()), fg->int64(values_.size() / 2)});
+    return init(fg, initializer_, {fg->builder().CreateBitCast(keys, fg->builder().getInt8PtrTy()),
+                                   fg->builder().CreateBitCast(values, fg->builder().getInt8PtrTy()),
+                                   fg->int64(values_.size() / 2)});
 }
 
 
 Value* ASTInterpolationLiteral::generate(FunctionCodeGenerator *fg) const {
-    int64_t length = 0;
+    ConstantValue constant;
+    if (ConstantEvaluator(fg->compiler()).evaluate(this, &constant)) {
+        return fg->generator()->stringPool().pool(constant.string);
+    }
+
+    auto type = Type(fg->compiler()->sString);
+
+    int64_t literalsSize = 0;
     for (auto &literal : literals_) {
-        length += literal.size() + 6;
+        literalsSize += utf8(literal).size();
     }
-    auto type = init_->owner()->type();
-    auto lengthNode = std::make_shared<ASTNumberLiteral>(length, U"", position());
-    auto builder = ASTInitialization::initObject(fg, ASTArguments(position(), {lengthNode}), init_, type, nullptr, true,
-                                                 nullptr);
 
-    auto literalsIt = literals_.begin();
-    append(fg, *literalsIt++, builder);
+    // The strings of all values are created first so that the result can be allocated with its exact size.
+    std::vector<llvm::Value *> strings;
+    llvm::Value *size = fg->int64(literalsSize);
     for (auto &value : values_) {
-        auto str = CallCodeGenerator(fg, CallType::DynamicProtocolDispatch).generate(value->generate(fg), value->expressionType(),
-                                                                 ASTArguments(position()), toString_, nullptr);
-        append(fg, str, builder);
-        append(fg, *literalsIt++, builder);
+        auto str = CallCodeGenerator(fg, CallType::DynamicProtocolDispatch)
+                .generate(value->generate(fg), value->expressionType(), ASTArguments(position()), toString_, nullptr);
+        strings.emplace_back(str);
+        auto strSize = CallCodeGenerator(fg, CallType::StaticDispatch)
+                .generate(str, type, ASTArguments(position()), size_, nullptr);
+        size = fg->builder().CreateAdd(size, strSize);
     }
 
-    auto str = CallCodeGenerator(fg, CallType::StaticDispatch).generate(builder, type,
-                                                                        ASTArguments(position()), get_, nullptr);
-    fg->release(builder, type);
-    return handleResult(fg, str);
-}
+    auto memory = fg->builder().CreateCall(fg->generator()->runTime().alloc(), fg->builder().CreateAdd(
+            size, fg->sizeOf(llvm::Type::getInt8PtrTy(fg->ctx()))), "alloc");
 
-void
-ASTInterpolationLiteral::append(FunctionCodeGenerator *fg, llvm::Value *value, llvm::Value *builder) const {
-    CallCodeGenerator(fg, CallType::StaticDispatch).generate(builder, init_->owner()->type(), ASTArguments(position()),
-                                                             append_, nullptr,
-                                                             {value});
+    auto literalsIt = literals_.begin();
+    llvm::Value *offset = copy(fg, *literalsIt++, memory, fg->int64(0));
+    for (auto str : strings) {
+        CallCodeGenerator(fg, CallType::StaticDispatch).generate(str, type, ASTArguments(position()), copy_, nullptr,
+                                                                 { memory, offset });
+        offset = fg->builder().CreateAdd(offset, CallCodeGenerator(fg, CallType::StaticDispatch)
+                .generate(str, type, ASTArguments(position()), size_, nullptr));
+        fg->release(str, type);
+        offset = copy(fg, *literalsIt++, memory, offset);
+    }
+
+    auto llvmType = llvm::dyn_cast<llvm::PointerType>(fg->typeHelper().llvmTypeFor(type));
+    auto obj = fg->alloc(llvmType);
+    fg->builder().CreateStore(type.klass()->classInfo(), fg->buildGetClassInfoPtrFromObject(obj));
+    auto str = CallCodeGenerator(fg, CallType::StaticDispatch).generate(obj, type, ASTArguments(position()), init_,
+                                                                        nullptr, { memory, size });
+    return handleResult(fg, str);
 }
 
-void
-ASTInterpolationLiteral::append(FunctionCodeGenerator *fg, const std::u32string &literal, llvm::Value *builder) const {
+llvm::Value* ASTInterpolationLiteral::copy(FunctionCodeGenerator *fg, const std::u32string &literal,
+                                           llvm::Value *memory, llvm::Value *offset) const {
     if (literal.empty()) {
-        return;
+        return offset;
     }
-    append(fg, fg->generator()->stringPool().pool(literal), builder);
+    auto size = utf8(literal).size();
+    auto destination = fg->builder().CreateGEP(memory, fg->builder().CreateAdd(
+            offset, fg->sizeOf(llvm::Type::getInt8PtrTy(fg->ctx()))));
+    fg->builder().CreateMemCpy(destination, 1, fg->generator()->stringPool().poolBytes(literal), 1, size);
+    return fg->builder().CreateAdd(offset, fg->int64(size));
 }
 
 }  // namespace EmojicodeCompiler
@@ -28,6 +28,8 @@ public:
     void analyse(FunctionAnalyser *) final {}
     void toCode(PrettyStream &pretty) const override {}
     void generate(FunctionCodeGenerator *fg) const override;
+
+    using AccessesAnyVariable::id;
 };
 
 /// An ASTRetain node retains the content of the specified variable.
@@ -8,6 +8,7 @@
 
 #include "ASTMethod.hpp"
 #include "ASTVariables.hpp"
+#include "Analysis/ConstantEvaluator.hpp"
 #include "Analysis/FunctionAnalyser.hpp"
 #include "Analysis/SemanticAnalyser.hpp"
 #include "Compiler.hpp"
@@ -15,9 +16,11 @@
 #include "Functions/Function.hpp"
 #include "MemoryFlowAnalysis/MFFunctionAnalyser.hpp"
 #include "Scoping/SemanticScoper.hpp"
+#include "Types/Class.hpp"
 #include "Types/Enum.hpp"
 #include "Types/Protocol.hpp"
 #include "Types/TypeExpectation.hpp"
+#include <cmath>
 
 namespace EmojicodeCompiler {
 
@@ -43,7 +46,7 @@ Type ASTMethodable::analyseMethodCall(ExpressionAnalyser *analyser, const std::u
     method_ = calleeType_.typeDefinition()->methods().get(name, args_.mood(), &args_,
                                                           &calleeType_, analyser, position());
 
-    if (calleeType_.type() == TypeType::Class && (method_->accessLevel() == AccessLevel::Private || calleeType_.isExact())) {
+    if (calleeType_.type() == TypeType::Class && hasSingleImplementation()) {
         callType_ = CallType::StaticDispatch;
     }
 
@@ -80,6 +83,15 @@ void ASTMethodable::determineCalleeType(ExpressionAnalyser *analyser, const std:
     }
 }
 
+bool ASTMethodable::hasSingleImplementation() const {
+    if (method_->accessLevel() == AccessLevel::Private || calleeType_.isExact()) {
+        return true;
+    }
+    // Subclasses of a class that is not extensible by other packages can only be declared in this package, which has
+    // been analysed. A class that is not exported is extensible if it has an exported subclass.
+    return !method_->overridden() && !calleeType_.klass()->extensibleByOtherPackages();
+}
+
 void ASTMethodable::determineCallType(const ExpressionAnalyser *analyser) {
     if (calleeType_.type() == TypeType::ValueType) {
         callType_ = CallType::StaticDispatch;
@@ -133,8 +145,11 @@ Type ASTMethodable::analyseTypeMethodCall(ExpressionAnalyser *analyser, const st
 
     method_ = calleeType_.typeDefinition()->typeMethods().get(name, args_.mood(), &args_,
                                                               &calleeType_, analyser, position());
+    if (calleeType_.typeDefinition() == analyser->compiler()->sTracing && method_->externalName() == "ejcBuiltIn") {
+        builtIn_ = BuiltInType::TracingEnabled;
+    }
 
-    if (calleeType_.type() == TypeType::Class && (method_->accessLevel() == AccessLevel::Private || calleeType_.isExact())) {
+    if (calleeType_.type() == TypeType::Class && hasSingleImplementation()) {
         callType_ = CallType::StaticDispatch;
     }
     ensureErrorIsHandled(analyser);
@@ -183,11 +198,60 @@ void ASTMethodable::prepareBuiltIns(Compiler *c) {
         {{c->sReal, 0x1f3c7}, BuiltInType::Round},
         {{c->sReal, 0x1f3e7}, BuiltInType::DoubleAbs},
         {{c->sReal, 0x1f522}, BuiltInType::DoubleToInteger},
+        {{c->sReal, 0x1f4d3}, BuiltInType::Sin},
+        {{c->sReal, 0x1f4d5}, BuiltInType::Cos},
+        {{c->sReal, 0x1f4d0}, BuiltInType::Tan},
+        {{c->sReal, 0x1f4d4}, BuiltInType::ASin},
+        {{c->sReal, 0x1f4d9}, BuiltInType::ACos},
+        {{c->sReal, 0x1f4d2}, BuiltInType::ATan},
+        {{c->sReal, 0x26f7}, BuiltInType::Sqrt},
+        {{c->sReal, 0x1f939}, BuiltInType::FusedMultiplyAdd},
+        {{c->sReal, 0x1f53d}, BuiltInType::DoubleMinimum},
+        {{c->sReal, 0x1f53c}, BuiltInType::DoubleMaximum},
         {{c->sMemory, E_RECYCLING_SYMBOL}, BuiltInType::Release},
         {{c->sMemory, 0x1F69C}, BuiltInType::MemoryMove},
+        {{c->sMemory, 0x1F69A}, BuiltInType::MemoryCopy},
         {{c->sMemory, 0x270D}, BuiltInType::MemorySet},
         {{c->sMemory, 0x1F43D}, BuiltInType::Load},
+        {{c->sMemory, 0x1F52D}, BuiltInType::AtomicLoad},
+        {{c->sMemory, 0x1F4CC}, BuiltInType::AtomicStore},
+        {{c->sMemory, 0x1F9EE}, BuiltInType::AtomicAdd},
+        {{c->sMemory, 0x1F504}, BuiltInType::AtomicExchange},
+        {{c->sMemory, 0x1F500}, BuiltInType::AtomicCompareExchange},
+        {{c->sMemory, 0x1F4E5}, BuiltInType::LoadUnaligned},
+        {{c->sMemory, 0x1F4E4}, BuiltInType::StoreUnaligned},
+        {{c->sReal, 0x1F682}, BuiltInType::VectorSplat},
+        {{c->sInteger, 0x1F682}, BuiltInType::VectorSplat},
+        {{c->sByte, 0x1F682}, BuiltInType::VectorSplat},
     };
+    for (auto integer : { c->sInteger, c->sUInt8, c->sUInt16, c->sUInt32 }) {
+        kBuiltIns.emplace(std::make_pair(integer, 0x1F9EE), BuiltInType::IntegerPopCount);
+        kBuiltIns.emplace(std::make_pair(integer, 0x23EE), BuiltInType::IntegerLeadingZeros);
+        kBuiltIns.emplace(std::make_pair(integer, 0x23ED), BuiltInType::IntegerTrailingZeros);
+        kBuiltIns.emplace(std::make_pair(integer, 0x1F504), BuiltInType::IntegerRotateLeft);
+        kBuiltIns.emplace(std::make_pair(integer, 0x1F503), BuiltInType::IntegerRotateRight);
+        kBuiltIns.emplace(std::make_pair(integer, 0x1F500), BuiltInType::IntegerByteSwap);
+        kBuiltIns.emplace(std::make_pair(integer, 0x1F6E1), BuiltInType::IntegerChecked);
+        kBuiltIns.emplace(std::make_pair(integer, 0x1F9F1), BuiltInType::IntegerSaturating);
+    }
+    for (auto integer : { c->sUInt8, c->sUInt16, c->sUInt32 }) {
+        kBuiltIns.emplace(std::make_pair(integer, 0x1F522), BuiltInType::UnsignedToInteger);
+    }
+    kBuiltIns.emplace(std::make_pair(c->sInteger, 0x1F949), BuiltInType::IntegerTruncate);
+    kBuiltIns.emplace(std::make_pair(c->sInteger, 0x1F948), BuiltInType::IntegerTruncate);
+    kBuiltIns.emplace(std::make_pair(c->sInteger, 0x1F947), BuiltInType::IntegerTruncate);
+    for (auto vector : { c->sRealVector, c->sIntegerVector, c->sByteVector }) {
+        kBuiltIns.emplace(std::make_pair(vector, 0x1F43D), BuiltInType::VectorExtract);
+        kBuiltIns.emplace(std::make_pair(vector, 0x1F437), BuiltInType::VectorInsert);
+        kBuiltIns.emplace(std::make_pair(vector, 0x1F500), BuiltInType::VectorSelect);
+        kBuiltIns.emplace(std::make_pair(vector, 0x1F503), BuiltInType::VectorReverse);
+        kBuiltIns.emplace(std::make_pair(vector, 0x1F501), BuiltInType::VectorRotate);
+        kBuiltIns.emplace(std::make_pair(vector, 0x1F53D), BuiltInType::VectorMinimum);
+        kBuiltIns.emplace(std::make_pair(vector, 0x1F53C), BuiltInType::VectorMaximum);
+        kBuiltIns.emplace(std::make_pair(vector, 0x1F9EE), BuiltInType::VectorSum);
+        kBuiltIns.emplace(std::make_pair(vector, 0x2B07), BuiltInType::VectorSmallest);
+        kBuiltIns.emplace(std::make_pair(vector, 0x2B06), BuiltInType::VectorGreatest);
+    }
 }
 
 bool ASTMethodable::builtIn(ExpressionAnalyser *analyser, const Type &btype, const std::u32string &name) {
@@ -220,4 +284,104 @@ void ASTMethod::analyseMemoryFlow(MFFunctionAnalyser *analyser, MFFlowCategory t
     analyser->analyseFunctionCall(&args_, callee_.get(), method_);
 }
 
+bool ASTMethod::evaluate(ConstantEvaluator *evaluator, ConstantValue *value) const {
+    if (builtIn_ != BuiltInType::None) {
+        return evaluateBuiltIn(evaluator, value);
+    }
+    if ((callType_ != CallType::StaticContextfreeDispatch && callType_ != CallType::StaticDispatch) ||
+        !isTypeMethod(method_) || !castTo_.is<TypeType::NoReturn>() ||
+        method_->owner()->storesGenericArgs() || !calleeType_.genericArguments().empty()) {
+        return false;
+    }
+    std::vector<ConstantValue> arguments(args_.args().size());
+    for (size_t i = 0; i < arguments.size(); i++) {
+        if (!args_.args()[i]->evaluate(evaluator, &arguments[i])) {
+            return false;
+        }
+    }
+    return evaluator->call(method_, std::move(arguments), value);
+}
+
+bool ASTMethod::evaluateBuiltIn(ConstantEvaluator *evaluator, ConstantValue *value) const {
+    ConstantValue v;
+    if (!callee_->evaluate(evaluator, &v)) {
+        return false;
+    }
+    auto integer = v.kind == ConstantValue::Kind::Integer || v.kind == ConstantValue::Kind::Byte;
+    auto wrap = [&v](uint64_t result) {
+        return ConstantValue(v.kind, v.kind == ConstantValue::Kind::Byte ? static_cast<int8_t>(result)
+                                                                         : static_cast<int64_t>(result));
+    };
+    switch (builtIn_) {
+        case BuiltInType::IntegerNot:
+            if (!integer) return false;
+            *value = wrap(~static_cast<uint64_t>(v.integer));
+            return true;
+        case BuiltInType::IntegerInverse:
+            if (!integer) return false;
+            *value = wrap(0 - static_cast<uint64_t>(v.integer));
+            return true;
+        case BuiltInType::IntegerToDouble:
+            if (!integer) return false;
+            *value = ConstantValue(static_cast<double>(v.integer));
+            return true;
+        case BuiltInType::IntegerToByte:
+            if (v.kind != ConstantValue::Kind::Integer) return false;
+            *value = ConstantValue(ConstantValue::Kind::Byte, static_cast<int8_t>(v.integer));
+            return true;
+        case BuiltInType::ByteToInteger:
+            if (v.kind != ConstantValue::Kind::Byte) return false;
+            *value = ConstantValue(ConstantValue::Kind::Integer, v.integer);
+            return true;
+        case BuiltInType::BooleanNegate:
+            if (v.kind != ConstantValue::Kind::Boolean) return false;
+            *value = ConstantValue(!v.boolean);
+            return true;
+        default:
+            break;
+    }
+    if (v.kind != ConstantValue::Kind::Real) {
+        return false;
+    }
+    switch (builtIn_) {
+        case BuiltInType::DoubleInverse:
+            *value = ConstantValue(-v.real);
+            return true;
+        case BuiltInType::DoubleAbs:
+            *value = ConstantValue(std::fabs(v.real));
+            return true;
+        case BuiltInType::Floor:
+            *value = ConstantValue(std::floor(v.real));
+            return true;
+        case BuiltInType::Ceil:
+            *value = ConstantValue(std::ceil(v.real));
+            return true;
+        case BuiltInType::Round:
+            *value = ConstantValue(std::round(v.real));
+            return true;
+        case BuiltInType::Sqrt:
+            *value = ConstantValue(std::sqrt(v.real));
+            return true;
+        case BuiltInType::DoubleToInteger:
+            // The conversion of NaN and of values out of the range of 🔢 is undefined.
+            if (!(v.real >= -9223372036854775808.0 && v.real < 9223372036854775808.0)) return false;
+            *value = ConstantValue(ConstantValue::Kind::Integer, static_cast<int64_t>(v.real));
+            return true;
+        case BuiltInType::DoubleMinimum:
+        case BuiltInType::DoubleMaximum: {
+            ConstantValue other;
+            if (!args_.args()[0]->evaluate(evaluator, &other) || other.kind != ConstantValue::Kind::Real) {
+                return false;
+            }
+            *value = ConstantValue(builtIn_ == BuiltInType::DoubleMinimum ? std::fmin(v.real, other.real)
+                                                                          : std::fmax(v.real, other.real));
+            return true;
+        }
+        default:
+            // Functions like sin are not evaluated as the results of the compiler's and the program's math library
+            // might differ.
+            return false;
+    }
+}
+
 }  // namespace EmojicodeCompiler
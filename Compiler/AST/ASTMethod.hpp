@@ -11,6 +11,8 @@
 
 #include "ASTExpr.hpp"
 #include "Functions/CallType.h"
+#include <llvm/Support/AtomicOrdering.h>
+#include <functional>
 #include <utility>
 #include <map>
 
@@ -35,12 +37,22 @@ protected:
         None,
         DoubleMultiply, DoubleAdd, DoubleSubstract, DoubleDivide, DoubleGreater, DoubleGreaterOrEqual,
         DoubleLess, DoubleLessOrEqual, DoubleRemainder, DoubleEqual, DoubleInverse, Power, Log2, Log10, Ln, Ceil, Floor,
-        Round, DoubleAbs, DoubleToInteger,
+        Round, DoubleAbs, DoubleToInteger, Sin, Cos, Tan, ASin, ACos, ATan, Sqrt, FusedMultiplyAdd, DoubleMinimum,
+        DoubleMaximum,
+        VectorSplat, VectorExtract, VectorInsert, VectorSelect, VectorReverse, VectorRotate, VectorMinimum,
+        VectorMaximum, VectorSum, VectorSmallest, VectorGreatest,
         IntegerMultiply, IntegerAdd, IntegerSubstract, IntegerDivide, IntegerGreater, IntegerGreaterOrEqual,
         IntegerLess, IntegerLessOrEqual, IntegerLeftShift, IntegerRightShift, IntegerOr, IntegerAnd, IntegerXor,
         IntegerRemainder, IntegerToDouble, IntegerNot, IntegerInverse, IntegerToByte, ByteToInteger,
+        IntegerPopCount, IntegerLeadingZeros, IntegerTrailingZeros, IntegerRotateLeft, IntegerRotateRight,
+        IntegerByteSwap, IntegerChecked, IntegerSaturating, IntegerTruncate,
+        UnsignedDivide, UnsignedRemainder, UnsignedLess, UnsignedLessOrEqual, UnsignedGreater, UnsignedGreaterOrEqual,
+        UnsignedToInteger,
         BooleanAnd, BooleanOr, BooleanNegate,
-        Equal, Store, Load, Release, MemoryMove, MemorySet, IsNoValueLeft, IsNoValueRight, Multiprotocol,
+        Equal, Store, Load, Release, MemoryMove, MemoryCopy, MemorySet, IsNoValueLeft, IsNoValueRight, Multiprotocol,
+        LoadUnaligned, StoreUnaligned,
+        AtomicLoad, AtomicStore, AtomicAdd, AtomicExchange, AtomicCompareExchange,
+        TracingEnabled,
     };
 
     BuiltInType builtIn_ = BuiltInType::None;
@@ -64,6 +76,10 @@ private:
 
     void checkMutation(ExpressionAnalyser *analyser, const std::shared_ptr<ASTExpr> &callee) const;
     void determineCallType(const ExpressionAnalyser *analyser);
+    /// Returns true if method_ called on a calleeType_ instance can only invoke method_ itself and therefore does not
+    /// need dynamic dispatch.
+    /// @pre calleeType_ is a class type.
+    bool hasSingleImplementation() const;
     void determineCalleeType(ExpressionAnalyser *analyser, const std::u32string &name,
                              std::shared_ptr<ASTExpr> &callee, const Type &otype);
     Type analyseTypeMethodCall(ExpressionAnalyser *analyser, const std::u32string &name,
@@ -79,14 +95,35 @@ public:
     Value* generate(FunctionCodeGenerator *fg) const override;
     void analyseMemoryFlow(MFFunctionAnalyser *analyser, MFFlowCategory type) override;
     void mutateReference(ExpressionAnalyser *analyser) final;
+    /// Evaluates the built-in operations of 🔢, 💧, 💯 and 👌 whose result is exactly defined and statically dispatched
+    /// calls of type methods, which are interpreted by ConstantEvaluator::call.
+    bool evaluate(ConstantEvaluator *evaluator, ConstantValue *value) const override;
 
 private:
     std::u32string name_;
     std::shared_ptr<ASTExpr> callee_;
 
+    bool evaluateBuiltIn(ConstantEvaluator *evaluator, ConstantValue *value) const;
+
     llvm::Value* buildMemoryAddress(FunctionCodeGenerator *fg, llvm::Value *memory, llvm::Value *offset,
                                     const Type &type) const;
     llvm::Value* buildAddOffsetAddress(FunctionCodeGenerator *fg, llvm::Value *memory, llvm::Value *offset) const;
+    /// Copies *count* values of the given type from *source* to *destination* and retains the copies if necessary.
+    /// Trivially copyable values are copied with a single memcpy.
+    void buildCopyValues(FunctionCodeGenerator *fg, llvm::Value *destination, llvm::Value *source, llvm::Value *count,
+                         const Type &type) const;
+    /// Returns the address of the 🔢 *offset* bytes past *memory* for an atomic operation.
+    llvm::Value* buildAtomicAddress(FunctionCodeGenerator *fg, llvm::Value *memory, llvm::Value *offset) const;
+    /// Calls *build* with the atomic ordering represented by *order*, a 🧭 value, and returns its result. If *order*
+    /// is not a constant, a switch over all orderings is generated, which LLVM reduces to the right case once *order*
+    /// becomes a constant through inlining.
+    llvm::Value* buildWithAtomicOrdering(FunctionCodeGenerator *fg, llvm::Value *order,
+                                         const std::function<llvm::Value* (llvm::AtomicOrdering)> &build) const;
+    llvm::Value* generateAtomic(FunctionCodeGenerator *fg, llvm::Value *memory) const;
+    /// Generates the built-ins of the vector types and the conversion of lane values to vectors.
+    llvm::Value* generateVector(FunctionCodeGenerator *fg, llvm::Value *value) const;
+    /// Generates the bit operations and the checked and saturating arithmetic of the integer types.
+    llvm::Value* generateInteger(FunctionCodeGenerator *fg, llvm::Value *value) const;
 };
     
 }  // namespace EmojicodeCompiler
@@ -8,8 +8,12 @@
 
 #include "ASTMethod.hpp"
 #include "ASTType.hpp"
+#include "Analysis/ConstantEvaluator.hpp"
+#include "Compiler.hpp"
 #include "Generation/CallCodeGenerator.hpp"
+#include "Generation/CodeGenerator.hpp"
 #include "Generation/FunctionCodeGenerator.hpp"
+#include "Generation/RunTimeHelper.hpp"
 #include "Generation/TypeDescriptionGenerator.hpp"
 #include "Functions/Function.hpp"
 #include "Types/TypeDefinition.hpp"
@@ -21,6 +25,15 @@ llvm::Value* callIntrinsic(FunctionCodeGenerator *fg, llvm::Intrinsic::ID id, ll
 }
 
 Value* ASTMethod::generate(FunctionCodeGenerator *fg) const {
+    if (builtIn_ == BuiltInType::TracingEnabled) {
+        // The flag may be changed by any thread at any time. As tracing is usually off, the branch on the result is
+        // laid out for the flag being zero.
+        auto flag = fg->builder().CreateLoad(fg->generator()->runTime().tracing());
+        flag->setAlignment(1);
+        flag->setAtomic(llvm::AtomicOrdering::Monotonic);
+        auto enabled = fg->builder().CreateICmpNE(flag, fg->builder().getInt8(0));
+        return callIntrinsic(fg, llvm::Intrinsic::expect, { enabled, fg->builder().getFalse() });
+    }
     if (builtIn_ != BuiltInType::None) {
         auto v = callee_->generate(fg);
         switch (builtIn_) {
@@ -52,6 +65,27 @@ Value* ASTMethod::generate(FunctionCodeGenerator *fg) const {
                 return callIntrinsic(fg, llvm::Intrinsic::ID::round, v);
             case BuiltInType::DoubleAbs:
                 return callIntrinsic(fg, llvm::Intrinsic::ID::fabs, v);
+            case BuiltInType::Sin:
+                return callIntrinsic(fg, llvm::Intrinsic::ID::sin, v);
+            case BuiltInType::Cos:
+                return callIntrinsic(fg, llvm::Intrinsic::ID::cos, v);
+            case BuiltInType::Sqrt:
+                return callIntrinsic(fg, llvm::Intrinsic::ID::sqrt, v);
+            case BuiltInType::Tan:
+                return fg->builder().CreateCall(fg->generator()->runTime().mathFunction("tan"), v);
+            case BuiltInType::ASin:
+                return fg->builder().CreateCall(fg->generator()->runTime().mathFunction("asin"), v);
+            case BuiltInType::ACos:
+                return fg->builder().CreateCall(fg->generator()->runTime().mathFunction("acos"), v);
+            case BuiltInType::ATan:
+                return fg->builder().CreateCall(fg->generator()->runTime().mathFunction("atan"), v);
+            case BuiltInType::FusedMultiplyAdd:
+                return callIntrinsic(fg, llvm::Intrinsic::ID::fma, {v, args_.args()[0]->generate(fg),
+                                                                    args_.args()[1]->generate(fg)});
+            case BuiltInType::DoubleMinimum:
+                return callIntrinsic(fg, llvm::Intrinsic::ID::minnum, {v, args_.args()[0]->generate(fg)});
+            case BuiltInType::DoubleMaximum:
+                return callIntrinsic(fg, llvm::Intrinsic::ID::maxnum, {v, args_.args()[0]->generate(fg)});
             case BuiltInType::DoubleToInteger:
                 return fg->builder().CreateFPToSI(v, llvm::Type::getInt64Ty(fg->ctx()));
             case BuiltInType::BooleanNegate:
@@ -90,11 +124,63 @@ Value* ASTMethod::generate(FunctionCodeGenerator *fg) const {
                                             args_.args()[3]->generate(fg));
                 return nullptr;
             }
+            case BuiltInType::MemoryCopy: {
+                auto type = args_.genericArguments().front()->type();
+                auto destination = buildMemoryAddress(fg, v, args_.args()[0]->generate(fg), type);
+                auto source = buildMemoryAddress(fg, args_.args()[1]->generate(fg), args_.args()[2]->generate(fg),
+                                                 type);
+                auto count = args_.args()[3]->generate(fg);
+                buildCopyValues(fg, destination, source, count, type);
+                return nullptr;
+            }
             case BuiltInType::MemorySet: {
                 fg->builder().CreateMemSet(buildAddOffsetAddress(fg, v, args_.args()[1]->generate(fg)),
                                            args_.args()[0]->generate(fg), args_.args()[2]->generate(fg), 0);
                 return nullptr;
             }
+            case BuiltInType::AtomicLoad:
+            case BuiltInType::AtomicStore:
+            case BuiltInType::AtomicAdd:
+            case BuiltInType::AtomicExchange:
+            case BuiltInType::AtomicCompareExchange:
+                return generateAtomic(fg, v);
+            case BuiltInType::LoadUnaligned: {
+                auto type = args_.genericArguments().front()->type();
+                auto load = fg->builder().CreateLoad(buildMemoryAddress(fg, v, args_.args()[0]->generate(fg), type));
+                load->setAlignment(1);
+                return load;
+            }
+            case BuiltInType::StoreUnaligned: {
+                auto type = args_.genericArguments().front()->type();
+                auto value = args_.args()[0]->generate(fg);
+                auto store = fg->builder().CreateStore(value, buildMemoryAddress(fg, v, args_.args()[1]->generate(fg),
+                                                                                 type));
+                store->setAlignment(1);
+                return nullptr;
+            }
+            case BuiltInType::VectorSplat:
+            case BuiltInType::VectorExtract:
+            case BuiltInType::VectorInsert:
+            case BuiltInType::VectorSelect:
+            case BuiltInType::VectorReverse:
+            case BuiltInType::VectorRotate:
+            case BuiltInType::VectorMinimum:
+            case BuiltInType::VectorMaximum:
+            case BuiltInType::VectorSum:
+            case BuiltInType::VectorSmallest:
+            case BuiltInType::VectorGreatest:
+                return generateVector(fg, v);
+            case BuiltInType::IntegerPopCount:
+            case BuiltInType::IntegerLeadingZeros:
+            case BuiltInType::IntegerTrailingZeros:
+            case BuiltInType::IntegerRotateLeft:
+            case BuiltInType::IntegerRotateRight:
+            case BuiltInType::IntegerByteSwap:
+            case BuiltInType::IntegerChecked:
+            case BuiltInType::IntegerSaturating:
+            case BuiltInType::IntegerTruncate:
+            case BuiltInType::UnsignedToInteger:
+                return generateInteger(fg, v);
             case BuiltInType::Multiprotocol:
                 return MultiprotocolCallCodeGenerator(fg, callType_).generate(callee_->generate(fg), calleeType_, args_,
                                                                               method_, errorPointer(), multiprotocolN_);
@@ -103,6 +189,16 @@ Value* ASTMethod::generate(FunctionCodeGenerator *fg) const {
         }
     }
 
+    // Calls of pure type methods with constant arguments are replaced by their result.
+    if (isTypeMethod(method_)) {
+        ConstantValue value;
+        if (ConstantEvaluator(fg->compiler()).evaluate(this, &value)) {
+            if (auto constant = fg->generator()->constantFor(value, expressionType())) {
+                return constant;
+            }
+        }
+    }
+
     std::vector<llvm::Value *> supplArgs;
     auto tdg = TypeDescriptionGenerator(fg, TypeDescriptionGenerator::User::Function);
     if (isTypeMethod(method_) && method_->owner()->storesGenericArgs()) {
@@ -122,6 +218,311 @@ Value* ASTMethod::generate(FunctionCodeGenerator *fg) const {
     return handleResult(fg, ret);
 }
 
+void ASTMethod::buildCopyValues(FunctionCodeGenerator *fg, llvm::Value *destination, llvm::Value *source,
+                                llvm::Value *count, const Type &type) const {
+    if (type.storageType() == StorageType::Box) {
+        fg->builder().CreateCall(fg->generator()->runTime().copyBoxes(), { destination, source, count });
+        return;
+    }
+
+    auto elementType = llvm::cast<llvm::PointerType>(destination->getType())->getElementType();
+    fg->builder().CreateMemCpy(destination, 0, source, 0,
+                               fg->builder().CreateMul(fg->sizeOf(elementType), count));
+    if (type.isTriviallyCopyable()) {
+        return;
+    }
+
+    auto entry = fg->builder().GetInsertBlock();
+    auto loop = fg->createBlock("copyRetain");
+    auto after = fg->createBlock("copyRetainDone");
+    fg->builder().CreateCondBr(fg->builder().CreateICmpSGT(count, fg->int64(0)), loop, after);
+
+    fg->builder().SetInsertPoint(loop);
+    auto index = fg->builder().CreatePHI(llvm::Type::getInt64Ty(fg->ctx()), 2);
+    index->addIncoming(fg->int64(0), entry);
+    auto ptr = fg->builder().CreateGEP(destination, index);
+    fg->retain(fg->isManagedByReference(type) ? ptr : fg->builder().CreateLoad(ptr), type);
+    auto next = fg->builder().CreateAdd(index, fg->int64(1));
+    index->addIncoming(next, fg->builder().GetInsertBlock());
+    fg->builder().CreateCondBr(fg->builder().CreateICmpSLT(next, count), loop, after);
+
+    fg->builder().SetInsertPoint(after);
+}
+
+Value* ASTMethod::buildAtomicAddress(FunctionCodeGenerator *fg, llvm::Value *memory, llvm::Value *offset) const {
+    return buildMemoryAddress(fg, memory, offset, Type(fg->compiler()->sInteger));
+}
+
+/// Loads cannot release and stores cannot acquire, so these parts of *ordering* are dropped for them.
+static llvm::AtomicOrdering withoutRelease(llvm::AtomicOrdering ordering) {
+    switch (ordering) {
+        case llvm::AtomicOrdering::Release:
+            return llvm::AtomicOrdering::Monotonic;
+        case llvm::AtomicOrdering::AcquireRelease:
+            return llvm::AtomicOrdering::Acquire;
+        default:
+            return ordering;
+    }
+}
+
+static llvm::AtomicOrdering withoutAcquire(llvm::AtomicOrdering ordering) {
+    switch (ordering) {
+        case llvm::AtomicOrdering::Acquire:
+            return llvm::AtomicOrdering::Monotonic;
+        case llvm::AtomicOrdering::AcquireRelease:
+            return llvm::AtomicOrdering::Release;
+        default:
+            return ordering;
+    }
+}
+
+Value* ASTMethod::buildWithAtomicOrdering(FunctionCodeGenerator *fg, llvm::Value *order,
+                                          const std::function<llvm::Value* (llvm::AtomicOrdering)> &build) const {
+    // In the order of the values of 🧭
+    static const llvm::AtomicOrdering orderings[] = {
+        llvm::AtomicOrdering::Monotonic, llvm::AtomicOrdering::Acquire, llvm::AtomicOrdering::Release,
+        llvm::AtomicOrdering::AcquireRelease, llvm::AtomicOrdering::SequentiallyConsistent,
+    };
+    constexpr size_t count = sizeof(orderings) / sizeof(orderings[0]);
+
+    if (auto constant = llvm::dyn_cast<llvm::ConstantInt>(order)) {
+        auto value = constant->getSExtValue();
+        return build(value >= 0 && static_cast<size_t>(value) < count ?
+                     orderings[value] : llvm::AtomicOrdering::SequentiallyConsistent);
+    }
+
+    auto after = fg->createBlock("atomicDone");
+    auto sequential = fg->createBlock("atomicOrdering");
+    auto switchInst = fg->builder().CreateSwitch(order, sequential, count - 1);
+    std::vector<std::pair<llvm::Value *, llvm::BasicBlock *>> results;
+    for (size_t i = 0; i < count; i++) {
+        auto block = i == count - 1 ? sequential : fg->createBlock("atomicOrdering");
+        if (block != sequential) {
+            switchInst->addCase(fg->int64(i), block);
+        }
+        fg->builder().SetInsertPoint(block);
+        auto value = build(orderings[i]);
+        results.emplace_back(value, fg->builder().GetInsertBlock());
+        fg->builder().CreateBr(after);
+    }
+
+    fg->builder().SetInsertPoint(after);
+    if (results.front().first == nullptr) {
+        return nullptr;
+    }
+    auto phi = fg->builder().CreatePHI(results.front().first->getType(), count);
+    for (auto &result : results) {
+        phi->addIncoming(result.first, result.second);
+    }
+    return phi;
+}
+
+Value* ASTMethod::generateAtomic(FunctionCodeGenerator *fg, llvm::Value *memory) const {
+    auto &args = args_.args();
+    switch (builtIn_) {
+        case BuiltInType::AtomicLoad: {
+            auto ptr = buildAtomicAddress(fg, memory, args[0]->generate(fg));
+            return buildWithAtomicOrdering(fg, args[1]->generate(fg), [&](llvm::AtomicOrdering ordering) -> llvm::Value* {
+                auto load = fg->builder().CreateLoad(ptr);
+                load->setAlignment(8);
+                load->setAtomic(withoutRelease(ordering));
+                return load;
+            });
+        }
+        case BuiltInType::AtomicStore: {
+            auto value = args[0]->generate(fg);
+            auto ptr = buildAtomicAddress(fg, memory, args[1]->generate(fg));
+            return buildWithAtomicOrdering(fg, args[2]->generate(fg), [&](llvm::AtomicOrdering ordering) -> llvm::Value* {
+                auto store = fg->builder().CreateStore(value, ptr);
+                store->setAlignment(8);
+                store->setAtomic(withoutAcquire(ordering));
+                return nullptr;
+            });
+        }
+        case BuiltInType::AtomicAdd:
+        case BuiltInType::AtomicExchange: {
+            auto value = args[0]->generate(fg);
+            auto ptr = buildAtomicAddress(fg, memory, args[1]->generate(fg));
+            auto op = builtIn_ == BuiltInType::AtomicAdd ? llvm::AtomicRMWInst::Add : llvm::AtomicRMWInst::Xchg;
+            return buildWithAtomicOrdering(fg, args[2]->generate(fg), [&](llvm::AtomicOrdering ordering) -> llvm::Value* {
+                return fg->builder().CreateAtomicRMW(op, ptr, value, ordering);
+            });
+        }
+        case BuiltInType::AtomicCompareExchange: {
+            auto expected = args[0]->generate(fg);
+            auto desired = args[1]->generate(fg);
+            auto ptr = buildAtomicAddress(fg, memory, args[2]->generate(fg));
+            return buildWithAtomicOrdering(fg, args[3]->generate(fg), [&](llvm::AtomicOrdering ordering) -> llvm::Value* {
+                auto pair = fg->builder().CreateAtomicCmpXchg(ptr, expected, desired, ordering,
+                                                              withoutRelease(ordering));
+                return fg->builder().CreateExtractValue(pair, 1);
+            });
+        }
+        default:
+            return nullptr;
+    }
+}
+
+/// Returns the lane-wise minimum or maximum of *a* and *b*.
+static llvm::Value* buildMinimum(FunctionCodeGenerator *fg, llvm::Value *a, llvm::Value *b, bool maximum) {
+    if (a->getType()->isFPOrFPVectorTy()) {
+        return callIntrinsic(fg, maximum ? llvm::Intrinsic::ID::maxnum : llvm::Intrinsic::ID::minnum, {a, b});
+    }
+    return fg->builder().CreateSelect(maximum ? fg->builder().CreateICmpSGT(a, b) : fg->builder().CreateICmpSLT(a, b),
+                                      a, b);
+}
+
+/// Combines all lanes of *vector* with *combine* by repeatedly combining its lower and upper half.
+static llvm::Value* buildReduction(FunctionCodeGenerator *fg, llvm::Value *vector,
+                                   const std::function<llvm::Value* (llvm::Value *, llvm::Value *)> &combine) {
+    auto undefined = llvm::UndefValue::get(vector->getType());
+    for (auto count = vector->getType()->getVectorNumElements() / 2; count > 0; count /= 2) {
+        std::vector<uint32_t> low, high;
+        for (uint32_t i = 0; i < count; i++) {
+            low.emplace_back(i);
+            high.emplace_back(i + count);
+        }
+        vector = combine(fg->builder().CreateShuffleVector(vector, undefined, low),
+                         fg->builder().CreateShuffleVector(vector, undefined, high));
+        undefined = llvm::UndefValue::get(vector->getType());
+    }
+    return fg->builder().CreateExtractElement(vector, uint64_t(0));
+}
+
+/// Converts between the integer lanes of vectors and 🔢, which differ in size.
+static llvm::Value* buildLaneCast(FunctionCodeGenerator *fg, llvm::Value *value, llvm::Type *type) {
+    return value->getType() == type ? value : fg->builder().CreateSExtOrTrunc(value, type);
+}
+
+Value* ASTMethod::generateVector(FunctionCodeGenerator *fg, llvm::Value *value) const {
+    auto &args = args_.args();
+    if (builtIn_ == BuiltInType::VectorSplat) {
+        auto type = llvm::cast<llvm::VectorType>(fg->typeHelper().llvmTypeFor(expressionType()));
+        return fg->builder().CreateVectorSplat(type->getNumElements(),
+                                               buildLaneCast(fg, value, type->getElementType()));
+    }
+
+    auto type = llvm::cast<llvm::VectorType>(value->getType());
+    auto count = type->getNumElements();
+    switch (builtIn_) {
+        case BuiltInType::VectorExtract: {
+            auto lane = fg->builder().CreateExtractElement(value, args[0]->generate(fg));
+            return buildLaneCast(fg, lane, fg->typeHelper().llvmTypeFor(expressionType()));
+        }
+        case BuiltInType::VectorInsert: {
+            auto index = args[0]->generate(fg);
+            auto lane = buildLaneCast(fg, args[1]->generate(fg), type->getElementType());
+            return fg->builder().CreateInsertElement(value, lane, index);
+        }
+        case BuiltInType::VectorSelect: {
+            auto integers = fg->builder().CreateBitCast(value, llvm::VectorType::getInteger(type));
+            auto mask = fg->builder().CreateIsNotNull(integers);
+            return fg->builder().CreateSelect(mask, args[0]->generate(fg), args[1]->generate(fg));
+        }
+        case BuiltInType::VectorReverse: {
+            std::vector<uint32_t> indices;
+            for (uint32_t i = count; i > 0; i--) {
+                indices.emplace_back(i - 1);
+            }
+            return fg->builder().CreateShuffleVector(value, llvm::UndefValue::get(type), indices);
+        }
+        case BuiltInType::VectorRotate: {
+            // The lane counts are powers of two, so the remainder is right for negative counts too. InstCombine
+            // turns this into a single shuffle if the count is a constant.
+            auto rotation = args[0]->generate(fg);
+            llvm::Value *result = llvm::UndefValue::get(type);
+            for (uint64_t i = 0; i < count; i++) {
+                auto index = fg->builder().CreateURem(fg->builder().CreateAdd(rotation, fg->int64(i)),
+                                                      fg->int64(count));
+                result = fg->builder().CreateInsertElement(result, fg->builder().CreateExtractElement(value, index), i);
+            }
+            return result;
+        }
+        case BuiltInType::VectorMinimum:
+        case BuiltInType::VectorMaximum:
+            return buildMinimum(fg, value, args[0]->generate(fg), builtIn_ == BuiltInType::VectorMaximum);
+        case BuiltInType::VectorSum: {
+            auto lane = buildReduction(fg, value, [fg](llvm::Value *a, llvm::Value *b) {
+                if (a->getType()->isFPOrFPVectorTy()) {
+                    return fg->builder().CreateFAdd(a, b);
+                }
+                return fg->builder().CreateAdd(a, b);
+            });
+            return buildLaneCast(fg, lane, fg->typeHelper().llvmTypeFor(expressionType()));
+        }
+        case BuiltInType::VectorSmallest:
+        case BuiltInType::VectorGreatest: {
+            auto maximum = builtIn_ == BuiltInType::VectorGreatest;
+            auto lane = buildReduction(fg, value, [fg, maximum](llvm::Value *a, llvm::Value *b) {
+                return buildMinimum(fg, a, b, maximum);
+            });
+            return buildLaneCast(fg, lane, fg->typeHelper().llvmTypeFor(expressionType()));
+        }
+        default:
+            return nullptr;
+    }
+}
+
+/// Returns the intrinsic for the operation of a checked or saturating method, whose name is 🛡🔸 or 🧱🔸 followed by
+/// *operation*, which is ➕, ➖ or ✖️.
+static llvm::Intrinsic::ID arithmeticIntrinsic(char32_t operation, bool checked, bool isUnsigned) {
+    using llvm::Intrinsic::ID;
+    switch (operation) {
+        case 0x2795:
+            if (checked) return isUnsigned ? ID::uadd_with_overflow : ID::sadd_with_overflow;
+            return isUnsigned ? ID::uadd_sat : ID::sadd_sat;
+        case 0x2796:
+            if (checked) return isUnsigned ? ID::usub_with_overflow : ID::ssub_with_overflow;
+            return isUnsigned ? ID::usub_sat : ID::ssub_sat;
+        default:
+            return isUnsigned ? ID::umul_with_overflow : ID::smul_with_overflow;
+    }
+}
+
+Value* ASTMethod::generateInteger(FunctionCodeGenerator *fg, llvm::Value *value) const {
+    auto &args = args_.args();
+    auto type = value->getType();
+    auto int64 = llvm::Type::getInt64Ty(fg->ctx());
+    auto isUnsigned = fg->compiler()->isUnsignedInteger(callee_->expressionType().valueType());
+    switch (builtIn_) {
+        case BuiltInType::IntegerPopCount:
+            return fg->builder().CreateZExtOrTrunc(callIntrinsic(fg, llvm::Intrinsic::ID::ctpop, value), int64);
+        case BuiltInType::IntegerLeadingZeros:
+            return fg->builder().CreateZExtOrTrunc(callIntrinsic(fg, llvm::Intrinsic::ID::ctlz,
+                                                                 {value, fg->builder().getFalse()}), int64);
+        case BuiltInType::IntegerTrailingZeros:
+            return fg->builder().CreateZExtOrTrunc(callIntrinsic(fg, llvm::Intrinsic::ID::cttz,
+                                                                 {value, fg->builder().getFalse()}), int64);
+        case BuiltInType::IntegerRotateLeft:
+        case BuiltInType::IntegerRotateRight: {
+            // A funnel shift of a value with itself is a rotation. The amount is taken modulo the bit width.
+            auto amount = fg->builder().CreateZExtOrTrunc(args[0]->generate(fg), type);
+            auto id = builtIn_ == BuiltInType::IntegerRotateLeft ? llvm::Intrinsic::ID::fshl
+                                                                 : llvm::Intrinsic::ID::fshr;
+            return callIntrinsic(fg, id, {value, value, amount});
+        }
+        case BuiltInType::IntegerByteSwap:
+            return type->getIntegerBitWidth() == 8 ? value : callIntrinsic(fg, llvm::Intrinsic::ID::bswap, value);
+        case BuiltInType::IntegerChecked: {
+            auto id = arithmeticIntrinsic(name_[2], true, isUnsigned);
+            auto result = callIntrinsic(fg, id, {value, args[0]->generate(fg)});
+            auto withValue = fg->buildSimpleOptionalWithValue(fg->builder().CreateExtractValue(result, 0),
+                                                              expressionType());
+            return fg->builder().CreateSelect(fg->builder().CreateExtractValue(result, 1),
+                                              fg->buildSimpleOptionalWithoutValue(expressionType()), withValue);
+        }
+        case BuiltInType::IntegerSaturating:
+            return callIntrinsic(fg, arithmeticIntrinsic(name_[2], false, isUnsigned),
+                                 {value, args[0]->generate(fg)});
+        case BuiltInType::IntegerTruncate:
+            return fg->builder().CreateTrunc(value, fg->typeHelper().llvmTypeFor(expressionType()));
+        case BuiltInType::UnsignedToInteger:
+            return fg->builder().CreateZExt(value, int64);
+        default:
+            return nullptr;
+    }
+}
+
 Value* ASTMethod::buildAddOffsetAddress(FunctionCodeGenerator *fg, llvm::Value *memory, llvm::Value *offset) const {
     auto addOffset = fg->builder().CreateAdd(offset, fg->sizeOf(llvm::Type::getInt8PtrTy(fg->ctx())));
     return fg->builder().CreateGEP(memory, addOffset);
@@ -7,6 +7,7 @@
 //
 
 #include "ASTStatements.hpp"
+#include "Analysis/ConstantEvaluator.hpp"
 #include "Analysis/FunctionAnalyser.hpp"
 #include "Compiler.hpp"
 #include "Functions/FunctionType.hpp"
@@ -40,9 +41,21 @@ void ASTBlock::analyse(FunctionAnalyser *analyser) {
 
 void ASTBlock::analyseMemoryFlow(MFFunctionAnalyser *analyser) {
     auto stop = !returnedCertainly_ ? stmts_.size() : stop_;
+    analyser->enterBlock();
     for (size_t i = 0; i < stop; i++) {
         stmts_[i]->analyseMemoryFlow(analyser);
     }
+    analyser->exitBlock();
+}
+
+bool ASTBlock::evaluate(ConstantEvaluator *evaluator) const {
+    auto stop = !returnedCertainly_ ? stmts_.size() : stop_;
+    for (size_t i = 0; i < stop && !evaluator->returned(); i++) {
+        if (!evaluator->step() || !stmts_[i]->evaluate(evaluator)) {
+            return false;
+        }
+    }
+    return true;
 }
 
 ASTReturn* ASTBlock::getReturn() const {
@@ -68,6 +81,11 @@ void ASTExprStatement::analyseMemoryFlow(MFFunctionAnalyser *analyser) {
     expr_->analyseMemoryFlow(analyser, MFFlowCategory::Borrowing);
 }
 
+bool ASTExprStatement::evaluate(ConstantEvaluator *evaluator) const {
+    ConstantValue value;
+    return expr_->evaluate(evaluator, &value);
+}
+
 void ASTReturn::analyse(FunctionAnalyser *analyser) {
     analyser->pathAnalyser().record(PathAnalyserIncident::Returned);
 
@@ -86,6 +104,10 @@ void ASTReturn::analyse(FunctionAnalyser *analyser) {
         throw CompilerError(position(), "↩️ cannot be used inside an initializer.");
     }
 
+    if (requiresTailCall_ && dynamic_cast<ASTCall *>(value_.get()) == nullptr) {
+        throw CompilerError(position(), "↩️🔁 can only be used to return the value of a call.");
+    }
+
     auto rtType = analyser->function()->returnType()->type();
 
     auto type = analyser->ExpressionAnalyser::analyse(value_);
@@ -140,8 +162,19 @@ void ASTRaise::analyse(FunctionAnalyser *analyser) {
 void ASTReturn::analyseMemoryFlow(MFFunctionAnalyser *analyser) {
     if (value_ != nullptr && !initReturn_) {
         analyser->take(value_.get());
+        analyser->recordVariablesInto(&valueVariables_);
         value_->analyseMemoryFlow(analyser, MFFlowCategory::Return);
+        analyser->recordVariablesInto(nullptr);
+    }
+}
+
+bool ASTReturn::evaluate(ConstantEvaluator *evaluator) const {
+    ConstantValue value;
+    if (value_ == nullptr || initReturn_ || !value_->evaluate(evaluator, &value)) {
+        return false;
     }
+    evaluator->setReturn(std::move(value));
+    return true;
 }
 
 }  // namespace EmojicodeCompiler
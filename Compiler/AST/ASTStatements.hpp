@@ -9,6 +9,7 @@
 #ifndef ASTStatements_hpp
 #define ASTStatements_hpp
 
+#include <set>
 #include <utility>
 #include "Scoping/SemanticScopeStats.hpp"
 #include "ASTExpr.hpp"
@@ -27,6 +28,10 @@ public:
     virtual void generate(FunctionCodeGenerator *) const = 0;
     virtual void analyse(FunctionAnalyser *) = 0;
     virtual void analyseMemoryFlow(MFFunctionAnalyser *) = 0;
+    /// Interprets the statement at compile time. ASTStatement’s implementation returns false, which means that the
+    /// statement cannot be interpreted.
+    /// @see ASTExpr::evaluate
+    virtual bool evaluate(ConstantEvaluator *evaluator) const { return false; }
 
     void setParagraph() { paragraph_ = true; }
     bool paragraph() const { return paragraph_; }
@@ -48,6 +53,7 @@ public:
     void analyse(FunctionAnalyser *analyser) override;
     void generate(FunctionCodeGenerator *) const override;
     void analyseMemoryFlow(MFFunctionAnalyser *analyser) override;
+    bool evaluate(ConstantEvaluator *evaluator) const override;
 
     void toCode(PrettyStream &pretty) const override;
     /// Prints the code that goes between the block delimiters.
@@ -95,6 +101,7 @@ public:
 
     void toCode(PrettyStream &pretty) const override;
     void analyseMemoryFlow(MFFunctionAnalyser *analyser) override;
+    bool evaluate(ConstantEvaluator *evaluator) const override;
 
     ASTExprStatement(std::shared_ptr<ASTExpr> expr, const SourcePosition &p) : ASTStatement(p), expr_(std::move(expr)) {}
 private:
@@ -110,15 +117,33 @@ public:
 
     void toCode(PrettyStream &pretty) const override;
     void analyseMemoryFlow(MFFunctionAnalyser *analyser) override;
+    bool evaluate(ConstantEvaluator *evaluator) const override;
 
     /// Informs the expression that it is used to return the initialized object from an object initializer.
     void setIsInitReturn() { initReturn_ = true; }
+    /// Makes the return statement require that its value is returned by a tail call (↩️🔁). It is an error if the
+    /// call cannot be made a tail call.
+    void setRequiresTailCall() { requiresTailCall_ = true; }
 
 protected:
     void returnReference(FunctionAnalyser *analyser, Type type);
 
     std::shared_ptr<ASTExpr> value_;
     bool initReturn_ = false;
+
+private:
+    bool requiresTailCall_ = false;
+    /// The variables whose values are used by the returned expression. All other variables can be released before
+    /// the value is computed.
+    std::set<size_t> valueVariables_;
+
+    /// Turns the call that computed *value* into a tail call if it is the last instruction and its caller has no more
+    /// obligations after the call than releasing variables that are not used by the returned expression, which are
+    /// then released before the call.
+    /// @returns True if the call was made a tail call. The caller must then return *value* immediately.
+    bool generateTailCall(FunctionCodeGenerator *fg, llvm::Value *value) const;
+    /// Returns the reason why the call that computed *value* cannot be made a tail call or nullptr if it can.
+    const char* tailCallObstacle(FunctionCodeGenerator *fg, llvm::Value *value) const;
 };
 
 class ASTRaise final : public ASTReturn, private ErrorSelfDestructing {
@@ -128,6 +153,7 @@ public:
     void analyse(FunctionAnalyser *analyser) override;
     void generate(FunctionCodeGenerator *) const override;
     void toCode(PrettyStream &pretty) const override;
+    bool evaluate(ConstantEvaluator *evaluator) const override { return false; }
 };
 
 } // namespace EmojicodeCompiler
@@ -13,12 +13,16 @@
 #include "Generation/FunctionCodeGenerator.hpp"
 #include "Scoping/IDScoper.hpp"
 #include "Types/Class.hpp"
+#include "Compiler.hpp"
+#include "CompilerError.hpp"
+#include <llvm/Analysis/ValueTracking.h>
 
 namespace EmojicodeCompiler {
 
 void ASTBlock::generate(FunctionCodeGenerator *fg) const {
     auto stop = !returnedCertainly_ ? stmts_.size() : stop_;
     for (size_t i = 0; i < stop; i++) {
+        fg->setDebugLocation(stmts_[i]->position());
         stmts_[i]->generate(fg);
         fg->releaseTemporaryObjects();
     }
@@ -30,9 +34,19 @@ ASTReturn::ASTReturn(std::shared_ptr<ASTExpr> value, const SourcePosition &p)
 void ASTReturn::generate(FunctionCodeGenerator *fg) const {
     if (value_) {
         auto val = value_->generate(fg);
+        if (generateTailCall(fg, val)) {
+            fg->builder().CreateRet(val);
+            return;
+        }
         fg->releaseTemporaryObjects();
         release(fg);
-        fg->builder().CreateRet(val);
+        if (auto ptr = fg->returnValuePointer()) {
+            fg->builder().CreateStore(val, ptr);
+            fg->builder().CreateRetVoid();
+        }
+        else {
+            fg->builder().CreateRet(val);
+        }
     }
     else {
         release(fg);
@@ -40,6 +54,60 @@ void ASTReturn::generate(FunctionCodeGenerator *fg) const {
     }
 }
 
+const char* ASTReturn::tailCallObstacle(FunctionCodeGenerator *fg, llvm::Value *value) const {
+    auto call = llvm::dyn_cast<llvm::CallInst>(value);
+    if (call == nullptr || call->getParent() != fg->builder().GetInsertBlock() || call->getNextNode() != nullptr) {
+        return "The returned value must be the unconverted value of the call.";
+    }
+    if (fg->returnValuePointer() != nullptr) {
+        return "The value is returned indirectly.";
+    }
+    if (fg->hasTemporaryObjects()) {
+        return "Temporary values must be released after the call.";
+    }
+    if (releasesAnyOf(valueVariables_)) {
+        return "A variable whose value is used by the call must be released after the call.";
+    }
+    auto &dataLayout = fg->builder().GetInsertBlock()->getModule()->getDataLayout();
+    for (auto &arg : call->arg_operands()) {
+        if (llvm::isa<llvm::AllocaInst>(llvm::GetUnderlyingObject(arg, dataLayout))) {
+            return "The call is passed memory on the stack of the caller.";
+        }
+    }
+    return nullptr;
+}
+
+bool ASTReturn::generateTailCall(FunctionCodeGenerator *fg, llvm::Value *value) const {
+    if (auto obstacle = tailCallObstacle(fg, value)) {
+        if (requiresTailCall_) {
+            fg->compiler()->error(CompilerError(position(), "Cannot make tail call. ", obstacle));
+        }
+        return false;
+    }
+
+    auto call = llvm::cast<llvm::CallInst>(value);
+    auto caller = fg->builder().GetInsertBlock()->getParent();
+    // Only a call to a function with the same signature can be guaranteed to reuse the stack frame.
+    if (requiresTailCall_ && (call->getFunctionType() != caller->getFunctionType() ||
+                              call->getCallingConv() != caller->getCallingConv())) {
+        fg->compiler()->error(CompilerError(position(), "Cannot make tail call. The called function must have the "
+                                            "same parameter and return types as this function."));
+        return false;
+    }
+
+    // Release the variables before the call, which must be directly followed by the return instruction.
+    auto block = call->getParent();
+    auto callBlock = block->splitBasicBlock(call, "tailCall");
+    block->getTerminator()->eraseFromParent();
+    fg->builder().SetInsertPoint(block);
+    release(fg);
+    fg->builder().CreateBr(callBlock);
+    fg->builder().SetInsertPoint(callBlock);
+
+    call->setTailCallKind(requiresTailCall_ ? llvm::CallInst::TCK_MustTail : llvm::CallInst::TCK_Tail);
+    return true;
+}
+
 void ASTRaise::generate(FunctionCodeGenerator *fg) const {
     fg->builder().CreateStore(value_->generate(fg), fg->errorPointer());
     fg->releaseTemporaryObjects();
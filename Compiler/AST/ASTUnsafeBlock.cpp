@@ -5,6 +5,7 @@
 #include "ASTUnsafeBlock.hpp"
 #include "Analysis/FunctionAnalyser.hpp"
 #include "CompilerError.hpp"
+#include "Types/TypeExpectation.hpp"
 
 namespace EmojicodeCompiler {
 
@@ -20,4 +21,14 @@ void ASTUnsafeBlock::analyse(FunctionAnalyser *analyser) {
     analyser->setInUnsafeBlock(false);
 }
 
+Type ASTUnsafeExpr::analyse(ExpressionAnalyser *analyser) {
+    auto functionAnalyser = dynamic_cast<FunctionAnalyser *>(analyser);
+    assert(functionAnalyser != nullptr);
+    auto wasInUnsafeBlock = functionAnalyser->isInUnsafeBlock();
+    functionAnalyser->setInUnsafeBlock(true);
+    auto type = analyser->expect(TypeExpectation(false, false), &expr_);
+    functionAnalyser->setInUnsafeBlock(wasInUnsafeBlock);
+    return type;
+}
+
 }  // namespace EmojicodeCompiler
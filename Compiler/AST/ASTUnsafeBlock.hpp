@@ -6,6 +6,7 @@
 #define EMOJICODE_ASTUNSAFEBLOCK_HPP
 
 #include "ASTStatements.hpp"
+#include "ASTUnary.hpp"
 
 namespace EmojicodeCompiler {
 
@@ -25,6 +26,20 @@ private:
     ASTBlock block_;
 };
 
+/// Analyses an expression as if it appeared in a ☣️ block.
+///
+/// This node is only created by the compiler for code it generates, e.g. by ASTForIn to retrieve elements with an
+/// unchecked method after it made sure the index is valid.
+class ASTUnsafeExpr final : public ASTUnaryMFForwarding {
+public:
+    using ASTUnaryMFForwarding::ASTUnaryMFForwarding;
+
+    Type analyse(ExpressionAnalyser *analyser) override;
+    Value* generate(FunctionCodeGenerator *fg) const override { return expr_->generate(fg); }
+
+    void toCode(PrettyStream &pretty) const override;
+};
+
 }  // namespace EmojicodeCompiler
 
 #endif //EMOJICODE_ASTUNSAFEBLOCK_HPP
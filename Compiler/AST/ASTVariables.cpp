@@ -10,6 +10,7 @@
 #include "ASTBinaryOperator.hpp"
 #include "ASTInitialization.hpp"
 #include "ASTType.hpp"
+#include "Analysis/ConstantEvaluator.hpp"
 #include "Analysis/FunctionAnalyser.hpp"
 #include "Generation/FunctionCodeGenerator.hpp"
 #include "MemoryFlowAnalysis/MFFunctionAnalyser.hpp"
@@ -47,10 +48,22 @@ void ASTGetVariable::analyseMemoryFlow(MFFunctionAnalyser *analyser, MFFlowCateg
         returned_ = true;
     }
     if (!inInstanceScope()) {
-        analyser->recordVariableGet(id(), type);
+        analyser->recordVariableGet(id(), type, !reference_ && !isTemporary() ? this : nullptr);
     }
 }
 
+bool ASTGetVariable::evaluate(ConstantEvaluator *evaluator, ConstantValue *value) const {
+    if (inInstanceScope() || reference_) {
+        return false;
+    }
+    auto variable = evaluator->variable(id());
+    if (variable == nullptr) {
+        return false;
+    }
+    *value = *variable;
+    return true;
+}
+
 void ASTGetVariable::mutateReference(ExpressionAnalyser *analyser) {
     analyser->scoper().getVariable(name(), position()).variable.mutate(position());
 }
@@ -65,6 +78,9 @@ Type ASTIsOnlyReference::analyse(ExpressionAnalyser *analyser) {
 }
 
 void ASTIsOnlyReference::analyseMemoryFlow(MFFunctionAnalyser *analyser, MFFlowCategory type) {
+    if (!inInstanceScope()) {
+        analyser->recordVariableGet(id(), MFFlowCategory::Borrowing);
+    }
 }
 
 ASTVariableDeclaration::ASTVariableDeclaration(std::unique_ptr<ASTType> type,
@@ -83,6 +99,15 @@ void ASTVariableDeclaration::analyse(FunctionAnalyser *analyser) {
 
 ASTVariableDeclaration::~ASTVariableDeclaration() = default;
 
+bool ASTVariableInit::evaluate(ConstantEvaluator *evaluator) const {
+    ConstantValue value;
+    if (inInstanceScope() || !expr_->evaluate(evaluator, &value)) {
+        return false;
+    }
+    evaluator->setVariable(id(), std::move(value));
+    return true;
+}
+
 void ASTVariableAssignment::analyse(FunctionAnalyser *analyser) {
     auto rvar = analyser->scoper().getVariable(name(), position());
 
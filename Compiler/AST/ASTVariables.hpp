@@ -31,6 +31,7 @@ public:
 
     void toCode(PrettyStream &pretty) const override;
     void analyseMemoryFlow(MFFunctionAnalyser *) override {}
+    bool evaluate(ConstantEvaluator *evaluator) const override { return true; }
 
     ~ASTVariableDeclaration();
 
@@ -84,14 +85,20 @@ public:
 
     void toCode(PrettyStream &pretty) const override;
     void analyseMemoryFlow(MFFunctionAnalyser *analyser, MFFlowCategory type) override;
+    bool evaluate(ConstantEvaluator *evaluator, ConstantValue *value) const override;
 
     void mutateReference(ExpressionAnalyser *analyser) override;
 
+    /// Informs this node that it is the last use of the variable and that it takes over the variable value, which
+    /// is therefore neither retained by this node nor released at the end of the block that declared the variable.
+    void setMoved() { moved_ = true; }
+
 private:
     bool reference_ = false;
     /// Set to true if the value created by the expression is returned. If it is returned, the value of the variable
     /// must not be retained.
     bool returned_ = false;
+    bool moved_ = false;
 };
 
 class ASTIsOnlyReference final : public ASTExpr, public AccessesAnyVariable {
@@ -109,6 +116,9 @@ public:
 /// Every AST node that potentially initializes a variable, i.e. initializes a value type to its address, inherits
 /// from this class. The act of initializing a variable may occur repeatedly per variable.
 class ASTVariableInit : public ASTStatement, public AccessesAnyVariable {
+public:
+    bool evaluate(ConstantEvaluator *evaluator) const override;
+
 protected:
     ASTVariableInit(std::shared_ptr<ASTExpr> e, const SourcePosition &p, std::u32string name, bool declare)
             : ASTStatement(p), AccessesAnyVariable(std::move(name)), expr_(std::move(e)), declare_(declare) {}
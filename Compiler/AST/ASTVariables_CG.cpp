@@ -69,7 +69,7 @@ Value* ASTGetVariable::generate(FunctionCodeGenerator *fg) const {
 
     auto val = fg->builder().CreateLoad(localVariable);
     setTbaaMetadata(fg, val);
-    if (!returned_ && !isTemporary() && expressionType().isManaged()) {
+    if (!returned_ && !moved_ && !isTemporary() && expressionType().isManaged()) {
         fg->retain(fg->isManagedByReference(expressionType()) ? localVariable : val, expressionType());
         handleResult(fg, val);  // See above
     }
@@ -8,6 +8,7 @@
 #include "Releasing.hpp"
 #include "Generation/FunctionCodeGenerator.hpp"
 #include "ASTMemory.hpp"
+#include <algorithm>
 
 namespace EmojicodeCompiler {
 
@@ -22,4 +23,10 @@ void Releasing::release(FunctionCodeGenerator *fg) const {
     }
 }
 
+bool Releasing::releasesAnyOf(const std::set<size_t> &variables) const {
+    return std::any_of(releases_.begin(), releases_.end(), [&variables](auto &release) {
+        return variables.count(release->id()) > 0;
+    });
+}
+
 }
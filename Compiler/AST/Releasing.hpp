@@ -8,8 +8,9 @@
 #ifndef Releasing_hpp
 #define Releasing_hpp
 
-#include <vector>
 #include <memory>
+#include <set>
+#include <vector>
 
 namespace EmojicodeCompiler {
 
@@ -35,6 +36,8 @@ protected:
     /// Release all temporary objects and all variables in this scope. To be called before the method ultimately returns
     /// but after the return value has been evaluated.
     void release(FunctionCodeGenerator *fg) const;
+    /// Returns true if any of the release statements releases one of the variables with the IDs in *variables*.
+    bool releasesAnyOf(const std::set<size_t> &variables) const;
 
 private:
     std::vector<std::unique_ptr<ASTRelease>> releases_;
@@ -0,0 +1,53 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "ConstantEvaluator.hpp"
+#include "AST/ASTStatements.hpp"
+#include "Functions/Function.hpp"
+#include "Functions/FunctionType.hpp"
+#include "Types/TypeDefinition.hpp"
+
+namespace EmojicodeCompiler {
+
+bool ConstantEvaluator::evaluate(const ASTExpr *expr, ConstantValue *value) {
+    frames_.emplace_back();
+    auto evaluated = expr->evaluate(this, value);
+    frames_.pop_back();
+    return evaluated;
+}
+
+bool ConstantEvaluator::canCall(Function *function) {
+    return isTypeMethod(function) && !function->isExternal() && function->ast() != nullptr && !function->unsafe() &&
+           !function->errorProne() && function->genericParameters().empty() &&
+           !function->owner()->storesGenericArgs();
+}
+
+bool ConstantEvaluator::call(Function *function, std::vector<ConstantValue> arguments, ConstantValue *value) {
+    if (frames_.size() >= kMaxDepth || !canCall(function) || function->parameters().size() != arguments.size()) {
+        return false;
+    }
+    frames_.emplace_back();
+    for (size_t i = 0; i < arguments.size(); i++) {
+        setVariable(i, std::move(arguments[i]));
+    }
+    auto evaluated = function->ast()->evaluate(this) && returned();
+    if (evaluated) {
+        *value = std::move(frames_.back().returnValue);
+    }
+    frames_.pop_back();
+    return evaluated;
+}
+
+const ConstantValue* ConstantEvaluator::variable(VariableID id) const {
+    auto &variables = frames_.back().variables;
+    auto it = variables.find(id);
+    return it != variables.end() ? &it->second : nullptr;
+}
+
+void ConstantEvaluator::setReturn(ConstantValue value) {
+    frames_.back().returnValue = std::move(value);
+    frames_.back().returned = true;
+}
+
+}  // namespace EmojicodeCompiler
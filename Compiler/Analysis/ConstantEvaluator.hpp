@@ -0,0 +1,106 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#ifndef EMOJICODE_CONSTANTEVALUATOR_HPP
+#define EMOJICODE_CONSTANTEVALUATOR_HPP
+
+#include "Scoping/Variable.hpp"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace EmojicodeCompiler {
+
+class ASTExpr;
+class Compiler;
+class Function;
+
+/// A value computed at compile time by ConstantEvaluator.
+struct ConstantValue {
+    enum class Kind {
+        /// A 🔢 stored in ::integer.
+        Integer,
+        /// A 💧 stored sign-extended in ::integer.
+        Byte,
+        Real,
+        Boolean,
+        String,
+    };
+
+    ConstantValue() = default;
+    ConstantValue(Kind kind, int64_t integer) : kind(kind), integer(integer) {}
+    explicit ConstantValue(double real) : kind(Kind::Real), real(real) {}
+    explicit ConstantValue(bool boolean) : kind(Kind::Boolean), boolean(boolean) {}
+    explicit ConstantValue(std::u32string string) : kind(Kind::String), string(std::move(string)) {}
+
+    Kind kind = Kind::Integer;
+    int64_t integer = 0;
+    double real = 0;
+    bool boolean = false;
+    std::u32string string;
+};
+
+/// Evaluates expressions at compile time by interpreting their syntax tree.
+///
+/// Only nodes that override ASTExpr::evaluate or ASTStatement::evaluate can be evaluated: literals, local variables,
+/// the built-in operations of 🔢, 💧, 💯 and 👌, string interpolation, ↪️, 🔁 and statically dispatched calls of type
+/// methods whose bodies consist of such nodes only. Functions that perform I/O, use ☣️ or are external contain other
+/// nodes or no syntax tree and are therefore never evaluated, so every function that can be evaluated is pure.
+///
+/// The number of steps and the depth of calls are limited, so that evaluating a function that does not terminate or
+/// computes for long does not stall the compiler. The evaluation is given up in this case and the code is generated
+/// normally.
+class ConstantEvaluator {
+public:
+    explicit ConstantEvaluator(Compiler *compiler) : compiler_(compiler) {}
+
+    /// Evaluates *expr* outside of any function, i.e. without access to variables.
+    /// @returns True and sets *value* if *expr* is constant.
+    bool evaluate(const ASTExpr *expr, ConstantValue *value);
+
+    /// Interprets *function*, which must be a type method, with the provided arguments.
+    /// @returns True and sets *value* to the returned value if the function could be interpreted.
+    bool call(Function *function, std::vector<ConstantValue> arguments, ConstantValue *value);
+
+    /// Returns false if call() never interprets *function*, whatever the arguments. The syntax tree of such a function
+    /// is not needed anymore once its code has been generated.
+    static bool canCall(Function *function);
+
+    /// Must be called for every statement and loop iteration that is interpreted.
+    /// @returns False if the step limit was exceeded and the evaluation must be given up.
+    bool step() { return ++steps_ <= kMaxSteps; }
+
+    /// Returns the value of the variable in the function being interpreted, or nullptr if no value was assigned to
+    /// the variable yet.
+    const ConstantValue* variable(VariableID id) const;
+    void setVariable(VariableID id, ConstantValue value) { frames_.back().variables[id] = std::move(value); }
+
+    /// Makes the function being interpreted return *value*.
+    void setReturn(ConstantValue value);
+    /// Whether the function being interpreted executed a return statement. No more statements must be interpreted
+    /// if this is the case.
+    bool returned() const { return frames_.back().returned; }
+
+    Compiler* compiler() const { return compiler_; }
+
+private:
+    static constexpr size_t kMaxSteps = 100000;
+    static constexpr size_t kMaxDepth = 64;
+
+    struct Frame {
+        std::map<VariableID, ConstantValue> variables;
+        ConstantValue returnValue;
+        bool returned = false;
+    };
+
+    Compiler *compiler_;
+    std::vector<Frame> frames_;
+    size_t steps_ = 0;
+};
+
+}  // namespace EmojicodeCompiler
+
+#endif  // EMOJICODE_CONSTANTEVALUATOR_HPP
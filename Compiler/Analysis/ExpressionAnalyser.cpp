@@ -199,7 +199,7 @@ Type ExpressionAnalyser::box(Type exprType, const TypeExpectation &expectation,
 
     switch (expectation.simplifyType(exprType)) {
         case StorageType::SimpleOptional:
-        case StorageType::PointerOptional:
+        case StorageType::NicheOptional:
             makeIntoSimpleOptional(exprType, node);
             break;
         case StorageType::Box:
@@ -215,7 +215,7 @@ Type ExpressionAnalyser::box(Type exprType, const TypeExpectation &expectation,
 void ExpressionAnalyser::makeIntoSimpleOptional(Type &exprType, std::shared_ptr<ASTExpr> *node) const {
     switch (exprType.storageType()) {
         case StorageType::SimpleOptional:
-        case StorageType::PointerOptional:
+        case StorageType::NicheOptional:
             break;
         case StorageType::Box:
             exprType = (*node)->expressionType().unboxed().optionalized();
@@ -253,7 +253,7 @@ void ExpressionAnalyser::makeIntoBox(Type &exprType, const TypeExpectation &expe
             }
             break;
         case StorageType::SimpleOptional:
-        case StorageType::PointerOptional:
+        case StorageType::NicheOptional:
             exprType = exprType.boxedFor(expectation.boxFor());
             insertNode<ASTSimpleOptionalToBox>(node, exprType);
             break;
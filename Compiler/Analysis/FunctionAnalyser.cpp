@@ -98,11 +98,12 @@ void FunctionAnalyser::analyse() {
 void FunctionAnalyser::analyseBabyBottle() {
     auto initializer = dynamic_cast<Initializer *>(function_);
     for (auto &var : initializer->argumentsToVariables()) {
-        if (!scoper_->instanceScope()->hasLocalVariable(var)) {
+        auto instanceVariablePtr = scoper_->instanceScope()->findLocalVariable(var);
+        if (instanceVariablePtr == nullptr) {
             throw CompilerError(initializer->position(), "🍼 was applied to \"", utf8(var),
                                 "\" but no matching instance variable was found.");
         }
-        auto &instanceVariable = scoper_->instanceScope()->getLocalVariable(var);
+        auto &instanceVariable = *instanceVariablePtr;
         auto &argumentVariable = scoper_->currentScope().getLocalVariable(var);
         if (!argumentVariable.type().compatibleTo(instanceVariable.type(), typeContext_)) {
             throw CompilerError(initializer->position(), "🍼 was applied to \"",
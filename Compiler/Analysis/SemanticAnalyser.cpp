@@ -9,11 +9,16 @@
 #include "Scoping/SemanticScoper.hpp"
 #include "Types/TypeExpectation.hpp"
 #include "Package/Package.hpp"
+#include "SerializationBuilder.hpp"
 #include "ThunkBuilder.hpp"
 #include "Types/Class.hpp"
 #include "Types/Protocol.hpp"
 #include "Types/TypeDefinition.hpp"
 #include "Types/ValueType.hpp"
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace EmojicodeCompiler {
 
@@ -42,6 +47,9 @@ void SemanticAnalyser::analyse(bool executable) {
         });
     }
     for (auto &vt : package_->valueTypes()) {
+        if (!imported_) {
+            buildSerialization(vt.get());
+        }
         enqueueFunctionsOfTypeDefinition(vt.get());
         checkProtocolConformance(Type(vt.get()));
         declareInstanceVariables(Type(vt.get()));
@@ -87,6 +95,10 @@ void SemanticAnalyser::checkStartFlagFunction(bool executable) {
 }
 
 void SemanticAnalyser::analyseQueue() {
+    if (jobs_ > 1) {
+        analyseQueueInParallel();
+        return;
+    }
     while (!queue_.empty()) {
         try {
             FunctionAnalyser(queue_.front(), this).analyse();
@@ -98,6 +110,54 @@ void SemanticAnalyser::analyseQueue() {
     }
 }
 
+void SemanticAnalyser::analyseQueueInParallel() {
+    std::vector<std::pair<size_t, CompilerError>> errors;
+    size_t next = 0;
+    size_t busy = 0;
+
+    auto work = [&] {
+        std::unique_lock<std::mutex> lock(queueMutex_);
+        while (true) {
+            // Functions being analysed may enqueue further functions, so the queue is only drained if it is empty
+            // and no thread is busy.
+            queueCondition_.wait(lock, [&] { return !queue_.empty() || busy == 0; });
+            if (queue_.empty()) {
+                queueCondition_.notify_all();
+                return;
+            }
+            auto function = queue_.front();
+            queue_.pop();
+            auto index = next++;
+            busy++;
+            lock.unlock();
+            try {
+                FunctionAnalyser(function, this).analyse();
+                lock.lock();
+            }
+            catch (CompilerError &ce) {
+                lock.lock();
+                errors.emplace_back(index, ce);
+            }
+            busy--;
+            queueCondition_.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < jobs_; i++) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    std::sort(errors.begin(), errors.end(), [](auto &a, auto &b) { return a.first < b.first; });
+    for (auto &error : errors) {
+        package_->compiler()->error(error.second);
+    }
+}
+
 void SemanticAnalyser::enqueueFunctionsOfTypeDefinition(TypeDefinition *typeDef) {
     typeDef->eachFunction([this](Function *function) {
         enqueueFunction(function);
@@ -107,7 +167,9 @@ void SemanticAnalyser::enqueueFunctionsOfTypeDefinition(TypeDefinition *typeDef)
 void SemanticAnalyser::enqueueFunction(Function *function) {
     analyseFunctionDeclaration(function);
     if (!function->isExternal()) {
+        std::lock_guard<std::mutex> lock(queueMutex_);
         queue_.emplace(function);
+        queueCondition_.notify_one();
     }
 }
 
@@ -126,6 +188,16 @@ void SemanticAnalyser::analyseFunctionDeclaration(Function *function) const {
         throw CompilerError(function->errorType()->position(), "Error type must be a subclass of 🚧.");
     }
 
+    if (!function->externalName().empty() && !function->isExternal()) {
+        if (!function->genericParameters().empty() ||
+            (function->owner() != nullptr && !function->owner()->genericParameters().empty())) {
+            throw CompilerError(function->position(), "A function with an external name cannot be generic.");
+        }
+        if (function->errorProne()) {
+            throw CompilerError(function->position(), "A function with an external name cannot be error-prone.");
+        }
+    }
+
     function->analyseConstraints(context);
     for (auto &param : function->parameters()) {
         param.type->analyseType(context);
@@ -135,6 +207,19 @@ void SemanticAnalyser::analyseFunctionDeclaration(Function *function) const {
         }
     }
     function->returnType()->analyseType(context, true);
+    if (function->isPure()) {
+        if (!function->isExternal() || function->externalName().empty()) {
+            throw CompilerError(function->position(), "🧼 can only be applied to functions declared with 📻.");
+        }
+        if (function->errorProne() || (function->functionType() == FunctionType::ValueTypeMethod &&
+                                       function->mutating())) {
+            throw CompilerError(function->position(), "🧼 functions cannot be mutating or error-prone.");
+        }
+        if (function->returnType()->type().isManaged()) {
+            // Merging two calls would otherwise leave two references with a single retain.
+            throw CompilerError(function->position(), "🧼 functions cannot return reference-counted values.");
+        }
+    }
 }
 
 void SemanticAnalyser::declareInstanceVariables(const Type &type) {
@@ -195,7 +280,7 @@ std::unique_ptr<Function> SemanticAnalyser::enforcePromises(Function *sub, Funct
 
     bool isReturnOk = checkReturnPromise(sub, subContext, super, superContext, superSource);
     bool isParamsOk = checkArgumentPromise(sub, super, subContext, superContext) ;
-    if (!isParamsOk || !isReturnOk) {
+    if (!isParamsOk || !isReturnOk || sub->passesThisByValue()) {
         auto thunk = buildBoxingThunk(superContext, super, sub);
         enqueueFunction(thunk.get());  // promises are enforced after calls to enqueueFunctionsOfTypeDefinition
         return thunk;
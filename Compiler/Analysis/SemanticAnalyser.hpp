@@ -5,8 +5,10 @@
 #ifndef EMOJICODE_SEMANTICANALYSER_HPP
 #define EMOJICODE_SEMANTICANALYSER_HPP
 
-#include <queue>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <queue>
 
 namespace EmojicodeCompiler {
 
@@ -23,7 +25,9 @@ struct SourcePosition;
 /// Manages the semantic analysis of a package.
 class SemanticAnalyser {
 public:
-    explicit SemanticAnalyser(Package *package, bool imported) : package_(package), imported_(imported) {}
+    /// @param jobs The number of threads on which function bodies are analysed.
+    explicit SemanticAnalyser(Package *package, bool imported, unsigned jobs = 1)
+        : package_(package), imported_(imported), jobs_(jobs) {}
 
     /// Analyses the package.
     /// @throws CompilerError if an unrecoverable error occurs, e.g. if the start flag function is not present but
@@ -32,6 +36,8 @@ public:
     /// flag function be present.
     void analyse(bool executable);
 
+    /// Analyses the declaration of the function and enqueues its body for analysis. Can be called from any thread
+    /// that is analysing a function body.
     void enqueueFunction(Function *);
 
     /// Iff `type` is a literal type, returns the default inferred type for the literal type. Otherwise the type is
@@ -51,6 +57,9 @@ public:
 
 private:
     void analyseQueue();
+    /// Analyses the function bodies in the queue on `jobs_` threads. Errors are reported in the order in which the
+    /// functions were enqueued, once all bodies have been analysed.
+    void analyseQueueInParallel();
     void enqueueFunctionsOfTypeDefinition(TypeDefinition *typeDef);
     void finalizeProtocols(const Type &type);
     void checkProtocolConformance(const Type &type);
@@ -60,6 +69,10 @@ private:
     Package *package_;
     std::queue<Function *> queue_;
     bool imported_;
+    unsigned jobs_;
+    /// Guards `queue_` while analyseQueueInParallel() runs.
+    std::mutex queueMutex_;
+    std::condition_variable queueCondition_;
 
     bool checkArgumentPromise(const Function *sub, const Function *super, const TypeContext &subContext,
                                   const TypeContext &superContext) const;
@@ -0,0 +1,352 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "SerializationBuilder.hpp"
+#include "AST/ASTConditionalAssignment.hpp"
+#include "AST/ASTControlFlow.hpp"
+#include "AST/ASTInitialization.hpp"
+#include "AST/ASTLiterals.hpp"
+#include "AST/ASTMethod.hpp"
+#include "AST/ASTTypeExpr.hpp"
+#include "AST/ASTUnary.hpp"
+#include "AST/ASTVariables.hpp"
+#include "Compiler.hpp"
+#include "Functions/Initializer.hpp"
+#include "Package/Package.hpp"
+#include "Parsing/AbstractParser.hpp"
+#include "Types/Class.hpp"
+#include "Types/Protocol.hpp"
+#include "Types/TypeContext.hpp"
+#include "Types/ValueType.hpp"
+#include <algorithm>
+#include <memory>
+#include <string>
+
+namespace EmojicodeCompiler {
+
+namespace {
+
+/// A format in which the builder can serialize value types.
+struct Format {
+    /// The protocol for which the builder provides the method. Its name is also the name of the method and of the
+    /// initializer.
+    Protocol *protocol;
+    Class *encoder;
+    Class *decoder;
+    Class *error;
+    /// The method of the encoder that begins the instance variables.
+    std::u32string begin;
+    /// Whether every instance variable is preceded by its name and every collection is ended with 🔚. The decoder
+    /// then looks up the instance variables by their names.
+    bool keyed;
+    /// Whether 📇 can be written.
+    bool data;
+};
+
+class SerializationBuilder {
+public:
+    SerializationBuilder(ValueType *valueType, Format format, const SourcePosition &p)
+        : valueType_(valueType), compiler_(valueType->package()->compiler()), format_(std::move(format)), p_(p),
+          name_(format_.protocol->name()), encoder_(parameterName(U"encoder")), decoder_(parameterName(U"decoder")) {}
+
+    void build() {
+        auto encode = std::make_unique<ASTBlock>(p_);
+        auto decode = std::make_unique<ASTBlock>(p_);
+        auto fields = static_cast<int64_t>(valueType_->instanceVariables().size());
+        encode->appendNode(statement(call(format_.begin, encoder_, { number(fields) })));
+        decode->appendNode(statement(reraise(call(name_, decoder_, { number(fields) }))));
+
+        auto context = TypeContext(Type(valueType_));
+        for (auto &var : valueType_->instanceVariables()) {
+            auto &type = var.type->analyseType(context);
+            if (!canSerialize(type)) {
+                compiler_->error(CompilerError(var.position, "Instance variable ", utf8(var.name), " of type ",
+                                               type.toString(context), " cannot be serialized for ",
+                                               utf8(name_), "."));
+                return;
+            }
+            if (format_.keyed) {
+                encode->appendNode(statement(call(U"🏷", encoder_, { string(var.name) })));
+                decode->appendNode(statement(call(U"🏷", decoder_, { string(var.name) })));
+            }
+            encodeValue(encode.get(), var.name, type);
+            decode->appendNode(std::make_unique<ASTVariableAssignment>(var.name, decodeValue(decode.get(), type),
+                                                                       p_));
+        }
+        end(encode.get(), encoder_);
+        end(decode.get(), decoder_);
+
+        auto method = std::make_unique<Function>(name_, AccessLevel::Public, true, valueType_, valueType_->package(),
+                                                 p_, false, std::u32string(), false, false, Mood::Imperative, false,
+                                                 FunctionType::ValueTypeMethod, false);
+        std::vector<Parameter> params;
+        params.emplace_back(encoder_, std::make_unique<ASTLiteralType>(Type(format_.encoder)),
+                            MFFlowCategory::Borrowing);
+        method->setParameters(std::move(params));
+        method->setReturnType(std::make_unique<ASTLiteralType>(Type::noReturn()));
+        method->setAst(std::move(encode));
+        valueType_->methods().add(std::move(method));
+
+        auto init = std::make_unique<Initializer>(name_, AccessLevel::Public, true, valueType_,
+                                                  valueType_->package(), p_, false, std::u32string(), false, false,
+                                                  false, FunctionType::ValueTypeInitializer, false);
+        std::vector<Parameter> initParams;
+        initParams.emplace_back(decoder_, std::make_unique<ASTLiteralType>(Type(format_.decoder)),
+                                MFFlowCategory::Borrowing);
+        init->setParameters(std::move(initParams));
+        init->setErrorType(std::make_unique<ASTLiteralType>(Type(format_.error)));
+        init->setAst(std::move(decode));
+        valueType_->inits().add(std::move(init));
+    }
+
+private:
+    ValueType *valueType_;
+    Compiler *compiler_;
+    Format format_;
+    SourcePosition p_;
+    /// The name of the method and the initializer, which is the name of the protocol.
+    std::u32string name_;
+    std::u32string encoder_;
+    std::u32string decoder_;
+    /// Used to name temporary variables. The names begin with the name of the protocol so that they cannot collide
+    /// with variables declared in source code.
+    int variables_ = 0;
+
+    /// Returns *name*, to which underscores are appended as long as an instance variable has the same name.
+    std::u32string parameterName(std::u32string name) const {
+        auto &vars = valueType_->instanceVariables();
+        while (std::any_of(vars.begin(), vars.end(), [&name](auto &var) { return var.name == name; })) {
+            name.push_back('_');
+        }
+        return name;
+    }
+
+    std::u32string temporary() {
+        auto number = std::to_string(++variables_);
+        return name_ + std::u32string(number.begin(), number.end());
+    }
+
+    bool isValueType(const Type &type, ValueType *valueType) const {
+        return type.type() == TypeType::ValueType && type.valueType() == valueType;
+    }
+
+    bool isClass(const Type &type, Class *klass) const {
+        return type.type() == TypeType::Class && type.klass() == klass;
+    }
+
+    /// Returns the name of the methods of the encoder and decoder that encode and decode *type*, or an empty string.
+    std::u32string primitiveName(const Type &type) const {
+        if (isValueType(type, compiler_->sInteger)) return U"🔢";
+        if (isValueType(type, compiler_->sReal)) return U"💯";
+        if (isValueType(type, compiler_->sBoolean)) return U"👌";
+        if (isClass(type, compiler_->sString)) return U"🔡";
+        if (format_.data && isClass(type, compiler_->sData)) return U"📇";
+        return std::u32string();
+    }
+
+    bool isSerializable(const Type &type) const {
+        return type.type() == TypeType::ValueType &&
+               type.compatibleTo(Type(format_.protocol), TypeContext(Type(valueType_)));
+    }
+
+    bool canSerialize(const Type &type) const {
+        auto unboxed = type.unboxed();
+        if (unboxed.type() == TypeType::Optional) {
+            return unboxed.optionalType().unboxed().type() != TypeType::Optional && canSerialize(unboxed.optionalType());
+        }
+        if (isValueType(unboxed, compiler_->sList) || isValueType(unboxed, compiler_->sDictionary)) {
+            return canSerialize(unboxed.genericArguments()[0]);
+        }
+        return !primitiveName(unboxed).empty() || isSerializable(unboxed);
+    }
+
+    std::shared_ptr<ASTExpr> variable(const std::u32string &name) const {
+        return std::make_shared<ASTGetVariable>(name, p_);
+    }
+
+    std::shared_ptr<ASTExpr> number(int64_t value) const {
+        auto string = std::to_string(value);
+        return std::make_shared<ASTNumberLiteral>(value, std::u32string(string.begin(), string.end()), p_);
+    }
+
+    std::shared_ptr<ASTExpr> string(const std::u32string &value) const {
+        return std::make_shared<ASTStringLiteral>(value, p_);
+    }
+
+    std::shared_ptr<ASTExpr> call(const std::u32string &name, const std::u32string &callee,
+                                  std::vector<std::shared_ptr<ASTExpr>> args, Mood mood = Mood::Imperative) const {
+        auto arguments = ASTArguments(p_, std::move(args));
+        arguments.setMood(mood);
+        return std::make_shared<ASTMethod>(name, variable(callee), arguments, p_);
+    }
+
+    std::shared_ptr<ASTExpr> reraise(std::shared_ptr<ASTExpr> expr) const {
+        return std::make_shared<ASTReraise>(std::move(expr), p_);
+    }
+
+    std::shared_ptr<ASTExpr> initialization(const std::u32string &name, const Type &type,
+                                            std::vector<std::shared_ptr<ASTExpr>> args) const {
+        auto typeExpr = std::make_shared<ASTStaticType>(std::make_unique<ASTLiteralType>(type), p_);
+        return std::make_shared<ASTInitialization>(name, typeExpr, ASTArguments(p_, std::move(args)), p_);
+    }
+
+    std::unique_ptr<ASTStatement> statement(std::shared_ptr<ASTExpr> expr) const {
+        return std::make_unique<ASTExprStatement>(std::move(expr), p_);
+    }
+
+    /// Appends a call of 🔚 on *callee* to *block* if the format is keyed.
+    void end(ASTBlock *block, const std::u32string &callee) const {
+        if (format_.keyed) {
+            block->appendNode(statement(call(U"🔚", callee, {})));
+        }
+    }
+
+    /// Appends statements to *block* that write the value of the variable *name* of type *type*.
+    void encodeValue(ASTBlock *block, const std::u32string &name, const Type &type) {
+        auto unboxed = type.unboxed();
+        auto primitive = primitiveName(unboxed);
+        if (!primitive.empty()) {
+            block->appendNode(statement(call(primitive, encoder_, { variable(name) })));
+        }
+        else if (unboxed.type() == TypeType::Optional) {
+            auto value = temporary();
+            auto ifStmt = std::make_unique<ASTIf>(p_);
+            ifStmt->addCondition(std::make_shared<ASTConditionalAssignment>(value, variable(name), p_));
+            auto some = ASTBlock(p_);
+            encodeValue(&some, value, unboxed.optionalType());
+            ifStmt->addBlock(std::move(some));
+            auto none = ASTBlock(p_);
+            none.appendNode(statement(call(U"🕳", encoder_, {})));
+            ifStmt->addBlock(std::move(none));
+            block->appendNode(std::move(ifStmt));
+        }
+        else if (isValueType(unboxed, compiler_->sList)) {
+            block->appendNode(statement(call(U"🍨", encoder_, { call(U"📏", name, {}, Mood::Interogative) })));
+            auto element = temporary();
+            auto body = ASTBlock(p_);
+            encodeValue(&body, element, unboxed.genericArguments()[0]);
+            block->appendNode(std::make_unique<ASTForIn>(variable(name), element, std::move(body), p_));
+            end(block, encoder_);
+        }
+        else if (isValueType(unboxed, compiler_->sDictionary)) {
+            block->appendNode(statement(call(U"🍯", encoder_, { call(U"📏", name, {}, Mood::Interogative) })));
+            auto key = temporary();
+            auto value = temporary();
+            auto body = ASTBlock(p_);
+            body.appendNode(statement(call(U"🔡", encoder_, { variable(key) })));
+            auto ifStmt = std::make_unique<ASTIf>(p_);
+            ifStmt->addCondition(std::make_shared<ASTConditionalAssignment>(value, call(U"🐽", name,
+                                                                                        { variable(key) }), p_));
+            auto some = ASTBlock(p_);
+            encodeValue(&some, value, unboxed.genericArguments()[0]);
+            ifStmt->addBlock(std::move(some));
+            body.appendNode(std::move(ifStmt));
+            block->appendNode(std::make_unique<ASTForIn>(call(U"🐙", name, {}), key, std::move(body), p_));
+            end(block, encoder_);
+        }
+        else {
+            block->appendNode(statement(call(name_, name, { variable(encoder_) })));
+        }
+    }
+
+    /// Returns an expression that reads a value of type *type*. Statements needed to read the value are appended to
+    /// *block*.
+    std::shared_ptr<ASTExpr> decodeValue(ASTBlock *block, const Type &type) {
+        auto unboxed = type.unboxed();
+        auto primitive = primitiveName(unboxed);
+        if (!primitive.empty()) {
+            return reraise(call(primitive, decoder_, {}));
+        }
+        if (unboxed.type() == TypeType::Optional) {
+            auto value = temporary();
+            block->appendNode(std::make_unique<ASTVariableDeclaration>(std::make_unique<ASTLiteralType>(unboxed),
+                                                                       value, p_));
+            auto ifStmt = std::make_unique<ASTIf>(p_);
+            ifStmt->addCondition(call(U"🕳", decoder_, {}, Mood::Interogative));
+            ifStmt->addBlock(ASTBlock(p_));
+            auto some = ASTBlock(p_);
+            auto expr = decodeValue(&some, unboxed.optionalType());
+            some.appendNode(std::make_unique<ASTVariableAssignment>(value, expr, p_));
+            ifStmt->addBlock(std::move(some));
+            block->appendNode(std::move(ifStmt));
+            return variable(value);
+        }
+        if (isValueType(unboxed, compiler_->sList) || isValueType(unboxed, compiler_->sDictionary)) {
+            auto isList = isValueType(unboxed, compiler_->sList);
+            auto count = temporary();
+            auto collection = temporary();
+            block->appendNode(std::make_unique<ASTConstantVariable>(count, reraise(call(isList ? U"🍨" : U"🍯",
+                                                                                        decoder_, {})), p_));
+            block->appendNode(std::make_unique<ASTVariableDeclareAndAssign>(collection, initialization(
+                    U"🐴", unboxed, { variable(count) }), p_));
+            auto body = ASTBlock(p_);
+            if (isList) {
+                auto element = decodeValue(&body, unboxed.genericArguments()[0]);
+                body.appendNode(statement(call(U"🐻", collection, { element })));
+            }
+            else {
+                auto key = temporary();
+                body.appendNode(std::make_unique<ASTConstantVariable>(key, reraise(call(U"🔡", decoder_, {})), p_));
+                auto element = decodeValue(&body, unboxed.genericArguments()[0]);
+                body.appendNode(statement(call(U"🐽", collection, { element, variable(key) }, Mood::Assignment)));
+            }
+            auto range = initialization(kDefaultInitName, Type(compiler_->sRange), { number(0), variable(count) });
+            block->appendNode(std::make_unique<ASTForIn>(range, temporary(), std::move(body), p_));
+            end(block, decoder_);
+            return variable(collection);
+        }
+        return reraise(initialization(name_, unboxed, { variable(decoder_) }));
+    }
+};
+
+/// Stores the format of the json package in *format* if *protocol* is its 🌼.
+bool jsonFormat(Protocol *protocol, Format *format) {
+    auto package = protocol->package();
+    if (protocol->name() != U"🌼" || package->name() != "json") return false;
+    auto lookup = [package](const std::u32string &name) {
+        Type type = Type::noReturn();
+        package->lookupRawType(TypeIdentifier(name, kDefaultNamespace, SourcePosition()), &type);
+        return type.type() == TypeType::Class ? type.klass() : nullptr;
+    };
+    *format = Format{ protocol, lookup(U"🖋"), lookup(U"🔖"), lookup(U"🚧🔸🌸"), U"🌼", true, false };
+    return format->encoder != nullptr && format->decoder != nullptr && format->error != nullptr;
+}
+
+/// Stores the format of *protocol* in *format* if the builder can provide conformance to *protocol*.
+bool formatFor(Protocol *protocol, Compiler *compiler, Format *format) {
+    if (protocol == compiler->sSerializable) {
+        *format = Format{ protocol, compiler->sEncoder, compiler->sDecoder, compiler->sDecodingError, U"🍨", false,
+                          true };
+        return true;
+    }
+    return jsonFormat(protocol, format);
+}
+
+}  // namespace
+
+void buildSerialization(ValueType *valueType) {
+    auto compiler = valueType->package()->compiler();
+    if (compiler->sSerializable == nullptr) return;
+
+    for (auto &conformance : valueType->protocols()) {
+        auto type = conformance.type->type().unboxed();
+        Format format;
+        if (type.type() != TypeType::Protocol || !formatFor(type.protocol(), compiler, &format)) continue;
+
+        auto &methods = valueType->methods().list();
+        auto name = format.protocol->name();
+        if (std::any_of(methods.begin(), methods.end(), [&name](Function *method) { return method->name() == name; })) {
+            continue;
+        }
+        if (!valueType->genericParameters().empty()) {
+            compiler->error(CompilerError(conformance.type->position(), "Conformance to ", utf8(name),
+                                          " cannot be provided for generic types. Implement ", utf8(name),
+                                          " and 🆕 ▶️", utf8(name), " instead."));
+            continue;
+        }
+        SerializationBuilder(valueType, std::move(format), conformance.type->position()).build();
+    }
+}
+
+}  // namespace EmojicodeCompiler
@@ -0,0 +1,24 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#ifndef EMOJICODE_SERIALIZATIONBUILDER_HPP
+#define EMOJICODE_SERIALIZATIONBUILDER_HPP
+
+namespace EmojicodeCompiler {
+
+class ValueType;
+
+/// Provides the method 🧬 and the initializer 🆕 ▶️🧬 for a value type that declares conformance to 🧬 but does not
+/// implement 🧬 itself. The functions encode and decode the instance variables in the order of their declaration.
+///
+/// The same is done for 🌼 of the json package, whose functions write the instance variables as the members of a JSON
+/// object and look them up by their names when decoding.
+///
+/// Must be called after the protocols of all types were finalized and before the functions of the value type are
+/// enqueued for analysis.
+void buildSerialization(ValueType *valueType);
+
+}  // namespace EmojicodeCompiler
+
+#endif  // EMOJICODE_SERIALIZATIONBUILDER_HPP
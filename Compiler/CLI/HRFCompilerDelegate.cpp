@@ -10,6 +10,8 @@
 #include "Lex/SourcePosition.hpp"
 #include "Utils/rang.hpp"
 #include "CompilerError.hpp"
+#include <algorithm>
+#include <iomanip>
 
 namespace EmojicodeCompiler {
 
@@ -35,6 +37,36 @@ void HRFCompilerDelegate::error(Compiler *compiler, const CompilerError &ce) {
     }
 }
 
+void HRFCompilerDelegate::measured(const Measurement &measurement) {
+    measurements_.emplace_back(measurement);
+}
+
+void HRFCompilerDelegate::finish() {
+    if (!measurements_.empty()) {
+        printMeasurements();
+        measurements_.clear();
+    }
+}
+
+void HRFCompilerDelegate::printMeasurements() {
+    std::stable_sort(measurements_.begin(), measurements_.end(), [](auto &a, auto &b) {
+        return a.start < b.start || (a.start == b.start && a.depth < b.depth);
+    });
+    std::cerr << rang::style::bold << "⏱  " << std::left << std::setw(34) << "phase" << std::right << std::setw(10)
+              << "wall (s)" << std::setw(10) << "CPU (s)" << std::setw(14) << "peak (MiB)" << rang::style::reset
+              << std::endl;
+    for (auto &measurement : measurements_) {
+        auto name = std::string(measurement.depth * 2, ' ') + measurement.name;
+        // Pad by code points, as the names of packages contain emojis.
+        auto length = std::count_if(name.begin(), name.end(), [](char c) { return (c & 0xC0) != 0x80; });
+        std::cerr << "   " << name << std::string(std::max<long>(34 - length, 1), ' ') << std::fixed
+                  << std::setprecision(3) << std::setw(10) << measurement.wallTime << std::setw(10)
+                  << measurement.cpuTime << std::setprecision(1) << std::setw(14)
+                  << measurement.peakMemory / (1024.0 * 1024.0) << std::endl;
+    }
+    std::cerr << std::defaultfloat;
+}
+
 void HRFCompilerDelegate::printMessage(const std::string &message) const {
     std::cerr << rang::style::bold << message << std::endl << rang::style::reset;
 }
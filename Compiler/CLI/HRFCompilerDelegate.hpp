@@ -10,6 +10,7 @@
 #define HRFCompilerDelegate_hpp
 
 #include "Compiler.hpp"
+#include <vector>
 
 namespace EmojicodeCompiler {
 
@@ -23,9 +24,15 @@ public:
     void begin() override {}
     void error(Compiler *compiler, const CompilerError &ce) override;
     void warn(Compiler *compiler, const std::string &message, const SourcePosition &p) override;
-    void finish() override {}
+    void finish() override;
+    void measured(const Measurement &measurement) override;
 
 private:
+    std::vector<Measurement> measurements_;
+
+    /// Prints the measurements in the order in which they began, indented by their depth.
+    void printMeasurements();
+
     void printPosition(const SourcePosition &p) const;
 
     void printOffendingCode(Compiler *compiler, const SourcePosition &position);
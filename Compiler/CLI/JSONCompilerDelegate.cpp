@@ -48,6 +48,25 @@ void JSONCompilerDelegate::warn(Compiler *compiler, const std::string &message,
     printJson("warning", p, message);
 }
 
+void JSONCompilerDelegate::measured(const Measurement &measurement) {
+    writer_.StartObject();
+    writer_.Key("type");
+    writer_.String("measurement");
+    writer_.Key("name");
+    writer_.String(measurement.name);
+    writer_.Key("depth");
+    writer_.Uint(measurement.depth);
+    writer_.Key("start");
+    writer_.Double(measurement.start);
+    writer_.Key("wallTime");
+    writer_.Double(measurement.wallTime);
+    writer_.Key("cpuTime");
+    writer_.Double(measurement.cpuTime);
+    writer_.Key("peakMemory");
+    writer_.Uint64(measurement.peakMemory);
+    writer_.EndObject();
+}
+
 }  // namespace CLI
 
 }  // namespace EmojicodeCompiler
@@ -27,6 +27,7 @@ public:
     void error(Compiler *compiler, const CompilerError &ce) override;
     void warn(Compiler *compiler, const std::string &message, const SourcePosition &p) override;
     void finish() override;
+    void measured(const Measurement &measurement) override;
 private:
     rapidjson::OStreamWrapper wrapper_;
     rapidjson::Writer<rapidjson::OStreamWrapper> writer_;
@@ -13,7 +13,9 @@
 #include "Utils/args.hxx"
 #include <llvm/Support/FileSystem.h>
 #include <llvm/Support/Path.h>
+#include <algorithm>
 #include <iostream>
+#include <sstream>
 
 namespace EmojicodeCompiler {
 
@@ -27,6 +29,8 @@ Options::Options(int argc, char *argv[]) {
     args::ArgumentParser parser("Emojicode Compiler 1.0 beta 2. Visit https://www.emojicode.org for help.");
     args::Positional<std::string> file(parser, "file", "The main file of the package to be compiled", std::string(),
                                        args::Options::Required);
+    args::PositionalList<std::string> programArguments(parser, "arguments",
+                                                       "The arguments of the program if it is run with --run");
     args::HelpFlag help(parser, "help", "Display this help menu", {'h', "help"});
     args::ValueFlag<std::string> package(parser, "package", "The name of the package", {'p'});
     args::ValueFlag<std::string> out(parser, "out", "Set output path for binary or assembly", {'o'});
@@ -35,9 +39,41 @@ Options::Options(int argc, char *argv[]) {
     args::Flag object(parser, "object", "Produce object file, do not link", {'c'});
     args::Flag json(parser, "json", "Show compiler messages as JSON", {"json"});
     args::Flag format(parser, "format", "Format source code", {"format"});
+    args::Flag check(parser, "check", "Only analyse the package and write the interface and report, generate no code",
+                     {"check"});
     args::Flag color(parser, "color", "Always show compiler messages in color", {"color"});
     args::Flag optimize(parser, "optimize", "Compile with optimizations", {'O'});
+    args::MapFlag<std::string, OptimizationLevel> optimizationLevel(parser, "level",
+        "Compile with the given optimizations: 0, 1, 2, 3, s (small code) or z (smallest code)", {"opt"}, {
+            { "0", OptimizationLevel::None }, { "1", OptimizationLevel::O1 }, { "2", OptimizationLevel::O2 },
+            { "3", OptimizationLevel::O3 }, { "s", OptimizationLevel::Os }, { "z", OptimizationLevel::Oz },
+    });
     args::Flag printIr(parser, "emit-llvm", "Print the IR to the standard output", {"emit-llvm"});
+    args::Flag cache(parser, "cache", "Reuse the results of an earlier compilation with the same inputs",
+                     {"cache"});
+    args::Flag run(parser, "run", "Run the program with the JIT instead of writing an executable", {"run"});
+    args::Flag watch(parser, "watch", "Compile again whenever a source file changes", {"watch"});
+    args::ValueFlag<std::string> target(parser, "triple", "Generate code for the given target triple", {"target"});
+    args::ValueFlag<std::string> cpu(parser, "cpu", "Generate code for the given CPU or \"native\" for this computer",
+                                     {"cpu"});
+    args::Flag lto(parser, "lto", "Emit bitcode and link with ThinLTO to optimize across packages", {"lto"});
+    args::Flag debugInfo(parser, "debug", "Emit debug information and export the symbols of executables", {'g'});
+    args::Flag staticLink(parser, "static", "Link a static executable, which starts faster", {"static"});
+    args::Flag shared(parser, "shared", "Link a shared library that C and C++ programs can load", {"shared"});
+    args::Flag icf(parser, "icf", "Fold identical functions when linking, which requires lld or gold", {"icf"});
+    args::ValueFlag<std::string> profileGenerate(parser, "path",
+        "Instrument the code to write a profile of its execution to the given path", {"profile-generate"});
+    args::ValueFlag<std::string> profileUse(parser, "path",
+        "Optimize with the given profile, which was merged with llvm-profdata", {"profile-use"});
+    args::Flag warnHeapBoxing(parser, "warn-heap-boxing",
+                              "Warn wherever a value is boxed on the heap because it is larger than a box",
+                              {"warn-heap-boxing"});
+    args::Flag inlineCaches(parser, "inline-caches",
+                            "Call methods of known classes directly instead of through the virtual table",
+                            {"inline-caches"});
+    args::Flag timePhases(parser, "time-phases", "Report the time and memory each phase of the compilation uses",
+                          {"time-phases"});
+    args::ValueFlag<unsigned> jobs(parser, "jobs", "Read, analyse and generate code on the given number of threads", {'j'});
     args::ValueFlagList<std::string> searchPaths(parser, "search path",
                                                  "Adds the path to the package search path (after './packages')",
                                                  {'S'});
@@ -51,9 +87,46 @@ Options::Options(int argc, char *argv[]) {
         mainFile_ = file.Get();
         jsonOutput_ = json.Get();
         format_ = format.Get();
+        check_ = check.Get();
         forceColor_ = color.Get();
-        optimize_ = optimize.Get();
+        if (optimizationLevel) {
+            optimizationLevel_ = optimizationLevel.Get();
+        }
+        else if (optimize) {
+            optimizationLevel_ = OptimizationLevel::O3;
+        }
         printIr_ = printIr.Get();
+        cache_ = cache.Get();
+        watch_ = watch.Get();
+        run_ = run.Get();
+        programArguments_ = programArguments.Get();
+        if (run_ && (object || printIr_ || lto || target || package || format_ || check_ || shared)) {
+            throw args::ValidationError("--run cannot be combined with -c, -p, --emit-llvm, --lto, --target, "
+                                        "--format, --check or --shared.");
+        }
+        if (shared && (object || printIr_ || staticLink)) {
+            throw args::ValidationError("--shared cannot be combined with -c, --emit-llvm or --static.");
+        }
+        if (!run_ && !programArguments_.empty()) {
+            throw args::ValidationError("Program arguments can only be passed with --run.");
+        }
+        timePhases_ = timePhases.Get();
+        lto_ = lto.Get();
+        debugInfo_ = debugInfo.Get();
+        staticLink_ = staticLink.Get();
+        shared_ = shared.Get();
+        foldIdenticalCode_ = icf.Get();
+        warnHeapBoxing_ = warnHeapBoxing.Get();
+        inlineCaches_ = inlineCaches.Get();
+        if (profileGenerate) {
+            profile_.instrumentationPath = profileGenerate.Get();
+        }
+        if (profileUse) {
+            profile_.profilePath = profileUse.Get();
+        }
+        if ((profileGenerate || profileUse) && optimizationLevel_ == OptimizationLevel::None) {
+            optimizationLevel_ = OptimizationLevel::O2;
+        }
 
         if (package) {
             mainPackageName_ = package.Get();
@@ -66,6 +139,17 @@ Options::Options(int argc, char *argv[]) {
         }
         if (interfaceOut) {
             interfaceFile_ = interfaceOut.Get();
+            explicitInterface_ = true;
+        }
+        explicitOutput_ = out || object || printIr_;
+        if (target) {
+            targetTriple_ = target.Get();
+        }
+        if (cpu) {
+            cpu_ = cpu.Get();
+        }
+        if (jobs) {
+            jobs_ = std::max(jobs.Get(), 1u);
         }
     }
     catch (args::Help &e) {
@@ -111,7 +195,15 @@ void Options::configureOutPath() {
     }
 
     if (pack() && outPath_.empty()) {
-        if (standalone()) {
+        if (shared_) {
+            auto name = standalone() ? std::string(llvm::sys::path::stem(mainFile_)) : mainPackageName_;
+#ifdef __APPLE__
+            outPath_ = outDir_ + "lib" + name + ".dylib";
+#else
+            outPath_ = outDir_ + "lib" + name + ".so";
+#endif
+        }
+        else if (standalone()) {
             outPath_ = outDir_ + std::string(llvm::sys::path::stem(mainFile_));
         }
         else {
@@ -146,7 +238,7 @@ std::string Options::ar() const {
     if (auto var = getenv("AR")) {
         return var;
     }
-    return "ar";
+    return "";
 }
 
 std::string Options::objectPath() const {
@@ -163,6 +255,40 @@ std::string Options::llvmIrPath() const {
     return outDir_ + std::string(llvm::sys::path::stem(mainFile_)) + ".ll";
 }
 
+std::string Options::cachePath() const {
+    // The cache does not notice changes to the contents of the profile. Warnings about heap boxing are issued while
+    // code is generated, which restoring the artifacts skips. A program that is run produces no artifacts, the JIT
+    // caches its code itself instead. (See jitCachePath().)
+    if (!cache_ || run_ || printIr_ || format_ || check_ || report_ || warnHeapBoxing_ ||
+        !profile_.profilePath.empty()) {
+        return "";
+    }
+    return outDir_ + ".emojicodecache";
+}
+
+std::string Options::jitCachePath() const {
+    if (!cache_) {
+        return "";
+    }
+    return outDir_ + ".emojicodecache";
+}
+
+std::vector<std::string> Options::programArguments() const {
+    std::vector<std::string> arguments{ mainFile_ };
+    arguments.insert(arguments.end(), programArguments_.begin(), programArguments_.end());
+    return arguments;
+}
+
+std::string Options::cacheConfiguration() const {
+    std::stringstream configuration;
+    configuration << "emojicodec " << __DATE__ << " " << __TIME__ << "\n" << mainPackageName_ << "\n"
+                  << static_cast<int>(optimizationLevel_) << "\n" << codeGenerationJobs() << "\n" << objectPath() << "\n"
+                  << interfaceFile_ << "\n" << lto_ << "\n" << targetTriple_ << "\n" << cpu_ << "\n"
+                  << profile_.instrumentationPath << "\n" << debugInfo_ << "\n" << staticLink_ << "\n"
+                  << foldIdenticalCode_ << "\n" << inlineCaches_ << "\n" << shared_;
+    return configuration.str();
+}
+
 }  // namespace CLI
 
 }  // namespace EmojicodeCompiler
@@ -9,6 +9,7 @@
 #ifndef Options_hpp
 #define Options_hpp
 
+#include "Generation/OptimizationLevel.hpp"
 #include <exception>
 #include <memory>
 #include <string>
@@ -38,9 +39,45 @@ public:
     std::unique_ptr<CompilerDelegate> compilerDelegate() const;
 
     bool shouldReport() const { return report_; }
-    bool optimize() const { return optimize_; }
+    OptimizationLevel optimizationLevel() const { return optimizationLevel_; }
     bool pack() const { return pack_; }
+    /// Whether the package shall be compiled again whenever one of its source files changes.
+    bool watch() const { return watch_; }
+    /// Whether the program shall be run with the JIT after it was compiled instead of emitting and linking it.
+    bool run() const { return run_; }
+    /// Whether the resources the phases of the compilation use shall be reported.
+    bool timePhases() const { return timePhases_; }
+    /// Whether bitcode for ThinLTO shall be emitted instead of machine code and executables shall be linked with
+    /// ThinLTO.
+    bool lto() const { return lto_; }
+    /// Whether DWARF debug information shall be emitted and executables shall export their symbols, so that debuggers
+    /// and profilers show the Emojicode names and source positions of the functions.
+    bool debugInfo() const { return debugInfo_; }
+    /// Whether executables shall be linked statically.
+    bool staticLink() const { return staticLink_; }
+    /// Whether a shared library that C and C++ programs can load shall be linked instead of an executable or archive.
+    bool shared() const { return shared_; }
+    /// Whether an executable shall be linked, which requires a 🏁 block.
+    bool executable() const { return standalone() && !shared_; }
+    /// Whether executables shall be linked with identical code folding.
+    bool foldIdenticalCode() const { return foldIdenticalCode_; }
+    /// Whether a warning shall be issued wherever a value is boxed on the heap.
+    bool warnsHeapBoxing() const { return warnHeapBoxing_; }
+    /// Whether dynamic dispatches on classes shall use inline caches. (See Compiler::setUsesInlineCaches.)
+    bool inlineCaches() const { return inlineCaches_; }
+    /// Describes whether the code shall be instrumented or optimized with a profile. Either implies --opt 2 if no
+    /// optimization level was given.
+    const ProfileGuidance& profileGuidance() const { return profile_; }
+    /// The triple of the target for which code shall be generated or an empty string for the host.
+    const std::string& targetTriple() const { return targetTriple_; }
+    /// The CPU for which code shall be generated. "native" stands for the CPU of the host.
+    const std::string& cpu() const { return cpu_; }
     bool standalone() const { return mainPackageName_ == "_"; }
+    /// The number of threads on which source files are read and function bodies are analysed.
+    unsigned jobs() const { return jobs_; }
+    /// The number of threads on which machine code is generated. This is always 1 if a single object file was
+    /// requested or ThinLTO is used, as the code is otherwise emitted to one object file per thread.
+    unsigned codeGenerationJobs() const { return pack_ && !lto_ ? jobs_ : 1; }
 
     const std::string& outPath() const { return outPath_; }
     const std::string& mainFile() const { return mainFile_; }
@@ -49,12 +86,27 @@ public:
     const std::string& mainPackageName() const { return mainPackageName_; }
     const std::string& reportPath() const { return reportPath_; }
     std::string llvmIrPath() const;
+    /// The directory of the CompilationCache or an empty string if no cache shall be used.
+    std::string cachePath() const;
+    /// Describes the options that influence the artifacts of the compilation. (See CompilationCache.)
+    std::string cacheConfiguration() const;
+    /// The directory in which the JIT caches compiled code or an empty string if it shall compile lazily.
+    std::string jitCachePath() const;
+    /// The command-line arguments of a program run with --run, beginning with the path of the main file.
+    std::vector<std::string> programArguments() const;
     std::string linker() const;
+    /// The archiver specified by the AR environment variable or an empty string if the compiler shall write archives
+    /// itself.
     std::string ar() const;
 
-    /// Whether the main purpose of the invocation of the compiler is to prettyprint a file.
-    /// This method returns true if prettyprint was explicitely requested or if a file is being migrated.
+    /// Whether the source code of the package shall be formatted.
     bool prettyprint() const { return format_; }
+    /// Whether the package shall be analysed. If the source code is formatted, the package is only analysed if an
+    /// interface, a report or code was explicitly requested as well, so that one invocation can produce all of them.
+    bool analyses() const { return !format_ || explicitInterface_ || report_ || generatesCode(); }
+    /// Whether code shall be generated. This is not the case if only the package was to be checked or if the source
+    /// code is formatted and no output file was requested.
+    bool generatesCode() const { return !check_ && (!format_ || explicitOutput_); }
 
     std::string objectPath() const;
 private:
@@ -64,16 +116,37 @@ private:
     std::string reportPath_;
     std::string llvmIr_;
     std::vector<std::string> packageSearchPaths_;
+    std::vector<std::string> programArguments_;
     std::string mainPackageName_ = "_";
     /// Path to the directory where the output files will be placed.
     std::string outDir_;
+    std::string targetTriple_;
+    std::string cpu_ = "generic";
     bool format_ = false;
+    bool check_ = false;
+    /// Whether an interface file was requested with -i.
+    bool explicitInterface_ = false;
+    /// Whether an output file, an object file or LLVM IR was requested.
+    bool explicitOutput_ = false;
     bool jsonOutput_ = false;
     bool pack_ = true;
     bool report_ = false;
     bool forceColor_ = false;
-    bool optimize_ = false;
+    OptimizationLevel optimizationLevel_ = OptimizationLevel::None;
     bool printIr_ = false;
+    bool cache_ = false;
+    bool watch_ = false;
+    bool run_ = false;
+    bool timePhases_ = false;
+    bool lto_ = false;
+    bool debugInfo_ = false;
+    bool staticLink_ = false;
+    bool shared_ = false;
+    bool foldIdenticalCode_ = false;
+    bool warnHeapBoxing_ = false;
+    bool inlineCaches_ = false;
+    ProfileGuidance profile_;
+    unsigned jobs_ = 1;
 
     void readEnvironment(const std::vector<std::string> &searchPaths);
 
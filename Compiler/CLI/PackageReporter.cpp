@@ -7,6 +7,8 @@
 //
 
 #include "PackageReporter.hpp"
+#include "Generation/CodeGenerator.hpp"
+#include "Lex/SourceManager.hpp"
 #include "Functions/Function.hpp"
 #include "Functions/Initializer.hpp"
 #include "Package/Package.hpp"
@@ -22,8 +24,9 @@ namespace EmojicodeCompiler {
 
 namespace CLI {
 
-PackageReporter::PackageReporter(Package *package, const std::string &string)
-    : file_(string, std::ios_base::out), wrapper_(file_), writer_(wrapper_), package_(package) {}
+PackageReporter::PackageReporter(Package *package, const std::string &string, CodeGenerator *generator)
+    : file_(string, std::ios_base::out), wrapper_(file_), writer_(wrapper_), package_(package),
+      generator_(generator) {}
 
 void PackageReporter::report() {
     writer_.StartObject();
@@ -37,11 +40,54 @@ void PackageReporter::report() {
     }
     writer_.EndArray();
 
+    if (generator_ != nullptr) {
+        reportHeapBoxings();
+        reportVirtualTables();
+    }
+
     writer_.EndObject();
 
     std::cout << std::endl;
 }
 
+void PackageReporter::reportHeapBoxings() {
+    writer_.Key("heapBoxing");
+    writer_.StartArray();
+    for (auto &boxing : generator_->heapBoxings()) {
+        writer_.StartObject();
+        writer_.Key("type");
+        writer_.String(boxing.type);
+        writer_.Key("size");
+        writer_.Uint64(boxing.size);
+        writer_.Key("file");
+        writer_.String(boxing.position.file != nullptr ? boxing.position.file->path() : "");
+        writer_.Key("line");
+        writer_.Uint(boxing.position.line);
+        writer_.Key("character");
+        writer_.Uint(boxing.position.character);
+        writer_.EndObject();
+    }
+    writer_.EndArray();
+}
+
+void PackageReporter::reportVirtualTables() {
+    writer_.Key("virtualTables");
+    writer_.StartArray();
+    for (auto &table : generator_->virtualTables()) {
+        writer_.StartObject();
+        writer_.Key("type");
+        writer_.String(table.type);
+        writer_.Key("entries");
+        writer_.Uint64(table.entries);
+        writer_.Key("size");
+        writer_.Uint64(table.size);
+        writer_.Key("shared");
+        writer_.Bool(table.shared);
+        writer_.EndObject();
+    }
+    writer_.EndArray();
+}
+
 void PackageReporter::reportDocumentation(const std::u32string &documentation) {
     if (!documentation.empty()) {
         writer_.Key("documentation");
@@ -170,6 +216,8 @@ void PackageReporter::reportFunction(Function *function, const TypeContext &tc)
     writer_.Bool(function->mutating());
     writer_.Key("final");
     writer_.Bool(function->final());
+    writer_.Key("escaping");
+    writer_.Bool(!function->memoryFlowTypeForThis().isUnknown() && function->memoryFlowTypeForThis().isEscaping());
 
     if (function->errorProne()) {
         writer_.Key("errorType");
@@ -22,12 +22,14 @@ class Package;
 class Type;
 class TypeContext;
 class Function;
+class CodeGenerator;
 
 namespace CLI {
 
 class PackageReporter {
 public:
-    explicit PackageReporter(Package *package, const std::string &string);
+    /// @param generator If not nullptr, the places at which the generator boxed values on the heap are reported.
+    explicit PackageReporter(Package *package, const std::string &string, CodeGenerator *generator = nullptr);
 
     void report();
 
@@ -36,6 +38,7 @@ private:
     rapidjson::OStreamWrapper wrapper_;
     rapidjson::PrettyWriter<rapidjson::OStreamWrapper> writer_;
     Package *package_;
+    CodeGenerator *generator_;
 
     void reportDocumentation(const std::u32string &documentation);
     void reportType(const Type &type, const TypeContext &tc);
@@ -57,6 +60,8 @@ private:
     }
 
     void reportExportedType(const Type &type);
+    void reportHeapBoxings();
+    void reportVirtualTables();
 
     template <typename T>
     void printFunctions(const std::vector<T *> &functions, const Type &type)  {
@@ -7,69 +7,152 @@
 //
 
 #include "Compiler.hpp"
+#include "Lex/TokenCache.hpp"
 #include "Options.hpp"
 #include "Package/RecordingPackage.hpp"
 #include "PackageReporter.hpp"
 #include "Prettyprint/PrettyPrinter.hpp"
+#include <llvm/Support/Chrono.h>
+#include <llvm/Support/FileSystem.h>
+#include <chrono>
 #include <exception>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 namespace EmojicodeCompiler {
 
 namespace CLI {
 
 class FormatPhase : public Compiler::Phase {
+public:
+    explicit FormatPhase(unsigned jobs) : jobs_(jobs) {}
     void perform(Compiler *compiler) override {
-        PrettyPrinter(compiler->mainPackage()).print();
+        PrettyPrinter(compiler->mainPackage()).print(jobs_);
     }
+    const char* name() const override { return "format"; }
+
+private:
+    unsigned jobs_;
 };
 
 class ReportPhase : public Compiler::Phase {
 public:
     ReportPhase(std::string path) : path_(std::move(path)) {}
     void perform(Compiler *compiler) override {
-        PackageReporter(compiler->mainPackage(), path_).report();
+        PackageReporter(compiler->mainPackage(), path_, compiler->generator()).report();
     }
+    const char* name() const override { return "report"; }
 
 private:
     std::string path_;
 };
 
+/// Adds the phases that generate, emit and link the code of the analysed package to `compiler`.
+void addCodeGenerationPhases(Compiler *compiler, const Options &options) {
+    compiler->add<Compiler::GenerationPhase>(options.optimizationLevel(), options.targetTriple(), options.cpu(),
+                                             options.profileGuidance(), options.debugInfo());
+    if (options.run()) {
+        compiler->add<Compiler::RunPhase>(options.jitCachePath(), options.linker(), options.programArguments());
+        return;
+    }
+    if (!options.llvmIrPath().empty()) {
+        compiler->add<Compiler::LLVMIREmissionPhase>(options.llvmIrPath());
+    }
+    else {
+        compiler->add<Compiler::ObjectFileEmissionPhase>(options.objectPath(), options.codeGenerationJobs(),
+                                                         options.lto());
+        if (!options.cachePath().empty()) {
+            std::vector<std::string> files;
+            if (!options.interfaceFile().empty()) {
+                files = { options.interfaceFile(), tokenCachePath(options.interfaceFile()) };
+            }
+            compiler->add<Compiler::CacheStorePhase>(std::move(files));
+        }
+    }
+    if (options.pack()) {
+        if (options.standalone() || options.shared()) {
+            compiler->add<Compiler::LinkPhase>(options.outPath(), options.linker(), options.lto(),
+                                               options.profileGuidance().instruments(), options.debugInfo(),
+                                               options.staticLink(), options.foldIdenticalCode(), options.shared());
+        }
+        else {
+            compiler->add<Compiler::ArchivePhase>(options.outPath(), options.ar());
+        }
+    }
+}
+
 /// The compiler CLI main function
-/// @returns True if the requested operation was successful.
-bool start(const Options &options) {
+/// @param files If not nullptr, set to the paths of all source files read during the compilation.
+/// @returns The exit code of the compiler, which is the exit code of the program if it was run with --run.
+int start(const Options &options, std::vector<std::string> *files = nullptr) {
     Compiler compiler(options.mainPackageName(), options.mainFile(), options.packageSearchPaths(),
                       options.compilerDelegate());
+    compiler.setMeasures(options.timePhases());
+    compiler.setWarnsHeapBoxing(options.warnsHeapBoxing());
+    compiler.setUsesInlineCaches(options.inlineCaches());
+    auto compile = [&] {
+        auto success = compiler.compile();
+        if (files != nullptr) {
+            *files = compiler.sourceManager().paths();
+        }
+        return success ? compiler.exitCode() : 1;
+    };
 
-    compiler.add<Compiler::ParsePhase>();
+    if (!options.cachePath().empty()) {
+        compiler.add<Compiler::CacheLookupPhase>(options.cachePath(), options.cacheConfiguration());
+    }
+    compiler.add<Compiler::ParsePhase>(options.jobs());
     if (options.prettyprint()) {
-        compiler.add<FormatPhase>();
-        return compiler.compile();
+        compiler.add<FormatPhase>(options.jobs());
+    }
+    if (!options.analyses()) {
+        return compile();
     }
-    compiler.add<Compiler::AnalysisPhase>(options.standalone());
+    compiler.add<Compiler::AnalysisPhase>(options.executable(), options.jobs());
     if (!options.interfaceFile().empty()) {
         compiler.add<Compiler::PrintInterfacePhase>(options.interfaceFile());
     }
-    compiler.add<Compiler::GenerationPhase>(options.optimize());
-    if (!options.llvmIrPath().empty()) {
-        compiler.add<Compiler::LLVMIREmissionPhase>(options.llvmIrPath());
+    if (options.generatesCode()) {
+        addCodeGenerationPhases(&compiler, options);
     }
-    else {
-        compiler.add<Compiler::ObjectFileEmissionPhase>(options.objectPath());
+
+    if (options.shouldReport()) {
+        compiler.add<ReportPhase>(options.reportPath());
     }
-    if (options.pack()) {
-        if (options.standalone()) {
-            compiler.add<Compiler::LinkPhase>(options.objectPath(), options.outPath(), options.linker());
+    return compile();
+}
+
+/// Returns the modification times of the files, or the minimum time for files that do not exist.
+std::vector<llvm::sys::TimePoint<>> modificationTimes(const std::vector<std::string> &files) {
+    std::vector<llvm::sys::TimePoint<>> times;
+    times.reserve(files.size());
+    for (auto &file : files) {
+        llvm::sys::fs::file_status status;
+        if (llvm::sys::fs::status(file, status)) {
+            times.emplace_back();
         }
         else {
-            compiler.add<Compiler::ArchivePhase>(options.objectPath(), options.outPath(), options.ar());
+            times.emplace_back(status.getLastModificationTime());
         }
     }
+    return times;
+}
 
-    if (options.shouldReport()) {
-        compiler.add<ReportPhase>(options.reportPath());
+/// Compiles the package and compiles it again whenever one of the source files read during the last compilation
+/// changes. Each compilation creates a new Compiler, so that no state from the last compilation remains, but the
+/// process and LLVM's target registry stay initialized.
+[[noreturn]] void watch(const Options &options) {
+    while (true) {
+        std::vector<std::string> files;
+        start(options, &files);
+        std::cout << std::endl;
+
+        auto times = modificationTimes(files);
+        do {
+            std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        } while (modificationTimes(files) == times);
     }
-    return compiler.compile();
 }
 
 }  // namespace CLI
@@ -78,7 +161,11 @@ bool start(const Options &options) {
 
 int main(int argc, char *argv[]) {
     try {
-        return EmojicodeCompiler::CLI::start(EmojicodeCompiler::CLI::Options(argc, argv)) ? 0 : 1;
+        EmojicodeCompiler::CLI::Options options(argc, argv);
+        if (options.watch()) {
+            EmojicodeCompiler::CLI::watch(options);
+        }
+        return EmojicodeCompiler::CLI::start(options);
     }
     catch (EmojicodeCompiler::CLI::CompilationCancellation &e) { return 0; }
     catch (std::exception &ex) {
@@ -0,0 +1,84 @@
+//
+// Created by Theo Weidmann on 14.10.26.
+//
+
+#include "CompilationCache.hpp"
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MD5.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <fstream>
+
+namespace EmojicodeCompiler {
+
+CompilationCache::CompilationCache(const std::string &directory, const std::set<std::string> &files,
+                                   const std::string &configuration) {
+    llvm::MD5 hash;
+    hash.update(configuration);
+    for (auto &path : files) {
+        hash.update(path);
+        // Separates the path from the contents so that different files cannot produce the same input.
+        hash.update(llvm::StringRef("\0", 1));
+        if (auto buffer = llvm::MemoryBuffer::getFile(path)) {
+            hash.update((*buffer)->getBuffer());
+        }
+    }
+    llvm::MD5::MD5Result result;
+    hash.final(result);
+    llvm::SmallString<32> key;
+    llvm::MD5::stringifyResult(result, key);
+    directory_ = directory + "/" + key.str().str();
+}
+
+bool CompilationCache::restore(std::vector<std::string> *objectFiles) const {
+    std::ifstream manifest(directory_ + "/manifest");
+    if (manifest.fail()) {
+        return false;
+    }
+
+    std::vector<std::string> restored;
+    std::string kind, path;
+    for (size_t i = 0; manifest >> kind && std::getline(manifest >> std::ws, path); i++) {
+        if (llvm::sys::fs::copy_file(directory_ + "/" + std::to_string(i), path)) {
+            return false;
+        }
+        if (kind == "object") {
+            restored.emplace_back(path);
+        }
+    }
+    *objectFiles = std::move(restored);
+    return true;
+}
+
+void CompilationCache::store(const std::vector<std::string> &objectFiles,
+                             const std::vector<std::string> &files) const {
+    // The artifacts are first copied to a temporary directory, so that a compilation that is stopped while storing
+    // leaves no incomplete artifacts.
+    auto temporary = directory_ + ".partial";
+    llvm::sys::fs::remove_directories(temporary);
+    if (llvm::sys::fs::create_directories(temporary)) {
+        return;
+    }
+
+    std::ofstream manifest(temporary + "/manifest");
+    size_t i = 0;
+    auto copy = [&](const std::string &kind, const std::string &path) {
+        if (llvm::sys::fs::exists(path) && !llvm::sys::fs::copy_file(path, temporary + "/" + std::to_string(i))) {
+            manifest << kind << " " << path << "\n";
+            i++;
+        }
+    };
+    for (auto &path : objectFiles) {
+        copy("object", path);
+    }
+    for (auto &path : files) {
+        copy("file", path);
+    }
+    manifest.close();
+
+    if (llvm::sys::fs::rename(temporary, directory_)) {
+        llvm::sys::fs::remove_directories(temporary);
+    }
+}
+
+}  // namespace EmojicodeCompiler
@@ -0,0 +1,42 @@
+//
+// Created by Theo Weidmann on 14.10.26.
+//
+
+#ifndef EMOJICODE_COMPILATIONCACHE_HPP
+#define EMOJICODE_COMPILATIONCACHE_HPP
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace EmojicodeCompiler {
+
+/// A CompilationCache stores the artifacts of a compilation of a package, i.e. its object files and interface, on
+/// disk so that they can be reused by a later compilation with the same inputs.
+///
+/// The artifacts are keyed by an MD5 hash of the paths and contents of all source files of the package and the
+/// interfaces of all packages it imports (see PackagePrefetcher) as well as of a description of all other inputs.
+class CompilationCache {
+public:
+    /// @param directory The directory in which all artifacts are stored.
+    /// @param files The source files from which the artifacts are produced.
+    /// @param configuration Describes all other inputs, e.g. compiler options, that influence the artifacts.
+    CompilationCache(const std::string &directory, const std::set<std::string> &files,
+                     const std::string &configuration);
+
+    /// Copies the artifacts stored for the key back to the paths from which they were stored.
+    /// @param objectFiles Set to the paths of the restored object files.
+    /// @returns False if no artifacts were stored for the key or they could not be restored.
+    bool restore(std::vector<std::string> *objectFiles) const;
+
+    /// Stores the object files and further files, e.g. the interface, for the key.
+    void store(const std::vector<std::string> &objectFiles, const std::vector<std::string> &files) const;
+
+private:
+    /// The directory in which the artifacts for the key are stored.
+    std::string directory_;
+};
+
+}  // namespace EmojicodeCompiler
+
+#endif //EMOJICODE_COMPILATIONCACHE_HPP
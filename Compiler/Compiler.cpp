@@ -7,13 +7,20 @@
 //
 
 #include "CompilerError.hpp"
+#include "CompilationCache.hpp"
 #include "Analysis/SemanticAnalyser.hpp"
 #include "Compiler.hpp"
 #include "Generation/CodeGenerator.hpp"
+#include "Generation/JITRunner.hpp"
+#include "Generation/Mangler.hpp"
+#include "Lex/TokenCache.hpp"
+#include "Package/PackagePrefetcher.hpp"
 #include "Package/RecordingPackage.hpp"
 #include "Parsing/AbstractParser.hpp"
 #include "Prettyprint/PrettyPrinter.hpp"
+#include <llvm/Object/ArchiveWriter.h>
 #include <llvm/Support/FileSystem.h>
+#include <sys/resource.h>
 #include "MemoryFlowAnalysis/MFAnalyser.hpp"
 #include "Types/ValueType.hpp"
 #include "Functions/Function.hpp"
@@ -30,10 +37,14 @@ Compiler::Compiler(std::string mainPackage, std::string mainFile, std::vector<st
 Compiler::~Compiler() = default;
 
 bool Compiler::compile() {
+    compilationStart_ = std::chrono::steady_clock::now();
     delegate_->begin();
     try {
         for (auto &phase : phases_) {
-            phase->perform(this);
+            if (restoredFromCache_ && phase->isCacheable()) {
+                continue;
+            }
+            measure(phase->name(), [&] { phase->perform(this); });
             if (hasError_) {
                 break;
             }
@@ -46,29 +57,77 @@ bool Compiler::compile() {
     return !hasError_;
 }
 
+Compiler::MeasurementStart Compiler::startMeasurement() {
+    measurementDepth_++;
+    return MeasurementStart { std::chrono::steady_clock::now(), std::clock() };
+}
+
+void Compiler::finishMeasurement(const std::string &name, const MeasurementStart &start) {
+    auto wall = std::chrono::steady_clock::now();
+    auto cpu = std::clock();
+    measurementDepth_--;
+
+    struct rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    auto peakMemory = static_cast<size_t>(usage.ru_maxrss);
+#else
+    auto peakMemory = static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+
+    using Seconds = std::chrono::duration<double>;
+    delegate_->measured(Measurement { name, measurementDepth_, Seconds(start.wall - compilationStart_).count(),
+                                      Seconds(wall - start.wall).count(),
+                                      static_cast<double>(cpu - start.cpu) / CLOCKS_PER_SEC, peakMemory });
+}
+
+void Compiler::CacheLookupPhase::perform(Compiler *compiler) {
+    PackagePrefetcher prefetcher(compiler, 1);
+    prefetcher.prefetch(compiler->mainFile_, compiler->mainPackage_->name());
+    compiler->cache_ = std::make_unique<CompilationCache>(directory_, prefetcher.files(), configuration_);
+    compiler->restoredFromCache_ = compiler->cache_->restore(&compiler->objectFilePaths_);
+}
+
+void Compiler::CacheStorePhase::perform(Compiler *compiler) {
+    assert(compiler->cache_ != nullptr && "CacheStorePhase must be run after CacheLookupPhase");
+    compiler->cache_->store(compiler->objectFilePaths_, files_);
+}
+
 void Compiler::ParsePhase::perform(Compiler *compiler) {
+    if (jobs_ > 1) {
+        PackagePrefetcher(compiler, jobs_).prefetch(compiler->mainFile_, compiler->mainPackage_->name());
+    }
     compiler->mainPackage_->parse(compiler->mainFile_);
 }
 
 void Compiler::AnalysisPhase::perform(Compiler *compiler) {
-    SemanticAnalyser(compiler->mainPackage(), false).analyse(standalone_);
+    compiler->measure("semantic analysis", [&] {
+        SemanticAnalyser(compiler->mainPackage(), false, jobs_).analyse(standalone_);
+    });
     if (compiler->hasError_) return;
-    MFAnalyser(compiler->mainPackage()).analyse();
+    compiler->measure("memory flow analysis", [&] { MFAnalyser(compiler->mainPackage()).analyse(); });
 }
 
 void Compiler::PrintInterfacePhase::perform(Compiler *compiler) {
     PrettyPrinter(compiler->mainPackage()).printInterface(path_);
+    writeTokenCache(path_);
 }
 
 void Compiler::GenerationPhase::perform(Compiler *compiler) {
     assert(compiler->generator_ == nullptr);
-    compiler->generator_ = std::make_unique<CodeGenerator>(compiler, optimize_);
+    compiler->generator_ = std::make_unique<CodeGenerator>(compiler, optimizationLevel_, targetTriple_, cpu_,
+                                                           profile_, debugInfo_);
     compiler->generator_->generate();
 }
 
 void Compiler::ObjectFileEmissionPhase::perform(Compiler *compiler) {
     assert(compiler->generator_ != nullptr && "ObjectFileEmissionPhase must be run after GenerationPhase");
-    compiler->generator_->emit(false, path_);
+    if (bitcode_) {
+        compiler->generator_->emitBitcode(path_);
+        compiler->objectFilePaths_ = { path_ };
+        return;
+    }
+    compiler->objectFilePaths_ = compiler->generator_->emitObjectFiles(path_, jobs_);
 }
 
 void Compiler::LLVMIREmissionPhase::perform(Compiler *compiler) {
@@ -79,32 +138,105 @@ void Compiler::LLVMIREmissionPhase::perform(Compiler *compiler) {
 void Compiler::LinkPhase::perform(Compiler *compiler) {
     std::stringstream cmd;
 
-    cmd << linker_ << " " << objectFilePath_;
+    cmd << linker_;
+    if (lto_) {
+        cmd << " -flto=thin";
+    }
+    if (profileRuntime_) {
+        cmd << " -fprofile-generate";
+    }
+    if (exportSymbols_) {
+        cmd << " -rdynamic";
+    }
+    if (shared_) {
+#ifdef __APPLE__
+        cmd << " -dynamiclib";
+#else
+        cmd << " -shared";
+#endif
+    }
+    else if (staticLink_) {
+        cmd << " -static-pie";
+    }
+#ifdef __APPLE__
+    cmd << " -Wl,-dead_strip";
+#else
+    cmd << " -Wl,--gc-sections";
+#endif
+    if (foldIdenticalCode_) {
+        cmd << " -Wl,--icf=safe";
+    }
+    for (auto &path : compiler->objectFilePaths_) {
+        cmd << " " << path;
+    }
+    for (auto &input : compiler->linkInputs()) {
+        cmd << " " << input;
+    }
+    cmd << " -o " << outPath_;
+
+    system(cmd.str().c_str());
+}
+
+void Compiler::RunPhase::perform(Compiler *compiler) {
+    assert(compiler->generator_ != nullptr && "RunPhase must be run after GenerationPhase");
+    auto package = compiler->mainPackage();
+    if (!package->hasStartFlagFunction()) {
+        throw CompilerError(SourcePosition(), "Cannot run a package without 🏁 block.");
+    }
+    JITRunner runner(compiler->generator(), cacheDirectory_);
+    runner.loadLibraries(compiler->linkInputs(), linker_);
+    compiler->exitCode_ = runner.run(mangleFunction(package->startFlagFunction(), {}), arguments_);
+}
 
-    for (auto it = compiler->packageImportOrder_.rbegin(); it != compiler->packageImportOrder_.rend(); it++) {
+std::vector<std::string> Compiler::linkInputs() {
+    std::vector<std::string> inputs;
+    for (auto it = packageImportOrder_.rbegin(); it != packageImportOrder_.rend(); it++) {
         auto package = *it;
-        auto path = compiler->findBinaryPathPackage(package->path(), package->name());
-        cmd << " " << path;
+        inputs.emplace_back(findBinaryPathPackage(package->path(), package->name()));
         for (auto &hint : package->linkHints()) {
-            cmd << " -l" << hint;
+            inputs.emplace_back("-l" + hint);
         }
     }
-
-    auto runtimeLib = compiler->findBinaryPathPackage(compiler->searchPackage("runtime", SourcePosition()), "runtime");
-    cmd << " " << runtimeLib << " -o " << outPath_;
-
-    system(cmd.str().c_str());
+    inputs.emplace_back(findBinaryPathPackage(searchPackage("runtime", SourcePosition()), "runtime"));
+    return inputs;
 }
 
 void Compiler::ArchivePhase::perform(Compiler *compiler) {
+    if (ar_.empty()) {
+        writeArchive(compiler);
+        return;
+    }
     std::string cmd = ar_;
     cmd.append(" cr ");
     cmd.append(outPath_);
-    cmd.append(" ");
-    cmd.append(objectFilePath_);
+    for (auto &path : compiler->objectFilePaths_) {
+        cmd.append(" ");
+        cmd.append(path);
+    }
     system(cmd.c_str());
 }
 
+void Compiler::ArchivePhase::writeArchive(Compiler *compiler) {
+    std::vector<llvm::NewArchiveMember> members;
+    for (auto &path : compiler->objectFilePaths_) {
+        auto member = llvm::NewArchiveMember::getFile(path, true);
+        if (!member) {
+            throw CompilerError(SourcePosition(), "Could not read object file ", path, ": ",
+                                llvm::toString(member.takeError()));
+        }
+        members.emplace_back(std::move(*member));
+    }
+#ifdef __APPLE__
+    auto kind = llvm::object::Archive::K_DARWIN;
+#else
+    auto kind = llvm::object::Archive::K_GNU;
+#endif
+    if (auto error = llvm::writeArchive(outPath_, members, true, kind, true, false)) {
+        throw CompilerError(SourcePosition(), "Could not write archive ", outPath_, ": ",
+                            llvm::toString(std::move(error)));
+    }
+}
+
 std::string Compiler::searchPackage(const std::string &name, const SourcePosition &p) {
     for (auto &path : packageSearchPaths_) {
         auto full = path + "/";
@@ -145,30 +277,39 @@ Package *Compiler::loadPackage(const std::string &name, const SourcePosition &p,
     auto rawPtr = package.get();
     packageImportOrder_.emplace_back(rawPtr);
     packages_.emplace(name, std::move(package));
-    parseInterface(rawPtr, p);
+    measure("📦 " + name, [&] {
+        parseInterface(rawPtr, p);
 
-    SemanticAnalyser(rawPtr, true).analyse(false);
-    if (!hasError_) {
-        MFAnalyser(rawPtr).analyse();
-    }
+        SemanticAnalyser(rawPtr, true).analyse(false);
+        if (!hasError_) {
+            MFAnalyser(rawPtr).analyse();
+        }
+    });
     return rawPtr;
 }
 
 void Compiler::parseInterface(Package *pkg, const SourcePosition &p) {
-    std::string emojiPath = pkg->path() + "/🏛", textPath = pkg->path() + "/interface.emojii";
+    pkg->parse(interfacePath(pkg->path(), pkg->name(), p));
+}
+
+std::string Compiler::interfacePath(const std::string &packagePath, const std::string &packageName,
+                                    const SourcePosition &p) const {
+    std::string emojiPath = packagePath + "/🏛", textPath = packagePath + "/interface.emojii";
     bool emojiExists = llvm::sys::fs::exists(emojiPath), textExists = llvm::sys::fs::exists(textPath);
     if (emojiExists && textExists) {
-        throw CompilerError(p, "Package ", pkg->name(), " contains both a 🏛 file and interface.emojii.");
+        throw CompilerError(p, "Package ", packageName, " contains both a 🏛 file and interface.emojii.");
     }
-    pkg->parse(textExists ? textPath : emojiPath);
+    return textExists ? textPath : emojiPath;
 }
 
 void Compiler::error(const CompilerError &ce) {
+    std::lock_guard<std::mutex> lock(messageMutex_);
     hasError_ = true;
     delegate_->error(this, ce);
 }
 
 void Compiler::warn(const SourcePosition &p, const std::string &warning) {
+    std::lock_guard<std::mutex> lock(messageMutex_);
     delegate_->warn(this, warning, p);
 }
 
@@ -208,17 +349,34 @@ void Compiler::assignSTypes(Package *s) {
     sMemory = getStandardValueType(U"🧠", s);
     sByte = getStandardValueType(U"💧", s);
     sByte->constructibleFrom_ = TypeType::IntegerLiteral;
+    sUInt8 = getStandardValueType(U"🔢🔸🥉", s);
+    sUInt16 = getStandardValueType(U"🔢🔸🥈", s);
+    sUInt32 = getStandardValueType(U"🔢🔸🥇", s);
+    for (auto type : { sUInt8, sUInt16, sUInt32 }) {
+        type->constructibleFrom_ = TypeType::IntegerLiteral;
+    }
     sWeak = getStandardValueType(U"📶", s);
+    sTracing = getStandardValueType(U"🛰", s);
+    sRealVector = getStandardValueType(U"🚂🔸💯", s);
+    sIntegerVector = getStandardValueType(U"🚂🔸🔢", s);
+    sByteVector = getStandardValueType(U"🚂🔸💧", s);
     sString = getStandardClass(U"🔡", s);
     sError = getStandardClass(U"🚧", s);
     sList = getStandardValueType(U"🍨", s);
     sList->constructibleFrom_ = TypeType::ListLiteral;
     sDictionary = getStandardValueType(U"🍯", s);
     sDictionary->constructibleFrom_ = TypeType::DictionaryLiteral;
+    sRange = getStandardValueType(U"⏩", s);
+    sSlice = getStandardValueType(U"🍰", s);
+    sData = getStandardClass(U"📇", s);
+    sEncoder = getStandardClass(U"🖨", s);
+    sDecoder = getStandardClass(U"🔬", s);
+    sDecodingError = getStandardClass(U"🚧🔸🧬", s);
 
     sInterpolateable = getStandardProtocol(U"↘🔸🔡", s);
     sEnumerable = getStandardProtocol(
             std::u32string(1, E_CLOCKWISE_RIGHTWARDS_AND_LEFTWARDS_OPEN_CIRCLE_ARROWS_WITH_CIRCLED_ONE_OVERLAY), s);
+    sSerializable = getStandardProtocol(U"🧬", s);
 }
 
 } // namespace EmojicodeCompiler
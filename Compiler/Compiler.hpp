@@ -11,8 +11,12 @@
 
 #include "Utils/StringUtils.hpp"
 #include "Lex/SourceManager.hpp"
+#include "Generation/OptimizationLevel.hpp"
+#include <chrono>
+#include <ctime>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -29,6 +33,22 @@ class Protocol;
 class ValueType;
 class Compiler;
 class CodeGenerator;
+class CompilationCache;
+
+/// Describes the resources that a part of the compilation used. (See Compiler::measure().)
+struct Measurement {
+    std::string name;
+    /// The number of measurements that enclose this measurement.
+    unsigned depth;
+    /// The time in seconds after the beginning of the compilation at which the part began.
+    double start;
+    /// The wall-clock time in seconds the part took.
+    double wallTime;
+    /// The processor time in seconds all threads of the process spent on the part.
+    double cpuTime;
+    /// The peak resident set size of the process in bytes when the part ended.
+    size_t peakMemory;
+};
 
 /// CompilerDelegate is an interface class, which is used by Compiler to notify about certain events, like
 /// compiler errors.
@@ -46,6 +66,9 @@ public:
     virtual void warn(Compiler *compiler, const std::string &message, const SourcePosition &p) = 0;
     /// Called when the compilation stops, i.e. just before Compiler::compile returns.
     virtual void finish() = 0;
+    /// A part of the compilation was measured. Measurements are reported when they end, so a measurement is
+    /// reported after the measurements it encloses. Only called if Compiler::setMeasures(true) was called.
+    virtual void measured(const Measurement &measurement) {}
 
     virtual ~CompilerDelegate() = default;
 };
@@ -61,22 +84,68 @@ public:
     class Phase {
     public:
         virtual void perform(Compiler *compiler) = 0;
+        /// The name under which the phase is measured. (See Compiler::measure().)
+        virtual const char* name() const = 0;
+        /// Whether this phase only produces artifacts that are restored by CacheLookupPhase and can thus be skipped
+        /// if they were restored.
+        virtual bool isCacheable() const { return false; }
         virtual ~Phase() = default;
     };
 
+    /// Restores the artifacts of an earlier compilation with the same inputs from a CompilationCache. If they are
+    /// restored, all following phases for which Phase::isCacheable() returns true are skipped. ParsePhase is not
+    /// skipped, as loading the imported packages determines the archives that LinkPhase links. Must precede
+    /// AnalysisPhase.
+    class CacheLookupPhase final : public Phase {
+    public:
+        /// @param directory The directory in which the cache is stored.
+        /// @param configuration Describes all options that influence the artifacts.
+        CacheLookupPhase(std::string directory, std::string configuration)
+            : directory_(std::move(directory)), configuration_(std::move(configuration)) {}
+        void perform(Compiler *compiler) override;
+        const char* name() const override { return "cache lookup"; }
+    private:
+        std::string directory_;
+        std::string configuration_;
+    };
+
+    /// Stores the object files and the provided files in the CompilationCache created by CacheLookupPhase. Must be
+    /// preceded by ObjectFileEmissionPhase.
+    class CacheStorePhase final : public Phase {
+    public:
+        /// @param files Further artifacts that must be restored, e.g. the interface.
+        explicit CacheStorePhase(std::vector<std::string> files) : files_(std::move(files)) {}
+        void perform(Compiler *compiler) override;
+        const char* name() const override { return "cache store"; }
+        bool isCacheable() const override { return true; }
+    private:
+        std::vector<std::string> files_;
+    };
+
     /// Parses the main package.
     class ParsePhase final : public Phase {
+    public:
+        /// @param jobs The number of threads on which the source files of the main package and the interfaces of the
+        ///             packages it imports are read before parsing. (See PackagePrefetcher.)
+        explicit ParsePhase(unsigned jobs = 1) : jobs_(jobs) {}
         void perform(Compiler *compiler) override;
+        const char* name() const override { return "parse"; }
+    private:
+        unsigned jobs_;
     };
 
     /// Analyses the main package. Must be preceded by ParsePhase.
     class AnalysisPhase final : public Phase {
     public:
-        /// @param standalone If the package is a standalone package a start flag block is required.
-        AnalysisPhase(bool standalone) : standalone_(standalone) {}
+        /// @param standalone Whether the package is linked into an executable, which requires a start flag block.
+        /// @param jobs The number of threads on which function bodies are analysed.
+        AnalysisPhase(bool standalone, unsigned jobs = 1) : standalone_(standalone), jobs_(jobs) {}
         void perform(Compiler *compiler) override;
+        const char* name() const override { return "analysis"; }
+        bool isCacheable() const override { return true; }
     private:
         bool standalone_;
+        unsigned jobs_;
     };
 
     /// Prints the interface. Must be preceded by AnalysisPhase.
@@ -85,6 +154,8 @@ public:
         /// @param path The path at which an interface file for the main package shall be created.
         PrintInterfacePhase(std::string path) : path_(std::move(path)) {}
         void perform(Compiler *compiler) override;
+        const char* name() const override { return "interface"; }
+        bool isCacheable() const override { return true; }
     private:
         std::string path_;
     };
@@ -92,20 +163,44 @@ public:
     /// Generates code. Must be preceded by AnalysisPhase. Must only be added once per Compiler.
     class GenerationPhase final : public Phase {
     public:
-        /// @param optimize Whether optimizations should be run.
-        GenerationPhase(bool optimize) : optimize_(optimize) {}
+        /// @param optimizationLevel The optimizations that should be run.
+        /// @param targetTriple The target triple or an empty string for the host. (See CodeGenerator::CodeGenerator.)
+        /// @param cpu The target CPU, "generic" or "native".
+        /// @param profile Whether the code is instrumented or optimized with a profile.
+        /// @param debugInfo Whether DWARF debug information is generated.
+        GenerationPhase(OptimizationLevel optimizationLevel, std::string targetTriple = "",
+                        std::string cpu = "generic", ProfileGuidance profile = ProfileGuidance(),
+                        bool debugInfo = false)
+            : optimizationLevel_(optimizationLevel), targetTriple_(std::move(targetTriple)), cpu_(std::move(cpu)),
+              profile_(std::move(profile)), debugInfo_(debugInfo) {}
         void perform(Compiler *compiler) override;
+        const char* name() const override { return "generation"; }
+        bool isCacheable() const override { return true; }
     private:
-        bool optimize_;
+        OptimizationLevel optimizationLevel_;
+        std::string targetTriple_;
+        std::string cpu_;
+        ProfileGuidance profile_;
+        bool debugInfo_;
     };
 
-    /// Emits the generated code to an object file. Must be preceded by GenerationPhase.
+    /// Emits the generated code to object files. Must be preceded by GenerationPhase.
     class ObjectFileEmissionPhase final : public Phase {
     public:
-        ObjectFileEmissionPhase(std::string path) : path_(std::move(path)) {}
+        /// @param path The path of the object file. If the code is emitted in several partitions, this is the path
+        ///             of the first partition. (See CodeGenerator::emitObjectFiles.)
+        /// @param jobs The number of threads on which machine code is generated.
+        /// @param bitcode Whether bitcode for ThinLTO shall be emitted instead of machine code. The bitcode is always
+        ///                emitted to a single file at `path`. (See CodeGenerator::emitBitcode.)
+        ObjectFileEmissionPhase(std::string path, unsigned jobs = 1, bool bitcode = false)
+            : path_(std::move(path)), jobs_(jobs), bitcode_(bitcode) {}
         void perform(Compiler *compiler) override;
+        const char* name() const override { return "object file emission"; }
+        bool isCacheable() const override { return true; }
     private:
         std::string path_;
+        unsigned jobs_;
+        bool bitcode_;
     };
 
     /// Emits the generated code to an object file. Must be preceded by GenerationPhase.
@@ -113,35 +208,81 @@ public:
     public:
         LLVMIREmissionPhase(std::string path) : path_(std::move(path)) {}
         void perform(Compiler *compiler) override;
+        const char* name() const override { return "LLVM IR emission"; }
+        bool isCacheable() const override { return true; }
     private:
         std::string path_;
     };
 
-    /// Links an object file with the archives of the imported packages of the Compiler.
+    /// Links the object files of the main package with the archives of the imported packages of the Compiler.
+    /// Must be preceded by ObjectFileEmissionPhase.
     class LinkPhase final : public Phase {
     public:
-        /// @param objectFilePath Where the object file of the main package is located.
         /// @param outPath Where the linked binary shall be placed.
         /// @param linker Name of or path to the linker to use.
-        LinkPhase(std::string objectFilePath, std::string outPath, std::string linker)
-            : objectFilePath_(std::move(objectFilePath)), outPath_(std::move(outPath)), linker_(std::move(linker)) {}
+        /// @param lto Whether the object files are bitcode that the linker must optimize with ThinLTO. The linker
+        ///            must be a compiler driver that supports `-flto=thin`.
+        /// @param profileRuntime Whether the code is instrumented and the profile run-time library must be linked.
+        ///                       The linker must be a compiler driver that supports `-fprofile-generate`.
+        /// @param exportSymbols Whether the symbols of the executable are exported with `-rdynamic`, so that the
+        ///                      runtime can name the functions in profiles.
+        /// @param staticLink Whether a static position independent executable is linked with `-static-pie`, which
+        ///                   starts faster as the dynamic loader does not need to load and relocate shared libraries.
+        /// @param foldIdenticalCode Whether identical functions are folded with `--icf=safe`, which requires lld or
+        ///                          gold. Unused sections are always removed.
+        /// @param shared Whether a shared library is linked instead of an executable. The library contains the
+        ///               imported packages and the run-time library but no `main`. A host must call ejcSetUp() before
+        ///               it calls any function of the library.
+        LinkPhase(std::string outPath, std::string linker, bool lto = false, bool profileRuntime = false,
+                  bool exportSymbols = false, bool staticLink = false, bool foldIdenticalCode = false,
+                  bool shared = false)
+            : outPath_(std::move(outPath)), linker_(std::move(linker)), lto_(lto), profileRuntime_(profileRuntime),
+              exportSymbols_(exportSymbols), staticLink_(staticLink), foldIdenticalCode_(foldIdenticalCode),
+              shared_(shared) {}
         void perform(Compiler *compiler) override;
+        const char* name() const override { return "link"; }
     private:
-        std::string objectFilePath_;
         std::string outPath_;
         std::string linker_;
+        bool lto_;
+        bool profileRuntime_;
+        bool exportSymbols_;
+        bool staticLink_;
+        bool foldIdenticalCode_;
+        bool shared_;
+    };
+
+    /// Runs 🏁 of the generated code in the compiler process instead of linking an executable. Must be preceded by
+    /// GenerationPhase. (See JITRunner.)
+    class RunPhase final : public Phase {
+    public:
+        /// @param cacheDirectory The directory in which compiled objects are cached or an empty string if the code
+        ///                       shall be compiled lazily instead.
+        /// @param linker The compiler driver with which the imported packages are linked into a shared library.
+        /// @param arguments The command-line arguments of the program, beginning with its name.
+        RunPhase(std::string cacheDirectory, std::string linker, std::vector<std::string> arguments)
+            : cacheDirectory_(std::move(cacheDirectory)), linker_(std::move(linker)),
+              arguments_(std::move(arguments)) {}
+        void perform(Compiler *compiler) override;
+        const char* name() const override { return "run"; }
+    private:
+        std::string cacheDirectory_;
+        std::string linker_;
+        std::vector<std::string> arguments_;
     };
 
+    /// Archives the object files of the main package. Must be preceded by ObjectFileEmissionPhase.
     class ArchivePhase final : public Phase {
     public:
-        /// @param objectFilePath Where the object file of the main package is located.
         /// @param outPath Where the archive shall be placed.
-        /// @param ar Name of or path to the archiver to use.
-        ArchivePhase(std::string objectFilePath, std::string outPath, std::string ar)
-            : objectFilePath_(std::move(objectFilePath)), outPath_(std::move(outPath)), ar_(std::move(ar)) {}
+        /// @param ar Name of or path to the archiver to use. If empty, the archive is written by the compiler itself,
+        ///           which replaces any existing archive instead of adding the object files to it.
+        ArchivePhase(std::string outPath, std::string ar) : outPath_(std::move(outPath)), ar_(std::move(ar)) {}
         void perform(Compiler *compiler) override;
+        const char* name() const override { return "archive"; }
     private:
-        std::string objectFilePath_;
+        void writeArchive(Compiler *compiler);
+
         std::string outPath_;
         std::string ar_;
     };
@@ -161,12 +302,49 @@ public:
     /// @return True iff the compilation completed without error.
     bool compile();
 
+    /// Sets whether compile() measures the resources each phase uses and reports them to the delegate.
+    void setMeasures(bool measures) { measures_ = measures; }
+
+    /// Sets whether a warning is issued wherever a value is boxed on the heap. (See CodeGenerator::noteHeapBoxing.)
+    void setWarnsHeapBoxing(bool warns) { warnsHeapBoxing_ = warns; }
+    bool warnsHeapBoxing() const { return warnsHeapBoxing_; }
+
+    /// Sets whether dynamic dispatches on classes compare the class of the callee with the classes that can be
+    /// instances of the callee type and call the implementation directly if they match. (See CallCodeGenerator.)
+    void setUsesInlineCaches(bool uses) { usesInlineCaches_ = uses; }
+    bool usesInlineCaches() const { return usesInlineCaches_; }
+
+    /// Calls `fn` and, if enabled with setMeasures(), reports the resources it used as measurement `name` to the
+    /// delegate. Measurements can be nested. Must only be called on the thread that called compile().
+    template <typename F>
+    void measure(const std::string &name, F &&fn) {
+        if (!measures_) {
+            fn();
+            return;
+        }
+        auto start = startMeasurement();
+        try {
+            fn();
+        }
+        catch (...) {
+            finishMeasurement(name, start);
+            throw;
+        }
+        finishMeasurement(name, start);
+    }
+
     RecordingPackage* mainPackage() const { return mainPackage_.get(); }
 
     std::vector<Package *> importedPackages() const { return packageImportOrder_; }
 
     SourceManager &sourceManager() { return sourceManager_; }
 
+    /// The CodeGenerator created by GenerationPhase or nullptr if no code was generated.
+    CodeGenerator* generator() const { return generator_.get(); }
+
+    /// The exit code of the program that RunPhase ran or 0 if no program was run.
+    int exitCode() const { return exitCode_; }
+
     /// Issues a compiler warning. The compilation is continued normally.
     /// @param args All arguments will be concatenated.
     template<typename... Args>
@@ -176,9 +354,10 @@ public:
         warn(p, stream.str());
     }
 
-    /// Issues a compiler warning. The compilation is continued normally.
+    /// Issues a compiler warning. The compilation is continued normally. Can be called from any thread.
     void warn(const SourcePosition &p, const std::string &warning);
-    /// Issues a compiler error. The compilation can continue, but no code will be generated.
+    /// Issues a compiler error. The compilation can continue, but no code will be generated. Can be called from any
+    /// thread.
     void error(const CompilerError &ce);
 
     /// Loads the package with the given name. If the package has already been loaded it is returned immediately.
@@ -188,26 +367,67 @@ public:
 
     void assignSTypes(Package *s);
 
+    /// Returns the path of the directory of the package with the given name.
+    /// @throws CompilerError if the package cannot be found in any search path.
+    std::string searchPackage(const std::string &name, const SourcePosition &p);
+
+    /// Returns the path of the interface file of the package at `packagePath`.
+    /// @throws CompilerError if the package provides two interface files.
+    std::string interfacePath(const std::string &packagePath, const std::string &packageName,
+                              const SourcePosition &p) const;
+
     Class *sString = nullptr;
     Class *sError = nullptr;
     ValueType *sList = nullptr;
     ValueType *sDictionary = nullptr;
+    ValueType *sRange = nullptr;
+    ValueType *sSlice = nullptr;
+    Class *sData = nullptr;
+    Class *sEncoder = nullptr;
+    Class *sDecoder = nullptr;
+    Class *sDecodingError = nullptr;
     Protocol *sEnumerable = nullptr;
     Protocol *sInterpolateable = nullptr;
+    Protocol *sSerializable = nullptr;
     ValueType *sBoolean = nullptr;
     ValueType *sInteger = nullptr;
     ValueType *sReal = nullptr;
     ValueType *sMemory = nullptr;
     ValueType *sByte = nullptr;
+    /// The unsigned integer types 🔢🔸🥉, 🔢🔸🥈 and 🔢🔸🥇, which are 8, 16 and 32 bits wide.
+    ValueType *sUInt8 = nullptr;
+    ValueType *sUInt16 = nullptr;
+    ValueType *sUInt32 = nullptr;
     ValueType *sWeak = nullptr;
+    /// 🛰, whose type method 🔭 is generated as a read of the run-time library's tracing flag.
+    ValueType *sTracing = nullptr;
+    /// The vector types 🚂🔸💯, 🚂🔸🔢 and 🚂🔸💧, which are lowered to LLVM vectors.
+    ValueType *sRealVector = nullptr;
+    ValueType *sIntegerVector = nullptr;
+    ValueType *sByteVector = nullptr;
+
+    /// Returns true if *type* is 🔢🔸🥉, 🔢🔸🥈 or 🔢🔸🥇.
+    bool isUnsignedInteger(const ValueType *type) const {
+        return type == sUInt8 || type == sUInt16 || type == sUInt32;
+    }
 
     ~Compiler();
 
 private:
+    struct MeasurementStart {
+        std::chrono::steady_clock::time_point wall;
+        std::clock_t cpu;
+    };
+
+    MeasurementStart startMeasurement();
+    void finishMeasurement(const std::string &name, const MeasurementStart &start);
+
     std::vector<std::unique_ptr<Phase>> phases_;
-    std::string searchPackage(const std::string &name, const SourcePosition &p);
     void parseInterface(Package *pkg, const SourcePosition &p);
     std::string findBinaryPathPackage(const std::string &packagePath, const std::string &packageName);
+    /// Returns the archives of the imported packages, each followed by the libraries it requires as `-l` options,
+    /// and the run-time library in the order in which they must be passed to the linker.
+    std::vector<std::string> linkInputs();
 
     /// Searches the loaded packages for the package with the given name.
     /// If the package has not been loaded yet @c nullptr is returned.
@@ -217,10 +437,24 @@ private:
     std::vector<Package *> packageImportOrder_;
 
     bool hasError_ = false;
+    /// Serializes calls to the delegate from error() and warn().
+    std::mutex messageMutex_;
     std::string mainFile_;
     const std::vector<std::string> packageSearchPaths_;
     const std::unique_ptr<CompilerDelegate> delegate_;
     std::unique_ptr<CodeGenerator> generator_;
+    /// The object files that ObjectFileEmissionPhase emitted or CacheLookupPhase restored.
+    std::vector<std::string> objectFilePaths_;
+    std::unique_ptr<CompilationCache> cache_;
+    /// Whether CacheLookupPhase restored the artifacts.
+    bool restoredFromCache_ = false;
+    int exitCode_ = 0;
+    bool measures_ = false;
+    bool warnsHeapBoxing_ = false;
+    bool usesInlineCaches_ = false;
+    /// The number of measurements that have been started but not finished.
+    unsigned measurementDepth_ = 0;
+    std::chrono::steady_clock::time_point compilationStart_;
     std::unique_ptr<RecordingPackage> mainPackage_;
     SourceManager sourceManager_;
 };
@@ -101,11 +101,19 @@ enum Emojis {
     E_BATTERY = 0x1F50B,
     E_EIGHT_POINTED_STAR = 0x2734,
     E_BAGEL = 0x1F96F,
+    E_COLD_FACE = 0x1F976,
+    E_HOT_FACE = 0x1F975,
+    E_PRETZEL = 0x1F968,
+    E_CANNED_FOOD = 0x1F96B,
+    E_PANCAKES = 0x1F95E,
+    E_SOAP = 0x1F9FC,
+    E_SWIMMER = 0x1F3CA,
     E_CONSTRUCTION_SIGN = 0x1F6A7,
     E_RED_TRIANGLE_POINTED_UP = 0x1F53A,
     E_SMALL_ORANGE_DIAMOND = 0x1F538,
     E_PINE_DECORATION = 0x1F38D,
     E_OIL_DRUM = 0x1F6E2,
+    E_LEVEL_SLIDER = 0x1F39A,
     E_HAND_POINTING_DOWN = 0x1F447,
     E_MAGNET = U'🧲',
     E_CHEERING_MEGAPHONE = U'📣',
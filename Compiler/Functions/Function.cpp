@@ -44,9 +44,12 @@ TypeContext Function::typeContext() {
 }
 
 bool Function::isInline() const {
-    return forceInline_ || (ast() != nullptr && ast()->stmtsSize() <= 2 &&
-                            functionType() != FunctionType::Deinitializer &&
-                            functionType() != FunctionType::CopyRetainer);
+    if (neverInline_) {
+        return false;
+    }
+    auto shortAst = ast() != nullptr ? ast()->stmtsSize() <= 2 : shortAst_;
+    return forceInline_ || alwaysInline_ || (shortAst && functionType() != FunctionType::Deinitializer &&
+                                             functionType() != FunctionType::CopyRetainer);
 }
 
 Function::~Function() = default;
@@ -55,4 +58,11 @@ void Function::setAst(std::unique_ptr<ASTBlock> ast) {
     ast_ = std::move(ast);
 }
 
+void Function::releaseAst() {
+    if (ast_ != nullptr) {
+        shortAst_ = ast_->stmtsSize() <= 2;
+        ast_.reset();
+    }
+}
+
 }  // namespace EmojicodeCompiler
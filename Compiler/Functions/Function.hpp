@@ -85,6 +85,9 @@ public:
         external_ = true;
         externalName_ = name;
     }
+    /// Makes the function, which has a body, callable from C and C++ under *name*. The function is generated with the
+    /// calling convention of external functions, i.e. non-primitive value types are passed by reference.
+    void exportAs(const std::string &name) { externalName_ = name; }
 
     /// The type definition in which this function was defined.
     /// @returns nullptr if the function does not belong to a type (is not a method or initializer).
@@ -98,6 +101,10 @@ public:
 
     Function* superFunction() const { return superFunction_; }
     void setSuperFunction(Function *function) { superFunction_ = function; }
+    /// Whether a method of a subclass in this package overrides this method.
+    /// @see setOverridden()
+    bool overridden() const { return overridden_; }
+    void setOverridden() { overridden_ = true; }
 
     /** Whether the method is deprecated. */
     bool deprecated() const { return deprecated_; }
@@ -112,6 +119,32 @@ public:
 
     bool isInline() const;
 
+    /// Whether the function was marked with 🥶 as rarely called, e.g. because it panics. Calls to it are treated as
+    /// unlikely paths and are kept out of the hot code of the caller.
+    bool isCold() const { return cold_; }
+    void setCold() { cold_ = true; }
+    /// Whether the function was marked with 🥵 as frequently called. It is placed with the other hot code and the
+    /// inliner is more willing to inline it.
+    bool isHot() const { return hot_; }
+    void setHot() { hot_ = true; }
+    /// Whether the function was marked with 🥨 and must be inlined into all its callers.
+    bool alwaysInline() const { return alwaysInline_; }
+    void setAlwaysInline() { alwaysInline_ = true; }
+    /// Whether the function was marked with 🥫 and must never be inlined, even if it is small.
+    bool neverInline() const { return neverInline_; }
+    void setNeverInline() { neverInline_ = true; }
+    /// Whether the function was marked with 🥞, which makes all functions that it calls statically be inlined into
+    /// it if possible.
+    bool flatten() const { return flatten_; }
+    void setFlatten() { flatten_ = true; }
+    /// Whether the function was marked with 🧼 as a native function without side effects, which only reads its
+    /// arguments and the memory they reference. Calls to it can be removed, merged or moved by the optimizer.
+    bool isPure() const { return pure_; }
+    void setPure() { pure_ = true; }
+    /// Whether `this` is passed to the function by value instead of by reference, which is the case for 🧼 methods
+    /// of value types.
+    bool passesThisByValue() const { return pure_ && functionType() == FunctionType::ValueTypeMethod; }
+
     void setThunk() { thunk_ = true; }
     bool isThunk() const { return thunk_; }
 
@@ -143,6 +176,9 @@ public:
 
     void setAst(std::unique_ptr<ASTBlock> ast);
     ASTBlock* ast() const { return ast_.get(); }
+    /// Destroys the syntax tree of this function including its closures to free the memory it takes up. Must only be
+    /// called once the code of all reifications has been generated. isInline() returns the same result afterwards.
+    void releaseAst();
 
     size_t variableCount() const { return variableCount_; }
     void setVariableCount(size_t variableCount) { variableCount_ = variableCount; }
@@ -165,17 +201,26 @@ private:
     std::unique_ptr<ASTType> returnType_;
     std::unique_ptr<ASTType> errorType_;
     std::unique_ptr<ASTBlock> ast_;
+    /// Whether the syntax tree released by releaseAst() was short enough for this function to be inlined.
+    bool shortAst_ = false;
 
     bool final_;
     bool deprecated_;
     Mood mood_;
     bool unsafe_;
     bool forceInline_ = false;
+    bool cold_ = false;
+    bool hot_ = false;
+    bool alwaysInline_ = false;
+    bool neverInline_ = false;
+    bool flatten_ = false;
+    bool pure_ = false;
     bool thunk_ = false;
 
     bool mutating_;
     bool external_ = false;
     bool closure_ = false;
+    bool overridden_ = false;
 
     Function *virtualTableThunk_ = nullptr;
     Function *superFunction_ = nullptr;
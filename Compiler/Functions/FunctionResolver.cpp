@@ -15,14 +15,13 @@
 #include "Analysis/SemanticAnalyser.hpp"
 #include "AST/ASTExpr.hpp"
 #include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <set>
+#include <unordered_map>
 
 namespace EmojicodeCompiler {
 
-bool operator <(const FunctionTableKey& x, const FunctionTableKey& y) {
-    return std::tie(x.paramCount, x.name, x.mood) < std::tie(y.paramCount, y.name, y.mood);
-}
-
 template <typename T>
 void FunctionResolver<T>::duplicateDeclarationCheck(T *function) {
     auto prev = map_.find(FunctionTableKey(function->name(), function->mood(), function->parameters().size()));
@@ -43,8 +42,111 @@ void FunctionResolver<T>::duplicateDeclarationCheck(T *function) {
     }
 }
 
+namespace {
+
+/// Incremented whenever a function is added to a resolver, which invalidates all cached resolutions.
+std::atomic<size_t> resolverGeneration{0};
+
+/// Everything the result of a resolution depends on.
+struct ResolutionKey {
+    const void *resolver;
+    const FunctionTableKey &function;
+    const Type &callee;
+    const std::vector<Type> &args;
+    const std::vector<Type> &genericArgs;
+    const TypeContext &typeContext;
+    SemanticAnalyser *analyser;
+
+    size_t hash() const {
+        auto hash = std::hash<const void *>()(resolver) * 31 + FunctionTableKeyHash()(function);
+        hash = hash * 31 + callee.exactHash();
+        for (auto &arg : args) {
+            hash = hash * 31 + arg.exactHash();
+        }
+        for (auto &arg : genericArgs) {
+            hash = hash * 31 + arg.exactHash();
+        }
+        hash = hash * 31 + typeContext.calleeType().exactHash();
+        hash = hash * 31 + std::hash<Function *>()(typeContext.function());
+        return hash * 31 + std::hash<SemanticAnalyser *>()(analyser);
+    }
+};
+
+bool equalsExactly(const std::vector<Type> &a, const std::vector<Type> &b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](auto &x, auto &y) { return x.equalsExactly(y); });
+}
+
+/// Caches the candidates selected by resolutions of a single resolver. Shared by all threads of the semantic analysis.
+template <typename T>
+class ResolutionCache {
+public:
+    static ResolutionCache& shared() {
+        static ResolutionCache cache;
+        return cache;
+    }
+
+    std::optional<Candidate<T>> find(const ResolutionKey &key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        validate();
+        auto it = entries_.find(key.hash());
+        if (it == entries_.end()) {
+            return std::nullopt;
+        }
+        for (auto &entry : it->second) {
+            if (entry.matches(key)) {
+                return entry.candidate;
+            }
+        }
+        return std::nullopt;
+    }
+
+    void insert(const ResolutionKey &key, const Candidate<T> &candidate) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        validate();
+        entries_[key.hash()].emplace_back(Entry{key.resolver, key.function, key.callee, key.args, key.genericArgs,
+                                                key.typeContext.calleeType(), key.typeContext.function(),
+                                                key.analyser, candidate});
+    }
+
+private:
+    struct Entry {
+        const void *resolver;
+        FunctionTableKey function;
+        Type callee;
+        std::vector<Type> args;
+        std::vector<Type> genericArgs;
+        Type contextCallee;
+        Function *contextFunction;
+        SemanticAnalyser *analyser;
+        Candidate<T> candidate;
+
+        bool matches(const ResolutionKey &key) const {
+            return resolver == key.resolver && analyser == key.analyser && function == key.function &&
+                contextFunction == key.typeContext.function() && callee.equalsExactly(key.callee) &&
+                contextCallee.equalsExactly(key.typeContext.calleeType()) && equalsExactly(args, key.args) &&
+                equalsExactly(genericArgs, key.genericArgs);
+        }
+    };
+
+    /// Removes all entries if a function was added to a resolver since they were cached.
+    void validate() {
+        auto generation = resolverGeneration.load(std::memory_order_relaxed);
+        if (generation != generation_) {
+            entries_.clear();
+            generation_ = generation;
+        }
+    }
+
+    std::mutex mutex_;
+    std::unordered_map<size_t, std::vector<Entry>> entries_;
+    size_t generation_ = 0;
+};
+
+}  // namespace
+
 template <typename T>
 T* FunctionResolver<T>::add(std::unique_ptr<T> &&fn) {
+    resolverGeneration.fetch_add(1, std::memory_order_relaxed);
     auto rawPtr = fn.get();
     map_[FunctionTableKey(rawPtr->name(), rawPtr->mood(), rawPtr->parameters().size())].emplace_back(std::move(fn));
     list_.push_back(rawPtr);
@@ -169,8 +271,35 @@ bool FunctionResolution<T>::moreSpecific(Function *a, Function *b) const {
     return score > a->parameters().size() / 2;
 }
 
+template <typename T>
+void FunctionResolution<T>::setResolver(const FunctionResolver<T> *res) {
+    resolver_ = res;
+}
+
 template <typename T>
 std::optional<Candidate<T>> FunctionResolution<T>::resolve() {
+    // Function generic arguments provided by the type context are only set while a called function is analysed.
+    if (resolver_ == nullptr || typeContext_.functionGenericArguments() != nullptr) {
+        if (resolver_ != nullptr) {
+            addResolver(resolver_);
+        }
+        return select();
+    }
+
+    auto key = ResolutionKey{resolver_, key_, callee_, args_, genericArgs_, typeContext_, analyser_};
+    if (auto candidate = ResolutionCache<T>::shared().find(key)) {
+        return candidate;
+    }
+    addResolver(resolver_);
+    auto candidate = select();
+    if (candidate.has_value()) {
+        ResolutionCache<T>::shared().insert(key, *candidate);
+    }
+    return candidate;
+}
+
+template <typename T>
+std::optional<Candidate<T>> FunctionResolution<T>::select() {
     if (candidates_.empty()) { return std::nullopt; }
     if (auto f = pick()) { return f; }
 
@@ -279,7 +408,7 @@ template <typename T>
 T* FunctionResolver<T>::lookup(const std::u32string &name, Mood mood, const std::vector<Type> &args,
                                const Type &callee, const TypeContext &typeContext, SemanticAnalyser *analyser) const {
     auto resolver = FunctionResolution<T>(name, mood, args, {}, callee, typeContext, analyser, SourcePosition());
-    resolver.addResolver(this);
+    resolver.setResolver(this);
     if (auto candidate = resolver.resolve()) {
         return candidate->function;
     }
@@ -290,7 +419,7 @@ template <typename T>
 T* FunctionResolver<T>::get(const std::u32string &name, Mood mood, ASTArguments *args,
                             Type *callee, ExpressionAnalyser *analyser, const SourcePosition &p) const {
     auto resolver = FunctionResolution<T>(name, mood, args, *callee, analyser, p);
-    resolver.addResolver(this);
+    resolver.setResolver(this);
     if (auto candidate = resolver.resolveAndReificate(args, callee)) {
         return candidate;
     }
@@ -13,6 +13,7 @@
 #include <vector>
 #include <map>
 #include <list>
+#include <unordered_map>
 #include <optional>
 #include "AST/ASTExpr.hpp"
 
@@ -36,6 +37,17 @@ struct FunctionTableKey {
     std::u32string name;
     Mood mood;
     int paramCount;
+
+    bool operator==(const FunctionTableKey &other) const {
+        return paramCount == other.paramCount && mood == other.mood && name == other.name;
+    }
+};
+
+struct FunctionTableKeyHash {
+    size_t operator()(const FunctionTableKey &key) const {
+        return std::hash<std::u32string>()(key.name) * 31 + static_cast<size_t>(key.paramCount) * 2 +
+            static_cast<size_t>(key.mood);
+    }
 };
 
 template <typename T>
@@ -74,7 +86,7 @@ public:
 
 private:
     std::vector<T*> list_;
-    std::map<FunctionTableKey, std::vector<std::unique_ptr<T>>> map_;
+    std::unordered_map<FunctionTableKey, std::vector<std::unique_ptr<T>>, FunctionTableKeyHash> map_;
 
     FunctionResolver *super_ = nullptr;
 };
@@ -93,6 +105,9 @@ public:
 
     /// Adds the suitable functions of a resolver to the resolution.
     void addResolver(const FunctionResolver<T> *res);
+    /// Makes @c res the only resolver of this resolution. Unlike with addResolver(), the selected function is cached
+    /// and reused by later resolutions with exactly equal types.
+    void setResolver(const FunctionResolver<T> *res);
 
     /// Selects the most suitable function from the resolvers.
     std::optional<Candidate<T>> resolve();
@@ -123,6 +138,10 @@ private:
     const SourcePosition p_;
 
     std::optional<Candidate<T>> pick();
+    std::optional<Candidate<T>> select();
+
+    /// The resolver set with setResolver() or nullptr.
+    const FunctionResolver<T> *resolver_ = nullptr;
 
     std::vector<Candidate<T>> candidates_;
     std::vector<NonCandidate> nonCandidates_;
@@ -98,6 +98,12 @@ void buildDestructor(CodeGenerator *cg, TypeDefinition *typeDef) {
 
 
 std::pair<llvm::Function*, llvm::Function*> buildBoxRetainRelease(CodeGenerator *cg, const Type &type) {
+    if (type.isTriviallyCopyable()) {
+        // All trivially copyable types share the same function so that ejcCopyBoxes can recognize them.
+        auto trivial = cg->runTime().trivialBoxRetainRelease();
+        return std::make_pair(trivial, trivial);
+    }
+
     auto release = createFunction(cg, mangleBoxRelease(type));
     auto retain = createFunction(cg, mangleBoxRetain(type));
 
@@ -17,7 +17,9 @@ class Type;
 class ValueType;
 class TypeDefinition;
 
-std::pair<llvm::Function*, llvm::Function*> buildBoxRetainRelease(CodeGenerator *cg, const Type &type); 
+/// Builds the functions that retain and release a box containing a value of the given type. If the type is trivially
+/// copyable, RunTimeHelper::trivialBoxRetainRelease() is returned for both.
+std::pair<llvm::Function*, llvm::Function*> buildBoxRetainRelease(CodeGenerator *cg, const Type &type);
 void buildCopyRetain(CodeGenerator *cg, ValueType *typeDef);
 void buildDestructor(CodeGenerator *cg, TypeDefinition *typeDef);
 llvm::Function* createMemoryFunction(const std::string &str, CodeGenerator *cg, TypeDefinition *typeDef);
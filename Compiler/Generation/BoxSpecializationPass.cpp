@@ -0,0 +1,198 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "BoxSpecializationPass.hpp"
+#include <llvm/ADT/APInt.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+#include <algorithm>
+#include <vector>
+
+namespace EmojicodeCompiler {
+
+char BoxSpecializationPass::id = 0;
+
+bool BoxSpecializationPass::runOnModule(llvm::Module &module) {
+    dataLayout_ = &module.getDataLayout();
+
+    // Clones are added to the module while it is transformed and must not be specialized again.
+    std::vector<llvm::Function *> functions;
+    for (auto &function : module) {
+        if (!function.isDeclaration() && function.hasLocalLinkage() && !function.isVarArg()) {
+            functions.emplace_back(&function);
+        }
+    }
+
+    bool modified = false;
+    for (auto function : functions) {
+        modified |= specialize(function);
+    }
+    return modified;
+}
+
+bool BoxSpecializationPass::specialize(llvm::Function *function) {
+    std::vector<llvm::CallInst *> calls;
+    for (auto &use : function->uses()) {
+        auto call = llvm::dyn_cast<llvm::CallInst>(use.getUser());
+        if (call == nullptr || !call->isCallee(&use)) {
+            return false;
+        }
+        calls.emplace_back(call);
+    }
+    if (calls.empty()) {
+        return false;
+    }
+
+    bool modified = false;
+    llvm::Argument *cloneArg = nullptr;
+    std::vector<llvm::Constant *> cloneBoxInfos;
+    std::vector<llvm::Constant *> callBoxInfos;
+
+    for (auto &arg : function->args()) {
+        if ((arg.getType() != boxType_ && arg.getType() != callableType_) || arg.use_empty()) {
+            continue;
+        }
+
+        std::vector<llvm::Constant *> boxInfos;
+        std::vector<llvm::Constant *> perCall;
+        for (auto call : calls) {
+            auto boxInfo = constantBoxInfo(call->getArgOperand(arg.getArgNo()));
+            if (boxInfo == nullptr) {
+                break;
+            }
+            perCall.emplace_back(boxInfo);
+            if (std::find(boxInfos.begin(), boxInfos.end(), boxInfo) == boxInfos.end()) {
+                boxInfos.emplace_back(boxInfo);
+            }
+        }
+        if (perCall.size() != calls.size()) {
+            continue;
+        }
+
+        if (boxInfos.size() == 1) {
+            fixBoxInfo(function, arg.getArgNo(), boxInfos.front());
+            modified = true;
+        }
+        else if (clones_ && cloneArg == nullptr && boxInfos.size() <= kMaxSpecializations && readsBoxInfo(&arg)) {
+            cloneArg = &arg;
+            cloneBoxInfos = std::move(boxInfos);
+            callBoxInfos = std::move(perCall);
+        }
+    }
+
+    if (cloneArg == nullptr) {
+        return modified;
+    }
+    size_t instructions = 0;
+    for (auto &block : *function) {
+        instructions += block.size();
+    }
+    if (instructions > kMaxClonedInstructions) {
+        return modified;
+    }
+
+    // The original function is kept for the first constant, the calls passing another constant call a clone.
+    auto argNo = cloneArg->getArgNo();
+    for (size_t i = 1; i < cloneBoxInfos.size(); i++) {
+        llvm::ValueToValueMapTy map;
+        auto clone = llvm::CloneFunction(function, map);
+        clone->setName(function->getName() + ".box" + std::to_string(i));
+        for (size_t j = 0; j < calls.size(); j++) {
+            if (callBoxInfos[j] == cloneBoxInfos[i]) {
+                calls[j]->setCalledFunction(clone);
+            }
+        }
+        fixBoxInfo(clone, argNo, cloneBoxInfos[i]);
+    }
+    fixBoxInfo(function, argNo, cloneBoxInfos.front());
+    return true;
+}
+
+llvm::Constant* BoxSpecializationPass::constantBoxInfo(llvm::Value *box) {
+    if (auto constant = llvm::dyn_cast<llvm::Constant>(box)) {
+        auto boxInfo = constant->getAggregateElement(0u);
+        return boxInfo != nullptr && !llvm::isa<llvm::UndefValue>(boxInfo) ? boxInfo : nullptr;
+    }
+    if (auto insert = llvm::dyn_cast<llvm::InsertValueInst>(box)) {
+        if (insert->getIndices().front() != 0) {
+            return constantBoxInfo(insert->getAggregateOperand());
+        }
+        auto boxInfo = llvm::dyn_cast<llvm::Constant>(insert->getInsertedValueOperand());
+        if (insert->getNumIndices() != 1 || boxInfo == nullptr || llvm::isa<llvm::UndefValue>(boxInfo)) {
+            return nullptr;
+        }
+        return boxInfo;
+    }
+    if (auto load = llvm::dyn_cast<llvm::LoadInst>(box)) {
+        return storedBoxInfo(load);
+    }
+    return nullptr;
+}
+
+llvm::Constant* BoxSpecializationPass::storedBoxInfo(llvm::LoadInst *load) {
+    auto box = llvm::dyn_cast<llvm::AllocaInst>(load->getPointerOperand()->stripPointerCasts());
+    if (box == nullptr) {
+        return nullptr;
+    }
+    auto boxType = load->getType();
+    auto boxInfoType = boxType->getContainedType(0);
+    auto pointerSize = dataLayout_->getTypeStoreSize(boxInfoType);
+
+    for (auto it = load->getIterator(), begin = load->getParent()->begin(); it != begin;) {
+        auto inst = &*--it;
+        auto store = llvm::dyn_cast<llvm::StoreInst>(inst);
+        if (store == nullptr) {
+            if (inst->mayWriteToMemory()) {
+                return nullptr;
+            }
+            continue;
+        }
+
+        llvm::APInt offset(dataLayout_->getIndexTypeSizeInBits(store->getPointerOperand()->getType()), 0);
+        auto base = store->getPointerOperand()->stripAndAccumulateInBoundsConstantOffsets(*dataLayout_, offset);
+        if (base != box) {
+            // Another alloca cannot alias the box. Anything else could.
+            if (llvm::isa<llvm::AllocaInst>(base)) {
+                continue;
+            }
+            return nullptr;
+        }
+        if (offset.uge(pointerSize)) {
+            // A store into the value of the box.
+            continue;
+        }
+        if (!offset.isNullValue()) {
+            return nullptr;
+        }
+
+        auto value = store->getValueOperand();
+        if (value->getType() == boxType) {
+            return constantBoxInfo(value);
+        }
+        auto boxInfo = llvm::dyn_cast<llvm::Constant>(value);
+        if (value->getType() != boxInfoType || boxInfo == nullptr || llvm::isa<llvm::UndefValue>(boxInfo)) {
+            return nullptr;
+        }
+        return boxInfo;
+    }
+    return nullptr;
+}
+
+void BoxSpecializationPass::fixBoxInfo(llvm::Function *function, unsigned int argNo, llvm::Constant *boxInfo) {
+    auto arg = function->arg_begin() + argNo;
+    auto insertionPoint = &*function->getEntryBlock().getFirstInsertionPt();
+    auto box = llvm::InsertValueInst::Create(arg, boxInfo, 0, "", insertionPoint);
+    arg->replaceAllUsesWith(box);
+    box->setOperand(0, arg);
+}
+
+bool BoxSpecializationPass::readsBoxInfo(llvm::Argument *arg) {
+    return std::any_of(arg->user_begin(), arg->user_end(), [](llvm::User *user) {
+        auto extract = llvm::dyn_cast<llvm::ExtractValueInst>(user);
+        return extract != nullptr && extract->getIndices().front() == 0;
+    });
+}
+
+}  // namespace EmojicodeCompiler
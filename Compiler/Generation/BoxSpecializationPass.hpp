@@ -0,0 +1,66 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#ifndef EMOJICODE_BOXSPECIALIZATIONPASS_HPP
+#define EMOJICODE_BOXSPECIALIZATIONPASS_HPP
+
+#include <llvm/IR/Module.h>
+#include <llvm/Pass.h>
+
+namespace llvm {
+class LoadInst;
+}  // namespace llvm
+
+namespace EmojicodeCompiler {
+
+/// Specializes private functions with parameters of a protocol, multiprotocol or generic type, which are passed in
+/// boxes, for the concrete types their callers pass.
+///
+/// The first field of a box points to the protocol conformance or box info of the boxed type. If every call of a
+/// function passes a box whose first field is a constant, the function is changed to use that constant instead of the
+/// first field of the parameter. The optimizations that follow then load the method from the constant conformance and
+/// turn the dynamic protocol dispatch into a direct call, which can be inlined.
+///
+/// Parameters of a callable type are specialized in the same way for the function pointer in their first field, if the
+/// callers pass closures. The calls of the callable in the function then become direct calls of the closure, which can
+/// be inlined, so that a function taking a callback costs no more than a loop.
+///
+/// If the callers pass up to kMaxSpecializations different constants, the function is cloned for each of them as long
+/// as it is not larger than kMaxClonedInstructions instructions, and the calls are redirected to the clones. Functions
+/// are not cloned when optimizing for size.
+class BoxSpecializationPass : public llvm::ModulePass {
+public:
+    static char id;
+
+    /// @param clones Whether functions may be cloned for different constants.
+    BoxSpecializationPass(llvm::Type *boxType, llvm::Type *callableType, bool clones)
+        : ModulePass(id), boxType_(boxType), callableType_(callableType), clones_(clones) {}
+
+    bool runOnModule(llvm::Module &module) override;
+private:
+    static constexpr size_t kMaxSpecializations = 4;
+    static constexpr size_t kMaxClonedInstructions = 250;
+
+    llvm::Type *boxType_;
+    llvm::Type *callableType_;
+    bool clones_;
+    const llvm::DataLayout *dataLayout_ = nullptr;
+
+    bool specialize(llvm::Function *function);
+
+    /// Returns the constant first field of the box *box* or null if it is not known to be constant.
+    llvm::Constant* constantBoxInfo(llvm::Value *box);
+    /// Returns the constant that was stored into the first field of the box or callable that *load* loads or null if it
+    /// is not known. Only stores that precede *load* in its block are considered.
+    llvm::Constant* storedBoxInfo(llvm::LoadInst *load);
+
+    /// Replaces all uses of the argument *argNo* of *function* with a box that has *boxInfo* as first field.
+    void fixBoxInfo(llvm::Function *function, unsigned int argNo, llvm::Constant *boxInfo);
+    /// Returns true if the first field of the argument is read directly, i.e. if fixing it can devirtualize calls.
+    bool readsBoxInfo(llvm::Argument *arg);
+};
+
+}  // namespace EmojicodeCompiler
+
+#endif //EMOJICODE_BOXSPECIALIZATIONPASS_HPP
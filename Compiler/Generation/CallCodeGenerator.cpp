@@ -10,10 +10,13 @@
 #include "AST/ASTExpr.hpp"
 #include "FunctionCodeGenerator.hpp"
 #include "Functions/Initializer.hpp"
+#include "Compiler.hpp"
+#include "Types/Class.hpp"
 #include "Types/Protocol.hpp"
 #include "Types/TypeDefinition.hpp"
 #include "Generation/TypeDescriptionGenerator.hpp"
 #include <llvm/Support/raw_ostream.h>
+#include <map>
 #include <stdexcept>
 
 namespace EmojicodeCompiler {
@@ -24,27 +27,57 @@ CallCodeGenerator::~CallCodeGenerator() = default;
 llvm::Value *CallCodeGenerator::generate(llvm::Value *callee, const Type &type, const ASTArguments &astArgs,
                                          Function *function, llvm::Value *errorPointer,
                                          const std::vector<llvm::Value *> &supplArgs) {
-    auto args = createArgsVector(callee, astArgs, errorPointer, supplArgs);
-
     assert(function != nullptr);
+    auto errorArgument = prepareErrorArgument(function, errorPointer);
+    auto args = createArgsVector(callee, astArgs, errorArgument, supplArgs);
+
+    auto returnValue = passIndirectly(function->reificationFor(astArgs.genericArgumentTypes()).functionType(), &args);
+    auto value = dispatch(type, astArgs, function, std::move(args));
+    if (errorPointer != nullptr) {
+        fg()->storeErrorArgument(errorArgument, errorPointer);
+    }
+    return returnValue != nullptr ? fg()->builder().CreateLoad(returnValue) : value;
+}
+
+llvm::Value* CallCodeGenerator::prepareErrorArgument(Function *function, llvm::Value *errorPointer) {
+    swiftError_ = errorPointer != nullptr && fg()->typeHelper().takesSwiftError(function);
+    return errorPointer != nullptr ? fg()->errorPointerArgument(errorPointer, swiftError_) : nullptr;
+}
+
+llvm::CallInst* CallCodeGenerator::markSwiftError(llvm::CallInst *call) const {
+    if (swiftError_) {
+        call->addParamAttr(call->getNumArgOperands() - 1, llvm::Attribute::SwiftError);
+    }
+    return call;
+}
+
+llvm::Value *CallCodeGenerator::dispatch(const Type &type, const ASTArguments &astArgs, Function *function,
+                                         std::vector<llvm::Value *> args) {
     switch (callType_) {
         case CallType::StaticContextfreeDispatch:
         case CallType::StaticDispatch: {
             auto llvmFn = function->reificationFor(astArgs.genericArgumentTypes()).function;
             llvm::Type *castTo = nullptr;
-            if (!args.empty() && args.front()->getType() != llvmFn->args().begin()->getType()) {
+            if (function->passesThisByValue() &&
+                args.front()->getType() == llvmFn->args().begin()->getType()->getPointerTo()) {
+                args.front() = fg()->builder().CreateLoad(args.front());
+            }
+            else if (!args.empty() && args.front()->getType() != llvmFn->args().begin()->getType()) {
                 if (function->functionType() == FunctionType::ObjectInitializer) {
                     castTo = args.front()->getType();
                 }
                 args.front() = fg()->builder().CreateBitCast(args.front(), llvmFn->args().begin()->getType());
             }
-            auto ret = fg_->builder().CreateCall(llvmFn, args);
+            auto ret = markSwiftError(fg_->builder().CreateCall(llvmFn, args));
+            if (fg_->flattens() && !function->neverInline()) {
+                ret->addAttribute(llvm::AttributeList::FunctionIndex, llvm::Attribute::AlwaysInline);
+            }
             return castTo == nullptr ? ret : fg_->builder().CreateBitCast(ret, castTo);
         }
         case CallType::DynamicDispatch:
         case CallType::DynamicDispatchOnType:
             assert(type.type() == TypeType::Class);
-            return createDynamicDispatch(function, args, astArgs.genericArgumentTypes());
+            return createDynamicDispatch(function, type.klass(), args, astArgs.genericArgumentTypes());
         case CallType::DynamicProtocolDispatch: {
             assert(type.type() == TypeType::Box);
 
@@ -74,6 +107,28 @@ llvm::Value* CallCodeGenerator::buildFindProtocolConformance(const std::vector<l
     return fg()->buildFindProtocolConformance(args.front(), boxInfo, protocol.protocol()->rtti());
 }
 
+llvm::Value* CallCodeGenerator::passIndirectly(llvm::FunctionType *functionType, std::vector<llvm::Value *> *args) {
+    // The context is passed as is, even if the function expects a pointer to it, e.g. for protocol dispatch.
+    size_t first = callType_ == CallType::StaticContextfreeDispatch ? 0 : 1;
+    llvm::Value *returnValue = nullptr;
+    if (functionType->getNumParams() == args->size() + 1) {
+        auto type = functionType->getParamType(first)->getPointerElementType();
+        returnValue = fg()->createEntryAlloca(type, "ret");
+        args->insert(args->begin() + first++, returnValue);
+    }
+    for (size_t i = first; i < args->size(); i++) {
+        auto &arg = (*args)[i];
+        auto paramType = functionType->getParamType(i);
+        if (paramType != arg->getType() && paramType->isPointerTy() &&
+            paramType->getPointerElementType() == arg->getType()) {
+            auto copy = fg()->createEntryAlloca(arg->getType(), "arg");
+            fg()->builder().CreateStore(arg, copy);
+            arg = copy;
+        }
+    }
+    return returnValue;
+}
+
 std::vector<Value *> CallCodeGenerator::createArgsVector(llvm::Value *callee, const ASTArguments &args,
                                                          llvm::Value *errorPointer,
                                                          const std::vector<llvm::Value *> &supplArgs) {
@@ -101,7 +156,9 @@ llvm::Value *MultiprotocolCallCodeGenerator::generate(llvm::Value *callee, const
     assert(calleeType.type() == TypeType::Box);
     assert(function != nullptr);
 
-    auto argsv = createArgsVector(callee, args, errorPointer, {});
+    auto errorArgument = prepareErrorArgument(function, errorPointer);
+    auto argsv = createArgsVector(callee, args, errorArgument, {});
+    auto returnValue = passIndirectly(function->reificationFor(args.genericArgumentTypes()).functionType(), &argsv);
 
     llvm::Value *conformance;
     if (calleeType.boxedFor().type() != TypeType::MultiProtocol) {
@@ -115,16 +172,28 @@ llvm::Value *MultiprotocolCallCodeGenerator::generate(llvm::Value *callee, const
 
         conformance = fg()->builder().CreateLoad(fg()->builder().CreateConstGEP2_32(mpt, mpl, 0, multiprotocolN));
     }
-    return createDynamicProtocolDispatch(function, std::move(argsv), args.genericArgumentTypes(), conformance);
+    auto value = createDynamicProtocolDispatch(function, std::move(argsv), args.genericArgumentTypes(), conformance);
+    if (errorPointer != nullptr) {
+        fg()->storeErrorArgument(errorArgument, errorPointer);
+    }
+    return returnValue != nullptr ? fg()->builder().CreateLoad(returnValue) : value;
 }
 
 llvm::Value *CallCodeGenerator::dispatchFromVirtualTable(Function *function, llvm::Value *virtualTable,
                                                          const std::vector<llvm::Value *> &args,
                                                          const std::vector<Type> &genericArguments) {
-    auto reification = function->reificationFor(genericArguments);
-    auto id = fg()->int32(reification.vti());
+    auto id = fg()->int32(function->reificationFor(genericArguments).vti());
     auto dispatchedFunc = fg()->builder().CreateLoad(fg()->builder().CreateInBoundsGEP(virtualTable, id));
 
+    auto funcType = dispatchedFunctionType(function, args, genericArguments);
+    auto func = fg()->builder().CreateBitCast(dispatchedFunc, funcType->getPointerTo(), "dispatchFunc");
+    return markSwiftError(fg_->builder().CreateCall(funcType, func, args));
+}
+
+llvm::FunctionType* CallCodeGenerator::dispatchedFunctionType(Function *function,
+                                                              const std::vector<llvm::Value *> &args,
+                                                              const std::vector<Type> &genericArguments) {
+    auto reification = function->reificationFor(genericArguments);
     std::vector<llvm::Type *> argTypes = reification.functionType()->params();
     if (callType_ == CallType::DynamicProtocolDispatch) {
         argTypes.front() = llvm::Type::getInt8PtrTy(fg()->generator()->context());
@@ -136,19 +205,91 @@ llvm::Value *CallCodeGenerator::dispatchFromVirtualTable(Function *function, llv
         assert(argTypes.front() == args.front()->getType());
     }
 
-    auto funcType = llvm::FunctionType::get(reification.functionType()->getReturnType(), argTypes, false);
-    auto func = fg()->builder().CreateBitCast(dispatchedFunc, funcType->getPointerTo(), "dispatchFunc");
-    return fg_->builder().CreateCall(funcType, func, args);
+    return llvm::FunctionType::get(reification.functionType()->getReturnType(), argTypes, false);
 }
 
-llvm::Value *CallCodeGenerator::createDynamicDispatch(Function *function, const std::vector<llvm::Value *> &args,
+llvm::Value *CallCodeGenerator::createDynamicDispatch(Function *function, Class *klass,
+                                                      const std::vector<llvm::Value *> &args,
                                                       const std::vector<Type> &genericArgs) {
     auto info = callType_ == CallType::DynamicDispatchOnType ? args.front() : fg()->buildGetClassInfoFromObject(args.front());
+    if (fg()->generator()->compiler()->usesInlineCaches()) {
+        auto classes = cachedClasses(klass);
+        if (!classes.empty()) {
+            return createCachedDispatch(function, info, classes, args, genericArgs);
+        }
+    }
     auto tablePtr = fg()->builder().CreateConstInBoundsGEP2_32(fg_->typeHelper().classInfo(), info, 0, 1);
     auto table = fg()->builder().CreateLoad(tablePtr, "table");
     return dispatchFromVirtualTable(function, table, args, genericArgs);
 }
 
+std::vector<Class *> CallCodeGenerator::cachedClasses(Class *klass) const {
+    std::vector<Class *> classes = { klass };
+    for (size_t i = 0; i < classes.size(); i++) {
+        auto &subclasses = classes[i]->subclasses();
+        if (classes.size() + subclasses.size() > kMaxCachedClasses) {
+            return {};
+        }
+        classes.insert(classes.end(), subclasses.begin(), subclasses.end());
+    }
+    return classes;
+}
+
+llvm::Value *CallCodeGenerator::createCachedDispatch(Function *function, llvm::Value *info,
+                                                     const std::vector<Class *> &classes,
+                                                     const std::vector<llvm::Value *> &args,
+                                                     const std::vector<Type> &genericArgs) {
+    auto &builder = fg()->builder();
+    auto &context = fg()->generator()->context();
+    auto llvmFunction = builder.GetInsertBlock()->getParent();
+    auto vti = function->reificationFor(genericArgs).vti();
+    auto funcType = dispatchedFunctionType(function, args, genericArgs);
+
+    auto miss = llvm::BasicBlock::Create(context, "cacheMiss", llvmFunction);
+    auto end = llvm::BasicBlock::Create(context, "cacheEnd", llvmFunction);
+    std::vector<std::pair<llvm::Value *, llvm::BasicBlock *>> results;
+    // Subclasses that do not override the method share one call.
+    std::map<llvm::Constant *, llvm::BasicBlock *> hits;
+
+    for (size_t i = 0; i < classes.size(); i++) {
+        auto next = miss;
+        if (i + 1 < classes.size()) {
+            next = llvm::BasicBlock::Create(context, "cacheCheck", llvmFunction, miss);
+        }
+        auto classInfo = llvm::ConstantExpr::getBitCast(classes[i]->classInfo(), info->getType());
+        auto target = classes[i]->virtualTable()[vti];
+        auto hit = hits.find(target);
+        if (hit != hits.end()) {
+            builder.CreateCondBr(builder.CreateICmpEQ(info, classInfo), hit->second, next);
+        }
+        else {
+            auto block = llvm::BasicBlock::Create(context, "cacheHit", llvmFunction, miss);
+            hits.emplace(target, block);
+            builder.CreateCondBr(builder.CreateICmpEQ(info, classInfo), block, next);
+            builder.SetInsertPoint(block);
+            auto func = llvm::ConstantExpr::getBitCast(target, funcType->getPointerTo());
+            results.emplace_back(markSwiftError(builder.CreateCall(funcType, func, args)), builder.GetInsertBlock());
+            builder.CreateBr(end);
+        }
+        builder.SetInsertPoint(next);
+    }
+
+    auto tablePtr = builder.CreateConstInBoundsGEP2_32(fg_->typeHelper().classInfo(), info, 0, 1);
+    auto value = dispatchFromVirtualTable(function, builder.CreateLoad(tablePtr, "table"), args, genericArgs);
+    results.emplace_back(value, builder.GetInsertBlock());
+    builder.CreateBr(end);
+
+    builder.SetInsertPoint(end);
+    if (funcType->getReturnType()->isVoidTy()) {
+        return value;
+    }
+    auto phi = builder.CreatePHI(funcType->getReturnType(), results.size());
+    for (auto &result : results) {
+        phi->addIncoming(result.first, result.second);
+    }
+    return phi;
+}
+
 llvm::Value *CallCodeGenerator::createDynamicProtocolDispatch(Function *function, std::vector<llvm::Value *> args,
                                                               const std::vector<Type> &genericArgs,
                                                               llvm::Value *conformance) {
@@ -23,6 +23,7 @@ namespace EmojicodeCompiler {
 class FunctionCodeGenerator;
 class Type;
 class Function;
+class Class;
 class ASTArguments;
 class TypeDescriptionGenerator;
 
@@ -63,15 +64,44 @@ protected:
                                                const std::vector<Type> &genericArgs,
                                                llvm::Value *conformance);
     llvm::Value* buildFindProtocolConformance(const std::vector<llvm::Value *> &args, const Type &protocol);
+    /// Adapts *args* to the calling convention of functions of type *functionType*: Values of parameters that are
+    /// passed indirectly are stored to memory and, if the return value is returned indirectly, memory for it is
+    /// inserted after the context. See LLVMTypeHelper::isPassedIndirectly.
+    /// @returns The memory to which the function will write its return value or nullptr.
+    llvm::Value* passIndirectly(llvm::FunctionType *functionType, std::vector<llvm::Value *> *args);
+    /// Determines whether *function* takes its error pointer as `swifterror` and returns the value to pass as error
+    /// pointer. See FunctionCodeGenerator::errorPointerArgument.
+    llvm::Value* prepareErrorArgument(Function *function, llvm::Value *errorPointer);
+    /// Marks the error pointer passed by *call* as `swifterror` if prepareErrorArgument() determined that the
+    /// function takes it as such. Calls via dispatch tables must be marked so that they are lowered like the callee.
+    llvm::CallInst* markSwiftError(llvm::CallInst *call) const;
 private:
-    llvm::Value *createDynamicDispatch(Function *function, const std::vector<llvm::Value *> &args,
+    llvm::Value *dispatch(const Type &type, const ASTArguments &astArgs, Function *function,
+                          std::vector<llvm::Value *> args);
+    /// The maximal number of classes an inline cache compares the class of the callee with.
+    static constexpr size_t kMaxCachedClasses = 4;
+
+    llvm::Value *createDynamicDispatch(Function *function, Class *klass, const std::vector<llvm::Value *> &args,
                                        const std::vector<Type> &genericArgs);
     llvm::Value *dispatchFromVirtualTable(Function *function, llvm::Value *virtualTable,
                                               const std::vector<llvm::Value *> &args,
                                               const std::vector<Type> &genericArguments);
+    /// Returns the type of the function that is called with `args` if `function` is dispatched dynamically.
+    llvm::FunctionType* dispatchedFunctionType(Function *function, const std::vector<llvm::Value *> &args,
+                                               const std::vector<Type> &genericArguments);
+    /// Compares the class info `info` with the class infos of `classes`. If one matches, the implementation from the
+    /// virtual table of that class is called directly, so that it can be inlined. Otherwise the function is dispatched
+    /// from the virtual table of `info`.
+    llvm::Value *createCachedDispatch(Function *function, llvm::Value *info, const std::vector<Class *> &classes,
+                                      const std::vector<llvm::Value *> &args,
+                                      const std::vector<Type> &genericArgs);
+    /// Returns `klass` and its subclasses, or an empty vector if there are more than kMaxCachedClasses of them, in
+    /// which case an inline cache would rarely hit early.
+    std::vector<Class *> cachedClasses(Class *klass) const;
     FunctionCodeGenerator *fg_;
     CallType callType_;
     std::unique_ptr<TypeDescriptionGenerator> tdg_;
+    bool swiftError_ = false;
 
     llvm::Value *getProtocolCallee(std::vector<llvm::Value *> &args, llvm::Value *conformance) const;
 };
@@ -7,6 +7,7 @@
 //
 
 #include "CodeGenerator.hpp"
+#include "Analysis/ConstantEvaluator.hpp"
 #include "Compiler.hpp"
 #include "CompilerError.hpp"
 #include "RunTimeHelper.hpp"
@@ -21,10 +22,18 @@
 #include "Types/TypeContext.hpp"
 #include "Creator.hpp"
 #include "RunTimeTypeInfoFlags.hpp"
+#include "Lex/SourceManager.hpp"
+#include "Utils/StringUtils.hpp"
 #include <algorithm>
+#include <llvm/BinaryFormat/Dwarf.h>
+#include <llvm/CodeGen/ParallelCG.h>
+#include <llvm/IR/DIBuilder.h>
 #include <llvm/IR/IRPrintingPasses.h>
 #include <llvm/IR/Verifier.h>
+#include <llvm/MC/SubtargetFeature.h>
 #include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/Path.h>
 #include <llvm/Support/TargetRegistry.h>
 #include <llvm/Support/TargetSelect.h>
 #include <llvm/Support/raw_ostream.h>
@@ -37,11 +46,13 @@
 
 namespace EmojicodeCompiler {
 
-CodeGenerator::CodeGenerator(Compiler *compiler, bool optimize)
+CodeGenerator::CodeGenerator(Compiler *compiler, OptimizationLevel optimizationLevel, std::string targetTriple,
+                             std::string cpu, const ProfileGuidance &profile, bool debugInfo)
 : compiler_(compiler), typeHelper_(context(), this),
   module_(std::make_unique<llvm::Module>(compiler->mainPackage()->name(), context())),
   pool_(std::make_unique<StringPool>(this)), runTime_(std::make_unique<RunTimeHelper>(this)),
-  optimizationManager_(std::make_unique<OptimizationManager>(module_.get(), optimize, runTime_.get())) {
+  targetTriple_(targetTriple.empty() ? llvm::sys::getDefaultTargetTriple() : std::move(targetTriple)),
+  cpu_(std::move(cpu)) {
     runTime_->declareRunTime();
 
     llvm::InitializeAllTargetInfos();
@@ -50,18 +61,62 @@ CodeGenerator::CodeGenerator(Compiler *compiler, bool optimize)
     llvm::InitializeAllAsmParsers();
     llvm::InitializeAllAsmPrinters();
 
-    auto targetTriple = llvm::sys::getDefaultTargetTriple();
-    std::string error;
-    auto target = llvm::TargetRegistry::lookupTarget(targetTriple, error);
-
-    auto cpu = "generic";
-    auto features = "";
+    if (cpu_ == "native") {
+        cpu_ = llvm::sys::getHostCPUName();
+        llvm::StringMap<bool> hostFeatures;
+        if (llvm::sys::getHostCPUFeatures(hostFeatures)) {
+            llvm::SubtargetFeatures features;
+            for (auto &feature : hostFeatures) {
+                features.AddFeature(feature.first(), feature.second);
+            }
+            features_ = features.getString();
+        }
+    }
 
-    llvm::TargetOptions opt;
-    targetMachine_ = target->createTargetMachine(targetTriple, cpu, features, opt, llvm::Reloc::PIC_);
+    targetMachine_ = createTargetMachine().release();
 
     module()->setDataLayout(targetMachine_->createDataLayout());
-    module()->setTargetTriple(targetTriple);
+    module()->setTargetTriple(targetMachine_->getTargetTriple().str());
+
+    // The run-time library only calls 🏁 of an executable. The symbols of executables with debug information are
+    // exported, so that profilers can name all functions.
+    std::string entryPoint;
+    auto package = compiler->mainPackage();
+    if (!debugInfo && package->hasStartFlagFunction() && !package->startFlagFunction()->isExternal()) {
+        entryPoint = mangleFunction(package->startFlagFunction(), {});
+    }
+    optimizationManager_ = std::make_unique<OptimizationManager>(module_.get(), optimizationLevel, runTime_.get(),
+                                                                 typeHelper_.box(), typeHelper_.callable(),
+                                                                 targetMachine_, profile,
+                                                                 entryPoint);
+
+    if (debugInfo) {
+        debugInfo_ = std::make_unique<llvm::DIBuilder>(*module());
+        auto file = debugInfo_->createFile(compiler->mainPackage()->name(), compiler->mainPackage()->path());
+        // DWARF does not know Emojicode. Debuggers treat C like a language without overloading and namespaces and
+        // therefore show the names as they are.
+        compileUnit_ = debugInfo_->createCompileUnit(llvm::dwarf::DW_LANG_C, file, "emojicodec",
+                                                     optimizationLevel != OptimizationLevel::None, "", 0);
+        module()->addModuleFlag(llvm::Module::Warning, "Debug Info Version", llvm::DEBUG_METADATA_VERSION);
+        module()->addModuleFlag(llvm::Module::Warning, "Dwarf Version", 4);
+    }
+}
+
+std::unique_ptr<llvm::TargetMachine> CodeGenerator::createTargetMachine() const {
+    std::string error;
+    auto target = llvm::TargetRegistry::lookupTarget(targetTriple_, error);
+    if (target == nullptr) {
+        throw CompilerError(SourcePosition(), "Cannot generate code for ", targetTriple_, ": ", error);
+    }
+
+    llvm::TargetOptions opt;
+    // Allows the linker to remove the functions and tables of packages that are not used by an executable, and to
+    // fold identical functions safely.
+    opt.FunctionSections = true;
+    opt.DataSections = true;
+    opt.EmitAddrsig = true;
+    return std::unique_ptr<llvm::TargetMachine>(target->createTargetMachine(targetTriple_, cpu_, features_, opt,
+                                                                            llvm::Reloc::PIC_));
 }
 
 CodeGenerator::~CodeGenerator() = default;
@@ -88,6 +143,68 @@ llvm::Constant *CodeGenerator::boxInfoFor(const Type &type) {
     return type.valueType()->boxInfo();
 }
 
+llvm::GlobalVariable* CodeGenerator::constantVariable(llvm::Constant *initializer) {
+    auto &variable = constantVariables_[initializer];
+    if (variable == nullptr) {
+        variable = new llvm::GlobalVariable(*module(), initializer->getType(), true,
+                                            llvm::GlobalValue::LinkageTypes::PrivateLinkage, initializer);
+        variable->setUnnamedAddr(llvm::GlobalVariable::UnnamedAddr::Global);
+    }
+    return variable;
+}
+
+Type CodeGenerator::constantType(const ConstantValue &value) const {
+    switch (value.kind) {
+        case ConstantValue::Kind::Integer:
+            return Type(compiler()->sInteger);
+        case ConstantValue::Kind::Byte:
+            return Type(compiler()->sByte);
+        case ConstantValue::Kind::Real:
+            return Type(compiler()->sReal);
+        case ConstantValue::Kind::Boolean:
+            return Type(compiler()->sBoolean);
+        case ConstantValue::Kind::String:
+            return Type(compiler()->sString);
+    }
+}
+
+llvm::Constant* CodeGenerator::constantFor(const ConstantValue &value, const Type &type) {
+    auto valueType = constantType(value);
+    if (type.type() != valueType.type() || type.typeDefinition() != valueType.typeDefinition() ||
+        type.storageType() != StorageType::Simple || type.isReference()) {
+        return nullptr;
+    }
+    switch (value.kind) {
+        case ConstantValue::Kind::Integer:
+            return llvm::ConstantInt::get(llvm::Type::getInt64Ty(context()), value.integer, true);
+        case ConstantValue::Kind::Byte:
+            return llvm::ConstantInt::get(llvm::Type::getInt8Ty(context()), value.integer, true);
+        case ConstantValue::Kind::Real:
+            return llvm::ConstantFP::get(llvm::Type::getDoubleTy(context()), value.real);
+        case ConstantValue::Kind::Boolean:
+            return llvm::ConstantInt::get(llvm::Type::getInt1Ty(context()), value.boolean);
+        case ConstantValue::Kind::String:
+            return llvm::cast<llvm::Constant>(pool_->pool(value.string));
+    }
+}
+
+llvm::Constant* CodeGenerator::constantBox(const ConstantValue &value) {
+    auto type = constantType(value);
+    auto payload = constantFor(value, type);
+    auto padding = llvm::ArrayType::get(llvm::Type::getInt8Ty(context()),
+                                        typeHelper().boxSize() - querySize(payload->getType()));
+    return llvm::ConstantStruct::getAnon({ boxInfoFor(type), payload, llvm::Constant::getNullValue(padding) });
+}
+
+llvm::GlobalVariable* CodeGenerator::virtualTableVariable(Class *klass) {
+    auto type = llvm::ArrayType::get(llvm::Type::getInt8PtrTy(context()), klass->virtualTable().size());
+    auto table = llvm::ConstantArray::get(type, klass->virtualTable());
+    auto shared = constantVariables_.find(table) != constantVariables_.end();
+    virtualTables_.emplace_back(VirtualTable{ klass->type().toString(TypeContext()), klass->virtualTable().size(),
+                                              querySize(type), shared });
+    return constantVariable(table);
+}
+
 llvm::Constant* buildConstant00Gep(llvm::Type *type, llvm::Constant *value, llvm::LLVMContext &context) {
     return llvm::ConstantExpr::getInBoundsGetElementPtr(type, value,
                                                         llvm::ArrayRef<llvm::Constant *> {
@@ -97,17 +214,33 @@ llvm::Constant* buildConstant00Gep(llvm::Type *type, llvm::Constant *value, llvm
 }
 
 void CodeGenerator::generate() {
-    for (auto package : compiler()->importedPackages()) {
-        ImportedPackageCreator(package, this).generate();
-    }
-    PackageCreator(compiler()->mainPackage(), this).generate();
+    compiler()->measure("declarations", [this] {
+        for (auto package : compiler()->importedPackages()) {
+            ImportedPackageCreator(package, this).generate();
+        }
+        PackageCreator(compiler()->mainPackage(), this).generate();
+    });
 
-    for (auto package : compiler()->importedPackages()) {
-        generateFunctions(package, true);
-    }
-    generateFunctions(compiler()->mainPackage(), false);
+    compiler()->measure("function bodies", [this] {
+        for (auto package : compiler()->importedPackages()) {
+            generateFunctions(package, true);
+        }
+        generateFunctions(compiler()->mainPackage(), false);
+        if (debugInfo_ != nullptr) {
+            debugInfo_->finalize();
+        }
+        // No more constants are evaluated, so the remaining syntax trees are freed before the module is optimized.
+        for (auto package : compiler()->importedPackages()) {
+            releaseAsts(package);
+        }
+        releaseAsts(compiler()->mainPackage());
+    });
 
-    optimizationManager_->optimize(module());
+    // Functions that are not generated from a function body, e.g. box retainers, have not been processed yet.
+    for (auto &function : *module()) {
+        limitVectorAlignment(&function);
+    }
+    compiler()->measure("optimization", [this] { optimizationManager_->optimize(module()); });
 }
 
 void CodeGenerator::emit(bool ir, const std::string &outPath) {
@@ -132,6 +265,57 @@ void CodeGenerator::emit(bool ir, const std::string &outPath) {
     dest.flush();
 }
 
+void CodeGenerator::emitBitcode(const std::string &path) {
+    llvm::legacy::PassManager pass;
+    pass.add(llvm::createVerifierPass(false));
+
+    std::error_code errorCode;
+    llvm::raw_fd_ostream dest(path, errorCode, llvm::sys::fs::F_None);
+    pass.add(llvm::createWriteThinLTOBitcodePass(dest));
+    pass.run(*module());
+    dest.flush();
+}
+
+std::vector<std::string> CodeGenerator::emitObjectFiles(const std::string &path, unsigned partitions) {
+    if (partitions <= 1) {
+        emit(false, path);
+        return { path };
+    }
+
+    llvm::legacy::PassManager verifier;
+    verifier.add(llvm::createVerifierPass(false));
+    verifier.run(*module());
+
+    std::vector<std::string> paths;
+    std::vector<std::unique_ptr<llvm::raw_fd_ostream>> streams;
+    std::vector<llvm::raw_pwrite_stream *> outputs;
+    for (unsigned i = 0; i < partitions; i++) {
+        std::string partitionPath = path;
+        if (i > 0) {
+            llvm::SmallString<64> indexed(path);
+            llvm::sys::path::replace_extension(indexed, std::to_string(i) + llvm::sys::path::extension(path).str());
+            partitionPath = indexed.str();
+        }
+
+        std::error_code errorCode;
+        streams.emplace_back(std::make_unique<llvm::raw_fd_ostream>(partitionPath, errorCode,
+                                                                    llvm::sys::fs::F_None));
+        if (errorCode) {
+            throw std::runtime_error("Could not open " + partitionPath + ": " + errorCode.message());
+        }
+        outputs.emplace_back(streams.back().get());
+        paths.emplace_back(std::move(partitionPath));
+    }
+
+    // Every partition is cloned into its own LLVMContext, so that the threads do not share any state.
+    llvm::splitCodeGen(std::move(module_), outputs, {}, [this] { return createTargetMachine(); },
+                       llvm::TargetMachine::CGFT_ObjectFile);
+    for (auto &stream : streams) {
+        stream->flush();
+    }
+    return paths;
+}
+
 void CodeGenerator::generateFunctions(Package *package, bool imported) {
     for (auto &valueType : package->valueTypes()) {
         valueType->eachFunction([&](auto *function) {
@@ -154,22 +338,151 @@ void CodeGenerator::generateFunction(Function *function) {
             typeHelper_.withReificationContext(ReificationContext(*function, reification), [&] {
                 FunctionCodeGenerator(function, reification.entity.function, this).generate();
             });
+            limitVectorAlignment(reification.entity.function);
             optimizationManager_->optimize(reification.entity.function);
         });
+        // Only the syntax trees of functions that calls in other functions may still be evaluated from must be kept,
+        // so that the memory used is bounded by the largest function rather than by the package.
+        if (!ConstantEvaluator::canCall(function)) {
+            function->releaseAst();
+        }
+    }
+}
+
+namespace {
+
+bool containsVector(llvm::Type *type) {
+    if (type->isVectorTy()) {
+        return true;
+    }
+    if (auto structType = llvm::dyn_cast<llvm::StructType>(type)) {
+        return std::any_of(structType->element_begin(), structType->element_end(), containsVector);
+    }
+    if (auto arrayType = llvm::dyn_cast<llvm::ArrayType>(type)) {
+        return containsVector(arrayType->getElementType());
+    }
+    return false;
+}
+
+}  // namespace
+
+void CodeGenerator::limitVectorAlignment(llvm::Function *function) const {
+    auto &dataLayout = module_->getDataLayout();
+    auto limit = [&](auto *access, llvm::Type *type) {
+        if (!containsVector(type)) return;
+        auto alignment = access->getAlignment() == 0 ? dataLayout.getABITypeAlignment(type) : access->getAlignment();
+        access->setAlignment(std::min(alignment, kVectorStorageAlignment));
+    };
+    for (auto &block : *function) {
+        for (auto &instruction : block) {
+            if (auto load = llvm::dyn_cast<llvm::LoadInst>(&instruction)) {
+                limit(load, load->getType());
+            }
+            else if (auto store = llvm::dyn_cast<llvm::StoreInst>(&instruction)) {
+                limit(store, store->getValueOperand()->getType());
+            }
+        }
+    }
+}
+
+void CodeGenerator::releaseAsts(Package *package) {
+    for (auto &valueType : package->valueTypes()) {
+        valueType->eachFunction([](auto *function) { function->releaseAst(); });
+    }
+    for (auto &klass : package->classes()) {
+        klass->eachFunction([](auto *function) { function->releaseAst(); });
+    }
+    for (auto &function : package->functions()) {
+        function->releaseAst();
+    }
+}
+
+void CodeGenerator::noteHeapBoxing(const Type &type, const SourcePosition &position) {
+    auto name = type.toString(TypeContext());
+    if (!notedHeapBoxings_.emplace(name, position.file, position.line, position.character).second) {
+        return;
+    }
+    auto size = querySize(typeHelper().llvmTypeFor(type));
+    heapBoxings_.emplace_back(HeapBoxing{ name, size, position });
+    if (compiler()->warnsHeapBoxing()) {
+        compiler()->warn(position, "Boxing ", name, " (", size, " bytes) allocates memory on the heap, as a box can ",
+                         "only hold ", typeHelper().boxSize(), " bytes.");
     }
 }
 
+void CodeGenerator::attachDebugInfo(Function *function, llvm::Function *llvmFunction) {
+    if (debugInfo_ == nullptr) {
+        return;
+    }
+    std::string name;
+    if (function->owner() != nullptr) {
+        name = function->owner()->type().toString(function->typeContext()) + ".";
+    }
+    name.append(utf8(function->name()));
+    if (function->mood() == Mood::Interogative) {
+        name.append(moodEmoji(Mood::Interogative));
+    }
+
+    auto file = debugFile(function->position().file);
+    auto line = function->position().line;
+    auto type = debugInfo_->createSubroutineType(debugInfo_->getOrCreateTypeArray({}));
+    auto flags = llvm::DISubprogram::SPFlagDefinition;
+    if (compileUnit_->isOptimized()) {
+        flags |= llvm::DISubprogram::SPFlagOptimized;
+    }
+    llvmFunction->setSubprogram(debugInfo_->createFunction(file, name, llvmFunction->getName(), file, line, type, line,
+                                                           llvm::DINode::FlagPrototyped, flags));
+}
+
+llvm::DIFile* CodeGenerator::debugFile(SourceFile *file) {
+    if (file == nullptr) {
+        return compileUnit_->getFile();
+    }
+    auto &debugFile = debugFiles_[file];
+    if (debugFile == nullptr) {
+        debugFile = debugInfo_->createFile(llvm::sys::path::filename(file->path()),
+                                           llvm::sys::path::parent_path(file->path()));
+    }
+    return debugFile;
+}
+
 llvm::Function* CodeGenerator::createLlvmFunction(Function *function, ReificationContext reificationContext) {
     llvm::FunctionType *ft;
+    bool returnsIndirectly;
+    std::vector<bool> indirectParameters;
     typeHelper().withReificationContext(reificationContext, [&] {
         ft = typeHelper().functionTypeFor(function);
+        returnsIndirectly = typeHelper().returnsIndirectly(function);
+        for (auto &param : function->parameters()) {
+            indirectParameters.emplace_back(typeHelper().isPassedIndirectly(param.type->type(), function));
+        }
     });
     auto name = function->externalName().empty() ? mangleFunction(function, reificationContext.arguments())
     : function->externalName();
 
     auto fn = llvm::Function::Create(ft, linkageForFunction(function), name, module());
     fn->addFnAttr(llvm::Attribute::NoUnwind);
-    if (function->isInline()) {
+    if (function->alwaysInline()) {
+        fn->addFnAttr(llvm::Attribute::AlwaysInline);
+    }
+    else if (function->neverInline()) {
+        fn->addFnAttr(llvm::Attribute::NoInline);
+    }
+    if (function->isPure()) {
+        auto readsMemory = std::any_of(ft->param_begin(), ft->param_end(), [](auto type) {
+            return type->isPointerTy();
+        });
+        fn->addFnAttr(readsMemory ? llvm::Attribute::ReadOnly : llvm::Attribute::ReadNone);
+    }
+    if (function->isCold()) {
+        fn->addFnAttr(llvm::Attribute::Cold);
+    }
+    else if (function->isHot()) {
+        // LLVM has no attribute for hot functions. They are grouped in .text.hot like functions a profile marks hot.
+        fn->addFnAttr(llvm::Attribute::InlineHint);
+        fn->setSectionPrefix(".hot");
+    }
+    else if (function->isInline() && !function->alwaysInline()) {
         fn->addFnAttr(llvm::Attribute::InlineHint);
     }
 
@@ -199,8 +512,13 @@ llvm::Function* CodeGenerator::createLlvmFunction(Function *function, Reificatio
     else if (function->functionType() == FunctionType::ObjectInitializer && !function->errorProne()) {  // foreign initializers
         addParamDereferenceable(function->typeContext().calleeType(), 0, fn, true);
     }
-    for (auto &param : function->parameters()) {
-        addParamAttrs(param, i, fn);
+    if (returnsIndirectly) {
+        fn->addParamAttr(i, llvm::Attribute::StructRet);
+        fn->addParamAttr(i, llvm::Attribute::NoAlias);
+        i++;
+    }
+    for (size_t j = 0; j < function->parameters().size(); j++) {
+        addParamAttrs(function->parameters()[j], i, fn, indirectParameters[j]);
         i++;
     }
 
@@ -221,6 +539,9 @@ llvm::Function* CodeGenerator::createLlvmFunction(Function *function, Reificatio
         fn->addParamAttr(i, llvm::Attribute::NonNull);
         fn->addParamAttr(i, llvm::Attribute::NoCapture);
         fn->addParamAttr(i, llvm::Attribute::NoAlias);
+        if (typeHelper().takesSwiftError(function)) {
+            fn->addParamAttr(i, llvm::Attribute::SwiftError);
+        }
         i++;
     }
 
@@ -241,7 +562,15 @@ void CodeGenerator::declareLlvmFunction(Function *function) {
     });
 }
 
-void CodeGenerator::addParamAttrs(const Parameter &param, size_t index, llvm::Function *function) {
+void CodeGenerator::addParamAttrs(const Parameter &param, size_t index, llvm::Function *function, bool indirect) {
+    if (indirect) {
+        auto elementType = function->getFunctionType()->getParamType(index)->getPointerElementType();
+        function->addParamAttr(index, llvm::Attribute::NoCapture);
+        function->addParamAttr(index, llvm::Attribute::ReadOnly);
+        function->addParamAttr(index, llvm::Attribute::NoAlias);
+        function->addParamAttrs(index, llvm::AttrBuilder().addDereferenceableAttr(querySize(elementType)));
+        return;
+    }
     if (!param.memoryFlowType.isEscaping() && param.type->type().type() == TypeType::Class) {
         function->addParamAttr(index, llvm::Attribute::NoCapture);
     }
@@ -266,7 +595,7 @@ llvm::Function::LinkageTypes CodeGenerator::linkageForFunction(Function *functio
     if (function->isInline() && function->package()->isImported()) {
         return llvm::Function::AvailableExternallyLinkage;
     }
-    if ((function->accessLevel() == AccessLevel::Private && !function->isExternal() &&
+    if ((function->accessLevel() == AccessLevel::Private && function->externalName().empty() &&
          (function->owner() == nullptr || !function->owner()->exported())) || function->isClosure()) {
         return llvm::Function::PrivateLinkage;
     }
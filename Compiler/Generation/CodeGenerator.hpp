@@ -10,21 +10,30 @@
 #define CodeGenerator_hpp
 
 #include "LLVMTypeHelper.hpp"
+#include "OptimizationLevel.hpp"
+#include "Lex/SourcePosition.hpp"
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/Module.h>
 #include <memory>
 #include <string>
 #include <map>
+#include <set>
+#include <tuple>
+#include <vector>
 
 namespace llvm {
 class TargetMachine;
+class DIBuilder;
+class DICompileUnit;
+class DIFile;
 }  // namespace llvm
 
 namespace EmojicodeCompiler {
 
 class Compiler;
 class Package;
+class SourceFile;
 class Class;
 class Function;
 class TypeDefinition;
@@ -32,6 +41,7 @@ class StringPool;
 class RunTimeHelper;
 class OptimizationManager;
 struct Parameter;
+struct ConstantValue;
 
 /// Manages code generation.
 ///
@@ -41,7 +51,14 @@ class CodeGenerator {
 public:
     /// Creates a CodeGenerator bound to the provided Compiler.
     /// @param optimize Whether optimizations should be run.
-    CodeGenerator(Compiler *compiler, bool optimize);
+    /// @param targetTriple The triple of the target for which code is generated or an empty string for the host.
+    /// @param cpu The CPU for which code is generated. If the CPU is "native", code is generated for the CPU and the
+    ///            features of the host.
+    /// @param profile Whether the code is instrumented or optimized with a profile.
+    /// @param debugInfo Whether DWARF debug information is generated. (See attachDebugInfo().)
+    CodeGenerator(Compiler *compiler, OptimizationLevel optimizationLevel, std::string targetTriple = "",
+                  std::string cpu = "generic", const ProfileGuidance &profile = ProfileGuidance(),
+                  bool debugInfo = false);
 
     /// Generates the package.
     void generate();
@@ -51,6 +68,21 @@ public:
     /// @pre Call generate().
     void emit(bool ir, const std::string &outPath);
 
+    /// Emits the generated code to object files and returns their paths.
+    ///
+    /// If `partitions` is greater than 1, the module is split into as many partitions, for which machine code is
+    /// generated in parallel with one thread per partition. The first partition is written to `path`, every other
+    /// partition to `path` with its index inserted before the extension.
+    /// @pre Call generate().
+    /// @note If more than one partition is requested, the module is consumed and module() returns `nullptr`
+    /// afterwards.
+    std::vector<std::string> emitObjectFiles(const std::string &path, unsigned partitions);
+
+    /// Emits the generated code as bitcode with a ThinLTO summary to `path`. The linker then generates the machine
+    /// code and can inline functions across packages and into the runtime, if they were compiled to bitcode too.
+    /// @pre Call generate().
+    void emitBitcode(const std::string &path);
+
     /// The LLVM module that represents the package.
     llvm::Module* module() const { return module_.get(); }
 
@@ -70,9 +102,58 @@ public:
     /// @returns An LLVM value representing the box info that must be stored in the box info field.
     llvm::Constant* boxInfoFor(const Type &type);
 
+    /// Returns a private constant global variable initialized with `initializer`. Equal initializers share one
+    /// variable, so that type descriptions are at the same address at run-time and identical tables are only emitted
+    /// once.
+    llvm::GlobalVariable* constantVariable(llvm::Constant *initializer);
+
+    /// Returns the constant that represents *value*, which was computed by ConstantEvaluator, as an instance of
+    /// *type* or nullptr if *type* is not the type of the value, e.g. because it is optional. Strings are pooled like
+    /// literals.
+    llvm::Constant* constantFor(const ConstantValue &value, const Type &type);
+    /// Returns a constant of the layout of a box that contains *value* and is boxed for the type of *value*.
+    llvm::Constant* constantBox(const ConstantValue &value);
+
+    /// Returns a variable holding the virtual table of `klass`, which must have been built by VTCreator. Classes with
+    /// identical tables share one variable.
+    llvm::GlobalVariable* virtualTableVariable(Class *klass);
+
     /// Declares an LLVM function for each reification of the provided function.
     void declareLlvmFunction(Function *function);
 
+    /// A place where a value is boxed on the heap because its type is larger than a box.
+    struct HeapBoxing {
+        std::string type;
+        /// The size of a value of the type in bytes.
+        uint64_t size;
+        SourcePosition position;
+    };
+
+    /// Records that a value of `type` is boxed on the heap at `position` and issues a warning if enabled with
+    /// Compiler::setWarnsHeapBoxing(). Places are only recorded once, even if generic code is generated repeatedly.
+    void noteHeapBoxing(const Type &type, const SourcePosition &position);
+    /// The places at which values are boxed on the heap in the order in which they were generated.
+    const std::vector<HeapBoxing>& heapBoxings() const { return heapBoxings_; }
+
+    /// The virtual table of a class of the package.
+    struct VirtualTable {
+        std::string type;
+        /// The number of functions in the table.
+        size_t entries;
+        /// The size of the table in bytes.
+        uint64_t size;
+        /// Whether the table is the variable of a table that was generated before, i.e. costs no space.
+        bool shared;
+    };
+
+    /// The virtual tables returned by virtualTableVariable() in the order in which they were generated.
+    const std::vector<VirtualTable>& virtualTables() const { return virtualTables_; }
+
+    /// If debug information is generated, describes `llvmFunction` as a definition of `function` with its Emojicode
+    /// name and source position. The mangled name is the linkage name. Must be called before the body is generated.
+    /// @see FunctionCodeGenerator::setDebugLocation
+    void attachDebugInfo(Function *function, llvm::Function *llvmFunction);
+
     ~CodeGenerator();
 
 private:
@@ -86,11 +167,46 @@ private:
     std::unique_ptr<OptimizationManager> optimizationManager_;
 
     llvm::TargetMachine *targetMachine_ = nullptr;
+    std::string targetTriple_;
+    std::string cpu_;
+    std::string features_;
+
+    std::unique_ptr<llvm::DIBuilder> debugInfo_;
+    llvm::DICompileUnit *compileUnit_ = nullptr;
+    std::map<SourceFile *, llvm::DIFile *> debugFiles_;
+
+    /// The variables returned by constantVariable(). LLVM constants are uniqued, so equal initializers are the same
+    /// key.
+    std::map<llvm::Constant *, llvm::GlobalVariable *> constantVariables_;
+
+    std::vector<HeapBoxing> heapBoxings_;
+    std::vector<VirtualTable> virtualTables_;
+    std::set<std::tuple<std::string, SourceFile *, unsigned, unsigned>> notedHeapBoxings_;
+
+    llvm::DIFile* debugFile(SourceFile *file);
+
+    /// Returns the type of values of the kind of *value*.
+    Type constantType(const ConstantValue &value) const;
+
+    /// Creates a TargetMachine for the target triple, CPU and features determined in the constructor.
+    /// @throws CompilerError if there is no target for the triple.
+    std::unique_ptr<llvm::TargetMachine> createTargetMachine() const;
 
     void generateFunctions(Package *package, bool imported);
+    /// Generates the code of all reifications of `function` and then releases its syntax tree if it is not needed
+    /// anymore.
     void generateFunction(Function *function);
-
-    void addParamAttrs(const Parameter &param, size_t index, llvm::Function *function);
+    /// Releases the syntax trees of all functions of `package` after all code has been generated.
+    void releaseAsts(Package *package);
+    /// Lowers the alignment of all loads and stores of values that are or contain vectors of the vector types like
+    /// 🚂🔸💯 to kVectorStorageAlignment. LLVM aligns these vectors to their size by default, but they are stored in
+    /// places that are only 8-byte aligned, like the value field of a box, the instance variables of an object or the
+    /// storage of a 🍨, where an aligned vector move would fault.
+    void limitVectorAlignment(llvm::Function *function) const;
+    static constexpr unsigned kVectorStorageAlignment = 8;
+
+    /// @param indirect Whether the parameter is passed as pointer. See LLVMTypeHelper::isPassedIndirectly.
+    void addParamAttrs(const Parameter &param, size_t index, llvm::Function *function, bool indirect);
     void addParamDereferenceable(const Type &type, size_t index, llvm::Function *function, bool ret);
 
     llvm::Function::LinkageTypes linkageForFunction(Function *function) const;
@@ -19,8 +19,10 @@
 #include "ProtocolsTableGenerator.hpp"
 #include "BoxRetainReleaseBuilder.hpp"
 #include "Compiler.hpp"
+#include "Scoping/Scope.hpp"
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Constants.h>
+#include <algorithm>
 
 namespace EmojicodeCompiler {
 
@@ -74,10 +76,7 @@ void PackageCreator::createDestructor(Class *klass) {
 void ImportedPackageCreator::createDestructor(Class *klass) {}
 
 void PackageCreator::createClassInfo(Class *klass) {
-    auto type = llvm::ArrayType::get(llvm::Type::getInt8PtrTy(generator_->context()), klass->virtualTable().size());
-    auto virtualTable = new llvm::GlobalVariable(*generator_->module(), type, true,
-                                                 llvm::GlobalValue::LinkageTypes::PrivateLinkage,
-                                                 llvm::ConstantArray::get(type, klass->virtualTable()));
+    auto virtualTable = generator_->virtualTableVariable(klass);
     llvm::Constant *superclass;
     if (klass->superclass() != nullptr) {
         superclass = klass->superclass()->classInfo();
@@ -86,16 +85,93 @@ void PackageCreator::createClassInfo(Class *klass) {
         superclass = llvm::ConstantPointerNull::get(generator_->typeHelper().classInfo()->getPointerTo());
     }
 
+    auto info = new llvm::GlobalVariable(*generator_->module(), generator_->typeHelper().classInfo(), true,
+                                         llvm::GlobalValue::LinkageTypes::ExternalLinkage, nullptr,
+                                         mangleClassInfoName(klass));
+    klass->setClassInfo(info);
+
     auto protocolTable = ProtocolsTableGenerator(generator_).createProtocolTable(klass);
     auto gep = buildConstant00Gep(virtualTable->getType()->getElementType(), virtualTable, generator_->context());
     auto rtti = generator_->runTime().createRtti(klass, RunTimeTypeInfoFlags::Class);
+    auto display = createDisplay(klass);
     auto initializer = llvm::ConstantStruct::get(generator_->typeHelper().classInfo(), {
         rtti, gep, protocolTable, superclass,
-        llvm::ConstantExpr::getBitCast(klass->destructor(), llvm::Type::getInt8PtrTy(generator_->context())) });
-    auto info = new llvm::GlobalVariable(*generator_->module(), generator_->typeHelper().classInfo(), true,
-                                         llvm::GlobalValue::LinkageTypes::ExternalLinkage, initializer,
-                                         mangleClassInfoName(klass));
-    klass->setClassInfo(info);
+        llvm::ConstantExpr::getBitCast(klass->destructor(), llvm::Type::getInt8PtrTy(generator_->context())),
+        llvm::ConstantInt::get(llvm::Type::getInt64Ty(generator_->context()), display.second - 1),
+        display.first, createReferenceTable(klass), createPool(klass) });
+    info->setInitializer(initializer);
+}
+
+llvm::Constant* PackageCreator::createReferenceTable(Class *klass) {
+    auto root = generator_->typeHelper().llvmTypeFor(klass->type())->getPointerElementType();
+    std::vector<llvm::Constant *> indices{ llvm::ConstantInt::get(llvm::Type::getInt32Ty(generator_->context()), 0) };
+    std::vector<llvm::Constant *> offsets;
+    collectReferences(klass->type(), root, indices, offsets);
+
+    auto int64Ty = llvm::Type::getInt64Ty(generator_->context());
+    if (offsets.empty()) {
+        return llvm::ConstantPointerNull::get(int64Ty->getPointerTo());
+    }
+    // The control block pointer is at offset zero, which is therefore never the offset of a reference.
+    offsets.emplace_back(llvm::ConstantInt::get(int64Ty, 0));
+    auto type = llvm::ArrayType::get(int64Ty, offsets.size());
+    auto table = new llvm::GlobalVariable(*generator_->module(), type, true,
+                                          llvm::GlobalValue::LinkageTypes::PrivateLinkage,
+                                          llvm::ConstantArray::get(type, offsets));
+    return buildConstant00Gep(type, table, generator_->context());
+}
+
+llvm::Constant* PackageCreator::createPool(Class *klass) {
+    auto int8PtrTy = llvm::Type::getInt8PtrTy(generator_->context());
+    if (!klass->pooled()) {
+        return llvm::ConstantPointerNull::get(int8PtrTy);
+    }
+    // Corresponds to runtime::internal::Pool.
+    auto int64Ty = llvm::Type::getInt64Ty(generator_->context());
+    auto type = llvm::StructType::get(int64Ty, int64Ty);
+    auto size = llvm::ConstantExpr::getSizeOf(generator_->typeHelper().llvmTypeFor(klass->type())
+                                                      ->getPointerElementType());
+    auto pool = new llvm::GlobalVariable(*generator_->module(), type, false,
+                                         llvm::GlobalValue::LinkageTypes::PrivateLinkage,
+                                         llvm::ConstantStruct::get(type, { size, llvm::ConstantInt::get(int64Ty, 0) }));
+    return llvm::ConstantExpr::getBitCast(pool, int8PtrTy);
+}
+
+void PackageCreator::collectReferences(const Type &type, llvm::Type *root, std::vector<llvm::Constant *> &indices,
+                                       std::vector<llvm::Constant *> &offsets) {
+    auto typeDef = type.typeDefinition();
+    auto offset = (type.type() == TypeType::Class ? 2 : 0) + (typeDef->storesGenericArgs() ? 1 : 0);
+    auto int32Ty = llvm::Type::getInt32Ty(generator_->context());
+    for (auto &decl : typeDef->instanceVariables()) {
+        auto &var = typeDef->instanceScope().getLocalVariable(decl.name);
+        auto varType = var.type().unoptionalized();
+        indices.emplace_back(llvm::ConstantInt::get(int32Ty, offset + var.id()));
+        if (var.type().storageType() != StorageType::SimpleOptional &&
+            (varType.type() == TypeType::Class || varType.type() == TypeType::Someobject)) {
+            auto null = llvm::ConstantPointerNull::get(root->getPointerTo());
+            auto ptr = llvm::ConstantExpr::getInBoundsGetElementPtr(root, null, indices);
+            offsets.emplace_back(llvm::ConstantExpr::getPtrToInt(ptr, llvm::Type::getInt64Ty(generator_->context())));
+        }
+        else if (var.type().type() == TypeType::ValueType && var.type().isManaged() &&
+                 !var.type().valueType()->isPrimitive() && var.type().valueType() != package_->compiler()->sWeak) {
+            collectReferences(var.type(), root, indices, offsets);
+        }
+        indices.pop_back();
+    }
+}
+
+std::pair<llvm::Constant*, size_t> PackageCreator::createDisplay(Class *klass) {
+    std::vector<llvm::Constant *> ancestors;
+    for (auto ancestor = klass; ancestor != nullptr; ancestor = ancestor->superclass()) {
+        ancestors.emplace_back(ancestor->classInfo());
+    }
+    std::reverse(ancestors.begin(), ancestors.end());
+
+    auto type = llvm::ArrayType::get(generator_->typeHelper().classInfo()->getPointerTo(), ancestors.size());
+    auto display = new llvm::GlobalVariable(*generator_->module(), type, true,
+                                            llvm::GlobalValue::LinkageTypes::PrivateLinkage,
+                                            llvm::ConstantArray::get(type, ancestors));
+    return std::make_pair(buildConstant00Gep(type, display, generator_->context()), ancestors.size());
 }
 
 void ImportedPackageCreator::createProtocolTables(const Type &type) {
@@ -8,6 +8,15 @@
 #ifndef Creator_hpp
 #define Creator_hpp
 
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace llvm {
+class Constant;
+class Type;
+}  // namespace llvm
+
 namespace EmojicodeCompiler {
 
 class Protocol;
@@ -41,6 +50,22 @@ private:
     void createProtocol(Protocol *protocol);
     void createValueType(ValueType *valueType);
     void createClass(Class *klass);
+    /// Creates the display of @c klass, which is stored in its class info and allows constant time subclass checks.
+    /// @returns A pointer to the display and the number of its entries.
+    /// @pre The class info of @c klass must have been set.
+    std::pair<llvm::Constant*, size_t> createDisplay(Class *klass);
+    /// Creates the table of the offsets of all references to objects that instances of @c klass store, which the
+    /// cycle collector follows. The table is terminated by zero.
+    /// @returns A pointer to the table or null if instances of @c klass store no such references.
+    llvm::Constant* createReferenceTable(Class *klass);
+    /// Appends the offsets of the references to objects in the instance variables of @c type, which is stored at
+    /// @c indices in @c root, to @c offsets. Instance variables whose references cannot be enumerated statically, like
+    /// boxes and callables, are not included.
+    /// Creates the pool of @c klass if it was declared with 🏊.
+    /// @returns A pointer to the pool or null if instances of @c klass are not pooled.
+    llvm::Constant* createPool(Class *klass);
+    void collectReferences(const Type &type, llvm::Type *root, std::vector<llvm::Constant *> &indices,
+                           std::vector<llvm::Constant *> &offsets);
 };
 
 class ImportedPackageCreator : public PackageCreator {
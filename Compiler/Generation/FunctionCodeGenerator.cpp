@@ -17,8 +17,10 @@
 #include "Types/ValueType.hpp"
 #include "Types/TypeContext.hpp"
 #include <llvm/IR/BasicBlock.h>
+#include <llvm/IR/DebugInfoMetadata.h>
 #include <llvm/IR/DerivedTypes.h>
 #include <llvm/IR/Function.h>
+#include <llvm/IR/GlobalVariable.h>
 #include <llvm/IR/Verifier.h>
 
 namespace EmojicodeCompiler {
@@ -34,6 +36,8 @@ FunctionCodeGenerator::FunctionCodeGenerator(llvm::Function *llvmFunc, CodeGener
 
 void FunctionCodeGenerator::generate() {
     createEntry();
+    generator()->attachDebugInfo(fn_, function_);
+    setDebugLocation(fn_->position());
 
     declareArguments(function_);
 
@@ -51,6 +55,13 @@ void FunctionCodeGenerator::createEntry() {
     builder_.SetInsertPoint(basicBlock);
 }
 
+void FunctionCodeGenerator::setDebugLocation(const SourcePosition &position) {
+    if (auto subprogram = function_->getSubprogram()) {
+        builder_.SetCurrentDebugLocation(llvm::DILocation::get(ctx(), position.line, position.character,
+                                                               subprogram));
+    }
+}
+
 Compiler* FunctionCodeGenerator::compiler() const {
     return generator()->compiler();
 }
@@ -61,9 +72,19 @@ void FunctionCodeGenerator::declareArguments(llvm::Function *function) {
     if (hasThisArgument(fn_)) {
         (it++)->setName("this");
     }
+    if (typeHelper().returnsIndirectly(fn_)) {
+        returnValuePointer_ = &*(it++);
+        returnValuePointer_->setName("ret");
+    }
     for (auto &arg : fn_->parameters()) {
         auto &llvmArg = *(it++);
-        setVariable(i++, &llvmArg);
+        if (typeHelper().isPassedIndirectly(arg.type->type(), fn_)) {
+            // Parameters are immutable, so the value provided by the caller is used without copying it.
+            scoper_.getVariable(i++) = &llvmArg;
+        }
+        else {
+            setVariable(i++, &llvmArg);
+        }
         llvmArg.setName(utf8(arg.name));
     }
 
@@ -105,6 +126,30 @@ void FunctionCodeGenerator::setVariable(size_t id, llvm::Value *value, const llv
     scoper_.getVariable(id) = alloca;
 }
 
+llvm::Value* FunctionCodeGenerator::errorPointerArgument(llvm::Value *errorPointer, bool swiftError) {
+    auto alloca = llvm::dyn_cast<llvm::AllocaInst>(errorPointer);
+    if (swiftError) {
+        if (alloca != nullptr) {
+            alloca->setSwiftError(true);
+        }
+        return errorPointer;
+    }
+    auto argument = llvm::dyn_cast<llvm::Argument>(errorPointer);
+    if ((alloca == nullptr || !alloca->isSwiftError()) && (argument == nullptr || !argument->hasSwiftErrorAttr())) {
+        return errorPointer;
+    }
+    auto type = errorPointer->getType()->getPointerElementType();
+    auto temporary = createEntryAlloca(type, "error");
+    builder().CreateStore(llvm::Constant::getNullValue(type), temporary);
+    return temporary;
+}
+
+void FunctionCodeGenerator::storeErrorArgument(llvm::Value *argument, llvm::Value *errorPointer) {
+    if (argument != errorPointer) {
+        builder().CreateStore(builder().CreateLoad(argument), errorPointer);
+    }
+}
+
 void FunctionCodeGenerator::buildErrorReturn() {
     if (llvmReturnType()->isVoidTy()) {
         builder().CreateRetVoid();
@@ -146,22 +191,22 @@ llvm::Value* FunctionCodeGenerator::buildHasNoValueBox(llvm::Value *box) {
 }
 
 Value* FunctionCodeGenerator::buildOptionalHasNoValue(llvm::Value *simpleOptional, const Type &type) {
-    if (type.storageType() == StorageType::PointerOptional) {
-        return builder().CreateIsNull(simpleOptional);
+    if (type.storageType() == StorageType::NicheOptional) {
+        return builder().CreateNot(buildNicheOptionalHasValue(simpleOptional, type));
     }
     auto vf = builder().CreateExtractValue(simpleOptional, 0);
     return builder().CreateICmpEQ(vf, llvm::ConstantInt::getFalse(ctx()));
 }
 
 Value* FunctionCodeGenerator::buildOptionalHasValue(llvm::Value *simpleOptional, const Type &type) {
-    if (type.storageType() == StorageType::PointerOptional) {
-        return builder().CreateIsNotNull(simpleOptional);
+    if (type.storageType() == StorageType::NicheOptional) {
+        return buildNicheOptionalHasValue(simpleOptional, type);
     }
     return builder().CreateExtractValue(simpleOptional, 0);
 }
 
 Value* FunctionCodeGenerator::buildOptionalHasValuePtr(llvm::Value *simpleOptional, const Type &type) {
-    if (type.storageType() == StorageType::PointerOptional) {
+    if (type.storageType() == StorageType::NicheOptional) {
         return builder().CreateIsNotNull(simpleOptional);
     }
     auto ptype = llvm::cast<llvm::PointerType>(simpleOptional->getType())->getElementType();
@@ -169,7 +214,7 @@ Value* FunctionCodeGenerator::buildOptionalHasValuePtr(llvm::Value *simpleOption
 }
 
 Value* FunctionCodeGenerator::buildGetOptionalValuePtr(llvm::Value *simpleOptional, const Type &type) {
-    if (type.storageType() == StorageType::PointerOptional) {
+    if (type.storageType() == StorageType::NicheOptional) {
         return builder().CreateLoad(simpleOptional);
     }
     auto ptype = llvm::cast<llvm::PointerType>(simpleOptional->getType())->getElementType();
@@ -177,21 +222,42 @@ Value* FunctionCodeGenerator::buildGetOptionalValuePtr(llvm::Value *simpleOption
 }
 
 Value* FunctionCodeGenerator::buildSimpleOptionalWithoutValue(const Type &type) {
-    if (type.storageType() == StorageType::PointerOptional) {
-        return llvm::Constant::getNullValue(typeHelper().llvmTypeFor(type.optionalType()));
+    if (type.storageType() == StorageType::NicheOptional) {
+        return buildNicheOptionalNoValue(type);
     }
     auto structType = typeHelper().llvmTypeFor(type);
     auto undef = llvm::UndefValue::get(structType);
     return builder().CreateInsertValue(undef, llvm::ConstantInt::getFalse(ctx()), 0);
 }
 
+Value* FunctionCodeGenerator::buildNicheOptionalNoValue(const Type &type) {
+    auto llvmType = typeHelper().llvmTypeFor(type.optionalType());
+    if (type.optionalType().type() == TypeType::Enum) {
+        // Enum values are assigned from 0 upwards, so all bits set never denotes a case.
+        return llvm::Constant::getAllOnesValue(llvmType);
+    }
+    return llvm::Constant::getNullValue(llvmType);
+}
+
+Value* FunctionCodeGenerator::buildNicheOptionalHasValue(llvm::Value *optional, const Type &type) {
+    switch (type.optionalType().type()) {
+        case TypeType::Enum:
+            return builder().CreateICmpNE(optional, buildNicheOptionalNoValue(type));
+        case TypeType::Callable:
+            // A callable always has a function.
+            return builder().CreateIsNotNull(builder().CreateExtractValue(optional, 0));
+        default:
+            return builder().CreateIsNotNull(optional);
+    }
+}
+
 Value* FunctionCodeGenerator::buildBoxWithoutValue() {
     auto undef = llvm::UndefValue::get(typeHelper().box());
     return builder().CreateInsertValue(undef, llvm::Constant::getNullValue(typeHelper().boxInfo()->getPointerTo()), 0);
 }
 
 Value* FunctionCodeGenerator::buildSimpleOptionalWithValue(llvm::Value *value, const Type &type) {
-    if (type.storageType() == StorageType::PointerOptional) {
+    if (type.storageType() == StorageType::NicheOptional) {
         return value;
     }
     auto structType = typeHelper().llvmTypeFor(type);
@@ -201,7 +267,7 @@ Value* FunctionCodeGenerator::buildSimpleOptionalWithValue(llvm::Value *value, c
 }
 
 Value* FunctionCodeGenerator::buildGetOptionalValue(llvm::Value *value, const Type &type) {
-    if (type.storageType() == StorageType::PointerOptional) {
+    if (type.storageType() == StorageType::NicheOptional) {
         return value;
     }
     return builder().CreateExtractValue(value, 1);
@@ -500,8 +566,33 @@ llvm::Value* FunctionCodeGenerator::buildFindProtocolConformance(llvm::Value *bo
         return builder().CreateLoad(conformanceEntriesPtr);
     });
 
-    return builder().CreateCall(generator()->runTime().findProtocolConformance(),
+    if (!llvm::isa<llvm::Constant>(protocolRTTI)) {
+        return builder().CreateCall(generator()->runTime().findProtocolConformance(),
                                     { conformanceEntries, protocolRTTI });
+    }
+
+    // The protocol is known at this site, so the conformance only depends on the protocol table. Each site caches the
+    // last table it saw together with the found conformance. The cache is thread-local so that the two fields are
+    // never observed half-updated. The general-dynamic model is required as the code may end up in a shared library or
+    // be run by the JIT. The linker relaxes the accesses in executables.
+    auto cacheType = llvm::StructType::get(ctx(), { typeHelper().protocolConformanceEntry()->getPointerTo(),
+                                                    typeHelper().protocolConformance()->getPointerTo() });
+    auto cache = new llvm::GlobalVariable(*generator()->module(), cacheType, false,
+                                          llvm::GlobalValue::LinkageTypes::PrivateLinkage,
+                                          llvm::Constant::getNullValue(cacheType), "conformanceCache", nullptr,
+                                          llvm::GlobalValue::GeneralDynamicTLSModel);
+    auto cachedEntriesPtr = builder().CreateConstInBoundsGEP2_32(cacheType, cache, 0, 0);
+    auto cachedConformancePtr = builder().CreateConstInBoundsGEP2_32(cacheType, cache, 0, 1);
+    auto hit = builder().CreateICmpEQ(builder().CreateLoad(cachedEntriesPtr), conformanceEntries);
+    return createIfElsePhi(hit, [&]() -> llvm::Value* {
+        return builder().CreateLoad(cachedConformancePtr);
+    }, [&]() -> llvm::Value* {
+        auto conformance = builder().CreateCall(generator()->runTime().findProtocolConformance(),
+                                                { conformanceEntries, protocolRTTI });
+        builder().CreateStore(conformanceEntries, cachedEntriesPtr);
+        builder().CreateStore(conformance, cachedConformancePtr);
+        return conformance;
+    });
 }
 
 llvm::Value* FunctionCodeGenerator::instanceVariablePointer(size_t id) {
@@ -523,6 +614,10 @@ llvm::Value* FunctionCodeGenerator::genericArgsPtr() {
     return builder().CreateConstInBoundsGEP2_32(type, thisValue(), 0, callee.type() == TypeType::Class ? 2 : 0);
 }
 
+bool FunctionCodeGenerator::flattens() const {
+    return fn_ != nullptr && fn_->flatten();
+}
+
 FunctionCodeGenerator::~FunctionCodeGenerator() = default;
 
 }  // namespace EmojicodeCompiler
@@ -30,6 +30,7 @@ public:
     }
 
     void releaseTemporaryObjects(FunctionCodeGenerator *fg, bool clearQueue, bool skipLast);
+    bool empty() const { return temporaryObjects_.empty(); }
 
 private:
     struct Temporary {
@@ -64,6 +65,10 @@ public:
     /// Creates the entry block and initializes the builder to it.
     void createEntry();
 
+    /// Sets the source position of the instructions built from now on if the function is described in the debug
+    /// information. (See CodeGenerator::attachDebugInfo.)
+    void setDebugLocation(const SourcePosition &position);
+
     CGScoper& scoper() { return scoper_; }
     Compiler* compiler() const;
     CodeGenerator* generator() const { return generator_; }
@@ -73,6 +78,19 @@ public:
     virtual llvm::Value* thisValue() const { return &*function_->args().begin(); }
     llvm::Type* llvmReturnType() const { return function_->getReturnType(); }
     llvm::Value* errorPointer() const { return &*(function_->args().end() - 1); }
+    /// Returns the value that must be passed as error pointer to a function in place of *errorPointer*.
+    ///
+    /// If *swiftError* is true, the function takes its error pointer as `swifterror` (see
+    /// LLVMTypeHelper::takesSwiftError) and *errorPointer* is marked as such. Otherwise, if *errorPointer* is a
+    /// `swifterror` value, which cannot be passed to such a function, temporary memory is returned and
+    /// storeErrorArgument() must be called after the call.
+    llvm::Value* errorPointerArgument(llvm::Value *errorPointer, bool swiftError);
+    /// Stores the error written to *argument*, which errorPointerArgument() returned for *errorPointer*, into
+    /// *errorPointer* if they are different.
+    void storeErrorArgument(llvm::Value *argument, llvm::Value *errorPointer);
+    /// Returns the memory into which the return value must be stored if the function returns indirectly or nullptr.
+    /// @see LLVMTypeHelper::returnsIndirectly
+    llvm::Value* returnValuePointer() const { return returnValuePointer_; }
     const Type& calleeType() const;
     const SourcePosition& position() const;
 
@@ -114,6 +132,10 @@ public:
     /// @param type An optional type.
     llvm::Value* buildOptionalHasValue(llvm::Value *simpleOptional, const Type &type);
     llvm::Value* buildOptionalHasValuePtr(llvm::Value *simpleOptional, const Type &type);
+    /// Returns the value that denotes the absence of a value in a StorageType::NicheOptional optional.
+    llvm::Value* buildNicheOptionalNoValue(const Type &type);
+    /// Determines whether the StorageType::NicheOptional optional has a value.
+    llvm::Value* buildNicheOptionalHasValue(llvm::Value *optional, const Type &type);
     llvm::Value* buildGetOptionalValuePtr(llvm::Value *simpleOptional, const Type &type);
     /// Creates an optional value that represents no value for the provided type.
     /// @param type An optional type.
@@ -203,6 +225,8 @@ public:
         tom_.releaseTemporaryObjects(this, clearQueue, skipLast);
     }
 
+    /// Returns true if temporary values were registered that have not been released yet.
+    bool hasTemporaryObjects() const { return !tom_.empty(); }
     /// Returns the the TemporaryObjectsManager and resets the FunctionCodeGenerator’s internal one.
     TemporaryObjectsManager takeTemporaryObjectsManager() {
         TemporaryObjectsManager g;
@@ -210,6 +234,10 @@ public:
         return g;
     }
 
+    /// Whether the function being generated was marked with 🥞, so that the functions it calls statically are
+    /// inlined into it.
+    bool flattens() const;
+
    ~FunctionCodeGenerator();
 
 protected:
@@ -222,6 +250,7 @@ private:
     CGScoper scoper_;
     llvm::Value *functionGenericArgs_ = nullptr;
     llvm::Value *typeMethodGenericArgs_ = nullptr;
+    llvm::Value *returnValuePointer_ = nullptr;
 
     CodeGenerator *const generator_;
     llvm::IRBuilder<> builder_;
@@ -0,0 +1,193 @@
+//
+//  JITRunner.cpp
+//  EmojicodeCompiler
+//
+
+#include "JITRunner.hpp"
+#include "CodeGenerator.hpp"
+#include "CompilerError.hpp"
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/ExecutionEngine/Orc/CompileUtils.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/Support/DynamicLibrary.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MD5.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+
+namespace EmojicodeCompiler {
+
+/// Returns the hexadecimal MD5 hash of *data*.
+static std::string hash(llvm::StringRef data) {
+    llvm::MD5 md5;
+    md5.update(data);
+    llvm::MD5::MD5Result result;
+    md5.final(result);
+    return result.digest().str();
+}
+
+/// Throws a CompilerError describing *error* if it is an error.
+static void check(llvm::Error error, const char *action) {
+    if (error) {
+        throw CompilerError(SourcePosition(), "Could not ", action, ": ", llvm::toString(std::move(error)));
+    }
+}
+
+/// Called instead of a function whose lazy compilation failed.
+static void lazyCompilationFailed() {
+    std::cerr << "💣 A function could not be compiled." << std::endl;
+    std::abort();
+}
+
+std::string JITRunner::libraryDirectory() const {
+    if (!cacheDirectory_.empty()) {
+        return cacheDirectory_;
+    }
+    llvm::SmallString<128> directory;
+    llvm::sys::path::system_temp_directory(true, directory);
+    llvm::sys::path::append(directory, "emojicodec-jit");
+    return directory.str();
+}
+
+void JITRunner::loadLibraries(const std::vector<std::string> &inputs, const std::string &linker) {
+    std::stringstream key;
+    key << linker;
+    for (auto &input : inputs) {
+        key << "\n" << input;
+        llvm::sys::fs::file_status status;
+        if (!llvm::sys::fs::status(input, status)) {
+            key << " " << status.getLastModificationTime().time_since_epoch().count();
+        }
+    }
+
+    auto directory = libraryDirectory();
+    llvm::sys::fs::create_directories(directory);
+    llvm::SmallString<128> path(directory);
+    llvm::sys::path::append(path, "packages-" + hash(key.str()) + ".so");
+
+    if (!llvm::sys::fs::exists(path)) {
+        // The library is linked to a temporary path first, so that concurrent runs never load a partial library.
+        auto temporary = path.str().str() + "." + std::to_string(getpid());
+        std::stringstream cmd;
+        cmd << linker;
+#ifdef __APPLE__
+        cmd << " -dynamiclib -undefined dynamic_lookup -Wl,-all_load";
+#else
+        // The run-time library refers to 🏁 of the program, which is only resolved when main is called.
+        cmd << " -shared -Wl,-z,lazy -Wl,--whole-archive";
+#endif
+        for (auto &input : inputs) {
+#ifndef __APPLE__
+            if (input.compare(0, 2, "-l") == 0) {
+                cmd << " -Wl,--no-whole-archive " << input << " -Wl,--whole-archive";
+                continue;
+            }
+#endif
+            cmd << " " << input;
+        }
+#ifndef __APPLE__
+        cmd << " -Wl,--no-whole-archive";
+#endif
+        cmd << " -o " << temporary;
+        if (system(cmd.str().c_str()) != 0 || llvm::sys::fs::rename(temporary, path)) {
+            llvm::sys::fs::remove(temporary);
+            throw CompilerError(SourcePosition(), "Could not link the imported packages into ", path.str().str(), ".");
+        }
+    }
+
+    std::string error;
+    if (llvm::sys::DynamicLibrary::LoadLibraryPermanently(path.c_str(), &error)) {
+        throw CompilerError(SourcePosition(), "Could not load ", path.str().str(), ": ", error);
+    }
+}
+
+int JITRunner::run(const std::string &start, const std::vector<std::string> &arguments) {
+    // The JIT compiles on its own threads and therefore needs a module in a context it owns.
+    llvm::SmallString<0> bitcode;
+    llvm::raw_svector_ostream bitcodeStream(bitcode);
+    llvm::WriteBitcodeToFile(*generator_->module(), bitcodeStream);
+
+    auto context = std::make_unique<llvm::LLVMContext>();
+    auto module = llvm::parseBitcodeFile(llvm::MemoryBufferRef(bitcode, "module"), *context);
+    if (!module) {
+        check(module.takeError(), "read the module");
+    }
+
+    auto builder = llvm::orc::JITTargetMachineBuilder::detectHost();
+    if (!builder) {
+        check(builder.takeError(), "target the host");
+    }
+    auto dataLayout = builder->getDefaultDataLayoutForTarget();
+    if (!dataLayout) {
+        check(dataLayout.takeError(), "target the host");
+    }
+    auto targetMachine = builder->createTargetMachine();
+    if (!targetMachine) {
+        check(targetMachine.takeError(), "target the host");
+    }
+    auto jit = llvm::orc::LLLazyJIT::Create(*builder, *dataLayout,
+                                            llvm::pointerToJITTargetAddress(&lazyCompilationFailed));
+    if (!jit) {
+        check(jit.takeError(), "create the JIT");
+    }
+
+    auto generator = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(*dataLayout);
+    if (!generator) {
+        check(generator.takeError(), "search the process for symbols");
+    }
+    (*jit)->getMainJITDylib().setGenerator(std::move(*generator));
+
+    if (cacheDirectory_.empty()) {
+        llvm::orc::ThreadSafeModule threadSafeModule(std::move(*module), std::move(context));
+        check((*jit)->addLazyIRModule(std::move(threadSafeModule)), "add the module");
+    }
+    else {
+        llvm::SmallString<128> path(cacheDirectory_);
+        llvm::sys::path::append(path, "jit-" + hash(bitcode) + ".o");
+        auto object = llvm::MemoryBuffer::getFile(path);
+        if (!object) {
+            auto compiled = llvm::orc::SimpleCompiler(**targetMachine)(**module);
+            llvm::sys::fs::create_directories(cacheDirectory_);
+            std::error_code errorCode;
+            llvm::raw_fd_ostream stream(path, errorCode, llvm::sys::fs::F_None);
+            if (!errorCode) {
+                stream << compiled->getBuffer();
+            }
+            object = std::move(compiled);
+        }
+        check((*jit)->addObjectFile(std::move(*object)), "add the object");
+    }
+    check((*jit)->runConstructors(), "run the constructors");
+
+    auto symbol = (*jit)->lookup(start);
+    if (!symbol) {
+        check(symbol.takeError(), "find 🏁");
+    }
+    auto setUp = reinterpret_cast<void (*)(int, char **)>(
+            llvm::sys::DynamicLibrary::SearchForAddressOfSymbol("ejcSetUpProgram"));
+    if (setUp == nullptr) {
+        throw CompilerError(SourcePosition(), "Could not find the run-time library.");
+    }
+
+    std::vector<char *> argv;
+    for (auto &argument : arguments) {
+        argv.emplace_back(const_cast<char *>(argument.c_str()));
+    }
+    argv.emplace_back(nullptr);
+
+    std::cout.flush();
+    setUp(static_cast<int>(arguments.size()), argv.data());
+    auto code = reinterpret_cast<int64_t (*)()>(symbol->getAddress())();
+    std::fflush(stdout);
+    check((*jit)->runDestructors(), "run the destructors");
+    return static_cast<int>(code);
+}
+
+}  // namespace EmojicodeCompiler
@@ -0,0 +1,56 @@
+//
+//  JITRunner.hpp
+//  EmojicodeCompiler
+//
+
+#ifndef EMOJICODE_JITRUNNER_HPP
+#define EMOJICODE_JITRUNNER_HPP
+
+#include <string>
+#include <vector>
+
+namespace EmojicodeCompiler {
+
+class CodeGenerator;
+
+/// Runs the code generated by a CodeGenerator in the compiler process with LLVM's ORC JIT instead of emitting an
+/// object file and linking an executable.
+///
+/// The imported packages are precompiled archives that may use thread-local storage, which the JIT linker cannot
+/// relocate. They are therefore linked into a shared library together with the run-time library once and loaded
+/// into the process, where the symbols the generated code refers to are resolved. The library is stored with a name
+/// derived from the archives and their modification times and is reused until one of them changes.
+///
+/// If a cache directory is provided, the module is compiled completely and the object is stored with a name
+/// derived from the hash of the module, so that running unchanged code again skips code generation. Otherwise,
+/// every function is only compiled when it is called for the first time.
+class JITRunner {
+public:
+    /// @param cacheDirectory The directory in which compiled objects are stored or an empty string if the code shall
+    ///                       be compiled lazily.
+    JITRunner(CodeGenerator *generator, std::string cacheDirectory)
+        : generator_(generator), cacheDirectory_(std::move(cacheDirectory)) {}
+
+    /// Loads the archives and libraries in *inputs*, which are linker arguments as returned by
+    /// Compiler::linkInputs(), into the process. They are linked into a shared library with *linker* if there is no
+    /// library for them yet.
+    /// @throws CompilerError if the library cannot be linked or loaded.
+    void loadLibraries(const std::vector<std::string> &inputs, const std::string &linker);
+
+    /// Compiles the module, sets up the run-time library with *arguments* as the command-line arguments and calls
+    /// the function named *start*.
+    /// @returns The value returned by the function, which is the exit code of the program.
+    /// @throws CompilerError if the module cannot be compiled or the function is not found.
+    int run(const std::string &start, const std::vector<std::string> &arguments);
+
+private:
+    CodeGenerator *generator_;
+    std::string cacheDirectory_;
+
+    /// Returns the directory in which the shared library of the imported packages is stored.
+    std::string libraryDirectory() const;
+};
+
+}  // namespace EmojicodeCompiler
+
+#endif  // EMOJICODE_JITRUNNER_HPP
@@ -24,8 +24,12 @@
 
 namespace EmojicodeCompiler {
 
-/// The number of bytes a box provides for storing value type data.
-const unsigned kBoxSize = 32;
+#ifndef EJC_BOX_SIZE
+#define EJC_BOX_SIZE 32
+#endif
+
+/// The number of bytes a box provides for storing value type data. (See EJC_BOX_SIZE in runtime/Runtime.h.)
+const unsigned kBoxSize = EJC_BOX_SIZE;
 
 LLVMTypeHelper::LLVMTypeHelper(llvm::LLVMContext &context, CodeGenerator *codeGenerator)
         : context_(context), codeGenerator_(codeGenerator), mdBuilder_(context) {
@@ -41,7 +45,9 @@ LLVMTypeHelper::LLVMTypeHelper(llvm::LLVMContext &context, CodeGenerator *codeGe
         // Pointer to the generic type info of the described type.
         // The address itself is used to determine whether to types are equal!
         runTimeTypeInfo_->getPointerTo(),
-        llvm::Type::getInt1Ty(context_)  // optional
+        llvm::Type::getInt1Ty(context_),  // optional
+        // The number of elements describing the type and its generic arguments, including this one.
+        llvm::Type::getInt32Ty(context_),
     });
 
     boxInfoType_ = llvm::StructType::create(context_, "boxInfo");
@@ -75,7 +81,11 @@ LLVMTypeHelper::LLVMTypeHelper(llvm::LLVMContext &context, CodeGenerator *codeGe
         llvm::Type::getInt8PtrTy(context_)->getPointerTo(),
         protocolConformanceEntry_->getPointerTo(),
         classInfoType_->getPointerTo(),
-        llvm::Type::getInt8PtrTy(context_)  // destructor pointer
+        llvm::Type::getInt8PtrTy(context_),  // destructor pointer
+        llvm::Type::getInt64Ty(context_),  // depth in the class hierarchy
+        classInfoType_->getPointerTo()->getPointerTo(),  // display
+        llvm::Type::getInt64PtrTy(context_),  // offsets of the references to objects, see PackageCreator
+        llvm::Type::getInt8PtrTy(context_)  // pool of instances or null, see ejcPoolAlloc
     });
 
     callable_ = llvm::StructType::create({
@@ -100,6 +110,15 @@ LLVMTypeHelper::LLVMTypeHelper(llvm::LLVMContext &context, CodeGenerator *codeGe
     compiler->sBoolean->createUnspecificReification().type = llvm::Type::getInt1Ty(context_);
     compiler->sMemory->createUnspecificReification().type = llvm::Type::getInt8PtrTy(context_);
     compiler->sByte->createUnspecificReification().type = llvm::Type::getInt8Ty(context_);
+    compiler->sUInt8->createUnspecificReification().type = llvm::Type::getInt8Ty(context_);
+    compiler->sUInt16->createUnspecificReification().type = llvm::Type::getInt16Ty(context_);
+    compiler->sUInt32->createUnspecificReification().type = llvm::Type::getInt32Ty(context_);
+    compiler->sRealVector->createUnspecificReification().type =
+            llvm::VectorType::get(llvm::Type::getDoubleTy(context_), 4);
+    compiler->sIntegerVector->createUnspecificReification().type =
+            llvm::VectorType::get(llvm::Type::getInt32Ty(context_), 8);
+    compiler->sByteVector->createUnspecificReification().type =
+            llvm::VectorType::get(llvm::Type::getInt8Ty(context_), 16);
 
     tbaaRoot_ = mdBuilder_.createTBAARoot("something");
 }
@@ -129,25 +148,50 @@ llvm::ArrayType* LLVMTypeHelper::multiprotocolConformance(const Type &type) {
     return llvm::ArrayType::get(protocolConformance()->getPointerTo(), type.protocols().size());
 }
 
-llvm::Type* LLVMTypeHelper::typeForFunction(const Type &type, Function *function) {
+Type LLVMTypeHelper::reifiedType(const Type &type, Function *function) const {
     if (reifiContext_ != nullptr && type.type() == TypeType::LocalGenericVariable &&
         reifiContext_->providesActualTypeFor(type.genericVariableIndex())) {
-        return llvmTypeFor(reifiContext_->actualType(type.genericVariableIndex()));
+        return reifiContext_->actualType(type.genericVariableIndex());
     }
     if (type.type() == TypeType::LocalGenericVariable) {
-        return llvmTypeFor(function->constraintForIndex(type.genericVariableIndex()));
+        return function->constraintForIndex(type.genericVariableIndex());
     }
     if (type.type() == TypeType::GenericVariable && function->owner()->canResolve(type.resolutionConstraint())) {
-        return llvmTypeFor(function->owner()->constraintForIndex(type.genericVariableIndex()));
+        return function->owner()->constraintForIndex(type.genericVariableIndex());
     }
     if (type.unoptionalized().type() == TypeType::LocalGenericVariable) {
-        return llvmTypeFor(function->constraintForIndex(type.unoptionalized().genericVariableIndex()).optionalized());
+        return function->constraintForIndex(type.unoptionalized().genericVariableIndex()).optionalized();
     }
     if (type.unoptionalized().type() == TypeType::GenericVariable &&
         function->owner()->canResolve(type.unoptionalized().resolutionConstraint())) {
-        return llvmTypeFor(function->owner()->constraintForIndex(type.unoptionalized().genericVariableIndex()).optionalized());
+        return function->owner()->constraintForIndex(type.unoptionalized().genericVariableIndex()).optionalized();
+    }
+    return type;
+}
+
+llvm::Type* LLVMTypeHelper::typeForFunction(const Type &type, Function *function) {
+    return llvmTypeFor(reifiedType(type, function));
+}
+
+bool LLVMTypeHelper::isPassedIndirectly(const Type &type, Function *function) {
+    if (!function->externalName().empty() || function->isClosure()) {
+        return false;
+    }
+    auto reified = reifiedType(type, function);
+    if (reified.unoptionalized().type() != TypeType::ValueType || reified.storageType() == StorageType::Box) {
+        return false;
     }
-    return llvmTypeFor(type);
+    auto llvmType = llvmTypeFor(reified);
+    return llvmType->isStructTy() && codeGenerator_->querySize(llvmType) > kMaxDirectSize;
+}
+
+bool LLVMTypeHelper::takesSwiftError(Function *function) const {
+    return function->errorProne() && function->externalName().empty();
+}
+
+bool LLVMTypeHelper::returnsIndirectly(Function *function) {
+    return function->functionType() != FunctionType::ObjectInitializer &&
+           isPassedIndirectly(function->returnType()->type(), function);
 }
 
 llvm::FunctionType* LLVMTypeHelper::functionTypeFor(Function *function) {
@@ -156,10 +200,27 @@ llvm::FunctionType* LLVMTypeHelper::functionTypeFor(Function *function) {
         args.emplace_back(llvm::Type::getInt8PtrTy(context_));
     }
     else if (hasThisArgument(function)) {
-        args.emplace_back(typeForFunction(function->typeContext().calleeType(), function));
+        auto calleeType = function->typeContext().calleeType();
+        if (function->passesThisByValue()) {
+            calleeType.setReference(false);
+        }
+        args.emplace_back(typeForFunction(calleeType, function));
+    }
+    llvm::Type *returnType;
+    if (function->functionType() == FunctionType::ObjectInitializer) {
+        auto init = dynamic_cast<Initializer *>(function);
+        returnType = typeForFunction(init->constructedType(init->typeContext().calleeType()), function);
+    }
+    else {
+        returnType = typeForFunction(function->returnType()->type(), function);
+    }
+    if (returnsIndirectly(function)) {
+        args.emplace_back(returnType->getPointerTo());
+        returnType = llvm::Type::getVoidTy(context_);
     }
     std::transform(function->parameters().begin(), function->parameters().end(), std::back_inserter(args), [&](auto &arg) {
-        return typeForFunction(arg.type->type(), function);
+        auto type = typeForFunction(arg.type->type(), function);
+        return isPassedIndirectly(arg.type->type(), function) ? type->getPointerTo() : type;
     });
     if ((function->functionType() == FunctionType::ObjectInitializer ||
          function->functionType() == FunctionType::ValueTypeInitializer) && function->owner()->storesGenericArgs()) {
@@ -174,14 +235,6 @@ llvm::FunctionType* LLVMTypeHelper::functionTypeFor(Function *function) {
     if (function->errorProne()) {
         args.emplace_back(typeForFunction(function->errorType()->type(), function)->getPointerTo());
     }
-    llvm::Type *returnType;
-    if (function->functionType() == FunctionType::ObjectInitializer) {
-        auto init = dynamic_cast<Initializer *>(function);
-        returnType = typeForFunction(init->constructedType(init->typeContext().calleeType()), function);
-    }
-    else {
-        returnType = typeForFunction(function->returnType()->type(), function);
-    }
     return llvm::FunctionType::get(returnType, args, false);
 }
 
@@ -194,6 +247,10 @@ bool LLVMTypeHelper::isDereferenceable(const Type &type) const {
             type.storageType() != StorageType::Box) || type.isReference();
 }
 
+unsigned LLVMTypeHelper::boxSize() const {
+    return kBoxSize;
+}
+
 bool LLVMTypeHelper::isRemote(const Type &type) {
     return codeGenerator_->querySize(llvmTypeFor(type)) > kBoxSize;
 }
@@ -219,7 +276,7 @@ llvm::Type* LLVMTypeHelper::typeForOrdinaryType(const Type &type) {
             std::vector<llvm::Type *> types{ llvm::Type::getInt1Ty(context_), llvmTypeFor(type.optionalType()) };
             return llvm::StructType::get(context_, types);
         }
-        case StorageType::PointerOptional:
+        case StorageType::NicheOptional:
             return llvmTypeFor(type.optionalType());
         case StorageType::Simple:
             return getSimpleType(type);
@@ -49,12 +49,32 @@ public:
     /// @throws std::logic_error if no type can be established. This will normally not happen.
     llvm::FunctionType* functionTypeFor(Function *function);
 
+    /// @returns True if parameters or return values of the provided type are passed by pointer to and from
+    /// *function*.
+    ///
+    /// Value types larger than kMaxDirectSize are passed as a pointer to a value owned by the caller, which the callee
+    /// borrows and must not modify, and are returned into memory provided by the caller (sret) so that the value is
+    /// not copied at every call boundary. Functions implemented in another language and closures, whose signature
+    /// must match that of callables, always take and return such values directly.
+    /// @note Generic variables are resolved in the current reification context, so this method must only be called
+    /// while generating or declaring *function*.
+    bool isPassedIndirectly(const Type &type, Function *function);
+    /// @returns True if *function* returns its value into memory passed as first argument after the context.
+    /// @see isPassedIndirectly
+    bool returnsIndirectly(Function *function);
+    /// @returns True if *function* takes its error pointer as `swifterror`, which most targets pass and return in a
+    /// register, so that checking for an error after a call does not require a store and a load. Functions
+    /// implemented in another language receive a pointer to memory as usual.
+    bool takesSwiftError(Function *function) const;
+
     /// @returns True if it is guaranteed that the provided type is represnted as a pointer at run-time that can always
     /// be dereferenced.
     bool isDereferenceable(const Type &type) const;
 
     /// @returns True if this type cannot be directly stored in a box and memory must be allocated on the heap.
     bool isRemote(const Type &type);
+    /// @returns The number of bytes a box provides for storing a value.
+    unsigned boxSize() const;
 
     /// A pointer to a value of this type is stored in the first field of a box to identify its content.
     llvm::StructType* boxInfo() const { return boxInfoType_; }
@@ -111,7 +131,13 @@ private:
     llvm::StructType *callableBoxCapture_;
 
     llvm::Type* getSimpleType(const Type &type);
+    /// The size in bytes above which value types are passed indirectly. Values up to this size are passed in two
+    /// registers on common platforms.
+    static constexpr uint64_t kMaxDirectSize = 16;
+
     llvm::Type* typeForFunction(const Type &type, Function *function);
+    /// Resolves generic variables in *type* to the types as which they are passed to *function*.
+    Type reifiedType(const Type &type, Function *function) const;
 
     llvm::LLVMContext &context_;
     CodeGenerator *codeGenerator_;
@@ -0,0 +1,34 @@
+//
+// Created by Theo Weidmann on 14.10.26.
+//
+
+#ifndef EMOJICODE_OPTIMIZATIONLEVEL_HPP
+#define EMOJICODE_OPTIMIZATIONLEVEL_HPP
+
+#include <string>
+
+namespace EmojicodeCompiler {
+
+/// The levels of optimization, which correspond to the -O levels of Clang. Os and Oz optimize for size, with Oz
+/// omitting every optimization that would increase the code size.
+enum class OptimizationLevel {
+    None, O1, O2, O3, Os, Oz
+};
+
+/// Describes how profiles of executions of the program are recorded and used. Profiles are only recorded or used if
+/// optimizations are run.
+struct ProfileGuidance {
+    /// If not empty, the code is instrumented to write a profile of its execution to this path when the program exits.
+    /// The LLVM_PROFILE_FILE environment variable overrides the path at run-time.
+    std::string instrumentationPath;
+    /// If not empty, the path of an indexed profile, as created by `llvm-profdata merge`, that guides inlining, block
+    /// layout and the promotion of dynamic dispatch to direct calls.
+    std::string profilePath;
+
+    /// Whether the code is instrumented and must be linked with the profile run-time library.
+    bool instruments() const { return !instrumentationPath.empty(); }
+};
+
+}  // namespace EmojicodeCompiler
+
+#endif //EMOJICODE_OPTIMIZATIONLEVEL_HPP
@@ -3,29 +3,90 @@
 //
 
 #include "OptimizationManager.hpp"
+#include "BoxSpecializationPass.hpp"
 #include "ReferenceCountingPasses.hpp"
+#include <llvm/Analysis/TargetTransformInfo.h>
+#include <llvm/IR/GlobalValue.h>
+#include <llvm/Target/TargetMachine.h>
 #include <llvm/Transforms/IPO.h>
+#include <llvm/Transforms/IPO/AlwaysInliner.h>
 #include <llvm/Transforms/IPO/PassManagerBuilder.h>
 #include <llvm/Transforms/Scalar.h>
 #include <llvm/Transforms/Scalar/GVN.h>
 
 namespace EmojicodeCompiler {
 
-OptimizationManager::OptimizationManager(llvm::Module *module, bool optimize, RunTimeHelper *runTime)
-        : optimize_(optimize), functionPassManager_(std::make_unique<llvm::legacy::FunctionPassManager>(module)),
+OptimizationManager::OptimizationManager(llvm::Module *module, OptimizationLevel level, RunTimeHelper *runTime,
+                                         llvm::Type *boxType, llvm::Type *callableType,
+                                         llvm::TargetMachine *targetMachine,
+                                         const ProfileGuidance &profile, std::string entryPoint)
+        : level_(level), functionPassManager_(std::make_unique<llvm::legacy::FunctionPassManager>(module)),
             passManager_(std::make_unique<llvm::legacy::PassManager>()) {
-                initialize(runTime);
+                initialize(runTime, boxType, callableType, targetMachine, profile, entryPoint);
             }
 
-void OptimizationManager::initialize(RunTimeHelper *runTime) {
-    if (optimize_) {
+void OptimizationManager::initialize(RunTimeHelper *runTime, llvm::Type *boxType, llvm::Type *callableType,
+                                     llvm::TargetMachine *targetMachine, const ProfileGuidance &profile,
+                                     const std::string &entryPoint) {
+    if (level_ != OptimizationLevel::None) {
         llvm::PassManagerBuilder builder;
-        builder.OptLevel = 3;
-        builder.SizeLevel = 0;
-        builder.Inliner = llvm::createFunctionInliningPass();
-        builder.MergeFunctions = true;
+        switch (level_) {
+            case OptimizationLevel::O1:
+                builder.OptLevel = 1;
+                break;
+            case OptimizationLevel::O2:
+                builder.OptLevel = 2;
+                break;
+            case OptimizationLevel::Os:
+                builder.OptLevel = 2;
+                builder.SizeLevel = 1;
+                break;
+            case OptimizationLevel::Oz:
+                builder.OptLevel = 2;
+                builder.SizeLevel = 2;
+                break;
+            default:
+                builder.OptLevel = 3;
+                break;
+        }
+        builder.Inliner = llvm::createFunctionInliningPass(builder.OptLevel, builder.SizeLevel, false);
+        // Functions are merged after the reference counting passes below, which make more of them identical.
+        builder.MergeFunctions = false;
+        builder.LoopVectorize = builder.OptLevel > 1 && builder.SizeLevel < 2;
+        builder.SLPVectorize = builder.OptLevel > 1 && builder.SizeLevel < 2;
+        // The module passes insert the instrumentation or annotate branches and calls with the profile's counts
+        // before inlining, so that the inliner, block placement and indirect call promotion can use them.
+        if (profile.instruments()) {
+            builder.EnablePGOInstrGen = true;
+            builder.PGOInstrGen = profile.instrumentationPath;
+        }
+        builder.PGOInstrUse = profile.profilePath;
+        targetMachine->adjustPassManager(builder);
+
+        // Inlining and GVN place retains and releases of the same value next to each other, so the passes are also run
+        // after the scalar optimizations of each function in the inliner's call graph walk.
+        builder.addExtension(llvm::PassManagerBuilder::EP_ScalarOptimizerLate,
+                             [runTime](const llvm::PassManagerBuilder &, llvm::legacy::PassManagerBase &pm) {
+            pm.add(new ConstantReferenceCountingPass(runTime));
+            pm.add(new RedundantReferenceCountingPass(runTime));
+        });
+
+        passManager_->add(llvm::createTargetTransformInfoWrapperPass(targetMachine->getTargetIRAnalysis()));
+        functionPassManager_->add(llvm::createTargetTransformInfoWrapperPass(targetMachine->getTargetIRAnalysis()));
+
+        if (!entryPoint.empty()) {
+            // Reifications, thunks, box retain and release functions and protocol tables that cannot be reached from
+            // 🏁 are removed. Link-once values are kept, as their addresses must be the same in all object files.
+            passManager_->add(llvm::createInternalizePass([entryPoint](const llvm::GlobalValue &value) {
+                return value.getName() == entryPoint || value.hasLinkOnceLinkage() || value.hasWeakLinkage();
+            }));
+            passManager_->add(llvm::createGlobalDCEPass());
+        }
 
         passManager_->add(new LocalReferenceCountingPass(runTime));
+        // Before the inliner, so that it can inline the methods that were called via protocol tables and the closures
+        // that were called via callables.
+        passManager_->add(new BoxSpecializationPass(boxType, callableType, builder.SizeLevel == 0));
 
         builder.populateFunctionPassManager(*functionPassManager_);
         builder.populateModulePassManager(*passManager_);
@@ -36,19 +97,23 @@ void OptimizationManager::initialize(RunTimeHelper *runTime) {
 
         passManager_->add(new ConstantReferenceCountingPass(runTime));
         passManager_->add(new RedundantReferenceCountingPass(runTime));
+        passManager_->add(llvm::createMergeFunctionsPass());
+        passManager_->add(llvm::createGlobalDCEPass());
+    }
+    else {
+        // Functions marked with 🥨 and calls from functions marked with 🥞 are inlined even without optimization.
+        passManager_->add(llvm::createAlwaysInlinerLegacyPass());
     }
 }
 
 void OptimizationManager::optimize(llvm::Function *function) {
-    if (optimize_) {
+    if (level_ != OptimizationLevel::None) {
         functionPassManager_->run(*function);
     }
 }
 
 void OptimizationManager::optimize(llvm::Module *module) {
-    if (optimize_) {
-        passManager_->run(*module);
-    }
+    passManager_->run(*module);
 }
 
 }  // namespace EmojicodeCompiler
@@ -5,11 +5,15 @@
 #ifndef EMOJICODE_OPTIMIZATIONMANAGER_HPP
 #define EMOJICODE_OPTIMIZATIONMANAGER_HPP
 
+#include "OptimizationLevel.hpp"
 #include <llvm/IR/LegacyPassManager.h>
 #include <memory>
+#include <string>
 
 namespace llvm {
 class Function;
+class Type;
+class TargetMachine;
 }  // namespace llvm
 
 namespace EmojicodeCompiler {
@@ -18,12 +22,25 @@ class RunTimeHelper;
 
 class OptimizationManager {
 public:
-    explicit OptimizationManager(llvm::Module *module, bool optimize, RunTimeHelper *runTime);
+    /// @param targetMachine The target for which code is generated. Its cost model is used by the optimizations, so
+    ///                      that for instance the loop vectorizer can use the vector registers of the target CPU.
+    /// @param boxType The type of boxes, whose first field the BoxSpecializationPass specializes functions for.
+    /// @param callableType The type of callables, whose function pointer the BoxSpecializationPass specializes
+    ///                     functions for.
+    /// @param profile Whether the module is instrumented or optimized with a profile.
+    /// @param entryPoint The name of the only function of the module that other object files call if the module is the
+    ///                   package of an executable, otherwise an empty string. All other functions and variables of an
+    ///                   executable's package are internalized and removed if they cannot be reached from it.
+    OptimizationManager(llvm::Module *module, OptimizationLevel level, RunTimeHelper *runTime,
+                        llvm::Type *boxType, llvm::Type *callableType, llvm::TargetMachine *targetMachine,
+                        const ProfileGuidance &profile = ProfileGuidance(), std::string entryPoint = "");
     void optimize(llvm::Function *function);
     void optimize(llvm::Module *module);
-    void initialize(RunTimeHelper *runTime);
+    void initialize(RunTimeHelper *runTime, llvm::Type *boxType, llvm::Type *callableType,
+                    llvm::TargetMachine *targetMachine,
+                    const ProfileGuidance &profile, const std::string &entryPoint);
 private:
-    bool optimize_;
+    OptimizationLevel level_;
     std::unique_ptr<llvm::legacy::FunctionPassManager> functionPassManager_;
     std::unique_ptr<llvm::legacy::PassManager> passManager_;
 };
@@ -36,7 +36,7 @@ llvm::Constant* ProtocolsTableGenerator::createProtocolTable(TypeDefinition *typ
 }
 
 void ProtocolsTableGenerator::generate(const Type &type) {
-    std::map<Type, llvm::Constant *> tables;
+    std::unordered_map<Type, llvm::Constant *> tables;
     auto boxInfo = generator_->boxInfoFor(type);
 
     for (auto &protocol : type.typeDefinition()->protocols()) {
@@ -48,7 +48,7 @@ void ProtocolsTableGenerator::generate(const Type &type) {
 }
 
 void ProtocolsTableGenerator::declareImported(const Type &type) {
-    std::map<Type, llvm::Constant *> tables;
+    std::unordered_map<Type, llvm::Constant *> tables;
     if (type.type() != TypeType::Class) {
         type.unboxed().valueType()->setBoxInfo(generator_->runTime().declareBoxInfo(mangleBoxInfoName(type)));
     }
@@ -101,8 +101,7 @@ llvm::GlobalVariable* ProtocolsTableGenerator::createDispatchTable(const Type &t
     }
 
     auto array = llvm::ConstantArray::get(arrayType, virtualTable);
-    auto arrayVar = new llvm::GlobalVariable(*generator_->module(), arrayType, true,
-                                             llvm::GlobalValue::LinkageTypes::PrivateLinkage, array);
+    auto arrayVar = generator_->constantVariable(array);
     auto avGep = buildConstant00Gep(arrayType, arrayVar, generator_->context());
 
     auto load = llvm::ConstantInt::get(llvm::Type::getInt1Ty(generator_->context()),
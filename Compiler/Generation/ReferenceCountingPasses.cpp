@@ -6,6 +6,8 @@
 //
 
 #include "ReferenceCountingPasses.hpp"
+#include <llvm/IR/CFG.h>
+#include <llvm/IR/IntrinsicInst.h>
 
 namespace EmojicodeCompiler {
 
@@ -46,6 +48,21 @@ bool ReferenceCountingPass::isReleaseFunction(llvm::Function *function) {
     return function == runTime_->releaseMemory() || function == runTime_->release();
 }
 
+bool ReferenceCountingPass::mayRelease(llvm::Instruction *inst) {
+    if (llvm::isa<llvm::InvokeInst>(inst)) {
+        return true;
+    }
+    auto callInst = llvm::dyn_cast<llvm::CallInst>(inst);
+    if (callInst == nullptr || llvm::isa<llvm::IntrinsicInst>(callInst)) {
+        return false;
+    }
+    auto function = callInst->getCalledFunction();
+    if (function != nullptr && isRetainFunction(function)) {
+        return false;
+    }
+    return !callInst->onlyReadsMemory();
+}
+
 void LocalReferenceCountingPass::transformMemoryInst(llvm::CallInst *callInst) {
     auto operand = callInst->getArgOperand(0);
 
@@ -99,7 +116,10 @@ void RedundantReferenceCountingPass::transformBlock(llvm::BasicBlock &block) {
             if (isRetainFunction(callInst->getCalledFunction())) {
                 retains[callInst->getArgOperand(0)].emplace_back(callInst);
             }
-            else if (!isReleaseFunction(callInst->getCalledFunction()) || !findCounterpart(callInst, retains)) {
+            else if (isReleaseFunction(callInst->getCalledFunction()) && findCounterpart(callInst, retains)) {
+                continue;
+            }
+            else if (mayRelease(callInst)) {
                 retains.clear();
             }
         }
@@ -121,8 +141,89 @@ bool RedundantReferenceCountingPass::runOnFunction(llvm::Function &function) {
     for (llvm::BasicBlock &block : function) {
         transformBlock(block);
     }
+    modified_ = !toBeDeleted_.empty();
     deleteInstructions();
+    sinkRetains(function);
     return modified_;
 }
 
+void RedundantReferenceCountingPass::sinkRetains(llvm::Function &function) {
+    std::vector<llvm::CallInst*> retains;
+    for (auto &block : function) {
+        for (auto &inst : block) {
+            auto callInst = llvm::dyn_cast<llvm::CallInst>(&inst);
+            if (callInst != nullptr && isRetainFunction(callInst->getCalledFunction())) {
+                retains.emplace_back(callInst);
+            }
+        }
+    }
+    // Every sink removes at least one release, so retains that are sunk again eventually stop.
+    while (!retains.empty()) {
+        auto retain = retains.back();
+        retains.pop_back();
+        auto sunk = sinkRetain(retain);
+        retains.insert(retains.end(), sunk.begin(), sunk.end());
+    }
+}
+
+std::vector<llvm::CallInst*> RedundantReferenceCountingPass::sinkRetain(llvm::CallInst *retain) {
+    auto block = retain->getParent();
+    auto terminator = block->getTerminator();
+    if (!retain->use_empty() ||
+        (!llvm::isa<llvm::BranchInst>(terminator) && !llvm::isa<llvm::SwitchInst>(terminator))) {
+        return {};
+    }
+    for (auto it = std::next(retain->getIterator()); &*it != terminator; it++) {
+        if (mayRelease(&*it)) {
+            return {};
+        }
+    }
+
+    std::vector<llvm::CallInst*> releases;
+    std::vector<llvm::BasicBlock*> others;
+    for (auto successor : llvm::successors(block)) {
+        // The retain can only be moved into blocks that are not reached on any other path. This also rejects blocks
+        // that are reached through several edges from this block.
+        if (successor->getSinglePredecessor() != block) {
+            return {};
+        }
+        if (auto release = leadingRelease(successor, retain)) {
+            releases.emplace_back(release);
+        }
+        else {
+            others.emplace_back(successor);
+        }
+    }
+    if (releases.empty()) {
+        return {};
+    }
+
+    std::vector<llvm::CallInst*> sunk;
+    for (auto release : releases) {
+        release->eraseFromParent();
+    }
+    for (auto successor : others) {
+        auto clone = llvm::cast<llvm::CallInst>(retain->clone());
+        clone->insertBefore(&*successor->getFirstInsertionPt());
+        sunk.emplace_back(clone);
+    }
+    retain->eraseFromParent();
+    modified_ = true;
+    return sunk;
+}
+
+llvm::CallInst* RedundantReferenceCountingPass::leadingRelease(llvm::BasicBlock *block, llvm::CallInst *retain) {
+    for (auto &inst : *block) {
+        auto callInst = llvm::dyn_cast<llvm::CallInst>(&inst);
+        if (callInst != nullptr && isReleaseFunction(callInst->getCalledFunction()) &&
+            callInst->getArgOperand(0) == retain->getArgOperand(0)) {
+            return callInst;
+        }
+        if (mayRelease(&inst)) {
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
 }
@@ -33,6 +33,9 @@ protected:
     bool isMemoryFunction(llvm::Function *function);
     bool isRetainFunction(llvm::Function *function);
     bool isReleaseFunction(llvm::Function *function);
+    /// Returns true unless `inst` certainly does not call a member of the ejcRelease family, i.e. unless it is no call,
+    /// a call of an intrinsic or the ejcRetain family, or a call that only reads memory.
+    bool mayRelease(llvm::Instruction *inst);
 };
 
 /// Detects calls to the ejcRetain/Relase family with constant expresssions as argument and removes them.
@@ -57,7 +60,7 @@ private:
 };
 
 /// This pass finds calls to the ejcRetain family where the counterpart call to a member of the ejcRelease family
-/// is within the same block without other calls in-between and removes them.
+/// is within the same block without calls in-between that may release (see mayRelease()) and removes them.
 ///
 /// This will also optimize transfer of ownership as in this example:
 /// ```
@@ -66,6 +69,10 @@ private:
 /// call void @ejcRelease(i8* %18)  ; will be removed
 /// ret %_.class_1f41f* %1
 /// ```
+///
+/// Afterwards, retains that are only followed by instructions that do not release in their block are sunk into the
+/// successors of the block if at least one successor begins with the counterpart release, which then cancels the
+/// retain. This removes the retain and release from paths that, for instance, return a value an if just retained.
 class RedundantReferenceCountingPass : public ReferenceCountingPass {
 public:
     static char id;
@@ -75,6 +82,13 @@ private:
     void transformBlock(llvm::BasicBlock &block);
     bool findCounterpart(llvm::CallInst *release, std::map<llvm::Value*, std::vector<llvm::CallInst*>> &retains);
     bool runOnFunction(llvm::Function &function) override;
+
+    void sinkRetains(llvm::Function &function);
+    /// Sinks `retain` into the successors of its block as described above and returns the retains that were inserted
+    /// into successors.
+    std::vector<llvm::CallInst*> sinkRetain(llvm::CallInst *retain);
+    /// Returns the first release of the argument of `retain` in `block` if no instruction that may release precedes it.
+    llvm::CallInst* leadingRelease(llvm::BasicBlock *block, llvm::CallInst *retain);
 };
 
 }
@@ -28,6 +28,11 @@ void RunTimeHelper::declareRunTime() {
     alloc_->addFnAttr(llvm::Attribute::getWithAllocSizeArgs(generator_->context(), 0, llvm::Optional<unsigned>()));
     alloc_->addAttribute(llvm::AttributeList::ReturnIndex, llvm::Attribute::NoAlias);
 
+    poolAlloc_ = declareRunTimeFunction("ejcPoolAlloc", llvm::Type::getInt8PtrTy(generator_->context()),
+                                        generator_->typeHelper().classInfo()->getPointerTo());
+    poolAlloc_->addAttribute(llvm::AttributeList::ReturnIndex, llvm::Attribute::NonNull);
+    poolAlloc_->addAttribute(llvm::AttributeList::ReturnIndex, llvm::Attribute::NoAlias);
+
     panic_ = declareRunTimeFunction("ejcPanic", llvm::Type::getVoidTy(generator_->context()),
                                     llvm::Type::getInt8PtrTy(generator_->context()));
     panic_->addFnAttr(llvm::Attribute::NoReturn);
@@ -99,10 +104,25 @@ void RunTimeHelper::declareRunTime() {
     ignoreBlock_ = new llvm::GlobalVariable(*generator_->module(), llvm::Type::getInt8Ty(generator_->context()), true,
                                             llvm::GlobalValue::LinkageTypes::ExternalLinkage, nullptr,
                                             "ejcIgnoreBlock");
+    tracing_ = new llvm::GlobalVariable(*generator_->module(), llvm::Type::getInt8Ty(generator_->context()), false,
+                                        llvm::GlobalValue::LinkageTypes::ExternalLinkage, nullptr, "ejcTracing");
 
     somethingRTTI_ = createAbstractRtti("something_rtti");
     someobjectRTTI_ = createAbstractRtti("someobject_rtti");
 
+    trivialBoxRetainRelease_ = llvm::Function::Create(generator_->typeHelper().boxRetainRelease(),
+                                                      llvm::Function::ExternalLinkage, "ejcTrivialBoxRetainRelease",
+                                                      generator_->module());
+    trivialBoxRetainRelease_->addFnAttr(llvm::Attribute::NoUnwind);
+    trivialBoxRetainRelease_->addFnAttr(llvm::Attribute::ReadNone);
+
+    copyBoxes_ = declareRunTimeFunction("ejcCopyBoxes", llvm::Type::getVoidTy(generator_->context()), {
+        generator_->typeHelper().box()->getPointerTo(), generator_->typeHelper().box()->getPointerTo(),
+        llvm::Type::getInt64Ty(generator_->context())
+    });
+    copyBoxes_->addParamAttr(0, llvm::Attribute::NoAlias);
+    copyBoxes_->addParamAttr(1, llvm::Attribute::NoAlias);
+
     // This has to be last as buildRetainRelease uses functions declared above!
     boxInfoClassObjects_ = declareBoxInfo("class.boxInfo");
     classObjectRetainRelease_ = buildRetainRelease(Type(generator_->compiler()->sString), "class.boxRetain",
@@ -122,6 +142,15 @@ void RunTimeHelper::declareRunTime() {
                                    llvm::Type::getInt8PtrTy(generator_->context()));
     free_->removeFnAttr(llvm::Attribute::NoRecurse);
     free_->addParamAttr(0, llvm::Attribute::NonNull);
+
+    memcmp_ = declareRunTimeFunction("memcmp", llvm::Type::getInt32Ty(generator_->context()),
+                                     { llvm::Type::getInt8PtrTy(generator_->context()),
+                                       llvm::Type::getInt8PtrTy(generator_->context()),
+                                       llvm::Type::getInt64Ty(generator_->context()) });
+    memcmp_->addFnAttr(llvm::Attribute::ReadOnly);
+    memcmp_->addFnAttr(llvm::Attribute::ArgMemOnly);
+    memcmp_->addParamAttr(0, llvm::Attribute::NoCapture);
+    memcmp_->addParamAttr(1, llvm::Attribute::NoCapture);
 }
 
 llvm::Function* RunTimeHelper::declareRunTimeFunction(const char *name, llvm::Type *returnType,
@@ -133,6 +162,18 @@ llvm::Function* RunTimeHelper::declareRunTimeFunction(const char *name, llvm::Ty
     return fn;
 }
 
+llvm::Function* RunTimeHelper::mathFunction(const char *name) {
+    if (auto fn = generator_->module()->getFunction(name)) {
+        return fn;
+    }
+    auto fn = declareRunTimeFunction(name, llvm::Type::getDoubleTy(generator_->context()),
+                                     llvm::Type::getDoubleTy(generator_->context()));
+    // Emojicode does not observe errno, which is the only memory these functions write.
+    fn->addFnAttr(llvm::Attribute::ReadNone);
+    fn->addFnAttr(llvm::Attribute::Speculatable);
+    return fn;
+}
+
 llvm::Function* RunTimeHelper::declareMemoryRunTimeFunction(const char *name) {
     auto fn = declareRunTimeFunction(name, llvm::Type::getVoidTy(generator_->context()),
                                      llvm::Type::getInt8PtrTy(generator_->context()));
@@ -31,6 +31,8 @@ public:
 
     /// The allocator function that is called to allocate all heap memory. (ejcAlloc)
     llvm::Function* alloc() const { return alloc_; }
+    /// Allocates an instance of a class declared with 🏊 from the pool of the class. (ejcPoolAlloc)
+    llvm::Function* poolAlloc() const { return poolAlloc_; }
     /// The panic method, which is called if the program panics due to e.g. unwrapping an empty optional. (ejcPanic)
     llvm::Function* panic() const { return panic_; }
     /// The function that is called to determine if one class inherits from another. (ejcInheritsFrom)
@@ -61,6 +63,8 @@ public:
 
     llvm::Function* malloc() const { return malloc_; }
     llvm::Function* free() const { return free_; }
+    /// Compares memory areas. LLVM expands calls with a small constant size into loads and comparisons. (memcmp)
+    llvm::Function* memcmp() const { return memcmp_; }
 
     llvm::Function* checkGenericArgs() const { return checkGenericArgs_; }
     llvm::Function* typeDescriptionLength() const { return typeDescriptionLength_; }
@@ -68,7 +72,13 @@ public:
 
     llvm::Function* isOnlyReference() const { return isOnlyReference_; }
 
+    /// Returns the C library math function *name*, e.g. `tan`, which takes and returns a double. LLVM knows these
+    /// functions and folds calls with constant arguments or replaces them with vectorized versions in loops.
+    llvm::Function* mathFunction(const char *name);
+
     llvm::GlobalVariable* ignoreBlockPtr() const { return ignoreBlock_; }
+    /// The flag of the run-time library that is non-zero while tracing. (ejcTracing)
+    llvm::GlobalVariable* tracing() const { return tracing_; }
 
     /// Declares the box info with the provided name. This is a global variable without initializer.
     llvm::GlobalVariable* declareBoxInfo(const std::string &name);
@@ -77,6 +87,12 @@ public:
     llvm::GlobalVariable* boxInfoForCallables() { return boxInfoCallables_; }
 
     std::pair<llvm::Function*, llvm::Function*> classObjectRetainRelease() const { return classObjectRetainRelease_; }
+    /// The function used as box retain and release function for all trivially copyable types, which allows the run-time
+    /// library to identify boxes that need not be retained. (ejcTrivialBoxRetainRelease)
+    llvm::Function* trivialBoxRetainRelease() const { return trivialBoxRetainRelease_; }
+    /// Copies boxes from one memory area to another and retains the copies unless they contain trivially copyable
+    /// values. (ejcCopyBoxes)
+    llvm::Function* copyBoxes() const { return copyBoxes_; }
 
     llvm::Constant* createRtti(TypeDefinition *generic, RunTimeTypeInfoFlags::Flags flag);
 
@@ -87,6 +103,7 @@ private:
     CodeGenerator *generator_;
 
     llvm::Function *alloc_ = nullptr;
+    llvm::Function *poolAlloc_ = nullptr;
     llvm::Function *panic_ = nullptr;
 
     llvm::Function *inheritsFrom_ = nullptr;
@@ -98,6 +115,7 @@ private:
     llvm::GlobalVariable *boxInfoClassObjects_ = nullptr;
     llvm::GlobalVariable *boxInfoCallables_ = nullptr;
     llvm::GlobalVariable *ignoreBlock_ = nullptr;
+    llvm::GlobalVariable *tracing_ = nullptr;
 
     llvm::Function *retain_ = nullptr;
     llvm::Function *retainMemory_ = nullptr;
@@ -107,9 +125,12 @@ private:
     llvm::Function *releaseWithoutDeinit_ = nullptr;
     llvm::Function *releaseLocal_ = nullptr;
     llvm::Function *isOnlyReference_ = nullptr;
+    llvm::Function *trivialBoxRetainRelease_ = nullptr;
+    llvm::Function *copyBoxes_ = nullptr;
 
     llvm::Function *malloc_ = nullptr;
     llvm::Function *free_ = nullptr;
+    llvm::Function *memcmp_ = nullptr;
 
     llvm::GlobalVariable *somethingRTTI_ = nullptr;
     llvm::GlobalVariable *someobjectRTTI_ = nullptr;
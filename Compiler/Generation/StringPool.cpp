@@ -13,10 +13,18 @@
 #include "Package/Package.hpp"
 #include "Types/Class.hpp"
 #include <llvm/IR/Constants.h>
+#include <llvm/ADT/Triple.h>
 #include <llvm/IR/GlobalVariable.h>
+#include <llvm/Support/MD5.h>
+#include <algorithm>
 
 namespace EmojicodeCompiler {
 
+/// Returns true if the UTF-8 encoded string consists of ASCII characters only.
+static bool isAscii(const std::string &string) {
+    return std::all_of(string.begin(), string.end(), [](char c) { return (static_cast<unsigned char>(c) & 0x80) == 0; });
+}
+
 llvm::Value* StringPool::pool(const std::u32string &string) {
     auto it = pool_.find(string);
     if (it != pool_.end()) {
@@ -27,14 +35,45 @@ llvm::Value* StringPool::pool(const std::u32string &string) {
     return stringVar;
 }
 
+llvm::Constant* StringPool::poolBytes(const std::u32string &string) {
+    auto stringVar = llvm::cast<llvm::GlobalVariable>(pool(string));
+    auto memory = stringVar->getInitializer()->getAggregateElement(2u);
+    // The bytes are preceded by the pointer to the control block like in every memory area.
+    auto offset = llvm::ConstantExpr::getSizeOf(llvm::Type::getInt8PtrTy(codeGenerator_->context()));
+    return llvm::ConstantExpr::getInBoundsGetElementPtr(llvm::Type::getInt8Ty(codeGenerator_->context()), memory,
+                                                        offset);
+}
+
+void StringPool::makeMergeable(llvm::GlobalVariable *variable) const {
+    variable->setLinkage(llvm::GlobalValue::LinkageTypes::LinkOnceODRLinkage);
+    variable->setVisibility(llvm::GlobalValue::VisibilityTypes::HiddenVisibility);
+    // Mach-O has no COMDATs, its linker coalesces weak definitions by name instead.
+    if (!llvm::Triple(codeGenerator_->module()->getTargetTriple()).isOSBinFormatMachO()) {
+        variable->setComdat(codeGenerator_->module()->getOrInsertComdat(variable->getName()));
+    }
+}
+
 llvm::Value* StringPool::addToPool(const std::string &string) {
+    llvm::MD5 md5;
+    md5.update(string);
+    llvm::MD5::MD5Result result;
+    md5.final(result);
+    // Literals are named after their content, so that the linker keeps one copy of every literal that multiple
+    // packages contain.
+    auto name = "string." + result.digest().str().str();
+    if (auto existing = codeGenerator_->module()->getNamedGlobal(name)) {
+        return existing;
+    }
+
     auto data = llvm::ArrayRef<uint8_t>(reinterpret_cast<const uint8_t*>(string.data()), string.size());
     auto constant = llvm::ConstantStruct::getAnon({
         codeGenerator_->runTime().ignoreBlockPtr(),
         llvm::ConstantDataArray::get(codeGenerator_->context(), data)
     });
     auto var = new llvm::GlobalVariable(*codeGenerator_->module(), constant->getType(), true,
-                                        llvm::GlobalValue::LinkageTypes::PrivateLinkage, constant);
+                                        llvm::GlobalValue::LinkageTypes::PrivateLinkage, constant, name + ".bytes");
+    var->setUnnamedAddr(llvm::GlobalVariable::UnnamedAddr::Global);
+    makeMergeable(var);
 
 
     auto compiler = codeGenerator_->compiler();
@@ -48,11 +87,17 @@ llvm::Value* StringPool::addToPool(const std::string &string) {
         codeGenerator_->runTime().ignoreBlockPtr(),
         compiler->sString->classInfo(),
         varCast,
-        llvm::ConstantInt::get(llvm::Type::getInt64Ty(codeGenerator_->context()), string.size())
+        llvm::ConstantInt::get(llvm::Type::getInt64Ty(codeGenerator_->context()), string.size()),
+        llvm::ConstantInt::get(llvm::Type::getInt64Ty(codeGenerator_->context()), 0),  // hash, cached by sStringHash
+        llvm::ConstantInt::get(llvm::Type::getInt64Ty(codeGenerator_->context()), isAscii(string) ? 1 : 2),
+        llvm::ConstantInt::get(llvm::Type::getInt64Ty(codeGenerator_->context()), 0),  // start
+        llvm::Constant::getNullValue(stringLlvm->getElementType(7))  // graphemeCheckpoints
     });
 
-    auto stringVar = new llvm::GlobalVariable(*codeGenerator_->module(), stringLlvm, true,
-                                              llvm::GlobalValue::LinkageTypes::PrivateLinkage, stringStruct, "string");
+    // Not constant as sStringHash caches the hash in the string.
+    auto stringVar = new llvm::GlobalVariable(*codeGenerator_->module(), stringLlvm, false,
+                                              llvm::GlobalValue::LinkageTypes::PrivateLinkage, stringStruct, name);
+    makeMergeable(stringVar);
     return stringVar;
 }
 
@@ -9,11 +9,13 @@
 #ifndef StringPool_hpp
 #define StringPool_hpp
 
-#include <map>
+#include <unordered_map>
 #include <string>
 
 namespace llvm {
 class Value;
+class Constant;
+class GlobalVariable;
 }  // namespace llvm
 
 namespace EmojicodeCompiler {
@@ -21,6 +23,9 @@ namespace EmojicodeCompiler {
 class CodeGenerator;
 
 /// StringPool represents an application’s string pool.
+///
+/// The string objects and their characters are emitted with linkonce_odr linkage and names derived from their
+/// content, so that the linker folds the literals that occur in multiple packages into one.
 class StringPool {
 public:
     explicit StringPool(CodeGenerator *cg) : codeGenerator_(cg) {}
@@ -30,8 +35,13 @@ public:
     /// @returns The index to access the string in the pool.
     llvm::Value* pool(const std::u32string &string);
     llvm::Value* addToPool(const std::string &string);
+    /// Pools the given string like pool() does.
+    /// @returns A pointer to the UTF-8 encoded bytes of the pooled string, which are constant.
+    llvm::Constant* poolBytes(const std::u32string &string);
 private:
-    std::map<std::u32string, llvm::Value*> pool_;
+    std::unordered_map<std::u32string, llvm::Value*> pool_;
+    /// Gives *variable* linkage that lets the linker keep only one of the definitions with the same name.
+    void makeMergeable(llvm::GlobalVariable *variable) const;
     CodeGenerator *codeGenerator_;
 };
 
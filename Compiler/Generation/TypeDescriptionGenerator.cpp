@@ -16,7 +16,7 @@
 
 namespace EmojicodeCompiler {
 
-void TypeDescriptionGenerator::addType(const Type &type) {
+llvm::Value* TypeDescriptionGenerator::addType(const Type &type) {
     llvm::Constant *genericInfo;
     auto notype = type.unoptionalized().unboxed();
     switch (notype.type()) {
@@ -41,11 +41,9 @@ void TypeDescriptionGenerator::addType(const Type &type) {
                 fg_->calleeType().typeDefinition()->isGenericDynamismDisabled()) {
                 throw CompilerError(fg_->position(), "Generic dynamism is disabled in this type.");
             }
-            addDynamic(extractTypeDescriptionPtr(), notype.genericVariableIndex());
-            return;
+            return addDynamic(extractTypeDescriptionPtr(), notype.genericVariableIndex());
         case TypeType::LocalGenericVariable:
-            addDynamic(fg_->functionGenericArgs(), notype.genericVariableIndex());
-            return;
+            return addDynamic(fg_->functionGenericArgs(), notype.genericVariableIndex());
         case TypeType::Callable:
         case TypeType::TypeAsValue:
         case TypeType::MultiProtocol:
@@ -58,16 +56,26 @@ void TypeDescriptionGenerator::addType(const Type &type) {
             throw std::logic_error("Cannot create type description for compile-time type.");
     }
 
-    auto strct = llvm::ConstantStruct::get(fg_->typeHelper().typeDescription(), {
+    auto index = types_.size();
+    types_.emplace_back(nullptr);
+    llvm::Value *length = fg_->int64(1);
+    if (notype.canHaveGenericArguments()) {
+        for (auto &arg : notype.genericArguments()) {
+            length = fg_->builder().CreateAdd(length, addType(arg));
+        }
+    }
+
+    // The length is constant unless a generic argument is copied from a dynamic description.
+    auto constantLength = llvm::dyn_cast<llvm::ConstantInt>(length);
+    types_[index].concrete = llvm::ConstantStruct::get(fg_->typeHelper().typeDescription(), {
         genericInfo,
-        type.type() == TypeType::Optional ? llvm::ConstantInt::getTrue(fg_->ctx()) : llvm::ConstantInt::getFalse(fg_->ctx())
+        type.type() == TypeType::Optional ? llvm::ConstantInt::getTrue(fg_->ctx()) : llvm::ConstantInt::getFalse(fg_->ctx()),
+        fg_->int32(constantLength != nullptr ? constantLength->getSExtValue() : 0)
     });
-    types_.emplace_back(strct);
-
-    if (!notype.canHaveGenericArguments()) return;
-    for (auto &arg : notype.genericArguments()) {
-        addType(arg);
+    if (constantLength == nullptr) {
+        types_[index].length = length;
     }
+    return length;
 }
 
 llvm::Value* TypeDescriptionGenerator::extractTypeDescriptionPtr() {
@@ -81,12 +89,13 @@ llvm::Value* TypeDescriptionGenerator::extractTypeDescriptionPtr() {
     return fg_->builder().CreateConstInBoundsGEP2_32(ptr->getType()->getPointerElementType(), ptr, 0, 1);
 }
 
-void TypeDescriptionGenerator::addDynamic(llvm::Value *gargs, size_t index) {
+llvm::Value* TypeDescriptionGenerator::addDynamic(llvm::Value *gargs, size_t index) {
     dynamic_++;
     auto idf = fg_->generator()->runTime().indexTypeDescription();
     auto td = index > 0 ? fg_->builder().CreateCall(idf, { gargs, fg_->int64(index) }) : gargs;
     auto size = fg_->builder().CreateCall(fg_->generator()->runTime().typeDescriptionLength(), td);
     types_.emplace_back(td, size);
+    return size;
 }
 
 llvm::Value* TypeDescriptionGenerator::generate(const std::vector<Type> &types) {
@@ -147,7 +156,12 @@ llvm::Value* TypeDescriptionGenerator::finish() {
             current = fg_->builder().CreateInBoundsGEP(current, tdv.size);
         }
         else {
-            fg_->builder().CreateStore(tdv.concrete, current);
+            llvm::Value *description = tdv.concrete;
+            if (tdv.length != nullptr) {
+                auto length = fg_->builder().CreateTrunc(tdv.length, llvm::Type::getInt32Ty(fg_->ctx()));
+                description = fg_->builder().CreateInsertValue(description, length, 2);
+            }
+            fg_->builder().CreateStore(description, current);
             current = fg_->builder().CreateConstInBoundsGEP1_32(typeDesc, current, 1);
         }
     }
@@ -171,9 +185,7 @@ llvm::Value* TypeDescriptionGenerator::finishStatic() {
     if (user_ == User::ValueTypeOrValue) {
         init = llvm::ConstantStruct::getAnon({ fg_->generator()->runTime().ignoreBlockPtr(), init });
     }
-    auto var = new llvm::GlobalVariable(*fg_->generator()->module(), init->getType(), true,
-                                        llvm::GlobalValue::LinkageTypes::PrivateLinkage, init);
-    var->setUnnamedAddr(llvm::GlobalVariable::UnnamedAddr::Global);
+    auto var = fg_->generator()->constantVariable(init);
 
     if (user_ == User::ValueTypeOrValue) {
         auto mng = fg_->typeHelper().managable(fg_->typeHelper().typeDescription())->getPointerTo();
@@ -29,13 +29,19 @@ enum class TypeDescriptionUser {
 /// The TypeDescriptionGenerator creates a %typeDescription* pointing to the first element of an array describing one or
 /// more types and their generic arguments.
 ///
+/// Each element stores the number of elements that describe the type and its generic arguments, so that the run-time
+/// can skip over a type without visiting its generic arguments.
+///
 /// If none the provided types requires dynamism (i.e. none is a generic variable) the array is created as a global
-/// variable.
+/// variable. Equal arrays share one global variable.
 class TypeDescriptionGenerator {
     struct TypeDescriptionValue {
         TypeDescriptionValue(llvm::Constant *constant) : concrete(constant) {}
         TypeDescriptionValue(llvm::Value *from, llvm::Value *size) : from(from), size(size) {}
         llvm::Constant *concrete = nullptr;
+        /// If the generic arguments of the type require dynamism, the number of elements describing it, which must be
+        /// inserted into concrete.
+        llvm::Value *length = nullptr;
         llvm::Value *from;
         llvm::Value *size;
 
@@ -56,10 +62,11 @@ public:
     void restoreStack();
 
 private:
-    void addType(const Type &type);
+    /// Adds the description of @c type and returns the number of elements that describe it.
+    llvm::Value* addType(const Type &type);
     llvm::Value* finish();
     llvm::Value* finishStatic();
-    void addDynamic(llvm::Value *gargs, size_t index);
+    llvm::Value* addDynamic(llvm::Value *gargs, size_t index);
 
     FunctionCodeGenerator *fg_;
     /// Describes all values that will appear in the array
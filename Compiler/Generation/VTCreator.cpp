@@ -13,11 +13,22 @@ VTCreator::VTCreator(Class *klass, CodeGenerator *cg)
     : generator_(cg), klass_(klass),
      vti_(klass->superclass() != nullptr ? klass->superclass()->virtualFunctionCount() : 0) {}
 
+bool VTCreator::dispatchedDynamically(Function *function) const {
+    // Subclasses of a class that other packages cannot extend are declared in this package, which has been analysed.
+    // The slots of an extensible class, which includes the superclasses of an exported class, must not depend on the
+    // packages that subclass it, as they all must agree on its table.
+    return function->overridden() || klass_->extensibleByOtherPackages();
+}
+
 void VTCreator::assign(Function *function) {
+    auto needsSlot = dispatchedDynamically(function);
     decltype(vti_) designatedVti;
     if (auto sf = function->superFunction()) {
         designatedVti = sf->unspecificReification().vti();
     }
+    else if (!needsSlot) {
+        return;
+    }
     else {
         functions_.emplace_back(nullptr);
         designatedVti = vti_++;
@@ -29,9 +40,11 @@ void VTCreator::assign(Function *function) {
         generator_->declareLlvmFunction(layer);
         functions_[designatedVti] = layer->unspecificReification().function;
 
-        functions_.emplace_back(function->unspecificReification().function);
         function->unspecificReification().setVti(designatedVti);
-        vti_++;
+        if (needsSlot) {
+            functions_.emplace_back(function->unspecificReification().function);
+            vti_++;
+        }
     }
     else {
         function->unspecificReification().setVti(designatedVti);
@@ -35,6 +35,9 @@ private:
     std::vector<llvm::Constant *> functions_;
 
     void assign(Function *reification);
+    /// Returns true if *function* can be called through the virtual table of the class. Functions that are always
+    /// dispatched statically (see ASTMethodable::hasSingleImplementation) get no slot of their own.
+    bool dispatchedDynamically(Function *function) const;
 };
 
 }  // namespace EmojicodeCompiler
@@ -7,10 +7,15 @@
 //
 
 #include "EmojiTokenization.hpp"
+#include <array>
+#include <cstdint>
+#include <vector>
 
 namespace EmojicodeCompiler {
 
-bool isEmoji(char32_t ch) {
+namespace {
+
+bool inEmojiRanges(char32_t ch) {
     return ch == 0x00A9 || ch == 0x00AE || ch == 0x203C ||
     ch == 0x2049 || ch == 0x2122 || ch == 0x2139 ||
     (0x2194 <= ch && ch <= 0x2199) || (0x21A9 <= ch && ch <= 0x21AA) || (0x231A <= ch && ch <= 0x231B) ||
@@ -88,7 +93,7 @@ bool isEmoji(char32_t ch) {
     (0x1F9C1 <= ch && ch <= 0x1F9C2) || (0x1F9D0 <= ch && ch <= 0x1F9E6) || (0x1F9E7 <= ch && ch <= 0x1F9FF);
 }
 
-bool isEmojiModifierBase(char32_t ch) {
+bool inEmojiModifierBaseRanges(char32_t ch) {
     return ch == 0x261D || ch == 0x26F9 || (0x270A <= ch && ch <= 0x270B) ||
     (0x270C <= ch && ch <= 0x270D) || ch == 0x1F385 || (0x1F3C2 <= ch && ch <= 0x1F3C4) ||
     ch == 0x1F3C7 || ch == 0x1F3CA || (0x1F3CB <= ch && ch <= 0x1F3CC) ||
@@ -105,12 +110,83 @@ bool isEmojiModifierBase(char32_t ch) {
     (0x1F9D1 <= ch && ch <= 0x1F9DD);
 }
 
+enum CharacterClass : uint8_t {
+    kEmoji = 1 << 0,
+    kEmojiModifierBase = 1 << 1,
+    kEmojiModifier = 1 << 2,
+    kRegionalIndicator = 1 << 3,
+};
+
+uint8_t computeClasses(char32_t ch) {
+    uint8_t classes = 0;
+    if (inEmojiRanges(ch)) classes |= kEmoji;
+    if (inEmojiModifierBaseRanges(ch)) classes |= kEmojiModifierBase;
+    if (0x1F3FB <= ch && ch <= 0x1F3FF) classes |= kEmojiModifier;
+    if (0x1F1E6 <= ch && ch <= 0x1F1FF) classes |= kRegionalIndicator;
+    return classes;
+}
+
+/// A two-level lookup table of the classes of all code points below kLimit. The first level maps the upper bits of a
+/// code point to a block, the second level stores the classes of each of the code points in the block. Blocks that
+/// are equal are only stored once, so that all blocks without any emoji share a single block.
+class CharacterClassTable {
+public:
+    static constexpr char32_t kLimit = 0x20000;
+
+    CharacterClassTable() {
+        for (char32_t high = 0; high < kLimit >> kBlockBits; high++) {
+            Block block;
+            for (char32_t low = 0; low < kBlockSize; low++) {
+                block[low] = computeClasses(high << kBlockBits | low);
+            }
+            size_t index = 0;
+            while (index < blocks_.size() && blocks_[index] != block) {
+                index++;
+            }
+            if (index == blocks_.size()) {
+                blocks_.emplace_back(block);
+            }
+            index_[high] = static_cast<uint16_t>(index);
+        }
+    }
+
+    uint8_t classes(char32_t ch) const {
+        if (ch >= kLimit) {
+            return 0;
+        }
+        return blocks_[index_[ch >> kBlockBits]][ch & (kBlockSize - 1)];
+    }
+
+private:
+    static constexpr unsigned kBlockBits = 8;
+    static constexpr char32_t kBlockSize = 1 << kBlockBits;
+    using Block = std::array<uint8_t, kBlockSize>;
+
+    std::array<uint16_t, (kLimit >> kBlockBits)> index_;
+    std::vector<Block> blocks_;
+};
+
+uint8_t characterClasses(char32_t ch) {
+    static const CharacterClassTable table;
+    return table.classes(ch);
+}
+
+}  // namespace
+
+bool isEmoji(char32_t ch) {
+    return (characterClasses(ch) & kEmoji) != 0;
+}
+
+bool isEmojiModifierBase(char32_t ch) {
+    return (characterClasses(ch) & kEmojiModifierBase) != 0;
+}
+
 bool isEmojiModifier(char32_t ch) {
-    return 0x1F3FB <= ch && ch <= 0x1F3FF;
+    return (characterClasses(ch) & kEmojiModifier) != 0;
 }
 
 bool isRegionalIndicator(char32_t ch) {
-    return 0x1F1E6 <= ch && ch <= 0x1F1FF;
+    return (characterClasses(ch) & kRegionalIndicator) != 0;
 }
 
 bool isValidEmoji(std::u32string string) {
@@ -14,58 +14,67 @@
 namespace EmojicodeCompiler {
 
 Lexer::Lexer(SourceFile *source, bool minimalMode)
-        : sourcePosition_(1, 0, source), source_(source), minimalMode_(minimalMode) {
+        : sourcePosition_(1, 0, source), source_(source), singleTokens_(singleTokenTable()),
+          minimalMode_(minimalMode) {
     skipWhitespace();
+}
 
-    loadOperatorSingleTokens();
-    singleTokens_.emplace(E_RED_EXCLAMATION_MARK, TokenType::EndArgumentList);
-    singleTokens_.emplace(E_RED_QUESTION_MARK, TokenType::EndInterrogativeArgumentList);
-    singleTokens_.emplace(E_RIGHT_FACING_FIST, TokenType::GroupBegin);
-    singleTokens_.emplace(E_LEFT_FACING_FIST, TokenType::GroupEnd);
-    singleTokens_.emplace(E_RIGHT_ARROW_CURVING_LEFT, TokenType::Return);
-    singleTokens_.emplace(E_CLOCKWISE_RIGHTWARDS_AND_LEFTWARDS_OPEN_CIRCLE_ARROWS, TokenType::RepeatWhile);
-    singleTokens_.emplace(E_CLOCKWISE_RIGHTWARDS_AND_LEFTWARDS_OPEN_CIRCLE_ARROWS_WITH_CIRCLED_ONE_OVERLAY,
-                          TokenType::ForIn);
-    singleTokens_.emplace(E_THUMBS_UP_SIGN, TokenType::BooleanTrue);
-    singleTokens_.emplace(E_THUMBS_DOWN_SIGN, TokenType::BooleanFalse);
-    singleTokens_.emplace(E_POLICE_CARS_LIGHT, TokenType::Error);
-    singleTokens_.emplace(E_LEFT_ARROW_CURVING_RIGHT, TokenType::If);
-    singleTokens_.emplace(E_OK, TokenType::ErrorHandler);
-    singleTokens_.emplace(E_GRAPES, TokenType::BlockBegin);
-    singleTokens_.emplace(E_WATERMELON, TokenType::BlockEnd);
-    singleTokens_.emplace(E_NEW_SIGN, TokenType::New);
-    singleTokens_.emplace(E_HAND_POINTING_DOWN, TokenType::This);
-    singleTokens_.emplace(E_BIOHAZARD, TokenType::Unsafe);
-    singleTokens_.emplace(E_RIGHT_ARROW_CURVING_UP, TokenType::Super);
-    singleTokens_.emplace(E_RIGHTWARDS_ARROW, TokenType::RightProductionOperator);
-    singleTokens_.emplace(E_LEFTWARDS_ARROW, TokenType::LeftProductionOperator);
-    singleTokens_.emplace(E_CRAYON, TokenType::Mutable);
-    singleTokens_.emplace(E_SPIRAL_SHELL, TokenType::Generic);
-
-    singleTokens_.emplace(E_CROCODILE, TokenType::Protocol);
-    singleTokens_.emplace(E_DOVE_OF_PEACE, TokenType::ValueType);
-    singleTokens_.emplace(E_RABBIT, TokenType::Class);
-    singleTokens_.emplace(E_RADIO_BUTTON, TokenType::Enumeration);
-    singleTokens_.emplace(E_CHEERING_MEGAPHONE, TokenType::SelectionOperator);
-    singleTokens_.emplace(U'🍿', TokenType::CollectionLiteral);
+const std::unordered_map<char32_t, TokenType>& Lexer::singleTokenTable() {
+    static const std::unordered_map<char32_t, TokenType> table = [] {
+        std::unordered_map<char32_t, TokenType> singleTokens;
+        loadOperatorSingleTokens(&singleTokens);
+        singleTokens.emplace(E_RED_EXCLAMATION_MARK, TokenType::EndArgumentList);
+        singleTokens.emplace(E_RED_QUESTION_MARK, TokenType::EndInterrogativeArgumentList);
+        singleTokens.emplace(E_RIGHT_FACING_FIST, TokenType::GroupBegin);
+        singleTokens.emplace(E_LEFT_FACING_FIST, TokenType::GroupEnd);
+        singleTokens.emplace(E_RIGHT_ARROW_CURVING_LEFT, TokenType::Return);
+        singleTokens.emplace(E_CLOCKWISE_RIGHTWARDS_AND_LEFTWARDS_OPEN_CIRCLE_ARROWS, TokenType::RepeatWhile);
+        singleTokens.emplace(E_CLOCKWISE_RIGHTWARDS_AND_LEFTWARDS_OPEN_CIRCLE_ARROWS_WITH_CIRCLED_ONE_OVERLAY,
+                             TokenType::ForIn);
+        singleTokens.emplace(E_THUMBS_UP_SIGN, TokenType::BooleanTrue);
+        singleTokens.emplace(E_THUMBS_DOWN_SIGN, TokenType::BooleanFalse);
+        singleTokens.emplace(E_POLICE_CARS_LIGHT, TokenType::Error);
+        singleTokens.emplace(E_LEFT_ARROW_CURVING_RIGHT, TokenType::If);
+        singleTokens.emplace(E_LEVEL_SLIDER, TokenType::Match);
+        singleTokens.emplace(E_OK, TokenType::ErrorHandler);
+        singleTokens.emplace(E_GRAPES, TokenType::BlockBegin);
+        singleTokens.emplace(E_WATERMELON, TokenType::BlockEnd);
+        singleTokens.emplace(E_NEW_SIGN, TokenType::New);
+        singleTokens.emplace(E_HAND_POINTING_DOWN, TokenType::This);
+        singleTokens.emplace(E_BIOHAZARD, TokenType::Unsafe);
+        singleTokens.emplace(E_RIGHT_ARROW_CURVING_UP, TokenType::Super);
+        singleTokens.emplace(E_RIGHTWARDS_ARROW, TokenType::RightProductionOperator);
+        singleTokens.emplace(E_LEFTWARDS_ARROW, TokenType::LeftProductionOperator);
+        singleTokens.emplace(E_CRAYON, TokenType::Mutable);
+        singleTokens.emplace(E_SPIRAL_SHELL, TokenType::Generic);
+
+        singleTokens.emplace(E_CROCODILE, TokenType::Protocol);
+        singleTokens.emplace(E_DOVE_OF_PEACE, TokenType::ValueType);
+        singleTokens.emplace(E_RABBIT, TokenType::Class);
+        singleTokens.emplace(E_RADIO_BUTTON, TokenType::Enumeration);
+        singleTokens.emplace(E_CHEERING_MEGAPHONE, TokenType::SelectionOperator);
+        singleTokens.emplace(U'🍿', TokenType::CollectionLiteral);
+        return singleTokens;
+    }();
+    return table;
 }
 
-void Lexer::loadOperatorSingleTokens() {
-    singleTokens_.emplace(E_HEAVY_PLUS_SIGN, TokenType::Operator);
-    singleTokens_.emplace(E_HEAVY_MINUS_SIGN, TokenType::Operator);
-    singleTokens_.emplace(E_HEAVY_DIVISION_SIGN, TokenType::Operator);
-    singleTokens_.emplace(E_HEAVY_MULTIPLICATION_SIGN, TokenType::Operator);
-    singleTokens_.emplace(E_OPEN_HANDS, TokenType::Operator);
-    singleTokens_.emplace(E_HANDSHAKE, TokenType::Operator);
-    singleTokens_.emplace(E_HEAVY_LARGE_CIRCLE, TokenType::Operator);
-    singleTokens_.emplace(E_ANGER_SYMBOL, TokenType::Operator);
-    singleTokens_.emplace(E_CROSS_MARK, TokenType::Operator);
-    singleTokens_.emplace(E_LEFT_POINTING_BACKHAND_INDEX, TokenType::Operator);
-    singleTokens_.emplace(E_RIGHT_POINTING_BACKHAND_INDEX, TokenType::Operator);
-    singleTokens_.emplace(E_PUT_LITTER_IN_ITS_SPACE, TokenType::Operator);
-    singleTokens_.emplace(E_HANDS_RAISED_IN_CELEBRATION, TokenType::Operator);
-    singleTokens_.emplace(E_FACE_WITH_STUCK_OUT_TONGUE_AND_WINKING_EYE, TokenType::Operator);
-    singleTokens_.emplace(E_RED_EXCLAMATION_MARK_AND_QUESTION_MARK, TokenType::Call);
+void Lexer::loadOperatorSingleTokens(std::unordered_map<char32_t, TokenType> *singleTokens) {
+    singleTokens->emplace(E_HEAVY_PLUS_SIGN, TokenType::Operator);
+    singleTokens->emplace(E_HEAVY_MINUS_SIGN, TokenType::Operator);
+    singleTokens->emplace(E_HEAVY_DIVISION_SIGN, TokenType::Operator);
+    singleTokens->emplace(E_HEAVY_MULTIPLICATION_SIGN, TokenType::Operator);
+    singleTokens->emplace(E_OPEN_HANDS, TokenType::Operator);
+    singleTokens->emplace(E_HANDSHAKE, TokenType::Operator);
+    singleTokens->emplace(E_HEAVY_LARGE_CIRCLE, TokenType::Operator);
+    singleTokens->emplace(E_ANGER_SYMBOL, TokenType::Operator);
+    singleTokens->emplace(E_CROSS_MARK, TokenType::Operator);
+    singleTokens->emplace(E_LEFT_POINTING_BACKHAND_INDEX, TokenType::Operator);
+    singleTokens->emplace(E_RIGHT_POINTING_BACKHAND_INDEX, TokenType::Operator);
+    singleTokens->emplace(E_PUT_LITTER_IN_ITS_SPACE, TokenType::Operator);
+    singleTokens->emplace(E_HANDS_RAISED_IN_CELEBRATION, TokenType::Operator);
+    singleTokens->emplace(E_FACE_WITH_STUCK_OUT_TONGUE_AND_WINKING_EYE, TokenType::Operator);
+    singleTokens->emplace(E_RED_EXCLAMATION_MARK_AND_QUESTION_MARK, TokenType::Call);
 }
 
 void Lexer::skipWhitespace() {
@@ -11,7 +11,7 @@
 
 #include "Token.hpp"
 #include "SourceManager.hpp"
-#include <map>
+#include <unordered_map>
 #include <string>
 
 namespace EmojicodeCompiler {
@@ -55,7 +55,10 @@ private:
         bool commentDetermined_ = false;
     };
 
-    void loadOperatorSingleTokens();
+    /// Returns the table mapping characters that form a token on their own to the type of the token. The table is
+    /// created once and shared by all lexers.
+    static const std::unordered_map<char32_t, TokenType>& singleTokenTable();
+    static void loadOperatorSingleTokens(std::unordered_map<char32_t, TokenType> *singleTokens);
 
     /// Checks for a whitespace character and updates ::sourcePosition_.
     /// @returns True if @c is whitespace according to isWhitespace().
@@ -109,7 +112,7 @@ private:
     bool continue_ = true;
     SourceFile *source_;
     size_t i_ = 0;
-    std::map<char32_t, TokenType> singleTokens_;
+    const std::unordered_map<char32_t, TokenType> &singleTokens_;
 
     const bool minimalMode_;
 
@@ -5,29 +5,104 @@
 #include "CompilerError.hpp"
 #include "SourceManager.hpp"
 #include "SourcePosition.hpp"
+#include <llvm/Support/MemoryBuffer.h>
 #include <algorithm>
-#include <codecvt>
-#include <fstream>
-#include <locale>
+#include <cstring>
 
 namespace EmojicodeCompiler {
 
+bool decodeUtf8(const char *bytes, size_t size, std::u32string *string) {
+    // Every byte decodes to at most one code point.
+    string->resize(size);
+    auto data = reinterpret_cast<const unsigned char *>(bytes);
+    auto out = &(*string)[0];
+    size_t i = 0;
+    while (i < size) {
+        // Source code consists mostly of ASCII, which is widened eight bytes at a time.
+        if (i + 8 <= size) {
+            uint64_t word;
+            std::memcpy(&word, data + i, sizeof(word));
+            if ((word & 0x8080808080808080) == 0) {
+                for (size_t j = 0; j < 8; j++) {
+                    *out++ = data[i + j];
+                }
+                i += 8;
+                continue;
+            }
+        }
+
+        auto lead = data[i];
+        if (lead < 0x80) {
+            *out++ = lead;
+            i++;
+            continue;
+        }
+
+        size_t length;
+        char32_t codePoint, minimum;
+        if ((lead & 0xE0) == 0xC0) {
+            length = 2;
+            codePoint = lead & 0x1F;
+            minimum = 0x80;
+        }
+        else if ((lead & 0xF0) == 0xE0) {
+            length = 3;
+            codePoint = lead & 0x0F;
+            minimum = 0x800;
+        }
+        else if ((lead & 0xF8) == 0xF0) {
+            length = 4;
+            codePoint = lead & 0x07;
+            minimum = 0x10000;
+        }
+        else {
+            return false;
+        }
+        if (i + length > size) {
+            return false;
+        }
+        for (size_t j = 1; j < length; j++) {
+            auto continuation = data[i + j];
+            if ((continuation & 0xC0) != 0x80) {
+                return false;
+            }
+            codePoint = (codePoint << 6) | (continuation & 0x3F);
+        }
+        if (codePoint < minimum || codePoint > 0x10FFFF || (0xD800 <= codePoint && codePoint <= 0xDFFF)) {
+            return false;
+        }
+        *out++ = codePoint;
+        i += length;
+    }
+    string->resize(out - string->data());
+    return true;
+}
+
 SourceFile* SourceManager::read(std::string file) {
-    auto find = cache_.find(file);
-    if (find != cache_.end() && !find->second->wasCleared()) {
-        return find->second.get();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto find = cache_.find(file);
+        if (find != cache_.end() && !find->second->wasCleared()) {
+            return find->second.get();
+        }
     }
 
-    std::ifstream f(file, std::ios_base::binary | std::ios_base::in);
-    if (f.fail()) {
+    // The buffer maps the file if it is large enough and is released as soon as the content was decoded.
+    auto buffer = llvm::MemoryBuffer::getFile(file);
+    if (!buffer) {
         throw CompilerError(SourcePosition(), "Couldn't read input file ", file, ".");
     }
+    std::u32string content;
+    if (!decodeUtf8((*buffer)->getBufferStart(), (*buffer)->getBufferSize(), &content)) {
+        throw CompilerError(SourcePosition(), "Input file ", file, " is not valid UTF-8.");
+    }
 
-    auto string = std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
-    std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> conv;
-    auto content = conv.from_bytes(string);
-
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto find = cache_.find(file);
     if (find != cache_.end()) {
+        if (!find->second->wasCleared()) {
+            return find->second.get();
+        }
         find->second->setContent(std::move(content));
         return find->second.get();
     }
@@ -38,14 +113,58 @@ SourceFile* SourceManager::read(std::string file) {
     return ptr;
 }
 
+SourceFile* SourceManager::file(std::string file) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &cache = cache_[file];
+    if (cache == nullptr) {
+        cache = std::make_unique<SourceFile>(std::u32string(), file);
+    }
+    return cache.get();
+}
+
+std::vector<std::string> SourceManager::paths() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> paths;
+    paths.reserve(cache_.size());
+    for (auto &pair : cache_) {
+        paths.emplace_back(pair.first);
+    }
+    return paths;
+}
+
+namespace {
+
+bool precedes(const SourcePosition &a, const SourcePosition &b) {
+    return std::make_pair(a.line, a.character) < std::make_pair(b.line, b.character);
+}
+
+bool commentPrecedes(const Token &comment, const SourcePosition &p) {
+    return precedes(comment.position(), p);
+}
+
+bool precedesComment(const SourcePosition &p, const Token &comment) {
+    return precedes(p, comment.position());
+}
+
+}  // namespace
+
+void SourceFile::addComment(Token &&token) {
+    if (comments_.empty() || precedes(comments_.back().position(), token.position())) {
+        comments_.emplace_back(std::move(token));
+        return;
+    }
+    auto it = std::lower_bound(comments_.begin(), comments_.end(), token.position(), commentPrecedes);
+    if (precedes(token.position(), it->position())) {
+        comments_.emplace(it, std::move(token));
+    }
+}
+
 void SourceFile::findComments(const SourcePosition &a, const SourcePosition &b,
                               const std::function<void (const Token &)> &comment) const {
-    auto end = comments_.upper_bound(std::make_pair(b.line, b.character));
-    auto it = comments_.lower_bound(std::make_pair(a.line, a.character));
-    if (it != comments_.end()) {
-        for (; it != end; it++) {
-            comment(it->second);
-        }
+    auto it = std::lower_bound(comments_.begin(), comments_.end(), a, commentPrecedes);
+    auto end = std::upper_bound(it, comments_.end(), b, precedesComment);
+    for (; it < end; it++) {
+        comment(*it);
     }
 }
 
@@ -10,6 +10,7 @@
 #include <utility>
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <functional>
 #include "Token.hpp"
 
@@ -17,6 +18,10 @@ namespace EmojicodeCompiler {
 
 struct SourcePosition;
 
+/// Decodes the UTF-8 encoded `bytes` into `string`.
+/// @returns False if `bytes` is not valid UTF-8, in which case the content of `string` is unspecified.
+bool decodeUtf8(const char *bytes, size_t size, std::u32string *string);
+
 class SourceFile {
 public:
     explicit SourceFile(std::u32string file, std::string path) : content_(std::move(file)), path_(std::move(path)) {}
@@ -26,10 +31,11 @@ public:
     void endLine(size_t end) { lines_.emplace_back(end); }
     const std::vector<size_t>& lines() const { return lines_; }
 
-    void addComment(Token &&token) {
-        comments_.emplace(std::make_pair(token.position().line, token.position().character), token);
-    }
+    /// Adds a comment. Comments are usually added in the order in which they appear in the file, which costs constant
+    /// time. A comment at the position of a comment that was already added is ignored.
+    void addComment(Token &&token);
 
+    /// Calls `comment` with each comment between `a` and `b` inclusively in the order of their appearance.
     void findComments(const SourcePosition &a, const SourcePosition &b,
                       const std::function<void (const Token &)> &comment) const;
 
@@ -46,18 +52,28 @@ private:
     std::u32string content_;
     const std::string path_;
     std::vector<size_t> lines_ = {0};
-    std::map<std::pair<size_t, size_t>, Token> comments_;
+    /// The comments in this file sorted by their position.
+    std::vector<Token> comments_;
 };
 
 /// The SourceManager is responsible for reading source files. It caches their content and can provide lines from
 /// source files.
 class SourceManager {
 public:
-    /// Reads the file at the provided path.
+    /// Reads the file at the provided path. Can be called from any thread.
     /// @param file Path to the source file.
     SourceFile* read(std::string file);
 
+    /// Returns the file at the provided path without reading it if it was not read before, in which case its content
+    /// is empty. Can be called from any thread.
+    SourceFile* file(std::string file);
+
+    /// Returns the paths of all files that were read or requested with file().
+    std::vector<std::string> paths() const;
+
 private:
+    /// Guards `cache_`. Files are read and decoded without holding the lock.
+    mutable std::mutex mutex_;
     std::map<std::string, std::unique_ptr<SourceFile>> cache_;
 };
 
@@ -68,6 +68,7 @@ const char* Token::stringNameForType(TokenType type) {
         case TokenType::EndInterpolation: return "EndInterpolation";
         case TokenType::SelectionOperator: return "SelectionOperator";
         case TokenType::CollectionLiteral: return "CollectionLiteral";
+        case TokenType::Match: return "Match";
     }
 }
 
@@ -73,12 +73,16 @@ enum class TokenType {
     Protocol,
     SelectionOperator,
     CollectionLiteral,
+    Match,
 };
 
 class Token {
     friend Lexer;
 public:
     explicit Token(SourcePosition p) : position_(std::move(p)) {}
+    /// Constructs a token that was lexed before, e.g. a token read from a token cache.
+    Token(SourcePosition p, TokenType type, std::u32string value)
+        : position_(std::move(p)), type_(type), value_(std::move(value)) {}
 
     /** Returns the position at which this token was defined. */
     const SourcePosition& position() const { return position_; }
@@ -0,0 +1,158 @@
+//
+// Created by Theo Weidmann on 14.10.26.
+//
+
+#include "TokenCache.hpp"
+#include "CompilerError.hpp"
+#include "Lexer.hpp"
+#include "SourceManager.hpp"
+#include <llvm/Support/MemoryBuffer.h>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+namespace EmojicodeCompiler {
+
+namespace {
+
+/// Increment when the layout of the cache or the token types change.
+const uint32_t kTokenCacheVersion = 2;
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceSize;
+    uint64_t sourceHash;
+    uint32_t tokenCount;
+    uint32_t stringCount;
+};
+
+/// The tokens follow the header. The strings, each a length followed by as many UTF-32 code units, follow the
+/// tokens.
+struct CachedToken {
+    uint32_t type;
+    uint32_t value;
+    uint32_t line;
+    uint32_t character;
+};
+
+/// FNV-1a
+uint64_t hash(llvm::StringRef bytes) {
+    uint64_t hash = 0xcbf29ce484222325;
+    for (auto byte : bytes) {
+        hash = (hash ^ static_cast<uint8_t>(byte)) * 0x100000001b3;
+    }
+    return hash;
+}
+
+bool isCached(TokenType type) {
+    return type != TokenType::BlankLine && type != TokenType::LineBreak && type != TokenType::SinglelineComment &&
+           type != TokenType::MultilineComment;
+}
+
+}  // namespace
+
+std::string tokenCachePath(const std::string &path) {
+    return path + ".tokens";
+}
+
+void writeTokenCache(const std::string &path) {
+    auto buffer = llvm::MemoryBuffer::getFile(path);
+    if (!buffer) {
+        throw CompilerError(SourcePosition(), "Couldn't read input file ", path, ".");
+    }
+    auto bytes = (*buffer)->getBuffer();
+
+    std::u32string content;
+    if (!decodeUtf8(bytes.data(), bytes.size(), &content)) {
+        throw CompilerError(SourcePosition(), "Input file ", path, " is not valid UTF-8.");
+    }
+    SourceFile file(std::move(content), path);
+    Lexer lexer(&file, true);
+
+    std::vector<CachedToken> tokens;
+    std::vector<std::u32string> strings;
+    std::map<std::u32string, uint32_t> stringIndices;
+    while (lexer.continues()) {
+        auto token = lexer.lex();
+        if (!isCached(token.type())) {
+            continue;
+        }
+        auto it = stringIndices.emplace(token.value(), strings.size());
+        if (it.second) {
+            strings.emplace_back(token.value());
+        }
+        tokens.push_back(CachedToken{ static_cast<uint32_t>(token.type()), it.first->second,
+                                      token.position().line, token.position().character });
+    }
+
+    Header header{ { 'E', 'J', 'T', 'C' }, kTokenCacheVersion, bytes.size(), hash(bytes),
+                   static_cast<uint32_t>(tokens.size()), static_cast<uint32_t>(strings.size()) };
+    std::ofstream out(tokenCachePath(path), std::ios_base::binary | std::ios_base::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(tokens.data()), tokens.size() * sizeof(CachedToken));
+    for (auto &string : strings) {
+        auto length = static_cast<uint32_t>(string.size());
+        out.write(reinterpret_cast<const char *>(&length), sizeof(length));
+        out.write(reinterpret_cast<const char *>(string.data()), string.size() * sizeof(char32_t));
+    }
+}
+
+bool readTokenCache(const std::string &path, SourceFile *file, std::vector<Token> *tokens) {
+    auto source = llvm::MemoryBuffer::getFile(path);
+    auto cache = llvm::MemoryBuffer::getFile(tokenCachePath(path));
+    if (!source || !cache) {
+        return false;
+    }
+
+    auto data = (*cache)->getBufferStart();
+    auto end = (*cache)->getBufferEnd();
+    Header header;
+    if (static_cast<size_t>(end - data) < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    auto bytes = (*source)->getBuffer();
+    if (std::memcmp(header.magic, "EJTC", 4) != 0 || header.version != kTokenCacheVersion ||
+        header.sourceSize != bytes.size() || header.sourceHash != hash(bytes)) {
+        return false;
+    }
+
+    auto cachedTokens = data + sizeof(header);
+    auto position = cachedTokens + static_cast<size_t>(header.tokenCount) * sizeof(CachedToken);
+    if (position > end) {
+        return false;
+    }
+    std::vector<std::u32string> strings;
+    strings.reserve(header.stringCount);
+    for (uint32_t i = 0; i < header.stringCount; i++) {
+        uint32_t length;
+        if (static_cast<size_t>(end - position) < sizeof(length)) {
+            return false;
+        }
+        std::memcpy(&length, position, sizeof(length));
+        position += sizeof(length);
+        if (static_cast<size_t>(end - position) / sizeof(char32_t) < length) {
+            return false;
+        }
+        std::u32string string(length, 0);
+        std::memcpy(&string[0], position, length * sizeof(char32_t));
+        strings.emplace_back(std::move(string));
+        position += length * sizeof(char32_t);
+    }
+
+    tokens->reserve(header.tokenCount);
+    for (uint32_t i = 0; i < header.tokenCount; i++) {
+        CachedToken cached;
+        std::memcpy(&cached, cachedTokens + i * sizeof(CachedToken), sizeof(cached));
+        if (cached.value >= strings.size()) {
+            tokens->clear();
+            return false;
+        }
+        tokens->emplace_back(SourcePosition(cached.line, cached.character, file),
+                             static_cast<TokenType>(cached.type), strings[cached.value]);
+    }
+    return true;
+}
+
+}  // namespace EmojicodeCompiler
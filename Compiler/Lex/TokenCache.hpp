@@ -0,0 +1,35 @@
+//
+// Created by Theo Weidmann on 14.10.26.
+//
+
+#ifndef EMOJICODE_TOKENCACHE_HPP
+#define EMOJICODE_TOKENCACHE_HPP
+
+#include "Token.hpp"
+#include <string>
+#include <vector>
+
+namespace EmojicodeCompiler {
+
+class SourceFile;
+
+/// Returns the path of the token cache of the file at `path`.
+///
+/// A token cache stores the tokens of an interface file in a binary format, so that packages that import the
+/// interface neither have to decode nor to lex it. It is identified by the size and a hash of the interface file and
+/// is ignored once the interface file changes.
+std::string tokenCachePath(const std::string &path);
+
+/// Lexes the interface file at `path` and writes its tokens to its token cache.
+/// @throws CompilerError if the file cannot be lexed.
+void writeTokenCache(const std::string &path);
+
+/// Reads the tokens of the interface file at `path` from its token cache if the cache was written for the current
+/// contents of the file.
+/// @param file The file into which the positions of the tokens shall point.
+/// @returns True if the cache is valid and `tokens` was filled with the tokens of the file.
+bool readTokenCache(const std::string &path, SourceFile *file, std::vector<Token> *tokens);
+
+}  // namespace EmojicodeCompiler
+
+#endif //EMOJICODE_TOKENCACHE_HPP
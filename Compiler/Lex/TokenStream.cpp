@@ -13,14 +13,14 @@ namespace EmojicodeCompiler {
 
 Token TokenStream::consumeToken() {
     if (!hasMoreTokens()) {
-        throw CompilerError(lexer_.position(), "Unexpected end of program.");
+        throw CompilerError(position(), "Unexpected end of program.");
     }
     return advanceLexer();
 }
 
 Token TokenStream::consumeToken(TokenType type) {
     if (!hasMoreTokens()) {
-        throw CompilerError(lexer_.position(), "Unexpected end of program.");
+        throw CompilerError(position(), "Unexpected end of program.");
     }
     if (nextToken().type() != type) {
         throw CompilerError(nextToken().position(), "Expected ", Token::stringNameForType(type),
@@ -48,10 +48,19 @@ bool TokenStream::consumeTokenIf(TokenType type) {
 Token TokenStream::advanceLexer() {
     skippedBlankLine_ = false;
     auto temp = std::move(nextToken_);
+    if (lexer_ == nullptr) {
+        if (nextCachedToken_ < tokens_.size()) {
+            nextToken_ = std::move(tokens_[nextCachedToken_++]);
+        }
+        else {
+            moreTokens_ = false;
+        }
+        return temp;
+    }
     while (true) {
-        if (lexer_.continues()) {
-            index_ = lexer_.index();
-            nextToken_ = lexer_.lex();
+        if (lexer_->continues()) {
+            index_ = lexer_->index();
+            nextToken_ = lexer_->lex();
             if (nextToken_.type() == TokenType::BlankLine) {
                 skippedBlankLine_ = true;
                 continue;
@@ -10,6 +10,8 @@
 #define TokenStream_hpp
 
 #include "Lexer.hpp"
+#include <memory>
+#include <vector>
 
 namespace EmojicodeCompiler {
 
@@ -17,7 +19,11 @@ namespace EmojicodeCompiler {
 /// TokenStream skips comments and line breaks and provides handling for blank lines.
 class TokenStream {
 public:
-    explicit TokenStream(Lexer lexer) : lexer_(std::move(lexer)) { advanceLexer(); }
+    explicit TokenStream(Lexer lexer) : lexer_(std::make_unique<Lexer>(std::move(lexer))) { advanceLexer(); }
+    /// Constructs a stream that provides tokens that were lexed before. (See readTokenCache().)
+    /// @param end The position reported if the end of the stream is reached unexpectedly.
+    TokenStream(std::vector<Token> tokens, SourcePosition end)
+        : tokens_(std::move(tokens)), end_(std::move(end)) { advanceLexer(); }
     TokenStream(const TokenStream&) = delete;
     TokenStream(TokenStream&&) = default;
     TokenStream& operator=(const TokenStream&) = delete;
@@ -67,14 +73,20 @@ public:
     /// Whether a blank line is between the last consumed token and nextToken().
     bool skipsBlankLine() const { return skippedBlankLine_; }
 
+    /// The index of nextToken() in the source file. Always 0 if the stream provides tokens that were lexed before.
     size_t index() const { return index_; }
 
 private:
     Token advanceLexer();
+    const SourcePosition& position() const { return lexer_ ? lexer_->position() : end_; }
 
     bool moreTokens_ = true;
     bool skippedBlankLine_ = false;
-    Lexer lexer_;
+    /// The lexer providing the tokens or nullptr if the stream provides `tokens_`.
+    std::unique_ptr<Lexer> lexer_;
+    std::vector<Token> tokens_;
+    size_t nextCachedToken_ = 0;
+    SourcePosition end_;
     Token nextToken_ = Token(SourcePosition());
     size_t index_ = 0;
 };
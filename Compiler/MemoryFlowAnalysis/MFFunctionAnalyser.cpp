@@ -107,20 +107,33 @@ void MFFunctionAnalyser::popScope(ASTBlock *block) {
             }
         }
         var.inits.clear();
+        // Variable IDs are reused by subsequent scopes.
+        var.declarationDepth = -1;
+        var.move = nullptr;
+        var.isBorrowed = false;
     }
 }
 
 bool MFFunctionAnalyser::shouldReleaseVariable(const MFLocalVariable &var) const {
-    return !var.isParam && !var.isReturned && var.type.isManaged();
+    return !var.isParam && !var.isReturned && !var.isBorrowed && var.type.isManaged();
 }
 
-void MFFunctionAnalyser::releaseVariables(ASTBlock *block) const {
+bool MFFunctionAnalyser::canMoveVariable(const MFLocalVariable &var) const {
+    return shouldReleaseVariable(var) && var.declarationDepth == blockDepth_;
+}
+
+void MFFunctionAnalyser::releaseVariables(ASTBlock *block) {
     // If this block does not return certainly, we can simply release its local variables at the end of the block.
     if (!block->returnedCertainly()) {
         for (size_t i = 0; i < block->scopeStats().variables; i++) {
             VariableID variableId = i + block->scopeStats().from;
             auto &var = scope_.getVariable(variableId);
-            if (shouldReleaseVariable(var)) {
+            if (var.move != nullptr) {
+                // The value was moved out at its last use, which is now responsible for releasing it.
+                var.move->setMoved();
+                var.move = nullptr;
+            }
+            else if (shouldReleaseVariable(var)) {
                 block->appendNode(std::make_unique<ASTRelease>(false, variableId, var.type, block->position()));
             }
         }
@@ -133,24 +146,35 @@ void MFFunctionAnalyser::releaseVariables(ASTBlock *block) const {
 }
 
 void MFFunctionAnalyser::releaseAllVariables(Releasing *releasing, const SemanticScopeStats &stats,
-                                             const SourcePosition &p) const {
+                                             const SourcePosition &p) {
     for (size_t i = 0; i < stats.allVariablesCount; i++) {
         VariableID variableId = i;
         auto &var = scope_.getVariable(variableId);
+        var.move = nullptr;
         if (shouldReleaseVariable(var)) {
             releasing->addRelease(std::make_unique<ASTRelease>(false, variableId, var.type, p));
         }
     }
 }
 
-void MFFunctionAnalyser::recordVariableGet(size_t id, MFFlowCategory category) {
+void MFFunctionAnalyser::recordVariableGet(size_t id, MFFlowCategory category, ASTGetVariable *get) {
+    auto &var = scope_.getVariable(id);
+    if (recordedVariables_ != nullptr) {
+        recordedVariables_->insert(id);
+    }
+    // Any use of the variable means that an earlier use was not the last one.
+    var.move = nullptr;
+    if (var.isBorrowed) {
+        recordVariableGet(var.owner, category);
+    }
+    if (get != nullptr && category.isEscaping() && !category.isReturn() && canMoveVariable(var)) {
+        var.move = get;
+    }
     if (category.isReturn()) {
-        auto &var = scope_.getVariable(id);
         if (var.isParam) return;
         var.isReturned = true;
     }
     if (category.isEscaping()) {
-        auto &var = scope_.getVariable(id);
         auto type = var.type.unoptionalized();
         if (type.is<TypeType::ValueType>() || type.is<TypeType::Enum>()) {
             return;
@@ -172,6 +196,9 @@ void MFFunctionAnalyser::recordThis(MFFlowCategory category) {
 void MFFunctionAnalyser::recordVariableSet(size_t id, ASTExpr *expr, Type type) {
     auto &var = scope_.getVariable(id);
     var.type = std::move(type);
+    if (var.declarationDepth < 0) {
+        var.declarationDepth = blockDepth_;
+    }
     if (expr != nullptr) {
         expr->analyseMemoryFlow(this, MFFlowCategory::Escaping);
         auto heapAllocates = dynamic_cast<MFHeapAllocates *>(expr);
@@ -179,6 +206,19 @@ void MFFunctionAnalyser::recordVariableSet(size_t id, ASTExpr *expr, Type type)
             var.inits.emplace_back(heapAllocates);
         }
     }
+    // The old value is released when the variable is overwritten, so it must not have been moved out.
+    var.move = nullptr;
+}
+
+void MFFunctionAnalyser::recordVariableBorrow(size_t id, size_t owner, Type type) {
+    auto &var = scope_.getVariable(id);
+    var.type = std::move(type);
+    if (var.declarationDepth < 0) {
+        var.declarationDepth = blockDepth_;
+    }
+    var.isBorrowed = true;
+    var.owner = owner;
+    var.move = nullptr;
 }
 
 }  // namespace EmojicodeCompiler
@@ -12,6 +12,7 @@
 #include "MFFlowCategory.hpp"
 #include "Scoping/IDScoper.hpp"
 #include "Types/Type.hpp"
+#include <set>
 #include <utility>
 #include <vector>
 
@@ -19,6 +20,7 @@ namespace EmojicodeCompiler {
 
 class ASTExpr;
 class ASTArguments;
+class ASTGetVariable;
 class ASTBlock;
 class Function;
 class Releasing;
@@ -70,7 +72,10 @@ public:
     /// Records the flow category of a use of the context.
     void recordThis(MFFlowCategory category);
     /// Records the flow category of the use of a variable value.
-    void recordVariableGet(size_t id, MFFlowCategory category);
+    /// @param get The node that retrieves the variable value if it takes the value, i.e. the value is not temporary.
+    ///            If this is the last use of a local variable in the block that declared it, the value is moved
+    ///            out of the variable instead of being retained.
+    void recordVariableGet(size_t id, MFFlowCategory category, ASTGetVariable *get = nullptr);
     /// Records an expression whose resulting value was assigned to a variable.
     /// If the compiler can prove that the variable value is never used in an Escaping manner it will inform the
     /// expression that it can allocate on the heap if it inherits from MFHeapAllocates.
@@ -79,6 +84,10 @@ public:
     ///             This value can be `nullptr` in special circumstances.
     /// @param type The type of the variable.
     void recordVariableSet(size_t id, ASTExpr *expr, Type type);
+    /// Records that the variable *id* was set to the value of the constant local variable *owner*, which outlives
+    /// it. The variable borrows the value: It is neither retained for nor released by the variable and every use of
+    /// the variable is recorded as a use of *owner*.
+    void recordVariableBorrow(size_t id, size_t owner, Type type);
 
     /// Analyses a function call.
     /// Analyses the callee and arguments with the appropriate flow category. If the specified function was not
@@ -92,7 +101,12 @@ public:
 
     /// Adds release statments to `releasing` for all variables in the function’s scope (as described by the provided
     /// scope stats) that must be released.
-    void releaseAllVariables(Releasing *releasing, const SemanticScopeStats &stats, const SourcePosition &p) const;
+    /// Variables whose value was about to be moved are released normally instead.
+    void releaseAllVariables(Releasing *releasing, const SemanticScopeStats &stats, const SourcePosition &p);
+
+    /// Makes the analyser insert the ID of every variable whose value is used into *variables* until this method is
+    /// called with `nullptr`.
+    void recordVariablesInto(std::set<size_t> *variables) { recordedVariables_ = variables; }
 
     /// Informs the analyser that a loop has been entered.
     void enterLoop() { inLoop_++; }
@@ -101,26 +115,45 @@ public:
     /// @pre enterLoop() must have been called for the loop.
     void exitLoop() { inLoop_--; }
 
+    /// Informs the analyser that the statements of a block are about to be analysed.
+    void enterBlock() { blockDepth_++; }
+
+    /// Informs the analyser that the statements of a block have been analysed.
+    /// @pre enterBlock() must have been called for the block.
+    void exitBlock() { blockDepth_--; }
+
 private:
     struct MFLocalVariable {
         bool isParam = false;
         bool isReturned = false;
         size_t param;
+        /// Whether the variable borrows the value of the variable `owner`.
+        bool isBorrowed = false;
+        size_t owner;
         MFFlowCategory flowCategory = MFFlowCategory::Borrowing;
         Type type = Type::noReturn();
         std::vector<MFHeapAllocates *> inits;
+        /// The block depth at which the variable was first set, or -1 if it has not been set yet.
+        int declarationDepth = -1;
+        /// The node that retrieved the value of the variable for the last time so far, if the value can be moved
+        /// out of the variable at this point.
+        ASTGetVariable *move = nullptr;
     };
 
     IDScoper<MFLocalVariable> scope_;
     Function *function_;
     bool thisEscapes_ = false;
+    std::set<size_t> *recordedVariables_ = nullptr;
 
     unsigned int inLoop_ = 0;
+    int blockDepth_ = 0;
 
-    void releaseVariables(ASTBlock *block) const;
+    void releaseVariables(ASTBlock *block);
 
     /// Determines whether the contents of the variable should be released at the end of a block.
     bool shouldReleaseVariable(const MFLocalVariable &var) const;
+    /// Determines whether the value of the variable can be moved out of it instead of being retained.
+    bool canMoveVariable(const MFLocalVariable &var) const;
 
     void analyseIfNecessary(Function *function) const;
     void checkMFPromises() const;
@@ -11,6 +11,7 @@
 #include "CompilerError.hpp"
 #include "Lex/Lexer.hpp"
 #include "Lex/SourceManager.hpp"
+#include "Lex/TokenCache.hpp"
 #include "Package.hpp"
 #include "Parsing/DocumentParser.hpp"
 #include "Types/Class.hpp"
@@ -76,6 +77,15 @@ std::pair<SourceFile*, TokenStream> Package::lexFile(const std::string &path) {
         throw CompilerError(SourcePosition(), "Emojicode files must have a filename: ", path);
     }
 
+    if (isImported() && (endsWith(path, "🏛") || endsWith(path, ".emojii"))) {
+        auto file = compiler()->sourceManager().file(path);
+        std::vector<Token> tokens;
+        if (readTokenCache(path, file, &tokens)) {
+            auto end = tokens.empty() ? SourcePosition(1, 0, file) : tokens.back().position();
+            return std::make_pair(file, TokenStream(std::move(tokens), end));
+        }
+    }
+
     auto file = compiler()->sourceManager().read(path);
     return std::make_pair(file, TokenStream(Lexer(file, isImported())));
 }
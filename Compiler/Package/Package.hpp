@@ -10,7 +10,7 @@
 #define Package_hpp
 
 #include "Types/Type.hpp"
-#include <map>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include <memory>
@@ -136,7 +136,7 @@ private:
     Function *startFlag_ = nullptr;
     bool imported_;
 
-    std::map<std::u32string, Type> types_;
+    std::unordered_map<std::u32string, Type> types_;
     std::vector<ExportedType> exportedTypes_;
     std::vector<std::unique_ptr<Class>> classes_;
     std::vector<std::unique_ptr<ValueType>> valueTypes_;
@@ -0,0 +1,166 @@
+//
+// Created by Theo Weidmann on 14.10.26.
+//
+
+#include "PackagePrefetcher.hpp"
+#include "Compiler.hpp"
+#include "CompilerError.hpp"
+#include "Emojis.h"
+#include "Lex/SourceManager.hpp"
+#include "Lex/SourcePosition.hpp"
+#include <thread>
+#include <vector>
+
+namespace EmojicodeCompiler {
+
+namespace {
+
+bool isWhitespace(char32_t c) {
+    return (0x9 <= c && c <= 0xD) || c == 0x20 || c == 0xFE0F;
+}
+
+/// Returns the index after the token that begins with the delimiter at `i` and ends with the next occurrence of
+/// `end`, skipping characters escaped with ❌ if `escapes` is true.
+size_t skipDelimited(const std::u32string &content, size_t i, char32_t end, bool escapes) {
+    for (i++; i < content.size(); i++) {
+        if (escapes && content[i] == E_CROSS_MARK) {
+            i++;
+        }
+        else if (content[i] == end) {
+            return i + 1;
+        }
+    }
+    return i;
+}
+
+/// Skips a single line comment or a multi line comment beginning at `i`.
+size_t skipComment(const std::u32string &content, size_t i) {
+    if (i + 1 < content.size() && content[i + 1] == E_SOON_ARROW) {
+        for (i += 2; i + 1 < content.size(); i++) {
+            if (content[i] == E_END_ARROW && content[i + 1] == E_THOUGHT_BALLOON) {
+                return i + 2;
+            }
+        }
+        return content.size();
+    }
+    return skipDelimited(content, i, '\n', false);
+}
+
+size_t skipWhitespace(const std::u32string &content, size_t i) {
+    while (i < content.size() && isWhitespace(content[i])) {
+        i++;
+    }
+    return i;
+}
+
+}  // namespace
+
+void PackagePrefetcher::prefetch(const std::string &mainFile, const std::string &packageName) {
+    if (packageName != "s") {
+        enqueuePackage("s");
+    }
+    enqueueFile(mainFile);
+    size_t busy = 0;
+
+    auto work = [&] {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            condition_.wait(lock, [&] { return !queue_.empty() || busy == 0; });
+            if (queue_.empty()) {
+                condition_.notify_all();
+                return;
+            }
+            auto path = std::move(queue_.front());
+            queue_.pop();
+            busy++;
+            lock.unlock();
+            read(path);
+            lock.lock();
+            busy--;
+            condition_.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < jobs_; i++) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+void PackagePrefetcher::enqueueFile(const std::string &path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (files_.emplace(path).second) {
+        queue_.emplace(path);
+        condition_.notify_one();
+    }
+}
+
+void PackagePrefetcher::enqueuePackage(const std::string &name) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!packages_.emplace(name).second) {
+            return;
+        }
+    }
+    try {
+        auto path = compiler_->searchPackage(name, SourcePosition());
+        enqueueFile(compiler_->interfacePath(path, name, SourcePosition()));
+    }
+    catch (CompilerError &ce) {}
+}
+
+void PackagePrefetcher::read(const std::string &path) {
+    SourceFile *file;
+    try {
+        file = compiler_->sourceManager().read(path);
+    }
+    catch (std::exception &e) {
+        return;
+    }
+
+    auto directory = path.substr(0, path.find_last_of('/') + 1);
+    auto &content = file->file();
+    for (size_t i = 0; i < content.size();) {
+        switch (content[i]) {
+            case E_INPUT_SYMBOL_LATIN_LETTERS:
+                i = skipDelimited(content, i, E_INPUT_SYMBOL_LATIN_LETTERS, true);
+                break;
+            case E_GREEN_TEXTBOOK:
+            case E_BLUE_TEXTBOOK:
+                i = skipDelimited(content, i, content[i], false);
+                break;
+            case E_THOUGHT_BALLOON:
+                i = skipComment(content, i);
+                break;
+            case E_PACKAGE: {
+                auto begin = skipWhitespace(content, i + 1);
+                auto end = begin;
+                while (end < content.size() && !isWhitespace(content[end])) {
+                    end++;
+                }
+                enqueuePackage(utf8(content.substr(begin, end - begin)));
+                i = end;
+                break;
+            }
+            case E_SCROLL: {
+                auto begin = skipWhitespace(content, i + 1);
+                if (begin < content.size() && content[begin] == E_INPUT_SYMBOL_LATIN_LETTERS) {
+                    i = skipDelimited(content, begin, E_INPUT_SYMBOL_LATIN_LETTERS, true);
+                    enqueueFile(directory + utf8(content.substr(begin + 1, i - begin - 2)));
+                }
+                else {
+                    i = begin;
+                }
+                break;
+            }
+            default:
+                i++;
+        }
+    }
+}
+
+}  // namespace EmojicodeCompiler
@@ -0,0 +1,58 @@
+//
+// Created by Theo Weidmann on 14.10.26.
+//
+
+#ifndef EMOJICODE_PACKAGEPREFETCHER_HPP
+#define EMOJICODE_PACKAGEPREFETCHER_HPP
+
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <string>
+
+namespace EmojicodeCompiler {
+
+class Compiler;
+
+/// Reads the source files of a package, the files they include and the interfaces of all packages they import,
+/// directly or indirectly, on several threads and stores them in the SourceManager of the Compiler.
+///
+/// Parsing must remain serial because imports offer types to the importing package in the order in which they
+/// appear. The PackagePrefetcher therefore only discovers the import graph by scanning the files for 📦 and 📜
+/// without lexing them, so that the parser later finds every file already read and decoded.
+class PackagePrefetcher {
+public:
+    /// @param jobs The number of threads on which files are read.
+    PackagePrefetcher(Compiler *compiler, unsigned jobs) : compiler_(compiler), jobs_(jobs) {}
+
+    /// Reads `mainFile`, the main file of the package `packageName`, and all files it requires.
+    /// Errors are not reported, as the parser reports them when it reads the file again.
+    void prefetch(const std::string &mainFile, const std::string &packageName);
+
+    /// The paths of all files that prefetch() found, including files that could not be read.
+    const std::set<std::string>& files() const { return files_; }
+
+private:
+    Compiler *const compiler_;
+    const unsigned jobs_;
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::queue<std::string> queue_;
+    /// All files that were enqueued.
+    std::set<std::string> files_;
+    /// The names of all packages whose interfaces were enqueued.
+    std::set<std::string> packages_;
+
+    /// Enqueues the file at `path` unless it was enqueued before.
+    void enqueueFile(const std::string &path);
+    /// Enqueues the interface of the package `name` unless the package was enqueued before.
+    void enqueuePackage(const std::string &name);
+    /// Reads the file at `path` and enqueues the files and packages it refers to.
+    void read(const std::string &path);
+};
+
+}  // namespace EmojicodeCompiler
+
+#endif //EMOJICODE_PACKAGEPREFETCHER_HPP
@@ -26,6 +26,8 @@ enum class Attribute : char32_t {
     Deprecated = E_WARNING_SIGN, Final = E_LOCK_WITH_INK_PEN, Override = E_BLACK_NIB, StaticOnType = E_RABBIT,
     Required = E_KEY, Export = E_EARTH_GLOBE_EUROPE_AFRICA, Foreign = E_RADIO, Unsafe = E_BIOHAZARD,
     Mutating = E_CRAYON, Escaping = E_TAKEOUT_BOX, Inline = E_BAGEL, NoGenericDynamism = E_OIL_DRUM,
+    Cold = E_COLD_FACE, Pooled = E_SWIMMER, AlwaysInline = E_PRETZEL, NeverInline = E_CANNED_FOOD, Hot = E_HOT_FACE,
+    Flatten = E_PANCAKES, Pure = E_SOAP,
 };
 
 template <Attribute ...Attributes>
@@ -30,6 +30,9 @@ void DocumentParser::parse() {
                 auto klass = parseClass(documentation.get(), theToken, attributes.has(Attribute::Export),
                                         attributes.has(Attribute::Final), attributes.has(Attribute::Foreign));
                 setGenericTypeDynamism(klass, attributes.has(Attribute::NoGenericDynamism));
+                if (attributes.has(Attribute::Pooled)) {
+                    klass->setPooled();
+                }
                 continue;
             }
             case TokenType::Protocol:
@@ -17,7 +17,7 @@
 namespace EmojicodeCompiler {
 
 using PackageAttributeParser = AttributeParser<Attribute::Export, Attribute::NoGenericDynamism,
-    Attribute::Final, Attribute::Foreign>;
+    Attribute::Final, Attribute::Foreign, Attribute::Pooled>;
 
 /// DocumentParser instances parse the direct output from the lexer for one source code document (one source file).
 /// parse() therefore expects $document-statement$s.
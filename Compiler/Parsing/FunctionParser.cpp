@@ -122,6 +122,8 @@ std::unique_ptr<ASTStatement> FunctionParser::handleStatementToken(const Token &
             return parseVariableDeclaration(token);
         case TokenType::If:
             return parseIf(token.position());
+        case TokenType::Match:
+            return parseMatch(token.position());
         case TokenType::ErrorHandler:
             return parseErrorHandler(token.position());
         case TokenType::RepeatWhile: {
@@ -133,9 +135,18 @@ std::unique_ptr<ASTStatement> FunctionParser::handleStatementToken(const Token &
             return std::make_unique<ASTUnsafeBlock>(parseBlock(), token.position());
         case TokenType::ForIn: {
             auto variableToken = stream_.consumeToken(TokenType::Variable);
+            std::u32string valueVariable;
+            if (stream_.consumeTokenIf(TokenType::RightProductionOperator)) {
+                valueVariable = stream_.consumeToken(TokenType::Variable).value();
+            }
             auto iteratee = parseExpr(0);
             auto block = parseBlock();
-            return std::make_unique<ASTForIn>(iteratee, variableToken.value(), std::move(block), token.position());
+            auto forIn = std::make_unique<ASTForIn>(iteratee, variableToken.value(), std::move(block),
+                                                    token.position());
+            if (!valueVariable.empty()) {
+                forIn->setValueVariable(std::move(valueVariable));
+            }
+            return forIn;
         }
         case TokenType::Error:
             return std::make_unique<ASTRaise>(parseExpr(0), token.position());
@@ -148,8 +159,13 @@ std::unique_ptr<ASTStatement> FunctionParser::handleStatementToken(const Token &
 }
 
 std::unique_ptr<ASTStatement> FunctionParser::parseReturn(const Token &token) {
-    auto value = stream_.consumeTokenIf(TokenType::Return) ? nullptr : parseExpr(0);
-    return std::make_unique<ASTReturn>(value, token.position());
+    auto tailCall = stream_.consumeTokenIf(TokenType::RepeatWhile);
+    auto value = !tailCall && stream_.consumeTokenIf(TokenType::Return) ? nullptr : parseExpr(0);
+    auto ret = std::make_unique<ASTReturn>(value, token.position());
+    if (tailCall) {
+        ret->setRequiresTailCall();
+    }
+    return ret;
 }
 
 std::unique_ptr<ASTStatement> FunctionParser::parseVariableDeclaration(const Token &token) {
@@ -239,6 +255,28 @@ std::unique_ptr<ASTStatement> FunctionParser::parseIf(const SourcePosition &posi
     return node;
 }
 
+std::unique_ptr<ASTStatement> FunctionParser::parseMatch(const SourcePosition &position) {
+    auto node = std::make_unique<ASTMatch>(parseExpr(0), position);
+    stream_.consumeToken(TokenType::BlockBegin);
+    while (stream_.nextTokenIsEverythingBut(TokenType::BlockEnd)) {
+        if (stream_.nextTokenIs(TokenType::Else)) {
+            auto token = stream_.consumeToken();
+            if (node->hasDefault()) {
+                throw CompilerError(token.position(), "🎚 can only have one 🙅 case.");
+            }
+            node->setDefault(parseBlock());
+            continue;
+        }
+        std::vector<std::shared_ptr<ASTExpr>> values;
+        do {
+            values.emplace_back(parseExpr(0));
+        } while (stream_.nextTokenIsEverythingBut(TokenType::BlockBegin));
+        node->addCase(std::move(values), parseBlock());
+    }
+    stream_.consumeToken(TokenType::BlockEnd);
+    return node;
+}
+
 int FunctionParser::peakOperatorPrecedence() {
     if (stream_.nextTokenIs(TokenType::Operator)) {
         return operatorPrecedence(operatorType(stream_.nextToken().value()));
@@ -37,6 +37,7 @@ private:
     std::shared_ptr<ASTExpr> parseClosure(const Token &token);
 
     std::unique_ptr<ASTStatement> parseIf(const SourcePosition &position);
+    std::unique_ptr<ASTStatement> parseMatch(const SourcePosition &position);
     std::unique_ptr<ASTStatement> parseErrorHandler(const SourcePosition &position);
 
     std::shared_ptr<ASTExpr> parseExprTokens(const Token &token, int precendence);
@@ -25,11 +25,13 @@ void TypeBodyParser<TypeDef>::parseFunctionBody(Function *function) {
         if (token.value().empty()) {
             throw CompilerError(token.position(), "The external name must not be empty.");
         }
-        function->setExternalName(utf8(token.value()));
-        return;
+        if (interface_ || !stream_.nextTokenIs(TokenType::BlockBegin)) {
+            function->setExternalName(utf8(token.value()));
+            return;
+        }
+        function->exportAs(utf8(token.value()));
     }
-
-    if (interface_) {
+    else if (interface_) {
         if (!stream_.nextTokenIs(TokenType::BlockBegin)) {
             function->makeExternal();
             return;
@@ -97,7 +99,9 @@ void TypeBodyParser<TypeDef>::doParseMethod(const std::u32string &name, TypeBody
                                  const Documentation &documentation, AccessLevel access, Mood mood,
                                  const SourcePosition &p) {
     attributes.allow(Attribute::Deprecated).allow(Attribute::StaticOnType).allow(Attribute::Unsafe)
-            .allow(Attribute::Escaping).allow(Attribute::Inline).check(p, package_->compiler());
+            .allow(Attribute::Escaping).allow(Attribute::Inline).allow(Attribute::AlwaysInline)
+            .allow(Attribute::NeverInline).allow(Attribute::Flatten).allow(Attribute::Cold).allow(Attribute::Hot)
+            .allow(Attribute::Pure).check(p, package_->compiler());
 
     if (attributes.has(Attribute::StaticOnType)) {
         auto typeMethod = std::make_unique<Function>(name, access, attributes.has(Attribute::Final), typeDef_,
@@ -107,6 +111,7 @@ void TypeBodyParser<TypeDef>::doParseMethod(const std::u32string &name, TypeBody
                                                      std::is_same<TypeDef, Class>::value ?
                                                      FunctionType::ClassMethod : FunctionType::Function,
                                                      attributes.has(Attribute::Inline));
+        applyOptimizationAttributes(typeMethod.get(), attributes, p);
         parseFunction(typeMethod.get(), false, attributes.has(Attribute::Escaping));
         typeDef_->typeMethods().add(std::move(typeMethod));
     }
@@ -118,11 +123,45 @@ void TypeBodyParser<TypeDef>::doParseMethod(const std::u32string &name, TypeBody
                                                  attributes.has(Attribute::Unsafe),
                                                  std::is_same<TypeDef, Class>::value ? FunctionType::ObjectMethod :
                                                  FunctionType::ValueTypeMethod, attributes.has(Attribute::Inline));
+        applyOptimizationAttributes(method.get(), attributes, p);
         parseFunction(method.get(), false, attributes.has(Attribute::Escaping));
         typeDef_->methods().add(std::move(method));
     }
 }
 
+template <typename TypeDef>
+void TypeBodyParser<TypeDef>::applyOptimizationAttributes(Function *function, const TypeBodyAttributeParser &attributes,
+                                                          const SourcePosition &p) {
+    if (attributes.has(Attribute::AlwaysInline) && (attributes.has(Attribute::NeverInline) ||
+                                                    attributes.has(Attribute::Inline))) {
+        package_->compiler()->error(CompilerError(p, "🥨 cannot be combined with 🥯 or 🥫."));
+    }
+    if (attributes.has(Attribute::NeverInline) && attributes.has(Attribute::Inline)) {
+        package_->compiler()->error(CompilerError(p, "🥫 cannot be combined with 🥯."));
+    }
+    if (attributes.has(Attribute::Cold) && attributes.has(Attribute::Hot)) {
+        package_->compiler()->error(CompilerError(p, "🥶 cannot be combined with 🥵."));
+    }
+    if (attributes.has(Attribute::AlwaysInline)) {
+        function->setAlwaysInline();
+    }
+    if (attributes.has(Attribute::NeverInline)) {
+        function->setNeverInline();
+    }
+    if (attributes.has(Attribute::Flatten)) {
+        function->setFlatten();
+    }
+    if (attributes.has(Attribute::Cold)) {
+        function->setCold();
+    }
+    if (attributes.has(Attribute::Hot)) {
+        function->setHot();
+    }
+    if (attributes.has(Attribute::Pure)) {
+        function->setPure();
+    }
+}
+
 template <typename TypeDef>
 void TypeBodyParser<TypeDef>::parseMethod(const std::u32string &name, TypeBodyAttributeParser attributes,
                                           const Documentation &documentation, AccessLevel access, Mood mood,
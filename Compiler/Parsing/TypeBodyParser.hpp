@@ -19,7 +19,8 @@ enum class Mood;
 class Initializer;
 class CompilerError;
 
-using TypeBodyAttributeParser = AttributeParser<Attribute::Inline, Attribute::Deprecated, Attribute::Final,
+using TypeBodyAttributeParser = AttributeParser<Attribute::Inline, Attribute::AlwaysInline, Attribute::NeverInline,
+    Attribute::Flatten, Attribute::Cold, Attribute::Hot, Attribute::Pure, Attribute::Deprecated, Attribute::Final,
     Attribute::Override, Attribute::StaticOnType, Attribute::Unsafe, Attribute::Mutating, Attribute::Required,
     Attribute::Escaping>;
 
@@ -62,6 +63,9 @@ private:
     AccessLevel readAccessLevel();
     void parseFunctionBody(Function *function);
     void parseFunction(Function *function, bool inititalizer, bool escaping);
+    /// Applies the attributes that control inlining and code placement to *function*.
+    void applyOptimizationAttributes(Function *function, const TypeBodyAttributeParser &attributes,
+                                     const SourcePosition &p);
 };
 
 }  // namespace EmojicodeCompiler
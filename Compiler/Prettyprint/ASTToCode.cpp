@@ -82,7 +82,11 @@ void ASTRepeatWhile::toCode(PrettyStream &pretty) const {
 
 void ASTForIn::toCode(PrettyStream &pretty) const {
     pretty.printComments(position());
-    pretty.indent() << "🔂 " << varName_ << " " << iteratee_ << " " << block_;
+    pretty.indent() << "🔂 " << varName_ << " ";
+    if (!valueVarName_.empty()) {
+        pretty << "➡️ " << valueVarName_ << " ";
+    }
+    pretty << iteratee_ << " " << block_;
 }
 
 void ASTUnsafeBlock::toCode(PrettyStream &pretty) const {
@@ -90,6 +94,10 @@ void ASTUnsafeBlock::toCode(PrettyStream &pretty) const {
     pretty.indent() << "☣️ " << block_;
 }
 
+void ASTUnsafeExpr::toCode(PrettyStream &pretty) const {
+    pretty << expr_;
+}
+
 void printBranchSpeed(PrettyStream &pretty, ASTIf::BranchSpeed speed) {
     switch (speed) {
         case ASTIf::BranchSpeed::Fast:
@@ -118,6 +126,25 @@ void ASTIf::toCode(PrettyStream &pretty) const {
     }
 }
 
+void ASTMatch::toCode(PrettyStream &pretty) const {
+    pretty.printComments(position());
+    pretty.indent() << "🎚 " << subject_ << " 🍇";
+    pretty.offerNewLine();
+    pretty.increaseIndent();
+    for (auto &arm : cases_) {
+        pretty.indent();
+        for (auto &value : arm.values) {
+            pretty << value << " ";
+        }
+        pretty << arm.block;
+    }
+    if (hasDefault()) {
+        pretty.indent() << "🙅 " << *default_;
+    }
+    pretty.decreaseIndent();
+    pretty.indent() << "🍉\n";
+}
+
 void ASTClosure::toCode(PrettyStream &pretty) const {
     pretty.printComments(position());
     pretty.printClosure(closure_.get(), isEscaping_);
@@ -280,7 +307,7 @@ void ASTReturn::toCode(PrettyStream &pretty) const {
         pretty.indent() << "↩️↩️";
     }
     else {
-        pretty.indent() << "↩️ " << value_;
+        pretty.indent() << (requiresTailCall_ ? "↩️🔁 " : "↩️ ") << value_;
     }
 }
 
@@ -19,7 +19,11 @@
 #include "Lex/SourceManager.hpp"
 #include "Scoping/Scope.hpp"
 #include <algorithm>
+#include <atomic>
+#include <cstdio>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 namespace EmojicodeCompiler {
 
@@ -29,12 +33,34 @@ void PrettyPrinter::printRecordings(const std::vector<std::unique_ptr<RecordingP
     }
 }
 
-void PrettyPrinter::print() {
-    for (auto &file : package_->files()) {
-        prettyStream_.setOutPath(filePath(file.path_));
+void PrettyPrinter::print(unsigned jobs) {
+    auto &files = package_->files();
+    std::atomic<size_t> next{0};
+    // Every thread needs its own printer as the printer holds the state of the file it prints.
+    auto work = [&] {
+        PrettyPrinter printer(package_);
+        for (size_t i; (i = next++) < files.size();) {
+            printer.printFile(files[i]);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < jobs && i < files.size(); i++) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
 
-        printRecordings(file.recordings_);
+void PrettyPrinter::printFile(const RecordingPackage::File &file) {
+    prettyStream_.setOutPath(file.path_);
+    printRecordings(file.recordings_);
+    if (prettyStream_.changed()) {
+        std::rename(file.path_.c_str(), (file.path_ + "_original").c_str());
     }
+    prettyStream_.finish();
 }
 
 void PrettyPrinter::printInterface(const std::string &out) {
@@ -48,6 +74,7 @@ void PrettyPrinter::printInterface(const std::string &out) {
 
     printRecordings(package_->files().front().recordings_);
     printLinkHints();
+    prettyStream_.finish();
 }
 
 void PrettyPrinter::printLinkHints() {
@@ -88,11 +115,6 @@ void PrettyPrinter::print(RecordingPackage::Recording *recording) {
     }
 }
 
-std::string PrettyPrinter::filePath(const std::string &path) {
-    std::rename(path.c_str(), (path + "_original").c_str());
-    return path;
-}
-
 void PrettyPrinter::printArguments(Function *function) {
     if (auto initializer = dynamic_cast<Initializer *>(function)) {
         auto it = initializer->argumentsToVariables().begin();
@@ -159,6 +181,9 @@ void PrettyPrinter::printTypeDef(const Type &type) {
         if (klass->foreign()) {
             prettyStream_ << "📻 ";
         }
+        if (klass->pooled()) {
+            prettyStream_ << "🏊 ";
+        }
     }
     if (auto valueType = type.valueType()) {
         if (valueType->isPrimitive() && type.type() != TypeType::Enum) {
@@ -276,9 +301,27 @@ void PrettyPrinter::printEnumValues(Enum *enumeration) {
 }
 
 void PrettyPrinter::printFunctionAttributes(Function *function, bool noMutate) {
-    if (function->isInline()) {
+    if (function->alwaysInline()) {
+        prettyStream_ << "🥨 ";
+    }
+    else if (function->isInline()) {
         prettyStream_ << "🥯 ";
     }
+    if (function->neverInline()) {
+        prettyStream_ << "🥫 ";
+    }
+    if (function->flatten()) {
+        prettyStream_ << "🥞 ";
+    }
+    if (function->isCold()) {
+        prettyStream_ << "🥶 ";
+    }
+    if (function->isHot()) {
+        prettyStream_ << "🥵 ";
+    }
+    if (function->isPure()) {
+        prettyStream_ << "🧼 ";
+    }
     if (function->deprecated()) {
         prettyStream_ << "⚠️ ";
     }
@@ -375,6 +418,11 @@ void PrettyPrinter::print(const char *key, Function *function, bool body, bool n
 void PrettyPrinter::printBody(Function *function) {
     if (!function->externalName().empty()) {
         prettyStream_ << " 📻 🔤" << function->externalName() << "🔤";
+        if (!interface_ && !function->isExternal()) {
+            prettyStream_ << " ";
+            prettyStream_.setLastCommentQueryPlace(function->position());
+            function->ast()->toCode(prettyStream_);
+        }
     }
     else {
         if (interface_) {
@@ -24,8 +24,9 @@ public:
     /// @param out The path at which the file will be created. If the file exists it is overwritten.
     void printInterface(const std::string &out);
     /// Regenerates the code for the package. All packge files are regenerated in place, the original files are renamed
-    /// to preserve them as backup.
-    void print();
+    /// to preserve them as backup. Files whose code does not change are left untouched.
+    /// @param jobs The number of threads that format files in parallel.
+    void print(unsigned jobs = 1);
 
 private:
     PrettyStream prettyStream_;
@@ -36,6 +37,7 @@ private:
 
     void printClosure(Function *function, bool esacping);
 
+    void printFile(const RecordingPackage::File &file);
     void printRecordings(const std::vector<std::unique_ptr<RecordingPackage::Recording>> &recordings);
     void print(const char *key, Function *function, bool body, bool noMutate);
     void print(RecordingPackage::Recording *recording);
@@ -67,7 +69,6 @@ private:
     void printDocumentation(const std::u32string &doc);
     void printLinkHints();
     void printErrorType(Function *function);
-    std::string filePath(const std::string &path);
     void printBody(Function *function);
 };
 
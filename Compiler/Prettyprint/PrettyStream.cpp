@@ -11,6 +11,8 @@
 #include "PrettyPrinter.hpp"
 #include "Types/Type.hpp"
 #include "Utils/StringUtils.hpp"
+#include <fstream>
+#include <iterator>
 
 namespace EmojicodeCompiler {
 
@@ -21,24 +23,40 @@ void PrettyStream::printComments(const SourcePosition &p) {
     p.file->findComments(lastCommentQuery_, p, [this, &p](const Token &comment) {
         if (whitespaceOffer_ == '\n') {
             if (comment.position().line >= p.line) {
-                stream_ << whitespaceOffer_;
+                buffer_.push_back(whitespaceOffer_);
                 whitespaceOffer_ = 0;
                 indent();
             }
             else {
-                stream_ << "  ";
+                buffer_.append("  ");
             }
         }
 
         *this << (comment.type() == TokenType::MultilineComment ? "💭🔜" : "💭") << comment.value();
-        if (comment.type() == TokenType::MultilineComment) stream_ << "🔚💭";
+        if (comment.type() == TokenType::MultilineComment) buffer_.append("🔚💭");
         else offerNewLine();
     });
     lastCommentQuery_ = p;
 }
 
 void PrettyStream::setOutPath(const std::string &path) {
-    stream_ = std::fstream(path, std::ios_base::out);
+    path_ = path;
+    original_.clear();
+    std::ifstream file(path, std::ios_base::binary);
+    if (file) {
+        original_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    buffer_.clear();
+    // Formatting rarely changes the length of the code much.
+    buffer_.reserve(original_.size() + original_.size() / 8);
+}
+
+void PrettyStream::finish() {
+    if (!changed()) {
+        return;
+    }
+    std::ofstream file(path_, std::ios_base::binary | std::ios_base::trunc);
+    file.write(buffer_.data(), buffer_.size());
 }
 
 void PrettyStream::printClosure(Function *function, bool escaping) {
@@ -67,10 +85,10 @@ PrettyStream& PrettyStream::operator<<(const Type &type) {
 
 PrettyStream& PrettyStream::operator<<(const std::string &rhs) {
     if (whitespaceOffer_ != 0) {
-        stream_ << whitespaceOffer_;
+        buffer_.push_back(whitespaceOffer_);
         whitespaceOffer_ = 0;
     }
-    stream_ << rhs;
+    buffer_.append(rhs);
     return *this;
 }
 
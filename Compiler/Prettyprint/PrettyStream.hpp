@@ -11,9 +11,9 @@
 
 #include "Lex/SourcePosition.hpp"
 #include "Types/TypeContext.hpp"
-#include <fstream>
 #include <functional>
 #include <memory>
+#include <string>
 
 namespace EmojicodeCompiler {
 
@@ -25,11 +25,19 @@ class PrettyPrinter;
 /// PrettyStream features a concept of "whitespace offers". By a call to offerSpace() or offerNewLine() whitespace
 /// is offered. The whitespace is then appended before the next object passed to << unless refuseOffer() is called
 /// previously.
+///
+/// The code is appended to a buffer in memory, which is only written to the file if it differs from the file's
+/// content.
 class PrettyStream {
 public:
     PrettyStream(PrettyPrinter *prettyPrinter) : prettyPrinter_(prettyPrinter) {}
 
+    /// Starts the code that finish() writes to `path`.
     void setOutPath(const std::string &path);
+    /// Returns true if the code differs from the content of the file at the path passed to setOutPath().
+    bool changed() const { return buffer_ != original_; }
+    /// Writes the code to the path passed to setOutPath() if changed() is true.
+    void finish();
 
     template <typename T>
     PrettyStream& operator<<(const std::unique_ptr<T> &node) {
@@ -74,7 +82,10 @@ public:
     void offerNewLineUnlessEmpty(const T &collection) { if (!collection.empty()) { offerNewLine(); } }
     
 private:
-    std::fstream stream_;
+    std::string path_;
+    std::string buffer_;
+    /// The content of the file at path_ before the code was written to it.
+    std::string original_;
 
     PrettyPrinter *prettyPrinter_;
     TypeContext typeContext_;
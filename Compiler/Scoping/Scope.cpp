@@ -22,12 +22,12 @@ Variable& Scope::declareVariable(const std::u32string &variable, const Type &typ
 
 Variable& Scope::declareVariableWithId(const std::u32string &variable, Type type, bool constant, size_t id,
                                        const SourcePosition &p) {
-    if (hasLocalVariable(variable)) {
+    type.setMutable(!constant);
+    auto pair = map_.emplace(variable, Variable(std::move(type), id, constant, variable, p));
+    if (!pair.second) {
         throw CompilerError(p, "Cannot redeclare variable.");
     }
-    type.setMutable(!constant);
-    Variable &v = map_.emplace(variable, Variable(std::move(type), id, constant, variable, p)).first->second;
-    return v;
+    return pair.first->second;
 }
 
 Variable& Scope::getLocalVariable(const std::u32string &variable) {
@@ -10,7 +10,7 @@
 #define Scope_hpp
 
 #include "Variable.hpp"
-#include <map>
+#include <unordered_map>
 
 namespace EmojicodeCompiler {
 
@@ -38,6 +38,12 @@ public:
     Variable& getLocalVariable(const std::u32string &variable);
     /// Returns true if a variable with the name @c variable is set in this scope.
     bool hasLocalVariable(const std::u32string &variable) const;
+    /// Returns the variable with the name @c variable or nullptr if there is no such variable in this scope.
+    /// Unlike a call to @c hasLocalVariable followed by @c getLocalVariable, this method only searches once.
+    Variable* findLocalVariable(const std::u32string &variable) {
+        auto it = map_.find(variable);
+        return it != map_.end() ? &it->second : nullptr;
+    }
 
     /// Emits a warning for each mutable variable that has not been mutated.
     /// Ensures that all non-optional variables are either initialized or are certainly not.
@@ -49,8 +55,8 @@ public:
         }
     }
 
-    std::map<std::u32string, Variable>& map() { return map_; }
-    const std::map<std::u32string, Variable>& map() const { return map_; }
+    std::unordered_map<std::u32string, Variable>& map() { return map_; }
+    const std::unordered_map<std::u32string, Variable>& map() const { return map_; }
 
     unsigned int maxVariableId() const { return maxVariableId_; }
     unsigned int reserveIds(unsigned int count) {
@@ -60,7 +66,7 @@ public:
     }
 
 private:
-    std::map<std::u32string, Variable> map_;
+    std::unordered_map<std::u32string, Variable> map_;
     unsigned int maxVariableId_ = 0;
 };
 
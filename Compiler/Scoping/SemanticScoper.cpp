@@ -53,12 +53,14 @@ void SemanticScoper::pushScope() {
 
 ResolvedVariable SemanticScoper::getVariable(const std::u32string &name, const SourcePosition &errorPosition) {
     for (Scope &scope : scopes_) {
-        if (scope.hasLocalVariable(name)) {
-            return ResolvedVariable(scope.getLocalVariable(name), false);
+        if (auto variable = scope.findLocalVariable(name)) {
+            return ResolvedVariable(*variable, false);
         }
     }
-    if (instanceScope_ != nullptr && instanceScope_->hasLocalVariable(name)) {
-        return ResolvedVariable(instanceScope_->getLocalVariable(name), true);
+    if (instanceScope_ != nullptr) {
+        if (auto variable = instanceScope_->findLocalVariable(name)) {
+            return ResolvedVariable(*variable, true);
+        }
     }
     throw VariableNotFoundError(errorPosition, name);
 }
@@ -51,7 +51,7 @@ void Class::analyseSuperType() {
         package()->compiler()->error(CompilerError(superType()->position(), type.toString(TypeContext(classType)),
                                                   " can’t be used as superclass as it was marked with 🔏."));
     }
-    type.klass()->setHasSubclass();
+    type.klass()->addSubclass(this);
 
     offsetIndicesBy(type.genericArguments().size());
     for (size_t i = type.typeDefinition()->superGenericArguments().size(); i < type.genericArguments().size(); i++) {
@@ -172,6 +172,20 @@ void Class::checkOverride(Function *function, SemanticAnalyser *analyser) {
         function->setAccessLevel(AccessLevel::Public);
     }
     function->setSuperFunction(superFunction);
+    if (superFunction != nullptr) {
+        superFunction->setOverridden();
+    }
+}
+
+void Class::addSubclass(Class *subclass) {
+    if (std::find(subclasses_.begin(), subclasses_.end(), subclass) == subclasses_.end()) {
+        subclasses_.emplace_back(subclass);
+    }
+    if (subclass->extensibleByOtherPackages()) {
+        for (auto klass = this; klass != nullptr && !klass->hasExtensibleSubclass_; klass = klass->superclass()) {
+            klass->hasExtensibleSubclass_ = true;
+        }
+    }
 }
 
 void Class::addInstanceVariable(const InstanceVariableDeclaration &declaration) {
@@ -66,14 +66,25 @@ public:
     void inherit(SemanticAnalyser *analyser);
     void analyseSuperType();
 
-    /// Makes hasSubclass() return true.
-    void setHasSubclass() { hasSubclass_ = true; }
+    /// Records that `subclass` inherits from this class. hasSubclass() returns true afterwards. If other packages can
+    /// subclass `subclass`, this class and its superclasses become extensibleByOtherPackages().
+    void addSubclass(Class *subclass);
     /// @returns true if this class has a subclass.
-    /// @see setHasSubclass()
-    bool hasSubclass() const { return hasSubclass_; }
+    /// @see addSubclass()
+    bool hasSubclass() const { return !subclasses_.empty(); }
+    /// The direct subclasses of this class that were declared in the main package or the imported packages.
+    const std::vector<Class *>& subclasses() const { return subclasses_; }
+    /// Whether other packages can subclass this class, either directly or through an exported subclass. Methods of
+    /// such a class can be overridden in packages that have not been analysed.
+    bool extensibleByOtherPackages() const { return (exported() && !final()) || hasExtensibleSubclass_; }
 
     void setFinal() { final_ = true; }
 
+    /// Whether instances of this class are allocated from and returned to a per-thread pool (ejcPoolAlloc) instead of
+    /// the allocator. Subclasses are not pooled unless they are marked themselves.
+    bool pooled() const { return pooled_; }
+    void setPooled() { pooled_ = true; }
+
     void setVirtualFunctionCount(size_t n) { virtualFunctionCount_ = n; }
     size_t virtualFunctionCount() { return virtualFunctionCount_; }
 
@@ -97,7 +108,10 @@ private:
 
     bool final_;
     bool foreign_;
-    bool hasSubclass_ = false;
+    bool pooled_ = false;
+    std::vector<Class *> subclasses_;
+    /// Whether a direct or indirect subclass is exported and not final. Set by addSubclass().
+    bool hasExtensibleSubclass_ = false;
 
     llvm::GlobalVariable *classInfo_ = nullptr;
 
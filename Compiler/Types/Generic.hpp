@@ -16,7 +16,9 @@
 #include <cassert>
 #include <functional>
 #include <map>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace EmojicodeCompiler {
@@ -97,6 +99,7 @@ public:
     }
 
     Entity& reificationFor(const std::vector<Type> &arguments) {
+        std::lock_guard<std::mutex> lock(reificationsMutex());
         auto ref = reifications_.find(buildKey(arguments));
         assert(ref != reifications_.end());
         return ref->second.entity;
@@ -114,10 +117,11 @@ public:
     /// should only be called in combination with unspecificReification()
     Entity& createUnspecificReification() {
         assert(!requiresCopyReification());
+        std::lock_guard<std::mutex> lock(reificationsMutex());
         if (reifications_.empty()) {
             reifications_.emplace();
         }
-        return unspecificReification();
+        return reifications_.begin()->second.entity;
     }
 
     bool requiresCopyReification() const {
@@ -174,31 +178,53 @@ private:
     /// the number of super type generic parameters if applicable (see TypeDefinition).
     std::vector<GenericParameter> genericParameters_;
     /** Generic type arguments as variables */
-    std::map<std::u32string, size_t> parameterVariables_;
+    std::unordered_map<std::u32string, size_t> parameterVariables_;
 
     std::map<std::vector<Type>, Reification> reifications_;
 
     size_t offset_ = 0;
 
+    /// Returns the type that represents @c argument in a reification.
+    ///
+    /// All classes have the same layout and are reference counted in the same way, so one reification is shared by
+    /// all class arguments, including optional ones.
+    static Type reificationArgument(const Type &argument) {
+        if (argument.type() == TypeType::Class) {
+            return Type::someobject();
+        }
+        if (argument.type() == TypeType::Optional && argument.optionalType().type() == TypeType::Class) {
+            return Type::someobject().optionalized();
+        }
+        return argument;
+    }
+
     std::vector<Type> buildKey(const std::vector<Type> &arguments) {
         std::vector<Type> key;
         for (size_t i = 0; i < genericParameters_.size(); i++) {
             if (genericParameters_[i].reifies) {
-                key.emplace_back(arguments[i].type() == TypeType::Class ? Type::someobject() : arguments[i]);
+                key.emplace_back(reificationArgument(arguments[i]));
             }
         }
         return key;
     }
 
+    /// Guards `reifications_` of all instances, as function bodies that request reifications may be analysed
+    /// concurrently. (See SemanticAnalyser.)
+    static std::mutex& reificationsMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
     void requestReification(const std::vector<Type> &arguments) {
         auto key = buildKey(arguments);
+        std::lock_guard<std::mutex> lock(reificationsMutex());
         if (reifications_.find(key) != reifications_.end()) {
             return;
         }
         auto &reification = reifications_[key] = Reification();
         for (size_t i = 0; i < genericParameters_.size(); i++) {
             if (genericParameters_[i].reifies) {
-                reification.arguments.emplace(i + offset_, arguments[i]);
+                reification.arguments.emplace(i + offset_, reificationArgument(arguments[i]));
             }
         }
     }
@@ -11,10 +11,14 @@
 
 namespace EmojicodeCompiler {
 
+/// Describes how values of a type are laid out in memory.
 enum class StorageType {
     Simple,
+    /// An optional stored as a flag followed by the value.
     SimpleOptional,
-    PointerOptional,
+    /// An optional stored like the value itself, with a value that is never valid, like a null pointer, denoting the
+    /// absence of a value.
+    NicheOptional,
     Box,
 };
 
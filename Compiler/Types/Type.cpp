@@ -41,8 +41,9 @@ Type::Type(ValueType *valueType)
     if (valueType->genericParameters().empty() || !valueType->genericParameters().front().constraint->wasAnalysed()) {
         return;
     }
+    auto &arguments = genericArguments_.mutate();
     for (size_t i = 0; i < valueType->genericParameters().size(); i++) {
-        genericArguments_.emplace_back(valueType->typeForVariable(i));
+        arguments.emplace_back(valueType->typeForVariable(i));
     }
 }
 
@@ -51,19 +52,21 @@ Type::Type(Class *klass) : typeContent_(TypeType::Class), typeDefinition_(klass)
         klass->genericParameters().empty() || !klass->genericParameters().front().constraint->wasAnalysed()) {
         return;
     }
-    genericArguments_ = klass->superGenericArguments();
+    auto &arguments = genericArguments_.mutate();
+    arguments = klass->superGenericArguments();
     for (size_t i = klass->superGenericArguments().size();
          i < klass->superGenericArguments().size() + klass->genericParameters().size(); i++) { 
-        genericArguments_.emplace_back(klass->typeForVariable(i));
+        arguments.emplace_back(klass->typeForVariable(i));
     }
 }
 
 Type::Type(Function *function) : typeContent_(TypeType::Callable) {
-    genericArguments_.reserve(function->parameters().size() + 2);
-    genericArguments_.emplace_back(function->returnType()->type());
-    genericArguments_.emplace_back(function->errorType()->type());
+    auto &arguments = genericArguments_.mutate();
+    arguments.reserve(function->parameters().size() + 2);
+    arguments.emplace_back(function->returnType()->type());
+    arguments.emplace_back(function->errorType()->type());
     for (auto &argument : function->parameters()) {
-        genericArguments_.emplace_back(argument.type->type());
+        arguments.emplace_back(argument.type->type());
     }
 }
 
@@ -130,7 +133,7 @@ Type Type::optionalized() const {
     }
     if (type() == TypeType::Box) {
         auto t = *this;
-        t.genericArguments_[0] = t.genericArguments_[0].optionalized();
+        t.genericArguments_.mutate()[0] = t.genericArguments_[0].optionalized();
         return t;
     }
     return Type(MakeOptionalType(), *this);
@@ -168,11 +171,11 @@ bool Type::canHaveGenericArguments() const {
 
 void Type::setGenericArguments(std::vector<Type> &&args) {
     if (type() == TypeType::Box) {
-        genericArguments_[0].setGenericArguments(std::move(args));
+        genericArguments_.mutate()[0].setGenericArguments(std::move(args));
     }
     else {
         assert(canHaveGenericArguments());
-        genericArguments_ = args;
+        genericArguments_ = std::move(args);
     }
 }
 
@@ -185,7 +188,8 @@ bool Type::canHaveProtocol() const {
 
 void Type::sortMultiProtocolType() {
     assert(type() == TypeType::MultiProtocol);
-    std::sort(genericArguments_.begin(), genericArguments_.end(), [](const Type &a, const Type &b) {
+    auto &protocols = genericArguments_.mutate();
+    std::sort(protocols.begin(), protocols.end(), [](const Type &a, const Type &b) {
         return a.protocol() < b.protocol();
     });
 }
@@ -219,11 +223,11 @@ Type Type::resolveOnSuperArgumentsAndConstraints(const TypeContext &typeContext)
     bool ref = isReference();
     bool mut = mutable_;
     if (type() == TypeType::Optional) {
-        t.genericArguments_[0] = genericArguments_[0].resolveOnSuperArgumentsAndConstraints(typeContext);
+        t.genericArguments_.mutate()[0] = genericArguments_[0].resolveOnSuperArgumentsAndConstraints(typeContext);
         return t;
     }
     if (type() == TypeType::Box) {
-        t.genericArguments_[0] = genericArguments_[0].resolveOnSuperArgumentsAndConstraints(typeContext).unboxed();
+        t.genericArguments_.mutate()[0] = genericArguments_[0].resolveOnSuperArgumentsAndConstraints(typeContext).unboxed();
         return t;
     }
 
@@ -262,7 +266,7 @@ Type Type::resolveOnSuperArgumentsAndConstraints(const TypeContext &typeContext)
 
 std::vector<Type> Type::selfResolvedGenericArgs() const {
     TypeContext typeContext(*this);
-    auto args = genericArguments_;
+    auto args = genericArguments_.vector();
     for (auto &g : args) {
         g = g.resolveOn(typeContext);
     }
@@ -274,11 +278,11 @@ Type Type::resolveOn(const TypeContext &typeContext) const {
     bool ref = isReference();
     bool mut = mutable_;
     if (type() == TypeType::Optional) {
-        t.genericArguments_[0] = genericArguments_[0].resolveOn(typeContext);
+        t.genericArguments_.mutate()[0] = genericArguments_[0].resolveOn(typeContext);
         return t;
     }
     if (type() == TypeType::Box) {
-        t.genericArguments_[0] = genericArguments_[0].resolveOn(typeContext).unboxed();
+        t.genericArguments_.mutate()[0] = genericArguments_[0].resolveOn(typeContext).unboxed();
         return t;
     }
 
@@ -300,8 +304,8 @@ Type Type::resolveOn(const TypeContext &typeContext) const {
         }
     }
 
-    if (t.type() != TypeType::Box) {
-        for (auto &arg : t.genericArguments_) {
+    if (t.type() != TypeType::Box && !t.genericArguments_.empty()) {
+        for (auto &arg : t.genericArguments_.mutate()) {
             arg = arg.resolveOn(typeContext);
         }
     }
@@ -481,6 +485,30 @@ bool Type::isCompatibleToCallable(const Type &to, const TypeContext &ct, Generic
     return false;
 }
 
+size_t Type::hash() const {
+    auto hash = std::hash<TypeDefinition *>()(typeDefinition_);
+    hash = hash * 31 + static_cast<size_t>(typeContent_);
+    hash = hash * 31 + genericArgumentIndex_;
+    return hash * 31 + std::hash<Function *>()(localResolutionConstraint_);
+}
+
+bool Type::equalsExactly(const Type &other) const {
+    return typeContent_ == other.typeContent_ && typeDefinition_ == other.typeDefinition_ &&
+        genericArgumentIndex_ == other.genericArgumentIndex_ &&
+        localResolutionConstraint_ == other.localResolutionConstraint_ && isReference_ == other.isReference_ &&
+        mutable_ == other.mutable_ && forceExact_ == other.forceExact_ &&
+        genericArguments_.equalsExactly(other.genericArguments_);
+}
+
+size_t Type::exactHash() const {
+    auto hash = this->hash();
+    hash = hash * 8 + (isReference_ ? 4 : 0) + (mutable_ ? 2 : 0) + (forceExact_ ? 1 : 0);
+    for (auto &argument : genericArguments_) {
+        hash = hash * 31 + argument.exactHash();
+    }
+    return hash;
+}
+
 bool Type::identicalTo(Type to, const TypeContext &tc, GenericInferer *inf) const {
     if (inf != nullptr && inf->inferringLocal() && to.type() == TypeType::LocalGenericVariable) {
         inf->addLocal(to.genericVariableIndex(), *this, tc);
@@ -536,10 +564,15 @@ StorageType Type::storageType() const {
         case TypeType::Box:
             return StorageType::Box;
         case TypeType::Optional:
-            if (optionalType().type() == TypeType::Class || optionalType().type() == TypeType::Someobject) {
-                return StorageType::PointerOptional;
+            switch (optionalType().type()) {
+                case TypeType::Class:
+                case TypeType::Someobject:
+                case TypeType::Callable:
+                case TypeType::Enum:
+                    return StorageType::NicheOptional;
+                default:
+                    return StorageType::SimpleOptional;
             }
-            return StorageType::SimpleOptional;
         default:
             return StorageType::Simple;
     }
@@ -14,7 +14,10 @@
 #include <utility>
 #include <vector>
 #include <tuple>
+#include <algorithm>
 #include <cassert>
+#include <functional>
+#include <memory>
 
 namespace EmojicodeCompiler {
 
@@ -86,7 +89,8 @@ public:
     /// Creates a callable type.
     explicit Type(Type returnType, const std::vector<Type> &params, Type errorType)
             : typeContent_(TypeType::Callable), genericArguments_({ std::move(returnType), std::move(errorType) }) {
-        genericArguments_.insert(genericArguments_.end(), params.begin(), params.end());
+        auto &arguments = genericArguments_.mutate();
+        arguments.insert(arguments.end(), params.begin(), params.end());
     }
 
     /// Creates a generic variable to the generic argument @c r.
@@ -212,7 +216,7 @@ public:
         return genericArguments_;
     }
     /// Allows to change a specific generic argument. @c index must be smaller than @c genericArguments().size()
-    void setGenericArgument(size_t index, Type value) { genericArguments_[index] = std::move(value); }
+    void setGenericArgument(size_t index, Type value) { genericArguments_.mutate()[index] = std::move(value); }
 
     /// Replaces the generic arguments of this type.
     void setGenericArguments(std::vector<Type> &&args);
@@ -317,8 +321,20 @@ public:
 
     inline bool operator!=(const Type &rhs) const { return !(*this == rhs); }
 
+    /// Returns a hash value of the members compared by operator==, so that equal types have equal hash values.
+    size_t hash() const;
+
+    /// Returns true if this type and @c other are equal in every respect. Unlike operator==, this method also compares
+    /// the generic arguments and whether the types are references, mutable or exact.
+    bool equalsExactly(const Type &other) const;
+    /// Returns a hash value of all members, so that types for which equalsExactly() returns true have equal values.
+    size_t exactHash() const;
+
     /// Returns true iff a value of the given type requires memory management.
     bool isManaged() const;
+    /// Returns true iff a value of this type can be copied by copying its bytes, i.e. the copy must not be retained.
+    /// Boxes are never trivially copyable as the type of the boxed value is not known at compile time.
+    bool isTriviallyCopyable() const { return !isManaged(); }
 
     TypeDefinition* resolutionConstraint() const;
 
@@ -348,11 +364,62 @@ private:
             assert(genericArguments_.front().type() != TypeType::NoValueLiteral);
         }
 
+    /// The generic arguments of a type, which copies of the type share. They are only copied when a type whose
+    /// arguments are shared is modified, so that copying a type does not allocate.
+    class Arguments {
+    public:
+        Arguments() = default;
+        Arguments(std::vector<Type> arguments)
+            : arguments_(std::make_shared<std::vector<Type>>(std::move(arguments))) {}
+
+        const std::vector<Type>& vector() const {
+            static const std::vector<Type> kEmpty;
+            return arguments_ != nullptr ? *arguments_ : kEmpty;
+        }
+        operator const std::vector<Type>&() const { return vector(); }
+
+        const Type& operator[](size_t index) const { return (*arguments_)[index]; }
+        const Type& front() const { return arguments_->front(); }
+        const Type* data() const { return vector().data(); }
+        size_t size() const { return vector().size(); }
+        bool empty() const { return vector().empty(); }
+        std::vector<Type>::const_iterator begin() const { return vector().begin(); }
+        std::vector<Type>::const_iterator end() const { return vector().end(); }
+
+        /// Returns the arguments for modification. They are copied first if another type shares them.
+        std::vector<Type>& mutate() {
+            if (arguments_ == nullptr) {
+                arguments_ = std::make_shared<std::vector<Type>>();
+            }
+            else if (arguments_.use_count() > 1) {
+                arguments_ = std::make_shared<std::vector<Type>>(*arguments_);
+            }
+            return *arguments_;
+        }
+
+        bool operator==(const Arguments &other) const {
+            return arguments_ == other.arguments_ || vector() == other.vector();
+        }
+        bool operator<(const Arguments &other) const {
+            return arguments_ != other.arguments_ && vector() < other.vector();
+        }
+        /// Returns true if both share their arguments or if their arguments are exactly equal.
+        bool equalsExactly(const Arguments &other) const {
+            return arguments_ == other.arguments_ ||
+                std::equal(begin(), end(), other.begin(), other.end(), [](const Type &a, const Type &b) {
+                    return a.equalsExactly(b);
+                });
+        }
+
+    private:
+        std::shared_ptr<std::vector<Type>> arguments_;
+    };
+
     TypeType typeContent_;
     size_t genericArgumentIndex_ = 0;
     TypeDefinition *typeDefinition_ = nullptr;
     Function *localResolutionConstraint_ = nullptr;
-    std::vector<Type> genericArguments_;
+    Arguments genericArguments_;
 
     Function* localResolutionConstraint() const;
 
@@ -372,4 +439,11 @@ private:
 
 }  // namespace EmojicodeCompiler
 
+namespace std {
+template <>
+struct hash<EmojicodeCompiler::Type> {
+    size_t operator()(const EmojicodeCompiler::Type &type) const { return type.hash(); }
+};
+}  // namespace std
+
 #endif /* Type_hpp */
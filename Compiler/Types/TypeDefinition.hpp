@@ -15,7 +15,7 @@
 #include "Type.hpp"
 #include "Functions/FunctionResolver.hpp"
 #include <functional>
-#include <map>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -121,9 +121,9 @@ public:
     const std::vector<InstanceVariableDeclaration>& instanceVariables() const { return instanceVariables_; }
     std::vector<InstanceVariableDeclaration>& instanceVariablesMut() { return instanceVariables_; }
 
-    void setProtocolTables(std::map<Type, llvm::Constant*> &&tables) { protocolTables_ = std::move(tables); }
+    void setProtocolTables(std::unordered_map<Type, llvm::Constant*> &&tables) { protocolTables_ = std::move(tables); }
     llvm::Constant* protocolTableFor(const Type &type) { return protocolTables_.find(type)->second; }
-    const std::map<Type, llvm::Constant*>& protocolTables() { return protocolTables_; }
+    const std::unordered_map<Type, llvm::Constant*>& protocolTables() { return protocolTables_; }
 
 protected:
     TypeDefinition(std::u32string name, Package *p, SourcePosition pos, std::u32string documentation, bool exported);
@@ -144,7 +144,7 @@ private:
     bool exported_;
     bool genericDynamismDisabled_ = false;
 
-    std::map<Type, llvm::Constant*> protocolTables_;
+    std::unordered_map<Type, llvm::Constant*> protocolTables_;
 
     std::vector<InstanceVariableDeclaration> instanceVariables_;
 
@@ -0,0 +1,402 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "../runtime/Runtime.h"
+#include "../s/Data.h"
+#include "../s/Error.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <lz4frame.h>
+#include <zlib.h>
+#include <zstd.h>
+
+using s::Data;
+
+namespace compression {
+
+/// The cases of 🧰 in the order of their declaration.
+enum class Algorithm : runtime::Enum { Zstd, Gzip, Lz4 };
+
+/// The number of bytes that are made available to a codec for its output at once.
+constexpr size_t kChunkSize = 65536;
+
+/// Collects the output of a codec. The memory is kept and reused for the output of the next call.
+class Buffer {
+public:
+    /// Returns a pointer to at least *count* bytes after the collected bytes.
+    char* reserve(size_t count) {
+        if (capacity_ - count_ < count) {
+            auto capacity = std::max(capacity_ * 2, count_ + count);
+            auto bytes = std::unique_ptr<char[]>(new char[capacity]);
+            std::memcpy(bytes.get(), bytes_.get(), count_);
+            bytes_ = std::move(bytes);
+            capacity_ = capacity;
+        }
+        return bytes_.get() + count_;
+    }
+
+    /// Adds *count* bytes written to the memory returned by reserve() to the collected bytes.
+    void commit(size_t count) {
+        count_ += count;
+    }
+
+    /// Returns a 📇 of the collected bytes and empties the buffer.
+    Data* take() {
+        auto data = Data::init();
+        data->data = runtime::allocate<runtime::Byte>(count_);
+        data->count = count_;
+        std::memcpy(data->data.get(), bytes_.get(), count_);
+        count_ = 0;
+        return data;
+    }
+
+private:
+    std::unique_ptr<char[]> bytes_;
+    size_t capacity_ = 0;
+    size_t count_ = 0;
+};
+
+/// Compresses a stream in the gzip, zstd or LZ4 frame format.
+class Compressor : public runtime::Object<Compressor> {
+public:
+    bool open(Algorithm algorithm, int level) {
+        algorithm_ = algorithm;
+        switch (algorithm) {
+            case Algorithm::Gzip:
+                // 16 is added to the window bits to write a gzip header instead of a zlib header.
+                opened_ = deflateInit2(&zlib_, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+                return opened_ || fail("Invalid compression level");
+            case Algorithm::Zstd:
+                zstd_ = ZSTD_createCCtx();
+                opened_ = zstd_ != nullptr;
+                return opened_ && check(ZSTD_CCtx_setParameter(zstd_, ZSTD_c_compressionLevel, level));
+            case Algorithm::Lz4:
+                opened_ = !LZ4F_isError(LZ4F_createCompressionContext(&lz4_, LZ4F_VERSION));
+                preferences_.compressionLevel = level;
+                return opened_ || fail("Could not create LZ4 context");
+        }
+        return false;
+    }
+
+    /// Compresses *count* bytes into the buffer and finishes the stream if *end* is true.
+    bool compress(const char *bytes, size_t count, bool end) {
+        switch (algorithm_) {
+            case Algorithm::Gzip: {
+                zlib_.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(bytes));
+                zlib_.avail_in = static_cast<uInt>(count);
+                int result;
+                do {
+                    zlib_.next_out = reinterpret_cast<Bytef *>(buffer_.reserve(kChunkSize));
+                    zlib_.avail_out = kChunkSize;
+                    result = deflate(&zlib_, end ? Z_FINISH : Z_NO_FLUSH);
+                    buffer_.commit(kChunkSize - zlib_.avail_out);
+                    if (result == Z_STREAM_ERROR) return fail("Compression failed");
+                } while (zlib_.avail_out == 0 || (end && result != Z_STREAM_END));
+                return true;
+            }
+            case Algorithm::Zstd: {
+                ZSTD_inBuffer in{bytes, count, 0};
+                while (true) {
+                    ZSTD_outBuffer out{buffer_.reserve(kChunkSize), kChunkSize, 0};
+                    auto remaining = ZSTD_compressStream2(zstd_, &out, &in, end ? ZSTD_e_end : ZSTD_e_continue);
+                    buffer_.commit(out.pos);
+                    if (!check(remaining)) return false;
+                    if (end ? remaining == 0 : in.pos == in.size) return true;
+                }
+            }
+            case Algorithm::Lz4: {
+                if (!started_) {
+                    auto written = LZ4F_compressBegin(lz4_, buffer_.reserve(LZ4F_HEADER_SIZE_MAX),
+                                                      LZ4F_HEADER_SIZE_MAX, &preferences_);
+                    if (LZ4F_isError(written)) return fail(LZ4F_getErrorName(written));
+                    buffer_.commit(written);
+                    started_ = true;
+                }
+                if (count > 0) {
+                    auto bound = LZ4F_compressBound(count, &preferences_);
+                    auto written = LZ4F_compressUpdate(lz4_, buffer_.reserve(bound), bound, bytes, count, nullptr);
+                    if (LZ4F_isError(written)) return fail(LZ4F_getErrorName(written));
+                    buffer_.commit(written);
+                }
+                if (end) {
+                    auto bound = LZ4F_compressBound(0, &preferences_);
+                    auto written = LZ4F_compressEnd(lz4_, buffer_.reserve(bound), bound, nullptr);
+                    if (LZ4F_isError(written)) return fail(LZ4F_getErrorName(written));
+                    buffer_.commit(written);
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void close() {
+        if (!opened_) return;
+        opened_ = false;
+        switch (algorithm_) {
+            case Algorithm::Gzip:
+                deflateEnd(&zlib_);
+                break;
+            case Algorithm::Zstd:
+                ZSTD_freeCCtx(zstd_);
+                break;
+            case Algorithm::Lz4:
+                LZ4F_freeCompressionContext(lz4_);
+                break;
+        }
+    }
+
+    bool check(size_t result) {
+        return !ZSTD_isError(result) || fail(ZSTD_getErrorName(result));
+    }
+
+    bool fail(const char *error) {
+        error_ = error;
+        return false;
+    }
+
+    Algorithm algorithm_ = Algorithm::Zstd;
+    bool opened_ = false;
+    z_stream zlib_{};
+    ZSTD_CCtx *zstd_ = nullptr;
+    LZ4F_cctx *lz4_ = nullptr;
+    LZ4F_preferences_t preferences_{};
+    /// Whether the LZ4 frame header was written.
+    bool started_ = false;
+    Buffer buffer_;
+    const char *error_ = "Compression failed";
+};
+
+/// Decompresses a stream in the gzip, zlib, zstd or LZ4 frame format.
+class Decompressor : public runtime::Object<Decompressor> {
+public:
+    bool open(Algorithm algorithm) {
+        algorithm_ = algorithm;
+        switch (algorithm) {
+            case Algorithm::Gzip:
+                // 32 is added to the window bits to detect a gzip or zlib header automatically.
+                opened_ = inflateInit2(&zlib_, 15 + 32) == Z_OK;
+                return opened_ || fail("Could not create zlib stream");
+            case Algorithm::Zstd:
+                zstd_ = ZSTD_createDCtx();
+                opened_ = zstd_ != nullptr;
+                return opened_ || fail("Could not create zstd context");
+            case Algorithm::Lz4:
+                opened_ = !LZ4F_isError(LZ4F_createDecompressionContext(&lz4_, LZ4F_VERSION));
+                return opened_ || fail("Could not create LZ4 context");
+        }
+        return false;
+    }
+
+    /// Decompresses *count* bytes into the buffer.
+    bool decompress(const char *bytes, size_t count) {
+        switch (algorithm_) {
+            case Algorithm::Gzip: {
+                zlib_.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(bytes));
+                zlib_.avail_in = static_cast<uInt>(count);
+                do {
+                    zlib_.next_out = reinterpret_cast<Bytef *>(buffer_.reserve(kChunkSize));
+                    zlib_.avail_out = kChunkSize;
+                    auto result = inflate(&zlib_, Z_NO_FLUSH);
+                    buffer_.commit(kChunkSize - zlib_.avail_out);
+                    if (result == Z_STREAM_END) {
+                        finished_ = true;
+                        // A gzip file can consist of several members, e.g. if it was compressed in parallel.
+                        if (zlib_.avail_in > 0) {
+                            inflateReset(&zlib_);
+                            finished_ = false;
+                        }
+                    }
+                    else if (result != Z_OK && result != Z_BUF_ERROR) {
+                        return fail(zlib_.msg != nullptr ? zlib_.msg : "Invalid compressed data");
+                    }
+                    else if (result == Z_BUF_ERROR && zlib_.avail_out != 0) {
+                        break;
+                    }
+                } while (zlib_.avail_in > 0 || zlib_.avail_out == 0);
+                return true;
+            }
+            case Algorithm::Zstd: {
+                ZSTD_inBuffer in{bytes, count, 0};
+                ZSTD_outBuffer out{nullptr, 0, 0};
+                do {
+                    out = ZSTD_outBuffer{buffer_.reserve(kChunkSize), kChunkSize, 0};
+                    auto result = ZSTD_decompressStream(zstd_, &out, &in);
+                    buffer_.commit(out.pos);
+                    if (ZSTD_isError(result)) return fail(ZSTD_getErrorName(result));
+                    finished_ = result == 0;
+                } while (in.pos < in.size || out.pos == out.size);
+                return true;
+            }
+            case Algorithm::Lz4: {
+                size_t position = 0;
+                bool full;
+                do {
+                    size_t written = kChunkSize, read = count - position;
+                    auto result = LZ4F_decompress(lz4_, buffer_.reserve(kChunkSize), &written, bytes + position,
+                                                  &read, nullptr);
+                    if (LZ4F_isError(result)) return fail(LZ4F_getErrorName(result));
+                    buffer_.commit(written);
+                    position += read;
+                    finished_ = result == 0;
+                    full = written == kChunkSize;
+                } while (position < count || full);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void close() {
+        if (!opened_) return;
+        opened_ = false;
+        switch (algorithm_) {
+            case Algorithm::Gzip:
+                inflateEnd(&zlib_);
+                break;
+            case Algorithm::Zstd:
+                ZSTD_freeDCtx(zstd_);
+                break;
+            case Algorithm::Lz4:
+                LZ4F_freeDecompressionContext(lz4_);
+                break;
+        }
+    }
+
+    bool fail(const char *error) {
+        error_ = error;
+        return false;
+    }
+
+    Algorithm algorithm_ = Algorithm::Zstd;
+    bool opened_ = false;
+    z_stream zlib_{};
+    ZSTD_DCtx *zstd_ = nullptr;
+    LZ4F_dctx *lz4_ = nullptr;
+    /// Whether the end of the compressed stream was reached.
+    bool finished_ = false;
+    Buffer buffer_;
+    const char *error_ = "Decompression failed";
+};
+
+/// Releases *codec* and returns the message of its last error.
+template <typename Codec>
+const char* releaseWithError(Codec *codec) {
+    auto error = codec->error_;
+    codec->release();
+    return error;
+}
+
+extern "C" Compressor* compressionCompressorNew(runtime::Enum algorithm, runtime::Integer level,
+                                                runtime::Raiser *raiser) {
+    auto compressor = Compressor::init();
+    if (!compressor->open(static_cast<Algorithm>(algorithm), static_cast<int>(level))) {
+        EJC_RAISE(raiser, s::IOError::init(releaseWithError(compressor)));
+    }
+    return compressor;
+}
+
+extern "C" Compressor* compressionCompressorNewDictionary(Data *dictionary, runtime::Integer level,
+                                                          runtime::Raiser *raiser) {
+    auto compressor = Compressor::init();
+    if (!compressor->open(Algorithm::Zstd, static_cast<int>(level)) ||
+        !compressor->check(ZSTD_CCtx_loadDictionary(compressor->zstd_, dictionary->bytes(), dictionary->count))) {
+        EJC_RAISE(raiser, s::IOError::init(releaseWithError(compressor)));
+    }
+    return compressor;
+}
+
+extern "C" void compressionCompressorSetThreads(Compressor *compressor, runtime::Integer threads) {
+    if (compressor->algorithm_ == Algorithm::Zstd) {
+        // Fails if zstd was built without multithreading, the stream is then compressed on the calling thread.
+        ZSTD_CCtx_setParameter(compressor->zstd_, ZSTD_c_nbWorkers, static_cast<int>(threads));
+    }
+}
+
+extern "C" Data* compressionCompressorWrite(Compressor *compressor, Data *data, runtime::Raiser *raiser) {
+    if (!compressor->compress(reinterpret_cast<char *>(data->bytes()), data->count, false)) {
+        EJC_RAISE(raiser, s::IOError::init(compressor->error_));
+    }
+    return compressor->buffer_.take();
+}
+
+extern "C" Data* compressionCompressorFinish(Compressor *compressor, runtime::Raiser *raiser) {
+    if (!compressor->compress(nullptr, 0, true)) {
+        EJC_RAISE(raiser, s::IOError::init(compressor->error_));
+    }
+    return compressor->buffer_.take();
+}
+
+extern "C" Data* compressionCompressorCompress(runtime::ClassInfo*, Data *data, runtime::Enum algorithm,
+                                               runtime::Integer level, runtime::Raiser *raiser) {
+    auto compressor = Compressor::init();
+    if (!compressor->open(static_cast<Algorithm>(algorithm), static_cast<int>(level)) ||
+        !compressor->compress(reinterpret_cast<char *>(data->bytes()), data->count, true)) {
+        EJC_RAISE(raiser, s::IOError::init(releaseWithError(compressor)));
+    }
+    auto result = compressor->buffer_.take();
+    compressor->release();
+    return result;
+}
+
+extern "C" void compressionCompressorDestruct(Compressor *compressor) {
+    compressor->close();
+    compressor->~Compressor();
+}
+
+extern "C" Decompressor* compressionDecompressorNew(runtime::Enum algorithm, runtime::Raiser *raiser) {
+    auto decompressor = Decompressor::init();
+    if (!decompressor->open(static_cast<Algorithm>(algorithm))) {
+        EJC_RAISE(raiser, s::IOError::init(releaseWithError(decompressor)));
+    }
+    return decompressor;
+}
+
+extern "C" Decompressor* compressionDecompressorNewDictionary(Data *dictionary, runtime::Raiser *raiser) {
+    auto decompressor = Decompressor::init();
+    if (!decompressor->open(Algorithm::Zstd)) {
+        EJC_RAISE(raiser, s::IOError::init(releaseWithError(decompressor)));
+    }
+    auto result = ZSTD_DCtx_loadDictionary(decompressor->zstd_, dictionary->bytes(), dictionary->count);
+    if (ZSTD_isError(result)) {
+        decompressor->fail(ZSTD_getErrorName(result));
+        EJC_RAISE(raiser, s::IOError::init(releaseWithError(decompressor)));
+    }
+    return decompressor;
+}
+
+extern "C" Data* compressionDecompressorWrite(Decompressor *decompressor, Data *data, runtime::Raiser *raiser) {
+    if (!decompressor->decompress(reinterpret_cast<char *>(data->bytes()), data->count)) {
+        EJC_RAISE(raiser, s::IOError::init(decompressor->error_));
+    }
+    return decompressor->buffer_.take();
+}
+
+extern "C" runtime::Boolean compressionDecompressorFinished(Decompressor *decompressor) {
+    return decompressor->finished_;
+}
+
+extern "C" Data* compressionDecompressorDecompress(runtime::ClassInfo*, Data *data, runtime::Enum algorithm,
+                                                   runtime::Raiser *raiser) {
+    auto decompressor = Decompressor::init();
+    if (!decompressor->open(static_cast<Algorithm>(algorithm)) ||
+        !decompressor->decompress(reinterpret_cast<char *>(data->bytes()), data->count) ||
+        (!decompressor->finished_ && !decompressor->fail("Compressed data is incomplete"))) {
+        EJC_RAISE(raiser, s::IOError::init(releaseWithError(decompressor)));
+    }
+    auto result = decompressor->buffer_.take();
+    decompressor->release();
+    return result;
+}
+
+extern "C" void compressionDecompressorDestruct(Decompressor *decompressor) {
+    decompressor->close();
+    decompressor->~Decompressor();
+}
+
+}  // namespace compression
+
+SET_INFO_FOR(compression::Compressor, compression, 1f5dc)
+SET_INFO_FOR(compression::Decompressor, compression, 1f388)
@@ -5,7 +5,9 @@ import sys
 import subprocess
 
 version = "1.0-beta.2"
-packages = ["s", "files", "sockets", "testtube", "json"]
+packages = ["s", "files", "sockets", "http", "testtube", "json", "regex", "metrics"]
+# Packages that are only built if their dependencies are available.
+optional_packages = ["tls", "compression"]
 
 source = os.path.dirname(os.path.realpath(__file__))
 dist_name = "Emojicode-{0}-{1}-{2}".format(version, platform.system(),
@@ -14,10 +16,12 @@ path = os.path.abspath(dist_name)
 
 
 def copy_packages(destination, source):
-    for package in packages:
+    built = [p for p in optional_packages if os.path.exists(os.path.join(p, "lib" + p + ".a"))]
+    for package in packages + built:
         dir_path = os.path.join(destination, package)
         make_dir(dir_path)
         shutil.copy2(os.path.join(package.encode('utf-8'), "🏛".encode('utf-8')), dir_path.encode('utf-8'))
+        shutil.copy2(os.path.join(package.encode('utf-8'), "🏛.tokens".encode('utf-8')), dir_path.encode('utf-8'))
         shutil.copy2(os.path.join(package, "lib" + package + ".a"), dir_path)
 
 def make_dir(path):
@@ -35,6 +39,7 @@ if __name__ == "__main__":
 
     shutil.copy2(os.path.join(source, "install.sh"), path)
     shutil.copy2(os.path.join("Compiler", "emojicodec"), path)
+    shutil.copy2(os.path.join("tools", "emojicode-demangle"), path)
 
     copy_header("runtime", "Runtime.h")
     copy_header("s", "Data.h")
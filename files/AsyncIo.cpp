@@ -0,0 +1,326 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "AsyncIo.h"
+#include "../runtime/Internal.hpp"
+#include "../s/IoUring.hpp"
+#include "../s/String.h"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fcntl.h>
+#include <mutex>
+#include <poll.h>
+#include <sys/wait.h>
+#include <thread>
+#include <vector>
+
+using s::String;
+using s::Data;
+
+namespace files {
+
+bool writeAll(int descriptor, const char *bytes, size_t count, off_t offset);
+ssize_t readAll(int descriptor, char *bytes, size_t count, off_t offset);
+
+/// Performs operations without blocking the threads that start them and submits their tasks once they completed.
+///
+/// On Linux, operations are submitted to an io_uring, whose completions are reaped by a single thread, so that any
+/// number of operations can be in flight. Partial reads and writes are resubmitted for the remaining bytes. Where
+/// io_uring is not available, a fixed number of threads perform the operations with blocking system calls, which
+/// bounds the number of threads blocked by slow storage.
+class AsyncIo {
+public:
+    static AsyncIo& shared() {
+        static AsyncIo io;
+        return io;
+    }
+
+    void start(Operation *operation) {
+        operation->retain();
+        if (operation->kind_ == Operation::Kind::Wait && !pollsProcesses(operation)) {
+            // Waiting blocks a thread then. It must not be one of the threads for file operations, which would be
+            // blocked for as long as the child process runs.
+            std::thread([operation] { complete(operation, perform(operation) ? 0 : errno); }).detach();
+            return;
+        }
+#ifdef __linux__
+        if (usesRing_) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            prepare(operation);
+            ring_.submit();
+            return;
+        }
+#endif
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(operation);
+        }
+        available_.notify_one();
+    }
+
+    ~AsyncIo() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+#ifdef __linux__
+            if (usesRing_) {
+                // A no-op completes immediately and thereby ends the wait of the completion thread.
+                ring_.prepare()->opcode = IORING_OP_NOP;
+                ring_.submit();
+            }
+#endif
+        }
+        available_.notify_all();
+        for (auto &thread : threads_) {
+            thread.join();
+        }
+    }
+
+private:
+    AsyncIo() {
+        // Objects are released on the threads of this class.
+        runtime::internal::becomeMultithreaded();
+#ifdef __linux__
+        usesRing_ = ring_.init(kRingEntries);
+        if (usesRing_) {
+            threads_.emplace_back([this] { reapLoop(); });
+            return;
+        }
+#endif
+        for (unsigned int i = 0; i < kBlockingThreads; i++) {
+            threads_.emplace_back([this] { blockingLoop(); });
+        }
+    }
+
+    /// Returns true if the termination of the child process of *operation* is awaited with the io_uring.
+    bool pollsProcesses(Operation *operation) const {
+#ifdef __linux__
+        return usesRing_ && operation->descriptor_ != -1;
+#else
+        return false;
+#endif
+    }
+
+    /// Releases the objects kept alive by *operation* and submits its task.
+    static void complete(Operation *operation, int error) {
+        operation->error_ = error;
+        if (operation->kind_ == Operation::Kind::Read && error == 0) {
+            operation->data_->count = operation->transferred_;
+        }
+        if (operation->retained_ != nullptr) {
+            ejcRelease(operation->retained_);
+            operation->retained_ = nullptr;
+        }
+        auto task = operation->task_;
+        operation->task_ = nullptr;
+        operation->release();
+        s::submitTask(task);
+    }
+
+    void blockingLoop() {
+        while (true) {
+            Operation *operation;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                available_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+                if (queue_.empty()) return;
+                operation = queue_.front();
+                queue_.pop_front();
+            }
+            complete(operation, perform(operation) ? 0 : errno);
+        }
+    }
+
+    static bool perform(Operation *operation) {
+        auto bytes = reinterpret_cast<char *>(operation->data_ != nullptr ? operation->data_->bytes() : nullptr);
+        switch (operation->kind_) {
+            case Operation::Kind::Read: {
+                auto read = readAll(operation->descriptor_, bytes, operation->count_, operation->offset_);
+                if (read < 0) return false;
+                operation->transferred_ = read;
+                return true;
+            }
+            case Operation::Kind::Write:
+                operation->transferred_ = operation->count_;
+                return writeAll(operation->descriptor_, bytes, operation->count_, operation->offset_);
+            case Operation::Kind::Status: {
+                struct stat st{};
+                if (stat(operation->path_.c_str(), &st) != 0) return false;
+                operation->status_ = Status::init(st);
+                return true;
+            }
+            case Operation::Kind::Wait:
+                return reap(operation, 0);
+        }
+        return false;
+    }
+
+    /// Collects the status of the child process of *operation* with waitpid() called with *options*.
+    static bool reap(Operation *operation, int options) {
+        pid_t result;
+        do {
+            result = waitpid(operation->pid_, &operation->waitStatus_, options);
+        } while (result < 0 && errno == EINTR);
+        if (result == 0) {
+            errno = EAGAIN;
+        }
+        return result > 0;
+    }
+
+#ifdef __linux__
+    /// Prepares the submission of *operation* or of its remaining bytes. Must be called with mutex_ locked.
+    void prepare(Operation *operation) {
+        auto sqe = ring_.prepare();
+        sqe->user_data = reinterpret_cast<uint64_t>(operation);
+        if (operation->kind_ == Operation::Kind::Status) {
+            sqe->opcode = IORING_OP_STATX;
+            sqe->fd = AT_FDCWD;
+            sqe->addr = reinterpret_cast<uint64_t>(operation->path_.c_str());
+            sqe->len = STATX_TYPE | STATX_MODE | STATX_SIZE | STATX_MTIME;
+            sqe->addr2 = reinterpret_cast<uint64_t>(&operation->statx_);
+            return;
+        }
+        if (operation->kind_ == Operation::Kind::Wait) {
+            // The pidfd becomes readable when the process has terminated.
+            sqe->opcode = IORING_OP_POLL_ADD;
+            sqe->fd = operation->descriptor_;
+            sqe->poll32_events = POLLIN;
+            return;
+        }
+        sqe->opcode = operation->kind_ == Operation::Kind::Read ? IORING_OP_READ : IORING_OP_WRITE;
+        sqe->fd = operation->descriptor_;
+        sqe->addr = reinterpret_cast<uint64_t>(operation->data_->bytes() + operation->transferred_);
+        sqe->len = static_cast<uint32_t>(std::min<size_t>(operation->count_ - operation->transferred_, UINT32_MAX));
+        sqe->off = operation->offset_ + operation->transferred_;
+    }
+
+    /// Handles the completion of a submission for *operation* with *result*, which is the result of the system call
+    /// or a negated `errno`. Must be called with mutex_ locked.
+    void handle(Operation *operation, int result) {
+        if (result == -EINTR || result == -EAGAIN) {
+            prepare(operation);
+            return;
+        }
+        if (result < 0) {
+            complete(operation, -result);
+            return;
+        }
+        if (operation->kind_ == Operation::Kind::Wait) {
+            if (reap(operation, WNOHANG)) {
+                complete(operation, 0);
+            }
+            else if (errno == EAGAIN) {
+                prepare(operation);
+            }
+            else {
+                complete(operation, errno);
+            }
+            return;
+        }
+        if (operation->kind_ == Operation::Kind::Status) {
+            auto &st = operation->statx_;
+            operation->status_ = Status::init(st.stx_size, st.stx_mtime.tv_sec * 1000000000LL + st.stx_mtime.tv_nsec,
+                                              st.stx_mode);
+            complete(operation, 0);
+            return;
+        }
+        operation->transferred_ += result;
+        if (result == 0 && operation->kind_ == Operation::Kind::Read) {
+            complete(operation, 0);  // The end of the file was reached.
+            return;
+        }
+        if (result == 0) {
+            complete(operation, EIO);
+            return;
+        }
+        if (operation->transferred_ < operation->count_) {
+            prepare(operation);
+            return;
+        }
+        complete(operation, 0);
+    }
+
+    void reapLoop() {
+        while (true) {
+            if (ring_.wait(-1) < 0 && errno != EINTR) {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            ring_.reap([this](const io_uring_cqe &cqe) {
+                if (cqe.user_data != 0) {
+                    handle(reinterpret_cast<Operation *>(cqe.user_data), cqe.res);
+                }
+            });
+            ring_.submit();
+            if (stop_) return;
+        }
+    }
+
+    static constexpr unsigned kRingEntries = 256;
+
+    s::IoUring ring_;
+    bool usesRing_ = false;
+#endif
+
+    /// The number of threads performing blocking operations if io_uring is not used.
+    static constexpr unsigned kBlockingThreads = 4;
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable available_;
+    std::deque<Operation *> queue_;
+    bool stop_ = false;
+};
+
+void startOperation(Operation *operation) {
+    AsyncIo::shared().start(operation);
+}
+
+extern "C" Operation* filesOperationNew() {
+    return Operation::init();
+}
+
+extern "C" runtime::SimpleOptional<Data*> filesOperationData(Operation *operation) {
+    if (operation->error_ != 0 || operation->data_ == nullptr) {
+        return runtime::NoValue;
+    }
+    operation->data_->retain();
+    return operation->data_;
+}
+
+extern "C" runtime::SimpleOptional<Status*> filesOperationStatus(Operation *operation) {
+    if (operation->error_ != 0 || operation->status_ == nullptr) {
+        return runtime::NoValue;
+    }
+    operation->status_->retain();
+    return operation->status_;
+}
+
+extern "C" runtime::Boolean filesOperationSucceeded(Operation *operation) {
+    return operation->error_ == 0;
+}
+
+extern "C" s::Task* filesFsStatusAsync(String *path, Operation *operation, runtime::Callable<void> callable) {
+    operation->kind_ = Operation::Kind::Status;
+    operation->path_ = path->stdString();
+    auto task = s::newTask(callable);
+    operation->task_ = task;
+    startOperation(operation);
+    return task;
+}
+
+extern "C" void filesOperationDestruct(Operation *operation) {
+    if (operation->data_ != nullptr) {
+        operation->data_->release();
+    }
+    if (operation->status_ != nullptr) {
+        operation->status_->release();
+    }
+    operation->~Operation();
+}
+
+}  // namespace files
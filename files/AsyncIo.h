@@ -0,0 +1,60 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#ifndef EMOJICODE_FILES_ASYNCIO_H
+#define EMOJICODE_FILES_ASYNCIO_H
+
+#include "../runtime/Runtime.h"
+#include "../s/Data.h"
+#include "../s/Task.h"
+#include "Status.h"
+#include <string>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+namespace files {
+
+/// A read, write, stat or wait for a child process that is performed asynchronously by startOperation() and the result
+/// of which is collected from the 🎫 that is submitted once it has completed.
+class Operation : public runtime::Object<Operation> {
+public:
+    enum class Kind { Read, Write, Status, Wait };
+
+    Kind kind_ = Kind::Read;
+    /// The file descriptor to read or write or, for waits, a pidfd of the child process or -1 if pidfds are not
+    /// available.
+    int descriptor_ = -1;
+    off_t offset_ = 0;
+    /// The bytes that are read or written. For reads, `count` is the number of bytes read once the operation has
+    /// completed.
+    s::Data *data_ = nullptr;
+    /// The number of bytes to read or write.
+    size_t count_ = 0;
+    /// The number of bytes read or written so far.
+    size_t transferred_ = 0;
+    std::string path_;
+    Status *status_ = nullptr;
+    /// The child process to wait for.
+    pid_t pid_ = -1;
+    /// The status reported by waitpid() for the child process once it was waited for.
+    int waitStatus_ = 0;
+    /// 0 or the `errno` of the failed operation.
+    int error_ = 0;
+    /// Kept alive while the operation is in flight and released thereafter, e.g. the file that is read.
+    runtime::Object<void> *retained_ = nullptr;
+    /// Submitted once the operation has completed.
+    s::Task *task_ = nullptr;
+#ifdef __linux__
+    struct statx statx_;
+#endif
+};
+
+/// Performs *operation*, which is retained until it has completed. Can be called from any thread.
+void startOperation(Operation *operation);
+
+}  // namespace files
+
+SET_INFO_FOR(files::Operation, files, 1f4ee)
+
+#endif //EMOJICODE_FILES_ASYNCIO_H
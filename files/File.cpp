@@ -6,10 +6,23 @@
 #include "../runtime/Runtime.h"
 #include "../s/Data.h"
 #include "../s/Error.h"
-#include <fstream>
-#include <ios>
-#include <iostream>
+#include "../s/Stream.h"
+#include "AsyncIo.h"
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef O_DIRECT
+// Direct I/O is not available, files opened with it use the page cache.
+#define O_DIRECT 0
+#endif
 
 using s::String;
 using s::Data;
@@ -18,77 +31,611 @@ namespace files {
 
 runtime::Enum errorEnumFromErrno();
 
+/// The alignment of the memory, the offsets and the sizes used with O_DIRECT, which is sufficient for the logical block
+/// size of all common devices.
+constexpr size_t kDirectAlignment = 4096;
+
+/// The capacity of the buffer of files opened for writing unless a different capacity is set.
+constexpr size_t kDefaultBufferCapacity = 65536;
+
+/// Writes all *count* bytes at *offset*. Returns false and sets `errno` on failure.
+bool writeAll(int descriptor, const char *bytes, size_t count, off_t offset) {
+    while (count > 0) {
+        auto written = pwrite(descriptor, bytes, count, offset);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        bytes += written;
+        count -= written;
+        offset += written;
+    }
+    return true;
+}
+
+/// Reads up to *count* bytes at *offset* and stops early only at the end of the file. Returns the number of bytes read
+/// or -1 and sets `errno` on failure.
+ssize_t readAll(int descriptor, char *bytes, size_t count, off_t offset) {
+    size_t total = 0;
+    while (total < count) {
+        auto read = pread(descriptor, bytes + total, count - total, offset + total);
+        if (read < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (read == 0) break;
+        total += read;
+    }
+    return total;
+}
+
+/// A file accessed through a file descriptor.
+///
+/// Sequential reads and writes use the file pointer `position_`, which is kept by the object rather than the kernel so
+/// that all I/O is positional and the positional methods can be used by several threads at once. Sequential writes are
+/// collected in `buffer_`, which holds the bytes from `position_` on.
 class File : public runtime::Object<File> {
 public:
-    std::fstream file_;
+    bool open(const char *path, int flags) {
+        descriptor_ = ::open(path, flags | O_CLOEXEC, 0666);
+        if (descriptor_ == -1 && errno == EINVAL && (flags & O_DIRECT) != 0) {
+            // The file system does not support direct I/O.
+            flags &= ~O_DIRECT;
+            descriptor_ = ::open(path, flags | O_CLOEXEC, 0666);
+        }
+        direct_ = (flags & O_DIRECT) != 0;
+        return descriptor_ != -1;
+    }
+
+    /// Sets the capacity of the buffer. The buffer must be empty.
+    bool setBufferCapacity(size_t capacity) {
+        std::free(buffer_);
+        buffer_ = nullptr;
+        capacity_ = direct_ ? std::max((capacity + kDirectAlignment - 1) / kDirectAlignment, size_t(1)) *
+                              kDirectAlignment : capacity;
+        if (capacity_ > 0 && posix_memalign(reinterpret_cast<void **>(&buffer_), kDirectAlignment, capacity_) != 0) {
+            capacity_ = 0;
+            errno = ENOMEM;
+            return false;
+        }
+        return true;
+    }
+
+    bool write(const char *bytes, size_t count) {
+        if (count >= capacity_ && count_ == 0 && !direct_) {
+            if (!writeAll(descriptor_, bytes, count, position_)) return false;
+            position_ += count;
+            return true;
+        }
+        while (count > 0) {
+            auto n = std::min(count, capacity_ - count_);
+            std::memcpy(buffer_ + count_, bytes, n);
+            count_ += n;
+            bytes += n;
+            count -= n;
+            if (count_ == capacity_ && !flush()) return false;
+        }
+        return true;
+    }
+
+    /// Writes the buffer to the file. Bytes that could not be written are kept in the buffer.
+    ///
+    /// With O_DIRECT only whole blocks can be written directly. A partial block at the end is written through the page
+    /// cache and kept in the buffer, so that it is written directly again once it is complete.
+    bool flush() {
+        if (count_ == 0) return true;
+        if (!direct_) {
+            if (!writeAll(descriptor_, buffer_, count_, position_)) return false;
+            position_ += count_;
+            count_ = 0;
+            return true;
+        }
+        auto blocks = count_ / kDirectAlignment * kDirectAlignment;
+        if (!writeAll(descriptor_, buffer_, blocks, position_)) return false;
+        position_ += blocks;
+        count_ -= blocks;
+        std::memmove(buffer_, buffer_ + blocks, count_);
+        if (count_ > 0) {
+            auto flags = fcntl(descriptor_, F_GETFL);
+            fcntl(descriptor_, F_SETFL, flags & ~O_DIRECT);
+            auto success = writeAll(descriptor_, buffer_, count_, position_);
+            fcntl(descriptor_, F_SETFL, flags);
+            return success;
+        }
+        return true;
+    }
+
+    /// Flushes the buffer and empties it, so that `position_` is the file pointer. Files opened with O_DIRECT continue
+    /// without it if the file pointer is not aligned.
+    bool settle() {
+        if (!flush()) return false;
+        position_ += count_;
+        count_ = 0;
+        stopDirectIfUnaligned();
+        return true;
+    }
+
+    bool seek(off_t position) {
+        if (!settle()) return false;
+        position_ = position;
+        stopDirectIfUnaligned();
+        return true;
+    }
+
+    void close() {
+        if (descriptor_ == -1) return;
+        flush();
+        ::close(descriptor_);
+        descriptor_ = -1;
+        std::free(buffer_);
+        buffer_ = nullptr;
+        capacity_ = 0;
+        count_ = 0;
+    }
+
+    int descriptor_ = -1;
+    /// The offset in the file of the first byte of the buffer, which is the file pointer if the buffer is empty.
+    off_t position_ = 0;
+
+private:
+    void stopDirectIfUnaligned() {
+        if (direct_ && position_ % kDirectAlignment != 0) {
+            fcntl(descriptor_, F_SETFL, fcntl(descriptor_, F_GETFL) & ~O_DIRECT);
+            direct_ = false;
+        }
+    }
+
+    char *buffer_ = nullptr;
+    size_t capacity_ = 0;
+    size_t count_ = 0;
+    bool direct_ = false;
 };
 
-extern "C" File* filesFileNewWriting(String *path, runtime::Raiser *raiser) {
+/// Opens a file and raises an error if it cannot be opened.
+File* openFile(String *path, int flags, size_t bufferCapacity, runtime::Raiser *raiser) {
     auto file = File::init();
-    file->file_ = std::fstream(path->stdString().c_str(), std::ios_base::out);
-    EJC_COND_RAISE_IO(!file->file_.fail(), raiser);
+    if (!file->open(path->stdString().c_str(), flags) || !file->setBufferCapacity(bufferCapacity)) {
+        auto error = errno;
+        file->release();
+        errno = error;
+        EJC_RAISE(raiser, s::IOError::init());
+    }
     return file;
 }
 
+extern "C" File* filesFileNewWriting(String *path, runtime::Raiser *raiser) {
+    return openFile(path, O_WRONLY | O_CREAT | O_TRUNC, kDefaultBufferCapacity, raiser);
+}
+
 extern "C" File* filesFileNewReading(String *path, runtime::Raiser *raiser) {
-    auto file = File::init();
-    file->file_ = std::fstream(path->stdString().c_str(), std::ios_base::in);
-    EJC_COND_RAISE_IO(!file->file_.fail(), raiser);
-    return file;
+    return openFile(path, O_RDONLY, 0, raiser);
+}
+
+extern "C" File* filesFileNewDirect(String *path, runtime::Raiser *raiser) {
+    return openFile(path, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, kDefaultBufferCapacity, raiser);
 }
 
-extern "C" void filesFileWrite(File *file, Data *data) {
-    file->file_.write(reinterpret_cast<char *>(data->data.get()), data->count);
+extern "C" void filesFileWrite(File *file, Data *data, runtime::Raiser *raiser) {
+    EJC_COND_RAISE_IO_VOID(file->write(reinterpret_cast<char *>(data->bytes()), data->count), raiser);
 }
 
 extern "C" void filesFileClose(File *file) {
-    file->file_.close();
+    file->close();
 }
 
 extern "C" void filesFileFlush(File *file) {
-    file->file_.flush();
+    file->flush();
+}
+
+extern "C" void filesFileSync(File *file, runtime::Raiser *raiser) {
+#ifdef __APPLE__
+    EJC_COND_RAISE_IO_VOID(file->flush() && fsync(file->descriptor_) == 0, raiser);
+#else
+    EJC_COND_RAISE_IO_VOID(file->flush() && fdatasync(file->descriptor_) == 0, raiser);
+#endif
+}
+
+extern "C" void filesFileSetBufferCapacity(File *file, runtime::Integer capacity, runtime::Raiser *raiser) {
+    EJC_COND_RAISE_IO_VOID(file->settle() && file->setBufferCapacity(capacity), raiser);
+}
+
+extern "C" void filesFileAdvise(File *file, runtime::Enum advice, runtime::Raiser *raiser) {
+#ifdef POSIX_FADV_SEQUENTIAL
+    static const int advices[] = { POSIX_FADV_SEQUENTIAL, POSIX_FADV_RANDOM, POSIX_FADV_WILLNEED, POSIX_FADV_DONTNEED };
+    auto error = posix_fadvise(file->descriptor_, 0, 0, advices[advice]);
+    errno = error;
+    EJC_COND_RAISE_IO_VOID(error == 0, raiser);
+#endif
 }
 
 extern "C" Data* filesFileReadBytes(File *file, runtime::Integer count, runtime::Raiser *raiser) {
+    EJC_COND_RAISE_IO(file->settle(), raiser);
     auto bytes = runtime::allocate<runtime::Byte>(count);
-    file->file_.read(reinterpret_cast<char *>(bytes.get()), count);
+    auto read = readAll(file->descriptor_, bytes.get(), count, file->position_);
+    if (read < 0) {
+        bytes.release();
+        EJC_RAISE(raiser, s::IOError::init());
+    }
+    file->position_ += read;
 
     auto data = Data::init();
     data->data = bytes;
-    data->count = file->file_.gcount();
-    EJC_COND_RAISE_IO(!file->file_.fail(), raiser);
+    data->count = read;
+    return data;
+}
+
+extern "C" Data* filesFileReadAt(File *file, runtime::Integer count, runtime::Integer offset,
+                                 runtime::Raiser *raiser) {
+    auto bytes = runtime::allocate<runtime::Byte>(count);
+    auto read = readAll(file->descriptor_, bytes.get(), count, offset);
+    if (read < 0) {
+        bytes.release();
+        EJC_RAISE(raiser, s::IOError::init());
+    }
+    auto data = Data::init();
+    data->data = bytes;
+    data->count = read;
     return data;
 }
 
+extern "C" void filesFileWriteAt(File *file, Data *data, runtime::Integer offset, runtime::Raiser *raiser) {
+    EJC_COND_RAISE_IO_VOID(writeAll(file->descriptor_, reinterpret_cast<char *>(data->bytes()), data->count,
+                                    offset), raiser);
+}
+
 extern "C" void filesFileSeekToEnd(File *file) {
-    file->file_.seekp(std::ios_base::end);
+    struct stat status {};
+    if (file->flush() && fstat(file->descriptor_, &status) == 0) {
+        file->seek(status.st_size);
+    }
 }
 
 extern "C" void filesFileSeekTo(File *file, runtime::Integer pos) {
-    file->file_.seekp(pos, std::ios_base::beg);
+    file->seek(pos);
+}
+
+extern "C" runtime::Integer filesFileReadInto(File *file, runtime::MemoryPointer<runtime::Byte> memory,
+                                             runtime::Integer offset, runtime::Integer count, runtime::Raiser *raiser) {
+    EJC_COND_RAISE_IO(file->settle(), raiser);
+    auto read = readAll(file->descriptor_, memory.get() + offset, count, file->position_);
+    EJC_COND_RAISE_IO(read >= 0, raiser);
+    file->position_ += read;
+    return read;
+}
+
+extern "C" s::Task* filesFileReadAsync(File *file, runtime::Integer count, runtime::Integer offset,
+                                       Operation *operation, runtime::Callable<void> callable) {
+    operation->kind_ = Operation::Kind::Read;
+    operation->descriptor_ = file->descriptor_;
+    operation->offset_ = offset;
+    operation->count_ = count;
+    operation->data_ = Data::init();
+    operation->data_->data = runtime::allocate<runtime::Byte>(count);
+    operation->data_->count = 0;
+    file->retain();
+    operation->retained_ = reinterpret_cast<runtime::Object<void> *>(file);
+    auto task = s::newTask(callable);
+    operation->task_ = task;
+    startOperation(operation);
+    return task;
+}
+
+extern "C" s::Task* filesFileWriteAsync(File *file, Data *data, runtime::Integer offset, Operation *operation,
+                                        runtime::Callable<void> callable) {
+    operation->kind_ = Operation::Kind::Write;
+    operation->descriptor_ = file->descriptor_;
+    operation->offset_ = offset;
+    operation->count_ = data->count;
+    data->retain();
+    operation->data_ = data;
+    file->retain();
+    operation->retained_ = reinterpret_cast<runtime::Object<void> *>(file);
+    auto task = s::newTask(callable);
+    operation->task_ = task;
+    startOperation(operation);
+    return task;
+}
+
+/// Reads a file in chunks of equal size into two buffers that are used alternately: while the caller processes the
+/// chunk returned last, the next chunk is already read into the other buffer. A buffer is only reused if the caller
+/// released the chunk it held before, so that chunks the caller keeps are never overwritten.
+class Chunks : public runtime::Object<Chunks> {
+public:
+    Chunks(File *file, size_t size) : file_(file), size_(size) {
+        file->retain();
+    }
+
+    /// Reads the next chunk into `next_`, which is null afterwards if the end of the file was reached or reading
+    /// failed.
+    void prefetch() {
+        auto data = spare_;
+        spare_ = nullptr;
+        if (data == nullptr || !data->isOnlyReference() || !data->data.isOnlyReference()) {
+            if (data != nullptr) {
+                data->release();
+            }
+            data = Data::init();
+            data->data = runtime::allocate<runtime::Byte>(size_);
+        }
+        ssize_t read = -1;
+        if (file_->settle()) {
+            read = readAll(file_->descriptor_, data->data.get(), size_, file_->position_);
+        }
+        if (read <= 0) {
+            failed_ = read < 0;
+            data->release();
+            next_ = nullptr;
+            return;
+        }
+        file_->position_ += read;
+        data->count = read;
+        next_ = data;
+#ifdef POSIX_FADV_WILLNEED
+        // The kernel reads the chunk after the next one in the background while the caller processes this one.
+        posix_fadvise(file_->descriptor_, file_->position_, size_, POSIX_FADV_WILLNEED);
+#endif
+    }
+
+    File *file_;
+    size_t size_;
+    /// The chunk returned by the next call to 🔽.
+    Data *next_ = nullptr;
+    /// The chunk returned last, whose buffer receives the chunk after `next_`.
+    Data *spare_ = nullptr;
+    bool failed_ = false;
+};
+
+extern "C" Chunks* filesFileChunks(File *file, runtime::Integer size, runtime::Raiser *raiser) {
+    auto chunks = Chunks::init(file, size);
+    chunks->prefetch();
+    if (chunks->failed_) {
+        auto error = errno;
+        chunks->release();
+        errno = error;
+        EJC_RAISE(raiser, s::IOError::init());
+    }
+    return chunks;
+}
+
+extern "C" Data* filesChunksNext(Chunks *chunks) {
+    auto current = chunks->next_;
+    if (current == nullptr) {
+        ejcPanic("📚🔽 called after the last chunk.");
+    }
+    chunks->prefetch();
+    chunks->spare_ = current;
+    current->retain();
+    return current;
+}
+
+extern "C" runtime::Boolean filesChunksHasNext(Chunks *chunks) {
+    return chunks->next_ != nullptr;
+}
+
+extern "C" runtime::Boolean filesChunksFailed(Chunks *chunks) {
+    return chunks->failed_;
+}
+
+extern "C" void filesChunksDestruct(Chunks *chunks) {
+    if (chunks->next_ != nullptr) {
+        chunks->next_->release();
+    }
+    if (chunks->spare_ != nullptr) {
+        chunks->spare_->release();
+    }
+    chunks->file_->release();
+}
+
+/// Iterates over the lines or records of a file, which are read with an s::InputStream and are slices of its buffer.
+/// The next record is read in advance to know whether there is one.
+class Records : public runtime::Object<Records> {
+public:
+    /// Creates an iterator over the records terminated by *delimiter* or, if *size* is greater than 0, the records of
+    /// *size* bytes.
+    Records(File *file, char delimiter, size_t size)
+        : file_(file), stream_(file->descriptor_, file->position_), delimiter_(delimiter), size_(size) {
+        file->retain();
+        advance();
+    }
+
+    void advance() {
+        next_ = size_ > 0 ? stream_.readRecord(size_) : stream_.readUntil(delimiter_);
+    }
+
+    File *file_;
+    s::InputStream stream_;
+    char delimiter_;
+    size_t size_;
+    /// The record returned by the next call to 🔽.
+    runtime::SimpleOptional<String *> next_ = runtime::NoValue;
+};
+
+/// Creates a Records iterator and raises an error if the first record cannot be read.
+Records* newRecords(File *file, char delimiter, size_t size, runtime::Raiser *raiser) {
+    EJC_COND_RAISE_IO(file->settle(), raiser);
+    auto records = Records::init(file, delimiter, size);
+    if (records->stream_.failed()) {
+        auto error = errno;
+        records->release();
+        errno = error;
+        EJC_RAISE(raiser, s::IOError::init());
+    }
+    return records;
+}
+
+extern "C" Records* filesFileLines(File *file, runtime::Raiser *raiser) {
+    return newRecords(file, '\n', 0, raiser);
+}
+
+extern "C" Records* filesFileDelimitedRecords(File *file, runtime::Byte delimiter, runtime::Raiser *raiser) {
+    return newRecords(file, delimiter, 0, raiser);
+}
+
+extern "C" Records* filesFileFixedRecords(File *file, runtime::Integer size, runtime::Raiser *raiser) {
+    if (size < 1) {
+        ejcPanic("📜🔸📏 called with a size less than 1.");
+    }
+    return newRecords(file, 0, size, raiser);
+}
+
+extern "C" String* filesRecordsNext(Records *records) {
+    if (records->next_ == runtime::NoValue) {
+        ejcPanic("🧻🔽 called after the last record.");
+    }
+    auto current = *records->next_;
+    records->advance();
+    return current;
+}
+
+extern "C" runtime::Boolean filesRecordsHasNext(Records *records) {
+    return !(records->next_ == runtime::NoValue);
+}
+
+extern "C" runtime::Boolean filesRecordsFailed(Records *records) {
+    return records->stream_.failed();
+}
+
+extern "C" void filesRecordsDestruct(Records *records) {
+    if (!(records->next_ == runtime::NoValue)) {
+        (*records->next_)->release();
+    }
+    records->file_->release();
+    records->~Records();
 }
 
 extern "C" Data* filesFileReadFile(runtime::ClassInfo*, String *path, runtime::Raiser *raiser) {
-    auto file = std::ifstream(path->stdString().c_str(), std::ios_base::ate);
-    std::streamsize size = file.tellg();
-    file.seekg(0, std::ios::beg);
+    auto descriptor = open(path->stdString().c_str(), O_RDONLY | O_CLOEXEC);
+    EJC_COND_RAISE_IO(descriptor != -1, raiser);
+    struct stat status {};
+    runtime::MemoryPointer<runtime::Byte> bytes;
+    ssize_t read = -1;
+    if (fstat(descriptor, &status) == 0) {
+        bytes = runtime::allocate<runtime::Byte>(status.st_size);
+        read = readAll(descriptor, bytes.get(), status.st_size, 0);
+        if (read < 0) {
+            bytes.release();
+        }
+    }
+    auto error = errno;
+    close(descriptor);
+    errno = error;
+    EJC_COND_RAISE_IO(read >= 0, raiser);
 
-    auto bytes = runtime::allocate<runtime::Byte>(size);
-    file.read(reinterpret_cast<char *>(bytes.get()), size);
+    auto data = Data::init();
+    data->data = bytes;
+    data->count = read;
+    return data;
+}
 
+extern "C" Data* filesFileMapFile(runtime::ClassInfo*, String *path, bool sequential, runtime::Raiser *raiser) {
+    auto descriptor = open(path->stdString().c_str(), O_RDONLY | O_CLOEXEC);
+    EJC_COND_RAISE_IO(descriptor != -1, raiser);
+    struct stat status {};
+    runtime::MemoryPointer<runtime::Byte> bytes;
+    bool success = fstat(descriptor, &status) == 0;
+    if (success && status.st_size == 0) {
+        // Empty files cannot be mapped.
+        bytes = runtime::allocate<runtime::Byte>(0);
+    }
+    else if (success) {
+        success = runtime::mapFile(descriptor, status.st_size, &bytes);
+    }
+    auto error = errno;
+    close(descriptor);
+    errno = error;
+    EJC_COND_RAISE_IO(success, raiser);
+
+    if (status.st_size > 0) {
+        madvise(bytes.get(), status.st_size, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+        if (sequential) {
+            madvise(bytes.get(), status.st_size, MADV_WILLNEED);
+        }
+    }
     auto data = Data::init();
     data->data = bytes;
-    data->count = size;
-    EJC_COND_RAISE_IO(!file.fail(), raiser);
+    data->count = status.st_size;
     return data;
 }
 
 extern "C" void filesFileWriteToFile(runtime::ClassInfo*, String *path, Data *data, runtime::Raiser *raiser) {
-    auto file = std::ofstream(path->stdString().c_str(), std::ios_base::out);
-    file.write(reinterpret_cast<char *>(data->data.get()), data->count);
-    EJC_COND_RAISE_IO_VOID(!file.fail(), raiser);
+    auto descriptor = open(path->stdString().c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    EJC_COND_RAISE_IO_VOID(descriptor != -1, raiser);
+    auto success = writeAll(descriptor, reinterpret_cast<char *>(data->bytes()), data->count, 0);
+    auto error = errno;
+    close(descriptor);
+    errno = error;
+    EJC_COND_RAISE_IO_VOID(success, raiser);
+}
+
+/// Returns the path of the directory containing *path*.
+std::string directoryOf(const std::string &path) {
+    auto slash = path.rfind('/');
+    if (slash == std::string::npos) return ".";
+    if (slash == 0) return "/";
+    return path.substr(0, slash);
+}
+
+/// Creates a file next to *path* that does not exist yet and returns its descriptor, or -1 on failure. The path of
+/// the file is stored in *temporaryPath*.
+int createTemporaryNextTo(const std::string &path, std::string *temporaryPath) {
+    static std::atomic<unsigned int> counter{0};
+    while (true) {
+        *temporaryPath = path + ".~" + std::to_string(getpid()) + "-" +
+                         std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+        auto descriptor = open(temporaryPath->c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+        if (descriptor != -1 || errno != EEXIST) return descriptor;
+    }
+}
+
+/// Writes *count* bytes to a temporary file and renames it to *path* once it is stored on the device, so that *path*
+/// refers either to the old or to the new content even after a crash. The new file keeps the permissions of the file
+/// it replaces. Returns false and sets `errno` on failure.
+bool replaceAtomically(const std::string &path, const char *bytes, size_t count) {
+    std::string temporaryPath;
+    auto descriptor = createTemporaryNextTo(path, &temporaryPath);
+    if (descriptor == -1) return false;
+    struct stat existing {};
+    auto success = (stat(path.c_str(), &existing) != 0 || fchmod(descriptor, existing.st_mode & 07777) == 0) &&
+                   writeAll(descriptor, bytes, count, 0);
+#ifdef __APPLE__
+    success = success && fsync(descriptor) == 0;
+#else
+    success = success && fdatasync(descriptor) == 0;
+#endif
+    auto error = errno;
+    success = close(descriptor) == 0 && success;
+    if (success && rename(temporaryPath.c_str(), path.c_str()) == 0) {
+        // The rename itself is only durable once the directory is synchronized.
+        auto directory = open(directoryOf(path).c_str(), O_RDONLY | O_CLOEXEC);
+        if (directory == -1) return false;
+        success = fsync(directory) == 0 || errno == EINVAL;
+        error = errno;
+        close(directory);
+        errno = error;
+        return success;
+    }
+    error = success ? errno : error;
+    unlink(temporaryPath.c_str());
+    errno = error;
+    return false;
+}
+
+extern "C" void filesFileReplaceFile(runtime::ClassInfo*, String *path, Data *data, runtime::Raiser *raiser) {
+    EJC_COND_RAISE_IO_VOID(replaceAtomically(path->stdString(), reinterpret_cast<char *>(data->bytes()),
+                                             data->count), raiser);
+}
+
+extern "C" void filesFilePreallocate(File *file, runtime::Integer count, runtime::Raiser *raiser) {
+#ifdef FALLOC_FL_KEEP_SIZE
+    // Unlike posix_fallocate, fallocate fails instead of writing zeros if the file system cannot preallocate.
+    if (fallocate(file->descriptor_, FALLOC_FL_KEEP_SIZE, file->position_, count) != 0) {
+        EJC_COND_RAISE_IO_VOID(errno == EOPNOTSUPP, raiser);
+    }
+#endif
 }
 
 }  // namespace files
 
 SET_INFO_FOR(files::File, files, 1f4c4)
+SET_INFO_FOR(files::Chunks, files, 1f4da)
+SET_INFO_FOR(files::Records, files, 1f9fb)
@@ -0,0 +1,222 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "../runtime/Runtime.h"
+#include "../s/Error.h"
+#include "../s/Stream.h"
+#include "../s/String.h"
+#include "AsyncIo.h"
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <spawn.h>
+#include <string>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+extern char **environ;
+
+using s::String;
+
+namespace files {
+
+/// A child process started with posix_spawn, whose standard input, output and error are pipes to this process.
+class Process : public runtime::Object<Process> {
+public:
+    pid_t pid_ = -1;
+    /// A pidfd referring to the process or -1 if the system does not support them.
+    int pidfd_ = -1;
+    s::OutputStream *input_ = nullptr;
+    s::InputStream *output_ = nullptr;
+    s::InputStream *error_ = nullptr;
+    /// The exit status of the process once it was waited for or -1.
+    runtime::Integer exitStatus_ = -1;
+};
+
+namespace {
+
+/// Returns the exit status of a process like a shell does: the code passed to exit() or 128 plus the number of the
+/// signal that terminated the process.
+runtime::Integer exitStatus(int waitStatus) {
+    if (WIFSIGNALED(waitStatus)) {
+        return 128 + WTERMSIG(waitStatus);
+    }
+    return WEXITSTATUS(waitStatus);
+}
+
+void closePipes(int (&pipes)[3][2]) {
+    for (auto &pipe : pipes) {
+        for (auto descriptor : pipe) {
+            if (descriptor != -1) close(descriptor);
+        }
+    }
+}
+
+/// Starts *program* with the arguments *argv*, which must end with a null pointer, and stores the ends of its pipes in
+/// *process*. Returns an error number or 0.
+int spawn(Process *process, const char *program, char *const *argv) {
+    int pipes[3][2] = {{-1, -1}, {-1, -1}, {-1, -1}};
+    for (auto &pipe : pipes) {
+        if (pipe2(pipe, O_CLOEXEC) != 0) {
+            auto error = errno;
+            closePipes(pipes);
+            return error;
+        }
+    }
+
+    // The ends used by the child are duplicated onto its standard descriptors, which clears O_CLOEXEC for them.
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, pipes[0][0], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, pipes[1][1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, pipes[2][1], STDERR_FILENO);
+
+    // SIGPIPE is ignored in this process, so that writing to a child that exited raises no signal. Ignored signals
+    // remain ignored after exec, which the child must not inherit.
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    sigset_t defaults;
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attributes, &defaults);
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGDEF);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    auto error = posix_spawnp(&process->pid_, program, &actions, &attributes, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attributes);
+    if (error != 0) {
+        closePipes(pipes);
+        return error;
+    }
+    close(pipes[0][0]);
+    close(pipes[1][1]);
+    close(pipes[2][1]);
+
+#ifdef SYS_pidfd_open
+    process->pidfd_ = static_cast<int>(syscall(SYS_pidfd_open, process->pid_, 0));
+    if (process->pidfd_ != -1) {
+        fcntl(process->pidfd_, F_SETFD, FD_CLOEXEC);
+    }
+#endif
+
+    process->input_ = s::OutputStream::init(pipes[0][1]);
+    process->input_->closeDescriptorOnDestruction();
+    process->output_ = s::InputStream::init(pipes[1][0]);
+    process->output_->closeDescriptorOnDestruction();
+    process->error_ = s::InputStream::init(pipes[2][0]);
+    process->error_->closeDescriptorOnDestruction();
+    return 0;
+}
+
+}  // namespace
+
+extern "C" Process* filesProcessSpawn(runtime::ClassInfo*, String *program, runtime::MemoryPointer<String *> arguments,
+                                      runtime::Integer count, runtime::Raiser *raiser) {
+    std::vector<std::string> strings;
+    strings.reserve(count + 1);
+    strings.emplace_back(program->stdString());
+    for (runtime::Integer i = 0; i < count; i++) {
+        strings.emplace_back(arguments[i]->stdString());
+        arguments[i]->release();
+    }
+    std::vector<char *> argv;
+    for (auto &string : strings) {
+        argv.emplace_back(&string[0]);
+    }
+    argv.emplace_back(nullptr);
+
+    auto process = Process::init();
+    auto error = spawn(process, argv.front(), argv.data());
+    if (error != 0) {
+        process->release();
+        errno = error;
+        EJC_RAISE(raiser, s::IOError::init());
+    }
+    return process;
+}
+
+extern "C" runtime::Integer filesProcessId(Process *process) {
+    return process->pid_;
+}
+
+extern "C" s::OutputStream* filesProcessInput(Process *process) {
+    process->input_->retain();
+    return process->input_;
+}
+
+extern "C" s::InputStream* filesProcessOutput(Process *process) {
+    process->output_->retain();
+    return process->output_;
+}
+
+extern "C" s::InputStream* filesProcessError(Process *process) {
+    process->error_->retain();
+    return process->error_;
+}
+
+extern "C" void filesProcessCloseInput(Process *process) {
+    process->input_->close();
+}
+
+extern "C" runtime::Integer filesProcessWait(Process *process, runtime::Raiser *raiser) {
+    if (process->exitStatus_ == -1) {
+        int status;
+        pid_t result;
+        do {
+            result = waitpid(process->pid_, &status, 0);
+        } while (result < 0 && errno == EINTR);
+        EJC_COND_RAISE_IO(result > 0, raiser);
+        process->exitStatus_ = exitStatus(status);
+    }
+    return process->exitStatus_;
+}
+
+extern "C" void filesProcessSetExitStatus(Process *process, runtime::Integer status) {
+    process->exitStatus_ = status;
+}
+
+extern "C" s::Task* filesProcessWaitAsync(Process *process, Operation *operation, runtime::Callable<void> callable) {
+    operation->kind_ = Operation::Kind::Wait;
+    operation->pid_ = process->pid_;
+    operation->descriptor_ = process->pidfd_;
+    process->retain();
+    operation->retained_ = reinterpret_cast<runtime::Object<void> *>(process);
+    auto task = s::newTask(callable);
+    operation->task_ = task;
+    startOperation(operation);
+    return task;
+}
+
+extern "C" runtime::SimpleOptional<runtime::Integer> filesOperationExitStatus(Operation *operation) {
+    if (operation->error_ != 0 || operation->kind_ != Operation::Kind::Wait) {
+        return runtime::NoValue;
+    }
+    return exitStatus(operation->waitStatus_);
+}
+
+extern "C" void filesProcessDestruct(Process *process) {
+    if (process->input_ == nullptr) {
+        // Spawning the process failed.
+        process->~Process();
+        return;
+    }
+    process->input_->release();
+    process->output_->release();
+    process->error_->release();
+    if (process->pidfd_ != -1) {
+        close(process->pidfd_);
+    }
+    // Reaps the process if it has already exited and was not waited for. Otherwise it remains a zombie once it exits.
+    if (process->exitStatus_ == -1) {
+        waitpid(process->pid_, nullptr, WNOHANG);
+    }
+    process->~Process();
+}
+
+}  // namespace files
+
+SET_INFO_FOR(files::Process, files, 1f3c3)
@@ -0,0 +1,47 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#ifndef EMOJICODE_FILES_STATUS_H
+#define EMOJICODE_FILES_STATUS_H
+
+#include "../runtime/Runtime.h"
+#include <sys/stat.h>
+
+namespace files {
+
+/// The cases of 🗃 in the order of their declaration.
+enum class FileType : runtime::Enum { File, Directory, SymbolicLink, Other };
+
+inline FileType fileTypeFromMode(mode_t mode) {
+    if (S_ISREG(mode)) return FileType::File;
+    if (S_ISDIR(mode)) return FileType::Directory;
+    if (S_ISLNK(mode)) return FileType::SymbolicLink;
+    return FileType::Other;
+}
+
+/// The size, modification time and type of a file, which are obtained together with a single stat call.
+class Status : public runtime::Object<Status> {
+public:
+    Status(runtime::Integer size, runtime::Integer modified, mode_t mode)
+        : size_(size), modified_(modified), type_(fileTypeFromMode(mode)) {}
+
+#ifdef __APPLE__
+    explicit Status(const struct stat &st)
+        : Status(st.st_size, st.st_mtimespec.tv_sec * 1000000000LL + st.st_mtimespec.tv_nsec, st.st_mode) {}
+#else
+    explicit Status(const struct stat &st)
+        : Status(st.st_size, st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec, st.st_mode) {}
+#endif
+
+    runtime::Integer size_;
+    /// Nanoseconds since the epoch.
+    runtime::Integer modified_;
+    FileType type_;
+};
+
+}  // namespace files
+
+SET_INFO_FOR(files::Status, files, 1f3f7)
+
+#endif //EMOJICODE_FILES_STATUS_H
@@ -0,0 +1,319 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "../runtime/Runtime.h"
+#include "../s/Error.h"
+#include "../s/String.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#ifdef __linux__
+#include <sys/inotify.h>
+#else
+#include <sys/event.h>
+#endif
+
+#ifndef O_EVTONLY
+#define O_EVTONLY O_RDONLY
+#endif
+
+using s::String;
+
+namespace files {
+
+/// The cases of 🌀 in the order of their declaration.
+enum class ChangeKind : runtime::Enum { Created, Modified, Deleted, Overflow };
+
+struct Change {
+    std::string path;
+    ChangeKind kind;
+};
+
+/// Watches files and directory trees for changes with inotify on Linux and kqueue on other platforms. Changes are
+/// collected in batches, in which repeated changes of the same kind to the same file are reported once.
+///
+/// inotify reports changes to the entries of watched directories, so one watch per directory suffices. kqueue needs a
+/// descriptor for every watched file and only reports that a directory changed, not which entry.
+class Watcher : public runtime::Object<Watcher> {
+public:
+    bool open() {
+#ifdef __linux__
+        descriptor_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#else
+        descriptor_ = kqueue();
+        if (descriptor_ != -1) {
+            fcntl(descriptor_, F_SETFD, FD_CLOEXEC);
+        }
+#endif
+        return descriptor_ != -1;
+    }
+
+    /// Watches *path* and, if *recursive* is true and it is a directory, all directories below it.
+    bool add(const std::string &path, bool recursive) {
+        struct stat st{};
+        if (stat(path.c_str(), &st) != 0) return false;
+        if (!addOne(path, S_ISDIR(st.st_mode), recursive)) return false;
+        return !recursive || !S_ISDIR(st.st_mode) || addBelow(path);
+    }
+
+    /// Waits up to *timeout* milliseconds, or indefinitely if it is negative, for changes and stores them in
+    /// `changes_`. Once a change arrived, further changes are collected for `latency_` milliseconds.
+    bool wait(int timeout) {
+        changes_.clear();
+        seen_.clear();
+        pollfd poll{descriptor_, POLLIN, 0};
+        auto ready = ::poll(&poll, 1, timeout);
+        if (ready < 0) return errno == EINTR;
+        if (ready == 0) return true;
+        if (!readChanges()) return false;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(latency_);
+        while (latency_ > 0) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0 || ::poll(&poll, 1, static_cast<int>(remaining)) <= 0) break;
+            if (!readChanges()) return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (descriptor_ == -1) return;
+        ::close(descriptor_);
+        descriptor_ = -1;
+#ifndef __linux__
+        for (auto &watch : watches_) {
+            ::close(watch.first);
+        }
+#endif
+        watches_.clear();
+    }
+
+    int descriptor_ = -1;
+    runtime::Integer latency_ = 0;
+    std::vector<Change> changes_;
+
+private:
+    struct Watch {
+        std::string path;
+        bool directory;
+        bool recursive;
+    };
+
+    void report(std::string path, ChangeKind kind) {
+        if (seen_.insert(path + static_cast<char>('0' + static_cast<int>(kind))).second) {
+            changes_.emplace_back(Change{std::move(path), kind});
+        }
+    }
+
+    /// Watches all directories below *path*.
+    bool addBelow(const std::string &path) {
+        auto dir = opendir(path.c_str());
+        if (dir == nullptr) return errno == ENOENT;
+        auto success = true;
+        while (auto entry = readdir(dir)) {
+            if (std::strcmp(entry->d_name, ".") == 0 || std::strcmp(entry->d_name, "..") == 0) continue;
+            auto entryPath = path + "/" + entry->d_name;
+            struct stat st{};
+            if (lstat(entryPath.c_str(), &st) != 0) continue;
+#ifdef __linux__
+            if (!S_ISDIR(st.st_mode)) continue;
+#endif
+            if (!addOne(entryPath, S_ISDIR(st.st_mode), true) || (S_ISDIR(st.st_mode) && !addBelow(entryPath))) {
+                success = false;
+                break;
+            }
+        }
+        auto error = errno;
+        closedir(dir);
+        errno = error;
+        return success;
+    }
+
+#ifdef __linux__
+    bool addOne(const std::string &path, bool directory, bool recursive) {
+        auto watch = inotify_add_watch(descriptor_, path.c_str(), IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB |
+                                       IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF);
+        if (watch == -1) return errno == ENOENT;
+        watches_[watch] = Watch{path, directory, recursive};
+        return true;
+    }
+
+    bool readChanges() {
+        alignas(inotify_event) char buffer[65536];
+        while (true) {
+            auto length = read(descriptor_, buffer, sizeof(buffer));
+            if (length < 0) {
+                if (errno == EINTR) continue;
+                return errno == EAGAIN;
+            }
+            for (char *p = buffer; p < buffer + length;) {
+                auto event = reinterpret_cast<inotify_event *>(p);
+                handle(*event);
+                p += sizeof(inotify_event) + event->len;
+            }
+        }
+    }
+
+    void handle(const inotify_event &event) {
+        if ((event.mask & IN_Q_OVERFLOW) != 0) {
+            report("", ChangeKind::Overflow);
+            return;
+        }
+        auto it = watches_.find(event.wd);
+        if (it == watches_.end()) return;
+        if ((event.mask & IN_IGNORED) != 0) {
+            watches_.erase(it);
+            return;
+        }
+        auto path = event.len > 0 ? it->second.path + "/" + event.name : it->second.path;
+        if ((event.mask & (IN_CREATE | IN_MOVED_TO)) != 0) {
+            if ((event.mask & IN_ISDIR) != 0 && it->second.recursive) {
+                // Entries created before the watch was added are not reported.
+                addOne(path, true, true);
+                addBelow(path);
+            }
+            report(std::move(path), ChangeKind::Created);
+        }
+        else if ((event.mask & (IN_DELETE | IN_MOVED_FROM | IN_DELETE_SELF | IN_MOVE_SELF)) != 0) {
+            report(std::move(path), ChangeKind::Deleted);
+        }
+        else {
+            report(std::move(path), ChangeKind::Modified);
+        }
+    }
+#else
+    bool addOne(const std::string &path, bool directory, bool recursive) {
+        auto file = ::open(path.c_str(), O_EVTONLY | O_CLOEXEC);
+        if (file == -1) return errno == ENOENT;
+        struct kevent change{};
+        EV_SET(&change, file, EVFILT_VNODE, EV_ADD | EV_CLEAR,
+               NOTE_WRITE | NOTE_EXTEND | NOTE_ATTRIB | NOTE_DELETE | NOTE_RENAME, 0, nullptr);
+        if (kevent(descriptor_, &change, 1, nullptr, 0, nullptr) == -1) {
+            auto error = errno;
+            ::close(file);
+            errno = error;
+            return false;
+        }
+        watches_[file] = Watch{path, directory, recursive};
+        return true;
+    }
+
+    bool readChanges() {
+        struct kevent events[64];
+        timespec zero{0, 0};
+        while (true) {
+            auto count = kevent(descriptor_, nullptr, 0, events, 64, &zero);
+            if (count < 0) return errno == EINTR;
+            if (count == 0) return true;
+            for (int i = 0; i < count; i++) {
+                handle(events[i]);
+            }
+        }
+    }
+
+    void handle(const struct kevent &event) {
+        auto file = static_cast<int>(event.ident);
+        auto it = watches_.find(file);
+        if (it == watches_.end()) return;
+        if ((event.fflags & (NOTE_DELETE | NOTE_RENAME)) != 0) {
+            report(it->second.path, ChangeKind::Deleted);
+            ::close(file);
+            watches_.erase(it);
+            return;
+        }
+        report(it->second.path, ChangeKind::Modified);
+        if (it->second.directory && it->second.recursive && (event.fflags & NOTE_WRITE) != 0) {
+            // Watch the entries that were added to the directory.
+            addNewBelow(it->second.path);
+        }
+    }
+
+    /// Watches the entries of the directory *path* that are not watched yet and reports them as created.
+    void addNewBelow(const std::string &path) {
+        std::unordered_set<std::string> watched;
+        for (auto &watch : watches_) {
+            watched.insert(watch.second.path);
+        }
+        auto dir = opendir(path.c_str());
+        if (dir == nullptr) return;
+        while (auto entry = readdir(dir)) {
+            if (std::strcmp(entry->d_name, ".") == 0 || std::strcmp(entry->d_name, "..") == 0) continue;
+            auto entryPath = path + "/" + entry->d_name;
+            struct stat st{};
+            if (watched.count(entryPath) > 0 || lstat(entryPath.c_str(), &st) != 0) continue;
+            addOne(entryPath, S_ISDIR(st.st_mode), true);
+            if (S_ISDIR(st.st_mode)) {
+                addBelow(entryPath);
+            }
+            report(entryPath, ChangeKind::Created);
+        }
+        closedir(dir);
+    }
+#endif
+
+    /// The watched files by watch descriptor (inotify) or file descriptor (kqueue).
+    std::unordered_map<int, Watch> watches_;
+    /// The changes in `changes_` to recognize repeated changes.
+    std::unordered_set<std::string> seen_;
+};
+
+extern "C" Watcher* filesWatcherNew(runtime::Raiser *raiser) {
+    auto watcher = Watcher::init();
+    if (!watcher->open()) {
+        auto error = errno;
+        watcher->release();
+        errno = error;
+        EJC_RAISE(raiser, s::IOError::init());
+    }
+    return watcher;
+}
+
+extern "C" void filesWatcherAdd(Watcher *watcher, String *path, runtime::Boolean recursive,
+                                runtime::Raiser *raiser) {
+    EJC_COND_RAISE_IO_VOID(watcher->add(path->stdString(), recursive), raiser);
+}
+
+extern "C" void filesWatcherSetLatency(Watcher *watcher, runtime::Integer milliseconds) {
+    watcher->latency_ = milliseconds;
+}
+
+extern "C" runtime::Integer filesWatcherWait(Watcher *watcher, runtime::Integer milliseconds,
+                                            runtime::Raiser *raiser) {
+    EJC_COND_RAISE_IO(watcher->wait(static_cast<int>(milliseconds)), raiser);
+    return watcher->changes_.size();
+}
+
+extern "C" String* filesWatcherPath(Watcher *watcher, runtime::Integer index) {
+    return String::init(watcher->changes_[index].path.c_str());
+}
+
+extern "C" runtime::Enum filesWatcherKind(Watcher *watcher, runtime::Integer index) {
+    return static_cast<runtime::Enum>(watcher->changes_[index].kind);
+}
+
+extern "C" runtime::Integer filesWatcherDescriptor(Watcher *watcher) {
+    return watcher->descriptor_;
+}
+
+extern "C" void filesWatcherClose(Watcher *watcher) {
+    watcher->close();
+}
+
+extern "C" void filesWatcherDestruct(Watcher *watcher) {
+    watcher->close();
+    watcher->~Watcher();
+}
+
+}  // namespace files
+
+SET_INFO_FOR(files::Watcher, files, 1f441)
@@ -5,17 +5,41 @@
 #include "../s/String.h"
 #include "../s/Error.h"
 #include "../runtime/Runtime.h"
+#include "../runtime/Internal.hpp"
+#include "Status.h"
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
 #include <climits>
+#include <condition_variable>
 #include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
 #include <ftw.h>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <sys/stat.h>
+#include <thread>
+#ifdef __linux__
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
 #include <unistd.h>
+#include <vector>
 
 namespace files {
 
 using s::String;
 
+bool writeAll(int descriptor, const char *bytes, size_t count, off_t offset);
+ssize_t readAll(int descriptor, char *bytes, size_t count, off_t offset);
+
+/// The size of the buffer used to copy files that cannot be copied by the kernel.
+constexpr size_t kCopyBufferSize = 1048576;
+
 extern "C" void filesFsMakeDir(String *path, runtime::Raiser *raiser) {
     EJC_COND_RAISE_IO_VOID(mkdir(path->stdString().c_str(), 0755) == 0, raiser)
 }
@@ -51,6 +75,56 @@ extern "C" void filesFsRecursiveDeleteDir(String *path, runtime::Raiser *raiser)
                            raiser)
 }
 
+/// Copies the *size* bytes of the file *in* to the empty file *out*. The file is cloned if the file system supports
+/// it, so that both files share their blocks until one is changed, or copied by the kernel without passing the bytes
+/// through user space. Otherwise, the bytes are read and written through a buffer.
+bool copyContents(int in, int out, off_t size) {
+#ifdef FICLONE
+    if (ioctl(out, FICLONE, in) == 0) return true;
+#endif
+    off_t copied = 0;
+#ifdef __linux__
+    while (copied < size) {
+        off_t inOffset = copied, outOffset = copied;
+        auto count = copy_file_range(in, &inOffset, out, &outOffset, size - copied, 0);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EXDEV || errno == ENOSYS || errno == EOPNOTSUPP || errno == EINVAL) break;
+            return false;
+        }
+        if (count == 0) return true;  // The file became shorter.
+        copied += count;
+    }
+    if (copied == size) return true;
+#endif
+    auto buffer = std::unique_ptr<char[]>(new char[kCopyBufferSize]);
+    while (copied < size) {
+        auto count = readAll(in, buffer.get(), kCopyBufferSize, copied);
+        if (count < 0) return false;
+        if (count == 0) break;
+        if (!writeAll(out, buffer.get(), count, copied)) return false;
+        copied += count;
+    }
+    return true;
+}
+
+extern "C" void filesFsCopy(String *source, String *destination, runtime::Raiser *raiser) {
+    auto in = open(source->stdString().c_str(), O_RDONLY | O_CLOEXEC);
+    EJC_COND_RAISE_IO_VOID(in != -1, raiser);
+    struct stat st{};
+    auto success = fstat(in, &st) == 0;
+    auto out = success ? open(destination->stdString().c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                              st.st_mode & 0777) : -1;
+    success = out != -1 && copyContents(in, out, st.st_size);
+    auto error = errno;
+    if (out != -1) {
+        close(out);
+    }
+    close(in);
+    errno = error;
+    EJC_COND_RAISE_IO_VOID(success, raiser);
+}
+
 extern "C" runtime::Boolean filesFsExists(String *path) {
     return access(path->stdString().c_str(), F_OK) == 0;
 }
@@ -76,6 +150,224 @@ extern "C" runtime::Integer filesFsSize(String *path, runtime::Raiser *raiser) {
     return st.st_size;
 }
 
+extern "C" Status* filesFsStatus(String *path, runtime::Raiser *raiser) {
+    struct stat st{};
+    EJC_COND_RAISE_IO(stat(path->stdString().c_str(), &st) == 0, raiser);
+    return Status::init(st);
+}
+
+extern "C" runtime::Integer filesStatusSize(Status *status) {
+    return status->size_;
+}
+
+extern "C" runtime::Integer filesStatusModified(Status *status) {
+    return status->modified_;
+}
+
+extern "C" runtime::Enum filesStatusType(Status *status) {
+    return static_cast<runtime::Enum>(status->type_);
+}
+
+/// Iterates over the entries of a directory with readdir, which reads many entries with one system call (getdents64
+/// on Linux). The type of an entry is taken from `d_type` where the file system provides it, and the entry is only
+/// stat'ed relative to the directory if it does not or if its status is requested.
+class Directory : public runtime::Object<Directory> {
+public:
+    /// Reads the next entry other than `.` and `..` into `next_`, which is null afterwards if there is none.
+    void advance() {
+        errno = 0;
+        while ((next_ = readdir(dir_)) != nullptr) {
+            if (!isDotOrDotDot(next_->d_name)) return;
+        }
+        failed_ = errno != 0;
+    }
+
+    static bool isDotOrDotDot(const char *name) {
+        return name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0));
+    }
+
+    DIR *dir_ = nullptr;
+    /// The entry returned by the next call to 🔽, which is valid until readdir is called again.
+    struct dirent *next_ = nullptr;
+    /// The name and `d_type` of the entry returned last.
+    char name_[sizeof(dirent::d_name)] = {};
+    unsigned char type_ = DT_UNKNOWN;
+    bool failed_ = false;
+};
+
+extern "C" Directory* filesFsDirectory(String *path, runtime::Raiser *raiser) {
+    auto dir = opendir(path->stdString().c_str());
+    EJC_COND_RAISE_IO(dir != nullptr, raiser);
+    auto directory = Directory::init();
+    directory->dir_ = dir;
+    directory->advance();
+    if (directory->failed_) {
+        auto error = errno;
+        directory->release();
+        errno = error;
+        EJC_RAISE(raiser, s::IOError::init());
+    }
+    return directory;
+}
+
+extern "C" String* filesDirectoryNext(Directory *directory) {
+    auto next = directory->next_;
+    if (next == nullptr) {
+        ejcPanic("📂🔽 called after the last entry.");
+    }
+    std::strcpy(directory->name_, next->d_name);
+    directory->type_ = next->d_type;
+    directory->advance();
+    return String::init(directory->name_);
+}
+
+extern "C" runtime::Boolean filesDirectoryHasNext(Directory *directory) {
+    return directory->next_ != nullptr;
+}
+
+extern "C" runtime::Boolean filesDirectoryFailed(Directory *directory) {
+    return directory->failed_;
+}
+
+extern "C" Status* filesDirectoryStatus(Directory *directory, runtime::Raiser *raiser) {
+    struct stat st{};
+    EJC_COND_RAISE_IO(fstatat(dirfd(directory->dir_), directory->name_, &st, AT_SYMLINK_NOFOLLOW) == 0, raiser);
+    return Status::init(st);
+}
+
+extern "C" runtime::Enum filesDirectoryType(Directory *directory) {
+    switch (directory->type_) {
+        case DT_REG: return static_cast<runtime::Enum>(FileType::File);
+        case DT_DIR: return static_cast<runtime::Enum>(FileType::Directory);
+        case DT_LNK: return static_cast<runtime::Enum>(FileType::SymbolicLink);
+        case DT_UNKNOWN: {
+            struct stat st{};
+            if (fstatat(dirfd(directory->dir_), directory->name_, &st, AT_SYMLINK_NOFOLLOW) == 0) {
+                return static_cast<runtime::Enum>(fileTypeFromMode(st.st_mode));
+            }
+            return static_cast<runtime::Enum>(FileType::Other);
+        }
+        default: return static_cast<runtime::Enum>(FileType::Other);
+    }
+}
+
+extern "C" void filesDirectoryDestruct(Directory *directory) {
+    if (directory->dir_ != nullptr) {
+        closedir(directory->dir_);
+    }
+}
+
+using WalkCallable = runtime::Callable<runtime::Boolean, String*, Status*>;
+
+/// Walks a directory hierarchy. Every directory is opened by its path once and its entries are stat'ed relative to it
+/// with fstatat. Directories that are found are queued, so that several threads can take them from the queue and walk
+/// different subtrees at the same time. Directories are queued by path rather than descriptor to bound the number of
+/// open descriptors.
+class Walk {
+public:
+    explicit Walk(WalkCallable callable) : callable_(callable) {}
+
+    /// Walks the directories in the queue on *threads* threads, including the calling thread. Returns false and sets
+    /// `errno` if a directory could not be read, in which case no further directories are read.
+    bool run(std::string root, unsigned int threads) {
+        pending_.emplace_back(std::move(root));
+        std::vector<std::thread> workers;
+        if (threads > 1) {
+            runtime::internal::becomeMultithreaded();
+            for (unsigned int i = 1; i < threads; i++) {
+                workers.emplace_back([this] {
+                    work();
+                    runtime::internal::releaseThreadLocals();
+                });
+            }
+        }
+        work();
+        for (auto &worker : workers) {
+            worker.join();
+        }
+        errno = error_;
+        return error_ == 0;
+    }
+
+private:
+    /// Takes directories from the queue until it is empty and no other thread can add to it anymore.
+    void work() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            changed_.wait(lock, [this] { return !pending_.empty() || active_ == 0 || error_ != 0; });
+            if (pending_.empty() || error_ != 0) break;
+            auto path = std::move(pending_.back());
+            pending_.pop_back();
+            active_++;
+            lock.unlock();
+            auto success = walkDirectory(path);
+            auto error = errno;
+            lock.lock();
+            active_--;
+            if (!success && error_ == 0) {
+                error_ = error;
+            }
+            changed_.notify_all();
+        }
+        changed_.notify_all();
+    }
+
+    bool walkDirectory(const std::string &path) {
+        auto dir = opendir(path.c_str());
+        if (dir == nullptr) return false;
+        auto descriptor = dirfd(dir);
+        std::vector<std::string> found;
+        struct dirent *entry;
+        while (errno = 0, (entry = readdir(dir)) != nullptr) {
+            if (Directory::isDotOrDotDot(entry->d_name)) continue;
+            struct stat st{};
+            if (fstatat(descriptor, entry->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                if (errno == ENOENT) continue;  // Deleted since it was read.
+                closedir(dir);
+                return false;
+            }
+            auto entryPath = path;
+            if (entryPath.back() != '/') entryPath += '/';
+            entryPath += entry->d_name;
+            auto string = String::init(entryPath.c_str());
+            auto status = Status::init(st);
+            auto descend = callable_(string, status);
+            string->release();
+            status->release();
+            if (descend && S_ISDIR(st.st_mode)) {
+                found.emplace_back(std::move(entryPath));
+            }
+        }
+        auto success = errno == 0;
+        auto error = errno;
+        closedir(dir);
+        if (!found.empty()) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::move(found.begin(), found.end(), std::back_inserter(pending_));
+            changed_.notify_all();
+        }
+        errno = error;
+        return success;
+    }
+
+    WalkCallable callable_;
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::vector<std::string> pending_;
+    /// The number of directories being read, which can add directories to the queue.
+    unsigned int active_ = 0;
+    int error_ = 0;
+};
+
+extern "C" void filesFsWalk(String *path, WalkCallable callable, runtime::Raiser *raiser) {
+    EJC_COND_RAISE_IO_VOID(Walk(callable).run(path->stdString(), 1), raiser);
+}
+
+extern "C" void filesFsParallelWalk(String *path, WalkCallable callable, runtime::Raiser *raiser) {
+    auto threads = std::max(std::thread::hardware_concurrency(), 1u);
+    EJC_COND_RAISE_IO_VOID(Walk(callable).run(path->stdString(), threads), raiser);
+}
+
 extern "C" String* filesFsAbsolute(String *inPath, runtime::Raiser *raiser) {
     char path[PATH_MAX];
     char *x = realpath(inPath->stdString().c_str(), path);
@@ -86,3 +378,5 @@ extern "C" String* filesFsAbsolute(String *inPath, runtime::Raiser *raiser) {
 }
 
 }  // namespace files
+
+SET_INFO_FOR(files::Directory, files, 1f4c2)
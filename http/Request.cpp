@@ -0,0 +1,473 @@
+//
+// Created by Theo Weidmann on 14.10.26.
+//
+
+#include "../runtime/Runtime.h"
+#include "../s/Data.h"
+#include "../s/String.h"
+#include "../s/Error.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <strings.h>
+#include <utility>
+#include <vector>
+
+using s::String;
+using s::Data;
+
+namespace http {
+
+/// A 📬 of the sockets package. The layout must match the instance variables declared there.
+class Buffer : public runtime::Object<Buffer> {
+public:
+    runtime::MemoryPointer<runtime::Byte> data;
+    runtime::Integer count;
+    runtime::Integer capacity;
+    runtime::MemoryPointer<runtime::Byte> peer;
+    runtime::Integer peerLength;
+};
+
+/// A range of the bytes in the buffer of a 📩.
+struct Slice {
+    runtime::Integer offset;
+    runtime::Integer count;
+};
+
+/// Parses the requests received into a 📬 one after the other. The method, the target and the header fields are not
+/// copied but recorded as slices of the buffer, which are only copied into strings when they are retrieved.
+///
+/// Parsing is incremental: If a request was not received completely, the bytes already examined are not examined
+/// again after more bytes were read into the buffer. The bodies of requests with chunked transfer coding are decoded
+/// in place, so that the body is a contiguous range of the buffer as well.
+class Request : public runtime::Object<Request> {
+public:
+    enum class Chunk { Size, Data, DataEnd, Trailer, Done };
+
+    Buffer *buffer_;
+    /// The offset of the first byte of the current request.
+    runtime::Integer start_ = 0;
+    /// The number of bytes from start_ that were searched for the end of the header without finding it.
+    runtime::Integer scanned_ = 0;
+    /// The offset of the first byte after the empty line that ends the header or 0 if the header is incomplete.
+    runtime::Integer bodyStart_ = 0;
+    /// The number of bytes of the body, which follow bodyStart_ and are decoded if the body is chunked.
+    runtime::Integer bodyCount_ = 0;
+    /// The offset of the first byte after the current request or 0 if the request is incomplete.
+    runtime::Integer end_ = 0;
+    Slice method_{};
+    Slice target_{};
+    std::vector<std::pair<Slice, Slice>> headers_;
+    runtime::Integer contentLength_ = 0;
+    bool chunked_ = false;
+    bool keepAlive_ = false;
+    /// The state of the decoder of a chunked body and the offset of the first byte it has not decoded yet.
+    Chunk chunk_ = Chunk::Size;
+    runtime::Integer cursor_ = 0;
+    runtime::Integer chunkRemaining_ = 0;
+
+    char* bytes() const { return buffer_->data.get(); }
+
+    String* string(Slice slice) const {
+        return String::copy(bytes() + slice.offset, slice.count);
+    }
+
+    /// Forgets the current request, so that parsing continues with the bytes after it.
+    void reset(runtime::Integer start) {
+        start_ = start;
+        scanned_ = 0;
+        bodyStart_ = 0;
+        bodyCount_ = 0;
+        end_ = 0;
+        headers_.clear();
+        chunk_ = Chunk::Size;
+    }
+};
+
+/// The maximum number of bytes of a line that specifies the size of a chunk or of a trailer field.
+constexpr runtime::Integer kMaxChunkLine = 4096;
+
+bool isToken(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+        (c != 0 && std::strchr("!#$%&'*+-.^_`|~", c) != nullptr);
+}
+
+/// Returns the value of the hexadecimal digit *c* or -1 if it is not a hexadecimal digit.
+int hexDigit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c |= 0x20;
+    return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+}
+
+bool equals(const char *bytes, Slice slice, const char *literal) {
+    auto length = static_cast<runtime::Integer>(std::strlen(literal));
+    return slice.count == length && strncasecmp(bytes + slice.offset, literal, length) == 0;
+}
+
+/// Returns true if the comma-separated list in *slice* contains *token*, ignoring case.
+bool containsToken(const char *bytes, Slice slice, const char *token) {
+    auto end = slice.offset + slice.count;
+    for (auto offset = slice.offset; offset < end;) {
+        auto comma = std::find(bytes + offset, bytes + end, ',') - bytes;
+        auto first = offset, last = comma;
+        while (first < last && (bytes[first] == ' ' || bytes[first] == '\t')) first++;
+        while (last > first && (bytes[last - 1] == ' ' || bytes[last - 1] == '\t')) last--;
+        if (equals(bytes, Slice{first, last - first}, token)) {
+            return true;
+        }
+        offset = comma + 1;
+    }
+    return false;
+}
+
+/// Returns the offset of the first CRLF at or after *from* and before *to* or -1.
+runtime::Integer findLineEnd(const char *bytes, runtime::Integer from, runtime::Integer to) {
+    for (auto offset = from; offset + 1 < to; offset++) {
+        auto cr = static_cast<const char *>(std::memchr(bytes + offset, '\r', to - offset - 1));
+        if (cr == nullptr) {
+            return -1;
+        }
+        offset = cr - bytes;
+        if (bytes[offset + 1] == '\n') {
+            return offset;
+        }
+    }
+    return -1;
+}
+
+/// Parses the request line and the header fields between start_ and *end*, which is the offset of the CRLF that
+/// terminates the last header field. Returns false if the header is malformed.
+bool parseHeader(Request *request, runtime::Integer end) {
+    auto bytes = request->bytes();
+    auto offset = request->start_;
+    // Empty lines before the request line are ignored (RFC 7230, 3.5).
+    while (offset + 1 < end && bytes[offset] == '\r' && bytes[offset + 1] == '\n') {
+        offset += 2;
+    }
+
+    auto methodStart = offset;
+    while (offset < end && isToken(bytes[offset])) offset++;
+    request->method_ = Slice{methodStart, offset - methodStart};
+    if (request->method_.count == 0 || offset >= end || bytes[offset++] != ' ') {
+        return false;
+    }
+    auto targetStart = offset;
+    while (offset < end && bytes[offset] > ' ' && bytes[offset] != 0x7F) offset++;
+    request->target_ = Slice{targetStart, offset - targetStart};
+    if (request->target_.count == 0 || offset >= end || bytes[offset++] != ' ') {
+        return false;
+    }
+    if (end - offset < 8 || std::memcmp(bytes + offset, "HTTP/1.", 7) != 0 ||
+        (bytes[offset + 7] != '0' && bytes[offset + 7] != '1')) {
+        return false;
+    }
+    auto minorVersion = bytes[offset + 7] - '0';
+    offset += 8;
+
+    request->keepAlive_ = minorVersion >= 1;
+    request->chunked_ = false;
+    request->contentLength_ = 0;
+    bool hasContentLength = false;
+    while (offset < end) {
+        if (bytes[offset] != '\r' || bytes[offset + 1] != '\n') {
+            return false;
+        }
+        offset += 2;
+        auto lineEnd = findLineEnd(bytes, offset, end + 2);
+        auto nameStart = offset;
+        while (offset < lineEnd && isToken(bytes[offset])) offset++;
+        // Obsolete line folding and whitespace before the colon are rejected (RFC 7230, 3.2.4).
+        if (offset == nameStart || offset == lineEnd || bytes[offset] != ':') {
+            return false;
+        }
+        Slice name{nameStart, offset - nameStart};
+        offset++;
+        auto valueEnd = lineEnd;
+        while (offset < valueEnd && (bytes[offset] == ' ' || bytes[offset] == '\t')) offset++;
+        while (valueEnd > offset && (bytes[valueEnd - 1] == ' ' || bytes[valueEnd - 1] == '\t')) valueEnd--;
+        Slice value{offset, valueEnd - offset};
+        request->headers_.emplace_back(name, value);
+        offset = lineEnd;
+
+        if (equals(bytes, name, "content-length")) {
+            runtime::Integer length = 0;
+            for (auto i = value.offset; i < value.offset + value.count; i++) {
+                if (bytes[i] < '0' || bytes[i] > '9' || length > (INT64_MAX - 9) / 10) {
+                    return false;
+                }
+                length = length * 10 + (bytes[i] - '0');
+            }
+            if (value.count == 0 || (hasContentLength && length != request->contentLength_)) {
+                return false;
+            }
+            hasContentLength = true;
+            request->contentLength_ = length;
+        }
+        else if (equals(bytes, name, "transfer-encoding")) {
+            // Only chunked is supported. Other codings, also if combined with chunked, are rejected because proxies
+            // might frame the message differently (RFC 7230, 3.3.3).
+            if (!equals(bytes, value, "chunked") || request->chunked_) {
+                return false;
+            }
+            request->chunked_ = true;
+        }
+        else if (equals(bytes, name, "connection")) {
+            if (containsToken(bytes, value, "close")) {
+                request->keepAlive_ = false;
+            }
+            else if (containsToken(bytes, value, "keep-alive")) {
+                request->keepAlive_ = true;
+            }
+        }
+    }
+    // A message with both is a request smuggling attempt (RFC 7230, 3.3.3).
+    return !(hasContentLength && request->chunked_);
+}
+
+/// Decodes as much of a chunked body as was received. Returns false if the body is malformed.
+bool decodeChunks(Request *request) {
+    auto bytes = request->bytes();
+    auto count = request->buffer_->count;
+    while (request->chunk_ != Request::Chunk::Done) {
+        auto &cursor = request->cursor_;
+        switch (request->chunk_) {
+            case Request::Chunk::Size: {
+                auto lineEnd = findLineEnd(bytes, cursor, count);
+                if (lineEnd == -1) {
+                    return count - cursor <= kMaxChunkLine;
+                }
+                runtime::Integer size = 0, digits = 0;
+                for (; cursor < lineEnd; cursor++, digits++) {
+                    auto digit = hexDigit(bytes[cursor]);
+                    if (digit == -1) {
+                        break;
+                    }
+                    if (digits == 15) {
+                        return false;
+                    }
+                    size = size * 16 + digit;
+                }
+                // Chunk extensions are ignored.
+                if (digits == 0 || (cursor < lineEnd && bytes[cursor] != ';' && bytes[cursor] != ' ' &&
+                                    bytes[cursor] != '\t')) {
+                    return false;
+                }
+                cursor = lineEnd + 2;
+                request->chunkRemaining_ = size;
+                request->chunk_ = size == 0 ? Request::Chunk::Trailer : Request::Chunk::Data;
+                break;
+            }
+            case Request::Chunk::Data: {
+                auto available = std::min(request->chunkRemaining_, count - cursor);
+                if (available == 0) {
+                    return true;
+                }
+                std::memmove(bytes + request->bodyStart_ + request->bodyCount_, bytes + cursor, available);
+                request->bodyCount_ += available;
+                request->chunkRemaining_ -= available;
+                cursor += available;
+                if (request->chunkRemaining_ == 0) {
+                    request->chunk_ = Request::Chunk::DataEnd;
+                }
+                break;
+            }
+            case Request::Chunk::DataEnd:
+                if (count - cursor < 2) {
+                    return true;
+                }
+                if (bytes[cursor] != '\r' || bytes[cursor + 1] != '\n') {
+                    return false;
+                }
+                cursor += 2;
+                request->chunk_ = Request::Chunk::Size;
+                break;
+            case Request::Chunk::Trailer: {
+                auto lineEnd = findLineEnd(bytes, cursor, count);
+                if (lineEnd == -1) {
+                    return count - cursor <= kMaxChunkLine;
+                }
+                // Trailer fields are ignored until the empty line that ends the request.
+                if (lineEnd == cursor) {
+                    request->chunk_ = Request::Chunk::Done;
+                    request->end_ = cursor + 2;
+                }
+                cursor = lineEnd + 2;
+                break;
+            }
+            case Request::Chunk::Done:
+                break;
+        }
+    }
+    return true;
+}
+
+/// Removes the bytes between the decoded body and the bytes that were not decoded yet, so that the space can
+/// receive more bytes.
+void closeChunkGap(Request *request) {
+    auto gap = request->cursor_ - (request->bodyStart_ + request->bodyCount_);
+    if (gap == 0) {
+        return;
+    }
+    auto bytes = request->bytes();
+    std::memmove(bytes + request->cursor_ - gap, bytes + request->cursor_, request->buffer_->count - request->cursor_);
+    request->buffer_->count -= gap;
+    request->cursor_ -= gap;
+}
+
+extern "C" Request* httpRequestNew(Buffer *buffer) {
+    auto request = Request::init();
+    buffer->retain();
+    request->buffer_ = buffer;
+    return request;
+}
+
+extern "C" void httpRequestDestruct(Request *request) {
+    request->buffer_->release();
+    request->~Request();
+}
+
+extern "C" runtime::Boolean httpRequestParse(Request *request, runtime::Raiser *raiser) {
+    auto buffer = request->buffer_;
+    if (request->end_ != 0) {
+        return true;
+    }
+    if (request->bodyStart_ == 0) {
+        auto bytes = request->bytes();
+        // The search continues with the last three bytes already searched, which could begin the empty line.
+        auto from = request->start_ + std::max<runtime::Integer>(0, request->scanned_ - 3);
+        runtime::Integer headerEnd = -1;
+        for (auto offset = from; (offset = findLineEnd(bytes, offset, buffer->count)) != -1; offset += 2) {
+            if (offset + 3 < buffer->count && bytes[offset + 2] == '\r' && bytes[offset + 3] == '\n') {
+                headerEnd = offset;
+                break;
+            }
+        }
+        if (headerEnd == -1) {
+            request->scanned_ = buffer->count - request->start_;
+            if (request->scanned_ == buffer->capacity) {
+                errno = EMSGSIZE;
+                EJC_RAISE(raiser, s::IOError::init());
+            }
+            return false;
+        }
+        if (!parseHeader(request, headerEnd)) {
+            errno = EBADMSG;
+            EJC_RAISE(raiser, s::IOError::init());
+        }
+        request->bodyStart_ = headerEnd + 4;
+        request->cursor_ = request->bodyStart_;
+        if (!request->chunked_ && request->contentLength_ > buffer->capacity - (request->bodyStart_ - request->start_)) {
+            errno = EMSGSIZE;
+            EJC_RAISE(raiser, s::IOError::init());
+        }
+    }
+
+    if (!request->chunked_) {
+        if (buffer->count - request->bodyStart_ < request->contentLength_) {
+            return false;
+        }
+        request->bodyCount_ = request->contentLength_;
+        request->end_ = request->bodyStart_ + request->contentLength_;
+        return true;
+    }
+    if (!decodeChunks(request)) {
+        errno = EBADMSG;
+        EJC_RAISE(raiser, s::IOError::init());
+    }
+    if (request->end_ != 0) {
+        return true;
+    }
+    closeChunkGap(request);
+    if (buffer->count - request->start_ == buffer->capacity) {
+        errno = EMSGSIZE;
+        EJC_RAISE(raiser, s::IOError::init());
+    }
+    return false;
+}
+
+extern "C" void httpRequestNext(Request *request) {
+    if (request->end_ == 0) {
+        ejcPanic("📩⏭ called before a request was parsed completely.");
+    }
+    request->reset(request->end_);
+}
+
+extern "C" void httpRequestCompact(Request *request) {
+    auto shift = request->start_;
+    if (shift == 0) {
+        return;
+    }
+    auto buffer = request->buffer_;
+    std::memmove(request->bytes(), request->bytes() + shift, buffer->count - shift);
+    buffer->count -= shift;
+    request->start_ = 0;
+    if (request->bodyStart_ != 0) {
+        request->method_.offset -= shift;
+        request->target_.offset -= shift;
+        for (auto &header : request->headers_) {
+            header.first.offset -= shift;
+            header.second.offset -= shift;
+        }
+        request->bodyStart_ -= shift;
+        request->cursor_ -= shift;
+    }
+    if (request->end_ != 0) {
+        request->end_ -= shift;
+    }
+}
+
+extern "C" String* httpRequestMethod(Request *request) {
+    return request->string(request->method_);
+}
+
+extern "C" String* httpRequestTarget(Request *request) {
+    return request->string(request->target_);
+}
+
+extern "C" runtime::Integer httpRequestHeaderCount(Request *request) {
+    return request->headers_.size();
+}
+
+extern "C" String* httpRequestHeaderName(Request *request, runtime::Integer index) {
+    if (index < 0 || index >= static_cast<runtime::Integer>(request->headers_.size())) {
+        ejcPanic("Index out of bounds in 📩🔑");
+    }
+    return request->string(request->headers_[index].first);
+}
+
+extern "C" String* httpRequestHeaderValue(Request *request, runtime::Integer index) {
+    if (index < 0 || index >= static_cast<runtime::Integer>(request->headers_.size())) {
+        ejcPanic("Index out of bounds in 📩💎");
+    }
+    return request->string(request->headers_[index].second);
+}
+
+extern "C" runtime::SimpleOptional<String*> httpRequestHeader(Request *request, String *name) {
+    auto bytes = request->bytes();
+    for (auto &header : request->headers_) {
+        if (header.first.count == name->count &&
+            strncasecmp(bytes + header.first.offset, name->bytes(), name->count) == 0) {
+            return request->string(header.second);
+        }
+    }
+    return runtime::NoValue;
+}
+
+extern "C" runtime::Boolean httpRequestKeepAlive(Request *request) {
+    return request->keepAlive_;
+}
+
+extern "C" Data* httpRequestBody(Request *request) {
+    auto data = Data::init();
+    data->count = request->bodyCount_;
+    data->data = runtime::allocate<runtime::Byte>(request->bodyCount_);
+    std::memcpy(data->data.get(), request->bytes() + request->bodyStart_, request->bodyCount_);
+    return data;
+}
+
+}  // namespace http
+
+SET_INFO_FOR(http::Request, http, 1f4e9)
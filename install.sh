@@ -72,8 +72,10 @@ if [[ $REPLY =~ ^[Yy]$ ]]; then
     echo "Copying builds${n}"
 
     cp emojicodec "$binaries/emojicodec"
+    cp emojicode-demangle "$binaries/emojicode-demangle"
 
     chmod 755 "$binaries/emojicodec"
+    chmod 755 "$binaries/emojicode-demangle"
 
     echo "Copying packages${n}"
 
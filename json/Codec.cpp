@@ -0,0 +1,650 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "Scanner.h"
+#include "../s/Data.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace json {
+
+namespace {
+
+/// Returns a word in which the high bit of every byte of *word* that is less than *n* is set. Like matches(), only the
+/// lowest set bit is reliable.
+inline uint64_t lessThan(uint64_t word, uint8_t n) {
+    return (word - kOnes * n) & ~word & kHighBits;
+}
+
+/// A growable buffer in Emojicode memory, whose bytes can be shared with 📇 and 🔡 instead of being copied.
+class Buffer {
+public:
+    Buffer() = default;
+    Buffer(const Buffer&) = delete;
+    ~Buffer() {
+        if (capacity_ > 0) {
+            memory_.release();
+        }
+    }
+
+    void push_back(char byte) {
+        reserve(1);
+        memory_[size_++] = byte;
+    }
+
+    void append(const char *bytes, size_t count) {
+        reserve(count);
+        std::memcpy(memory_.get() + size_, bytes, count);
+        size_ += count;
+    }
+
+    void append(const char *string) {
+        append(string, std::strlen(string));
+    }
+
+    /// Empties the buffer. Its memory is reused unless it is still shared.
+    void clear() {
+        if (capacity_ > 0 && !memory_.isOnlyReference()) {
+            memory_.release();
+            capacity_ = 0;
+        }
+        size_ = 0;
+    }
+
+    /// Returns the memory of the buffer, retained for a 📇 or 🔡 that shares it. Bytes appended later do not change
+    /// the bytes the buffer contains now. Must only be called if the buffer is not empty.
+    runtime::MemoryPointer<char> share() {
+        memory_.retain();
+        return memory_;
+    }
+
+    const char* data() const { return memory_.get(); }
+    size_t size() const { return size_; }
+
+private:
+    static constexpr size_t kMinimumCapacity = 4096;
+
+    void reserve(size_t count) {
+        if (size_ + count <= capacity_) return;
+        auto capacity = std::max(std::max(capacity_ * 2, size_ + count), kMinimumCapacity);
+        auto memory = runtime::allocate<char>(capacity);
+        if (capacity_ > 0) {
+            std::memcpy(memory.get(), memory_.get(), size_);
+            memory_.release();
+        }
+        memory_ = memory;
+        capacity_ = capacity;
+    }
+
+    runtime::MemoryPointer<char> memory_;
+    size_t capacity_ = 0;
+    size_t size_ = 0;
+};
+
+}  // namespace
+
+/// Writes values as a JSON text for 🖋. Arrays and objects are begun and ended explicitly, the separators between
+/// their elements are inserted automatically.
+class Writer : public runtime::Object<Writer> {
+public:
+    enum class Container { Array, Object, Dictionary };
+
+    void writeInteger(int64_t value) {
+        separate();
+        char buffer[24];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        text_.append(buffer, result.ptr - buffer);
+    }
+
+    void writeReal(double value) {
+        separate();
+        if (!std::isfinite(value)) {
+            text_.append("null");
+            return;
+        }
+        // Uses the fewest digits from which the value is read exactly.
+        char buffer[32];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        auto length = std::to_chars(buffer, buffer + sizeof(buffer), value).ptr - buffer;
+#else
+        int length;
+        for (auto precision = 15; ; precision++) {
+            length = std::snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+            if (precision == 17 || std::strtod(buffer, nullptr) == value) break;
+        }
+#endif
+        text_.append(buffer, length);
+        // Keeps the value a real when it is read again.
+        if (std::find_if(buffer, buffer + length, [](char c) { return c == '.' || c == 'e'; }) == buffer + length) {
+            text_.append(".0");
+        }
+    }
+
+    void writeLiteral(const char *literal) {
+        separate();
+        text_.append(literal);
+    }
+
+    void writeString(const char *bytes, size_t count) {
+        separate();
+        quote(bytes, count);
+    }
+
+    /// Writes the name of the next member of an object.
+    void writeKey(const char *bytes, size_t count) {
+        if (frames_.empty() || frames_.back().container != Container::Object) return;
+        if (frames_.back().count++ > 0) {
+            text_.push_back(',');
+        }
+        quote(bytes, count);
+        text_.push_back(':');
+    }
+
+    void begin(Container container) {
+        separate();
+        text_.push_back(container == Container::Array ? '[' : '{');
+        frames_.push_back(Frame{ container, 0 });
+    }
+
+    void end() {
+        if (frames_.empty()) return;
+        text_.push_back(frames_.back().container == Container::Array ? ']' : '}');
+        frames_.pop_back();
+    }
+
+    void reset() {
+        frames_.clear();
+        text_.clear();
+    }
+
+    Buffer text_;
+
+private:
+    struct Frame {
+        Container container;
+        size_t count;
+    };
+
+    /// Writes the `,` or `:` that must precede the next value.
+    void separate() {
+        if (frames_.empty()) return;
+        auto &frame = frames_.back();
+        if (frame.container == Container::Object) return;
+        if (frame.container == Container::Dictionary && frame.count % 2 == 1) {
+            text_.push_back(':');
+        }
+        else if (frame.count > 0) {
+            text_.push_back(',');
+        }
+        frame.count++;
+    }
+
+    /// Writes a string literal. Runs of bytes that need no escaping are found eight bytes at a time and appended at
+    /// once.
+    void quote(const char *bytes, size_t count) {
+        text_.push_back('"');
+        size_t i = 0;
+        while (i < count) {
+            auto run = i;
+            while (i + 8 <= count) {
+                uint64_t word;
+                std::memcpy(&word, bytes + i, sizeof(word));
+                if ((matches(word, '"') | matches(word, '\\') | lessThan(word, 0x20)) != 0) break;
+                i += 8;
+            }
+            while (i < count && !needsEscape(static_cast<uint8_t>(bytes[i]))) {
+                i++;
+            }
+            text_.append(bytes + run, i - run);
+            if (i < count) {
+                escape(static_cast<uint8_t>(bytes[i++]));
+            }
+        }
+        text_.push_back('"');
+    }
+
+    static bool needsEscape(uint8_t c) {
+        return c == '"' || c == '\\' || c < 0x20;
+    }
+
+    void escape(uint8_t c) {
+        switch (c) {
+            case '"': text_.append("\\\""); break;
+            case '\\': text_.append("\\\\"); break;
+            case '\b': text_.append("\\b"); break;
+            case '\f': text_.append("\\f"); break;
+            case '\n': text_.append("\\n"); break;
+            case '\r': text_.append("\\r"); break;
+            case '\t': text_.append("\\t"); break;
+            default: {
+                char buffer[8];
+                std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                text_.append(buffer);
+            }
+        }
+    }
+
+    std::vector<Frame> frames_;
+};
+
+/// Reads values from a JSON text for 🔖. The text is parsed completely when the reader is created and stored as a
+/// sequence of nodes in which every array and object is followed by its elements, so that the members of objects can
+/// be looked up by their names in any order without creating 🍯 or boxing values in ⚪️.
+class Reader : public runtime::Object<Reader> {
+public:
+    enum class Kind : uint8_t { Missing, Null, False, True, Integer, Real, String, Array, Object };
+
+    /// Parses the JSON text. Returns false and stores a description of the problem in `error_` on failure.
+    bool parse(runtime::MemoryPointer<char> memory, const char *bytes, size_t count) {
+        // The first node is returned for members that are missing.
+        nodes_.push_back(Node{ Kind::Missing, 0, 0, { 0 } });
+        Scanner scanner(memory, bytes, count);
+        auto success = parseValue(&scanner, 0) && (!scanner.skipWhitespace() ||
+                                                    fail("Unexpected input after end of value."));
+        scanner.close();
+        return success;
+    }
+
+    bool readInteger(int64_t *value) {
+        const Node *node;
+        if (!next(Kind::Integer, "Expected an integer.", &node)) return false;
+        *value = node->integer;
+        return true;
+    }
+
+    bool readReal(double *value) {
+        const Node *node;
+        if (position_ < nodes_.size() && nodes_[position_].kind == Kind::Integer) {
+            next(Kind::Integer, nullptr, &node);
+            *value = static_cast<double>(node->integer);
+            return true;
+        }
+        if (!next(Kind::Real, "Expected a number.", &node)) return false;
+        *value = node->real;
+        return true;
+    }
+
+    bool readBoolean(bool *value) {
+        const Node *node;
+        if (position_ < nodes_.size() && nodes_[position_].kind == Kind::True) {
+            *value = true;
+            return next(Kind::True, nullptr, &node);
+        }
+        *value = false;
+        return next(Kind::False, "Expected a boolean.", &node);
+    }
+
+    bool readString(const char **bytes, size_t *count) {
+        const Node *node;
+        if (!next(Kind::String, "Expected a string.", &node)) return false;
+        *bytes = strings_.data() + node->offset;
+        *count = node->size;
+        return true;
+    }
+
+    /// Begins reading the elements of an array or the members of an object, which are read as pairs of a string and
+    /// a value, and stores their number in *count*.
+    bool begin(Kind kind, size_t *count) {
+        auto index = position_;
+        const Node *node;
+        if (!next(kind, kind == Kind::Array ? "Expected an array." : "Expected an object.", &node)) return false;
+        frames_.push_back(Frame{ node->next, index, 0 });
+        position_ = index + 1;
+        *count = node->size;
+        return true;
+    }
+
+    /// Begins reading an object whose members are looked up with find().
+    bool beginFields() {
+        auto index = position_;
+        const Node *node;
+        if (!next(Kind::Object, "Expected an object.", &node)) return false;
+        frames_.push_back(Frame{ node->next, index, index + 1 });
+        return true;
+    }
+
+    /// Positions the reader at the value of the member *name* of the object begun last. The members are searched
+    /// starting after the member found before, so that members in the order of the instance variables are each found
+    /// at once.
+    void find(const char *name, size_t count) {
+        if (frames_.empty()) return;
+        auto &frame = frames_.back();
+        auto &object = nodes_[frame.object];
+        for (uint32_t i = 0; i < object.size; i++) {
+            if (frame.hint == frame.end) {
+                frame.hint = frame.object + 1;
+            }
+            auto &key = nodes_[frame.hint];
+            auto value = frame.hint + 1;
+            frame.hint = nodes_[value].next;
+            if (key.size == count && std::memcmp(strings_.data() + key.offset, name, count) == 0) {
+                position_ = value;
+                return;
+            }
+        }
+        position_ = 0;
+        missing_.assign(name, count);
+    }
+
+    /// Continues reading after the array or object begun last.
+    void end() {
+        if (frames_.empty()) return;
+        position_ = frames_.back().end;
+        frames_.pop_back();
+    }
+
+    /// Consumes the next value if it is null or a missing member.
+    bool readNull() {
+        if (position_ >= nodes_.size()) return false;
+        auto kind = nodes_[position_].kind;
+        if (kind != Kind::Null && kind != Kind::Missing) return false;
+        position_ = nodes_[position_].next;
+        return true;
+    }
+
+    const char *error_ = nullptr;
+
+private:
+    /// The deepest nesting of arrays and objects that is parsed.
+    static constexpr int kMaxDepth = 1024;
+
+    struct Node {
+        Kind kind;
+        /// The number of elements of an array, members of an object or bytes of a string.
+        uint32_t size;
+        /// The index of the node that follows this value and, for arrays and objects, their elements.
+        size_t next;
+        union {
+            int64_t integer;
+            double real;
+            /// The offset of the bytes of a string in `strings_`.
+            size_t offset;
+        };
+    };
+
+    struct Frame {
+        /// The index of the node after the array or object.
+        size_t end;
+        size_t object;
+        /// The index of the member at which the next lookup starts.
+        size_t hint;
+    };
+
+    bool fail(const char *error) {
+        error_ = error;
+        return false;
+    }
+
+    /// Consumes the next node, which must be of *kind*.
+    bool next(Kind kind, const char *error, const Node **node) {
+        if (position_ >= nodes_.size()) return fail("Unexpected end of input.");
+        if (nodes_[position_].kind != kind) {
+            if (nodes_[position_].kind == Kind::Missing) {
+                message_ = "Missing member " + missing_ + ".";
+                return fail(message_.c_str());
+            }
+            return fail(error);
+        }
+        *node = &nodes_[position_];
+        position_ = (*node)->next;
+        return true;
+    }
+
+    bool parseValue(Scanner *scanner, int depth) {
+        if (!scanner->skipWhitespace()) return fail(scanner->error_);
+        auto index = nodes_.size();
+        nodes_.push_back(Node{ Kind::Null, 0, 0, { 0 } });
+        auto byte = scanner->bytes()[scanner->index_++];
+        switch (byte) {
+            case '"':
+                if (!parseString(scanner, index)) return false;
+                break;
+            case '[':
+            case '{':
+                if (depth == kMaxDepth) return fail("Arrays and objects are nested too deeply.");
+                if (!parseContainer(scanner, index, byte == '{', depth + 1)) return false;
+                break;
+            case 'n':
+                if (!scanner->expect("ull", 3)) return fail(scanner->error_);
+                break;
+            case 't':
+                if (!scanner->expect("rue", 3)) return fail(scanner->error_);
+                nodes_[index].kind = Kind::True;
+                break;
+            case 'f':
+                if (!scanner->expect("alse", 4)) return fail(scanner->error_);
+                nodes_[index].kind = Kind::False;
+                break;
+            default: {
+                bool isInteger;
+                if ((byte != '-' && !isDigit(byte)) || !scanner->readNumber(&isInteger)) {
+                    return fail(scanner->error_ != nullptr ? scanner->error_ : "Invalid JSON.");
+                }
+                if (isInteger) {
+                    nodes_[index].kind = Kind::Integer;
+                    nodes_[index].integer = scanner->integer_;
+                }
+                else {
+                    nodes_[index].kind = Kind::Real;
+                    nodes_[index].real = scanner->real_;
+                }
+            }
+        }
+        nodes_[index].next = nodes_.size();
+        return true;
+    }
+
+    bool parseString(Scanner *scanner, size_t index) {
+        const char *bytes;
+        size_t count;
+        if (!scanner->readString(&bytes, &count)) return fail(scanner->error_);
+        nodes_[index].kind = Kind::String;
+        nodes_[index].size = static_cast<uint32_t>(count);
+        nodes_[index].offset = strings_.size();
+        strings_.append(bytes, count);
+        return true;
+    }
+
+    bool parseContainer(Scanner *scanner, size_t index, bool isObject, int depth) {
+        nodes_[index].kind = isObject ? Kind::Object : Kind::Array;
+        auto close = isObject ? '}' : ']';
+        if (!scanner->skipWhitespace()) return fail(scanner->error_);
+        if (scanner->bytes()[scanner->index_] == close) {
+            scanner->index_++;
+            return true;
+        }
+        while (true) {
+            if (isObject) {
+                if (!scanner->skipWhitespace()) return fail(scanner->error_);
+                if (scanner->bytes()[scanner->index_++] != '"') return fail("Invalid JSON.");
+                auto key = nodes_.size();
+                nodes_.push_back(Node{ Kind::String, 0, key + 1, { 0 } });
+                if (!parseString(scanner, key)) return false;
+                if (!scanner->skipWhitespace()) return fail(scanner->error_);
+                if (scanner->bytes()[scanner->index_++] != ':') return fail("Invalid JSON.");
+            }
+            if (!parseValue(scanner, depth)) return false;
+            nodes_[index].size++;
+            if (!scanner->skipWhitespace()) return fail(scanner->error_);
+            auto byte = scanner->bytes()[scanner->index_++];
+            if (byte == close) return true;
+            if (byte != ',') return fail(isObject ? "Expected }." : "Expected ].");
+        }
+    }
+
+    std::vector<Node> nodes_;
+    /// The bytes of all strings, with escape sequences decoded.
+    std::string strings_;
+    std::vector<Frame> frames_;
+    size_t position_ = 1;
+    /// The name of the member that find() could not find.
+    std::string missing_;
+    std::string message_;
+};
+
+extern "C" Writer* jsonWriterNew() {
+    return Writer::init();
+}
+
+extern "C" void jsonWriterInteger(Writer *writer, runtime::Integer value) {
+    writer->writeInteger(value);
+}
+
+extern "C" void jsonWriterReal(Writer *writer, runtime::Real value) {
+    writer->writeReal(value);
+}
+
+extern "C" void jsonWriterBoolean(Writer *writer, runtime::Boolean value) {
+    writer->writeLiteral(value ? "true" : "false");
+}
+
+extern "C" void jsonWriterString(Writer *writer, String *string) {
+    writer->writeString(string->bytes(), string->count);
+}
+
+extern "C" void jsonWriterArray(Writer *writer, runtime::Integer count) {
+    writer->begin(Writer::Container::Array);
+}
+
+extern "C" void jsonWriterDictionary(Writer *writer, runtime::Integer count) {
+    writer->begin(Writer::Container::Dictionary);
+}
+
+extern "C" void jsonWriterFields(Writer *writer, runtime::Integer count) {
+    writer->begin(Writer::Container::Object);
+}
+
+extern "C" void jsonWriterKey(Writer *writer, String *name) {
+    writer->writeKey(name->bytes(), name->count);
+}
+
+extern "C" void jsonWriterNull(Writer *writer) {
+    writer->writeLiteral("null");
+}
+
+extern "C" void jsonWriterEnd(Writer *writer) {
+    writer->end();
+}
+
+extern "C" String* jsonWriterText(Writer *writer) {
+    if (writer->text_.size() <= 1) {
+        return String::copy(writer->text_.data(), writer->text_.size());
+    }
+    auto string = String::init();
+    string->characters = writer->text_.share();
+    string->count = writer->text_.size();
+    return string;
+}
+
+extern "C" s::Data* jsonWriterData(Writer *writer) {
+    auto data = s::Data::init();
+    data->count = writer->text_.size();
+    data->data = data->count > 0 ? writer->text_.share() : runtime::allocate<runtime::Byte>(0);
+    return data;
+}
+
+extern "C" void jsonWriterReset(Writer *writer) {
+    writer->reset();
+}
+
+extern "C" void jsonWriterDestruct(Writer *writer) {
+    writer->~Writer();
+}
+
+Reader* newReader(runtime::MemoryPointer<char> memory, const char *bytes, size_t count, runtime::Raiser *raiser) {
+    auto reader = Reader::init();
+    if (!reader->parse(memory, bytes, count)) {
+        auto error = Error::init(reader->error_);
+        reader->release();
+        EJC_RAISE(raiser, error);
+    }
+    return reader;
+}
+
+extern "C" Reader* jsonReaderNew(String *string, runtime::Raiser *raiser) {
+    return newReader(string->characters, string->bytes(), string->count, raiser);
+}
+
+extern "C" Reader* jsonReaderNewData(s::Data *data, runtime::Raiser *raiser) {
+    return newReader(data->data, data->bytes(), data->count, raiser);
+}
+
+extern "C" runtime::Integer jsonReaderInteger(Reader *reader, runtime::Raiser *raiser) {
+    int64_t value;
+    if (!reader->readInteger(&value)) {
+        EJC_RAISE(raiser, Error::init(reader->error_));
+    }
+    return value;
+}
+
+extern "C" runtime::Real jsonReaderReal(Reader *reader, runtime::Raiser *raiser) {
+    double value;
+    if (!reader->readReal(&value)) {
+        EJC_RAISE(raiser, Error::init(reader->error_));
+    }
+    return value;
+}
+
+extern "C" runtime::Boolean jsonReaderBoolean(Reader *reader, runtime::Raiser *raiser) {
+    bool value;
+    if (!reader->readBoolean(&value)) {
+        EJC_RAISE(raiser, Error::init(reader->error_));
+    }
+    return value;
+}
+
+extern "C" String* jsonReaderString(Reader *reader, runtime::Raiser *raiser) {
+    const char *bytes;
+    size_t count;
+    if (!reader->readString(&bytes, &count)) {
+        EJC_RAISE(raiser, Error::init(reader->error_));
+    }
+    return String::copy(bytes, count);
+}
+
+extern "C" runtime::Integer jsonReaderArray(Reader *reader, runtime::Raiser *raiser) {
+    size_t count;
+    if (!reader->begin(Reader::Kind::Array, &count)) {
+        EJC_RAISE(raiser, Error::init(reader->error_));
+    }
+    return count;
+}
+
+extern "C" runtime::Integer jsonReaderDictionary(Reader *reader, runtime::Raiser *raiser) {
+    size_t count;
+    if (!reader->begin(Reader::Kind::Object, &count)) {
+        EJC_RAISE(raiser, Error::init(reader->error_));
+    }
+    return count;
+}
+
+extern "C" void jsonReaderFields(Reader *reader, runtime::Integer fields, runtime::Raiser *raiser) {
+    if (!reader->beginFields()) {
+        EJC_RAISE_VOID(raiser, Error::init(reader->error_));
+    }
+}
+
+extern "C" void jsonReaderKey(Reader *reader, String *name) {
+    reader->find(name->bytes(), name->count);
+}
+
+extern "C" runtime::Boolean jsonReaderNull(Reader *reader) {
+    return reader->readNull();
+}
+
+extern "C" void jsonReaderEnd(Reader *reader) {
+    reader->end();
+}
+
+extern "C" void jsonReaderDestruct(Reader *reader) {
+    reader->~Reader();
+}
+
+}  // namespace json
+
+SET_INFO_FOR(json::Writer, json, 1f58b)
+SET_INFO_FOR(json::Reader, json, 1f516)
@@ -0,0 +1,323 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "Scanner.h"
+#include "../s/Data.h"
+#include <algorithm>
+#include <vector>
+
+namespace json {
+
+/// The kinds of events returned by 🌊 in the order of the values of 🎐.
+enum class Event : runtime::Enum {
+    BeginArray, BeginObject, End, Key, String, Integer, Real, Boolean, Null, NeedsInput, EndOfInput,
+};
+
+/// Reads JSON texts from chunks of input for 🌊 and returns the values as events. Only the bytes of the token that is
+/// being read and the kinds of the enclosing arrays and objects are kept, so that the memory used does not depend on
+/// the size of the texts. Any number of texts separated by whitespace, as in newline-delimited JSON, can be read.
+class EventReader : public runtime::Object<EventReader> {
+public:
+    void feed(const char *bytes, size_t count) {
+        if (position_ > 0) {
+            buffer_.erase(0, position_);
+            scanned_ -= std::min(scanned_, position_);
+            position_ = 0;
+        }
+        buffer_.append(bytes, count);
+    }
+
+    void finish() {
+        finished_ = true;
+    }
+
+    /// Reads the next event. Returns false and stores a description of the problem in `error_` if the input is not
+    /// valid JSON.
+    bool next(Event *event) {
+        while (true) {
+            if (!read(event)) return false;
+            if (!skipping_ || *event == Event::NeedsInput || *event == Event::EndOfInput) return true;
+            // A value or the end of an array or object at the depth at which skipping began completes the skipped
+            // value.
+            if (stack_.size() == skipDepth_ && *event != Event::BeginArray && *event != Event::BeginObject &&
+                *event != Event::Key) {
+                skipping_ = false;
+            }
+        }
+    }
+
+    /// Skips the value of the key returned last or the remainder of the array or object begun last.
+    void skip() {
+        if (last_ == Event::Key) {
+            skipDepth_ = stack_.size();
+            skipping_ = true;
+        }
+        else if ((last_ == Event::BeginArray || last_ == Event::BeginObject) && !stack_.empty()) {
+            skipDepth_ = stack_.size() - 1;
+            skipping_ = true;
+        }
+    }
+
+    size_t depth() const { return stack_.size(); }
+    /// Whether the event returned last was a key.
+    bool atKey() const { return last_ == Event::Key; }
+
+    std::string string_;
+    int64_t integer_ = 0;
+    double real_ = 0;
+    bool boolean_ = false;
+    const char *error_ = nullptr;
+
+private:
+    enum class State { Document, Value, ValueOrEnd, Key, KeyOrEnd, Colon, CommaOrEnd };
+
+    bool fail(const char *error) {
+        error_ = error;
+        return false;
+    }
+
+    static bool isNumberByte(uint8_t c) {
+        return isDigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+    }
+
+    /// Reads the next event, including the events of skipped values.
+    bool read(Event *event) {
+        while (true) {
+            while (position_ < buffer_.size() && isWhitespace(static_cast<uint8_t>(buffer_[position_]))) {
+                position_++;
+            }
+            if (position_ == buffer_.size()) {
+                if (!finished_) return emit(Event::NeedsInput, event);
+                if (state_ == State::Document) return emit(Event::EndOfInput, event);
+                return fail("Unexpected end of input.");
+            }
+
+            auto byte = buffer_[position_];
+            switch (state_) {
+                case State::Colon:
+                    if (byte != ':') return fail("Invalid JSON.");
+                    position_++;
+                    state_ = State::Value;
+                    continue;
+                case State::CommaOrEnd:
+                    if (byte == ',') {
+                        position_++;
+                        state_ = stack_.back() == Event::BeginArray ? State::Value : State::Key;
+                        continue;
+                    }
+                    if (byte != (stack_.back() == Event::BeginArray ? ']' : '}')) {
+                        return fail(stack_.back() == Event::BeginArray ? "Expected ]." : "Expected }.");
+                    }
+                    return end(event);
+                case State::KeyOrEnd:
+                    if (byte == '}') return end(event);
+                    // fallthrough
+                case State::Key: {
+                    if (byte != '"') return fail("Invalid JSON.");
+                    bool complete;
+                    if (!readString(&complete)) return false;
+                    if (!complete) return emit(Event::NeedsInput, event);
+                    state_ = State::Colon;
+                    return emit(Event::Key, event);
+                }
+                case State::ValueOrEnd:
+                    if (byte == ']') return end(event);
+                    // fallthrough
+                case State::Value:
+                case State::Document:
+                    return readValue(byte, event);
+            }
+        }
+    }
+
+    bool readValue(char byte, Event *event) {
+        switch (byte) {
+            case '[':
+            case '{':
+                position_++;
+                stack_.push_back(byte == '[' ? Event::BeginArray : Event::BeginObject);
+                state_ = byte == '[' ? State::ValueOrEnd : State::KeyOrEnd;
+                return emit(stack_.back(), event);
+            case '"': {
+                bool complete;
+                if (!readString(&complete)) return false;
+                if (!complete) return emit(Event::NeedsInput, event);
+                return value(Event::String, event);
+            }
+            case 't':
+            case 'f':
+            case 'n': {
+                auto literal = byte == 't' ? "true" : byte == 'f' ? "false" : "null";
+                auto length = std::strlen(literal);
+                if (buffer_.size() - position_ < length) {
+                    if (!finished_) return emit(Event::NeedsInput, event);
+                    return fail("Unexpected end of input.");
+                }
+                if (buffer_.compare(position_, length, literal) != 0) return fail("Invalid JSON.");
+                position_ += length;
+                boolean_ = byte == 't';
+                return value(byte == 'n' ? Event::Null : Event::Boolean, event);
+            }
+            default:
+                if (byte != '-' && !isDigit(static_cast<uint8_t>(byte))) return fail("Invalid JSON.");
+                return readNumber(event);
+        }
+    }
+
+    /// Reads the number at the current position once its end is part of the input.
+    bool readNumber(Event *event) {
+        auto end = position_;
+        while (end < buffer_.size() && isNumberByte(static_cast<uint8_t>(buffer_[end]))) {
+            end++;
+        }
+        if (end == buffer_.size() && !finished_) return emit(Event::NeedsInput, event);
+        if (skipping_) {
+            position_ = end;
+            return value(Event::Real, event);
+        }
+        Scanner scanner(buffer_.data() + position_, end - position_);
+        scanner.index_ = 1;
+        bool isInteger;
+        if (!scanner.readNumber(&isInteger)) return fail(scanner.error_);
+        if (scanner.index_ != end - position_) return fail("Invalid JSON.");
+        position_ = end;
+        integer_ = scanner.integer_;
+        real_ = scanner.real_;
+        return value(isInteger ? Event::Integer : Event::Real, event);
+    }
+
+    /// Reads the string at the current position into string_ once its closing `"` is part of the input. The bytes of
+    /// strings that are skipped are not decoded.
+    bool readString(bool *complete) {
+        // Finds the closing quote eight bytes at a time, resuming where the last attempt ran out of input.
+        auto index = std::max(position_ + 1, scanned_);
+        auto bytes = reinterpret_cast<const uint8_t *>(buffer_.data());
+        *complete = false;
+        while (true) {
+            while (index + 8 <= buffer_.size()) {
+                uint64_t word;
+                std::memcpy(&word, bytes + index, sizeof(word));
+                if ((matches(word, '"') | matches(word, '\\')) != 0) break;
+                index += 8;
+            }
+            while (index < buffer_.size() && bytes[index] != '"' && bytes[index] != '\\') {
+                index++;
+            }
+            if (index + 1 >= buffer_.size() && (index == buffer_.size() || bytes[index] == '\\')) {
+                scanned_ = index;
+                if (finished_) return fail("Unexpected end of input.");
+                return true;
+            }
+            if (bytes[index] == '"') break;
+            index += 2;
+        }
+        scanned_ = 0;
+        *complete = true;
+        if (skipping_) {
+            position_ = index + 1;
+            return true;
+        }
+        Scanner scanner(buffer_.data() + position_ + 1, index - position_);
+        const char *string;
+        size_t count;
+        if (!scanner.readString(&string, &count)) return fail(scanner.error_);
+        string_.assign(string, count);
+        position_ = index + 1;
+        return true;
+    }
+
+    /// Consumes the `]` or `}` at the current position.
+    bool end(Event *event) {
+        position_++;
+        stack_.pop_back();
+        return value(Event::End, event);
+    }
+
+    /// Returns the event of a value that was read completely.
+    bool value(Event kind, Event *event) {
+        state_ = stack_.empty() ? State::Document : State::CommaOrEnd;
+        return emit(kind, event);
+    }
+
+    bool emit(Event kind, Event *event) {
+        if (kind != Event::NeedsInput) {
+            last_ = kind;
+        }
+        *event = kind;
+        return true;
+    }
+
+    /// The unconsumed input. The bytes before position_ are discarded when more input is fed.
+    std::string buffer_;
+    size_t position_ = 0;
+    /// The index up to which the string at position_ was searched for its end.
+    size_t scanned_ = 0;
+    bool finished_ = false;
+    State state_ = State::Document;
+    /// The kinds of the enclosing arrays and objects, as BeginArray and BeginObject.
+    std::vector<Event> stack_;
+    Event last_ = Event::EndOfInput;
+    bool skipping_ = false;
+    /// The depth to which skipping returns.
+    size_t skipDepth_ = 0;
+};
+
+extern "C" EventReader* jsonEventReaderNew() {
+    return EventReader::init();
+}
+
+extern "C" void jsonEventReaderFeed(EventReader *reader, s::Data *data) {
+    reader->feed(reinterpret_cast<const char *>(data->bytes()), data->count);
+}
+
+extern "C" void jsonEventReaderFeedText(EventReader *reader, String *text) {
+    reader->feed(text->bytes(), text->count);
+}
+
+extern "C" void jsonEventReaderFinish(EventReader *reader) {
+    reader->finish();
+}
+
+extern "C" Event jsonEventReaderNext(EventReader *reader, runtime::Raiser *raiser) {
+    Event event;
+    if (!reader->next(&event)) {
+        EJC_RAISE(raiser, Error::init(reader->error_));
+    }
+    return event;
+}
+
+extern "C" void jsonEventReaderSkip(EventReader *reader) {
+    reader->skip();
+}
+
+extern "C" String* jsonEventReaderString(EventReader *reader) {
+    if (reader->atKey()) {
+        return String::internKey(reader->string_.data(), reader->string_.size());
+    }
+    return String::copy(reader->string_.data(), reader->string_.size());
+}
+
+extern "C" runtime::Integer jsonEventReaderInteger(EventReader *reader) {
+    return reader->integer_;
+}
+
+extern "C" runtime::Real jsonEventReaderReal(EventReader *reader) {
+    return reader->real_;
+}
+
+extern "C" runtime::Boolean jsonEventReaderBoolean(EventReader *reader) {
+    return reader->boolean_;
+}
+
+extern "C" runtime::Integer jsonEventReaderDepth(EventReader *reader) {
+    return reader->depth();
+}
+
+extern "C" void jsonEventReaderDestruct(EventReader *reader) {
+    reader->~EventReader();
+}
+
+}  // namespace json
+
+SET_INFO_FOR(json::EventReader, json, 1f30a)
@@ -0,0 +1,90 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "Scanner.h"
+#include "../s/Data.h"
+
+namespace json {
+
+extern "C" Scanner* jsonScannerNew(String *string) {
+    return Scanner::init(string->characters, string->bytes(), string->count);
+}
+
+extern "C" Scanner* jsonScannerNewData(s::Data *data) {
+    return Scanner::init(data->data, data->bytes(), data->count);
+}
+
+extern "C" runtime::Integer jsonScannerNext(Scanner *scanner, runtime::Raiser *raiser) {
+    if (!scanner->skipWhitespace()) {
+        EJC_RAISE(raiser, Error::init(scanner->error_));
+    }
+    return scanner->bytes()[scanner->index_++];
+}
+
+extern "C" runtime::Integer jsonScannerPeek(Scanner *scanner, runtime::Raiser *raiser) {
+    if (!scanner->skipWhitespace()) {
+        EJC_RAISE(raiser, Error::init(scanner->error_));
+    }
+    return scanner->bytes()[scanner->index_];
+}
+
+extern "C" void jsonScannerExpectByte(Scanner *scanner, runtime::Integer byte, runtime::Raiser *raiser) {
+    if (!scanner->skipWhitespace()) {
+        EJC_RAISE_VOID(raiser, Error::init(scanner->error_));
+    }
+    if (scanner->bytes()[scanner->index_++] != byte) {
+        EJC_RAISE_VOID(raiser, Error::init("Invalid JSON."));
+    }
+}
+
+extern "C" void jsonScannerExpect(Scanner *scanner, String *rest, runtime::Raiser *raiser) {
+    if (!scanner->expect(rest->bytes(), rest->count)) {
+        EJC_RAISE_VOID(raiser, Error::init(scanner->error_));
+    }
+}
+
+extern "C" String* jsonScannerString(Scanner *scanner, runtime::Raiser *raiser) {
+    const char *bytes;
+    size_t count;
+    if (!scanner->readString(&bytes, &count)) {
+        EJC_RAISE(raiser, Error::init(scanner->error_));
+    }
+    return String::copy(bytes, count);
+}
+
+extern "C" String* jsonScannerKey(Scanner *scanner, runtime::Raiser *raiser) {
+    const char *bytes;
+    size_t count;
+    if (!scanner->readString(&bytes, &count)) {
+        EJC_RAISE(raiser, Error::init(scanner->error_));
+    }
+    return String::internKey(bytes, count);
+}
+
+extern "C" runtime::Boolean jsonScannerNumber(Scanner *scanner, runtime::Raiser *raiser) {
+    bool isInteger;
+    if (!scanner->readNumber(&isInteger)) {
+        EJC_RAISE(raiser, Error::init(scanner->error_));
+    }
+    return isInteger;
+}
+
+extern "C" runtime::Integer jsonScannerInteger(Scanner *scanner) {
+    return scanner->integer_;
+}
+
+extern "C" runtime::Real jsonScannerReal(Scanner *scanner) {
+    return scanner->real_;
+}
+
+extern "C" runtime::Boolean jsonScannerAtEnd(Scanner *scanner) {
+    return !scanner->skipWhitespace();
+}
+
+extern "C" void jsonScannerDestruct(Scanner *scanner) {
+    scanner->close();
+    scanner->~Scanner();
+}
+
+}  // namespace json
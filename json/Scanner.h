@@ -0,0 +1,331 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#ifndef EMOJICODE_JSON_SCANNER_H
+#define EMOJICODE_JSON_SCANNER_H
+
+#include "../runtime/Runtime.h"
+#include "../s/String.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace json {
+
+using s::String;
+
+/// 🚧🔸🌸, which has the same layout as 🚧.
+class Error : public runtime::Object<Error> {
+public:
+    explicit Error(const char *message) : message(String::init(message)) {}
+
+private:
+    String *message;
+    runtime::SimpleOptional<String*> location = runtime::NoValue;
+};
+
+constexpr uint64_t kOnes = 0x0101010101010101ull;
+constexpr uint64_t kHighBits = 0x8080808080808080ull;
+
+/// Returns a word in which the high bit of every byte of *word* that equals *byte* is set. Bits above the first match
+/// may be set spuriously, so that only the lowest set bit is reliable.
+inline uint64_t matches(uint64_t word, uint8_t byte) {
+    auto x = word ^ (kOnes * byte);
+    return (x - kOnes) & ~x & kHighBits;
+}
+
+/// The powers of ten that can be represented exactly by a double.
+constexpr double kExactPowers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13,
+                                    1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+inline bool isDigit(uint8_t c) {
+    return static_cast<unsigned>(c - '0') < 10;
+}
+
+inline bool isWhitespace(uint8_t c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+inline int hexValue(uint8_t c) {
+    if (isDigit(c)) return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+inline void appendUtf8(std::string *string, uint32_t codePoint) {
+    if (codePoint < 0x80) {
+        string->push_back(static_cast<char>(codePoint));
+    }
+    else if (codePoint < 0x800) {
+        string->push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+        string->push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else if (codePoint < 0x10000) {
+        string->push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+        string->push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        string->push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else {
+        string->push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+        string->push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        string->push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        string->push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+/// Reads the bytes of a JSON text for 🌸. The bytes are inspected eight at a time wherever runs of bytes are skipped:
+/// whitespace, the characters of strings and the digits of numbers. On failure the methods return false and store a
+/// description of the problem in `error_`.
+class Scanner : public runtime::Object<Scanner> {
+public:
+    Scanner(runtime::MemoryPointer<char> memory, const char *bytes, size_t count)
+        : memory_(memory), bytes_(reinterpret_cast<const uint8_t *>(bytes)), count_(count), retained_(count > 0) {
+        if (retained_) {
+            memory_.retain();
+        }
+    }
+
+    /// Creates a scanner reading *bytes*, which must outlive it.
+    Scanner(const char *bytes, size_t count) : bytes_(reinterpret_cast<const uint8_t *>(bytes)), count_(count) {}
+
+    /// Skips whitespace and returns false if the input ended.
+    bool skipWhitespace() {
+        while (index_ + 8 <= count_) {
+            uint64_t word;
+            std::memcpy(&word, bytes_ + index_, sizeof(word));
+            if (word != kOnes * ' ') break;
+            index_ += 8;
+        }
+        while (index_ < count_ && isWhitespace(bytes_[index_])) {
+            index_++;
+        }
+        return index_ < count_ || fail("Unexpected end of input.");
+    }
+
+    /// Compares the bytes after the current position with *rest* and consumes them.
+    bool expect(const char *rest, size_t count) {
+        if (count_ - index_ < count || std::memcmp(bytes_ + index_, rest, count) != 0) {
+            return fail("Invalid JSON.");
+        }
+        index_ += count;
+        return true;
+    }
+
+    /// Reads a string whose opening `"` has been consumed. Unless the string contains escape sequences, its bytes are
+    /// located in one pass and copied at once.
+    bool readString(const char **bytes, size_t *count) {
+        auto start = index_;
+        if (!findQuoteOrEscape()) return false;
+        if (bytes_[index_] == '"') {
+            *bytes = reinterpret_cast<const char *>(bytes_ + start);
+            *count = index_ - start;
+            index_++;
+            return true;
+        }
+
+        buffer_.assign(reinterpret_cast<const char *>(bytes_ + start), index_ - start);
+        while (true) {
+            if (bytes_[index_] == '"') {
+                index_++;
+                *bytes = buffer_.data();
+                *count = buffer_.size();
+                return true;
+            }
+            index_++;  // The backslash
+            if (index_ == count_) return fail("Unexpected end of input.");
+            switch (bytes_[index_++]) {
+                case '"': buffer_.push_back('"'); break;
+                case '\\': buffer_.push_back('\\'); break;
+                case '/': buffer_.push_back('/'); break;
+                case 'b': buffer_.push_back('\b'); break;
+                case 'f': buffer_.push_back('\f'); break;
+                case 'n': buffer_.push_back('\n'); break;
+                case 'r': buffer_.push_back('\r'); break;
+                case 't': buffer_.push_back('\t'); break;
+                case 'u': {
+                    uint32_t codePoint;
+                    if (!readUnicodeEscape(&codePoint)) return false;
+                    appendUtf8(&buffer_, codePoint);
+                    break;
+                }
+                default:
+                    return fail("Unrecognized escape sequence.");
+            }
+            auto run = index_;
+            if (!findQuoteOrEscape()) return false;
+            buffer_.append(reinterpret_cast<const char *>(bytes_ + run), index_ - run);
+        }
+    }
+
+    /// Reads a number whose first character, a digit or `-`, has been consumed and stores it in `integer_` if it
+    /// consists of an integer part only and fits into 🔢, and in `real_` otherwise.
+    bool readNumber(bool *isInteger) {
+        auto start = --index_;
+        auto negative = bytes_[index_] == '-';
+        if (negative) index_++;
+
+        uint64_t mantissa = 0;
+        int digits = 0;
+        if (!readDigits(&mantissa, &digits) || (digits > 1 && bytes_[index_ - digits] == '0')) {
+            return fail("Invalid JSON.");
+        }
+        auto exponent = 0;
+        auto isReal = false;
+        if (index_ < count_ && bytes_[index_] == '.') {
+            index_++;
+            auto integerDigits = digits;
+            if (!readDigits(&mantissa, &digits)) return fail("Expected digit after decimal point");
+            exponent -= digits - integerDigits;
+            isReal = true;
+        }
+        if (index_ < count_ && (bytes_[index_] == 'e' || bytes_[index_] == 'E')) {
+            index_++;
+            auto negativeExponent = false;
+            if (index_ < count_ && (bytes_[index_] == '-' || bytes_[index_] == '+')) {
+                negativeExponent = bytes_[index_++] == '-';
+            }
+            uint64_t value = 0;
+            int exponentDigits = 0;
+            if (!readDigits(&value, &exponentDigits)) return fail("Expected digit in exponent");
+            if (exponentDigits > 4) value = 10000;
+            exponent += negativeExponent ? -static_cast<int>(value) : static_cast<int>(value);
+            isReal = true;
+        }
+
+        if (!isReal && digits <= 19 && mantissa <= (negative ? 0x8000000000000000ull : INT64_MAX)) {
+            integer_ = negative ? static_cast<int64_t>(0 - mantissa) : static_cast<int64_t>(mantissa);
+            *isInteger = true;
+            return true;
+        }
+        *isInteger = false;
+        // The mantissa and the power of ten are exact, so is their product or quotient. Other numbers are left to
+        // strtod, which rounds correctly.
+        if (digits <= 19 && mantissa <= (1ull << 53) && exponent >= -22 && exponent <= 22) {
+            auto value = static_cast<double>(mantissa);
+            value = exponent < 0 ? value / kExactPowers[-exponent] : value * kExactPowers[exponent];
+            real_ = negative ? -value : value;
+            return true;
+        }
+        buffer_.assign(reinterpret_cast<const char *>(bytes_ + start), index_ - start);
+        real_ = std::strtod(buffer_.c_str(), nullptr);
+        return true;
+    }
+
+    bool fail(const char *error) {
+        error_ = error;
+        return false;
+    }
+
+    void close() {
+        if (retained_) {
+            memory_.release();
+            retained_ = false;
+        }
+        count_ = 0;
+    }
+
+    const uint8_t* bytes() const { return bytes_; }
+
+    size_t index_ = 0;
+    int64_t integer_ = 0;
+    double real_ = 0;
+    const char *error_ = nullptr;
+
+private:
+    /// Advances to the next `"` or `\`.
+    bool findQuoteOrEscape() {
+        while (index_ + 8 <= count_) {
+            uint64_t word;
+            std::memcpy(&word, bytes_ + index_, sizeof(word));
+            if ((matches(word, '"') | matches(word, '\\')) != 0) break;
+            index_ += 8;
+        }
+        while (index_ < count_) {
+            if (bytes_[index_] == '"' || bytes_[index_] == '\\') return true;
+            index_++;
+        }
+        return fail("Unexpected end of input.");
+    }
+
+    /// Reads the four hexadecimal digits after `\u` and, if they denote a high surrogate, the low surrogate that must
+    /// follow as another `\u` escape.
+    bool readUnicodeEscape(uint32_t *codePoint) {
+        if (!readHex(codePoint)) return false;
+        if (*codePoint >= 0xDC00 && *codePoint <= 0xDFFF) {
+            return fail("\\u sequence is a low surrogate without a preceding high surrogate");
+        }
+        if (*codePoint < 0xD800 || *codePoint > 0xDBFF) return true;
+        uint32_t low;
+        if (count_ - index_ < 2 || bytes_[index_] != '\\' || bytes_[index_ + 1] != 'u') {
+            return fail("\\u sequence is begin of surrogate pair but not followed by another \\u sequence");
+        }
+        index_ += 2;
+        if (!readHex(&low)) return false;
+        if (low < 0xDC00 || low > 0xDFFF) {
+            return fail("\\u sequence is begin of surrogate pair but not followed by a low surrogate");
+        }
+        *codePoint = ((*codePoint - 0xD800) << 10) + (low - 0xDC00) + 0x10000;
+        return true;
+    }
+
+    bool readHex(uint32_t *value) {
+        if (count_ - index_ < 4) return fail("Unexpected end of input.");
+        *value = 0;
+        for (int i = 0; i < 4; i++) {
+            auto digit = hexValue(bytes_[index_++]);
+            if (digit < 0) return fail("\\u must be followed by four characters in range 0-9, A-F, a-f");
+            *value = *value * 16 + digit;
+        }
+        return true;
+    }
+
+    /// Appends the digits at the current position to *value* and adds their number to *digits*. Digits that would
+    /// overflow *value* are counted but otherwise ignored. Returns false if there is no digit.
+    bool readDigits(uint64_t *value, int *digits) {
+        auto start = index_;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        while (*digits <= 11 && index_ + 8 <= count_) {
+            uint64_t word;
+            std::memcpy(&word, bytes_ + index_, sizeof(word));
+            if (((word & 0xF0F0F0F0F0F0F0F0ull) | (((word + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4))
+                != 0x3333333333333333ull) {
+                break;
+            }
+            // Combines adjacent digits into numbers of two, four and finally eight digits.
+            word -= 0x3030303030303030ull;
+            word = (word * 10 + (word >> 8)) & 0x00FF00FF00FF00FFull;
+            word = (word * 100 + (word >> 16)) & 0x0000FFFF0000FFFFull;
+            word = (word * 10000 + (word >> 32)) & 0x00000000FFFFFFFFull;
+            *value = *value * 100000000 + word;
+            *digits += 8;
+            index_ += 8;
+        }
+#endif
+        while (index_ < count_ && isDigit(bytes_[index_])) {
+            if (*digits < 19) {
+                *value = *value * 10 + (bytes_[index_] - '0');
+            }
+            (*digits)++;
+            index_++;
+        }
+        return index_ > start;
+    }
+
+    runtime::MemoryPointer<char> memory_;
+    const uint8_t *bytes_;
+    size_t count_;
+    /// Whether memory_ was retained and must be released by close().
+    bool retained_ = false;
+    /// Holds strings with escape sequences while they are decoded and numbers that are passed to strtod.
+    std::string buffer_;
+};
+
+}  // namespace json
+
+SET_INFO_FOR(json::Error, json, 1f6a7_1f538_1f338)
+SET_INFO_FOR(json::Scanner, json, 1f526)
+
+#endif  // EMOJICODE_JSON_SCANNER_H
@@ -0,0 +1,379 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "Metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+namespace metrics {
+
+size_t shardIndex() {
+    static std::atomic<size_t> next{0};
+    // Trivially initialized, so that accessing it does not require a guard.
+    static thread_local size_t index = kShards;
+    if (index == kShards) {
+        index = next.fetch_add(1, std::memory_order_relaxed) % kShards;
+    }
+    return index;
+}
+
+int64_t Counter::value() const {
+    int64_t value = 0;
+    for (auto &cell : cells_) {
+        value += cell.value.load(std::memory_order_relaxed);
+    }
+    return value;
+}
+
+void Gauge::set(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    bits_.store(bits, std::memory_order_relaxed);
+}
+
+void Gauge::add(double amount) {
+    auto bits = bits_.load(std::memory_order_relaxed);
+    uint64_t newBits;
+    do {
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        value += amount;
+        std::memcpy(&newBits, &value, sizeof(newBits));
+    } while (!bits_.compare_exchange_weak(bits, newBits, std::memory_order_relaxed));
+}
+
+double Gauge::value() const {
+    auto bits = bits_.load(std::memory_order_relaxed);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+Histogram::~Histogram() {
+    for (auto &slot : shards_) {
+        delete slot.load(std::memory_order_relaxed);
+    }
+}
+
+Histogram::Shard& Histogram::createShard(std::atomic<Shard *> &slot) {
+    auto shard = new Shard();
+    Shard *expected = nullptr;
+    if (!slot.compare_exchange_strong(expected, shard, std::memory_order_acq_rel)) {
+        // Another thread with the same shard index was faster.
+        delete shard;
+        return *expected;
+    }
+    return *shard;
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+    Snapshot snapshot;
+    snapshot.buckets.resize(kBuckets);
+    for (auto &slot : shards_) {
+        auto shard = slot.load(std::memory_order_acquire);
+        if (shard == nullptr) continue;
+        snapshot.sum += shard->sum.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < kBuckets; i++) {
+            auto count = shard->buckets[i].load(std::memory_order_relaxed);
+            snapshot.buckets[i] += count;
+            snapshot.count += count;
+        }
+    }
+    return snapshot;
+}
+
+uint64_t Histogram::lowestValueOf(size_t bucket) {
+    if (bucket < (size_t(2) << kSubBucketBits)) {
+        return bucket;
+    }
+    auto shift = (bucket >> kSubBucketBits) - 1;
+    return static_cast<uint64_t>(bucket - (shift << kSubBucketBits)) << shift;
+}
+
+uint64_t Histogram::highestValueOf(size_t bucket) {
+    if (bucket < (size_t(2) << kSubBucketBits)) {
+        return bucket;
+    }
+    auto shift = (bucket >> kSubBucketBits) - 1;
+    return lowestValueOf(bucket) + ((UINT64_C(1) << shift) - 1);
+}
+
+uint64_t Histogram::Snapshot::quantile(double quantile) const {
+    if (count == 0) {
+        return 0;
+    }
+    auto rank = static_cast<uint64_t>(std::ceil(std::min(std::max(quantile, 0.0), 1.0) * count));
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return highestValueOf(i);
+        }
+    }
+    return highestValueOf(buckets.size() - 1);
+}
+
+Registry::~Registry() {
+    for (auto &entry : entries_) {
+        switch (entry.kind) {
+            case Kind::Counter:
+                static_cast<Counter *>(entry.metric)->release();
+                break;
+            case Kind::Gauge:
+                static_cast<Gauge *>(entry.metric)->release();
+                break;
+            case Kind::Histogram:
+                static_cast<Histogram *>(entry.metric)->release();
+                break;
+        }
+    }
+}
+
+void Registry::add(Counter *counter, String *name, String *labels, String *help) {
+    counter->retain();
+    add(Kind::Counter, counter, name, labels, help);
+}
+
+void Registry::add(Gauge *gauge, String *name, String *labels, String *help) {
+    gauge->retain();
+    add(Kind::Gauge, gauge, name, labels, help);
+}
+
+void Registry::add(Histogram *histogram, String *name, String *labels, String *help) {
+    histogram->retain();
+    add(Kind::Histogram, histogram, name, labels, help);
+}
+
+void Registry::add(Kind kind, void *metric, String *name, String *labels, String *help) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.emplace_back(Entry{ kind, metric, name->stdString(), labels != nullptr ? labels->stdString() : "",
+                                 help->stdString() });
+}
+
+namespace {
+
+/// The upper bounds of the buckets in the exposition of a histogram in nanoseconds and as they are written in
+/// seconds, which are the default buckets of the Prometheus client libraries extended to a microsecond.
+constexpr std::pair<uint64_t, const char *> kExposedBuckets[] = {
+    { 1000, "1e-06" }, { 2500, "2.5e-06" }, { 5000, "5e-06" }, { 10000, "1e-05" }, { 25000, "2.5e-05" },
+    { 50000, "5e-05" }, { 100000, "0.0001" }, { 250000, "0.00025" }, { 500000, "0.0005" }, { 1000000, "0.001" },
+    { 2500000, "0.0025" }, { 5000000, "0.005" }, { 10000000, "0.01" }, { 25000000, "0.025" },
+    { 50000000, "0.05" }, { 100000000, "0.1" }, { 250000000, "0.25" }, { 500000000, "0.5" },
+    { 1000000000, "1" }, { 2500000000, "2.5" }, { 5000000000, "5" }, { 10000000000, "10" },
+};
+
+std::string formatReal(double value) {
+    if (std::isnan(value)) return "NaN";
+    if (std::isinf(value)) return value > 0 ? "+Inf" : "-Inf";
+    // Uses the shortest of the two precisions that preserves the value, so that 0.1 is not written with 17 digits.
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+    if (std::strtod(buffer, nullptr) != value) {
+        std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+    }
+    return buffer;
+}
+
+/// Appends *name* followed by *labels* and *extra*, which are both written without braces, and the value.
+void appendSample(std::string *text, const std::string &name, const std::string &labels, const std::string &extra,
+                  const std::string &value) {
+    text->append(name);
+    if (!labels.empty() || !extra.empty()) {
+        text->push_back('{');
+        text->append(labels);
+        if (!labels.empty() && !extra.empty()) {
+            text->push_back(',');
+        }
+        text->append(extra);
+        text->push_back('}');
+    }
+    text->push_back(' ');
+    text->append(value);
+    text->push_back('\n');
+}
+
+void appendHelp(std::string *text, const std::string &help) {
+    for (auto c : help) {
+        if (c == '\\') text->append("\\\\");
+        else if (c == '\n') text->append("\\n");
+        else text->push_back(c);
+    }
+}
+
+}  // namespace
+
+std::string Registry::exposition() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string text;
+    std::vector<bool> written(entries_.size(), false);
+    for (size_t i = 0; i < entries_.size(); i++) {
+        if (written[i]) continue;
+        auto &first = entries_[i];
+        text.append("# HELP ").append(first.name).push_back(' ');
+        appendHelp(&text, first.help);
+        text.append("\n# TYPE ").append(first.name);
+        switch (first.kind) {
+            case Kind::Counter:
+                text.append(" counter\n");
+                break;
+            case Kind::Gauge:
+                text.append(" gauge\n");
+                break;
+            case Kind::Histogram:
+                text.append(" histogram\n");
+                break;
+        }
+
+        // All samples of a metric must follow its HELP and TYPE lines.
+        for (size_t j = i; j < entries_.size(); j++) {
+            auto &entry = entries_[j];
+            if (written[j] || entry.name != first.name) continue;
+            written[j] = true;
+            switch (entry.kind) {
+                case Kind::Counter:
+                    appendSample(&text, entry.name, entry.labels, "",
+                                 std::to_string(static_cast<Counter *>(entry.metric)->value()));
+                    break;
+                case Kind::Gauge:
+                    appendSample(&text, entry.name, entry.labels, "",
+                                 formatReal(static_cast<Gauge *>(entry.metric)->value()));
+                    break;
+                case Kind::Histogram: {
+                    auto snapshot = static_cast<Histogram *>(entry.metric)->snapshot();
+                    uint64_t cumulative = 0;
+                    size_t bucket = 0;
+                    for (auto &bound : kExposedBuckets) {
+                        for (; bucket < snapshot.buckets.size() &&
+                               Histogram::lowestValueOf(bucket) <= bound.first; bucket++) {
+                            cumulative += snapshot.buckets[bucket];
+                        }
+                        appendSample(&text, entry.name + "_bucket", entry.labels,
+                                     std::string("le=\"") + bound.second + "\"", std::to_string(cumulative));
+                    }
+                    appendSample(&text, entry.name + "_bucket", entry.labels, "le=\"+Inf\"",
+                                 std::to_string(snapshot.count));
+                    appendSample(&text, entry.name + "_sum", entry.labels, "",
+                                 formatReal(static_cast<double>(snapshot.sum) / 1e9));
+                    appendSample(&text, entry.name + "_count", entry.labels, "", std::to_string(snapshot.count));
+                    break;
+                }
+            }
+        }
+    }
+    return text;
+}
+
+extern "C" Counter* metricsCounterNewLabels(Registry *registry, String *name, String *labels, String *help) {
+    auto counter = Counter::init();
+    registry->add(counter, name, labels, help);
+    return counter;
+}
+
+extern "C" Counter* metricsCounterNew(Registry *registry, String *name, String *help) {
+    return metricsCounterNewLabels(registry, name, nullptr, help);
+}
+
+extern "C" void metricsCounterIncrement(Counter *counter) {
+    counter->add(1);
+}
+
+extern "C" void metricsCounterAdd(Counter *counter, runtime::Integer amount) {
+    counter->add(amount);
+}
+
+extern "C" runtime::Integer metricsCounterValue(Counter *counter) {
+    return counter->value();
+}
+
+extern "C" void metricsCounterDestruct(Counter *counter) {
+    counter->~Counter();
+}
+
+extern "C" Gauge* metricsGaugeNewLabels(Registry *registry, String *name, String *labels, String *help) {
+    auto gauge = Gauge::init();
+    registry->add(gauge, name, labels, help);
+    return gauge;
+}
+
+extern "C" Gauge* metricsGaugeNew(Registry *registry, String *name, String *help) {
+    return metricsGaugeNewLabels(registry, name, nullptr, help);
+}
+
+extern "C" void metricsGaugeSet(Gauge *gauge, runtime::Real value) {
+    gauge->set(value);
+}
+
+extern "C" void metricsGaugeAdd(Gauge *gauge, runtime::Real amount) {
+    gauge->add(amount);
+}
+
+extern "C" runtime::Real metricsGaugeValue(Gauge *gauge) {
+    return gauge->value();
+}
+
+extern "C" void metricsGaugeDestruct(Gauge *gauge) {
+    gauge->~Gauge();
+}
+
+extern "C" Histogram* metricsHistogramNewLabels(Registry *registry, String *name, String *labels, String *help) {
+    auto histogram = Histogram::init();
+    registry->add(histogram, name, labels, help);
+    return histogram;
+}
+
+extern "C" Histogram* metricsHistogramNew(Registry *registry, String *name, String *help) {
+    return metricsHistogramNewLabels(registry, name, nullptr, help);
+}
+
+extern "C" void metricsHistogramRecord(Histogram *histogram, runtime::Integer nanoseconds) {
+    histogram->record(nanoseconds);
+}
+
+extern "C" void metricsHistogramRecordSince(Histogram *histogram, runtime::Integer start) {
+    // The clock of ⏱ of 💻.
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    histogram->record(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count() - start);
+}
+
+extern "C" runtime::Integer metricsHistogramCount(Histogram *histogram) {
+    return static_cast<runtime::Integer>(histogram->snapshot().count);
+}
+
+extern "C" runtime::Integer metricsHistogramSum(Histogram *histogram) {
+    return static_cast<runtime::Integer>(histogram->snapshot().sum);
+}
+
+extern "C" runtime::Integer metricsHistogramQuantile(Histogram *histogram, runtime::Real quantile) {
+    return static_cast<runtime::Integer>(histogram->snapshot().quantile(quantile));
+}
+
+extern "C" void metricsHistogramDestruct(Histogram *histogram) {
+    histogram->~Histogram();
+}
+
+extern "C" Registry* metricsRegistryNew() {
+    return Registry::init();
+}
+
+extern "C" Registry* metricsRegistryShared(runtime::ClassInfo *) {
+    static Registry *registry = Registry::initStatic();
+    return registry;
+}
+
+extern "C" String* metricsRegistryExposition(Registry *registry) {
+    auto text = registry->exposition();
+    return String::copy(text.data(), text.size());
+}
+
+extern "C" void metricsRegistryDestruct(Registry *registry) {
+    registry->~Registry();
+}
+
+}  // namespace metrics
@@ -0,0 +1,157 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#ifndef EMOJICODE_METRICS_METRICS_H
+#define EMOJICODE_METRICS_METRICS_H
+
+#include "../runtime/Runtime.h"
+#include "../s/String.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace metrics {
+
+using s::String;
+
+/// The number of shards into which counters and histograms are split. Threads are assigned the shards in turn, so
+/// that up to this many threads record values without contending for a cache line.
+///
+/// Values are not kept per thread and folded back when a thread exits: Every update would have to look up the
+/// calling thread's value of the metric, and reading a metric would have to visit the values of all live threads
+/// under a lock that exiting threads take as well. With the shards embedded in the metric, an update is a single
+/// relaxed fetch_add at a known address, a metric takes the same memory however many threads update it, and reading
+/// it never waits for threads starting or exiting.
+constexpr size_t kShards = 16;
+
+/// Returns the shard of the calling thread.
+size_t shardIndex();
+
+/// An atomic value that occupies a cache line of its own.
+struct Cell {
+    std::atomic<int64_t> value{0};
+    char padding[64 - sizeof(std::atomic<int64_t>)];
+};
+
+class Counter : public runtime::Object<Counter> {
+public:
+    void add(int64_t amount) { cells_[shardIndex()].value.fetch_add(amount, std::memory_order_relaxed); }
+
+    int64_t value() const;
+
+private:
+    Cell cells_[kShards];
+};
+
+class Gauge : public runtime::Object<Gauge> {
+public:
+    void set(double value);
+    void add(double amount);
+    double value() const;
+
+private:
+    /// The bits of the double value.
+    std::atomic<uint64_t> bits_{0};
+};
+
+/// A histogram of non-negative integers with buckets like those of HdrHistogram: Every power of two is split into
+/// 2^kSubBucketBits buckets of equal width, so that any value is known to within about 3 % while the buckets of a
+/// shard take up a fixed 15 KiB for the whole range of 64-bit integers.
+class Histogram : public runtime::Object<Histogram> {
+public:
+    static constexpr int kSubBucketBits = 5;
+    static constexpr size_t kBuckets = (64 - kSubBucketBits + 1) << kSubBucketBits;
+
+    ~Histogram();
+
+    void record(int64_t value) {
+        auto sample = static_cast<uint64_t>(value < 0 ? 0 : value);
+        auto &shard = this->shard();
+        shard.buckets[bucketOf(sample)].fetch_add(1, std::memory_order_relaxed);
+        shard.sum.fetch_add(sample, std::memory_order_relaxed);
+    }
+
+    /// The counts of all buckets and the sum of all values recorded up to the moment of the call.
+    struct Snapshot {
+        std::vector<uint64_t> buckets;
+        uint64_t count = 0;
+        uint64_t sum = 0;
+
+        /// Returns the largest value that is equivalent to the value below which *quantile* of all values lie.
+        uint64_t quantile(double quantile) const;
+    };
+
+    Snapshot snapshot() const;
+
+    static size_t bucketOf(uint64_t value) {
+        if (value < (UINT64_C(1) << kSubBucketBits)) {
+            return static_cast<size_t>(value);
+        }
+        auto shift = 63 - __builtin_clzll(value) - kSubBucketBits;
+        return (static_cast<size_t>(shift) << kSubBucketBits) + static_cast<size_t>(value >> shift);
+    }
+
+    /// Returns the smallest value in *bucket*.
+    static uint64_t lowestValueOf(size_t bucket);
+    /// Returns the largest value in *bucket*.
+    static uint64_t highestValueOf(size_t bucket);
+
+private:
+    struct Shard {
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> buckets[kBuckets] = {};
+    };
+
+    /// Returns the shard of the calling thread, which is created when the thread records its first value.
+    Shard& shard() {
+        auto &slot = shards_[shardIndex()];
+        if (auto shard = slot.load(std::memory_order_acquire)) {
+            return *shard;
+        }
+        return createShard(slot);
+    }
+
+    Shard& createShard(std::atomic<Shard *> &slot);
+
+    std::atomic<Shard *> shards_[kShards] = {};
+};
+
+/// A set of metrics that are exposed together in the text format of Prometheus.
+class Registry : public runtime::Object<Registry> {
+public:
+    ~Registry();
+
+    void add(Counter *counter, String *name, String *labels, String *help);
+    void add(Gauge *gauge, String *name, String *labels, String *help);
+    void add(Histogram *histogram, String *name, String *labels, String *help);
+
+    std::string exposition();
+
+private:
+    enum class Kind { Counter, Gauge, Histogram };
+
+    struct Entry {
+        Kind kind;
+        void *metric;
+        std::string name;
+        std::string labels;
+        std::string help;
+    };
+
+    void add(Kind kind, void *metric, String *name, String *labels, String *help);
+
+    std::mutex mutex_;
+    std::vector<Entry> entries_;
+};
+
+}  // namespace metrics
+
+SET_INFO_FOR(metrics::Counter, metrics, 1f4c8)
+SET_INFO_FOR(metrics::Gauge, metrics, 1f50b)
+SET_INFO_FOR(metrics::Histogram, metrics, 1f4ca)
+SET_INFO_FOR(metrics::Registry, metrics, 1f4d2)
+
+#endif  // EMOJICODE_METRICS_METRICS_H
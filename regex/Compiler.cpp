@@ -0,0 +1,806 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "Regex.h"
+#include <algorithm>
+#include <utility>
+
+namespace regex {
+
+namespace {
+
+constexpr uint32_t kMaxCodePoint = 0x10FFFF;
+/// The maximum count of a repetition like {n,m}.
+constexpr int kMaxRepeat = 1000;
+/// The maximum nesting of groups and repetitions.
+constexpr int kMaxDepth = 1000;
+/// The maximum number of instructions of a program.
+constexpr size_t kMaxInsts = 1 << 20;
+
+using Ranges = std::vector<std::pair<uint32_t, uint32_t>>;
+
+/// A node of the syntax tree of a pattern.
+struct Node {
+    enum class Kind { Empty, Literal, Class, Concat, Alternate, Repeat, Group, Assert };
+
+    explicit Node(Kind kind) : kind(kind) {}
+
+    Kind kind;
+    uint32_t codePoint = 0;
+    /// The code points of a class, sorted and not overlapping.
+    Ranges ranges;
+    std::vector<std::unique_ptr<Node>> children;
+    int min = 0;
+    /// The maximum count of a repetition or -1 if it is unbounded.
+    int max = 0;
+    bool greedy = true;
+    /// The index of a capture group or -1 if the group does not capture.
+    int group = -1;
+    Assertion assertion = Assertion::BeginText;
+};
+
+/// Sorts *ranges* and merges overlapping and adjacent ranges.
+void normalize(Ranges *ranges) {
+    std::sort(ranges->begin(), ranges->end());
+    Ranges merged;
+    for (auto &range : *ranges) {
+        if (!merged.empty() && range.first <= merged.back().second + 1) {
+            merged.back().second = std::max(merged.back().second, range.second);
+        }
+        else {
+            merged.push_back(range);
+        }
+    }
+    *ranges = std::move(merged);
+}
+
+/// Returns the code points that are not in *ranges*, which must be normalized.
+Ranges complement(const Ranges &ranges) {
+    Ranges result;
+    uint32_t next = 0;
+    for (auto &range : ranges) {
+        if (range.first > next) {
+            result.emplace_back(next, range.first - 1);
+        }
+        next = range.second + 1;
+    }
+    if (next <= kMaxCodePoint) {
+        result.emplace_back(next, kMaxCodePoint);
+    }
+    return result;
+}
+
+/// Parses a pattern into a syntax tree by recursive descent. On failure the methods return nullptr and store a
+/// description of the problem in `error_`.
+class Parser {
+public:
+    Parser(const char *pattern, size_t count) : bytes_(reinterpret_cast<const uint8_t *>(pattern)), count_(count) {}
+
+    std::unique_ptr<Node> parse() {
+        auto node = alternate(0);
+        if (node != nullptr && index_ < count_) {
+            return fail("Unmatched )");
+        }
+        return node;
+    }
+
+    /// The number of capture groups including group 0.
+    int groups_ = 1;
+    bool wordAssertions_ = false;
+    const char *error_ = nullptr;
+
+private:
+    std::unique_ptr<Node> fail(const char *error) {
+        error_ = error;
+        return nullptr;
+    }
+
+    bool atEnd() const { return index_ >= count_; }
+    uint8_t peek() const { return bytes_[index_]; }
+
+    /// Decodes the code point at the current position and consumes it. Invalid UTF-8 is read byte by byte.
+    uint32_t codePoint() {
+        auto byte = bytes_[index_++];
+        int length = byte >= 0xF0 ? 3 : byte >= 0xE0 ? 2 : byte >= 0xC0 ? 1 : 0;
+        uint32_t value = length == 0 ? byte : byte & (0x3F >> length);
+        for (int i = 0; i < length && index_ < count_ && (bytes_[index_] & 0xC0) == 0x80; i++) {
+            value = (value << 6) | (bytes_[index_++] & 0x3F);
+        }
+        return value;
+    }
+
+    std::unique_ptr<Node> alternate(int depth) {
+        if (depth > kMaxDepth) {
+            return fail("Pattern is nested too deeply");
+        }
+        auto first = concat(depth);
+        if (first == nullptr || atEnd() || peek() != '|') {
+            return first;
+        }
+        auto node = std::make_unique<Node>(Node::Kind::Alternate);
+        node->children.push_back(std::move(first));
+        while (!atEnd() && peek() == '|') {
+            index_++;
+            auto next = concat(depth);
+            if (next == nullptr) {
+                return nullptr;
+            }
+            node->children.push_back(std::move(next));
+        }
+        return node;
+    }
+
+    std::unique_ptr<Node> concat(int depth) {
+        auto node = std::make_unique<Node>(Node::Kind::Concat);
+        while (!atEnd() && peek() != '|' && peek() != ')') {
+            auto next = repeat(depth);
+            if (next == nullptr) {
+                return nullptr;
+            }
+            node->children.push_back(std::move(next));
+        }
+        if (node->children.empty()) {
+            return std::make_unique<Node>(Node::Kind::Empty);
+        }
+        if (node->children.size() == 1) {
+            return std::move(node->children.front());
+        }
+        return node;
+    }
+
+    std::unique_ptr<Node> repeat(int depth) {
+        auto node = atom(depth);
+        while (node != nullptr && !atEnd()) {
+            int min, max;
+            auto start = index_;
+            switch (peek()) {
+                case '*': min = 0; max = -1; index_++; break;
+                case '+': min = 1; max = -1; index_++; break;
+                case '?': min = 0; max = 1; index_++; break;
+                case '{':
+                    if (!counts(&min, &max)) {
+                        if (error_ != nullptr) {
+                            return nullptr;
+                        }
+                        // A { that does not begin a valid repetition is a literal.
+                        index_ = start;
+                        return node;
+                    }
+                    break;
+                default:
+                    return node;
+            }
+            if (node->kind == Node::Kind::Assert || node->kind == Node::Kind::Empty) {
+                return fail("Nothing to repeat");
+            }
+            auto repetition = std::make_unique<Node>(Node::Kind::Repeat);
+            repetition->min = min;
+            repetition->max = max;
+            if (!atEnd() && peek() == '?') {
+                repetition->greedy = false;
+                index_++;
+            }
+            repetition->children.push_back(std::move(node));
+            node = std::move(repetition);
+            if (++depth > kMaxDepth) {
+                return fail("Pattern is nested too deeply");
+            }
+        }
+        return node;
+    }
+
+    /// Reads a decimal number and returns false if there is none.
+    bool number(int *value) {
+        auto start = index_;
+        *value = 0;
+        while (!atEnd() && peek() >= '0' && peek() <= '9') {
+            *value = std::min(*value * 10 + (peek() - '0'), kMaxRepeat + 1);
+            index_++;
+        }
+        return index_ > start;
+    }
+
+    /// Reads {n}, {n,} or {n,m}. Returns false without setting `error_` if the braces do not contain counts.
+    bool counts(int *min, int *max) {
+        index_++;
+        if (!number(min)) {
+            return false;
+        }
+        *max = *min;
+        if (!atEnd() && peek() == ',') {
+            index_++;
+            if (!number(max)) {
+                *max = -1;
+            }
+        }
+        if (atEnd() || peek() != '}') {
+            return false;
+        }
+        index_++;
+        if (*min > kMaxRepeat || *max > kMaxRepeat) {
+            error_ = "Repetition count is too large";
+            return false;
+        }
+        if (*max != -1 && *max < *min) {
+            error_ = "Invalid repetition count";
+            return false;
+        }
+        return true;
+    }
+
+    std::unique_ptr<Node> atom(int depth) {
+        switch (peek()) {
+            case '(': {
+                index_++;
+                int group = -1;
+                if (index_ + 1 < count_ && peek() == '?' && bytes_[index_ + 1] == ':') {
+                    index_ += 2;
+                }
+                else if (!atEnd() && peek() == '?') {
+                    return fail("Unsupported group syntax");
+                }
+                else {
+                    group = groups_++;
+                }
+                auto content = alternate(depth + 1);
+                if (content == nullptr) {
+                    return nullptr;
+                }
+                if (atEnd() || peek() != ')') {
+                    return fail("Missing )");
+                }
+                index_++;
+                auto node = std::make_unique<Node>(Node::Kind::Group);
+                node->group = group;
+                node->children.push_back(std::move(content));
+                return node;
+            }
+            case '[':
+                index_++;
+                return characterClass();
+            case '.': {
+                index_++;
+                auto node = std::make_unique<Node>(Node::Kind::Class);
+                node->ranges = { { 0, '\n' - 1 }, { '\n' + 1, kMaxCodePoint } };
+                return node;
+            }
+            case '^':
+            case '$': {
+                auto node = std::make_unique<Node>(Node::Kind::Assert);
+                node->assertion = peek() == '^' ? Assertion::BeginText : Assertion::EndText;
+                index_++;
+                return node;
+            }
+            case '*':
+            case '+':
+            case '?':
+                return fail("Nothing to repeat");
+            case '\\':
+                return escape();
+            default: {
+                auto node = std::make_unique<Node>(Node::Kind::Literal);
+                node->codePoint = codePoint();
+                return node;
+            }
+        }
+    }
+
+    /// Adds the ranges of the class escape *letter* like d or W to *ranges* and returns false if *letter* does not
+    /// denote a class.
+    static bool classEscape(uint8_t letter, Ranges *ranges) {
+        Ranges added;
+        switch (letter | 0x20) {
+            case 'd': added = { { '0', '9' } }; break;
+            case 'w': added = { { '0', '9' }, { 'A', 'Z' }, { '_', '_' }, { 'a', 'z' } }; break;
+            case 's': added = { { '\t', '\r' }, { ' ', ' ' } }; break;
+            default: return false;
+        }
+        if (letter >= 'A' && letter <= 'Z') {
+            added = complement(added);
+        }
+        ranges->insert(ranges->end(), added.begin(), added.end());
+        return true;
+    }
+
+    /// Reads the character after a backslash that does not denote a class or assertion. Returns false if it is
+    /// invalid.
+    bool escapedCodePoint(uint32_t *value) {
+        if (atEnd()) {
+            error_ = "Trailing backslash";
+            return false;
+        }
+        auto byte = peek();
+        switch (byte) {
+            case 'n': *value = '\n'; break;
+            case 'r': *value = '\r'; break;
+            case 't': *value = '\t'; break;
+            case 'f': *value = '\f'; break;
+            case 'v': *value = '\v'; break;
+            case '0': *value = 0; break;
+            case 'x': {
+                index_++;
+                auto braced = !atEnd() && peek() == '{';
+                if (braced) index_++;
+                *value = 0;
+                int digits = 0;
+                while (!atEnd() && (braced || digits < 2) && hexValue(peek()) >= 0 && *value <= kMaxCodePoint) {
+                    *value = *value * 16 + hexValue(peek());
+                    digits++;
+                    index_++;
+                }
+                if (digits == 0 || (!braced && digits < 2) || (braced && (atEnd() || peek() != '}')) ||
+                    *value > kMaxCodePoint) {
+                    error_ = "Invalid \\x escape";
+                    return false;
+                }
+                if (braced) index_++;
+                return true;
+            }
+            default:
+                if ((byte >= 'a' && byte <= 'z') || (byte >= 'A' && byte <= 'Z') || (byte >= '0' && byte <= '9')) {
+                    error_ = "Unknown escape sequence";
+                    return false;
+                }
+                // Any other character, in particular any punctuation, stands for itself.
+                *value = codePoint();
+                return true;
+        }
+        index_++;
+        return true;
+    }
+
+    static int hexValue(uint8_t c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    std::unique_ptr<Node> escape() {
+        index_++;
+        if (!atEnd()) {
+            auto letter = peek();
+            if (letter == 'b' || letter == 'B') {
+                index_++;
+                wordAssertions_ = true;
+                auto node = std::make_unique<Node>(Node::Kind::Assert);
+                node->assertion = letter == 'b' ? Assertion::WordBoundary : Assertion::NotWordBoundary;
+                return node;
+            }
+            auto node = std::make_unique<Node>(Node::Kind::Class);
+            if (classEscape(letter, &node->ranges)) {
+                index_++;
+                normalize(&node->ranges);
+                return node;
+            }
+        }
+        auto node = std::make_unique<Node>(Node::Kind::Literal);
+        if (!escapedCodePoint(&node->codePoint)) {
+            return nullptr;
+        }
+        return node;
+    }
+
+    /// Reads a class like [a-z_] whose [ has been consumed.
+    std::unique_ptr<Node> characterClass() {
+        auto node = std::make_unique<Node>(Node::Kind::Class);
+        auto negated = !atEnd() && peek() == '^';
+        if (negated) index_++;
+        auto first = true;
+        while (!atEnd() && (peek() != ']' || first)) {
+            first = false;
+            uint32_t low;
+            if (peek() == '\\') {
+                index_++;
+                if (!atEnd() && classEscape(peek(), &node->ranges)) {
+                    index_++;
+                    continue;
+                }
+                if (!escapedCodePoint(&low)) {
+                    return nullptr;
+                }
+            }
+            else {
+                low = codePoint();
+            }
+            auto high = low;
+            if (index_ + 1 < count_ && peek() == '-' && bytes_[index_ + 1] != ']') {
+                index_++;
+                if (peek() == '\\') {
+                    index_++;
+                    if (!escapedCodePoint(&high)) {
+                        return nullptr;
+                    }
+                }
+                else {
+                    high = codePoint();
+                }
+                if (high < low) {
+                    return fail("Invalid range in class");
+                }
+            }
+            node->ranges.emplace_back(low, high);
+        }
+        if (atEnd()) {
+            return fail("Missing ]");
+        }
+        index_++;
+        normalize(&node->ranges);
+        if (negated) {
+            node->ranges = complement(node->ranges);
+        }
+        return node;
+    }
+
+    const uint8_t *bytes_;
+    size_t count_;
+    size_t index_ = 0;
+};
+
+/// A sequence of byte ranges that matches the UTF-8 encodings of a range of code points.
+struct Sequence {
+    size_t length;
+    uint8_t lo[4];
+    uint8_t hi[4];
+};
+
+size_t encode(uint32_t codePoint, uint8_t *bytes) {
+    if (codePoint < 0x80) {
+        bytes[0] = codePoint;
+        return 1;
+    }
+    if (codePoint < 0x800) {
+        bytes[0] = 0xC0 | (codePoint >> 6);
+        bytes[1] = 0x80 | (codePoint & 0x3F);
+        return 2;
+    }
+    if (codePoint < 0x10000) {
+        bytes[0] = 0xE0 | (codePoint >> 12);
+        bytes[1] = 0x80 | ((codePoint >> 6) & 0x3F);
+        bytes[2] = 0x80 | (codePoint & 0x3F);
+        return 3;
+    }
+    bytes[0] = 0xF0 | (codePoint >> 18);
+    bytes[1] = 0x80 | ((codePoint >> 12) & 0x3F);
+    bytes[2] = 0x80 | ((codePoint >> 6) & 0x3F);
+    bytes[3] = 0x80 | (codePoint & 0x3F);
+    return 4;
+}
+
+/// Splits the code points from *lo* to *hi* into ranges whose encodings differ only in a suffix of continuation bytes
+/// and adds a sequence for each to *sequences*. Surrogates are left out as they cannot be encoded in UTF-8.
+void sequences(uint32_t lo, uint32_t hi, std::vector<Sequence> *sequences) {
+    std::vector<std::pair<uint32_t, uint32_t>> stack{ { lo, hi } };
+    while (!stack.empty()) {
+        std::tie(lo, hi) = stack.back();
+        stack.pop_back();
+        if (lo <= 0xDFFF && hi >= 0xD800) {
+            if (lo < 0xD800) stack.emplace_back(lo, 0xD7FF);
+            if (hi > 0xDFFF) stack.emplace_back(0xE000, hi);
+            continue;
+        }
+        auto split = false;
+        for (uint32_t max : { 0x7Fu, 0x7FFu, 0xFFFFu }) {
+            if (lo <= max && hi > max) {
+                stack.emplace_back(lo, max);
+                stack.emplace_back(max + 1, hi);
+                split = true;
+                break;
+            }
+        }
+        for (int i = 1; i < 4 && !split && hi > 0x7F; i++) {
+            uint32_t mask = (1u << (6 * i)) - 1;
+            if ((lo & ~mask) != (hi & ~mask)) {
+                if ((lo & mask) != 0) {
+                    stack.emplace_back(lo, lo | mask);
+                    stack.emplace_back((lo | mask) + 1, hi);
+                    split = true;
+                }
+                else if ((hi & mask) != mask) {
+                    stack.emplace_back(lo, (hi & ~mask) - 1);
+                    stack.emplace_back(hi & ~mask, hi);
+                    split = true;
+                }
+            }
+        }
+        if (!split) {
+            Sequence sequence;
+            sequence.length = encode(lo, sequence.lo);
+            encode(hi, sequence.hi);
+            sequences->push_back(sequence);
+        }
+    }
+}
+
+/// Generates the instructions of a syntax tree with Thompson's construction.
+class Generator {
+public:
+    explicit Generator(Program *program) : program_(program) {}
+
+    /// A piece of a program: its first instruction and the instruction fields that must be set to the instruction
+    /// that follows it, encoded as the index of the instruction times two plus one for the field `y`.
+    struct Fragment {
+        uint32_t start;
+        std::vector<uint32_t> holes;
+    };
+
+    bool generate(const Node &node, Fragment *fragment) {
+        switch (node.kind) {
+            case Node::Kind::Empty:
+                *fragment = { emit({ Inst::Op::Jump }), {} };
+                fragment->holes.push_back(fragment->start * 2);
+                break;
+            case Node::Kind::Literal: {
+                uint8_t bytes[4];
+                auto length = encode(node.codePoint, bytes);
+                *fragment = bytesFragment(bytes, bytes, length);
+                break;
+            }
+            case Node::Kind::Class:
+                *fragment = classFragment(node.ranges);
+                break;
+            case Node::Kind::Concat:
+                if (!generate(*node.children.front(), fragment)) return false;
+                for (size_t i = 1; i < node.children.size(); i++) {
+                    Fragment next;
+                    if (!generate(*node.children[i], &next)) return false;
+                    patch(fragment->holes, next.start);
+                    fragment->holes = std::move(next.holes);
+                }
+                break;
+            case Node::Kind::Alternate: {
+                std::vector<Fragment> alternatives(node.children.size());
+                for (size_t i = 0; i < node.children.size(); i++) {
+                    if (!generate(*node.children[i], &alternatives[i])) return false;
+                }
+                *fragment = alternate(std::move(alternatives));
+                break;
+            }
+            case Node::Kind::Repeat:
+                return repeat(node, fragment);
+            case Node::Kind::Group: {
+                if (node.group < 0) {
+                    return generate(*node.children.front(), fragment);
+                }
+                Inst open{ Inst::Op::Save };
+                open.y = node.group * 2;
+                auto start = emit(open);
+                Fragment content;
+                if (!generate(*node.children.front(), &content)) return false;
+                program_->insts[start].x = content.start;
+                Inst close{ Inst::Op::Save };
+                close.y = node.group * 2 + 1;
+                auto end = emit(close);
+                patch(content.holes, end);
+                *fragment = { start, { end * 2 } };
+                break;
+            }
+            case Node::Kind::Assert: {
+                Inst inst{ Inst::Op::Assert };
+                inst.assertion = node.assertion;
+                auto pc = emit(inst);
+                *fragment = { pc, { pc * 2 } };
+                break;
+            }
+        }
+        return program_->insts.size() <= kMaxInsts;
+    }
+
+    uint32_t emit(Inst inst) {
+        program_->insts.push_back(inst);
+        return program_->insts.size() - 1;
+    }
+
+    void patch(const std::vector<uint32_t> &holes, uint32_t target) {
+        for (auto hole : holes) {
+            auto &inst = program_->insts[hole / 2];
+            (hole % 2 == 0 ? inst.x : inst.y) = target;
+        }
+    }
+
+private:
+    Fragment bytesFragment(const uint8_t *lo, const uint8_t *hi, size_t length) {
+        Fragment fragment{ static_cast<uint32_t>(program_->insts.size()), {} };
+        for (size_t i = 0; i < length; i++) {
+            Inst inst{ Inst::Op::Bytes };
+            inst.lo = lo[i];
+            inst.hi = hi[i];
+            inst.x = program_->insts.size() + 1;
+            emit(inst);
+        }
+        fragment.holes.push_back((program_->insts.size() - 1) * 2);
+        return fragment;
+    }
+
+    Fragment classFragment(const Ranges &ranges) {
+        std::vector<Sequence> all;
+        for (auto &range : ranges) {
+            sequences(range.first, range.second, &all);
+        }
+        if (all.empty()) {
+            // A class that matches nothing, like [^\x00-\x{10FFFF}], is an instruction that never matches.
+            Inst inst{ Inst::Op::Bytes };
+            inst.lo = 1;
+            inst.hi = 0;
+            auto pc = emit(inst);
+            return { pc, { pc * 2 } };
+        }
+        std::vector<Fragment> alternatives;
+        for (auto &sequence : all) {
+            alternatives.push_back(bytesFragment(sequence.lo, sequence.hi, sequence.length));
+        }
+        return alternate(std::move(alternatives));
+    }
+
+    Fragment alternate(std::vector<Fragment> alternatives) {
+        auto fragment = std::move(alternatives.back());
+        for (size_t i = alternatives.size() - 1; i-- > 0;) {
+            Inst split{ Inst::Op::Split };
+            split.x = alternatives[i].start;
+            split.y = fragment.start;
+            fragment.start = emit(split);
+            fragment.holes.insert(fragment.holes.end(), alternatives[i].holes.begin(), alternatives[i].holes.end());
+        }
+        return fragment;
+    }
+
+    /// Returns a split whose preferred branch is the hole if the repetition is lazy, and the field of the other branch.
+    uint32_t split(bool greedy, uint32_t target, uint32_t *hole) {
+        Inst inst{ Inst::Op::Split };
+        auto pc = emit(inst);
+        (greedy ? program_->insts[pc].x : program_->insts[pc].y) = target;
+        *hole = greedy ? pc * 2 + 1 : pc * 2;
+        return pc;
+    }
+
+    /// Generates x{n,m} as n copies of x followed by (x(x(x)?)?)? with m - n copies or x* if m is unbounded.
+    bool repeat(const Node &node, Fragment *fragment) {
+        auto &child = *node.children.front();
+        std::vector<Fragment> parts;
+        for (int i = 0; i < node.min; i++) {
+            parts.emplace_back();
+            if (!generate(child, &parts.back())) return false;
+        }
+        if (node.max == -1) {
+            Fragment body;
+            if (!generate(child, &body)) return false;
+            uint32_t hole;
+            auto loop = split(node.greedy, body.start, &hole);
+            patch(body.holes, loop);
+            parts.push_back({ loop, { hole } });
+        }
+        else if (node.max > node.min) {
+            // The optional copies are generated from the innermost one outwards.
+            Fragment optional;
+            auto empty = true;
+            for (int i = node.min; i < node.max; i++) {
+                Fragment body;
+                if (!generate(child, &body)) return false;
+                if (!empty) {
+                    patch(body.holes, optional.start);
+                    body.holes = std::move(optional.holes);
+                }
+                uint32_t hole;
+                auto pc = split(node.greedy, body.start, &hole);
+                body.holes.push_back(hole);
+                optional = { pc, std::move(body.holes) };
+                empty = false;
+            }
+            parts.push_back(std::move(optional));
+        }
+        if (parts.empty()) {
+            *fragment = { emit({ Inst::Op::Jump }), {} };
+            fragment->holes.push_back(fragment->start * 2);
+            return true;
+        }
+        *fragment = std::move(parts.front());
+        for (size_t i = 1; i < parts.size(); i++) {
+            patch(fragment->holes, parts[i].start);
+            fragment->holes = std::move(parts[i].holes);
+        }
+        return program_->insts.size() <= kMaxInsts;
+    }
+
+    Program *program_;
+};
+
+/// Appends the bytes with which every match of *node* begins to *prefix* and returns true if every match of *node*
+/// consists only of these bytes, so that the bytes of the following nodes may be appended as well.
+bool appendPrefix(const Node &node, std::string *prefix) {
+    switch (node.kind) {
+        case Node::Kind::Literal: {
+            uint8_t bytes[4];
+            auto length = encode(node.codePoint, bytes);
+            prefix->append(reinterpret_cast<char *>(bytes), length);
+            return true;
+        }
+        case Node::Kind::Concat:
+            for (auto &child : node.children) {
+                if (!appendPrefix(*child, prefix)) return false;
+            }
+            return true;
+        case Node::Kind::Group:
+            return appendPrefix(*node.children.front(), prefix);
+        case Node::Kind::Empty:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool isAnchored(const Node &node) {
+    switch (node.kind) {
+        case Node::Kind::Assert:
+            return node.assertion == Assertion::BeginText;
+        case Node::Kind::Concat:
+        case Node::Kind::Group:
+            return isAnchored(*node.children.front());
+        default:
+            return false;
+    }
+}
+
+}  // namespace
+
+bool compile(const char *pattern, size_t count, Program *program, const char **error) {
+    Parser parser(pattern, count);
+    auto root = parser.parse();
+    if (root == nullptr) {
+        *error = parser.error_;
+        return false;
+    }
+
+    Generator generator(program);
+    // The whole match is group 0.
+    Inst open{ Inst::Op::Save };
+    open.y = 0;
+    program->start = generator.emit(open);
+    Generator::Fragment fragment;
+    if (!generator.generate(*root, &fragment)) {
+        *error = "Pattern is too large";
+        return false;
+    }
+    program->insts[program->start].x = fragment.start;
+    Inst close{ Inst::Op::Save };
+    close.y = 1;
+    auto end = generator.emit(close);
+    generator.patch(fragment.holes, end);
+    program->insts[end].x = generator.emit({ Inst::Op::Match });
+
+    Inst loop{ Inst::Op::Split };
+    loop.x = program->start;
+    loop.y = program->insts.size() + 1;
+    program->unanchoredStart = generator.emit(loop);
+    Inst any{ Inst::Op::Bytes };
+    any.lo = 0;
+    any.hi = 255;
+    any.x = program->unanchoredStart;
+    generator.emit(any);
+
+    program->groups = parser.groups_;
+    program->wordAssertions = parser.wordAssertions_;
+    program->anchored = isAnchored(*root);
+    if (!program->anchored) {
+        appendPrefix(*root, &program->prefix);
+    }
+
+    bool boundaries[257] = {};
+    for (auto &inst : program->insts) {
+        if (inst.op == Inst::Op::Bytes && inst.lo <= inst.hi) {
+            boundaries[inst.lo] = true;
+            boundaries[inst.hi + 1] = true;
+        }
+    }
+    size_t byteClass = 0;
+    for (int byte = 0; byte < 256; byte++) {
+        if (boundaries[byte] && byte > 0) {
+            byteClass++;
+        }
+        program->byteClasses[byte] = byteClass;
+    }
+    program->classCount = byteClass + 1;
+    return true;
+}
+
+}  // namespace regex
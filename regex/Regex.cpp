@@ -0,0 +1,81 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "Regex.h"
+
+namespace regex {
+
+extern "C" Regex* regexRegexNew(String *pattern, runtime::Raiser *raiser) {
+    auto regex = Regex::init();
+    const char *error;
+    if (!regex->compile(pattern->bytes(), pattern->count, &error)) {
+        regex->release();
+        EJC_RAISE(raiser, Error::init(error));
+    }
+    return regex;
+}
+
+extern "C" runtime::Boolean regexRegexContains(Regex *regex, String *string) {
+    return regex->matches(string, 0, false);
+}
+
+extern "C" runtime::Boolean regexRegexMatches(Regex *regex, String *string) {
+    return regex->matches(string, 0, true);
+}
+
+extern "C" runtime::SimpleOptional<Match*> regexRegexFindFrom(Regex *regex, String *string, runtime::Integer offset) {
+    if (offset < 0 || offset > string->count) {
+        return runtime::NoValue;
+    }
+    auto from = offset;
+    // A search never begins inside the encoding of a code point.
+    while (from < string->count && (static_cast<uint8_t>(string->bytes()[from]) & 0xC0) == 0x80) {
+        from++;
+    }
+    std::vector<int64_t> slots;
+    if (!regex->find(string, from, &slots)) {
+        return runtime::NoValue;
+    }
+    return Match::init(string, std::move(slots));
+}
+
+extern "C" runtime::SimpleOptional<Match*> regexRegexFind(Regex *regex, String *string) {
+    return regexRegexFindFrom(regex, string, 0);
+}
+
+extern "C" runtime::Integer regexRegexGroups(Regex *regex) {
+    return regex->program().groups - 1;
+}
+
+extern "C" void regexRegexDestruct(Regex *regex) {
+    regex->~Regex();
+}
+
+extern "C" runtime::SimpleOptional<String*> regexMatchGroup(Match *match, runtime::Integer group) {
+    if (group < 0 || static_cast<size_t>(group) * 2 >= match->slots_.size() || match->slots_[group * 2] < 0) {
+        return runtime::NoValue;
+    }
+    auto start = match->slots_[group * 2];
+    return match->string_->slice(start, match->slots_[group * 2 + 1] - start);
+}
+
+extern "C" runtime::SimpleOptional<runtime::Integer> regexMatchStart(Match *match, runtime::Integer group) {
+    if (group < 0 || static_cast<size_t>(group) * 2 >= match->slots_.size() || match->slots_[group * 2] < 0) {
+        return runtime::NoValue;
+    }
+    return match->slots_[group * 2];
+}
+
+extern "C" runtime::SimpleOptional<runtime::Integer> regexMatchEnd(Match *match, runtime::Integer group) {
+    if (group < 0 || static_cast<size_t>(group) * 2 >= match->slots_.size() || match->slots_[group * 2] < 0) {
+        return runtime::NoValue;
+    }
+    return match->slots_[group * 2 + 1];
+}
+
+extern "C" void regexMatchDestruct(Match *match) {
+    match->~Match();
+}
+
+}  // namespace regex
@@ -0,0 +1,217 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#ifndef EMOJICODE_REGEX_REGEX_H
+#define EMOJICODE_REGEX_REGEX_H
+
+#include "../runtime/Runtime.h"
+#include "../s/String.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace regex {
+
+using s::String;
+
+/// 🚧🔸🧩, which has the same layout as 🚧.
+class Error : public runtime::Object<Error> {
+public:
+    explicit Error(const char *message) : message(String::init(message)) {}
+
+private:
+    String *message;
+    runtime::SimpleOptional<String*> location = runtime::NoValue;
+};
+
+/// The zero-width assertions of a pattern.
+enum class Assertion : uint8_t { BeginText, EndText, WordBoundary, NotWordBoundary };
+
+/// An instruction of a Thompson NFA that runs on the UTF-8 bytes of the searched string.
+struct Inst {
+    enum class Op : uint8_t {
+        /// Consumes a byte between `lo` and `hi` and continues at `x`.
+        Bytes,
+        /// Continues at `x` and, with lower priority, at `y`.
+        Split,
+        Jump,
+        /// Stores the current position in the capture slot `y` and continues at `x`.
+        Save,
+        /// Continues at `x` if `assertion` holds at the current position.
+        Assert,
+        Match,
+    };
+
+    Op op;
+    uint8_t lo = 0;
+    uint8_t hi = 0;
+    Assertion assertion = Assertion::BeginText;
+    uint32_t x = 0;
+    uint32_t y = 0;
+};
+
+/// A compiled pattern.
+struct Program {
+    std::vector<Inst> insts;
+    /// The instruction at which an anchored search starts.
+    uint32_t start = 0;
+    /// The instruction at which an unanchored search starts. It precedes `start` with a loop that skips any byte.
+    uint32_t unanchoredStart = 0;
+    /// The number of capture groups, including the implicit group 0 that spans the whole match.
+    size_t groups = 1;
+    /// Bytes with which every match begins. Used to skip ahead in the searched string with s::findBytes().
+    std::string prefix;
+    /// Whether every match must begin at the beginning of the searched string.
+    bool anchored = false;
+    /// Whether the pattern contains \b or \B, which the DFA does not support.
+    bool wordAssertions = false;
+    /// Maps every byte to its equivalence class. Bytes in the same class are never distinguished by the program.
+    uint8_t byteClasses[256];
+    size_t classCount = 0;
+};
+
+/// Compiles *pattern* into *program*. Returns false and stores a description of the problem in *error* if the pattern
+/// is invalid.
+bool compile(const char *pattern, size_t count, Program *program, const char **error);
+
+/// A lazily built DFA that answers whether a program matches without tracking captures. States are created when they
+/// are first reached and cached, so that a search usually takes a table lookup per byte. The cache is bounded; if it
+/// fills up too often during a search, the search reports that it gave up and the caller falls back to the NFA.
+class Dfa {
+public:
+    enum class Result { Match, NoMatch, GaveUp };
+
+    explicit Dfa(const Program *program) : program_(program) {}
+
+    /// Checks whether a match of the program begins at or after *from* in *bytes*, or, if *whole* is true, whether
+    /// the program matches all of *bytes* starting at *from*.
+    Result search(const uint8_t *bytes, size_t count, size_t from, bool whole);
+
+private:
+    struct State {
+        /// The instructions the state consists of: Bytes, Match and pending EndText assertions, sorted.
+        std::vector<uint32_t> insts;
+        bool match;
+    };
+
+    static constexpr int32_t kUnknown = -1;
+    /// The maximum number of states. The cache is cleared when it is full.
+    static constexpr size_t kMaxStates = 4096;
+    /// A search gives up if the cache had to be cleared this many times.
+    static constexpr int kMaxClears = 8;
+
+    /// Returns the state consisting of the closure of *pcs*.
+    int32_t state(const std::vector<uint32_t> &pcs, bool atBegin);
+    int32_t step(int32_t state, uint8_t byte);
+    /// Checks whether *state* matches at the end of the string.
+    bool matchesAtEnd(int32_t state, bool atBegin);
+    /// Adds the instructions reachable from *pc* without consuming a byte to `set_`.
+    void closure(uint32_t pc, bool atBegin, bool atEnd);
+    /// Empties `set_` and forgets which instructions closure() visited.
+    void reset();
+    void clear();
+
+    const Program *program_;
+    std::vector<State> states_;
+    /// The transitions of all states, `classCount` entries per state.
+    std::vector<int32_t> transitions_;
+    std::unordered_map<std::string, int32_t> cache_;
+    /// Scratch space for closure().
+    std::vector<uint32_t> stack_;
+    std::vector<uint32_t> set_;
+    /// The instructions whose entry equals `generation_` have been visited since the last reset().
+    std::vector<uint32_t> visited_;
+    uint32_t generation_ = 0;
+};
+
+/// Simulates the NFA of a program in time linear to the length of the searched string, like the Pike VM, and
+/// reports the positions of the capture groups of the leftmost match, preferring alternatives and repetitions as
+/// Perl does.
+class Nfa {
+public:
+    explicit Nfa(const Program *program);
+
+    /// Finds the first match that begins at or after *from* in *bytes*, or, if *whole* is true, a match of all bytes
+    /// from *from* on, and stores the start and end offsets of every group in *slots*, -1 for groups that did not
+    /// participate. Returns false if there is no match.
+    bool search(const uint8_t *bytes, size_t count, size_t from, bool whole, std::vector<int64_t> *slots);
+
+private:
+    /// A set of threads in the order of their priority, with the capture slots of each thread.
+    struct Threads {
+        std::vector<uint32_t> dense;
+        std::vector<uint32_t> sparse;
+        std::vector<int64_t> slots;
+        size_t size = 0;
+
+        bool contains(uint32_t pc) const {
+            return sparse[pc] < size && dense[sparse[pc]] == pc;
+        }
+    };
+
+    struct Frame {
+        uint32_t pc;
+        /// If not kNoRestore, the frame restores slot `pc` to `value` instead of following an instruction.
+        uint32_t restore;
+        int64_t value;
+    };
+
+    static constexpr uint32_t kNoRestore = UINT32_MAX;
+
+    void add(Threads *threads, uint32_t pc, const uint8_t *bytes, size_t count, size_t position, int64_t *slots);
+
+    const Program *program_;
+    size_t slotCount_;
+    Threads current_;
+    Threads next_;
+    std::vector<Frame> stack_;
+};
+
+/// 🧩, a compiled pattern. The DFA is shared by all searches with the pattern and guarded by a mutex.
+class Regex : public runtime::Object<Regex> {
+public:
+    bool compile(const char *pattern, size_t count, const char **error) {
+        return regex::compile(pattern, count, &program_, error);
+    }
+
+    /// Checks whether a match begins at or after *from* in *string*, or matches the whole string if *whole* is true.
+    bool matches(String *string, size_t from, bool whole);
+    /// Finds the first match that begins at or after *from* in *string*. See Nfa::search().
+    bool find(String *string, size_t from, std::vector<int64_t> *slots);
+
+    const Program& program() const { return program_; }
+
+private:
+    Program program_;
+    std::mutex mutex_;
+    /// Created by the first search.
+    std::unique_ptr<Dfa> dfa_;
+};
+
+/// 🧩🔸🍃, a match, which keeps the searched string to return the groups as slices of it.
+class Match : public runtime::Object<Match> {
+public:
+    Match(String *string, std::vector<int64_t> slots) : string_(string), slots_(std::move(slots)) {
+        string_->retain();
+    }
+
+    ~Match() {
+        string_->release();
+    }
+
+    String *string_;
+    /// The start and end byte offsets of each group.
+    std::vector<int64_t> slots_;
+};
+
+}  // namespace regex
+
+SET_INFO_FOR(regex::Error, regex, 1f6a7_1f538_1f9e9)
+SET_INFO_FOR(regex::Regex, regex, 1f9e9)
+SET_INFO_FOR(regex::Match, regex, 1f9e9_1f538_1f343)
+
+#endif  // EMOJICODE_REGEX_REGEX_H
@@ -0,0 +1,342 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "Regex.h"
+#include "../s/Search.h"
+#include <algorithm>
+
+namespace regex {
+
+namespace {
+
+bool isWordByte(uint8_t byte) {
+    return (byte >= '0' && byte <= '9') || (byte >= 'A' && byte <= 'Z') || (byte >= 'a' && byte <= 'z') ||
+           byte == '_';
+}
+
+bool holds(Assertion assertion, const uint8_t *bytes, size_t count, size_t position) {
+    switch (assertion) {
+        case Assertion::BeginText:
+            return position == 0;
+        case Assertion::EndText:
+            return position == count;
+        case Assertion::WordBoundary:
+        case Assertion::NotWordBoundary: {
+            auto before = position > 0 && isWordByte(bytes[position - 1]);
+            auto after = position < count && isWordByte(bytes[position]);
+            return (before != after) == (assertion == Assertion::WordBoundary);
+        }
+    }
+    return false;
+}
+
+/// Returns the position of the next occurrence of *prefix* at or after *from* or *count* if there is none.
+size_t skip(const std::string &prefix, const uint8_t *bytes, size_t count, size_t from) {
+    auto found = s::findBytes(reinterpret_cast<const char *>(bytes) + from, count - from, prefix.data(), prefix.size());
+    return found == nullptr ? count : reinterpret_cast<const uint8_t *>(found) - bytes;
+}
+
+}  // namespace
+
+void Dfa::reset() {
+    set_.clear();
+    if (visited_.size() != program_->insts.size()) {
+        visited_.assign(program_->insts.size(), 0);
+    }
+    if (++generation_ == 0) {
+        std::fill(visited_.begin(), visited_.end(), 0);
+        generation_ = 1;
+    }
+}
+
+void Dfa::closure(uint32_t pc, bool atBegin, bool atEnd) {
+    stack_.clear();
+    stack_.push_back(pc);
+    while (!stack_.empty()) {
+        pc = stack_.back();
+        stack_.pop_back();
+        if (visited_[pc] == generation_) {
+            continue;
+        }
+        visited_[pc] = generation_;
+        auto &inst = program_->insts[pc];
+        switch (inst.op) {
+            case Inst::Op::Bytes:
+            case Inst::Op::Match:
+                set_.push_back(pc);
+                break;
+            case Inst::Op::Split:
+                stack_.push_back(inst.y);
+                stack_.push_back(inst.x);
+                break;
+            case Inst::Op::Jump:
+            case Inst::Op::Save:
+                stack_.push_back(inst.x);
+                break;
+            case Inst::Op::Assert:
+                if (inst.assertion == Assertion::BeginText) {
+                    if (atBegin) stack_.push_back(inst.x);
+                }
+                else if (atEnd) {
+                    stack_.push_back(inst.x);
+                }
+                else {
+                    // Whether the string ends here is only known when the next byte is read.
+                    set_.push_back(pc);
+                }
+                break;
+        }
+    }
+}
+
+int32_t Dfa::state(const std::vector<uint32_t> &pcs, bool atBegin) {
+    reset();
+    for (auto pc : pcs) {
+        closure(pc, atBegin, false);
+    }
+    std::sort(set_.begin(), set_.end());
+    std::string key(reinterpret_cast<const char *>(set_.data()), set_.size() * sizeof(uint32_t));
+    auto it = cache_.find(key);
+    if (it != cache_.end()) {
+        return it->second;
+    }
+    if (states_.size() >= kMaxStates) {
+        return kUnknown;
+    }
+    auto match = std::any_of(set_.begin(), set_.end(), [this](uint32_t pc) {
+        return program_->insts[pc].op == Inst::Op::Match;
+    });
+    auto id = static_cast<int32_t>(states_.size());
+    states_.push_back({ set_, match });
+    transitions_.resize(transitions_.size() + program_->classCount, kUnknown);
+    cache_.emplace(std::move(key), id);
+    return id;
+}
+
+int32_t Dfa::step(int32_t state, uint8_t byte) {
+    auto &transition = transitions_[state * program_->classCount + program_->byteClasses[byte]];
+    if (transition != kUnknown) {
+        return transition;
+    }
+    std::vector<uint32_t> next;
+    for (auto pc : states_[state].insts) {
+        auto &inst = program_->insts[pc];
+        if (inst.op == Inst::Op::Bytes && inst.lo <= byte && byte <= inst.hi) {
+            next.push_back(inst.x);
+        }
+    }
+    auto target = this->state(next, false);
+    if (target != kUnknown) {
+        // state() may have grown transitions_, so the reference is not used here.
+        transitions_[state * program_->classCount + program_->byteClasses[byte]] = target;
+    }
+    return target;
+}
+
+bool Dfa::matchesAtEnd(int32_t state, bool atBegin) {
+    if (states_[state].match) {
+        return true;
+    }
+    auto pending = states_[state].insts;
+    reset();
+    for (auto pc : pending) {
+        auto &inst = program_->insts[pc];
+        if (inst.op == Inst::Op::Assert) {
+            closure(inst.x, atBegin, true);
+        }
+    }
+    return std::any_of(set_.begin(), set_.end(), [this](uint32_t pc) {
+        return program_->insts[pc].op == Inst::Op::Match;
+    });
+}
+
+void Dfa::clear() {
+    states_.clear();
+    transitions_.clear();
+    cache_.clear();
+}
+
+Dfa::Result Dfa::search(const uint8_t *bytes, size_t count, size_t from, bool whole) {
+    if (program_->anchored && from > 0) {
+        return Result::NoMatch;
+    }
+    auto anchored = whole || program_->anchored;
+    std::vector<uint32_t> start{ anchored ? program_->start : program_->unanchoredStart };
+    auto current = state(start, from == 0);
+    if (current == kUnknown) {
+        clear();
+        current = state(start, from == 0);
+    }
+    // The state the unanchored search is in while no match has begun, from which the prefix can be skipped to.
+    auto skipFrom = kUnknown;
+    auto usePrefix = !anchored && !program_->prefix.empty();
+    int clears = 0;
+
+    for (auto position = from;; position++) {
+        if (states_[current].match && !whole) {
+            return Result::Match;
+        }
+        if (states_[current].insts.empty()) {
+            return Result::NoMatch;
+        }
+        if (usePrefix) {
+            if (skipFrom == kUnknown) {
+                skipFrom = state(start, false);
+            }
+            if (current == skipFrom) {
+                position = skip(program_->prefix, bytes, count, position);
+                if (position == count) {
+                    return Result::NoMatch;
+                }
+            }
+        }
+        if (position == count) {
+            return matchesAtEnd(current, position == 0) ? Result::Match : Result::NoMatch;
+        }
+        auto next = step(current, bytes[position]);
+        if (next == kUnknown) {
+            if (++clears > kMaxClears) {
+                return Result::GaveUp;
+            }
+            auto insts = states_[current].insts;
+            clear();
+            skipFrom = kUnknown;
+            current = state(insts, false);
+            next = step(current, bytes[position]);
+        }
+        current = next;
+    }
+}
+
+Nfa::Nfa(const Program *program) : program_(program), slotCount_(program->groups * 2) {
+    for (auto threads : { &current_, &next_ }) {
+        threads->dense.resize(program->insts.size());
+        threads->sparse.resize(program->insts.size());
+        threads->slots.resize(program->insts.size() * slotCount_);
+    }
+}
+
+void Nfa::add(Threads *threads, uint32_t pc, const uint8_t *bytes, size_t count, size_t position, int64_t *slots) {
+    stack_.clear();
+    stack_.push_back({ pc, kNoRestore, 0 });
+    while (!stack_.empty()) {
+        auto frame = stack_.back();
+        stack_.pop_back();
+        if (frame.restore != kNoRestore) {
+            slots[frame.restore] = frame.value;
+            continue;
+        }
+        pc = frame.pc;
+        if (threads->contains(pc)) {
+            continue;
+        }
+        threads->sparse[pc] = threads->size;
+        threads->dense[threads->size++] = pc;
+        auto &inst = program_->insts[pc];
+        switch (inst.op) {
+            case Inst::Op::Bytes:
+            case Inst::Op::Match:
+                std::copy(slots, slots + slotCount_, threads->slots.begin() + pc * slotCount_);
+                break;
+            case Inst::Op::Split:
+                // The preferred branch is pushed last so that it is followed first.
+                stack_.push_back({ inst.y, kNoRestore, 0 });
+                stack_.push_back({ inst.x, kNoRestore, 0 });
+                break;
+            case Inst::Op::Jump:
+                stack_.push_back({ inst.x, kNoRestore, 0 });
+                break;
+            case Inst::Op::Save:
+                stack_.push_back({ 0, inst.y, slots[inst.y] });
+                slots[inst.y] = position;
+                stack_.push_back({ inst.x, kNoRestore, 0 });
+                break;
+            case Inst::Op::Assert:
+                if (holds(inst.assertion, bytes, count, position)) {
+                    stack_.push_back({ inst.x, kNoRestore, 0 });
+                }
+                break;
+        }
+    }
+}
+
+bool Nfa::search(const uint8_t *bytes, size_t count, size_t from, bool whole, std::vector<int64_t> *slots) {
+    if (program_->anchored && from > 0) {
+        return false;
+    }
+    auto anchored = whole || program_->anchored;
+    auto usePrefix = !anchored && !program_->prefix.empty();
+    std::vector<int64_t> scratch(slotCount_);
+    auto matched = false;
+    current_.size = 0;
+
+    for (auto position = from;; position++) {
+        if (!matched && (position == from || !anchored)) {
+            if (usePrefix && current_.size == 0) {
+                position = skip(program_->prefix, bytes, count, position);
+                if (position == count) {
+                    break;
+                }
+            }
+            // A thread that begins here has a lower priority than all threads that began earlier.
+            std::fill(scratch.begin(), scratch.end(), -1);
+            add(&current_, program_->start, bytes, count, position, scratch.data());
+        }
+        if (current_.size == 0) {
+            break;
+        }
+
+        next_.size = 0;
+        for (size_t i = 0; i < current_.size; i++) {
+            auto pc = current_.dense[i];
+            auto &inst = program_->insts[pc];
+            auto threadSlots = current_.slots.data() + pc * slotCount_;
+            if (inst.op == Inst::Op::Match) {
+                if (whole && position != count) {
+                    continue;
+                }
+                slots->assign(threadSlots, threadSlots + slotCount_);
+                matched = true;
+                // Threads with a lower priority cannot produce the preferred match anymore.
+                break;
+            }
+            if (inst.op == Inst::Op::Bytes && position < count && inst.lo <= bytes[position] &&
+                bytes[position] <= inst.hi) {
+                add(&next_, inst.x, bytes, count, position + 1, threadSlots);
+            }
+        }
+        std::swap(current_, next_);
+        if (position == count) {
+            break;
+        }
+    }
+    return matched;
+}
+
+bool Regex::matches(String *string, size_t from, bool whole) {
+    auto bytes = reinterpret_cast<const uint8_t *>(string->bytes());
+    if (!program_.wordAssertions) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (dfa_ == nullptr) {
+            dfa_ = std::make_unique<Dfa>(&program_);
+        }
+        auto result = dfa_->search(bytes, string->count, from, whole);
+        if (result != Dfa::Result::GaveUp) {
+            return result == Dfa::Result::Match;
+        }
+    }
+    std::vector<int64_t> slots;
+    return Nfa(&program_).search(bytes, string->count, from, whole, &slots);
+}
+
+bool Regex::find(String *string, size_t from, std::vector<int64_t> *slots) {
+    // The DFA rejects strings without a match much faster than the NFA, which is only run to find the groups.
+    if (!program_.wordAssertions && !matches(string, from, false)) {
+        return false;
+    }
+    auto bytes = reinterpret_cast<const uint8_t *>(string->bytes());
+    return Nfa(&program_).search(bytes, string->count, from, false, slots);
+}
+
+}  // namespace regex
@@ -0,0 +1,465 @@
+//
+// Created by Theo Weidmann on 14.10.26.
+//
+
+#include "Allocator.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace runtime {
+
+namespace internal {
+
+namespace {
+
+/// Precedes every allocation made by the pooling allocator.
+struct alignas(8) Header {
+    /// The index of the size class plus one, zero if the memory was allocated directly with malloc or kHugePageClass
+    /// if it was mapped with mapHugePages().
+    uint64_t sizeClass : 8;
+    /// ThreadCache::node of the thread that allocated the memory.
+    uint64_t node : 8;
+    /// The number of bytes following the header.
+    uint64_t size : 48;
+};
+
+static_assert(sizeof(Header) == kAllocationOffset, "Allocations begin behind a Header.");
+
+struct FreeBlock {
+    FreeBlock *next;
+};
+
+/// Size classes are multiples of this value (including the Header).
+constexpr size_t kGranularity = 16;
+constexpr size_t kSizeClassCount = 16;
+/// The maximum number of bytes a thread keeps cached per size class.
+constexpr size_t kCacheBytesPerClass = 64 * 1024;
+/// The changes to the live memory a thread accumulates before it adds them to the shared counts.
+constexpr ptrdiff_t kUncountedBytes = 64 * 1024;
+constexpr ptrdiff_t kUncountedAllocations = 256;
+
+constexpr size_t blockSize(size_t sizeClass) { return (sizeClass + 1) * kGranularity; }
+
+constexpr uint64_t kHugePageClass = UINT8_MAX;
+/// The size of the huge pages backing large allocations if huge pages are enabled and the size from which allocations
+/// are backed by them.
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+/// The size of the largest huge pages, which are used for allocations of at least this size if explicit huge pages
+/// are enabled.
+constexpr size_t kGiganticPageSize = 1024 * 1024 * 1024;
+
+/// Precedes the Header of allocations backed by huge pages.
+struct HugePageRegion {
+    /// The number of bytes mapped beginning with this struct.
+    size_t length;
+    /// The size of the pages if the region was mapped from the reserved huge pages of the system, or zero if it is
+    /// backed by transparent huge pages.
+    size_t pageSize;
+};
+
+constexpr size_t kHugePageOverhead = sizeof(HugePageRegion) + sizeof(Header);
+
+/// This struct is trivial so that accessing it does not require a guard, which is important as it is accessed on every
+/// allocation.
+struct ThreadCache {
+    FreeBlock *lists[kSizeClassCount];
+    uint32_t counts[kSizeClassCount];
+    /// Changes to the live memory not yet added to liveBytes and liveAllocations.
+    ptrdiff_t bytes;
+    ptrdiff_t allocations;
+    bool registered;
+    /// Set once the thread is exiting. Memory is then always returned to the system allocator.
+    bool exiting;
+    /// The NUMA node set with setAllocationNode() plus one, or zero if none was set.
+    uint8_t node;
+};
+
+thread_local ThreadCache cache;
+
+std::atomic<int64_t> liveBytes{0};
+std::atomic<int64_t> liveAllocations{0};
+std::atomic<int64_t> memoryLimit{0};
+/// Set while the live bytes exceed the limit, so that the handler is only called once the limit is crossed.
+std::atomic_bool overLimit{false};
+
+/// Adds the changes to the live memory accumulated by the calling thread to the shared counts.
+void flushLiveMemory() {
+    auto bytes = liveBytes.fetch_add(cache.bytes, std::memory_order_relaxed) + cache.bytes;
+    liveAllocations.fetch_add(cache.allocations, std::memory_order_relaxed);
+    cache.bytes = 0;
+    cache.allocations = 0;
+
+    auto limit = memoryLimit.load(std::memory_order_relaxed);
+    if (limit == 0) {
+        return;
+    }
+    if (bytes <= limit) {
+        if (overLimit.load(std::memory_order_relaxed)) {
+            overLimit.store(false, std::memory_order_relaxed);
+        }
+    }
+    else if (!overLimit.exchange(true, std::memory_order_relaxed)) {
+        if (auto handler = memoryPressureHandler.load(std::memory_order_acquire)) {
+            handler();
+        }
+    }
+}
+
+void trimThreadCache() {
+    for (size_t i = 0; i < kSizeClassCount; i++) {
+        for (auto block = cache.lists[i]; block != nullptr;) {
+            auto next = block->next;
+            free(reinterpret_cast<Header *>(block) - 1);
+            block = next;
+        }
+        cache.lists[i] = nullptr;
+        cache.counts[i] = 0;
+    }
+}
+
+/// Returns the memory cached by a thread and counts its changes to the live memory when the thread exits.
+struct ThreadCacheReclaimer {
+    ~ThreadCacheReclaimer() {
+        cache.exiting = true;
+        trimThreadCache();
+        flushLiveMemory();
+    }
+};
+
+/// Must be called before the first block is placed in the cache of a thread or its live memory changes.
+void registerReclaimer() {
+    if (!cache.registered) {
+        static thread_local ThreadCacheReclaimer reclaimer;
+        (void)reclaimer;
+        cache.registered = true;
+    }
+}
+
+bool useSystemAllocator() {
+#ifdef EJC_SYSTEM_MALLOC
+    return true;
+#else
+    static const bool system = std::getenv("EJC_SYSTEM_MALLOC") != nullptr;
+    return system;
+#endif
+}
+
+enum class HugePages { None, Transparent, Explicit };
+
+/// Returns how allocations of at least kHugePageSize bytes are backed by huge pages, which reduces the misses of the
+/// translation lookaside buffer when large lists or buffers are scanned.
+HugePages hugePages() {
+#ifdef __linux__
+    static const HugePages hugePages = [] {
+        auto value = std::getenv("EJC_HUGE_PAGES");
+#ifdef EJC_HUGE_PAGES
+        if (value == nullptr) return HugePages::Transparent;
+#endif
+        if (value == nullptr || std::strcmp(value, "0") == 0) return HugePages::None;
+        return std::strcmp(value, "explicit") == 0 ? HugePages::Explicit : HugePages::Transparent;
+    }();
+    return hugePages;
+#else
+    return HugePages::None;
+#endif
+}
+
+constexpr size_t roundUp(size_t value, size_t multiple) { return (value + multiple - 1) / multiple * multiple; }
+
+#ifdef __linux__
+/// Reserves *length* bytes of address space that begin at a multiple of kHugePageSize, which is required for the
+/// kernel to back them with transparent huge pages. Returns nullptr if there is not enough address space.
+void* reserveAligned(size_t length) {
+    auto memory = mmap(nullptr, length + kHugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return nullptr;
+    }
+    auto address = reinterpret_cast<uintptr_t>(memory);
+    auto aligned = roundUp(address, kHugePageSize);
+    if (aligned > address) {
+        munmap(memory, aligned - address);
+    }
+    munmap(reinterpret_cast<void *>(aligned + length), address + kHugePageSize - aligned);
+    return reinterpret_cast<void *>(aligned);
+}
+#endif
+
+/// Maps a region of at least *length* bytes backed by huge pages. Returns nullptr if no memory could be mapped.
+HugePageRegion* mapHugePages(size_t length) {
+#ifdef __linux__
+#ifdef MAP_HUGE_SHIFT
+    if (hugePages() == HugePages::Explicit) {
+        // Reserved pages may be exhausted or not exist in the larger size, transparent huge pages are used then.
+        for (auto pageSize : { kGiganticPageSize, kHugePageSize }) {
+            if (length < pageSize) continue;
+            auto sizeFlag = (pageSize == kGiganticPageSize ? 30 : 21) << MAP_HUGE_SHIFT;
+            auto memory = mmap(nullptr, roundUp(length, pageSize), PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | sizeFlag, -1, 0);
+            if (memory != MAP_FAILED) {
+                return new(memory) HugePageRegion{ roundUp(length, pageSize), pageSize };
+            }
+        }
+    }
+#endif
+    length = roundUp(length, kHugePageSize);
+    auto memory = reserveAligned(length);
+    if (memory == nullptr) {
+        return nullptr;
+    }
+    madvise(memory, length, MADV_HUGEPAGE);
+    return new(memory) HugePageRegion{ length, 0 };
+#else
+    (void)length;
+    return nullptr;
+#endif
+}
+
+void unmapHugePages(HugePageRegion *region) {
+#ifdef __linux__
+    munmap(region, region->length);
+#else
+    (void)region;
+#endif
+}
+
+/// Resizes *region* to at least *length* bytes without copying its content if possible. Returns nullptr if the
+/// region could not be resized, in which case it is left unchanged.
+HugePageRegion* remapHugePages(HugePageRegion *region, size_t length) {
+#ifdef __linux__
+    auto pageSize = region->pageSize != 0 ? region->pageSize : kHugePageSize;
+    length = roundUp(length, pageSize);
+    if (length <= region->length) {
+        if (length < region->length) {
+            munmap(reinterpret_cast<uint8_t *>(region) + length, region->length - length);
+            region->length = length;
+        }
+        return region;
+    }
+    void *memory = MAP_FAILED;
+    if (region->pageSize == 0) {
+        // The pages are moved to an aligned address, so that they can still be backed by huge pages.
+        if (auto target = reserveAligned(length)) {
+            memory = mremap(region, region->length, length, MREMAP_MAYMOVE | MREMAP_FIXED, target);
+            if (memory == MAP_FAILED) {
+                munmap(target, length);
+            }
+        }
+    }
+    else {
+        memory = mremap(region, region->length, length, MREMAP_MAYMOVE);
+    }
+    if (memory == MAP_FAILED) {
+        return nullptr;
+    }
+    region = static_cast<HugePageRegion *>(memory);
+    region->length = length;
+    return region;
+#else
+    (void)region;
+    (void)length;
+    return nullptr;
+#endif
+}
+
+/// Returns the size of memory obtained from malloc, or zero if the C library cannot tell.
+size_t systemAllocationSize(void *memory) {
+#if defined(__GLIBC__)
+    return malloc_usable_size(memory);
+#else
+    (void)memory;
+    return 0;
+#endif
+}
+
+void* allocateLarge(size_t size) {
+    auto header = static_cast<Header *>(malloc(sizeof(Header) + size));
+    header->sizeClass = 0;
+    header->node = 0;
+    header->size = size;
+    return header + 1;
+}
+
+/// Allocates *size* bytes backed by huge pages, or with allocateLarge() if no huge pages are available.
+void* allocateHuge(size_t size) {
+    auto region = mapHugePages(kHugePageOverhead + size);
+    if (region == nullptr) {
+        return allocateLarge(size);
+    }
+    auto header = reinterpret_cast<Header *>(region + 1);
+    header->sizeClass = kHugePageClass;
+    header->node = 0;
+    header->size = size;
+    return header + 1;
+}
+
+void* reallocateHuge(Header *header, size_t size) {
+    auto region = reinterpret_cast<HugePageRegion *>(header) - 1;
+    if (auto newRegion = remapHugePages(region, kHugePageOverhead + size)) {
+        auto newHeader = reinterpret_cast<Header *>(newRegion + 1);
+        newHeader->size = size;
+        return newHeader + 1;
+    }
+    auto newMemory = allocateHuge(size);
+    std::memcpy(newMemory, header + 1, std::min(static_cast<size_t>(header->size), size));
+    unmapHugePages(region);
+    return newMemory;
+}
+
+}  // namespace
+
+void* allocate(size_t size) {
+    if (useSystemAllocator()) {
+        auto memory = static_cast<char *>(malloc(kAllocationOffset + size));
+        countLiveMemory(static_cast<ptrdiff_t>(systemAllocationSize(memory)), 1);
+        return memory + kAllocationOffset;
+    }
+
+    auto sizeClass = (size + sizeof(Header) - 1) / kGranularity;
+    if (sizeClass >= kSizeClassCount) {
+        countLiveMemory(static_cast<ptrdiff_t>(size), 1);
+        if (size >= kHugePageSize && hugePages() != HugePages::None) {
+            return allocateHuge(size);
+        }
+        return allocateLarge(size);
+    }
+    countLiveMemory(static_cast<ptrdiff_t>(blockSize(sizeClass) - sizeof(Header)), 1);
+
+    if (auto block = cache.lists[sizeClass]) {
+        cache.lists[sizeClass] = block->next;
+        cache.counts[sizeClass]--;
+        return block;
+    }
+
+    auto header = static_cast<Header *>(malloc(blockSize(sizeClass)));
+    header->sizeClass = sizeClass + 1;
+    header->node = cache.node;
+    header->size = blockSize(sizeClass) - sizeof(Header);
+    return header + 1;
+}
+
+void deallocate(void *memory) {
+    if (useSystemAllocator()) {
+        auto base = static_cast<char *>(memory) - kAllocationOffset;
+        countLiveMemory(-static_cast<ptrdiff_t>(systemAllocationSize(base)), -1);
+        free(base);
+        return;
+    }
+
+    auto header = static_cast<Header *>(memory) - 1;
+    countLiveMemory(-static_cast<ptrdiff_t>(header->size), -1);
+    if (header->sizeClass == 0) {
+        free(header);
+        return;
+    }
+    if (header->sizeClass == kHugePageClass) {
+        unmapHugePages(reinterpret_cast<HugePageRegion *>(header) - 1);
+        return;
+    }
+
+    auto sizeClass = header->sizeClass - 1;
+    // Memory from another node is not cached, so that a thread only reuses memory that is local to it.
+    if (cache.exiting || header->node != cache.node ||
+        cache.counts[sizeClass] >= kCacheBytesPerClass / blockSize(sizeClass)) {
+        free(header);
+        return;
+    }
+    auto block = static_cast<FreeBlock *>(memory);
+    block->next = cache.lists[sizeClass];
+    cache.lists[sizeClass] = block;
+    cache.counts[sizeClass]++;
+}
+
+void* reallocate(void *memory, size_t size) {
+    if (useSystemAllocator()) {
+        auto base = static_cast<char *>(memory) - kAllocationOffset;
+        auto oldSize = systemAllocationSize(base);
+        auto newBase = static_cast<char *>(realloc(base, kAllocationOffset + size));
+        countLiveMemory(static_cast<ptrdiff_t>(systemAllocationSize(newBase)) - static_cast<ptrdiff_t>(oldSize), 0);
+        return newBase + kAllocationOffset;
+    }
+
+    auto header = static_cast<Header *>(memory) - 1;
+    if (header->sizeClass == kHugePageClass) {
+        countLiveMemory(static_cast<ptrdiff_t>(size) - static_cast<ptrdiff_t>(header->size), 0);
+        return reallocateHuge(header, size);
+    }
+    if (header->sizeClass == 0) {
+        countLiveMemory(static_cast<ptrdiff_t>(size) - static_cast<ptrdiff_t>(header->size), 0);
+        if (size >= kHugePageSize && hugePages() != HugePages::None) {
+            // Moved to huge pages once, so that the memory can be resized without copying from then on.
+            auto newMemory = allocateHuge(size);
+            std::memcpy(newMemory, memory, std::min(static_cast<size_t>(header->size), size));
+            free(header);
+            return newMemory;
+        }
+        auto newHeader = static_cast<Header *>(realloc(header, sizeof(Header) + size));
+        newHeader->size = size;
+        return newHeader + 1;
+    }
+    auto oldSize = static_cast<size_t>(header->size);
+    if (size <= oldSize) {
+        return memory;
+    }
+
+    auto newMemory = allocate(size);
+    std::memcpy(newMemory, memory, std::min(oldSize, size));
+    deallocate(memory);
+    return newMemory;
+}
+
+void trimAllocationCaches() {
+    if (!useSystemAllocator()) {
+        trimThreadCache();
+    }
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+}
+
+void setAllocationNode(int node) {
+    uint8_t value = node >= 0 && node < UINT8_MAX ? static_cast<uint8_t>(node + 1) : 0;
+    if (value != cache.node) {
+        trimThreadCache();
+        cache.node = value;
+    }
+}
+
+std::atomic<void (*)()> memoryPressureHandler{nullptr};
+
+void countLiveMemory(ptrdiff_t bytes, ptrdiff_t allocations) {
+    cache.bytes += bytes;
+    cache.allocations += allocations;
+    if (cache.exiting) {
+        flushLiveMemory();
+        return;
+    }
+    registerReclaimer();
+    if (cache.bytes >= kUncountedBytes || cache.bytes <= -kUncountedBytes ||
+        cache.allocations >= kUncountedAllocations || cache.allocations <= -kUncountedAllocations) {
+        flushLiveMemory();
+    }
+}
+
+MemoryUsage liveMemory() {
+    return MemoryUsage{ liveBytes.load(std::memory_order_relaxed) + cache.bytes,
+                        liveAllocations.load(std::memory_order_relaxed) + cache.allocations };
+}
+
+void setMemoryLimit(int64_t bytes) {
+    memoryLimit.store(bytes, std::memory_order_relaxed);
+    overLimit.store(false, std::memory_order_relaxed);
+}
+
+}  // namespace internal
+
+}  // namespace runtime
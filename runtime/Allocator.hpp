@@ -0,0 +1,81 @@
+//
+// Created by Theo Weidmann on 14.10.26.
+//
+
+#ifndef EMOJICODE_ALLOCATOR_HPP
+#define EMOJICODE_ALLOCATOR_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace runtime {
+
+namespace internal {
+
+/// Every allocation begins kAllocationOffset bytes behind a multiple of alignof(std::max_align_t), whichever allocator
+/// serves it. ejcAlloc places an object behind a control block of the same size, so that objects are aligned to
+/// alignof(std::max_align_t).
+constexpr size_t kAllocationOffset = 8;
+
+/// Allocates at least `size` bytes of memory aligned for any Emojicode value.
+///
+/// Small allocations are served from thread-local free lists of fixed size classes. Memory released by a thread is
+/// cached by that thread up to a limit and handed to the system allocator beyond it, so that allocation heavy code
+/// rarely has to enter malloc.
+///
+/// If the runtime was compiled with `EJC_SYSTEM_MALLOC` defined or the environment variable `EJC_SYSTEM_MALLOC` is set
+/// when the program starts, all calls are forwarded to malloc, free and realloc directly, which only offset the memory
+/// by kAllocationOffset. This is useful for debugging with tools like valgrind.
+///
+/// On Linux, allocations of 2 MiB or more are mapped directly and backed by transparent huge pages if the runtime was
+/// compiled with `EJC_HUGE_PAGES` defined or the environment variable `EJC_HUGE_PAGES` is set to a value other than
+/// `0`. If it is set to `explicit`, the huge pages reserved by the system are used first, with 1 GiB pages for
+/// allocations of at least that size. reallocate() then resizes these allocations without copying their content.
+void* allocate(size_t size);
+/// Releases memory obtained from allocate() or reallocate().
+void deallocate(void *memory);
+/// Resizes memory obtained from allocate(). Like realloc(), the memory may be moved and its content is preserved up to
+/// the lesser of the old and the new size.
+void* reallocate(void *memory, size_t size);
+/// Releases all memory cached by the calling thread to the system allocator and asks the system allocator to return
+/// unused memory to the operating system if it supports this.
+void trimAllocationCaches();
+/// Declares that the calling thread runs on the processors of NUMA node `node`, or on any processor if `node` is
+/// negative. The system allocator places memory on the node of the thread that first touches it, so the memory the
+/// thread allocates is local to the node. Memory allocated on another node that the thread releases is returned to
+/// the system allocator instead of being cached and reused by the thread.
+void setAllocationNode(int node);
+
+/// The memory held by the allocations of a program.
+struct MemoryUsage {
+    /// The number of bytes requested from the system allocator for allocations that have not been released. Memory
+    /// the allocator keeps cached is not included, the chunks of arenas are included as a whole.
+    int64_t bytes;
+    /// The number of allocations that have not been released.
+    int64_t allocations;
+};
+
+/// Counts memory that is not obtained from allocate(), e.g. the chunks of arenas, as live.
+///
+/// Every thread accumulates changes to the counts and adds them to the shared counts once they exceed a threshold or
+/// the thread exits, so that counting requires no synchronization in the common case.
+void countLiveMemory(ptrdiff_t bytes, ptrdiff_t allocations);
+/// Returns the memory currently held by allocations. Changes that other threads have not added to the shared counts
+/// yet are not included.
+///
+/// If the system allocator is used directly (see allocate()), the sizes of allocations are only known if the C
+/// library can report them. Otherwise only the allocations are counted.
+MemoryUsage liveMemory();
+/// Sets the number of live bytes above which the memory pressure handler is called. Zero disables the limit.
+void setMemoryLimit(int64_t bytes);
+/// Called on the thread whose allocation made the live bytes exceed the limit set with setMemoryLimit(). It is
+/// called again only after the live bytes have dropped below the limit in the meantime. The handler must not
+/// allocate memory.
+extern std::atomic<void (*)()> memoryPressureHandler;
+
+}  // namespace internal
+
+}  // namespace runtime
+
+#endif //EMOJICODE_ALLOCATOR_HPP
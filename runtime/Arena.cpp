@@ -0,0 +1,100 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "Arena.hpp"
+#include "Allocator.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace runtime {
+
+namespace internal {
+
+thread_local Arena *activeArena = nullptr;
+
+/// Chunks are aligned to kChunkSize, so that the chunk of an allocation is found by masking its address.
+struct alignas(16) Arena::Chunk {
+    /// Decremented for every allocation that is released. The arena adds the number of allocations it made from the
+    /// chunk when it retires the chunk, so that the count reaches zero exactly when the last of them is released
+    /// afterwards.
+    std::atomic<std::ptrdiff_t> live{0};
+};
+
+namespace {
+
+/// Adds *value* to *count* and returns true if the result is zero.
+bool addToLive(std::atomic<std::ptrdiff_t> &count, std::ptrdiff_t value) {
+    if (multithreaded.load(std::memory_order_relaxed)) {
+        return count.fetch_add(value, std::memory_order_acq_rel) + value == 0;
+    }
+    auto newCount = count.load(std::memory_order_relaxed) + value;
+    count.store(newCount, std::memory_order_relaxed);
+    return newCount == 0;
+}
+
+}  // namespace
+
+void Arena::activate() {
+    outer_ = activeArena;
+    activeArena = this;
+}
+
+void Arena::deactivate() {
+    activeArena = outer_;
+    if (chunk_ != nullptr) {
+        retireChunk();
+    }
+}
+
+void* Arena::allocate(size_t size) {
+    size = (size + alignof(Chunk) - 1) & ~(alignof(Chunk) - 1);
+    if (size > kMaxAllocation) {
+        return nullptr;
+    }
+    if (static_cast<size_t>(end_ - next_) < size) {
+        if (chunk_ != nullptr) {
+            retireChunk();
+        }
+        void *memory = nullptr;
+        if (posix_memalign(&memory, kChunkSize, kChunkSize) != 0) {
+            throw std::bad_alloc();
+        }
+        countLiveMemory(static_cast<ptrdiff_t>(kChunkSize), 0);
+        chunk_ = new(memory) Chunk;
+        next_ = static_cast<char *>(memory) + sizeof(Chunk);
+        end_ = static_cast<char *>(memory) + kChunkSize;
+    }
+    auto memory = next_;
+    next_ += size;
+    count_++;
+    countLiveMemory(0, 1);
+    return memory;
+}
+
+void Arena::retireChunk() {
+    if (addToLive(chunk_->live, static_cast<std::ptrdiff_t>(count_))) {
+        chunk_->~Chunk();
+        free(chunk_);
+        countLiveMemory(-static_cast<ptrdiff_t>(kChunkSize), 0);
+    }
+    chunk_ = nullptr;
+    next_ = end_ = nullptr;
+    count_ = 0;
+}
+
+void arenaRelease(ControlBlock *block) {
+    auto chunk = reinterpret_cast<Arena::Chunk *>(reinterpret_cast<uintptr_t>(block) & ~(Arena::kChunkSize - 1));
+    countLiveMemory(0, -1);
+    if (addToLive(chunk->live, -1)) {
+        chunk->~Chunk();
+        free(chunk);
+        countLiveMemory(-static_cast<ptrdiff_t>(Arena::kChunkSize), 0);
+    }
+}
+
+}  // namespace internal
+
+}  // namespace runtime
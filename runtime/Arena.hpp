@@ -0,0 +1,86 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#ifndef EMOJICODE_ARENA_HPP
+#define EMOJICODE_ARENA_HPP
+
+#include "Internal.hpp"
+#include <cstddef>
+
+namespace runtime {
+
+namespace internal {
+
+/// Set in the weak count of the control block of an allocation made from an arena. Incrementing and decrementing the
+/// count keeps the bit, so that the allocation is given back to its arena when the count drops to this value.
+constexpr int kArenaAllocation = 1 << 30;
+
+/// Precedes the control block of an allocation made from an arena.
+struct ArenaAllocation {
+    /// The number of bytes following the control block.
+    size_t size;
+};
+
+/// A region that ejcAlloc bump-allocates from while it is active on the calling thread.
+///
+/// An arena allocates chunks of kChunkSize bytes and carves the allocations out of them one after another. Allocations
+/// are reference counted like any other, but an allocation whose last reference is released is not freed on its own.
+/// Instead every chunk counts the allocations made from it that are still alive and is freed as a whole once the arena
+/// has moved on to the next chunk or was deactivated and the last of them was released. Objects that outlive the arena,
+/// e.g. because they were stored in a global variable, therefore keep their chunk alive but remain valid.
+///
+/// Only the thread that activated an arena allocates from it, the allocations may be released by any thread.
+class Arena {
+public:
+    /// Makes this arena the arena of the calling thread until deactivate() is called. The previous arena, if any, is
+    /// restored then.
+    void activate();
+    /// Stops allocating from this arena. The chunks are freed once all allocations from them have been released.
+    void deactivate();
+
+    /// Returns *size* bytes from the current chunk or null if *size* is too large to be allocated from a chunk.
+    void* allocate(size_t size);
+
+private:
+    struct Chunk;
+
+    /// Allocations larger than this are made by the regular allocator, as they would waste too much of a chunk.
+    static constexpr size_t kMaxAllocation = 4096;
+    static constexpr size_t kChunkSize = 64 * 1024;
+
+    Chunk *chunk_ = nullptr;
+    char *next_ = nullptr;
+    char *end_ = nullptr;
+    /// The number of allocations made from the current chunk.
+    size_t count_ = 0;
+    Arena *outer_ = nullptr;
+
+    /// Gives the chunk over to its allocations, which free it once they are all released.
+    void retireChunk();
+
+    friend void arenaRelease(ControlBlock *block);
+};
+
+/// The arena of the calling thread or null.
+extern thread_local Arena *activeArena;
+
+/// Returns *size* bytes from the arena of the calling thread or null if there is no arena or the size is too large.
+inline void* arenaAllocate(size_t size) {
+    auto arena = activeArena;
+    return arena != nullptr ? arena->allocate(size) : nullptr;
+}
+
+/// Whether *block* is the control block of an allocation made from an arena.
+inline bool isArenaAllocation(ControlBlock *block) {
+    return block->weakCount.load(std::memory_order_relaxed) >= kArenaAllocation;
+}
+
+/// Gives the allocation of *block*, which was made from an arena, back to its chunk.
+void arenaRelease(ControlBlock *block);
+
+}  // namespace internal
+
+}  // namespace runtime
+
+#endif //EMOJICODE_ARENA_HPP
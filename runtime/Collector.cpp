@@ -0,0 +1,170 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "Collector.hpp"
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+extern runtime::internal::ControlBlock ejcIgnoreBlock;
+
+namespace runtime {
+
+namespace internal {
+
+std::atomic_bool collectorEnabled{false};
+
+namespace {
+
+std::mutex candidatesMutex;
+std::vector<Object<void> *> candidates;
+
+/// Set while the calling thread collects cycles. The garbage the collector deinitializes is not recorded as candidate
+/// again, and deinitializers cannot start another collection.
+thread_local bool collecting = false;
+
+/// An object the collector visited.
+struct Node {
+    /// The strong count minus the number of references to the object the collector found.
+    int count;
+    bool alive = false;
+};
+
+/// Calls *body* with every object that *object* references according to its class info.
+template <typename Body>
+void eachReference(Object<void> *object, Body body) {
+    auto references = object->classInfo()->references;
+    if (references == nullptr) {
+        return;
+    }
+    for (auto offset = references; *offset != 0; offset++) {
+        auto reference = *reinterpret_cast<Object<void> **>(reinterpret_cast<char *>(object) + *offset);
+        if (reference == nullptr) {
+            continue;
+        }
+        auto block = reference->controlBlock();
+        // Objects on the stack and objects that are not reference counted are never collected.
+        if (block != nullptr && block != &ejcIgnoreBlock) {
+            body(reference);
+        }
+    }
+}
+
+/// Moves the candidates out of the buffer and returns those that have not been deinitialized yet. The allocations of
+/// the others are released.
+std::vector<Object<void> *> takeCandidates() {
+    std::vector<Object<void> *> taken;
+    {
+        std::lock_guard<std::mutex> lock(candidatesMutex);
+        taken.swap(candidates);
+    }
+    std::vector<Object<void> *> alive;
+    for (auto object : taken) {
+        auto block = object->controlBlock();
+        if (block->strongCount.load(std::memory_order_acquire) != 0) {
+            alive.emplace_back(object);
+        }
+        // Turns the candidate bit into a weak reference, which is then given up.
+        block->weakCount.fetch_sub(kCycleCandidate - 1, std::memory_order_relaxed);
+        releaseAllocation(block);
+    }
+    return alive;
+}
+
+}  // namespace
+
+void addCycleCandidate(Object<void> *object) {
+    if (collecting) {
+        return;
+    }
+    auto &weakCount = object->controlBlock()->weakCount;
+    if (multithreaded.load(std::memory_order_relaxed)) {
+        if ((weakCount.fetch_or(kCycleCandidate, std::memory_order_relaxed) & kCycleCandidate) != 0) {
+            return;
+        }
+    }
+    else {
+        weakCount.store(weakCount.load(std::memory_order_relaxed) | kCycleCandidate, std::memory_order_relaxed);
+    }
+    std::lock_guard<std::mutex> lock(candidatesMutex);
+    candidates.emplace_back(object);
+}
+
+size_t collectCycles() {
+    if (collecting) {
+        return 0;
+    }
+    collecting = true;
+    auto roots = takeCandidates();
+
+    // Subtract all references between the objects reachable from the candidates.
+    std::unordered_map<Object<void> *, Node> nodes;
+    std::vector<Object<void> *> stack;
+    auto visit = [&](Object<void> *object) -> Node& {
+        auto count = object->controlBlock()->strongCount.load(std::memory_order_acquire);
+        auto inserted = nodes.emplace(object, Node{ count });
+        if (inserted.second) {
+            stack.emplace_back(object);
+        }
+        return inserted.first->second;
+    };
+    for (auto root : roots) {
+        visit(root);
+    }
+    while (!stack.empty()) {
+        auto object = stack.back();
+        stack.pop_back();
+        eachReference(object, [&](Object<void> *reference) { visit(reference).count--; });
+    }
+
+    // Objects referenced from elsewhere keep all objects they reach alive.
+    for (auto &pair : nodes) {
+        if (pair.second.count != 0 && !pair.second.alive) {
+            pair.second.alive = true;
+            stack.emplace_back(pair.first);
+        }
+        while (!stack.empty()) {
+            auto object = stack.back();
+            stack.pop_back();
+            eachReference(object, [&](Object<void> *reference) {
+                auto &node = nodes.find(reference)->second;
+                if (!node.alive) {
+                    node.alive = true;
+                    stack.emplace_back(reference);
+                }
+            });
+        }
+    }
+
+    std::vector<Object<void> *> garbage;
+    for (auto &pair : nodes) {
+        if (!pair.second.alive) {
+            garbage.emplace_back(pair.first);
+        }
+    }
+    // The additional reference prevents that releasing the references between the objects frees any of them while
+    // others are still being deinitialized.
+    for (auto object : garbage) {
+        object->controlBlock()->strongCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    for (auto object : garbage) {
+        object->classInfo()->destructor(object);
+    }
+    size_t freed = 0;
+    for (auto object : garbage) {
+        auto block = object->controlBlock();
+        // An object that a deinitializer stored somewhere is leaked, as it has already been deinitialized.
+        if (block->strongCount.load(std::memory_order_acquire) == 1) {
+            block->strongCount.store(0, std::memory_order_relaxed);
+            releaseAllocation(block);
+            freed++;
+        }
+    }
+    collecting = false;
+    return freed;
+}
+
+}  // namespace internal
+
+}  // namespace runtime
@@ -0,0 +1,60 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#ifndef EMOJICODE_COLLECTOR_HPP
+#define EMOJICODE_COLLECTOR_HPP
+
+#include "Runtime.h"
+#include "Internal.hpp"
+#include <cstddef>
+
+namespace runtime {
+
+namespace internal {
+
+/// Set in the weak count of the control block of an object that is a candidate of the cycle collector. Like a weak
+/// reference, the bit keeps the allocation alive, so that the collector can still inspect the control block after the
+/// object was deinitialized.
+constexpr int kCycleCandidate = 1 << 29;
+
+/// Set once the program asked for reference cycles to be collected. Until then ejcRelease records no candidates.
+extern std::atomic_bool collectorEnabled;
+
+/// Records *object* as candidate. Called by recordCycleCandidate().
+void addCycleCandidate(Object<void> *object);
+
+/// Called by ejcRelease before it decrements the strong count of *object*.
+///
+/// An object can only become part of a garbage cycle when a reference to it is released but others remain, so these
+/// objects are recorded as the roots from which collectCycles() searches for cycles. Objects without references to
+/// other objects cannot be part of a cycle and are never recorded.
+inline void recordCycleCandidate(Object<void> *object) {
+    if (!collectorEnabled.load(std::memory_order_relaxed) || object->classInfo()->references == nullptr) {
+        return;
+    }
+    auto block = object->controlBlock();
+    if ((block->weakCount.load(std::memory_order_relaxed) & kCycleCandidate) == 0 &&
+        block->strongCount.load(std::memory_order_relaxed) != 1) {
+        addCycleCandidate(object);
+    }
+}
+
+/// Frees all objects that are only referenced by reference cycles and reachable from a candidate and returns their
+/// number.
+///
+/// The collector uses trial deletion: Starting at the candidates, it follows the references listed in the class infos
+/// and subtracts every reference it finds from the strong count of the referenced object in a table of its own. An
+/// object whose count is not used up is referenced from elsewhere, so that it and all objects reachable from it are
+/// alive. The remaining objects are garbage. They are deinitialized like any other object, which releases the
+/// references between them, and then freed. References the class infos do not list, e.g. those in lists and boxes,
+/// are never subtracted and therefore keep the referenced objects alive.
+///
+/// No other thread must use the objects reachable from the candidates while the cycles are collected.
+size_t collectCycles();
+
+}  // namespace internal
+
+}  // namespace runtime
+
+#endif //EMOJICODE_COLLECTOR_HPP
@@ -0,0 +1,270 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "Demangler.hpp"
+#include <cctype>
+#include <cstring>
+
+namespace runtime {
+
+namespace {
+
+void appendUtf8(std::string &string, unsigned long codePoint) {
+    if (codePoint < 0x80) {
+        string.push_back(static_cast<char>(codePoint));
+    }
+    else if (codePoint < 0x800) {
+        string.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+        string.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else if (codePoint < 0x10000) {
+        string.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+        string.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        string.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else {
+        string.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+        string.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        string.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        string.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+/// Parses the grammar of the symbols created by Mangler.cpp. Every method returns false if the symbol does not match
+/// and may leave the position anywhere in this case.
+class Demangler {
+public:
+    explicit Demangler(const std::string &symbol) : symbol_(symbol) {}
+
+    bool demangle(std::string &result) {
+        if (consume("fn_")) {
+            return function(result);
+        }
+
+        auto classInfo = symbol_.find("_class_info_");
+        if (classInfo != std::string::npos) {
+            std::string package;
+            if (!this->package(package, classInfo)) return false;
+            pos_ = classInfo + std::strlen("_class_info_");
+            result = package;
+            return identifier(result) && atEnd();
+        }
+
+        if (type(result)) {
+            return member(result);
+        }
+
+        pos_ = 0;
+        result.clear();
+        return package(result, symbol_.find('.')) && consume(".") && identifier(result) && consume("_rtti") &&
+               atEnd() && append(result, ".rtti");
+    }
+
+private:
+    const std::string &symbol_;
+    size_t pos_ = 0;
+
+    bool atEnd() const { return pos_ == symbol_.size(); }
+
+    bool lookingAt(const char *string) const {
+        return symbol_.compare(pos_, std::strlen(string), string) == 0;
+    }
+
+    bool consume(const char *string) {
+        if (!lookingAt(string)) return false;
+        pos_ += std::strlen(string);
+        return true;
+    }
+
+    static bool append(std::string &string, const char *suffix) {
+        string.append(suffix);
+        return true;
+    }
+
+    /// Parses the part of a symbol that follows its owner type.
+    bool member(std::string &out) {
+        if (atEnd()) return true;
+        if (consume("_multi")) {
+            out.append(".multi🍱");
+            do {
+                if (!type(out)) return false;
+            } while (!atEnd());
+            out.append("🍱");
+            return true;
+        }
+        if (consume(".conformances.")) {
+            out.append(".conformances.");
+            return type(out) && atEnd();
+        }
+        for (auto suffix : { ".boxRetain", ".boxRelease", ".boxInfo", ".copyRetain", ".destructor", ".copy" }) {
+            if (consume(suffix)) {
+                out.append(suffix);
+                return atEnd();
+            }
+        }
+        if (consume(".deinit")) {
+            out.append(".♻️");
+            return atEnd();
+        }
+        if (consume(".init.")) {
+            out.append(".🆕");
+        }
+        else if (consume(".type.")) {
+            out.append(".🐇");
+        }
+        else if (consume(".")) {
+            out.append(".");
+        }
+        else {
+            return false;
+        }
+        return function(out);
+    }
+
+    /// Parses the name, mood, generic arguments and parameter types of a function.
+    bool function(std::string &out) {
+        if (!identifier(out)) return false;
+        if (consume("_intrg")) {
+            out.append("❓");
+        }
+        else if (consume("_assign")) {
+            out.append("➡️");
+        }
+        while (consume("$")) {
+            std::string index;
+            if (!number(index) || !consume("_")) return false;
+            out.append("🐚");
+            if (!type(out)) return false;
+        }
+        out.push_back('(');
+        for (bool first = true; consume("-"); first = false) {
+            if (!first) out.append(", ");
+            if (!type(out)) return false;
+        }
+        out.push_back(')');
+        return atEnd();
+    }
+
+    /// Parses the package name that precedes a type and ends at *end*. The package is empty for types that are not
+    /// defined in a package, such as optionals.
+    bool package(std::string &out, size_t end) {
+        if (end == std::string::npos || end < pos_) return false;
+        for (auto i = pos_; i < end; i++) {
+            if (!std::isalnum(static_cast<unsigned char>(symbol_[i])) && symbol_[i] != '_') return false;
+        }
+        out.append(symbol_, pos_, end - pos_);
+        pos_ = end;
+        return true;
+    }
+
+    bool number(std::string &out) {
+        auto start = pos_;
+        while (!atEnd() && std::isdigit(static_cast<unsigned char>(symbol_[pos_]))) pos_++;
+        out.append(symbol_, start, pos_ - start);
+        return pos_ > start;
+    }
+
+    /// Parses the hexadecimal code points of an identifier, which are separated by underscores.
+    ///
+    /// As the Mangler does not delimit identifiers, the code points are assumed to be emojis, i.e. a code point
+    /// consists of at most five digits if it begins with 1 and of at most four digits otherwise. Any further digits
+    /// belong to whatever follows the identifier, for instance the name of the package of the next type.
+    bool identifier(std::string &out) {
+        do {
+            size_t length = 0;
+            size_t limit = symbol_[pos_] == '1' ? 5 : 4;
+            while (length < limit && pos_ + length < symbol_.size() &&
+                   std::isxdigit(static_cast<unsigned char>(symbol_[pos_ + length]))) {
+                length++;
+            }
+            if (length == 0) return false;
+            auto codePoint = std::stoul(symbol_.substr(pos_, length), nullptr, 16);
+            if (codePoint == 0 || (codePoint >= 0xD800 && codePoint < 0xE000)) return false;
+            appendUtf8(out, codePoint);
+            pos_ += length;
+        } while (!lookingAt("_assign") && pos_ + 1 < symbol_.size() && symbol_[pos_] == '_' &&
+                 std::isxdigit(static_cast<unsigned char>(symbol_[pos_ + 1])) && consume("_"));
+        return true;
+    }
+
+    /// Appends the description of the type to *out*, in the form Type::toString uses.
+    bool type(std::string &out) {
+        if (!package(out, symbol_.find('.', pos_)) || !consume(".")) return false;
+        for (auto kind : { "vt_", "class_", "enum_", "protocol_", "ty_" }) {
+            if (consume(kind)) {
+                return identifier(out);
+            }
+        }
+        if (consume("callable_")) {
+            out.append("🍇");
+            // The parameters are followed by __. The type of a parameter can begin with _. if it is in the package _.
+            while (!lookingAt("__")) {
+                if (atEnd() || !type(out)) return false;
+            }
+            pos_ += 2;
+            std::string returnType;
+            if (!type(returnType)) return false;
+            if (returnType != "◼️") {
+                out.append("➡️").append(returnType);
+            }
+            out.append("🍉");
+            return true;
+        }
+        if (consume("no_return")) {
+            out.append("◼️");
+            return true;
+        }
+        if (consume("l_")) {
+            out.push_back('L');
+            return number(out);
+        }
+        if (consume("t_")) {
+            out.push_back('T');
+            return number(out);
+        }
+        if (consume("op_")) {
+            out.append("🍬");
+            return type(out);
+        }
+        if (consume("tv_")) {
+            auto dot = symbol_.find('.', pos_);
+            if (dot == std::string::npos) return false;
+            auto kind = symbol_.compare(dot + 1, 6, "class_") == 0 ? "🐇" :
+                        symbol_.compare(dot + 1, 3, "vt_") == 0 ? "🕊" :
+                        symbol_.compare(dot + 1, 5, "enum_") == 0 ? "🦃" :
+                        symbol_.compare(dot + 1, 9, "protocol_") == 0 ? "🐊" : "";
+            out.append(kind);
+            return type(out);
+        }
+        if (consume("mp_")) {
+            out.append("🍱");
+            if (!type(out)) return false;
+            // The protocols are not delimited, the multiprotocol is assumed to extend as long as types follow.
+            while (true) {
+                auto position = pos_;
+                auto length = out.size();
+                if (atEnd() || lookingAt("__") || !type(out)) {
+                    pos_ = position;
+                    out.resize(length);
+                    break;
+                }
+            }
+            out.append("🍱");
+            return true;
+        }
+        return false;
+    }
+};
+
+}  // namespace
+
+std::string demangle(const std::string &symbol) {
+    std::string result;
+    if (Demangler(symbol).demangle(result)) {
+        return result;
+    }
+    return symbol;
+}
+
+}  // namespace runtime
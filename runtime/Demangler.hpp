@@ -0,0 +1,22 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#ifndef EMOJICODE_DEMANGLER_HPP
+#define EMOJICODE_DEMANGLER_HPP
+
+#include <string>
+
+namespace runtime {
+
+/// Converts a symbol name created by the compiler’s Mangler back into the Emojicode names it was created from, e.g.
+/// `s.class_1f368.1f43b_intrg-s.vt_1f522` into `s🍨.🐻❓(s🔢)`.
+///
+/// Types are described like the compiler describes them in messages, i.e. prefixed with the name of their package.
+/// Initializers are prefixed with 🆕 and type methods with 🐇.
+/// @returns The demangled name or *symbol* unchanged if it is not a symbol created by the Mangler.
+std::string demangle(const std::string &symbol);
+
+}  // namespace runtime
+
+#endif //EMOJICODE_DEMANGLER_HPP
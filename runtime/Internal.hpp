@@ -6,21 +6,96 @@
 #define EMOJICODE_INTERNAL_HPP
 
 #include <atomic>
+#include <cstddef>
 
 namespace runtime {
 
+template <typename Subclass>
+class Object;
+
 /// This namespace contains variables that should not be considered part of the public API
 namespace internal {
 
 extern int argc;
 extern char **argv;
-extern int seed;
+/// Returns the seed for hashing strings. It is drawn from std::random_device when it is first needed, so that programs
+/// that never hash a string do not pay for it at startup.
+int hashSeed();
+
+/// Set when the program starts its first 🧵. Until then no other thread can observe reference counts, which are
+/// therefore updated without atomic read-modify-write instructions.
+extern std::atomic_bool multithreaded;
 
+/// Switches reference counting to atomic instructions for the rest of the program. Must be called on the creating
+/// thread before any thread of the run-time library is started, so that the counts updated so far happen before the
+/// start of the new thread and all later updates on the creating thread are atomic.
+inline void becomeMultithreaded() {
+    multithreaded.store(true, std::memory_order_seq_cst);
+}
+
+/// The reference counts of a heap allocated object.
+///
+/// ejcAlloc places the control block directly in front of the object in the same allocation, the object’s first
+/// field points to it. Stack allocated objects have no control block and objects that are not reference counted
+/// point to ejcIgnoreBlock.
 struct ControlBlock {
     std::atomic_int strongCount{1};
-    std::atomic_int weakCount{0};
+    /// The number of weak references plus one as long as there are strong references. The allocation is freed when
+    /// this count reaches zero, i.e. weak references that outlive the object keep the memory (but not the object)
+    /// alive.
+    std::atomic_int weakCount{1};
+};
+
+static_assert(sizeof(ControlBlock) % alignof(void*) == 0, "The object following the control block must be aligned");
+
+/// Gives up the weak reference held on behalf of all strong references or a weak reference and frees the allocation
+/// if this was the last one.
+/// @param block The control block, which is located at the beginning of the allocation.
+void releaseAllocation(ControlBlock *block);
+
+/// Memory areas are never referenced weakly. The weak count of the control block of a memory area created by
+/// ejcMapFile is set to this value so that releasing the area unmaps it instead of deallocating it.
+constexpr int kMappedMemory = -1;
+
+/// Precedes the control block of a memory area created by ejcMapFile. The area begins at a page boundary, the mapping
+/// and the control block are stored at the end of the page in front of it.
+struct Mapping {
+    void *base;
+    size_t length;
+    /// The number of bytes of the file that were mapped.
+    size_t size;
 };
 
+static_assert(sizeof(Mapping) % alignof(void*) == 0, "The control block following the mapping must be aligned");
+
+/// The weak count of the control block of a memory area created by ejcMemoryAligned, which is preceded by an
+/// AlignedAllocation.
+constexpr int kAlignedMemory = -2;
+
+/// Precedes the control block of a memory area created by ejcMemoryAligned. The control block is placed so that the
+/// content of the area begins at a multiple of the alignment, the allocation begins at *base*.
+struct AlignedAllocation {
+    void *base;
+    size_t alignment;
+    /// The number of bytes of the memory area.
+    size_t size;
+};
+
+static_assert(sizeof(AlignedAllocation) % alignof(void*) == 0,
+              "The control block following the aligned allocation must be aligned");
+
+/// Returns a key that has not been returned before, for use with threadLocal().
+size_t newThreadLocalKey();
+
+/// Returns the slot of the calling thread for the thread-local value with *key*, which is null until a value is set.
+/// The slot holds a reference to its object.
+Object<void>*& threadLocal(size_t key);
+
+/// Releases the thread-local values of the calling thread. 🧵 calls this function before its thread finishes so that
+/// the values are released while the thread can still run arbitrary code. Values of other threads are released when
+/// their thread-local storage is destroyed.
+void releaseThreadLocals();
+
 struct Capture {
     ControlBlock *controlBlock;
     void (*deinit)(Capture*);
@@ -0,0 +1,112 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "Pool.hpp"
+#include "Allocator.hpp"
+#include <cstddef>
+#include <new>
+
+namespace runtime {
+
+namespace internal {
+
+namespace {
+
+struct FreeAllocation {
+    FreeAllocation *next;
+};
+
+/// The number of pools that can have free lists. Instances of classes whose pool was indexed beyond this are never
+/// pooled.
+constexpr size_t kMaxPools = 256;
+/// The maximum number of bytes a thread keeps on the free list of a pool. At least one allocation is kept regardless.
+constexpr size_t kPoolBytes = 256 * 1024;
+
+std::atomic<int64_t> nextIndex{1};
+
+/// This struct is trivial so that accessing it does not require a guard.
+struct ThreadPools {
+    FreeAllocation *lists[kMaxPools];
+    uint32_t counts[kMaxPools];
+    /// Set once the thread is exiting. Allocations are then always released as usual.
+    bool exiting;
+};
+
+thread_local ThreadPools pools;
+
+/// Returns the allocations kept by a thread when the thread exits.
+struct ThreadPoolsReclaimer {
+    ~ThreadPoolsReclaimer() {
+        pools.exiting = true;
+        trimObjectPools();
+    }
+};
+
+/// Returns the index of the free lists of *pool* plus one, assigning one if necessary.
+int64_t indexOf(Pool *pool) {
+    auto index = pool->index.load(std::memory_order_relaxed);
+    if (index != 0) {
+        return index;
+    }
+    int64_t expected = 0;
+    index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+    if (!pool->index.compare_exchange_strong(expected, index, std::memory_order_relaxed)) {
+        return expected;
+    }
+    return index;
+}
+
+}  // namespace
+
+ControlBlock* poolTake(Pool *pool) {
+    auto index = pool->index.load(std::memory_order_relaxed);
+    if (index == 0 || index > static_cast<int64_t>(kMaxPools)) {
+        return nullptr;
+    }
+    auto &list = pools.lists[index - 1];
+    if (list == nullptr) {
+        return nullptr;
+    }
+    auto allocation = list;
+    list = allocation->next;
+    pools.counts[index - 1]--;
+    return new(allocation) ControlBlock;
+}
+
+bool poolGive(Pool *pool, ControlBlock *block) {
+    auto index = indexOf(pool);
+    if (pools.exiting || index > static_cast<int64_t>(kMaxPools)) {
+        return false;
+    }
+    auto bytes = sizeof(ControlBlock) + static_cast<size_t>(pool->size);
+    auto &count = pools.counts[index - 1];
+    if (count > 0 && count >= kPoolBytes / bytes) {
+        return false;
+    }
+    static thread_local ThreadPoolsReclaimer reclaimer;
+    (void)reclaimer;
+
+    block->~ControlBlock();
+    auto allocation = reinterpret_cast<FreeAllocation *>(block);
+    allocation->next = pools.lists[index - 1];
+    pools.lists[index - 1] = allocation;
+    count++;
+    return true;
+}
+
+void trimObjectPools() {
+    for (size_t i = 0; i < kMaxPools; i++) {
+        for (auto allocation = pools.lists[i]; allocation != nullptr;) {
+            auto next = allocation->next;
+            deallocate(allocation);
+            allocation = next;
+        }
+        pools.lists[i] = nullptr;
+        pools.counts[i] = 0;
+    }
+}
+
+}  // namespace internal
+
+}  // namespace runtime
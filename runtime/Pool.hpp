@@ -0,0 +1,44 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#ifndef EMOJICODE_POOL_HPP
+#define EMOJICODE_POOL_HPP
+
+#include "Internal.hpp"
+#include <atomic>
+#include <cstdint>
+
+namespace runtime {
+
+namespace internal {
+
+/// The pool of a class declared with 🏊. The compiler emits one for every such class and references it from the class
+/// info.
+///
+/// Every thread keeps a free list of allocations per pool. The allocation of an instance whose last reference is
+/// released is put on the free list of the releasing thread instead of being freed, and ejcPoolAlloc takes allocations
+/// from the free list of the calling thread before it falls back to ejcAlloc. Unlike the size classes of the allocator,
+/// this also works for instances of large classes.
+struct Pool {
+    /// The size of an instance in bytes, as passed to ejcAlloc.
+    int64_t size;
+    /// The index of the free lists of this pool plus one, or zero until an allocation was pooled for the first time.
+    std::atomic<int64_t> index;
+};
+
+/// Takes an allocation for an instance from the free list of *pool* of the calling thread.
+/// @returns The control block of the allocation or null if the free list is empty.
+ControlBlock* poolTake(Pool *pool);
+/// Puts the allocation of an instance, whose strong and weak counts have dropped to zero, on the free list of *pool*
+/// of the calling thread.
+/// @returns False if the free list is full, in which case the allocation must be released as usual.
+bool poolGive(Pool *pool, ControlBlock *block);
+/// Frees all allocations on the free lists of the calling thread.
+void trimObjectPools();
+
+}  // namespace internal
+
+}  // namespace runtime
+
+#endif //EMOJICODE_POOL_HPP
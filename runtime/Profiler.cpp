@@ -0,0 +1,195 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "Profiler.hpp"
+#include "Demangler.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cinttypes>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <map>
+#include <string>
+#include <sys/time.h>
+#include <unordered_map>
+#include <vector>
+
+// Weak so that programs link even if dladdr is in a library that is not linked. Functions are then shown by address.
+extern "C" int dladdr(const void *address, Dl_info *info) __attribute__((weak));
+
+namespace runtime {
+
+namespace internal {
+
+namespace {
+
+constexpr int kMaxDepth = 64;
+/// The frames of the signal handler and the signal trampoline, which precede the frames of the interrupted thread.
+constexpr int kHandlerFrames = 2;
+/// The number of distinct stacks that can be recorded. Samples of further stacks are dropped.
+constexpr size_t kStackCount = 1 << 14;
+
+struct Stack {
+    uint64_t hash;
+    int depth;
+    uint64_t samples;
+    void *frames[kMaxDepth];
+};
+
+/// The samples are recorded by the signal handler, which must not allocate memory or take locks. The stacks are
+/// therefore stored in a hash table that is allocated when the profiler starts and is never resized.
+struct Profile {
+    std::string path;
+    std::vector<Stack> stacks = std::vector<Stack>(kStackCount);
+    /// Set while a signal handler records a sample. Samples that arrive on another thread meanwhile are dropped.
+    std::atomic_flag busy = ATOMIC_FLAG_INIT;
+    std::atomic<uint64_t> dropped{0};
+};
+
+Profile *profile = nullptr;
+
+uint64_t hashFrames(void **frames, int depth) {
+    uint64_t hash = 14695981039346656037u;
+    for (int i = 0; i < depth; i++) {
+        hash = (hash ^ reinterpret_cast<uintptr_t>(frames[i])) * 1099511628211u;
+    }
+    return hash;
+}
+
+void sample(int) {
+    auto savedErrno = errno;
+    if (profile->busy.test_and_set(std::memory_order_acquire)) {
+        profile->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    void *frames[kMaxDepth + kHandlerFrames];
+    auto depth = backtrace(frames, kMaxDepth + kHandlerFrames) - kHandlerFrames;
+    if (depth > 0) {
+        auto hash = hashFrames(frames + kHandlerFrames, depth);
+        bool recorded = false;
+        for (size_t probe = 0; probe < kStackCount && !recorded; probe++) {
+            auto &stack = profile->stacks[(hash + probe) % kStackCount];
+            if (stack.depth == 0) {
+                stack.hash = hash;
+                stack.depth = depth;
+                std::memcpy(stack.frames, frames + kHandlerFrames, depth * sizeof(void *));
+            }
+            else if (stack.hash != hash || stack.depth != depth ||
+                     std::memcmp(stack.frames, frames + kHandlerFrames, depth * sizeof(void *)) != 0) {
+                continue;
+            }
+            stack.samples++;
+            recorded = true;
+        }
+        if (!recorded) {
+            profile->dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    profile->busy.clear(std::memory_order_release);
+    errno = savedErrno;
+}
+
+/// Returns the demangled name of the function containing *address*, or the file and offset if the function has no
+/// symbol.
+std::string symbolize(void *address) {
+    Dl_info info;
+    if (dladdr != nullptr && dladdr(address, &info) != 0) {
+        if (info.dli_sname != nullptr) {
+            return demangle(info.dli_sname);
+        }
+        if (info.dli_fname != nullptr) {
+            auto name = std::strrchr(info.dli_fname, '/');
+            char buffer[256];
+            std::snprintf(buffer, sizeof(buffer), "%s+0x%tx", name != nullptr ? name + 1 : info.dli_fname,
+                          static_cast<char *>(address) - static_cast<char *>(info.dli_fbase));
+            return buffer;
+        }
+    }
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%p", address);
+    return buffer;
+}
+
+void write() {
+    itimerval stop{};
+    setitimer(ITIMER_PROF, &stop, nullptr);
+    while (profile->busy.test_and_set(std::memory_order_acquire)) {}
+
+    auto file = std::fopen(profile->path.c_str(), "w");
+    if (file == nullptr) {
+        std::fprintf(stderr, "Could not write the profile to %s: %s\n", profile->path.c_str(), std::strerror(errno));
+        return;
+    }
+
+    // Stacks that differ in the addresses within the functions are merged.
+    std::unordered_map<void *, std::string> names;
+    std::map<std::string, uint64_t> lines;
+    for (auto &stack : profile->stacks) {
+        if (stack.depth == 0) continue;
+        std::string line;
+        for (int i = stack.depth - 1; i >= 0; i--) {
+            // Except for the innermost frame, the frames are return addresses, which can already belong to the next
+            // function if the call was the last instruction of the function.
+            auto address = i == 0 ? stack.frames[i] : static_cast<char *>(stack.frames[i]) - 1;
+            auto it = names.find(address);
+            if (it == names.end()) {
+                it = names.emplace(address, symbolize(address)).first;
+            }
+            if (!line.empty()) line.push_back(';');
+            line.append(it->second);
+        }
+        lines[line] += stack.samples;
+    }
+    for (auto &line : lines) {
+        std::fprintf(file, "%s %" PRIu64 "\n", line.first.c_str(), line.second);
+    }
+    std::fclose(file);
+
+    if (auto dropped = profile->dropped.load(std::memory_order_relaxed)) {
+        std::fprintf(stderr, "The profiler dropped %" PRIu64 " samples.\n", dropped);
+    }
+}
+
+}  // namespace
+
+void startProfiler() {
+    auto path = std::getenv("EJC_PROFILE");
+    if (path == nullptr || *path == '\0') return;
+    long frequency = 100;
+    if (auto value = std::getenv("EJC_PROFILE_FREQUENCY")) {
+        frequency = std::max(1L, std::min(std::strtol(value, nullptr, 10), 1000000L));
+    }
+
+    profile = new Profile;
+    profile->path = path;
+
+    // The first call to backtrace can load the unwinder, which allocates memory and must not happen in the handler.
+    void *frames[1];
+    backtrace(frames, 1);
+
+    struct sigaction action{};
+    action.sa_handler = sample;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGPROF, &action, nullptr);
+    std::atexit(write);
+
+    itimerval timer{};
+    timer.it_interval.tv_sec = frequency == 1 ? 1 : 0;
+    timer.it_interval.tv_usec = frequency == 1 ? 0 : 1000000 / frequency;
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_PROF, &timer, nullptr);
+}
+
+}  // namespace internal
+
+}  // namespace runtime
@@ -0,0 +1,27 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#ifndef EMOJICODE_PROFILER_HPP
+#define EMOJICODE_PROFILER_HPP
+
+namespace runtime {
+
+namespace internal {
+
+/// Starts the sampling profiler if the environment variable `EJC_PROFILE` is set to a path.
+///
+/// The profiler interrupts the program with SIGPROF `EJC_PROFILE_FREQUENCY` times (100 by default) per second of CPU
+/// time and records the call stack of the interrupted thread. When the program exits, the stacks are written to the
+/// path in the folded format, i.e. one line per distinct stack with the demangled names of the functions from the
+/// outermost to the innermost function separated by semicolons, followed by the number of samples. This format is
+/// understood by flame graph tools and can be converted into pprof profiles.
+///
+/// Functions of the executable are only named if it was linked with -rdynamic, which `emojicodec -g` does.
+void startProfiler();
+
+}  // namespace internal
+
+}  // namespace runtime
+
+#endif //EMOJICODE_PROFILER_HPP
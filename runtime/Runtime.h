@@ -14,18 +14,37 @@
 #include <cstdlib>
 #include <type_traits>
 #include <new>
+#include <string_view>
 #include <utility>
 
 namespace runtime {
 namespace internal {
 struct ControlBlock;
-ControlBlock* newControlBlock();
 struct Capture;
+struct Pool;
 }
 }
 
+#ifndef EJC_BOX_SIZE
+/// The number of bytes a box provides for storing a value. Values of value types that are larger are allocated on the
+/// heap and the box stores pointers to them. The compiler, the runtime and all packages must agree on this size, which
+/// is set with the CMake option EMOJICODE_BOX_SIZE.
+#define EJC_BOX_SIZE 32
+#endif
+
 extern "C" int8_t* ejcAlloc(int64_t size);
-extern "C" [[noreturn]] void ejcPanic(const char *message);
+extern "C" int8_t* ejcMapFile(int descriptor, int64_t size);
+extern "C" int8_t* ejcMapShared(int descriptor, int64_t size);
+extern "C" [[noreturn]] void ejcPanic(const char *message) __attribute__((cold));
+/// Prepares the run-time library with the command-line arguments *argc* and *argv*. A program that loads a shared
+/// library linked with `--shared` must call it once before it calls any function of the library. The host may call
+/// into the library from any of its threads, so reference counts are updated atomically from the start.
+extern "C" void ejcSetUp(int argc, char **argv);
+/// Like ejcSetUp() but for executables and programs run with `--run`, which call it before 🏁. Such programs begin on
+/// a single thread and only update reference counts atomically once they start another one.
+extern "C" void ejcSetUpProgram(int argc, char **argv);
+/// The control block of all objects and memory areas that are not reference counted.
+extern runtime::internal::ControlBlock ejcIgnoreBlock;
 
 namespace runtime {
 
@@ -54,6 +73,17 @@ struct ClassInfo {
     void *protocolTable;
     ClassInfo *superclass;
     void (*destructor)(void*);
+    /// The number of superclasses of this class.
+    size_t depth;
+    /// The class infos of all superclasses starting with the root class followed by this class info.
+    /// `display[superclass->depth] == superclass` holds for any superclass.
+    ClassInfo **display;
+    /// The offsets of the instance variables, including those nested in value types, that reference objects, terminated
+    /// by zero. Null if instances store no references that can be enumerated, e.g. if the class is native. Used by the
+    /// cycle collector.
+    const int64_t *references;
+    /// The pool that instances are recycled through if the class was declared with 🏊, otherwise null.
+    internal::Pool *pool;
 
     template <typename Return, typename ObjectType, typename ...Args>
     Return dispatch(size_t virtualTableIndex, ObjectType *object, Args... args) const {
@@ -65,6 +95,12 @@ template <typename T>
 class MemoryPointer {
     template <typename TA>
     friend inline MemoryPointer<TA> allocate(int64_t n);
+    template <typename TA>
+    friend inline MemoryPointer<TA> allocateStatic(int64_t n);
+    template <typename TA>
+    friend inline bool mapFile(int descriptor, int64_t size, MemoryPointer<TA> *memory);
+    template <typename TA>
+    friend inline bool mapShared(int descriptor, int64_t size, MemoryPointer<TA> *memory);
 public:
     MemoryPointer() {}
     T* get() const {
@@ -75,8 +111,12 @@ public:
         return get()[index];
     }
 
+    internal::ControlBlock* controlBlock() const { return *reinterpret_cast<internal::ControlBlock **>(pointer_); }
+
     void retain();
     void release();
+    /// Returns true if this is the only reference to the memory area.
+    bool isOnlyReference() const;
     
 private:
     explicit MemoryPointer(int8_t *pointer) : pointer_(pointer) {}
@@ -88,6 +128,40 @@ inline MemoryPointer<T> allocate(int64_t n = 1) {
     return MemoryPointer<T>(ejcAlloc(sizeof(T) * n + sizeof(runtime::internal::ControlBlock *)));
 }
 
+/// Like allocate() but the memory is never deallocated. Retaining and releasing it has no effect.
+template <typename T>
+inline MemoryPointer<T> allocateStatic(int64_t n = 1) {
+    auto memory = allocate<T>(n);
+    *reinterpret_cast<runtime::internal::ControlBlock **>(memory.pointer_) = &ejcIgnoreBlock;
+    return memory;
+}
+
+/// Maps the first *size* bytes of the file *descriptor* into a memory area, which starts at a page boundary and is
+/// unmapped once the last reference to it is released. The mapping is private: writes to the memory area are not
+/// carried through to the file. The descriptor can be closed afterwards.
+/// @returns False and sets `errno` if the file cannot be mapped.
+template <typename T>
+inline bool mapFile(int descriptor, int64_t size, MemoryPointer<T> *memory) {
+    auto pointer = ejcMapFile(descriptor, size);
+    if (pointer == nullptr) {
+        return false;
+    }
+    *memory = MemoryPointer<T>(pointer);
+    return true;
+}
+
+/// Like mapFile() but the mapping is shared: writes to the memory area are carried through to the file and are visible
+/// to all processes that map the same file.
+template <typename T>
+inline bool mapShared(int descriptor, int64_t size, MemoryPointer<T> *memory) {
+    auto pointer = ejcMapShared(descriptor, size);
+    if (pointer == nullptr) {
+        return false;
+    }
+    *memory = MemoryPointer<T>(pointer);
+    return true;
+}
+
 template <typename Subclass>
 class Object {
 public:
@@ -97,7 +171,19 @@ public:
     static Subclass* init(Args&& ...args) {
         static_assert(util::is_complete<ClassInfoFor<Subclass>>::value,
                       "Provide class info for this class with SET_INFO_FOR.");
-        return new(malloc(sizeof(Subclass))) Subclass(std::forward<Args>(args)...);
+        auto memory = ejcAlloc(sizeof(Subclass));
+        auto block = *reinterpret_cast<internal::ControlBlock **>(memory);
+        auto object = new(memory) Subclass(std::forward<Args>(args)...);
+        object->block_ = block;
+        return object;
+    }
+
+    /// Like init() but creates an object that is never deallocated. Retaining and releasing it has no effect.
+    template <typename ...Args>
+    static Subclass* initStatic(Args&& ...args) {
+        auto object = init(std::forward<Args>(args)...);
+        object->block_ = &ejcIgnoreBlock;
+        return object;
     }
 
     internal::ControlBlock* controlBlock() const { return block_; }
@@ -105,8 +191,11 @@ public:
 
     void retain();
     void release();
+    /// Returns true if this is the only reference to the object. Always false for objects that are not reference
+    /// counted.
+    bool isOnlyReference();
 protected:
-    Object() : block_(internal::newControlBlock()), classInfo_(ClassInfoFor<Subclass>::value) {}
+    Object() : block_(nullptr), classInfo_(ClassInfoFor<Subclass>::value) {}
 private:
     internal::ControlBlock *block_;
     const ClassInfo *classInfo_;
@@ -161,8 +250,10 @@ private:
 
 class Raiser {
 public:
+    /// Marked cold so that the C++ compiler moves the code that constructs the error, which EJC_RAISE evaluates right
+    /// before this call, out of the hot path of the raising function.
     template <typename T>
-    void raise(T *errorObj, const char *location) {
+    __attribute__((cold)) void raise(T *errorObj, const char *location) {
         errorDestination_ = errorObj;
     }
 private:
@@ -174,6 +265,16 @@ private:
 #define EJC_RAISE(raiser, error) raiser->raise(error, __FILE__ ":" S2(__LINE__)); return {};
 #define EJC_RAISE_VOID(raiser, error) raiser->raise(error, __FILE__ ":" S2(__LINE__)); return;
 
+/// Compiles the function that follows once for AVX2 and once for the baseline instruction set. The dynamic loader
+/// selects the version the processor supports when the function is first called. This is only done on x86-64 ELF
+/// platforms, as it relies on ifuncs, and should only be used for hot loops that the compiler can vectorize.
+#if defined(__x86_64__) && defined(__ELF__) && ((defined(__clang__) && __clang_major__ >= 14) || \
+    (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 6))
+#define EJC_MULTIVERSIONED __attribute__((target_clones("avx2", "default")))
+#else
+#define EJC_MULTIVERSIONED
+#endif
+
 template <typename Return, typename ...Args>
 class Callable {
 public:
@@ -192,6 +293,7 @@ extern "C" void ejcRetain(runtime::Object<void> *object);
 extern "C" void ejcRelease(runtime::Object<void> *object);
 extern "C" void ejcReleaseCapture(runtime::internal::Capture *capture);
 extern "C" void ejcReleaseMemory(runtime::Object<void> *object);
+extern "C" bool ejcIsOnlyReference(runtime::Object<void> *object);
 
 template <typename Return, typename ...Args>
 void Callable<Return, Args...>::retain() const {
@@ -213,6 +315,11 @@ void Object<Subclass>::release() {
     ejcRelease(reinterpret_cast<runtime::Object<void> *>(this));
 }
 
+template <typename Subclass>
+bool Object<Subclass>::isOnlyReference() {
+    return ejcIsOnlyReference(reinterpret_cast<runtime::Object<void> *>(this));
+}
+
 template <typename Type>
 void MemoryPointer<Type>::retain() {
     ejcRetain(reinterpret_cast<runtime::Object<void> *>(pointer_));
@@ -223,6 +330,126 @@ void MemoryPointer<Type>::release() {
     ejcReleaseMemory(reinterpret_cast<runtime::Object<void> *>(pointer_));
 }
 
+template <typename Type>
+bool MemoryPointer<Type>::isOnlyReference() const {
+    return ejcIsOnlyReference(reinterpret_cast<runtime::Object<void> *>(pointer_));
+}
+
+/// The layout of a box, in which generic code such as 🍨 and 🍯 stores values whose type it does not know.
+struct Box {
+    /// The box info of the type of the value or null if the box contains no value.
+    const void *info;
+    int8_t value[EJC_BOX_SIZE];
+
+    /// Returns the value in the box, which must be of type *T*. Values that are larger than EJC_BOX_SIZE are stored
+    /// on the heap and cannot be read with this method.
+    template <typename T>
+    const T& get() const {
+        static_assert(sizeof(T) <= EJC_BOX_SIZE, "The value is stored on the heap.");
+        return *reinterpret_cast<const T *>(value);
+    }
+};
+
+// The following views let C++ code that calls functions exported with 📻 inspect the 🔡, 🍨 and 🍯 it is passed or
+// returned without copying them. 🍨 and 🍯 are passed to exported functions by reference. A view does not retain
+// what it views and is only valid as long as the value is referenced and not mutated.
+
+/// A view of the UTF-8 encoded characters of a 🔡.
+class StringView {
+public:
+    /// The layout of the instances of 🔡 (s::String).
+    struct Layout {
+        internal::ControlBlock *block;
+        const ClassInfo *classInfo;
+        MemoryPointer<char> characters;
+        Integer count;
+        Integer hash;
+        Integer ascii;
+        Integer start;
+        SimpleOptional<MemoryPointer<int8_t>> graphemeCheckpoints;
+    };
+
+    /// @param string A 🔡, i.e. an s::String.
+    explicit StringView(const void *string) : string_(static_cast<const Layout *>(string)) {}
+
+    const char* data() const { return string_->characters.get() + string_->start; }
+    /// The number of bytes of the string.
+    size_t size() const { return static_cast<size_t>(string_->count); }
+
+    operator std::string_view() const { return std::string_view(data(), size()); }
+
+private:
+    const Layout *string_;
+};
+
+/// A view of the elements of a 🍨.
+class ListView {
+public:
+    /// The layout of the backing store of 🍨 (🍧).
+    struct Layout {
+        internal::ControlBlock *block;
+        const ClassInfo *classInfo;
+        MemoryPointer<Box> data;
+        Integer count;
+        Integer size;
+    };
+
+    /// @param list A 🍨, which consists of a reference to its backing store.
+    explicit ListView(const void *list) : storage_(*static_cast<const Layout *const *>(list)) {}
+
+    Integer size() const { return storage_->count; }
+    const Box& operator[](Integer index) const { return storage_->data[index]; }
+
+    const Box* begin() const { return storage_->count == 0 ? nullptr : storage_->data.get(); }
+    const Box* end() const { return begin() + storage_->count; }
+
+private:
+    const Layout *storage_;
+};
+
+/// A view of the entries of a 🍯.
+class DictionaryView {
+public:
+    /// The layout of the backing store of 🍯 (🌸). The memory area holds one control byte per slot, which is greater
+    /// than 1 if the slot holds an entry, followed by the slots. A slot holds the hash, the key and a box with the
+    /// value of an entry.
+    struct StoreLayout {
+        internal::ControlBlock *block;
+        const ClassInfo *classInfo;
+        Integer capacity;
+        Integer slotSize;
+        Integer occupied;
+        MemoryPointer<uint8_t> data;
+    };
+    /// The layout of 🍯.
+    struct Layout {
+        const StoreLayout *store;
+        Integer count;
+    };
+
+    /// @param dictionary A 🍯.
+    explicit DictionaryView(const void *dictionary) : dictionary_(static_cast<const Layout *>(dictionary)) {}
+
+    Integer size() const { return dictionary_->count; }
+
+    /// Calls *body* with a StringView of the key and the box of the value of every entry in no particular order.
+    template <typename Body>
+    void forEach(Body body) const {
+        auto store = dictionary_->store;
+        auto control = store->data.get();
+        for (Integer i = 0; i < store->capacity; i++) {
+            if (control[i] > 1) {
+                auto slot = control + store->capacity + i * store->slotSize;
+                body(StringView(*reinterpret_cast<void *const *>(slot + sizeof(Integer))),
+                     *reinterpret_cast<const Box *>(slot + 2 * sizeof(Integer)));
+            }
+        }
+    }
+
+private:
+    const Layout *dictionary_;
+};
+
 }  // namespace runtime
 
 #endif /* Runtime_h */
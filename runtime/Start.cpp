@@ -0,0 +1,17 @@
+//
+//  Start.cpp
+//  EmojicodeCompiler
+//
+
+#include "Runtime.h"
+
+extern "C" runtime::Integer fn_1f3c1();
+
+// main is kept apart from the rest of the run-time library, so that the linker only takes it from the archive into
+// executables. Shared libraries have no 🏁 and are set up by their host with ejcSetUp.
+int main(int largc, char **largv) {
+    ejcSetUpProgram(largc, largv);
+
+    auto code = fn_1f3c1();
+    return static_cast<int>(code);
+}
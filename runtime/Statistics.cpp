@@ -0,0 +1,251 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "Statistics.hpp"
+
+#ifdef EJC_STATISTICS
+
+#include "Demangler.hpp"
+#include "Runtime.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cinttypes>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Weak so that programs link even if dladdr is in a library that is not linked. Classes are then shown by address.
+extern "C" int dladdr(const void *address, Dl_info *info) __attribute__((weak));
+
+namespace runtime {
+
+namespace internal {
+
+namespace {
+
+constexpr size_t kStatisticCount = static_cast<size_t>(Statistic::Deinitialization) + 1;
+/// Allocation sizes are counted by the number of bits needed to represent them, i.e. bucket i counts the sizes from
+/// 2^(i-1) up to but not including 2^i.
+constexpr size_t kSizeBucketCount = 65;
+
+const char *kStatisticNames[kStatisticCount] = {
+    "allocations", "retains", "memory retains", "releases", "local releases", "capture releases", "memory releases",
+    "releases without deinit", "deinitializations",
+};
+
+struct ClassCounts {
+    uint64_t releases = 0;
+    uint64_t deinitializations = 0;
+};
+
+/// The counts of one thread. Only the thread itself changes them. They are atomic so that they can be read by the
+/// thread that prints the statistics while the thread runs.
+struct Counters {
+    std::array<std::atomic<uint64_t>, kStatisticCount> statistics{};
+    std::array<std::atomic<uint64_t>, kSizeBucketCount> sizes{};
+    std::atomic<uint64_t> bytes{0};
+    std::mutex classesMutex;
+    std::unordered_map<const ClassInfo *, ClassCounts> classes;
+};
+
+/// Increments a counter that is only changed by one thread.
+inline void increment(std::atomic<uint64_t> &counter, uint64_t value = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+struct Totals {
+    std::array<uint64_t, kStatisticCount> statistics{};
+    std::array<uint64_t, kSizeBucketCount> sizes{};
+    uint64_t bytes = 0;
+    std::unordered_map<const ClassInfo *, ClassCounts> classes;
+
+    void add(Counters &counters) {
+        for (size_t i = 0; i < kStatisticCount; i++) {
+            statistics[i] += counters.statistics[i].load(std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < kSizeBucketCount; i++) {
+            sizes[i] += counters.sizes[i].load(std::memory_order_relaxed);
+        }
+        bytes += counters.bytes.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(counters.classesMutex);
+        for (auto &entry : counters.classes) {
+            auto &counts = classes[entry.first];
+            counts.releases += entry.second.releases;
+            counts.deinitializations += entry.second.deinitializations;
+        }
+    }
+};
+
+/// The counters of all running threads and the counts of the threads that finished.
+struct Registry {
+    std::mutex mutex;
+    std::vector<Counters *> threads;
+    Totals finished;
+    /// Counts operations of threads whose counters were already destroyed. Guarded by mutex.
+    Counters late;
+};
+
+/// The registry is never destroyed, as threads can still count while the program exits.
+Registry& registry() {
+    static auto registry = new Registry;
+    return *registry;
+}
+
+struct ThreadCounters {
+    Counters counters;
+
+    ThreadCounters() {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        registry().threads.push_back(&counters);
+    }
+
+    ~ThreadCounters();
+};
+
+thread_local ThreadCounters threadCounters;
+/// Set once the counters of the thread were destroyed. Trivial, so that reading it does not construct threadCounters.
+thread_local bool threadCountersDestroyed;
+
+ThreadCounters::~ThreadCounters() {
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    auto &threads = registry().threads;
+    threads.erase(std::find(threads.begin(), threads.end(), &counters));
+    registry().finished.add(counters);
+    threadCountersDestroyed = true;
+}
+
+std::atomic_bool printRequested{false};
+
+std::string className(const ClassInfo *classInfo) {
+    Dl_info info;
+    if (dladdr != nullptr && dladdr(classInfo, &info) != 0 && info.dli_saddr == classInfo &&
+        info.dli_sname != nullptr) {
+        return demangle(info.dli_sname);
+    }
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%p", static_cast<const void *>(classInfo));
+    return buffer;
+}
+
+void print() {
+    Totals totals;
+    {
+        auto &registry = internal::registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        totals = registry.finished;
+        for (auto counters : registry.threads) {
+            totals.add(*counters);
+        }
+        totals.add(registry.late);
+    }
+
+    std::fprintf(stderr, "Emojicode runtime statistics\n");
+    for (size_t i = 0; i < kStatisticCount; i++) {
+        std::fprintf(stderr, "  %-26s%16" PRIu64 "\n", kStatisticNames[i], totals.statistics[i]);
+    }
+    std::fprintf(stderr, "  %-26s%16" PRIu64 "\n", "allocated bytes", totals.bytes);
+
+    std::fprintf(stderr, "Allocations by size\n");
+    for (size_t i = 0; i < kSizeBucketCount; i++) {
+        if (totals.sizes[i] == 0) continue;
+        auto low = i == 0 ? 0 : uint64_t(1) << (i - 1);
+        std::fprintf(stderr, "  %10" PRIu64 " to %-13s%16" PRIu64 "\n", low,
+                     i == kSizeBucketCount - 1 ? "max" : std::to_string((uint64_t(1) << i) - 1).c_str(),
+                     totals.sizes[i]);
+    }
+
+    std::vector<std::pair<const ClassInfo *, ClassCounts>> classes(totals.classes.begin(), totals.classes.end());
+    std::sort(classes.begin(), classes.end(), [](auto &a, auto &b) {
+        return a.second.releases > b.second.releases;
+    });
+    std::fprintf(stderr, "Classes%38s%18s\n", "releases", "deinitializations");
+    for (auto &entry : classes) {
+        std::fprintf(stderr, "  %-34s%9" PRIu64 "%18" PRIu64 "\n", className(entry.first).c_str(),
+                     entry.second.releases, entry.second.deinitializations);
+    }
+}
+
+/// Only requests the statistics to be printed, as printing them is not async-signal-safe. They are printed by the
+/// next thread that counts an operation.
+void requestPrint(int) {
+    printRequested.store(true, std::memory_order_relaxed);
+}
+
+/// Prints the statistics when the program exits or receives SIGUSR1.
+struct Installer {
+    Installer() {
+        std::atexit(print);
+        std::signal(SIGUSR1, requestPrint);
+    }
+} installer;
+
+Counters* currentCounters() {
+    if (printRequested.load(std::memory_order_relaxed) && printRequested.exchange(false)) {
+        print();
+    }
+    if (threadCountersDestroyed) {
+        return nullptr;
+    }
+    return &threadCounters.counters;
+}
+
+/// Counts the operation of a thread whose counters were destroyed.
+template <typename Function>
+void countLate(Function function) {
+    auto &registry = internal::registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    function(registry.late);
+}
+
+}  // namespace
+
+void countAllocation(size_t size) {
+    auto function = [size](Counters &counters) {
+        increment(counters.statistics[static_cast<size_t>(Statistic::Allocation)]);
+        increment(counters.bytes, size);
+        size_t bucket = 0;
+        while (bucket < 64 && (size >> bucket) != 0) bucket++;
+        increment(counters.sizes[bucket]);
+    };
+    if (auto counters = currentCounters()) {
+        function(*counters);
+    }
+    else {
+        countLate(function);
+    }
+}
+
+void count(Statistic statistic, const ClassInfo *classInfo) {
+    auto function = [statistic, classInfo](Counters &counters) {
+        increment(counters.statistics[static_cast<size_t>(statistic)]);
+        if (classInfo == nullptr) return;
+        std::lock_guard<std::mutex> lock(counters.classesMutex);
+        auto &counts = counters.classes[classInfo];
+        if (statistic == Statistic::Deinitialization) {
+            counts.deinitializations++;
+        }
+        else {
+            counts.releases++;
+        }
+    };
+    if (auto counters = currentCounters()) {
+        function(*counters);
+    }
+    else {
+        countLate(function);
+    }
+}
+
+}  // namespace internal
+
+}  // namespace runtime
+
+#endif
@@ -0,0 +1,50 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#ifndef EMOJICODE_STATISTICS_HPP
+#define EMOJICODE_STATISTICS_HPP
+
+#include <cstddef>
+
+namespace runtime {
+
+struct ClassInfo;
+
+namespace internal {
+
+/// The operations counted if the runtime was compiled with `EJC_STATISTICS` defined.
+enum class Statistic {
+    Allocation,
+    Retain,
+    RetainMemory,
+    Release,
+    ReleaseLocal,
+    ReleaseCapture,
+    ReleaseMemory,
+    ReleaseWithoutDeinit,
+    Deinitialization,
+};
+
+/// Counts an allocation of *size* bytes by ejcAlloc.
+void countAllocation(size_t size);
+/// Counts *statistic*. If *classInfo* is not null, the operation is also counted for the class.
+void count(Statistic statistic, const ClassInfo *classInfo = nullptr);
+
+}  // namespace internal
+
+}  // namespace runtime
+
+/// If the runtime was compiled with `EJC_STATISTICS` defined, each thread counts the allocations, retains and releases
+/// it performs, the sizes of the allocations and the releases and deinitializations per class. The counts of all
+/// threads are printed to the standard error when the program exits or receives SIGUSR1. Otherwise these macros
+/// expand to nothing.
+#ifdef EJC_STATISTICS
+#define EJC_COUNT_ALLOCATION(size) runtime::internal::countAllocation(size)
+#define EJC_COUNT(...) runtime::internal::count(__VA_ARGS__)
+#else
+#define EJC_COUNT_ALLOCATION(size) ((void)0)
+#define EJC_COUNT(...) ((void)0)
+#endif
+
+#endif //EMOJICODE_STATISTICS_HPP
@@ -0,0 +1,393 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "Tracer.hpp"
+#include "Internal.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <pthread.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+uint8_t ejcTracing = 0;
+
+namespace runtime {
+
+namespace internal {
+
+namespace {
+
+enum class EventKind : uint8_t { ThreadName, Begin, End, Argument, Instant };
+
+/// Precedes the texts of an event in the ring buffer of a thread. The texts are padded so that the next header is
+/// aligned to 8 bytes.
+struct EventHeader {
+    uint64_t time;
+    EventKind kind;
+    uint8_t padding;
+    uint16_t nameLength;
+    uint16_t valueLength;
+    uint16_t padding2;
+};
+
+static_assert(sizeof(EventHeader) == 16, "An event without texts must take up exactly one header");
+
+constexpr size_t kBufferSize = 1 << 16;
+/// Texts are truncated to this many bytes so that a single event cannot fill a large part of a buffer.
+constexpr size_t kMaxTextLength = 1024;
+constexpr auto kExportInterval = std::chrono::milliseconds(10);
+constexpr size_t kNotSkipping = std::numeric_limits<size_t>::max();
+
+/// The events of a thread. The thread is the only producer and the exporter the only consumer, so that recording an
+/// event needs no synchronization beyond publishing the new head.
+struct Buffer {
+    std::atomic<uint64_t> head{0};
+    std::atomic<uint64_t> tail{0};
+    std::atomic<uint64_t> dropped{0};
+    /// Set when the thread exits. The exporter deletes the buffer once it has been drained.
+    std::atomic<bool> retired{false};
+    uint64_t id = 0;
+
+    // Only accessed by the thread.
+    /// The tracing session the following members refer to.
+    uint64_t session = 0;
+    /// The number of spans that have been begun and not ended.
+    size_t openSpans = 0;
+    /// The depth of the outermost open span whose beginning was dropped. The events of it and the spans within it are
+    /// dropped until it ends, so that the recorded spans stay properly nested.
+    size_t skippedFrom = kNotSkipping;
+
+    /// Only accessed by the exporter: The arguments of the recorded open spans formatted as JSON members.
+    std::vector<std::string> arguments;
+
+    char data[kBufferSize];
+
+    size_t recordedSpans() const { return std::min(openSpans, skippedFrom); }
+};
+
+struct ThreadBuffer {
+    Buffer *buffer = nullptr;
+
+    ~ThreadBuffer() {
+        if (buffer != nullptr) {
+            buffer->retired.store(true, std::memory_order_release);
+        }
+    }
+};
+
+thread_local ThreadBuffer threadBuffer;
+
+struct Tracer {
+    /// Guards all members but session.
+    std::mutex mutex;
+    std::vector<Buffer *> buffers;
+    uint64_t nextId = 1;
+    std::atomic<uint64_t> session{0};
+
+    std::FILE *file = nullptr;
+    bool firstEvent = true;
+    std::thread exporter;
+    std::condition_variable wake;
+    bool stopping = false;
+    int pid = 0;
+};
+
+Tracer& tracer() {
+    static auto tracer = new Tracer;
+    return *tracer;
+}
+
+bool isTracing() {
+    return __atomic_load_n(&ejcTracing, __ATOMIC_RELAXED) != 0;
+}
+
+uint64_t now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+size_t truncatedLength(const char *text, size_t length) {
+    if (length <= kMaxTextLength) return length;
+    length = kMaxTextLength;
+    // Do not split a UTF-8 sequence.
+    while (length > 0 && (static_cast<uint8_t>(text[length]) & 0xC0) == 0x80) {
+        length--;
+    }
+    return length;
+}
+
+void copyIn(Buffer *buffer, uint64_t position, const void *bytes, size_t count) {
+    if (count == 0) return;
+    auto offset = position % kBufferSize;
+    auto first = std::min(count, kBufferSize - offset);
+    std::memcpy(buffer->data + offset, bytes, first);
+    std::memcpy(buffer->data, static_cast<const char *>(bytes) + first, count - first);
+}
+
+void copyOut(const Buffer *buffer, uint64_t position, void *bytes, size_t count) {
+    if (count == 0) return;
+    auto offset = position % kBufferSize;
+    auto first = std::min(count, kBufferSize - offset);
+    std::memcpy(bytes, buffer->data + offset, first);
+    std::memcpy(static_cast<char *>(bytes) + first, buffer->data, count - first);
+}
+
+/// Appends an event to *buffer* if at least *reserve* bytes remain free afterwards. Every recorded open span reserves
+/// the space of its end event, so that ends are never dropped.
+bool record(Buffer *buffer, EventKind kind, const char *name, size_t nameLength, const char *value,
+            size_t valueLength, size_t reserve) {
+    nameLength = truncatedLength(name, nameLength);
+    valueLength = truncatedLength(value, valueLength);
+    auto size = (sizeof(EventHeader) + nameLength + valueLength + 7) & ~static_cast<size_t>(7);
+
+    auto head = buffer->head.load(std::memory_order_relaxed);
+    if (kBufferSize - (head - buffer->tail.load(std::memory_order_acquire)) < size + reserve) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    EventHeader header{now(), kind, 0, static_cast<uint16_t>(nameLength), static_cast<uint16_t>(valueLength), 0};
+    copyIn(buffer, head, &header, sizeof(header));
+    copyIn(buffer, head + sizeof(header), name, nameLength);
+    copyIn(buffer, head + sizeof(header) + nameLength, value, valueLength);
+    buffer->head.store(head + size, std::memory_order_release);
+    return true;
+}
+
+/// Returns the buffer of the calling thread, which is reset and names the thread at the start of every session.
+Buffer* buffer() {
+    auto buffer = threadBuffer.buffer;
+    if (buffer == nullptr) {
+        buffer = new Buffer;
+        auto &tracer = runtime::internal::tracer();
+        std::lock_guard<std::mutex> lock(tracer.mutex);
+        buffer->id = tracer.nextId++;
+        tracer.buffers.emplace_back(buffer);
+        threadBuffer.buffer = buffer;
+    }
+    auto session = tracer().session.load(std::memory_order_relaxed);
+    if (buffer->session != session) {
+        buffer->session = session;
+        buffer->openSpans = 0;
+        buffer->skippedFrom = kNotSkipping;
+        char name[64] = "";
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        record(buffer, EventKind::ThreadName, name, std::strlen(name), nullptr, 0, 0);
+    }
+    return buffer;
+}
+
+void appendEscaped(std::string &json, const char *text, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        auto c = static_cast<unsigned char>(text[i]);
+        if (c == '"' || c == '\\') {
+            json.push_back('\\');
+            json.push_back(static_cast<char>(c));
+        }
+        else if (c < 0x20) {
+            char escape[8];
+            std::snprintf(escape, sizeof(escape), "\\u%04x", c);
+            json.append(escape);
+        }
+        else {
+            json.push_back(static_cast<char>(c));
+        }
+    }
+}
+
+/// Writes the events of *buffer* to the trace file. Must be called with the mutex of the tracer held.
+void drain(Tracer &tracer, Buffer *buffer) {
+    auto tail = buffer->tail.load(std::memory_order_relaxed);
+    auto head = buffer->head.load(std::memory_order_acquire);
+    std::string text, json;
+    while (tail < head) {
+        EventHeader header;
+        copyOut(buffer, tail, &header, sizeof(header));
+        text.resize(header.nameLength + header.valueLength);
+        copyOut(buffer, tail + sizeof(header), &text[0], text.size());
+        tail += (sizeof(header) + text.size() + 7) & ~static_cast<size_t>(7);
+
+        char common[96];
+        std::snprintf(common, sizeof(common), "\"pid\":%d,\"tid\":%" PRIu64 ",\"ts\":%" PRIu64 ".%03" PRIu64,
+                      tracer.pid, buffer->id, header.time / 1000, header.time % 1000);
+        json.clear();
+        switch (header.kind) {
+            case EventKind::ThreadName:
+                if (header.nameLength == 0) continue;
+                json.append("{\"ph\":\"M\",\"name\":\"thread_name\",").append(common).append(",\"args\":{\"name\":\"");
+                appendEscaped(json, text.data(), header.nameLength);
+                json.append("\"}}");
+                break;
+            case EventKind::Begin:
+                json.append("{\"ph\":\"B\",").append(common).append(",\"name\":\"");
+                appendEscaped(json, text.data(), header.nameLength);
+                json.append("\"}");
+                buffer->arguments.emplace_back();
+                break;
+            case EventKind::End:
+                if (buffer->arguments.empty()) continue;
+                json.append("{\"ph\":\"E\",").append(common);
+                if (!buffer->arguments.back().empty()) {
+                    json.append(",\"args\":{").append(buffer->arguments.back()).append("}");
+                }
+                json.append("}");
+                buffer->arguments.pop_back();
+                break;
+            case EventKind::Argument: {
+                if (buffer->arguments.empty()) continue;
+                auto &arguments = buffer->arguments.back();
+                if (!arguments.empty()) arguments.push_back(',');
+                arguments.push_back('"');
+                appendEscaped(arguments, text.data(), header.nameLength);
+                arguments.append("\":\"");
+                appendEscaped(arguments, text.data() + header.nameLength, header.valueLength);
+                arguments.push_back('"');
+                continue;
+            }
+            case EventKind::Instant:
+                json.append("{\"ph\":\"i\",\"s\":\"t\",").append(common).append(",\"name\":\"");
+                appendEscaped(json, text.data(), header.nameLength);
+                json.append("\"}");
+                break;
+        }
+        std::fputs(tracer.firstEvent ? "\n" : ",\n", tracer.file);
+        std::fputs(json.c_str(), tracer.file);
+        tracer.firstEvent = false;
+    }
+    buffer->tail.store(tail, std::memory_order_release);
+}
+
+void exportEvents() {
+    auto &tracer = runtime::internal::tracer();
+    std::unique_lock<std::mutex> lock(tracer.mutex);
+    while (!tracer.stopping) {
+        tracer.wake.wait_for(lock, kExportInterval);
+        auto end = std::remove_if(tracer.buffers.begin(), tracer.buffers.end(), [&tracer](Buffer *buffer) {
+            auto retired = buffer->retired.load(std::memory_order_acquire);
+            drain(tracer, buffer);
+            if (retired) {
+                delete buffer;
+            }
+            return retired;
+        });
+        tracer.buffers.erase(end, tracer.buffers.end());
+        std::fflush(tracer.file);
+    }
+}
+
+}  // namespace
+
+bool startTracing(const char *path) {
+    auto &tracer = runtime::internal::tracer();
+    {
+        std::lock_guard<std::mutex> lock(tracer.mutex);
+        if (tracer.file != nullptr) return false;
+        tracer.file = std::fopen(path, "w");
+        if (tracer.file == nullptr) return false;
+        std::fputs("[", tracer.file);
+        tracer.firstEvent = true;
+        tracer.pid = static_cast<int>(getpid());
+        tracer.stopping = false;
+        // Events recorded while the last session was stopped are discarded.
+        for (auto buffer : tracer.buffers) {
+            buffer->tail.store(buffer->head.load(std::memory_order_acquire), std::memory_order_release);
+            buffer->arguments.clear();
+        }
+        tracer.session.fetch_add(1, std::memory_order_relaxed);
+        runtime::internal::becomeMultithreaded();
+        tracer.exporter = std::thread(exportEvents);
+    }
+
+    static std::once_flag registered;
+    std::call_once(registered, [] { std::atexit(stopTracing); });
+    __atomic_store_n(&ejcTracing, 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+void stopTracing() {
+    auto &tracer = runtime::internal::tracer();
+    {
+        std::lock_guard<std::mutex> lock(tracer.mutex);
+        if (tracer.file == nullptr || tracer.stopping) return;
+        __atomic_store_n(&ejcTracing, 0, __ATOMIC_RELAXED);
+        tracer.stopping = true;
+    }
+    tracer.wake.notify_one();
+    tracer.exporter.join();
+
+    std::lock_guard<std::mutex> lock(tracer.mutex);
+    uint64_t dropped = 0;
+    for (auto buffer : tracer.buffers) {
+        drain(tracer, buffer);
+        dropped += buffer->dropped.exchange(0, std::memory_order_relaxed);
+    }
+    std::fputs("\n]\n", tracer.file);
+    if (std::fclose(tracer.file) != 0) {
+        std::fprintf(stderr, "Could not write the trace: %s\n", std::strerror(errno));
+    }
+    tracer.file = nullptr;
+    if (dropped > 0) {
+        std::fprintf(stderr, "The tracer dropped %" PRIu64 " events.\n", dropped);
+    }
+}
+
+void startTracer() {
+    auto path = std::getenv("EJC_TRACE");
+    if (path == nullptr || *path == '\0') return;
+    if (!startTracing(path)) {
+        std::fprintf(stderr, "Could not write the trace to %s: %s\n", path, std::strerror(errno));
+    }
+}
+
+void traceBegin(const char *name, size_t length) {
+    if (!isTracing()) return;
+    auto buffer = runtime::internal::buffer();
+    auto depth = buffer->openSpans++;
+    if (buffer->skippedFrom <= depth) return;
+    if (!record(buffer, EventKind::Begin, name, length, nullptr, 0, (depth + 1) * sizeof(EventHeader))) {
+        buffer->skippedFrom = depth;
+    }
+}
+
+void traceEnd() {
+    if (!isTracing()) return;
+    auto buffer = runtime::internal::buffer();
+    if (buffer->openSpans == 0) return;
+    auto depth = --buffer->openSpans;
+    if (buffer->skippedFrom <= depth) {
+        if (buffer->skippedFrom == depth) {
+            buffer->skippedFrom = kNotSkipping;
+        }
+        return;
+    }
+    record(buffer, EventKind::End, nullptr, 0, nullptr, 0, depth * sizeof(EventHeader));
+}
+
+void traceArgument(const char *key, size_t keyLength, const char *value, size_t valueLength) {
+    if (!isTracing()) return;
+    auto buffer = runtime::internal::buffer();
+    if (buffer->openSpans == 0 || buffer->skippedFrom < buffer->openSpans) return;
+    record(buffer, EventKind::Argument, key, keyLength, value, valueLength,
+           buffer->recordedSpans() * sizeof(EventHeader));
+}
+
+void traceInstant(const char *name, size_t length) {
+    if (!isTracing()) return;
+    auto buffer = runtime::internal::buffer();
+    record(buffer, EventKind::Instant, name, length, nullptr, 0, buffer->recordedSpans() * sizeof(EventHeader));
+}
+
+}  // namespace internal
+
+}  // namespace runtime
@@ -0,0 +1,44 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#ifndef EMOJICODE_TRACER_HPP
+#define EMOJICODE_TRACER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/// Non-zero while tracing. Compiled code reads this flag directly to decide whether to record spans (see 🔭 of 🛰).
+extern "C" uint8_t ejcTracing;
+
+namespace runtime {
+
+namespace internal {
+
+/// Starts tracing if the environment variable `EJC_TRACE` is set to a path.
+void startTracer();
+
+/// Starts writing the events recorded by all threads to the file at *path* in the trace event format of Chrome.
+/// Returns false if tracing is already on or the file cannot be created.
+///
+/// Every thread records its events into a ring buffer of its own without synchronization. A background thread drains
+/// the buffers into the file. If the buffer of a thread is full, the events of the thread are dropped until the
+/// background thread has caught up, so that tracing never blocks a thread.
+bool startTracing(const char *path);
+/// Writes the remaining events, closes the file and turns tracing off. Does nothing if tracing is off.
+void stopTracing();
+
+/// Begins a span named *name* on the calling thread.
+void traceBegin(const char *name, size_t length);
+/// Ends the span that was begun last on the calling thread. Does nothing if no span begun while tracing is open.
+void traceEnd();
+/// Adds the argument *key* with the value *value* to the span that was begun last on the calling thread.
+void traceArgument(const char *key, size_t keyLength, const char *value, size_t valueLength);
+/// Records that the event *name* happened on the calling thread.
+void traceInstant(const char *name, size_t length);
+
+}  // namespace internal
+
+}  // namespace runtime
+
+#endif //EMOJICODE_TRACER_HPP
@@ -8,31 +8,182 @@
 
 #include "Runtime.h"
 #include "Internal.hpp"
+#include "Allocator.hpp"
+#include "Arena.hpp"
+#include "Collector.hpp"
+#include "Pool.hpp"
+#include "Profiler.hpp"
+#include "Tracer.hpp"
+#include "Statistics.hpp"
+#include <algorithm>
+#include <cerrno>
 #include <cinttypes>
 #include <cstdlib>
 #include <cstring>
-#include <iostream>
 #include <random>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 runtime::internal::ControlBlock ejcIgnoreBlock;
 
 int runtime::internal::argc;
 char **runtime::internal::argv;
-int runtime::internal::seed;
+std::atomic_bool runtime::internal::multithreaded{false};
+
+namespace {
+
+/// The thread-local values of a thread indexed by their key.
+struct ThreadLocals {
+    std::vector<runtime::Object<void> *> objects;
+
+    /// Releases all values. Releasing a value can run a deinitializer that sets thread-local values again, which are
+    /// released as well.
+    void release() {
+        while (!objects.empty()) {
+            std::vector<runtime::Object<void> *> released;
+            released.swap(objects);
+            for (auto object : released) {
+                if (object != nullptr) object->release();
+            }
+        }
+    }
+
+    ~ThreadLocals() {
+        release();
+    }
+};
+
+thread_local ThreadLocals threadLocals;
+
+}  // namespace
 
-runtime::internal::ControlBlock* runtime::internal::newControlBlock() {
-    return new runtime::internal::ControlBlock;
+size_t runtime::internal::newThreadLocalKey() {
+    static std::atomic<size_t> next{0};
+    return next.fetch_add(1, std::memory_order_relaxed);
 }
 
-extern "C" runtime::Integer fn_1f3c1();
+runtime::Object<void>*& runtime::internal::threadLocal(size_t key) {
+    auto &objects = threadLocals.objects;
+    if (key >= objects.size()) {
+        objects.resize(key + 1, nullptr);
+    }
+    return objects[key];
+}
+
+void runtime::internal::releaseThreadLocals() {
+    threadLocals.release();
+}
+
+static_assert((runtime::internal::kAllocationOffset + sizeof(runtime::internal::ControlBlock)) %
+                  alignof(std::max_align_t) == 0, "Objects must be aligned like memory returned by malloc");
 
 extern "C" int8_t* ejcAlloc(runtime::Integer size) {
-    auto ptr = malloc(size);
-    *static_cast<runtime::internal::ControlBlock**>(ptr) = new runtime::internal::ControlBlock;
-    return static_cast<int8_t*>(ptr);
+    EJC_COUNT_ALLOCATION(size);
+    auto bytes = sizeof(runtime::internal::ControlBlock) + size;
+    runtime::internal::ControlBlock *block;
+    if (auto memory = runtime::internal::arenaAllocate(sizeof(runtime::internal::ArenaAllocation) + bytes)) {
+        auto allocation = new(memory) runtime::internal::ArenaAllocation{ static_cast<size_t>(size) };
+        block = new(allocation + 1) runtime::internal::ControlBlock;
+        block->weakCount.store(runtime::internal::kArenaAllocation + 1, std::memory_order_relaxed);
+    }
+    else {
+        block = new(runtime::internal::allocate(bytes)) runtime::internal::ControlBlock;
+    }
+    auto ptr = reinterpret_cast<int8_t*>(block + 1);
+    *reinterpret_cast<runtime::internal::ControlBlock**>(ptr) = block;
+    return ptr;
+}
+
+extern "C" int8_t* ejcPoolAlloc(runtime::ClassInfo *classInfo) {
+    if (auto block = runtime::internal::poolTake(classInfo->pool)) {
+        EJC_COUNT_ALLOCATION(classInfo->pool->size);
+        auto ptr = reinterpret_cast<int8_t*>(block + 1);
+        *reinterpret_cast<runtime::internal::ControlBlock**>(ptr) = block;
+        return ptr;
+    }
+    return ejcAlloc(classInfo->pool->size);
+}
+
+/// Maps the first *size* bytes of *descriptor* with *flags*, which is MAP_PRIVATE or MAP_SHARED, into a memory area.
+static int8_t* mapDescriptor(int descriptor, runtime::Integer size, int flags) {
+    static const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    auto length = pageSize + static_cast<size_t>(size);
+    // Reserve the page for the bookkeeping and the address range of the file in one go, so that the file can then be
+    // mapped directly behind the page.
+    auto base = static_cast<int8_t *>(mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (base == MAP_FAILED) {
+        return nullptr;
+    }
+    if (mmap(base + pageSize, static_cast<size_t>(size), PROT_READ | PROT_WRITE, flags | MAP_FIXED, descriptor, 0) ==
+            MAP_FAILED) {
+        munmap(base, length);
+        return nullptr;
+    }
+    auto ptr = base + pageSize - sizeof(runtime::internal::ControlBlock *);
+    auto block = reinterpret_cast<runtime::internal::ControlBlock *>(ptr) - 1;
+    new(reinterpret_cast<runtime::internal::Mapping *>(block) - 1) runtime::internal::Mapping{
+        base, length, static_cast<size_t>(size) };
+    new(block) runtime::internal::ControlBlock;
+    block->weakCount.store(runtime::internal::kMappedMemory, std::memory_order_relaxed);
+    *reinterpret_cast<runtime::internal::ControlBlock**>(ptr) = block;
+    return ptr;
+}
+
+extern "C" int8_t* ejcMapFile(int descriptor, runtime::Integer size) {
+    return mapDescriptor(descriptor, size, MAP_PRIVATE);
+}
+
+extern "C" int8_t* ejcMapShared(int descriptor, runtime::Integer size) {
+    return mapDescriptor(descriptor, size, MAP_SHARED);
+}
+
+/// Unmaps a memory area created by ejcMapFile or ejcMapShared.
+void unmap(runtime::internal::ControlBlock *block) {
+    auto mapping = reinterpret_cast<runtime::internal::Mapping *>(block) - 1;
+    munmap(mapping->base, mapping->length);
+}
+
+/// Increments a reference count.
+inline void incrementCount(std::atomic_int &count) {
+    if (runtime::internal::multithreaded.load(std::memory_order_relaxed)) {
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+    else {
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+}
+
+/// Decrements a reference count.
+/// @returns True if the count reached *zero*.
+inline bool decrementCount(std::atomic_int &count, int zero = 0) {
+    if (runtime::internal::multithreaded.load(std::memory_order_relaxed)) {
+        return count.fetch_sub(1, std::memory_order_acq_rel) == zero + 1;
+    }
+    auto newCount = count.load(std::memory_order_relaxed) - 1;
+    count.store(newCount, std::memory_order_relaxed);
+    return newCount == zero;
+}
+
+void runtime::internal::releaseAllocation(ControlBlock *block) {
+    if (isArenaAllocation(block)) {
+        if (decrementCount(block->weakCount, kArenaAllocation)) {
+            arenaRelease(block);
+        }
+        return;
+    }
+    if (decrementCount(block->weakCount)) {
+        deallocate(block);
+    }
 }
 
 extern "C" void ejcRetain(runtime::Object<void> *object) {
+    EJC_COUNT(runtime::internal::Statistic::Retain);
     runtime::internal::ControlBlock *controlBlock = object->controlBlock();
     if (controlBlock == nullptr) {
         auto ptr = reinterpret_cast<int64_t *>(reinterpret_cast<uint8_t *>(object) - 8);
@@ -40,13 +191,14 @@ extern "C" void ejcRetain(runtime::Object<void> *object) {
         return;
     }
     if (controlBlock == &ejcIgnoreBlock) return;
-    controlBlock->strongCount.fetch_add(1, std::memory_order_relaxed);
+    incrementCount(controlBlock->strongCount);
 }
 
 extern "C" void ejcRetainMemory(runtime::Object<void> *object) {
+    EJC_COUNT(runtime::internal::Statistic::RetainMemory);
     runtime::internal::ControlBlock *controlBlock = object->controlBlock();
     if (controlBlock == &ejcIgnoreBlock) return;
-    controlBlock->strongCount.fetch_add(1, std::memory_order_relaxed);
+    incrementCount(controlBlock->strongCount);
 }
 
 bool releaseLocal(void *object) {
@@ -56,35 +208,41 @@ bool releaseLocal(void *object) {
 }
 
 extern "C" void ejcReleaseLocal(runtime::Object<void> *object) {
+    EJC_COUNT(runtime::internal::Statistic::ReleaseLocal, object->classInfo());
     if (releaseLocal(object)) {
+        EJC_COUNT(runtime::internal::Statistic::Deinitialization, object->classInfo());
         object->classInfo()->destructor(object);
     }
 }
 
-void deleteControlBlock(runtime::internal::ControlBlock *block) {
-    if (block->weakCount == 0) {
-        delete block;
-    }
-}
-
 extern "C" void ejcRelease(runtime::Object<void> *object) {
+    EJC_COUNT(runtime::internal::Statistic::Release, object->classInfo());
     runtime::internal::ControlBlock *controlBlock = object->controlBlock();
     if (controlBlock == nullptr) {
         if (releaseLocal(object)) {
+            EJC_COUNT(runtime::internal::Statistic::Deinitialization, object->classInfo());
             object->classInfo()->destructor(object);
         }
         return;
     }
     if (controlBlock == &ejcIgnoreBlock) return;
 
-    if (controlBlock->strongCount.fetch_sub(1, std::memory_order_acq_rel) - 1 != 0) return;
+    runtime::internal::recordCycleCandidate(object);
+    if (!decrementCount(controlBlock->strongCount)) return;
 
+    EJC_COUNT(runtime::internal::Statistic::Deinitialization, object->classInfo());
     object->classInfo()->destructor(object);
-    deleteControlBlock(controlBlock);
-    free(object);
+    auto pool = object->classInfo()->pool;
+    // Allocations that are referenced weakly, were made from an arena or are cycle candidates are never pooled.
+    if (pool != nullptr && controlBlock->weakCount.load(std::memory_order_relaxed) == 1 &&
+        runtime::internal::poolGive(pool, controlBlock)) {
+        return;
+    }
+    runtime::internal::releaseAllocation(controlBlock);
 }
 
 extern "C" void ejcReleaseCapture(runtime::internal::Capture *capture) {
+    EJC_COUNT(runtime::internal::Statistic::ReleaseCapture);
     runtime::internal::ControlBlock *controlBlock = capture->controlBlock;
     if (controlBlock == nullptr) {
         if (releaseLocal(capture)) {
@@ -93,34 +251,47 @@ extern "C" void ejcReleaseCapture(runtime::internal::Capture *capture) {
         return;
     }
 
-    if (controlBlock->strongCount.fetch_sub(1, std::memory_order_acq_rel) - 1 != 0) return;
+    if (!decrementCount(controlBlock->strongCount)) return;
 
     capture->deinit(capture);
-    deleteControlBlock(controlBlock);
-    free(capture);
+    runtime::internal::releaseAllocation(controlBlock);
 }
 
 extern "C" void ejcReleaseMemory(runtime::Object<void> *object) {
+    EJC_COUNT(runtime::internal::Statistic::ReleaseMemory);
     runtime::internal::ControlBlock *controlBlock = object->controlBlock();
 
     if (controlBlock == &ejcIgnoreBlock) return;
 
-    if (controlBlock->strongCount.fetch_sub(1, std::memory_order_acq_rel) - 1 != 0) return;
+    if (!decrementCount(controlBlock->strongCount)) return;
 
-    delete controlBlock;
-    free(object);
+    // Memory areas cannot be referenced weakly.
+    auto weakCount = controlBlock->weakCount.load(std::memory_order_relaxed);
+    if (weakCount == runtime::internal::kMappedMemory) {
+        unmap(controlBlock);
+        return;
+    }
+    if (weakCount == runtime::internal::kAlignedMemory) {
+        runtime::internal::deallocate((reinterpret_cast<runtime::internal::AlignedAllocation *>(controlBlock) - 1)->base);
+        return;
+    }
+    if (runtime::internal::isArenaAllocation(controlBlock)) {
+        runtime::internal::arenaRelease(controlBlock);
+        return;
+    }
+    runtime::internal::deallocate(controlBlock);
 }
 
 extern "C" void ejcReleaseWithoutDeinit(runtime::Object<void> *object) {
+    EJC_COUNT(runtime::internal::Statistic::ReleaseWithoutDeinit);
     runtime::internal::ControlBlock *controlBlock = object->controlBlock();
     if (controlBlock == nullptr) {
         releaseLocal(object);
         return;
     }
-    if (controlBlock->strongCount.fetch_sub(1, std::memory_order_acq_rel) - 1 != 0) return;
+    if (!decrementCount(controlBlock->strongCount)) return;
 
-    deleteControlBlock(controlBlock);
-    free(object);
+    runtime::internal::releaseAllocation(controlBlock);
 }
 
 struct WeakReference {
@@ -129,22 +300,19 @@ struct WeakReference {
 };
 
 void releaseWeakReference(WeakReference *ref) {
-    ref->block->weakCount--;
-    if (ref->block->strongCount == 0) {
-        deleteControlBlock(ref->block);
-    }
+    runtime::internal::releaseAllocation(ref->block);
     ref->block = nullptr;
 }
 
 extern "C" void ejcCreateWeak(WeakReference *ref, runtime::Object<void> *object) {
     ref->object = object;
-    object->controlBlock()->weakCount++;
+    incrementCount(object->controlBlock()->weakCount);
     ref->block = object->controlBlock();
 }
 
 extern "C" void ejcRetainWeak(WeakReference *ref) {
     if (ref->block != nullptr) {
-        ref->block->weakCount++;
+        incrementCount(ref->block->weakCount);
     }
 }
 
@@ -154,25 +322,55 @@ extern "C" void ejcReleaseWeak(WeakReference *ref) {
     }
 }
 
-extern "C" runtime::SimpleOptional<void*> ejcAcquireStrong(WeakReference *ref) {
+/// Increments the strong count of the object referenced by *ref* unless it is zero, i.e. unless the object has been
+/// deinitialized, in which case the weak reference is given up.
+/// @returns True if the strong count was incremented.
+bool retainStrong(WeakReference *ref) {
     if (ref->block == nullptr) {
-        return runtime::NoValue;
+        return false;
     }
-    if (ref->block->strongCount == 0) {
-        releaseWeakReference(ref);
+    auto &strongCount = ref->block->strongCount;
+    auto count = strongCount.load(std::memory_order_relaxed);
+    if (!runtime::internal::multithreaded.load(std::memory_order_relaxed)) {
+        if (count != 0) {
+            strongCount.store(count + 1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    else {
+        // The final release decrements the count to zero with acq_rel ordering. The object must not be read before
+        // the count was seen to be non-zero, hence acquire.
+        while (count != 0) {
+            if (strongCount.compare_exchange_weak(count, count + 1, std::memory_order_acquire,
+                                                  std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+    }
+    releaseWeakReference(ref);
+    return false;
+}
+
+extern "C" runtime::SimpleOptional<void*> ejcAcquireStrong(WeakReference *ref) {
+    if (!retainStrong(ref)) {
         return runtime::NoValue;
     }
-    ref->block->strongCount++;
     return ref->object;
 }
 
-extern "C" bool ejcInheritsFrom(runtime::ClassInfo *classInfo, runtime::ClassInfo *from) {
-    for (auto classInfoNew = classInfo; classInfoNew != nullptr; classInfoNew = classInfoNew->superclass) {
-        if (classInfoNew == from) {
-            return true;
-        }
+extern "C" bool ejcBorrowWeak(WeakReference *ref, runtime::Callable<void, runtime::Object<void>*> body) {
+    if (!retainStrong(ref)) {
+        return false;
     }
-    return false;
+    // The body may reassign the weak reference and release any other strong reference to the object.
+    auto object = static_cast<runtime::Object<void> *>(ref->object);
+    body(object);
+    ejcRelease(object);
+    return true;
+}
+
+extern "C" bool ejcInheritsFrom(runtime::ClassInfo *classInfo, runtime::ClassInfo *from) {
+    return from->depth <= classInfo->depth && classInfo->display[from->depth] == from;
 }
 
 struct ProtocolConformanceEntry {
@@ -192,46 +390,136 @@ extern "C" void* ejcFindProtocolConformance(ProtocolConformanceEntry *info, void
 struct RunTimeTypeInfo {
     int16_t paramCount;
     int16_t paramOffset;
+    int8_t flag;
 };
 
-struct TypeDescription {
-    RunTimeTypeInfo *rtti;
-    bool optional;
+struct Box;
+
+struct BoxInfo {
+    RunTimeTypeInfo rtti;
+    void (*retain)(Box *);
+    void (*release)(Box *);
+    ProtocolConformanceEntry *conformances;
+};
+
+struct Box {
+    BoxInfo *info;
+    int8_t value[EJC_BOX_SIZE];
 };
 
-bool checkGenericArgs(TypeDescription **argsl, TypeDescription **argsr, int16_t argsCount, int16_t argsOffset) {
-    *argsl += argsOffset, *argsr += argsOffset;
-    for (int16_t i = 0; i < argsCount; i++) {
-        auto l = *((*argsl)++), r = *((*argsr)++);
-        if (l.rtti != r.rtti || l.optional != r.optional) return false;
-        if (!checkGenericArgs(argsl, argsr, l.rtti->paramCount, l.rtti->paramOffset)) return false;
+/// The box retain and release function of all trivially copyable types. Does nothing.
+extern "C" void ejcTrivialBoxRetainRelease(Box *) {}
+
+extern "C" void ejcCopyBoxes(Box *destination, Box *source, runtime::Integer count) {
+    std::memcpy(destination, source, count * sizeof(Box));
+    for (runtime::Integer i = 0; i < count; i++) {
+        auto info = destination[i].info;
+        // Boxes without box info contain no value.
+        if (info != nullptr && info->retain != ejcTrivialBoxRetainRelease) {
+            info->retain(destination + i);
+        }
     }
-    return true;
 }
 
+struct TypeDescription {
+    RunTimeTypeInfo *rtti;
+    bool optional;
+    /// The number of descriptions of this type and its generic arguments, including this one.
+    uint32_t length;
+};
+
 extern "C" bool ejcCheckGenericArgs(TypeDescription *argsl, TypeDescription *argsr, int16_t argsCount,
                                     int16_t argsOffset) {
-    auto g = checkGenericArgs(&argsl, &argsr, argsCount, argsOffset);
-    return g;
+    // Equal static descriptions are uniqued by the compiler.
+    if (argsl == argsr) {
+        return true;
+    }
+    // Two descriptions are equal if all their elements are. If they differ, an element differs before the end of the
+    // shorter one, as the preceding elements determine the structure.
+    runtime::Integer length = 0;
+    for (int16_t i = 0; i < argsOffset + argsCount; i++) {
+        length += argsl[length].length;
+    }
+    for (runtime::Integer i = 0; i < length; i++) {
+        if (argsl[i].rtti != argsr[i].rtti || argsl[i].optional != argsr[i].optional) return false;
+    }
+    return true;
 }
 
 extern "C" runtime::Integer ejcTypeDescriptionLength(TypeDescription *arg) {
-    runtime::Integer count = 1;
-    for (runtime::Integer i = 0; i < count; i++) {
-        count += (arg++)->rtti->paramCount;
-    }
-    return count;
+    return arg->length;
 }
 
 extern "C" TypeDescription* ejcIndexTypeDescription(TypeDescription *arg, runtime::Integer index) {
     for (runtime::Integer i = 0; i < index; i++) {
-        index += (arg++)->rtti->paramCount;
+        arg += arg->length;
     }
     return arg;
 }
 
+extern "C" int8_t* ejcMemoryAligned(runtime::Integer size, runtime::Integer alignment) {
+    size_t align = 2 * alignof(void*);
+    while (align < static_cast<size_t>(alignment)) {
+        align *= 2;
+    }
+    auto header = sizeof(runtime::internal::AlignedAllocation) + sizeof(runtime::internal::ControlBlock) +
+                  sizeof(runtime::internal::ControlBlock*);
+    EJC_COUNT_ALLOCATION(header + align + size);
+    auto base = static_cast<int8_t *>(runtime::internal::allocate(header + align - 1 + size));
+    auto content = reinterpret_cast<int8_t *>((reinterpret_cast<uintptr_t>(base + header) + align - 1) & ~(align - 1));
+    auto ptr = content - sizeof(runtime::internal::ControlBlock*);
+    auto block = reinterpret_cast<runtime::internal::ControlBlock *>(ptr) - 1;
+    new(reinterpret_cast<runtime::internal::AlignedAllocation *>(block) - 1) runtime::internal::AlignedAllocation{
+        base, align, static_cast<size_t>(size) };
+    new(block) runtime::internal::ControlBlock;
+    block->weakCount.store(runtime::internal::kAlignedMemory, std::memory_order_relaxed);
+    *reinterpret_cast<runtime::internal::ControlBlock**>(ptr) = block;
+    return ptr;
+}
+
 extern "C" void ejcMemoryRealloc(int8_t **pointerPtr, runtime::Integer newSize) {
-    *pointerPtr = static_cast<int8_t*>(realloc(*pointerPtr, newSize + sizeof(runtime::internal::ControlBlock*)));
+    auto block = *reinterpret_cast<runtime::internal::ControlBlock**>(*pointerPtr);
+    if (block->weakCount.load(std::memory_order_relaxed) == runtime::internal::kAlignedMemory) {
+        // The area keeps its alignment.
+        auto aligned = reinterpret_cast<runtime::internal::AlignedAllocation *>(block) - 1;
+        auto ptr = ejcMemoryAligned(newSize, static_cast<runtime::Integer>(aligned->alignment));
+        std::memcpy(ptr + sizeof(runtime::internal::ControlBlock*), *pointerPtr + sizeof(runtime::internal::ControlBlock*),
+                    std::min(aligned->size, static_cast<size_t>(newSize)));
+        (*reinterpret_cast<runtime::internal::ControlBlock**>(ptr))->strongCount.store(
+                block->strongCount.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        runtime::internal::deallocate(aligned->base);
+        *pointerPtr = ptr;
+        return;
+    }
+    if (block->weakCount.load(std::memory_order_relaxed) == runtime::internal::kMappedMemory) {
+        // A mapping cannot be resized, its content is copied into an allocation instead.
+        auto mapping = reinterpret_cast<runtime::internal::Mapping *>(block) - 1;
+        auto ptr = ejcAlloc(newSize + sizeof(runtime::internal::ControlBlock*));
+        std::memcpy(ptr + sizeof(runtime::internal::ControlBlock*), *pointerPtr + sizeof(runtime::internal::ControlBlock*),
+                    std::min(mapping->size, static_cast<size_t>(newSize)));
+        (*reinterpret_cast<runtime::internal::ControlBlock**>(ptr))->strongCount.store(
+                block->strongCount.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        unmap(block);
+        *pointerPtr = ptr;
+        return;
+    }
+    if (runtime::internal::isArenaAllocation(block)) {
+        // Allocations from an arena cannot grow in place, the content is copied into a new allocation instead.
+        auto allocation = reinterpret_cast<runtime::internal::ArenaAllocation *>(block) - 1;
+        auto ptr = ejcAlloc(newSize + sizeof(runtime::internal::ControlBlock*));
+        auto size = std::min(allocation->size - sizeof(runtime::internal::ControlBlock*), static_cast<size_t>(newSize));
+        std::memcpy(ptr + sizeof(runtime::internal::ControlBlock*), *pointerPtr + sizeof(runtime::internal::ControlBlock*),
+                    size);
+        (*reinterpret_cast<runtime::internal::ControlBlock**>(ptr))->strongCount.store(
+                block->strongCount.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        runtime::internal::arenaRelease(block);
+        *pointerPtr = ptr;
+        return;
+    }
+    block = static_cast<runtime::internal::ControlBlock*>(runtime::internal::reallocate(
+            block, sizeof(runtime::internal::ControlBlock) + newSize + sizeof(runtime::internal::ControlBlock*)));
+    *pointerPtr = reinterpret_cast<int8_t*>(block + 1);
+    *reinterpret_cast<runtime::internal::ControlBlock**>(*pointerPtr) = block;
 }
 
 extern "C" runtime::Integer ejcMemoryCompare(int8_t **self, int8_t *other, runtime::Integer bytes) {
@@ -239,25 +527,112 @@ extern "C" runtime::Integer ejcMemoryCompare(int8_t **self, int8_t *other, runti
                        other + sizeof(runtime::internal::ControlBlock*), bytes);
 }
 
+/// Returns the address *offset* bytes past the beginning of the content of the memory area *memory*.
+inline int8_t* memoryContent(int8_t *memory, runtime::Integer offset) {
+    return memory + sizeof(runtime::internal::ControlBlock*) + offset;
+}
+
+extern "C" runtime::SimpleOptional<runtime::Integer> ejcMemoryFind(int8_t **self, runtime::Byte byte,
+                                                                   runtime::Integer offset, runtime::Integer bytes) {
+    auto start = memoryContent(*self, 0);
+    auto found = std::memchr(start + offset, static_cast<unsigned char>(byte), bytes);
+    if (found == nullptr) {
+        return runtime::NoValue;
+    }
+    return static_cast<int8_t *>(found) - start;
+}
+
+extern "C" void ejcMemoryReverse(int8_t **self, runtime::Integer offset, runtime::Integer bytes) {
+    auto start = memoryContent(*self, offset);
+    std::reverse(start, start + bytes);
+}
+
+extern "C" void ejcMemorySwap(int8_t **self, runtime::Integer offset, int8_t *other, runtime::Integer otherOffset,
+                              runtime::Integer bytes) {
+    auto start = memoryContent(*self, offset);
+    std::swap_ranges(start, start + bytes, memoryContent(other, otherOffset));
+}
+
+/// Copies of fewer bytes are made with memcpy, as the destination then likely fits into the cache anyway.
+constexpr runtime::Integer kStreamingCopyThreshold = 256 * 1024;
+
+extern "C" void ejcMemoryCopyStreaming(int8_t **self, runtime::Integer destinationOffset, int8_t *source,
+                                       runtime::Integer sourceOffset, runtime::Integer bytes) {
+    auto destination = memoryContent(*self, destinationOffset);
+    auto from = memoryContent(source, sourceOffset);
+#if defined(__SSE2__)
+    if (bytes >= kStreamingCopyThreshold) {
+        // Non-temporal stores must be aligned to 16 bytes.
+        auto head = static_cast<runtime::Integer>((16 - reinterpret_cast<uintptr_t>(destination) % 16) % 16);
+        std::memcpy(destination, from, head);
+        destination += head;
+        from += head;
+        bytes -= head;
+        for (; bytes >= 64; bytes -= 64, destination += 64, from += 64) {
+            auto src = reinterpret_cast<const __m128i *>(from);
+            auto dst = reinterpret_cast<__m128i *>(destination);
+            auto a = _mm_loadu_si128(src), b = _mm_loadu_si128(src + 1);
+            auto c = _mm_loadu_si128(src + 2), d = _mm_loadu_si128(src + 3);
+            _mm_stream_si128(dst, a);
+            _mm_stream_si128(dst + 1, b);
+            _mm_stream_si128(dst + 2, c);
+            _mm_stream_si128(dst + 3, d);
+        }
+        // Orders the non-temporal stores before any store that may publish the memory to another thread.
+        _mm_sfence();
+    }
+#endif
+    std::memcpy(destination, from, bytes);
+}
+
 extern "C" bool ejcIsOnlyReference(runtime::Object<void> *object) {
     runtime::internal::ControlBlock *controlBlock = object->controlBlock();
     if (controlBlock == nullptr) {
         return *reinterpret_cast<int64_t *>(reinterpret_cast<uint8_t *>(object) - 8) == 1;
     }
     if (controlBlock == &ejcIgnoreBlock) return false;  // Impossible to say as object is not reference counted
-    return controlBlock->strongCount == 1;
+    return controlBlock->strongCount.load(std::memory_order_acquire) == 1;
 }
 
+/// Provided by the profile run-time library if the program was compiled with --profile-generate. It is called by
+/// the library when the program exits normally.
+extern "C" int __llvm_profile_write_file() __attribute__((weak));
+
+/// Provided by the s package if it is linked. Writes the output that the standard output stream still buffers.
+extern "C" void sFlushStandardOutput() __attribute__((weak));
+
 extern "C" [[noreturn]] void ejcPanic(const char *message) {
-    std::cout << "🤯 Program panicked: " << message << std::endl;
+    if (sFlushStandardOutput != nullptr) {
+        sFlushStandardOutput();
+    }
+    std::string text = "🤯 Program panicked: ";
+    text.append(message).push_back('\n');
+    for (size_t written = 0; written < text.size();) {
+        auto n = write(STDOUT_FILENO, text.data() + written, text.size() - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        written += n;
+    }
+    // abort() skips the exit handlers, which would lose the profile of the run.
+    if (__llvm_profile_write_file != nullptr) {
+        __llvm_profile_write_file();
+    }
     abort();
 }
 
-int main(int largc, char **largv) {
+int runtime::internal::hashSeed() {
+    static const int seed = std::random_device()();
+    return seed;
+}
+
+extern "C" void ejcSetUpProgram(int largc, char **largv) {
     runtime::internal::argc = largc;
     runtime::internal::argv = largv;
-    runtime::internal::seed = std::random_device()();
+    runtime::internal::startProfiler();
+    runtime::internal::startTracer();
+}
 
-    auto code = fn_1f3c1();
-    return static_cast<int>(code);
+extern "C" void ejcSetUp(int largc, char **largv) {
+    runtime::internal::becomeMultithreaded();
+    ejcSetUpProgram(largc, largv);
 }
@@ -0,0 +1,94 @@
+//
+// Created by Theo Weidmann on 14.10.26.
+//
+
+#include "../runtime/Runtime.h"
+#include <atomic>
+#include <thread>
+
+namespace s {
+
+/// A reference that can be read and replaced from several threads. Loading a reference and retaining it must happen
+/// without the reference being replaced and released in between, so both are guarded by a spin lock, which is held
+/// only for these few instructions.
+class AtomicReference : public runtime::Object<AtomicReference> {
+public:
+    runtime::Object<void> *object;
+
+    void lock() {
+        while (flag_.test_and_set(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+
+    void unlock() {
+        flag_.clear(std::memory_order_release);
+    }
+
+private:
+    std::atomic_flag flag_ = ATOMIC_FLAG_INIT;
+};
+
+extern "C" AtomicReference* sAtomicReferenceNew(runtime::Object<void> *object) {
+    auto reference = AtomicReference::init();
+    object->retain();
+    reference->object = object;
+    return reference;
+}
+
+extern "C" runtime::Object<void>* sAtomicReferenceLoad(AtomicReference *reference) {
+    reference->lock();
+    auto object = reference->object;
+    object->retain();
+    reference->unlock();
+    return object;
+}
+
+extern "C" void sAtomicReferenceStore(AtomicReference *reference, runtime::Object<void> *object) {
+    object->retain();
+    reference->lock();
+    auto old = reference->object;
+    reference->object = object;
+    reference->unlock();
+    old->release();
+}
+
+extern "C" runtime::Object<void>* sAtomicReferenceExchange(AtomicReference *reference,
+                                                            runtime::Object<void> *object) {
+    object->retain();
+    reference->lock();
+    auto old = reference->object;
+    reference->object = object;
+    reference->unlock();
+    return old;
+}
+
+extern "C" runtime::Boolean sAtomicReferenceCompareExchange(AtomicReference *reference,
+                                                            runtime::Object<void> *expected,
+                                                            runtime::Object<void> *desired) {
+    reference->lock();
+    if (reference->object != expected) {
+        reference->unlock();
+        return false;
+    }
+    desired->retain();
+    reference->object = desired;
+    reference->unlock();
+    expected->release();
+    return true;
+}
+
+extern "C" void sAtomicReferenceDestruct(AtomicReference *reference) {
+    reference->object->release();
+    reference->~AtomicReference();
+}
+
+/// Returns a new identifier for the nodes a transient 🎋 or 🌴 may modify in place.
+extern "C" runtime::Integer sPersistentNewOwner(runtime::ClassInfo *) {
+    static std::atomic<runtime::Integer> next(1);
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace s
+
+SET_INFO_FOR(s::AtomicReference, s, 269b_1f538_1f535)
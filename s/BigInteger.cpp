@@ -0,0 +1,481 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "../runtime/Runtime.h"
+#include "String.h"
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+using s::String;
+
+namespace s {
+
+using Limb = uint64_t;
+__extension__ typedef unsigned __int128 DoubleLimb;
+/// The magnitude of a big integer as limbs of 64 bits, least significant limb first. The most significant limb is
+/// never 0, so that 0 has no limbs.
+using Limbs = std::vector<Limb>;
+
+/// The limbs of a 🐘 whose value does not fit into 🔢. Smaller values are stored in the 🐘 itself.
+class BigInteger : public runtime::Object<BigInteger> {
+public:
+    BigInteger(bool negative, Limbs limbs) : negative(negative && !limbs.empty()), limbs(std::move(limbs)) {}
+
+    bool negative;
+    Limbs limbs;
+};
+
+namespace {
+
+/// Factors with fewer limbs than this are multiplied with the schoolbook method, which is faster for small factors
+/// than Karatsuba multiplication.
+constexpr size_t kKaratsubaThreshold = 32;
+
+constexpr char kDigits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+void trim(Limbs &limbs) {
+    while (!limbs.empty() && limbs.back() == 0) {
+        limbs.pop_back();
+    }
+}
+
+int compare(const Limbs &a, const Limbs &b) {
+    if (a.size() != b.size()) {
+        return a.size() < b.size() ? -1 : 1;
+    }
+    for (auto i = a.size(); i-- > 0;) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+Limbs add(const Limb *a, size_t n, const Limb *b, size_t m) {
+    if (n < m) {
+        return add(b, m, a, n);
+    }
+    Limbs result(n + 1);
+    Limb carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        auto sum = DoubleLimb(a[i]) + (i < m ? b[i] : 0) + carry;
+        result[i] = static_cast<Limb>(sum);
+        carry = static_cast<Limb>(sum >> 64);
+    }
+    result[n] = carry;
+    trim(result);
+    return result;
+}
+
+/// Subtracts *b* from *a*, which must not be smaller than *b*.
+void subtractInPlace(Limbs &a, const Limbs &b) {
+    Limb borrow = 0;
+    for (size_t i = 0; i < a.size() && (i < b.size() || borrow != 0); i++) {
+        auto subtrahend = i < b.size() ? b[i] : 0;
+        auto difference = a[i] - subtrahend - borrow;
+        borrow = a[i] < subtrahend || a[i] - subtrahend < borrow;
+        a[i] = difference;
+    }
+    trim(a);
+}
+
+/// Adds *x* multiplied by 2^(64 * *shift*) to *result*, which must be large enough to hold the sum.
+void addShifted(Limbs &result, const Limbs &x, size_t shift) {
+    Limb carry = 0;
+    size_t i = 0;
+    for (; i < x.size() && i + shift < result.size(); i++) {
+        auto sum = DoubleLimb(result[i + shift]) + x[i] + carry;
+        result[i + shift] = static_cast<Limb>(sum);
+        carry = static_cast<Limb>(sum >> 64);
+    }
+    for (i += shift; carry != 0 && i < result.size(); i++) {
+        carry = ++result[i] == 0;
+    }
+}
+
+void multiplySchoolbook(const Limb *a, size_t n, const Limb *b, size_t m, Limb *result) {
+    for (size_t i = 0; i < n; i++) {
+        Limb carry = 0;
+        for (size_t j = 0; j < m; j++) {
+            auto product = DoubleLimb(a[i]) * b[j] + result[i + j] + carry;
+            result[i + j] = static_cast<Limb>(product);
+            carry = static_cast<Limb>(product >> 64);
+        }
+        result[i + m] = carry;
+    }
+}
+
+/// Returns the product of the *n* limbs at *a* and the *m* limbs at *b* in n + m limbs, the most significant of which
+/// can be 0.
+Limbs multiply(const Limb *a, size_t n, const Limb *b, size_t m) {
+    if (n < m) {
+        return multiply(b, m, a, n);
+    }
+    Limbs result(n + m);
+    if (m < kKaratsubaThreshold) {
+        multiplySchoolbook(a, n, b, m, result.data());
+        return result;
+    }
+
+    auto half = (n + 1) / 2;
+    if (m <= half) {
+        // Only the longer factor is split, so that the products are balanced again.
+        auto low = multiply(a, half, b, m);
+        auto high = multiply(a + half, n - half, b, m);
+        addShifted(result, low, 0);
+        addShifted(result, high, half);
+        return result;
+    }
+
+    // Karatsuba: With a = a1 * B + a0 and b = b1 * B + b0, a * b = z2 * B^2 + z1 * B + z0, where z0 = a0 * b0,
+    // z2 = a1 * b1 and z1 = (a0 + a1) * (b0 + b1) - z0 - z2, which takes three instead of four multiplications.
+    auto z0 = multiply(a, half, b, half);
+    auto z2 = multiply(a + half, n - half, b + half, m - half);
+    auto aSum = add(a, half, a + half, n - half);
+    auto bSum = add(b, half, b + half, m - half);
+    auto z1 = multiply(aSum.data(), aSum.size(), bSum.data(), bSum.size());
+    trim(z0);
+    trim(z1);
+    trim(z2);
+    subtractInPlace(z1, z0);
+    subtractInPlace(z1, z2);
+    addShifted(result, z0, 0);
+    addShifted(result, z1, half);
+    addShifted(result, z2, 2 * half);
+    return result;
+}
+
+Limbs multiply(const Limbs &a, const Limbs &b) {
+    if (a.empty() || b.empty()) {
+        return Limbs();
+    }
+    auto result = multiply(a.data(), a.size(), b.data(), b.size());
+    trim(result);
+    return result;
+}
+
+/// Sets *a* to a * *factor* + *addend*.
+void multiplyAddInPlace(Limbs &a, Limb factor, Limb addend) {
+    auto carry = addend;
+    for (auto &limb : a) {
+        auto product = DoubleLimb(limb) * factor + carry;
+        limb = static_cast<Limb>(product);
+        carry = static_cast<Limb>(product >> 64);
+    }
+    if (carry != 0) {
+        a.emplace_back(carry);
+    }
+}
+
+/// Divides *a* by *divisor* in place and returns the remainder.
+Limb divideInPlace(Limbs &a, Limb divisor) {
+    DoubleLimb remainder = 0;
+    for (auto i = a.size(); i-- > 0;) {
+        auto dividend = (remainder << 64) | a[i];
+        a[i] = static_cast<Limb>(dividend / divisor);
+        remainder = dividend % divisor;
+    }
+    trim(a);
+    return static_cast<Limb>(remainder);
+}
+
+/// Returns *a* shifted to the left by *shift* bits, which must be less than 64, with one more limb than *a*.
+Limbs shiftLeft(const Limbs &a, unsigned int shift) {
+    Limbs result(a.size() + 1);
+    for (size_t i = 0; i < a.size(); i++) {
+        result[i] |= a[i] << shift;
+        if (shift != 0) {
+            result[i + 1] = a[i] >> (64 - shift);
+        }
+    }
+    return result;
+}
+
+/// Divides *a* by *b*, which must not be 0, and sets *quotient* and *remainder*.
+void divide(const Limbs &a, const Limbs &b, Limbs &quotient, Limbs &remainder) {
+    if (compare(a, b) < 0) {
+        quotient.clear();
+        remainder = a;
+        return;
+    }
+    if (b.size() == 1) {
+        quotient = a;
+        remainder = Limbs{ divideInPlace(quotient, b[0]) };
+        trim(remainder);
+        return;
+    }
+
+    // Knuth, The Art of Computer Programming, Vol. 2, 4.3.1, Algorithm D. The divisor is normalized so that its most
+    // significant bit is set, which makes the estimated quotient digits at most two too large.
+    auto shift = static_cast<unsigned int>(__builtin_clzll(b.back()));
+    auto v = shiftLeft(b, shift);
+    v.pop_back();
+    auto u = shiftLeft(a, shift);
+    auto n = v.size();
+    auto m = a.size() - n;
+    quotient.assign(m + 1, 0);
+
+    for (auto j = m + 1; j-- > 0;) {
+        auto numerator = (DoubleLimb(u[j + n]) << 64) | u[j + n - 1];
+        auto estimate = numerator / v[n - 1];
+        auto rest = numerator % v[n - 1];
+        while (estimate >> 64 != 0 || estimate * v[n - 2] > ((rest << 64) | u[j + n - 2])) {
+            estimate--;
+            rest += v[n - 1];
+            if (rest >> 64 != 0) {
+                break;
+            }
+        }
+
+        Limb borrow = 0;
+        Limb carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            auto product = estimate * v[i] + carry;
+            carry = static_cast<Limb>(product >> 64);
+            auto low = static_cast<Limb>(product);
+            auto difference = u[i + j] - low - borrow;
+            borrow = u[i + j] < low || u[i + j] - low < borrow;
+            u[i + j] = difference;
+        }
+        auto top = u[j + n];
+        u[j + n] = top - carry - borrow;
+        if (top < carry || top - carry < borrow) {
+            // The estimate was one too large.
+            estimate--;
+            Limb addCarry = 0;
+            for (size_t i = 0; i < n; i++) {
+                auto sum = DoubleLimb(u[i + j]) + v[i] + addCarry;
+                u[i + j] = static_cast<Limb>(sum);
+                addCarry = static_cast<Limb>(sum >> 64);
+            }
+            u[j + n] += addCarry;
+        }
+        quotient[j] = static_cast<Limb>(estimate);
+    }
+    trim(quotient);
+
+    remainder.assign(n, 0);
+    for (size_t i = 0; i < n; i++) {
+        remainder[i] = u[i] >> shift;
+        if (shift != 0) {
+            remainder[i] |= u[i + 1] << (64 - shift);
+        }
+    }
+    trim(remainder);
+}
+
+Limbs magnitude(runtime::Integer value) {
+    auto a = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    return a == 0 ? Limbs() : Limbs{ a };
+}
+
+BigInteger* sum(bool aNegative, const Limbs &a, bool bNegative, const Limbs &b) {
+    if (aNegative == bNegative) {
+        return BigInteger::init(aNegative, add(a.data(), a.size(), b.data(), b.size()));
+    }
+    if (compare(a, b) >= 0) {
+        auto result = a;
+        subtractInPlace(result, b);
+        return BigInteger::init(aNegative, std::move(result));
+    }
+    auto result = b;
+    subtractInPlace(result, a);
+    return BigInteger::init(bNegative, std::move(result));
+}
+
+/// Returns the largest power of *base* that fits into a limb and sets *digits* to its exponent.
+Limb chunkBase(Limb base, unsigned int &digits) {
+    Limb power = base;
+    digits = 1;
+    while (power <= UINT64_MAX / base) {
+        power *= base;
+        digits++;
+    }
+    return power;
+}
+
+/// Returns the value of the digit c in bases up to 36 or 36 if c is not a digit.
+uint64_t digitValue(char c) {
+    if ('0' <= c && c <= '9') return c - '0';
+    if ('a' <= c && c <= 'z') return c - 'a' + 10;
+    if ('A' <= c && c <= 'Z') return c - 'A' + 10;
+    return 36;
+}
+
+}  // namespace
+
+extern "C" BigInteger* sBigIntegerNew(runtime::Integer value) {
+    return BigInteger::init(value < 0, magnitude(value));
+}
+
+extern "C" BigInteger* sBigIntegerAdd(BigInteger *a, BigInteger *b) {
+    return sum(a->negative, a->limbs, b->negative, b->limbs);
+}
+
+extern "C" BigInteger* sBigIntegerSubtract(BigInteger *a, BigInteger *b) {
+    return sum(a->negative, a->limbs, !b->negative, b->limbs);
+}
+
+extern "C" BigInteger* sBigIntegerMultiply(BigInteger *a, BigInteger *b) {
+    return BigInteger::init(a->negative != b->negative, multiply(a->limbs, b->limbs));
+}
+
+extern "C" BigInteger* sBigIntegerDivide(BigInteger *a, BigInteger *b) {
+    if (b->limbs.empty()) {
+        ejcPanic("Division by zero in 🐘➗.");
+    }
+    Limbs quotient, remainder;
+    divide(a->limbs, b->limbs, quotient, remainder);
+    return BigInteger::init(a->negative != b->negative, std::move(quotient));
+}
+
+extern "C" BigInteger* sBigIntegerRemainder(BigInteger *a, BigInteger *b) {
+    if (b->limbs.empty()) {
+        ejcPanic("Division by zero in 🐘🚮.");
+    }
+    Limbs quotient, remainder;
+    divide(a->limbs, b->limbs, quotient, remainder);
+    return BigInteger::init(a->negative, std::move(remainder));
+}
+
+extern "C" runtime::Integer sBigIntegerCompare(BigInteger *a, BigInteger *b) {
+    if (a->negative != b->negative) {
+        return a->negative ? -1 : 1;
+    }
+    auto order = compare(a->limbs, b->limbs);
+    return a->negative ? -order : order;
+}
+
+extern "C" runtime::SimpleOptional<runtime::Integer> sBigIntegerToInteger(BigInteger *a) {
+    if (a->limbs.empty()) {
+        return 0;
+    }
+    if (a->limbs.size() > 1) {
+        return runtime::NoValue;
+    }
+    auto limb = a->limbs.front();
+    if (a->negative) {
+        if (limb > static_cast<uint64_t>(INT64_MAX) + 1) {
+            return runtime::NoValue;
+        }
+        return static_cast<runtime::Integer>(0 - limb);
+    }
+    if (limb > static_cast<uint64_t>(INT64_MAX)) {
+        return runtime::NoValue;
+    }
+    return static_cast<runtime::Integer>(limb);
+}
+
+extern "C" runtime::Real sBigIntegerToReal(BigInteger *a) {
+    runtime::Real real = 0;
+    for (auto i = a->limbs.size(); i-- > 0;) {
+        real = real * 18446744073709551616.0 + static_cast<runtime::Real>(a->limbs[i]);
+    }
+    return a->negative ? -real : real;
+}
+
+extern "C" runtime::Integer sBigIntegerHash(BigInteger *a) {
+    uint64_t hash = a->negative ? 0x9e3779b97f4a7c15 : 0;
+    for (auto limb : a->limbs) {
+        hash = (hash ^ limb) * 0xbf58476d1ce4e5b9;
+        hash ^= hash >> 31;
+    }
+    return static_cast<runtime::Integer>(hash);
+}
+
+extern "C" String* sBigIntegerToString(BigInteger *a, runtime::Integer base) {
+    auto b = static_cast<Limb>(base);
+    if (a->limbs.empty()) {
+        return String::copy("0", 1);
+    }
+    std::string digits;
+
+    if ((b & (b - 1)) == 0) {
+        // Every digit of a power of two base stands for the same number of bits, which are read from the limbs.
+        auto shift = static_cast<size_t>(__builtin_ctzll(b));
+        auto bits = a->limbs.size() * 64 - __builtin_clzll(a->limbs.back());
+        for (auto position = (bits + shift - 1) / shift * shift; position > 0;) {
+            position -= shift;
+            auto index = position / 64, offset = position % 64;
+            auto value = a->limbs[index] >> offset;
+            if (offset + shift > 64 && index + 1 < a->limbs.size()) {
+                value |= a->limbs[index + 1] << (64 - offset);
+            }
+            digits.push_back(kDigits[value & (b - 1)]);
+        }
+    }
+    else {
+        // The limbs are divided by the largest power of the base that fits into a limb, so that each division yields
+        // many digits, which are then computed with machine integers.
+        unsigned int chunkDigits;
+        auto chunk = chunkBase(b, chunkDigits);
+        std::vector<Limb> chunks;
+        auto rest = a->limbs;
+        while (!rest.empty()) {
+            chunks.emplace_back(divideInPlace(rest, chunk));
+        }
+        char buffer[64];
+        for (auto it = chunks.rbegin(); it != chunks.rend(); it++) {
+            auto value = *it;
+            auto end = buffer + sizeof(buffer), characters = end;
+            do {
+                *--characters = kDigits[value % b];
+            } while ((value /= b) > 0);
+            if (it != chunks.rbegin()) {
+                digits.append(chunkDigits - (end - characters), '0');
+            }
+            digits.append(characters, end);
+        }
+    }
+
+    if (a->negative) {
+        digits.insert(digits.begin(), '-');
+    }
+    return String::copy(digits.data(), digits.size());
+}
+
+extern "C" runtime::SimpleOptional<BigInteger*> sBigIntegerParse(runtime::ClassInfo *, String *string,
+                                                                 runtime::Integer base) {
+    auto characters = string->bytes();
+    auto end = characters + string->count;
+    bool negative = false;
+    if (characters != end && (*characters == '-' || *characters == '+')) {
+        negative = *characters++ == '-';
+    }
+    if (characters == end) {
+        return runtime::NoValue;
+    }
+
+    // Digits are collected in a machine integer until it holds as many as fit into a limb, which is then multiplied
+    // into the limbs all at once.
+    auto b = static_cast<Limb>(base);
+    unsigned int chunkDigits;
+    chunkBase(b, chunkDigits);
+    Limbs limbs;
+    while (characters != end) {
+        Limb value = 0, factor = 1;
+        for (unsigned int i = 0; i < chunkDigits && characters != end; i++, characters++) {
+            auto digit = digitValue(*characters);
+            if (digit >= b) {
+                return runtime::NoValue;
+            }
+            value = value * b + digit;
+            factor *= b;
+        }
+        multiplyAddInPlace(limbs, factor, value);
+    }
+    trim(limbs);
+    return BigInteger::init(negative, std::move(limbs));
+}
+
+extern "C" void sBigIntegerDestruct(BigInteger *a) {
+    a->~BigInteger();
+}
+
+}  // namespace s
+
+SET_INFO_FOR(s::BigInteger, s, 1f418_1f538_1f9f1)
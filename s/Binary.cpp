@@ -0,0 +1,472 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "../runtime/Runtime.h"
+#include "Data.h"
+#include "Error.h"
+#include "String.h"
+#include "Utf8.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace s {
+
+/// Writes values in the MessagePack format, always choosing the shortest representation.
+class Encoder : public runtime::Object<Encoder> {
+public:
+    void writeInteger(int64_t value) {
+        if (value >= 0) {
+            auto u = static_cast<uint64_t>(value);
+            if (u < 0x80) {
+                byte(static_cast<uint8_t>(u));
+            }
+            else if (u <= UINT8_MAX) {
+                byte(0xcc);
+                byte(static_cast<uint8_t>(u));
+            }
+            else if (u <= UINT16_MAX) {
+                byte(0xcd);
+                bigEndian(u, 2);
+            }
+            else if (u <= UINT32_MAX) {
+                byte(0xce);
+                bigEndian(u, 4);
+            }
+            else {
+                byte(0xcf);
+                bigEndian(u, 8);
+            }
+        }
+        else if (value >= -32) {
+            byte(static_cast<uint8_t>(0xe0 | (value + 32)));
+        }
+        else if (value >= INT8_MIN) {
+            byte(0xd0);
+            bigEndian(static_cast<uint64_t>(value), 1);
+        }
+        else if (value >= INT16_MIN) {
+            byte(0xd1);
+            bigEndian(static_cast<uint64_t>(value), 2);
+        }
+        else if (value >= INT32_MIN) {
+            byte(0xd2);
+            bigEndian(static_cast<uint64_t>(value), 4);
+        }
+        else {
+            byte(0xd3);
+            bigEndian(static_cast<uint64_t>(value), 8);
+        }
+    }
+
+    void writeReal(double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        byte(0xcb);
+        bigEndian(bits, 8);
+    }
+
+    void writeString(const char *bytes, size_t count) {
+        if (count < 32) {
+            byte(static_cast<uint8_t>(0xa0 | count));
+        }
+        else {
+            header(count, 0xd9, 0xda, 0xdb);
+        }
+        append(bytes, count);
+    }
+
+    void writeData(const char *bytes, size_t count) {
+        header(count, 0xc4, 0xc5, 0xc6);
+        append(bytes, count);
+    }
+
+    /// Writes the header of an array (*fix* is 0x90, *prefix* 0xdc) or map (*fix* is 0x80, *prefix* 0xde).
+    void writeCollection(size_t count, uint8_t fix, uint8_t prefix) {
+        if (count < 16) {
+            byte(static_cast<uint8_t>(fix | count));
+        }
+        else if (count <= UINT16_MAX) {
+            byte(prefix);
+            bigEndian(count, 2);
+        }
+        else {
+            byte(prefix + 1);
+            bigEndian(count, 4);
+        }
+    }
+
+    void byte(uint8_t value) {
+        bytes_.push_back(value);
+    }
+
+    std::vector<uint8_t> bytes_;
+
+private:
+    void bigEndian(uint64_t value, int count) {
+        for (int i = count - 1; i >= 0; i--) {
+            bytes_.push_back(static_cast<uint8_t>(value >> (i * 8)));
+        }
+    }
+
+    /// Writes a length with the shortest of the prefixes for 8, 16 and 32 bit lengths.
+    void header(size_t count, uint8_t prefix8, uint8_t prefix16, uint8_t prefix32) {
+        if (count <= UINT8_MAX) {
+            byte(prefix8);
+            byte(static_cast<uint8_t>(count));
+        }
+        else if (count <= UINT16_MAX) {
+            byte(prefix16);
+            bigEndian(count, 2);
+        }
+        else {
+            byte(prefix32);
+            bigEndian(count, 4);
+        }
+    }
+
+    void append(const char *bytes, size_t count) {
+        bytes_.insert(bytes_.end(), bytes, bytes + count);
+    }
+};
+
+/// Reads values in the MessagePack format from a 📇. Strings are returned as slices of the 📇 instead of copies.
+class Decoder : public runtime::Object<Decoder> {
+public:
+    explicit Decoder(Data *data) : data_(data) {
+        data->retain();
+    }
+
+    bool readInteger(int64_t *value) {
+        uint8_t type;
+        if (!next(&type)) return false;
+        if (type < 0x80 || type >= 0xe0) {
+            *value = static_cast<int8_t>(type);
+            return true;
+        }
+        uint64_t bits;
+        switch (type) {
+            case 0xcc: return unsignedValue(1, value);
+            case 0xcd: return unsignedValue(2, value);
+            case 0xce: return unsignedValue(4, value);
+            case 0xcf: return unsignedValue(8, value);
+            case 0xd0:
+                if (!bigEndian(1, &bits)) return false;
+                *value = static_cast<int8_t>(bits);
+                return true;
+            case 0xd1:
+                if (!bigEndian(2, &bits)) return false;
+                *value = static_cast<int16_t>(bits);
+                return true;
+            case 0xd2:
+                if (!bigEndian(4, &bits)) return false;
+                *value = static_cast<int32_t>(bits);
+                return true;
+            case 0xd3:
+                if (!bigEndian(8, &bits)) return false;
+                *value = static_cast<int64_t>(bits);
+                return true;
+            default:
+                return fail("Expected an integer");
+        }
+    }
+
+    bool readReal(double *value) {
+        uint8_t type;
+        if (!peek(&type)) return false;
+        uint64_t bits;
+        if (type == 0xcb) {
+            offset_++;
+            if (!bigEndian(8, &bits)) return false;
+            std::memcpy(value, &bits, sizeof(*value));
+            return true;
+        }
+        if (type == 0xca) {
+            offset_++;
+            if (!bigEndian(4, &bits)) return false;
+            auto single = static_cast<uint32_t>(bits);
+            float real;
+            std::memcpy(&real, &single, sizeof(real));
+            *value = real;
+            return true;
+        }
+        // Integers are accepted as other encoders write integral reals as integers.
+        int64_t integer;
+        if (!readInteger(&integer)) return fail("Expected a real");
+        *value = static_cast<double>(integer);
+        return true;
+    }
+
+    bool readBoolean(bool *value) {
+        uint8_t type;
+        if (!next(&type)) return false;
+        if (type != 0xc2 && type != 0xc3) return fail("Expected a boolean");
+        *value = type == 0xc3;
+        return true;
+    }
+
+    /// Reads the header of a string and stores the offset and length of its bytes.
+    bool readString(size_t *offset, size_t *count) {
+        uint8_t type;
+        if (!next(&type)) return false;
+        if ((type & 0xe0) == 0xa0) {
+            *count = type & 0x1f;
+        }
+        else if (type < 0xd9 || type > 0xdb || !length(1 << (type - 0xd9), count)) {
+            return fail("Expected a string");
+        }
+        return bytes(*count, offset);
+    }
+
+    /// Reads the header of binary data or a string and stores the offset and length of its bytes.
+    bool readData(size_t *offset, size_t *count) {
+        uint8_t type;
+        if (!peek(&type)) return false;
+        if ((type & 0xe0) == 0xa0 || (type >= 0xd9 && type <= 0xdb)) {
+            return readString(offset, count);
+        }
+        offset_++;
+        if (type < 0xc4 || type > 0xc6 || !length(1 << (type - 0xc4), count)) {
+            return fail("Expected binary data");
+        }
+        return bytes(*count, offset);
+    }
+
+    /// Reads the header of an array (*fix* is 0x90, *prefix* 0xdc) or map (*fix* is 0x80, *prefix* 0xde).
+    bool readCollection(uint8_t fix, uint8_t prefix, size_t *count, const char *error) {
+        uint8_t type;
+        if (!next(&type)) return false;
+        if ((type & 0xf0) == fix) {
+            *count = type & 0x0f;
+            return true;
+        }
+        if (type == prefix) return length(2, count);
+        if (type == prefix + 1) return length(4, count);
+        return fail(error);
+    }
+
+    /// Consumes nil if it is the next value.
+    bool readNil() {
+        uint8_t type;
+        if (!peek(&type) || type != 0xc0) return false;
+        offset_++;
+        return true;
+    }
+
+    bool fail(const char *error) {
+        error_ = error;
+        return false;
+    }
+
+    void close() {
+        data_->release();
+    }
+
+    Data *data_;
+    size_t offset_ = 0;
+    const char *error_ = nullptr;
+
+private:
+    bool peek(uint8_t *type) {
+        if (offset_ >= static_cast<size_t>(data_->count)) return fail("Unexpected end of data");
+        *type = static_cast<uint8_t>(data_->bytes()[offset_]);
+        return true;
+    }
+
+    bool next(uint8_t *type) {
+        if (!peek(type)) return false;
+        offset_++;
+        return true;
+    }
+
+    bool bigEndian(size_t count, uint64_t *value) {
+        if (static_cast<size_t>(data_->count) - offset_ < count) return fail("Unexpected end of data");
+        auto bytes = reinterpret_cast<const uint8_t *>(data_->bytes()) + offset_;
+        *value = 0;
+        for (size_t i = 0; i < count; i++) {
+            *value = (*value << 8) | bytes[i];
+        }
+        offset_ += count;
+        return true;
+    }
+
+    bool unsignedValue(size_t count, int64_t *value) {
+        uint64_t bits;
+        if (!bigEndian(count, &bits)) return false;
+        if (bits > INT64_MAX) return fail("Integer does not fit into 🔢");
+        *value = static_cast<int64_t>(bits);
+        return true;
+    }
+
+    bool length(size_t count, size_t *length) {
+        uint64_t bits;
+        if (!bigEndian(count, &bits)) return false;
+        *length = bits;
+        return true;
+    }
+
+    /// Consumes *count* bytes and stores the offset of the first.
+    bool bytes(size_t count, size_t *offset) {
+        if (static_cast<size_t>(data_->count) - offset_ < count) return fail("Unexpected end of data");
+        *offset = offset_;
+        offset_ += count;
+        return true;
+    }
+};
+
+extern "C" Encoder* sEncoderNew() {
+    return Encoder::init();
+}
+
+extern "C" void sEncoderInteger(Encoder *encoder, runtime::Integer value) {
+    encoder->writeInteger(value);
+}
+
+extern "C" void sEncoderReal(Encoder *encoder, runtime::Real value) {
+    encoder->writeReal(value);
+}
+
+extern "C" void sEncoderBoolean(Encoder *encoder, runtime::Boolean value) {
+    encoder->byte(value ? 0xc3 : 0xc2);
+}
+
+extern "C" void sEncoderString(Encoder *encoder, String *string) {
+    encoder->writeString(string->bytes(), string->count);
+}
+
+extern "C" void sEncoderData(Encoder *encoder, Data *data) {
+    encoder->writeData(reinterpret_cast<const char *>(data->bytes()), data->count);
+}
+
+extern "C" void sEncoderList(Encoder *encoder, runtime::Integer count) {
+    encoder->writeCollection(count, 0x90, 0xdc);
+}
+
+extern "C" void sEncoderDictionary(Encoder *encoder, runtime::Integer count) {
+    encoder->writeCollection(count, 0x80, 0xde);
+}
+
+extern "C" void sEncoderNil(Encoder *encoder) {
+    encoder->byte(0xc0);
+}
+
+extern "C" Data* sEncoderBytes(Encoder *encoder) {
+    auto data = Data::init();
+    data->count = encoder->bytes_.size();
+    data->data = runtime::allocate<runtime::Byte>(data->count);
+    std::memcpy(data->data.get(), encoder->bytes_.data(), data->count);
+    return data;
+}
+
+extern "C" void sEncoderDestruct(Encoder *encoder) {
+    encoder->~Encoder();
+}
+
+extern "C" Decoder* sDecoderNew(Data *data) {
+    return Decoder::init(data);
+}
+
+extern "C" runtime::Integer sDecoderInteger(Decoder *decoder, runtime::Raiser *raiser) {
+    int64_t value;
+    if (!decoder->readInteger(&value)) {
+        EJC_RAISE(raiser, DecodingError::init(decoder->error_));
+    }
+    return value;
+}
+
+extern "C" runtime::Real sDecoderReal(Decoder *decoder, runtime::Raiser *raiser) {
+    double value;
+    if (!decoder->readReal(&value)) {
+        EJC_RAISE(raiser, DecodingError::init(decoder->error_));
+    }
+    return value;
+}
+
+extern "C" runtime::Boolean sDecoderBoolean(Decoder *decoder, runtime::Raiser *raiser) {
+    bool value;
+    if (!decoder->readBoolean(&value)) {
+        EJC_RAISE(raiser, DecodingError::init(decoder->error_));
+    }
+    return value;
+}
+
+extern "C" String* sDecoderString(Decoder *decoder, runtime::Raiser *raiser) {
+    size_t offset, count;
+    if (!decoder->readString(&offset, &count)) {
+        EJC_RAISE(raiser, DecodingError::init(decoder->error_));
+    }
+    auto bytes = reinterpret_cast<const char *>(decoder->data_->bytes()) + offset;
+    bool ascii;
+    if (!validateUtf8(bytes, count, &ascii)) {
+        EJC_RAISE(raiser, DecodingError::init("String is not valid UTF-8"));
+    }
+    if (count <= 1) {
+        return String::copy(bytes, count);
+    }
+    auto string = String::init();
+    string->characters = decoder->data_->data;
+    string->start = decoder->data_->start + offset;
+    string->count = count;
+    string->ascii.store(ascii ? String::AsciiState::Ascii : String::AsciiState::NotAscii, std::memory_order_relaxed);
+    decoder->data_->data.retain();
+    return string;
+}
+
+extern "C" Data* sDecoderData(Decoder *decoder, runtime::Raiser *raiser) {
+    size_t offset, count;
+    if (!decoder->readData(&offset, &count)) {
+        EJC_RAISE(raiser, DecodingError::init(decoder->error_));
+    }
+    // The data shares the bytes of the decoded data.
+    auto data = Data::init();
+    data->count = count;
+    data->data = decoder->data_->data;
+    data->start = decoder->data_->start + offset;
+    decoder->data_->data.retain();
+    return data;
+}
+
+extern "C" runtime::Integer sDecoderList(Decoder *decoder, runtime::Raiser *raiser) {
+    size_t count;
+    if (!decoder->readCollection(0x90, 0xdc, &count, "Expected an array")) {
+        EJC_RAISE(raiser, DecodingError::init(decoder->error_));
+    }
+    return count;
+}
+
+extern "C" runtime::Integer sDecoderDictionary(Decoder *decoder, runtime::Raiser *raiser) {
+    size_t count;
+    if (!decoder->readCollection(0x80, 0xde, &count, "Expected a map")) {
+        EJC_RAISE(raiser, DecodingError::init(decoder->error_));
+    }
+    return count;
+}
+
+extern "C" void sDecoderFields(Decoder *decoder, runtime::Integer fields, runtime::Raiser *raiser) {
+    size_t count;
+    if (!decoder->readCollection(0x90, 0xdc, &count, "Expected an array")) {
+        EJC_RAISE_VOID(raiser, DecodingError::init(decoder->error_));
+    }
+    if (count != static_cast<size_t>(fields)) {
+        EJC_RAISE_VOID(raiser, DecodingError::init("Number of fields does not match the type"));
+    }
+}
+
+extern "C" runtime::Boolean sDecoderNil(Decoder *decoder) {
+    return decoder->readNil();
+}
+
+extern "C" runtime::Boolean sDecoderAtEnd(Decoder *decoder) {
+    return decoder->offset_ == static_cast<size_t>(decoder->data_->count);
+}
+
+extern "C" void sDecoderDestruct(Decoder *decoder) {
+    decoder->close();
+    decoder->~Decoder();
+}
+
+}  // namespace s
+
+SET_INFO_FOR(s::Encoder, s, 1f5a8)
+SET_INFO_FOR(s::Decoder, s, 1f52c)
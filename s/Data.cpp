@@ -4,9 +4,11 @@
 
 #include "../runtime/Runtime.h"
 #include "Data.h"
+#include "Search.h"
 #include "String.h"
-#include "utf8proc.h"
+#include "Utf8.h"
 #include <algorithm>
+#include <cstring>
 
 namespace s {
 
@@ -15,24 +17,358 @@ extern "C" runtime::SimpleOptional<runtime::Integer> sDataFindFromIndex(Data *da
     if (offset >= data->count) {
         return runtime::NoValue;
     }
-    auto end = data->data.get() + data->count;
-    auto pos = std::search(data->data.get() + offset, end, search->data.get(), search->data.get() + search->count);
-    if (pos != end) {
-        return pos - data->data.get();
+    auto pos = findBytes(data->bytes() + offset, data->count - offset, search->bytes(), search->count);
+    if (pos != nullptr) {
+        return pos - data->bytes();
     }
     return runtime::NoValue;
 }
 
-extern "C" runtime::SimpleOptional<String *> sDataAsString(Data *data) {
-    auto chars = reinterpret_cast<char *>(data->data.get());
+extern "C" Data* sDataSlice(Data *data, runtime::Integer from, runtime::Integer length) {
+    from = std::min(std::max(from, runtime::Integer(0)), data->count);
+    auto slice = Data::init();
+    slice->count = std::min(std::max(length, runtime::Integer(0)), data->count - from);
+    slice->data = data->data;
+    slice->start = data->start + from;
+    data->data.retain();
+    return slice;
+}
+
+extern "C" bool sDataEqual(Data *data, Data *other) {
+    return data->count == other->count && std::memcmp(data->bytes(), other->bytes(), data->count) == 0;
+}
+
+extern "C" void sDataCompact(Data *data) {
+    if (data->data.controlBlock() == &ejcIgnoreBlock || (data->start == 0 && data->data.isOnlyReference())) {
+        return;
+    }
+    auto memory = runtime::allocate<runtime::Byte>(data->count);
+    std::memcpy(memory.get(), data->bytes(), data->count);
+    data->data.release();
+    data->data = memory;
+    data->start = 0;
+}
 
-    // TODO: validate
+namespace {
 
+/// Returns a string sharing the bytes of `data`.
+String* stringFromData(Data *data, String::AsciiState ascii) {
     auto *string = String::init();
     string->count = data->count;
     string->characters = data->data;
+    string->start = data->start;
+    string->ascii.store(ascii, std::memory_order_relaxed);
     data->data.retain();
     return string;
 }
 
+}  // namespace
+
+extern "C" runtime::SimpleOptional<String *> sDataAsString(Data *data) {
+    bool ascii;
+    if (!validateUtf8(data->bytes(), data->count, &ascii)) {
+        return runtime::NoValue;
+    }
+    return stringFromData(data, ascii ? String::AsciiState::Ascii : String::AsciiState::NotAscii);
+}
+
+extern "C" String* sDataAsStringUnchecked(Data *data) {
+    return stringFromData(data, String::AsciiState::Unknown);
+}
+
+namespace {
+
+constexpr char kBase64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+constexpr char kBase64UrlAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+constexpr char kHexDigits[] = "0123456789abcdef";
+constexpr char kUppercaseHexDigits[] = "0123456789ABCDEF";
+
+/// Marks the bytes that are not digits in kBase64Values and kHexValues. Decoders OR the values of all bytes together
+/// and check for this bit once at the end instead of branching on every byte.
+constexpr uint32_t kInvalid = 0x100;
+
+/// The tables the encoders and decoders look bytes up in.
+struct Tables {
+    /// The value of each byte as a Base64 digit of either alphabet or kInvalid.
+    uint32_t base64Values[256] = {};
+    /// The value of each byte as a hexadecimal digit or kInvalid.
+    uint32_t hexValues[256] = {};
+    /// The two lowercase hexadecimal digits of each byte.
+    char hexPairs[512] = {};
+    /// Whether a byte is an unreserved character of RFC 3986, which percent-encoding keeps.
+    bool unreserved[256] = {};
+
+    constexpr Tables() {
+        for (int i = 0; i < 256; i++) {
+            base64Values[i] = kInvalid;
+            hexValues[i] = kInvalid;
+            hexPairs[i * 2] = kHexDigits[i >> 4];
+            hexPairs[i * 2 + 1] = kHexDigits[i & 0xF];
+            unreserved[i] = (i >= 'A' && i <= 'Z') || (i >= 'a' && i <= 'z') || (i >= '0' && i <= '9') ||
+                            i == '-' || i == '.' || i == '_' || i == '~';
+        }
+        for (int i = 0; i < 64; i++) {
+            base64Values[static_cast<uint8_t>(kBase64Alphabet[i])] = i;
+            base64Values[static_cast<uint8_t>(kBase64UrlAlphabet[i])] = i;
+        }
+        for (int i = 0; i < 16; i++) {
+            hexValues[static_cast<uint8_t>(kHexDigits[i])] = i;
+            hexValues[static_cast<uint8_t>(kUppercaseHexDigits[i])] = i;
+        }
+    }
+};
+
+constexpr Tables kTables;
+
+/// Returns a string of `count` ASCII characters whose bytes are yet to be written.
+String* asciiString(size_t count) {
+    auto string = String::init();
+    string->count = count;
+    string->characters = runtime::allocate<char>(count);
+    string->ascii.store(String::AsciiState::Ascii, std::memory_order_relaxed);
+    return string;
+}
+
+/// Returns a 📇 of `count` bytes that are yet to be written.
+Data* dataOfCount(size_t count) {
+    auto data = Data::init();
+    data->count = count;
+    data->data = runtime::allocate<runtime::Byte>(count);
+    return data;
+}
+
+/// Writes the Base64 encoding of `count` bytes with `alphabet` to `out`, followed by padding if `pad` is true.
+EJC_MULTIVERSIONED void encodeBase64(const uint8_t *bytes, size_t count, const char *alphabet, bool pad, char *out) {
+    size_t i = 0;
+    for (; i + 3 <= count; i += 3) {
+        uint32_t group = bytes[i] << 16 | bytes[i + 1] << 8 | bytes[i + 2];
+        out[0] = alphabet[group >> 18];
+        out[1] = alphabet[group >> 12 & 0x3F];
+        out[2] = alphabet[group >> 6 & 0x3F];
+        out[3] = alphabet[group & 0x3F];
+        out += 4;
+    }
+    if (i == count) {
+        return;
+    }
+    uint32_t group = bytes[i] << 16 | (i + 1 < count ? bytes[i + 1] << 8 : 0);
+    *out++ = alphabet[group >> 18];
+    *out++ = alphabet[group >> 12 & 0x3F];
+    if (i + 1 < count) {
+        *out++ = alphabet[group >> 6 & 0x3F];
+    }
+    else if (pad) {
+        *out++ = '=';
+    }
+    if (pad) {
+        *out = '=';
+    }
+}
+
+/// Returns the Base64 encoding of `data`. Padded encodings are a multiple of four characters long.
+String* base64(Data *data, const char *alphabet, bool pad) {
+    auto count = static_cast<size_t>(data->count);
+    auto length = pad ? (count + 2) / 3 * 4 : count / 3 * 4 + (count % 3 == 0 ? 0 : count % 3 + 1);
+    auto string = asciiString(length);
+    encodeBase64(reinterpret_cast<const uint8_t *>(data->bytes()), count, alphabet, pad, string->bytes());
+    return string;
+}
+
+/// Decodes `count` Base64 digits without padding to `out`. Returns false if a character is not a digit, if `count`
+/// cannot be the length of an encoding or if the unused bits of the last digit are not zero.
+EJC_MULTIVERSIONED bool decodeBase64(const uint8_t *chars, size_t count, uint8_t *out) {
+    auto &values = kTables.base64Values;
+    uint32_t invalid = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        auto a = values[chars[i]], b = values[chars[i + 1]], c = values[chars[i + 2]], d = values[chars[i + 3]];
+        invalid |= a | b | c | d;
+        uint32_t group = a << 18 | b << 12 | c << 6 | d;
+        out[0] = group >> 16;
+        out[1] = group >> 8;
+        out[2] = group;
+        out += 3;
+    }
+    switch (count - i) {
+        case 0:
+            break;
+        case 2: {
+            auto a = values[chars[i]], b = values[chars[i + 1]];
+            invalid |= a | b | (b & 0xF ? kInvalid : 0);
+            out[0] = a << 2 | b >> 4;
+            break;
+        }
+        case 3: {
+            auto a = values[chars[i]], b = values[chars[i + 1]], c = values[chars[i + 2]];
+            invalid |= a | b | c | (c & 0x3 ? kInvalid : 0);
+            out[0] = a << 2 | b >> 4;
+            out[1] = b << 4 | c >> 2;
+            break;
+        }
+        default:
+            return false;
+    }
+    return (invalid & kInvalid) == 0;
+}
+
+/// Writes the bytes as pairs of lowercase hexadecimal digits to `out`.
+EJC_MULTIVERSIONED void encodeHex(const uint8_t *bytes, size_t count, char *out) {
+    for (size_t i = 0; i < count; i++) {
+        std::memcpy(out + i * 2, kTables.hexPairs + bytes[i] * 2, 2);
+    }
+}
+
+/// Decodes `count` / 2 pairs of hexadecimal digits of either case. Returns false if a character is not a digit.
+EJC_MULTIVERSIONED bool decodeHex(const uint8_t *chars, size_t count, uint8_t *out) {
+    auto &values = kTables.hexValues;
+    uint32_t invalid = 0;
+    for (size_t i = 0; i < count / 2; i++) {
+        auto high = values[chars[i * 2]], low = values[chars[i * 2 + 1]];
+        invalid |= high | low;
+        out[i] = high << 4 | low;
+    }
+    return (invalid & kInvalid) == 0;
+}
+
+/// Returns the number of bytes that are not kept by percent-encoding.
+EJC_MULTIVERSIONED size_t countReserved(const uint8_t *bytes, size_t count) {
+    size_t reserved = 0;
+    for (size_t i = 0; i < count; i++) {
+        reserved += !kTables.unreserved[bytes[i]];
+    }
+    return reserved;
+}
+
+/// Returns the percent-encoding of `count` bytes of which `reserved` bytes, as counted by countReserved(), are
+/// escaped. As the length of the result is known, the encoding is written in one pass.
+String* percentEncode(const uint8_t *bytes, size_t count, size_t reserved) {
+    auto string = asciiString(count + reserved * 2);
+    auto out = string->bytes();
+    for (size_t i = 0; i < count; i++) {
+        if (kTables.unreserved[bytes[i]]) {
+            *out++ = static_cast<char>(bytes[i]);
+        }
+        else {
+            out[0] = '%';
+            out[1] = kUppercaseHexDigits[bytes[i] >> 4];
+            out[2] = kUppercaseHexDigits[bytes[i] & 0xF];
+            out += 3;
+        }
+    }
+    return string;
+}
+
+/// Decodes the percent-encoded `count` bytes to `out`, which must have room for `count` bytes, and returns the number
+/// of bytes written or -1 if a `%` is not followed by two hexadecimal digits. Other bytes are copied unchanged. The
+/// runs between two `%` are found with memchr() and copied as a whole.
+runtime::Integer percentDecode(const uint8_t *chars, size_t count, uint8_t *out) {
+    auto &values = kTables.hexValues;
+    auto end = chars + count;
+    auto start = out;
+    while (chars < end) {
+        auto percent = static_cast<const uint8_t *>(std::memchr(chars, '%', end - chars));
+        auto run = (percent == nullptr ? end : percent) - chars;
+        std::memcpy(out, chars, run);
+        out += run;
+        if (percent == nullptr) {
+            break;
+        }
+        if (end - percent < 3 || ((values[percent[1]] | values[percent[2]]) & kInvalid) != 0) {
+            return -1;
+        }
+        *out++ = values[percent[1]] << 4 | values[percent[2]];
+        chars = percent + 3;
+    }
+    return out - start;
+}
+
+}  // namespace
+
+extern "C" String* sDataBase64(Data *data) {
+    return base64(data, kBase64Alphabet, true);
+}
+
+extern "C" String* sDataBase64Url(Data *data) {
+    return base64(data, kBase64UrlAlphabet, false);
+}
+
+extern "C" runtime::SimpleOptional<Data*> sDataFromBase64(runtime::ClassInfo *, String *text) {
+    auto chars = reinterpret_cast<const uint8_t *>(text->bytes());
+    auto count = static_cast<size_t>(text->count);
+    auto length = count;
+    while (length > 0 && count - length < 2 && chars[length - 1] == '=') {
+        length--;
+    }
+    // Padding, if present, must complete the last group of four characters.
+    if (length != count && count % 4 != 0) {
+        return runtime::NoValue;
+    }
+    auto data = dataOfCount(length / 4 * 3 + (length % 4 == 0 ? 0 : length % 4 - 1));
+    if (!decodeBase64(chars, length, reinterpret_cast<uint8_t *>(data->bytes()))) {
+        data->release();
+        return runtime::NoValue;
+    }
+    return data;
+}
+
+extern "C" String* sDataHex(Data *data) {
+    auto string = asciiString(data->count * 2);
+    encodeHex(reinterpret_cast<const uint8_t *>(data->bytes()), data->count, string->bytes());
+    return string;
+}
+
+extern "C" runtime::SimpleOptional<Data*> sDataFromHex(runtime::ClassInfo *, String *text) {
+    if (text->count % 2 != 0) {
+        return runtime::NoValue;
+    }
+    auto data = dataOfCount(text->count / 2);
+    if (!decodeHex(reinterpret_cast<const uint8_t *>(text->bytes()), text->count,
+                   reinterpret_cast<uint8_t *>(data->bytes()))) {
+        data->release();
+        return runtime::NoValue;
+    }
+    return data;
+}
+
+extern "C" String* sDataPercentEncode(Data *data) {
+    auto bytes = reinterpret_cast<const uint8_t *>(data->bytes());
+    return percentEncode(bytes, data->count, countReserved(bytes, data->count));
+}
+
+extern "C" runtime::SimpleOptional<Data*> sDataFromPercentEncoding(runtime::ClassInfo *, String *text) {
+    auto data = dataOfCount(text->count);
+    auto count = percentDecode(reinterpret_cast<const uint8_t *>(text->bytes()), text->count,
+                               reinterpret_cast<uint8_t *>(data->bytes()));
+    if (count < 0) {
+        data->release();
+        return runtime::NoValue;
+    }
+    data->count = count;
+    return data;
+}
+
+extern "C" String* sStringPercentEncode(String *string) {
+    auto bytes = reinterpret_cast<const uint8_t *>(string->bytes());
+    auto reserved = countReserved(bytes, string->count);
+    if (reserved == 0) {
+        string->retain();
+        return string;
+    }
+    return percentEncode(bytes, string->count, reserved);
+}
+
+extern "C" runtime::SimpleOptional<String*> sStringPercentDecode(String *string) {
+    auto data = dataOfCount(string->count);
+    auto count = percentDecode(reinterpret_cast<const uint8_t *>(string->bytes()), string->count,
+                               reinterpret_cast<uint8_t *>(data->bytes()));
+    if (count < 0) {
+        data->release();
+        return runtime::NoValue;
+    }
+    data->count = count;
+    auto result = sDataAsString(data);
+    data->release();
+    return result;
+}
+
 }  // namespace s
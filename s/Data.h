@@ -13,6 +13,11 @@ class Data : public runtime::Object<Data>  {
 public:
     runtime::MemoryPointer<runtime::Byte> data;
     runtime::Integer count;
+    /// The index in `data` of the first byte. Slices share the bytes of another 📇 and begin at an arbitrary index.
+    runtime::Integer start = 0;
+
+    /// Returns a pointer to the first byte.
+    runtime::Byte* bytes() const { return data.get() + start; }
 };
 
 }  // namespace s
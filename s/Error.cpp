@@ -13,3 +13,11 @@
 s::IOError::IOError() : message(s::String::init(std::strerror(errno))) {
 
 }
+
+s::IOError::IOError(const char *message) : message(s::String::init(message)) {
+
+}
+
+s::DecodingError::DecodingError(const char *message) : message(s::String::init(message)) {
+
+}
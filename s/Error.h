@@ -34,10 +34,21 @@ private:
     runtime::SimpleOptional<s::String*> location = runtime::NoValue;
 };
 
+/// Raised when a 🔬 encounters data that is not valid MessagePack or does not match the decoded type.
+class DecodingError : public runtime::Object<DecodingError>  {
+public:
+    DecodingError(const char *message);
+
+private:
+    s::String *message;
+    runtime::SimpleOptional<s::String*> location = runtime::NoValue;
+};
+
 }  // namespace s
 
 SET_INFO_FOR(s::Error, s, 1f6a7)
 SET_INFO_FOR(s::IOError, s, 1f6a7_1f538_2195)
+SET_INFO_FOR(s::DecodingError, s, 1f6a7_1f538_1f9ec)
 
 #define EJC_COND_RAISE_IO(cond, raiser) if (!(cond)) { EJC_RAISE(raiser, s::IOError::init()); }
 #define EJC_COND_RAISE_IO_VOID(cond, raiser) if (!(cond)) { EJC_RAISE_VOID(raiser, s::IOError::init()); }
@@ -0,0 +1,269 @@
+//
+// Created by Theo Weidmann on 14.10.26.
+//
+
+#include "Format.h"
+#include "../Compiler/Utils/rapidjson/internal/dtoa.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace s {
+
+namespace {
+
+constexpr char kDigits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+constexpr char kDigitPairs[] = "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+constexpr double kPow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19,
+    1e20, 1e21, 1e22
+};
+/// The powers of ten that fit into an uint64_t, except that the first entry is 0 so that decimalLength() counts a
+/// digit for 0.
+constexpr uint64_t kIntegerPow10[] = {
+    0, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+    10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL, 1000000000000000ULL,
+    10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+/// Powers of ten up to this one are represented exactly by a double.
+constexpr int kMaxExactPow10 = 22;
+/// formatReal() uses integer arithmetic for precisions up to this one, with which the fractional digits always fit
+/// into an uint64_t.
+constexpr runtime::Integer kMaxIntegerPrecision = 18;
+/// The number of significant digits parseReal() collects in an uint64_t.
+constexpr int kMaxMantissaDigits = 19;
+
+size_t decimalLength(uint64_t n) {
+    // 1233 / 4096 approximates log10(2), which turns the number of bits of n into its number of digits or one less.
+    auto bits = 64 - __builtin_clzll(n | 1);
+    auto length = static_cast<size_t>(bits * 1233 >> 12);
+    return n < kIntegerPow10[length] ? length : length + 1;
+}
+
+/// Writes the decimal digits of n so that the last digit is located before end.
+/// @returns A pointer to the first digit.
+char* writeDecimal(char *end, uint64_t n) {
+    while (n >= 100) {
+        auto pair = (n % 100) * 2;
+        n /= 100;
+        *--end = kDigitPairs[pair + 1];
+        *--end = kDigitPairs[pair];
+    }
+    if (n >= 10) {
+        *--end = kDigitPairs[n * 2 + 1];
+        *--end = kDigitPairs[n * 2];
+    }
+    else {
+        *--end = static_cast<char>('0' + n);
+    }
+    return end;
+}
+
+/// Returns the value of the digit c in bases up to 36 or 36 if c is not a digit.
+uint64_t digitValue(char c) {
+    if ('0' <= c && c <= '9') return c - '0';
+    if ('a' <= c && c <= 'z') return c - 'a' + 10;
+    if ('A' <= c && c <= 'Z') return c - 'A' + 10;
+    return 36;
+}
+
+size_t formatWithPrintf(char *buffer, runtime::Real real, runtime::Integer precision) {
+    auto length = std::snprintf(nullptr, 0, "%.*f", static_cast<int>(precision), real);
+    if (buffer != nullptr) {
+        std::string string(length, '\0');
+        std::snprintf(&string[0], length + 1, "%.*f", static_cast<int>(precision), real);
+        std::memcpy(buffer, string.data(), length);
+    }
+    return length;
+}
+
+}  // namespace
+
+size_t formatInteger(char *buffer, runtime::Integer n, runtime::Integer base) {
+    bool negative = n < 0;
+    auto a = negative ? 0 - static_cast<uint64_t>(n) : static_cast<uint64_t>(n);
+    if (base == 10) {
+        auto length = decimalLength(a) + negative;
+        writeDecimal(buffer + length, a);
+        if (negative) {
+            buffer[0] = '-';
+        }
+        return length;
+    }
+
+    auto b = static_cast<uint64_t>(base);
+    auto characters = buffer;
+    if ((b & (b - 1)) == 0) {
+        // Every digit of a power of two base stands for the same number of bits.
+        auto shift = __builtin_ctzll(b);
+        auto bits = 64 - __builtin_clzll(a | 1);
+        characters += (bits + shift - 1) / shift + negative;
+        auto end = characters;
+        do {
+            *--characters = kDigits[a & (b - 1)];
+        } while ((a >>= shift) > 0);
+        if (negative) {
+            buffer[0] = '-';
+        }
+        return end - buffer;
+    }
+
+    size_t length = negative ? 2 : 1;
+    for (auto ac = a; (ac /= b) != 0;) {
+        length++;
+    }
+    characters += length;
+    do {
+        *--characters = kDigits[a % b];
+    } while ((a /= b) > 0);
+    if (negative) {
+        buffer[0] = '-';
+    }
+    return length;
+}
+
+size_t formatReal(char *buffer, runtime::Real real, runtime::Integer precision) {
+    double integral;
+    double fractional = std::modf(real, &integral);
+
+    // Beyond these limits the digits cannot be calculated with integers.
+    if (!std::isfinite(real) || std::abs(integral) >= 9e18 || precision > kMaxIntegerPrecision) {
+        return formatWithPrintf(buffer, real, precision > 0 ? precision : 0);
+    }
+
+    if (precision <= 0) {
+        char digits[kMaxIntegerLength];
+        auto length = formatInteger(digits, static_cast<runtime::Integer>(integral), 10);
+        if (buffer != nullptr) {
+            std::memcpy(buffer, digits, length);
+        }
+        return length;
+    }
+
+    bool negative = real < 0;
+    auto a = static_cast<uint64_t>(std::abs(integral));
+    auto length = (negative ? 2 : 1) + decimalLength(a) + precision;
+    if (buffer == nullptr) {
+        return length;
+    }
+
+    auto f = static_cast<uint64_t>(std::abs(kPow10[precision] * fractional));
+    auto characters = buffer + length;
+    for (decltype(precision) i = 0; i < precision; i++) {
+        *--characters = static_cast<char>('0' + f % 10);
+        f /= 10;
+    }
+    *--characters = '.';
+    writeDecimal(characters, a);
+    if (negative) {
+        buffer[0] = '-';
+    }
+    return length;
+}
+
+size_t formatShortestReal(char *buffer, runtime::Real real) {
+    if (std::isnan(real)) {
+        std::memcpy(buffer, "nan", 3);
+        return 3;
+    }
+    if (std::isinf(real)) {
+        std::memcpy(buffer, real < 0 ? "-inf" : "inf", real < 0 ? 4 : 3);
+        return real < 0 ? 4 : 3;
+    }
+    return rapidjson::internal::dtoa(real, buffer) - buffer;
+}
+
+runtime::SimpleOptional<runtime::Integer> parseInteger(const char *begin, const char *end, runtime::Integer base) {
+    bool negative = false;
+    if (begin != end && (*begin == '-' || *begin == '+')) {
+        negative = *begin == '-';
+        begin++;
+    }
+    if (begin == end) {
+        return runtime::NoValue;
+    }
+
+    auto b = static_cast<uint64_t>(base);
+    uint64_t limit = negative ? static_cast<uint64_t>(INT64_MAX) + 1 : INT64_MAX;
+    uint64_t x = 0;
+    for (; begin != end; begin++) {
+        auto d = digitValue(*begin);
+        if (d >= b || x > (limit - d) / b) {
+            return runtime::NoValue;
+        }
+        x = x * b + d;
+    }
+    return static_cast<runtime::Integer>(negative ? 0 - x : x);
+}
+
+runtime::SimpleOptional<runtime::Real> parseReal(const char *begin, const char *end) {
+    auto p = begin;
+    bool negative = false;
+    if (p != end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    int mantissaDigits = 0;
+    int64_t exponent = 0;
+    bool foundDigit = false;
+    bool truncated = false;
+    auto addDigit = [&](char c, bool fractional) {
+        foundDigit = true;
+        if (mantissa == 0 && c == '0') {
+            exponent -= fractional;
+        }
+        else if (mantissaDigits < kMaxMantissaDigits) {
+            mantissa = mantissa * 10 + (c - '0');
+            mantissaDigits++;
+            exponent -= fractional;
+        }
+        else {
+            truncated = true;
+            exponent += !fractional;
+        }
+    };
+
+    for (; p != end && '0' <= *p && *p <= '9'; p++) {
+        addDigit(*p, false);
+    }
+    if (p != end && *p == '.') {
+        for (p++; p != end && '0' <= *p && *p <= '9'; p++) {
+            addDigit(*p, true);
+        }
+    }
+    if (!foundDigit) {
+        return runtime::NoValue;
+    }
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        auto explicitExponent = parseInteger(p + 1, end, 10);
+        if (explicitExponent == runtime::NoValue) {
+            return runtime::NoValue;
+        }
+        // Clamped so that the sum cannot overflow. Such exponents are handled by strtod anyway.
+        exponent += std::max<int64_t>(-100000, std::min<int64_t>(100000, *explicitExponent));
+        p = end;
+    }
+    if (p != end) {
+        return runtime::NoValue;
+    }
+
+    if (mantissa == 0) {
+        return negative ? -0.0 : 0.0;
+    }
+    // The mantissa and the power of ten are represented exactly, the single operation is therefore correctly rounded.
+    if (!truncated && mantissa <= (uint64_t(1) << 53) && -kMaxExactPow10 <= exponent && exponent <= kMaxExactPow10) {
+        auto value = static_cast<double>(mantissa);
+        value = exponent < 0 ? value / kPow10[-exponent] : value * kPow10[exponent];
+        return negative ? -value : value;
+    }
+    return std::strtod(std::string(begin, end).c_str(), nullptr);
+}
+
+}  // namespace s
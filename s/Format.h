@@ -0,0 +1,50 @@
+//
+// Created by Theo Weidmann on 14.10.26.
+//
+
+#ifndef EMOJICODE_FORMAT_HPP
+#define EMOJICODE_FORMAT_HPP
+
+#include "../runtime/Runtime.h"
+#include <cstddef>
+
+namespace s {
+
+/// The maximum number of bytes formatInteger() writes, which is the length of the smallest Integer in base 2.
+constexpr size_t kMaxIntegerLength = 65;
+/// The maximum number of bytes formatInteger() writes for base 10.
+constexpr size_t kMaxDecimalIntegerLength = 20;
+/// The maximum number of bytes formatShortestReal() writes.
+constexpr size_t kMaxShortestRealLength = 32;
+
+/// Writes the representation of `n` in `base` to `buffer`, which must have room for kMaxIntegerLength bytes.
+/// `base` must be in the range 2 to 36 and the digits above 9 are represented by lowercase letters. Decimal digits are
+/// produced two at a time.
+/// @returns The number of bytes written.
+size_t formatInteger(char *buffer, runtime::Integer n, runtime::Integer base);
+
+/// Writes `real` with `precision` digits after the decimal separator to `buffer`. Further digits are truncated. If
+/// `precision` is not positive, only the integral part is written like by formatInteger().
+/// @param buffer The destination or nullptr to only determine the number of bytes needed.
+/// @returns The number of bytes written.
+size_t formatReal(char *buffer, runtime::Real real, runtime::Integer precision);
+
+/// Writes the shortest representation of `real` that parseReal() converts back to exactly `real` to `buffer`, which
+/// must have room for kMaxShortestRealLength bytes. The digits are found with the Grisu2 algorithm. NaN and the
+/// infinities are written as “nan”, “inf” and “-inf”, which parseReal() does not accept.
+/// @returns The number of bytes written.
+size_t formatShortestReal(char *buffer, runtime::Real real);
+
+/// Parses all bytes in [`begin`, `end`) as an integer in `base`, optionally preceded by “+” or “-”. Digits above 9 may
+/// be represented by lowercase or uppercase letters.
+/// @returns NoValue if the bytes do not represent an integer or the integer cannot be represented by Integer.
+runtime::SimpleOptional<runtime::Integer> parseInteger(const char *begin, const char *end, runtime::Integer base);
+
+/// Parses all bytes in [`begin`, `end`) as a decimal number, optionally preceded by “+” or “-”, with an optional
+/// fractional part and an optional exponent introduced by “e” or “E”. The result is correctly rounded.
+/// @returns NoValue if the bytes do not represent a number.
+runtime::SimpleOptional<runtime::Real> parseReal(const char *begin, const char *end);
+
+}  // namespace s
+
+#endif //EMOJICODE_FORMAT_HPP
@@ -0,0 +1,556 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "../runtime/Runtime.h"
+#include "Data.h"
+#include "String.h"
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define EJC_HASH_X86
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define EJC_HASH_ARM_CRC32
+#endif
+
+namespace s {
+
+namespace {
+
+/// The reflected polynomial of CRC32C (Castagnoli), which SSE 4.2 and ARMv8 implement in hardware.
+constexpr uint32_t kCrc32cPolynomial = 0x82F63B78;
+
+/// The tables of the slicing-by-8 algorithm: `values[k][byte]` is the CRC of `byte` followed by `k` zero bytes.
+struct Crc32cTable {
+    uint32_t values[8][256] = {};
+
+    constexpr Crc32cTable() {
+        for (uint32_t i = 0; i < 256; i++) {
+            auto crc = i;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc >> 1) ^ (crc & 1 ? kCrc32cPolynomial : 0);
+            }
+            values[0][i] = crc;
+        }
+        for (int k = 1; k < 8; k++) {
+            for (int i = 0; i < 256; i++) {
+                values[k][i] = (values[k - 1][i] >> 8) ^ values[0][values[k - 1][i] & 0xFF];
+            }
+        }
+    }
+};
+
+constexpr Crc32cTable kCrc32cTable;
+
+/// Continues the CRC `crc`, which is kept inverted like the register of the hardware instructions, with `count` bytes.
+uint32_t crc32cSoftware(uint32_t crc, const uint8_t *bytes, size_t count) {
+    auto &t = kCrc32cTable.values;
+    for (; count >= 8; bytes += 8, count -= 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes, sizeof(word));
+        word ^= crc;
+        crc = t[7][word & 0xFF] ^ t[6][word >> 8 & 0xFF] ^ t[5][word >> 16 & 0xFF] ^ t[4][word >> 24 & 0xFF] ^
+              t[3][word >> 32 & 0xFF] ^ t[2][word >> 40 & 0xFF] ^ t[1][word >> 48 & 0xFF] ^ t[0][word >> 56];
+    }
+    for (; count > 0; bytes++, count--) {
+        crc = t[0][(crc ^ *bytes) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#if defined(EJC_HASH_X86)
+
+/// The instruction set extensions used below, which are detected once with cpuid.
+struct CpuFeatures {
+    bool sse42 = false;
+    bool sha = false;
+
+    CpuFeatures() {
+        unsigned eax, ebx, ecx, edx;
+        if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+            sse42 = (ecx & bit_SSE4_2) != 0;
+            auto ssse3AndSse41 = (ecx & bit_SSSE3) != 0 && (ecx & bit_SSE4_1) != 0;
+            if (ssse3AndSse41 && __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+                sha = (ebx & bit_SHA) != 0;
+            }
+        }
+    }
+};
+
+const CpuFeatures& cpuFeatures() {
+    static const CpuFeatures features;
+    return features;
+}
+
+__attribute__((target("sse4.2"))) uint32_t crc32cHardware(uint32_t crc, const uint8_t *bytes, size_t count) {
+    uint64_t crc64 = crc;
+    for (; count >= 8; bytes += 8, count -= 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = static_cast<uint32_t>(crc64);
+    for (; count > 0; bytes++, count--) {
+        crc = _mm_crc32_u8(crc, *bytes);
+    }
+    return crc;
+}
+
+#elif defined(EJC_HASH_ARM_CRC32)
+
+uint32_t crc32cHardware(uint32_t crc, const uint8_t *bytes, size_t count) {
+    for (; count >= 8; bytes += 8, count -= 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes, sizeof(word));
+        crc = __crc32cd(crc, word);
+    }
+    for (; count > 0; bytes++, count--) {
+        crc = __crc32cb(crc, *bytes);
+    }
+    return crc;
+}
+
+#endif
+
+/// Continues the inverted CRC `crc` with `count` bytes, using the CRC instructions of the processor if it has them.
+uint32_t crc32c(uint32_t crc, const uint8_t *bytes, size_t count) {
+#if defined(EJC_HASH_X86)
+    if (cpuFeatures().sse42) {
+        return crc32cHardware(crc, bytes, count);
+    }
+    return crc32cSoftware(crc, bytes, count);
+#elif defined(EJC_HASH_ARM_CRC32)
+    return crc32cHardware(crc, bytes, count);
+#else
+    return crc32cSoftware(crc, bytes, count);
+#endif
+}
+
+constexpr uint64_t kXxPrime1 = 0x9E3779B185EBCA87;
+constexpr uint64_t kXxPrime2 = 0xC2B2AE3D27D4EB4F;
+constexpr uint64_t kXxPrime3 = 0x165667B19E3779F9;
+constexpr uint64_t kXxPrime4 = 0x85EBCA77C2B2AE63;
+constexpr uint64_t kXxPrime5 = 0x27D4EB2F165667C5;
+
+uint64_t rotate(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+uint64_t read64(const uint8_t *bytes) {
+    uint64_t word;
+    std::memcpy(&word, bytes, sizeof(word));
+    return word;
+}
+
+uint32_t read32(const uint8_t *bytes) {
+    uint32_t word;
+    std::memcpy(&word, bytes, sizeof(word));
+    return word;
+}
+
+uint64_t xxRound(uint64_t accumulator, uint64_t input) {
+    return rotate(accumulator + input * kXxPrime2, 31) * kXxPrime1;
+}
+
+uint64_t xxMerge(uint64_t hash, uint64_t accumulator) {
+    return (hash ^ xxRound(0, accumulator)) * kXxPrime1 + kXxPrime4;
+}
+
+constexpr uint32_t kSha256RoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+uint32_t rotateRight(uint32_t x, int k) {
+    return (x >> k) | (x << (32 - k));
+}
+
+uint32_t readBigEndian32(const uint8_t *bytes) {
+    return static_cast<uint32_t>(bytes[0]) << 24 | bytes[1] << 16 | bytes[2] << 8 | bytes[3];
+}
+
+void sha256BlocksSoftware(uint32_t *state, const uint8_t *bytes, size_t blocks) {
+    for (; blocks > 0; blocks--, bytes += 64) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; i++) {
+            w[i] = readBigEndian32(bytes + i * 4);
+        }
+        for (int i = 16; i < 64; i++) {
+            auto s0 = rotateRight(w[i - 15], 7) ^ rotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            auto s1 = rotateRight(w[i - 2], 17) ^ rotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        auto a = state[0], b = state[1], c = state[2], d = state[3];
+        auto e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; i++) {
+            auto t1 = h + (rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25)) + ((e & f) ^ (~e & g)) +
+                      kSha256RoundConstants[i] + w[i];
+            auto t2 = (rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#if defined(EJC_HASH_X86)
+
+/// Processes the blocks with the SHA extensions. Each group of four rounds takes two sha256rnds2 instructions, while
+/// sha256msg1 and sha256msg2 compute the message schedule four words at a time.
+__attribute__((target("sha,sse4.1"))) void sha256BlocksHardware(uint32_t *state, const uint8_t *bytes,
+                                                                 size_t blocks) {
+    const auto byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0b, 0x0405060700010203);
+    // The instructions keep the state as the words ABEF and CDGH.
+    auto dcba = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(state)), 0xB1);
+    auto hgfe = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(state + 4)), 0x1B);
+    auto abef = _mm_alignr_epi8(dcba, hgfe, 8);
+    auto cdgh = _mm_blend_epi16(hgfe, dcba, 0xF0);
+
+    for (; blocks > 0; blocks--, bytes += 64) {
+        auto abefBefore = abef;
+        auto cdghBefore = cdgh;
+        __m128i words[4];
+        for (int group = 0; group < 16; group++) {
+            auto &current = words[group % 4];
+            if (group < 4) {
+                current = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + group * 16)),
+                                           byteSwap);
+            }
+            auto constants = _mm_loadu_si128(reinterpret_cast<const __m128i *>(kSha256RoundConstants + group * 4));
+            auto message = _mm_add_epi32(current, constants);
+            cdgh = _mm_sha256rnds2_epu32(cdgh, abef, message);
+            if (group >= 3 && group <= 14) {
+                auto &next = words[(group + 1) % 4];
+                next = _mm_add_epi32(next, _mm_alignr_epi8(current, words[(group + 3) % 4], 4));
+                next = _mm_sha256msg2_epu32(next, current);
+            }
+            abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(message, 0x0E));
+            if (group >= 1 && group <= 12) {
+                auto &previous = words[(group + 3) % 4];
+                previous = _mm_sha256msg1_epu32(previous, current);
+            }
+        }
+        abef = _mm_add_epi32(abef, abefBefore);
+        cdgh = _mm_add_epi32(cdgh, cdghBefore);
+    }
+
+    auto feba = _mm_shuffle_epi32(abef, 0x1B);
+    auto dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(state), _mm_blend_epi16(feba, dchg, 0xF0));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(state + 4), _mm_alignr_epi8(dchg, feba, 8));
+}
+
+#endif
+
+void sha256Blocks(uint32_t *state, const uint8_t *bytes, size_t blocks) {
+#if defined(EJC_HASH_X86)
+    if (cpuFeatures().sha) {
+        sha256BlocksHardware(state, bytes, blocks);
+        return;
+    }
+#endif
+    sha256BlocksSoftware(state, bytes, blocks);
+}
+
+/// The state of a CRC32C checksum.
+class Crc32cState {
+public:
+    void update(const void *bytes, size_t count) {
+        crc_ = crc32c(crc_, static_cast<const uint8_t *>(bytes), count);
+    }
+
+    uint32_t value() const { return ~crc_; }
+
+private:
+    uint32_t crc_ = 0xFFFFFFFF;
+};
+
+/// The state of an XXH64 hash. Input is consumed in stripes of 32 bytes; a partial stripe is kept in `buffer_`.
+class XxHash64State {
+public:
+    explicit XxHash64State(uint64_t seed) : seed_(seed) {
+        accumulators_[0] = seed + kXxPrime1 + kXxPrime2;
+        accumulators_[1] = seed + kXxPrime2;
+        accumulators_[2] = seed;
+        accumulators_[3] = seed - kXxPrime1;
+    }
+
+    void update(const void *data, size_t count) {
+        auto bytes = static_cast<const uint8_t *>(data);
+        total_ += count;
+        if (buffered_ + count < sizeof(buffer_)) {
+            std::memcpy(buffer_ + buffered_, bytes, count);
+            buffered_ += count;
+            return;
+        }
+        if (buffered_ > 0) {
+            auto fill = sizeof(buffer_) - buffered_;
+            std::memcpy(buffer_ + buffered_, bytes, fill);
+            consume(buffer_);
+            bytes += fill;
+            count -= fill;
+            buffered_ = 0;
+        }
+        for (; count >= sizeof(buffer_); bytes += sizeof(buffer_), count -= sizeof(buffer_)) {
+            consume(bytes);
+        }
+        std::memcpy(buffer_, bytes, count);
+        buffered_ = count;
+    }
+
+    uint64_t value() const {
+        uint64_t hash;
+        if (total_ >= sizeof(buffer_)) {
+            auto &a = accumulators_;
+            hash = rotate(a[0], 1) + rotate(a[1], 7) + rotate(a[2], 12) + rotate(a[3], 18);
+            for (auto accumulator : a) {
+                hash = xxMerge(hash, accumulator);
+            }
+        }
+        else {
+            hash = seed_ + kXxPrime5;
+        }
+        hash += total_;
+        auto bytes = buffer_;
+        auto count = buffered_;
+        for (; count >= 8; bytes += 8, count -= 8) {
+            hash = rotate(hash ^ xxRound(0, read64(bytes)), 27) * kXxPrime1 + kXxPrime4;
+        }
+        if (count >= 4) {
+            hash = rotate(hash ^ read32(bytes) * kXxPrime1, 23) * kXxPrime2 + kXxPrime3;
+            bytes += 4;
+            count -= 4;
+        }
+        for (; count > 0; bytes++, count--) {
+            hash = rotate(hash ^ *bytes * kXxPrime5, 11) * kXxPrime1;
+        }
+        hash ^= hash >> 33;
+        hash *= kXxPrime2;
+        hash ^= hash >> 29;
+        hash *= kXxPrime3;
+        return hash ^ (hash >> 32);
+    }
+
+private:
+    void consume(const uint8_t *stripe) {
+        for (int i = 0; i < 4; i++) {
+            accumulators_[i] = xxRound(accumulators_[i], read64(stripe + i * 8));
+        }
+    }
+
+    uint64_t seed_;
+    uint64_t accumulators_[4];
+    uint64_t total_ = 0;
+    uint8_t buffer_[32];
+    size_t buffered_ = 0;
+};
+
+/// The state of a SHA-256 hash. A partial block is kept in `buffer_`.
+class Sha256State {
+public:
+    static constexpr size_t kDigestSize = 32;
+
+    void update(const void *data, size_t count) {
+        auto bytes = static_cast<const uint8_t *>(data);
+        total_ += count;
+        if (buffered_ > 0) {
+            auto fill = std::min(count, sizeof(buffer_) - buffered_);
+            std::memcpy(buffer_ + buffered_, bytes, fill);
+            buffered_ += fill;
+            bytes += fill;
+            count -= fill;
+            if (buffered_ < sizeof(buffer_)) {
+                return;
+            }
+            sha256Blocks(state_, buffer_, 1);
+            buffered_ = 0;
+        }
+        sha256Blocks(state_, bytes, count / sizeof(buffer_));
+        bytes += count / sizeof(buffer_) * sizeof(buffer_);
+        buffered_ = count % sizeof(buffer_);
+        std::memcpy(buffer_, bytes, buffered_);
+    }
+
+    /// Writes the digest of the bytes added so far to `digest`. The state is not changed, so that more bytes can be
+    /// added afterwards.
+    void digest(uint8_t *digest) const {
+        uint32_t state[8];
+        std::memcpy(state, state_, sizeof(state));
+        uint8_t padding[128] = {};
+        std::memcpy(padding, buffer_, buffered_);
+        padding[buffered_] = 0x80;
+        auto blocks = buffered_ + 9 <= sizeof(buffer_) ? 1 : 2;
+        auto bits = total_ * 8;
+        for (int i = 0; i < 8; i++) {
+            padding[blocks * 64 - 1 - i] = static_cast<uint8_t>(bits >> (i * 8));
+        }
+        sha256Blocks(state, padding, blocks);
+        for (int i = 0; i < 8; i++) {
+            for (int j = 0; j < 4; j++) {
+                digest[i * 4 + j] = static_cast<uint8_t>(state[i] >> (24 - j * 8));
+            }
+        }
+    }
+
+private:
+    uint32_t state_[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+    uint64_t total_ = 0;
+    uint8_t buffer_[64];
+    size_t buffered_ = 0;
+};
+
+Data* sha256Digest(const Sha256State &sha256) {
+    auto data = Data::init();
+    data->count = Sha256State::kDigestSize;
+    data->data = runtime::allocate<runtime::Byte>(Sha256State::kDigestSize);
+    sha256.digest(reinterpret_cast<uint8_t *>(data->bytes()));
+    return data;
+}
+
+}  // namespace
+
+/// 🧿, a CRC32C checksum that is computed while bytes are added.
+class Crc32c : public runtime::Object<Crc32c> {
+public:
+    Crc32cState state;
+};
+
+/// 🥣, an XXH64 hash that is computed while bytes are added.
+class XxHash64 : public runtime::Object<XxHash64> {
+public:
+    explicit XxHash64(uint64_t seed) : state(seed) {}
+
+    XxHash64State state;
+};
+
+/// 🗝, a SHA-256 hash that is computed while bytes are added.
+class Sha256 : public runtime::Object<Sha256> {
+public:
+    Sha256State state;
+};
+
+extern "C" Crc32c* sCrc32cNew() {
+    return Crc32c::init();
+}
+
+extern "C" void sCrc32cUpdate(Crc32c *crc, Data *data) {
+    crc->state.update(data->bytes(), data->count);
+}
+
+extern "C" void sCrc32cUpdateString(Crc32c *crc, String *string) {
+    crc->state.update(string->bytes(), string->count);
+}
+
+extern "C" runtime::Integer sCrc32cValue(Crc32c *crc) {
+    return crc->state.value();
+}
+
+extern "C" void sCrc32cDestruct(Crc32c *crc) {
+    crc->~Crc32c();
+}
+
+extern "C" XxHash64* sXxHash64New() {
+    return XxHash64::init(0);
+}
+
+extern "C" XxHash64* sXxHash64NewSeeded(runtime::Integer seed) {
+    return XxHash64::init(seed);
+}
+
+extern "C" void sXxHash64Update(XxHash64 *hash, Data *data) {
+    hash->state.update(data->bytes(), data->count);
+}
+
+extern "C" void sXxHash64UpdateString(XxHash64 *hash, String *string) {
+    hash->state.update(string->bytes(), string->count);
+}
+
+extern "C" runtime::Integer sXxHash64Value(XxHash64 *hash) {
+    return static_cast<runtime::Integer>(hash->state.value());
+}
+
+extern "C" void sXxHash64Destruct(XxHash64 *hash) {
+    hash->~XxHash64();
+}
+
+extern "C" Sha256* sSha256New() {
+    return Sha256::init();
+}
+
+extern "C" void sSha256Update(Sha256 *sha256, Data *data) {
+    sha256->state.update(data->bytes(), data->count);
+}
+
+extern "C" void sSha256UpdateString(Sha256 *sha256, String *string) {
+    sha256->state.update(string->bytes(), string->count);
+}
+
+extern "C" Data* sSha256Digest(Sha256 *sha256) {
+    return sha256Digest(sha256->state);
+}
+
+extern "C" void sSha256Destruct(Sha256 *sha256) {
+    sha256->~Sha256();
+}
+
+extern "C" runtime::Integer sDataCrc32c(Data *data) {
+    return ~crc32c(0xFFFFFFFF, reinterpret_cast<const uint8_t *>(data->bytes()), data->count);
+}
+
+extern "C" runtime::Integer sStringCrc32c(String *string) {
+    return ~crc32c(0xFFFFFFFF, reinterpret_cast<const uint8_t *>(string->bytes()), string->count);
+}
+
+extern "C" runtime::Integer sDataXxHash64(Data *data) {
+    XxHash64State hash(0);
+    hash.update(data->bytes(), data->count);
+    return static_cast<runtime::Integer>(hash.value());
+}
+
+extern "C" runtime::Integer sStringXxHash64(String *string) {
+    XxHash64State hash(0);
+    hash.update(string->bytes(), string->count);
+    return static_cast<runtime::Integer>(hash.value());
+}
+
+extern "C" Data* sDataSha256(Data *data) {
+    Sha256State sha256;
+    sha256.update(data->bytes(), data->count);
+    return sha256Digest(sha256);
+}
+
+extern "C" Data* sStringSha256(String *string) {
+    Sha256State sha256;
+    sha256.update(string->bytes(), string->count);
+    return sha256Digest(sha256);
+}
+
+}  // namespace s
+
+SET_INFO_FOR(s::Crc32c, s, 1f9ff)
+SET_INFO_FOR(s::XxHash64, s, 1f963)
+SET_INFO_FOR(s::Sha256, s, 1f5dd)
@@ -7,78 +7,42 @@
 //
 
 #include "../runtime/Runtime.h"
+#include "Format.h"
 #include "String.h"
-#include <cstdint>
 #include <cstdlib>
-#include <cmath>
 
 using s::String;
 
-extern "C" runtime::Integer sIntAbsolute(runtime::Integer *integer) {
-    return std::abs(*integer);
+extern "C" runtime::Integer sIntAbsolute(runtime::Integer integer) {
+    return std::abs(integer);
 }
 
 extern "C" s::String* sIntToString(runtime::Integer *nptr, runtime::Integer base) {
-    auto n = *nptr;
-    auto a = std::abs(n);
-    bool negative = n < 0;
-
-    unsigned int d = negative ? 2 : 1;
-    while ((n /= base) != 0) {
-        d++;
-    }
-
-    auto string = String::init();
-    string->count = d;
-    string->characters = runtime::allocate<char>(d);
-
-    auto *characters = string->characters.get() + d;
-    do {
-        *--characters =  "0123456789abcdefghijklmnopqrstuvxyz"[a % base % 35];
-    } while ((a /= base) > 0);
+    char buffer[s::kMaxIntegerLength];
+    return String::copy(buffer, s::formatInteger(buffer, *nptr, base));
+}
 
-    if (negative) {
-        characters[-1] = '-';
-    }
-    return string;
+extern "C" runtime::Integer sIntFormat(runtime::Integer *nptr, runtime::MemoryPointer<char> destination,
+                                       runtime::Integer offset) {
+    return s::formatInteger(destination.get() + offset, *nptr, 10);
 }
 
 extern "C" s::String* sRealToString(runtime::Real *real, runtime::Integer precision) {
-    double integral;
-    double fractional = std::modf(*real, &integral);
-
-    if (precision <= 0) {
-        runtime::Integer i = static_cast<runtime::Integer>(integral);
-        return sIntToString(&i, 10);
-    }
-
-    auto a = std::abs(static_cast<long long>(integral));
-    bool negative = *real < 0;
-
-    unsigned int d = (negative ? 3 : 2) + precision;
-    auto ac = a;
-    while ((ac /= 10) != 0) {
-        d++;
-    }
-
+    auto count = s::formatReal(nullptr, *real, precision);
     auto string = String::init();
-    string->count = d;
-    string->characters = runtime::allocate<char>(d);
-
-    auto *characters = string->characters.get() + d;
-
-    auto f = static_cast<long long>(std::abs(std::pow(10, precision) * fractional));
-    for (decltype(precision) i = 0; i < precision; i++) {
-        *--characters = "0123456789"[f % 10];
-        f /= 10;
-    }
-    *--characters = '.';
-    do {
-        *--characters = "0123456789"[a % 10];
-    } while ((a /= 10) > 0);
-    if (negative) {
-        characters[-1] = '-';
-    }
+    string->count = count;
+    string->characters = runtime::allocate<char>(count);
+    string->ascii.store(String::AsciiState::Ascii, std::memory_order_relaxed);
+    s::formatReal(string->characters.get(), *real, precision);
     return string;
 }
 
+extern "C" s::String* sRealToShortestString(runtime::Real *real) {
+    char buffer[s::kMaxShortestRealLength];
+    return String::copy(buffer, s::formatShortestReal(buffer, *real));
+}
+
+extern "C" runtime::Integer sRealFormatShortest(runtime::Real *real, runtime::MemoryPointer<char> destination,
+                                                runtime::Integer offset) {
+    return s::formatShortestReal(destination.get() + offset, *real);
+}
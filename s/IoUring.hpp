@@ -0,0 +1,151 @@
+//
+// Created by Theo Weidmann on 14.10.26.
+//
+
+#ifndef EMOJICODE_IOURING_HPP
+#define EMOJICODE_IOURING_HPP
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace s {
+
+/// A minimal io_uring submission and completion queue pair, which is used directly through the system calls as
+/// liburing is not a dependency of Emojicode.
+///
+/// Submission queue entries are collected with prepare() and submitted together by the next call to submit(), so that
+/// any number of them costs a single system call. The queues are not synchronized, callers must serialize calls to
+/// prepare() and submit() and calls to reap().
+class IoUring {
+public:
+    /// Sets up a ring with space for *entries* submissions. Returns false if io_uring is not available, e.g. because
+    /// the kernel is too old to support waiting with a timeout or a seccomp filter forbids it.
+    bool init(unsigned entries) {
+        io_uring_params params{};
+        fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd_ < 0) {
+            return false;
+        }
+        if ((params.features & IORING_FEAT_EXT_ARG) == 0 || (params.features & IORING_FEAT_SINGLE_MMAP) == 0) {
+            close(fd_);
+            fd_ = -1;
+            return false;
+        }
+        ringSize_ = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                             params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+        ring_ = mmap(nullptr, ringSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+        sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe *>(mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE,
+                                                 MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES));
+        if (ring_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+            close(fd_);
+            fd_ = -1;
+            return false;
+        }
+        auto base = static_cast<char *>(ring_);
+        sqHead_ = reinterpret_cast<unsigned *>(base + params.sq_off.head);
+        sqTail_ = reinterpret_cast<unsigned *>(base + params.sq_off.tail);
+        sqMask_ = *reinterpret_cast<unsigned *>(base + params.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned *>(base + params.sq_off.array);
+        sqEntries_ = params.sq_entries;
+        cqHead_ = reinterpret_cast<unsigned *>(base + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned *>(base + params.cq_off.tail);
+        cqMask_ = *reinterpret_cast<unsigned *>(base + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe *>(base + params.cq_off.cqes);
+        return true;
+    }
+
+    ~IoUring() {
+        if (fd_ >= 0) {
+            munmap(sqes_, sqesSize_);
+            munmap(ring_, ringSize_);
+            close(fd_);
+        }
+    }
+
+    /// Returns a cleared submission queue entry that is submitted by the next call to submit(). If the submission
+    /// queue is full, the pending entries are submitted first.
+    io_uring_sqe* prepare() {
+        auto tail = *sqTail_;
+        if (tail - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) >= sqEntries_) {
+            submit();
+            tail = *sqTail_;
+        }
+        auto index = tail & sqMask_;
+        auto sqe = &sqes_[index];
+        std::memset(sqe, 0, sizeof(io_uring_sqe));
+        sqArray_[index] = index;
+        __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+        pending_++;
+        return sqe;
+    }
+
+    /// Submits all prepared entries. Returns the number of submitted entries or -1 on error.
+    int submit() {
+        auto submitted = pending_;
+        pending_ = 0;
+        return enter(submitted, 0, 0, nullptr, _NSIG / 8);
+    }
+
+    /// Waits until a completion is available or *timeout* milliseconds have passed. A negative *timeout* waits
+    /// indefinitely. Does not submit entries and can therefore be called while another thread prepares and submits.
+    int wait(int timeout) {
+        if (timeout < 0) {
+            return enter(0, 1, IORING_ENTER_GETEVENTS, nullptr, _NSIG / 8);
+        }
+        __kernel_timespec timespec{timeout / 1000, (timeout % 1000) * 1000000};
+        io_uring_getevents_arg arg{};
+        arg.sigmask_sz = _NSIG / 8;
+        arg.ts = reinterpret_cast<uint64_t>(&timespec);
+        auto result = enter(0, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+        return result < 0 && errno == ETIME ? 0 : result;
+    }
+
+    /// Calls *handler* with every available completion queue entry.
+    template <typename Handler>
+    void reap(Handler handler) {
+        auto head = *cqHead_;
+        auto tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++) {
+            handler(cqes_[head & cqMask_]);
+        }
+        __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+    }
+
+private:
+    int enter(unsigned toSubmit, unsigned minComplete, unsigned flags, const void *arg, size_t argSize) {
+        return static_cast<int>(syscall(__NR_io_uring_enter, fd_, toSubmit, minComplete, flags, arg, argSize));
+    }
+
+    int fd_ = -1;
+    void *ring_ = nullptr;
+    size_t ringSize_ = 0;
+    io_uring_sqe *sqes_ = nullptr;
+    size_t sqesSize_ = 0;
+    unsigned *sqHead_ = nullptr;
+    unsigned *sqTail_ = nullptr;
+    unsigned *sqArray_ = nullptr;
+    unsigned sqMask_ = 0;
+    unsigned sqEntries_ = 0;
+    unsigned *cqHead_ = nullptr;
+    unsigned *cqTail_ = nullptr;
+    unsigned cqMask_ = 0;
+    io_uring_cqe *cqes_ = nullptr;
+    unsigned pending_ = 0;
+};
+
+}  // namespace s
+
+#endif
+
+#endif //EMOJICODE_IOURING_HPP
@@ -0,0 +1,172 @@
+//
+// Created by Theo Weidmann on 14.10.26.
+//
+
+#include "../runtime/Runtime.h"
+#include "String.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// The box infos the compiler emits for 🔢, 💯 and objects. Their names are not valid C++ identifiers.
+extern "C" const char sIntegerBoxInfo asm("s.vt_1f522.boxInfo");
+extern "C" const char sRealBoxInfo asm("s.vt_1f4af.boxInfo");
+extern "C" const char sObjectBoxInfo asm("class.boxInfo");
+
+namespace s {
+
+namespace {
+
+/// The layout in which 🍨 stores its elements, as the type of the elements is not known to the list.
+struct Box {
+    const void *boxInfo;
+    union {
+        runtime::Integer integer;
+        runtime::Real real;
+        String *string;
+    };
+    char padding[EJC_BOX_SIZE - sizeof(runtime::Integer)];
+};
+
+/// The backing store of a list (🍧).
+class ListStorage : public runtime::Object<ListStorage> {
+public:
+    runtime::MemoryPointer<Box> data;
+    runtime::Integer count;
+    runtime::Integer size;
+};
+
+/// Sorts the payloads of the boxes on their own, so that the comparisons work on contiguous memory, and writes
+/// the sorted payloads back. All boxes must have the same box info.
+template <typename T, typename Get, typename Set, typename Less>
+void sortPayloads(Box *boxes, runtime::Integer count, Get get, Set set, Less less) {
+    std::vector<T> payloads;
+    payloads.reserve(count);
+    for (runtime::Integer i = 0; i < count; i++) {
+        payloads.emplace_back(get(boxes[i]));
+    }
+    std::sort(payloads.begin(), payloads.end(), less);
+    for (runtime::Integer i = 0; i < count; i++) {
+        set(boxes[i], payloads[i]);
+    }
+}
+
+/// Orders reals like 🐈, which places NaN after all other numbers so that the ordering remains strict weak.
+bool lessReal(runtime::Real a, runtime::Real b) {
+    return a < b || (!std::isnan(a) && std::isnan(b));
+}
+
+bool isString(const Box &box) {
+    return box.string->classInfo() == runtime::ClassInfoFor<String>::value;
+}
+
+/// Compares boxes by the ordering of 🐈. All boxes must have the box info of the box the instance was created
+/// with, otherwise `failed` is set.
+struct NaturalLess {
+    explicit NaturalLess(const Box &box) : boxInfo(box.boxInfo) {}
+
+    bool operator()(const Box &a, const Box &b) {
+        if (a.boxInfo != boxInfo || b.boxInfo != boxInfo) {
+            failed = true;
+            return false;
+        }
+        if (boxInfo == &sIntegerBoxInfo) {
+            return a.integer < b.integer;
+        }
+        if (boxInfo == &sRealBoxInfo) {
+            return lessReal(a.real, b.real);
+        }
+        if (boxInfo == &sObjectBoxInfo && isString(a) && isString(b)) {
+            return a.string->compare(b.string) < 0;
+        }
+        failed = true;
+        return false;
+    }
+
+    const void *boxInfo;
+    bool failed = false;
+};
+
+}  // namespace
+
+extern "C" runtime::Integer sListCompareNatively(ListStorage *storage, runtime::Integer a, runtime::Integer b) {
+    auto boxes = storage->data.get();
+    NaturalLess less(boxes[a]);
+    auto result = less(boxes[a], boxes[b]);
+    return less.failed ? -1 : result;
+}
+
+extern "C" runtime::Boolean sListSiftUpNatively(ListStorage *storage, runtime::Integer index) {
+    auto boxes = storage->data.get();
+    NaturalLess less(boxes[index]);
+    while (index > 0) {
+        auto parent = (index - 1) / 2;
+        if (!less(boxes[index], boxes[parent])) {
+            break;
+        }
+        std::swap(boxes[index], boxes[parent]);
+        index = parent;
+    }
+    return !less.failed;
+}
+
+extern "C" runtime::Boolean sListSiftDownNatively(ListStorage *storage, runtime::Integer index,
+                                                  runtime::Integer count) {
+    auto boxes = storage->data.get();
+    NaturalLess less(boxes[index]);
+    while (!less.failed) {
+        auto child = 2 * index + 1;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1 < count && less(boxes[child + 1], boxes[child])) {
+            child++;
+        }
+        if (!less(boxes[child], boxes[index])) {
+            break;
+        }
+        std::swap(boxes[index], boxes[child]);
+        index = child;
+    }
+    return !less.failed;
+}
+
+extern "C" runtime::Boolean sListSortNatively(ListStorage *storage) {
+    auto boxes = storage->data.get();
+    auto count = storage->count;
+    if (count < 2) {
+        return true;
+    }
+    auto boxInfo = boxes[0].boxInfo;
+    for (runtime::Integer i = 1; i < count; i++) {
+        if (boxes[i].boxInfo != boxInfo) {
+            return false;
+        }
+    }
+
+    if (boxInfo == &sIntegerBoxInfo) {
+        sortPayloads<runtime::Integer>(boxes, count, [](const Box &box) { return box.integer; },
+                                       [](Box &box, runtime::Integer value) { box.integer = value; },
+                                       std::less<runtime::Integer>());
+        return true;
+    }
+    if (boxInfo == &sRealBoxInfo) {
+        sortPayloads<runtime::Real>(boxes, count, [](const Box &box) { return box.real; },
+                                    [](Box &box, runtime::Real value) { box.real = value; }, lessReal);
+        return true;
+    }
+    if (boxInfo == &sObjectBoxInfo) {
+        for (runtime::Integer i = 0; i < count; i++) {
+            if (!isString(boxes[i])) {
+                return false;
+            }
+        }
+        sortPayloads<String *>(boxes, count, [](const Box &box) { return box.string; },
+                               [](Box &box, String *value) { box.string = value; },
+                               [](String *a, String *b) { return a->compare(b) < 0; });
+        return true;
+    }
+    return false;
+}
+
+}  // namespace s
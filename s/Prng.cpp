@@ -3,25 +3,137 @@
 //
 
 #include "../runtime/Runtime.h"
+#include "../runtime/Internal.hpp"
+#include <memory>
 #include <random>
 
 namespace s {
 
+/// Returns the next value of the SplitMix64 sequence, which is used to expand a seed into the state of Xoshiro256.
+inline uint64_t splitMix64(uint64_t &state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+/// The xoshiro256** generator by Blackman and Vigna, which has a state of 32 bytes and is much faster to create
+/// and step than the Mersenne Twister. Satisfies UniformRandomBitGenerator.
+class Xoshiro256 {
+public:
+    using result_type = uint64_t;
+
+    explicit Xoshiro256(uint64_t seed) {
+        for (auto &word : state_) {
+            word = splitMix64(seed);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+
+    result_type operator()() {
+        auto result = rotate(state_[1] * 5, 7) * 9;
+        auto t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = rotate(state_[3], 45);
+        return result;
+    }
+
+private:
+    static uint64_t rotate(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    uint64_t state_[4];
+};
+
 class PRNG : public runtime::Object<PRNG> {
 public:
-    std::mt19937_64 prng = std::mt19937_64(std::random_device()());
+    explicit PRNG(uint64_t seed) : xoshiro(seed) {}
+
+    /// The Mersenne Twister, which is only allocated for generators created with 🆕. All other generators use
+    /// `xoshiro`.
+    std::unique_ptr<std::mt19937_64> mersenne;
+    Xoshiro256 xoshiro;
+
+    /// Calls `function` with the engine of this generator and returns its result.
+    template <typename Function>
+    auto generate(Function function) {
+        return mersenne ? function(*mersenne) : function(xoshiro);
+    }
 };
 
+namespace {
+
+/// Returns a seed of 64 bits from `std::random_device`, which yields only 32 bits per call.
+uint64_t randomSeed() {
+    std::random_device device;
+    return (static_cast<uint64_t>(device()) << 32) ^ device();
+}
+
+}  // namespace
+
 extern "C" PRNG* sPrngNew() {
-    return PRNG::init();
+    auto prng = PRNG::init(0);
+    prng->mersenne = std::make_unique<std::mt19937_64>(std::random_device()());
+    return prng;
+}
+
+extern "C" PRNG* sPrngNewFast() {
+    return PRNG::init(randomSeed());
+}
+
+extern "C" PRNG* sPrngNewSeeded(runtime::Integer seed) {
+    return PRNG::init(static_cast<uint64_t>(seed));
+}
+
+extern "C" PRNG* sPrngThread(runtime::ClassInfo *) {
+    static const size_t key = runtime::internal::newThreadLocalKey();
+    auto &slot = runtime::internal::threadLocal(key);
+    if (slot == nullptr) {
+        slot = reinterpret_cast<runtime::Object<void> *>(PRNG::init(randomSeed()));
+    }
+    slot->retain();
+    return reinterpret_cast<PRNG *>(slot);
 }
 
 extern "C" runtime::Integer sPrngGetInteger(PRNG *prng, runtime::Integer from, runtime::Integer to) {
-    return std::uniform_int_distribution<runtime::Integer>(from, to)(prng->prng);
+    std::uniform_int_distribution<runtime::Integer> distribution(from, to);
+    return prng->generate([&](auto &engine) { return distribution(engine); });
 }
 
 extern "C" runtime::Real sPrngGetReal(PRNG *prng) {
-    return std::uniform_real_distribution<runtime::Real>()(prng->prng);
+    std::uniform_real_distribution<runtime::Real> distribution;
+    return prng->generate([&](auto &engine) { return distribution(engine); });
+}
+
+extern "C" void sPrngFillIntegers(PRNG *prng, runtime::MemoryPointer<int8_t> destination, runtime::Integer offset,
+                                  runtime::Integer count, runtime::Integer from, runtime::Integer to) {
+    auto integers = reinterpret_cast<runtime::Integer *>(destination.get() + offset);
+    std::uniform_int_distribution<runtime::Integer> distribution(from, to);
+    prng->generate([&](auto &engine) {
+        for (runtime::Integer i = 0; i < count; i++) {
+            integers[i] = distribution(engine);
+        }
+        return 0;
+    });
+}
+
+extern "C" void sPrngFillReals(PRNG *prng, runtime::MemoryPointer<int8_t> destination, runtime::Integer offset,
+                               runtime::Integer count) {
+    auto reals = reinterpret_cast<runtime::Real *>(destination.get() + offset);
+    std::uniform_real_distribution<runtime::Real> distribution;
+    prng->generate([&](auto &engine) {
+        for (runtime::Integer i = 0; i < count; i++) {
+            reals[i] = distribution(engine);
+        }
+        return 0;
+    });
 }
 
 extern "C" void sPrngDestruct(PRNG *prng) {
@@ -0,0 +1,96 @@
+//
+// Created by Theo Weidmann on 14.10.26.
+//
+
+#include "Search.h"
+#include "../runtime/Runtime.h"
+#include <cstdint>
+#include <cstring>
+
+namespace s {
+
+namespace {
+
+constexpr uint64_t kOnes = 0x0101010101010101ull;
+constexpr uint64_t kLowBits = 0x7f7f7f7f7f7f7f7full;
+constexpr uint64_t kHighBits = 0x8080808080808080ull;
+
+/// Needles longer than this are searched for with findLong().
+constexpr size_t kShortNeedleLength = 32;
+
+uint64_t load(const char *p) {
+    uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+    return word;
+}
+
+/// Returns a word in which exactly the high bits of the bytes that are zero in `word` are set.
+uint64_t zeroBytes(uint64_t word) {
+    return ~(((word & kLowBits) + kLowBits) | word | kLowBits);
+}
+
+EJC_MULTIVERSIONED const char* findShort(const char *haystack, size_t haystackLength, const char *needle, size_t needleLength) {
+    auto first = kOnes * static_cast<uint8_t>(needle[0]);
+    auto last = kOnes * static_cast<uint8_t>(needle[needleLength - 1]);
+    auto lastPosition = haystackLength - needleLength;
+
+    size_t i = 0;
+    for (; i + 8 <= lastPosition + 1; i += 8) {
+        auto candidates = zeroBytes(load(haystack + i) ^ first) &
+                          zeroBytes(load(haystack + i + needleLength - 1) ^ last);
+        while (candidates != 0) {
+            // Words are loaded in little endian order, so the lowest set bit is the first candidate.
+            auto position = i + (__builtin_ctzll(candidates) / 8);
+            if (std::memcmp(haystack + position + 1, needle + 1, needleLength - 2) == 0) {
+                return haystack + position;
+            }
+            candidates &= candidates - 1;
+        }
+    }
+    for (; i <= lastPosition; i++) {
+        if (haystack[i] == needle[0] && std::memcmp(haystack + i + 1, needle + 1, needleLength - 1) == 0) {
+            return haystack + i;
+        }
+    }
+    return nullptr;
+}
+
+const char* findLong(const char *haystack, size_t haystackLength, const char *needle, size_t needleLength) {
+    size_t skip[256];
+    for (auto &s : skip) {
+        s = needleLength;
+    }
+    for (size_t i = 0; i < needleLength - 1; i++) {
+        skip[static_cast<uint8_t>(needle[i])] = needleLength - 1 - i;
+    }
+
+    auto lastByte = needle[needleLength - 1];
+    for (size_t i = 0; i <= haystackLength - needleLength;) {
+        auto end = haystack[i + needleLength - 1];
+        if (end == lastByte && std::memcmp(haystack + i, needle, needleLength - 1) == 0) {
+            return haystack + i;
+        }
+        i += skip[static_cast<uint8_t>(end)];
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+const char* findBytes(const char *haystack, size_t haystackLength, const char *needle, size_t needleLength) {
+    if (needleLength == 0) {
+        return haystack;
+    }
+    if (needleLength > haystackLength) {
+        return nullptr;
+    }
+    if (needleLength == 1) {
+        return static_cast<const char *>(std::memchr(haystack, needle[0], haystackLength));
+    }
+    if (needleLength <= kShortNeedleLength) {
+        return findShort(haystack, haystackLength, needle, needleLength);
+    }
+    return findLong(haystack, haystackLength, needle, needleLength);
+}
+
+}  // namespace s
@@ -0,0 +1,22 @@
+//
+// Created by Theo Weidmann on 14.10.26.
+//
+
+#ifndef EMOJICODE_SEARCH_HPP
+#define EMOJICODE_SEARCH_HPP
+
+#include <cstddef>
+
+namespace s {
+
+/// Returns a pointer to the first occurrence of the `needleLength` bytes at `needle` in the `haystackLength` bytes at
+/// `haystack` or nullptr if there is no occurrence. An empty needle is found at the beginning of the haystack.
+///
+/// Short needles are found by comparing the first and the last byte of the needle with eight positions of the haystack
+/// at once and only comparing the remaining bytes at positions where both match. Longer needles are found with the
+/// Boyer-Moore-Horspool algorithm.
+const char* findBytes(const char *haystack, size_t haystackLength, const char *needle, size_t needleLength);
+
+}  // namespace s
+
+#endif //EMOJICODE_SEARCH_HPP
@@ -0,0 +1,444 @@
+//
+//  SharedRing.cpp
+//  EmojicodeCompiler
+//
+
+#include "../runtime/Runtime.h"
+#include "Data.h"
+#include "Error.h"
+#include "String.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+namespace s {
+
+namespace {
+
+constexpr size_t kCacheLine = 64;
+constexpr uint64_t kMagic = 0x676e6972f09f928dULL;
+
+/// The start of the shared memory of a 💍. The positions and the words threads wait on each occupy a cache line of
+/// their own, so that senders and receivers do not contend for the same line.
+struct RingHeader {
+    std::atomic<uint64_t> magic;
+    uint64_t capacity;
+    uint64_t messageSize;
+    uint64_t slotSize;
+    /// Whether several processes or threads may send or receive at the same time, in which case the positions are
+    /// advanced with compare-and-swap.
+    uint64_t concurrent;
+    alignas(kCacheLine) std::atomic<uint64_t> sendPosition;
+    alignas(kCacheLine) std::atomic<uint64_t> receivePosition;
+    /// Incremented whenever a message was sent. Receivers wait on this word while the ring is empty.
+    alignas(kCacheLine) std::atomic<uint32_t> sent;
+    std::atomic<uint32_t> waitingReceivers;
+    /// Incremented whenever a slot was released. Senders wait on this word while the ring is full.
+    alignas(kCacheLine) std::atomic<uint32_t> released;
+    std::atomic<uint32_t> waitingSenders;
+};
+
+/// A slot of the ring, which is followed by *messageSize* bytes and padded to a multiple of the cache line size.
+struct alignas(kCacheLine) RingSlot {
+    /// As in 📨, a slot at position p can be written if its sequence is p and read if its sequence is p + 1.
+    std::atomic<uint64_t> sequence;
+    uint64_t length;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "Atomics in shared memory must be lock free to be usable from several processes");
+
+constexpr size_t kSlotsOffset = (sizeof(RingHeader) + kCacheLine - 1) / kCacheLine * kCacheLine;
+/// The start of a view that was passed to 💍✅. Views of messages start after a slot header and never at 0.
+constexpr runtime::Integer kReleasedView = 0;
+
+/// Waits until *word* no longer has the value *value* or a wake-up was requested. May return spuriously.
+void waitOn(std::atomic<uint32_t> &word, uint32_t value) {
+#ifdef __linux__
+    // The word is in shared memory, so the futex must not be private to this process.
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT, value, nullptr, nullptr, 0);
+#else
+    if (word.load(std::memory_order_acquire) == value) {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+#endif
+}
+
+/// Wakes all threads of all processes waiting on *word*.
+void wakeAll(std::atomic<uint32_t> &word) {
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+}
+
+/// Increments *word* and wakes the threads waiting on it if *waiting* indicates there are any. Waking requires a
+/// system call, which is thus avoided while the other side keeps up.
+void signal(std::atomic<uint32_t> &word, std::atomic<uint32_t> &waiting) {
+    word.fetch_add(1, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting.load(std::memory_order_relaxed) > 0) {
+        wakeAll(word);
+    }
+}
+
+}  // namespace
+
+class SharedRing : public runtime::Object<SharedRing> {
+public:
+    runtime::MemoryPointer<runtime::Byte> memory;
+    int descriptor;
+
+    RingHeader* header() const { return reinterpret_cast<RingHeader *>(memory.get()); }
+
+    RingSlot* slot(uint64_t position) const {
+        auto header = this->header();
+        return reinterpret_cast<RingSlot *>(memory.get() + kSlotsOffset +
+                                            (position & (header->capacity - 1)) * header->slotSize);
+    }
+
+    runtime::Byte* bytes(RingSlot *slot) const { return reinterpret_cast<runtime::Byte *>(slot + 1); }
+
+    /// Claims the slot at the next send position, or returns nullptr if the ring is full.
+    RingSlot* claimSend() const {
+        auto header = this->header();
+        auto position = header->sendPosition.load(std::memory_order_relaxed);
+        while (true) {
+            auto slot = this->slot(position);
+            auto difference = static_cast<int64_t>(slot->sequence.load(std::memory_order_acquire) - position);
+            if (difference == 0) {
+                if (!header->concurrent) {
+                    header->sendPosition.store(position + 1, std::memory_order_relaxed);
+                    return slot;
+                }
+                if (header->sendPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    return slot;
+                }
+            }
+            else if (difference < 0) {
+                return nullptr;
+            }
+            else {
+                position = header->sendPosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Claims the slot at the next receive position, or returns nullptr if the ring is empty.
+    RingSlot* claimReceive() const {
+        auto header = this->header();
+        auto position = header->receivePosition.load(std::memory_order_relaxed);
+        while (true) {
+            auto slot = this->slot(position);
+            auto difference = static_cast<int64_t>(slot->sequence.load(std::memory_order_acquire) - (position + 1));
+            if (difference == 0) {
+                if (!header->concurrent) {
+                    header->receivePosition.store(position + 1, std::memory_order_relaxed);
+                    return slot;
+                }
+                if (header->receivePosition.compare_exchange_weak(position, position + 1,
+                                                                  std::memory_order_relaxed)) {
+                    return slot;
+                }
+            }
+            else if (difference < 0) {
+                return nullptr;
+            }
+            else {
+                position = header->receivePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Copies *message* into *slot*, which was claimed with claimSend(), and makes it available to receivers.
+    void publish(RingSlot *slot, Data *message) const {
+        std::memcpy(bytes(slot), message->bytes(), message->count);
+        slot->length = static_cast<uint64_t>(message->count);
+        slot->sequence.store(slot->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        signal(header()->sent, header()->waitingReceivers);
+    }
+
+    /// Returns a 📇 that refers to the message in *slot*, which was claimed with claimReceive(), without copying it.
+    Data* view(RingSlot *slot) const {
+        auto data = Data::init();
+        data->data = memory;
+        data->start = bytes(slot) - memory.get();
+        data->count = static_cast<runtime::Integer>(slot->length);
+        data->data.retain();
+        return data;
+    }
+};
+
+namespace {
+
+/// Returns the path of the shared memory object named *name*. On Linux, shared memory objects are files in /dev/shm,
+/// which avoids depending on librt for shm_open.
+std::string sharedMemoryPath(String *name) {
+    auto string = name->stdString();
+    if (!string.empty() && string[0] == '/') {
+        string.erase(0, 1);
+    }
+#ifdef __linux__
+    return "/dev/shm/" + string;
+#else
+    return "/" + string;
+#endif
+}
+
+int openShared(const std::string &path, int flags) {
+#ifdef __linux__
+    return open(path.c_str(), flags | O_CLOEXEC | O_NOFOLLOW, 0600);
+#else
+    return shm_open(path.c_str(), flags, 0600);
+#endif
+}
+
+int unlinkShared(const std::string &path) {
+#ifdef __linux__
+    return unlink(path.c_str());
+#else
+    return shm_unlink(path.c_str());
+#endif
+}
+
+uint64_t roundUpToPowerOfTwo(uint64_t value) {
+    uint64_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+/// Sizes *descriptor* for a ring of at least *capacity* messages of *messageSize* bytes, maps it and initializes the
+/// header and the slots. Takes ownership of *descriptor*.
+SharedRing* createRing(int descriptor, runtime::Integer capacity, runtime::Integer messageSize, bool concurrent,
+                       runtime::Raiser *raiser) {
+    if (descriptor == -1) {
+        EJC_RAISE(raiser, IOError::init());
+    }
+    if (capacity < 1 || messageSize < 0 || capacity > (INT64_C(1) << 32)) {
+        close(descriptor);
+        errno = EINVAL;
+        EJC_RAISE(raiser, IOError::init());
+    }
+    auto slots = roundUpToPowerOfTwo(static_cast<uint64_t>(capacity));
+    auto slotSize = (sizeof(RingSlot) + static_cast<uint64_t>(messageSize) + kCacheLine - 1) / kCacheLine * kCacheLine;
+    auto size = static_cast<runtime::Integer>(kSlotsOffset + slots * slotSize);
+
+    runtime::MemoryPointer<runtime::Byte> memory;
+    if (ftruncate(descriptor, size) == -1 || !runtime::mapShared(descriptor, size, &memory)) {
+        close(descriptor);
+        EJC_RAISE(raiser, IOError::init());
+    }
+
+    auto ring = SharedRing::init();
+    ring->memory = memory;
+    ring->descriptor = descriptor;
+    auto header = new(ring->memory.get()) RingHeader;
+    header->capacity = slots;
+    header->messageSize = static_cast<uint64_t>(messageSize);
+    header->slotSize = slotSize;
+    header->concurrent = concurrent;
+    header->sendPosition.store(0, std::memory_order_relaxed);
+    header->receivePosition.store(0, std::memory_order_relaxed);
+    header->sent.store(0, std::memory_order_relaxed);
+    header->waitingReceivers.store(0, std::memory_order_relaxed);
+    header->released.store(0, std::memory_order_relaxed);
+    header->waitingSenders.store(0, std::memory_order_relaxed);
+    for (uint64_t i = 0; i < slots; i++) {
+        new(ring->slot(i)) RingSlot;
+        ring->slot(i)->sequence.store(i, std::memory_order_relaxed);
+    }
+    // Processes that open the ring check the magic number last written here before they use the ring.
+    header->magic.store(kMagic, std::memory_order_release);
+    return ring;
+}
+
+/// Returns true if *header* describes a ring that was completely initialized by createRing() and occupies exactly
+/// *size* bytes. The header comes from another process and is checked before any slot is computed from it.
+bool isValidHeader(const RingHeader *header, uint64_t size) {
+    if (header->magic.load(std::memory_order_acquire) != kMagic) {
+        return false;
+    }
+    auto capacity = header->capacity, slotSize = header->slotSize, messageSize = header->messageSize;
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        return false;
+    }
+    if (slotSize % kCacheLine != 0 || slotSize < sizeof(RingSlot) || messageSize > slotSize - sizeof(RingSlot)) {
+        return false;
+    }
+    return capacity <= (size - kSlotsOffset) / slotSize && kSlotsOffset + capacity * slotSize == size;
+}
+
+/// Maps the ring that was created in *descriptor* by another process. Takes ownership of *descriptor*.
+SharedRing* mapRing(int descriptor, runtime::Raiser *raiser) {
+    if (descriptor == -1) {
+        EJC_RAISE(raiser, IOError::init());
+    }
+    struct stat status{};
+    runtime::MemoryPointer<runtime::Byte> memory;
+    if (fstat(descriptor, &status) == -1 || static_cast<size_t>(status.st_size) < kSlotsOffset ||
+        !runtime::mapShared(descriptor, status.st_size, &memory)) {
+        auto error = status.st_size == 0 ? EINVAL : errno;
+        close(descriptor);
+        errno = error;
+        EJC_RAISE(raiser, IOError::init());
+    }
+    if (!isValidHeader(reinterpret_cast<RingHeader *>(memory.get()), static_cast<uint64_t>(status.st_size))) {
+        memory.release();
+        close(descriptor);
+        errno = EINVAL;
+        EJC_RAISE(raiser, IOError::init());
+    }
+    auto ring = SharedRing::init();
+    ring->memory = memory;
+    ring->descriptor = descriptor;
+    return ring;
+}
+
+}  // namespace
+
+extern "C" SharedRing* sSharedRingNew(String *name, runtime::Integer capacity, runtime::Integer messageSize,
+                                      runtime::Boolean concurrent, runtime::Raiser *raiser) {
+    auto path = sharedMemoryPath(name);
+    // A ring left behind by a process that did not remove it is replaced, processes still using it keep their copy.
+    unlinkShared(path);
+    return createRing(openShared(path, O_RDWR | O_CREAT | O_EXCL), capacity, messageSize, concurrent, raiser);
+}
+
+extern "C" SharedRing* sSharedRingOpen(String *name, runtime::Raiser *raiser) {
+    return mapRing(openShared(sharedMemoryPath(name), O_RDWR), raiser);
+}
+
+extern "C" SharedRing* sSharedRingNewAnonymous(runtime::Integer capacity, runtime::Integer messageSize,
+                                               runtime::Boolean concurrent, runtime::Raiser *raiser) {
+#ifdef __linux__
+    auto descriptor = static_cast<int>(syscall(SYS_memfd_create, "emojicode-ring", 1u /* MFD_CLOEXEC */));
+#else
+    auto path = "/emojicode-ring-" + std::to_string(getpid()) + "-" +
+        std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+    auto descriptor = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    shm_unlink(path.c_str());
+#endif
+    return createRing(descriptor, capacity, messageSize, concurrent, raiser);
+}
+
+extern "C" SharedRing* sSharedRingFromDescriptor(runtime::Integer descriptor, runtime::Raiser *raiser) {
+    return mapRing(fcntl(static_cast<int>(descriptor), F_DUPFD_CLOEXEC, 0), raiser);
+}
+
+extern "C" runtime::Integer sSharedRingDescriptor(SharedRing *ring) {
+    return ring->descriptor;
+}
+
+extern "C" runtime::Integer sSharedRingMessageSize(SharedRing *ring) {
+    return static_cast<runtime::Integer>(ring->header()->messageSize);
+}
+
+extern "C" runtime::Boolean sSharedRingTrySend(SharedRing *ring, Data *message, runtime::Raiser *raiser) {
+    if (static_cast<uint64_t>(message->count) > ring->header()->messageSize) {
+        errno = EMSGSIZE;
+        EJC_RAISE(raiser, IOError::init());
+    }
+    auto slot = ring->claimSend();
+    if (slot == nullptr) {
+        return false;
+    }
+    ring->publish(slot, message);
+    return true;
+}
+
+extern "C" void sSharedRingSend(SharedRing *ring, Data *message, runtime::Raiser *raiser) {
+    auto header = ring->header();
+    if (static_cast<uint64_t>(message->count) > header->messageSize) {
+        errno = EMSGSIZE;
+        EJC_RAISE_VOID(raiser, IOError::init());
+    }
+    while (true) {
+        if (auto slot = ring->claimSend()) {
+            ring->publish(slot, message);
+            return;
+        }
+        auto released = header->released.load(std::memory_order_acquire);
+        header->waitingSenders.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (auto slot = ring->claimSend()) {
+            header->waitingSenders.fetch_sub(1, std::memory_order_relaxed);
+            ring->publish(slot, message);
+            return;
+        }
+        waitOn(header->released, released);
+        header->waitingSenders.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+extern "C" runtime::SimpleOptional<Data *> sSharedRingTryReceive(SharedRing *ring) {
+    if (auto slot = ring->claimReceive()) {
+        return ring->view(slot);
+    }
+    return runtime::NoValue;
+}
+
+extern "C" Data* sSharedRingReceive(SharedRing *ring) {
+    auto header = ring->header();
+    while (true) {
+        if (auto slot = ring->claimReceive()) {
+            return ring->view(slot);
+        }
+        auto sent = header->sent.load(std::memory_order_acquire);
+        header->waitingReceivers.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (auto slot = ring->claimReceive()) {
+            header->waitingReceivers.fetch_sub(1, std::memory_order_relaxed);
+            return ring->view(slot);
+        }
+        waitOn(header->sent, sent);
+        header->waitingReceivers.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+extern "C" void sSharedRingRelease(SharedRing *ring, Data *message) {
+    auto header = ring->header();
+    if (message->data.get() == ring->memory.get() && message->start == kReleasedView) {
+        ejcPanic("📇 passed to 💍✅ was already released.");
+    }
+    auto offset = message->start - static_cast<runtime::Integer>(kSlotsOffset + sizeof(RingSlot));
+    if (message->data.get() != ring->memory.get() || offset < 0 || offset % header->slotSize != 0 ||
+        static_cast<uint64_t>(offset) / header->slotSize >= header->capacity) {
+        ejcPanic("📇 passed to 💍✅ was not received from this 💍.");
+    }
+    auto slot = ring->slot(static_cast<uint64_t>(offset) / header->slotSize);
+    // The slot was read at position sequence - 1 and can be written again at that position plus the capacity.
+    slot->sequence.store(slot->sequence.load(std::memory_order_relaxed) - 1 + header->capacity,
+                         std::memory_order_release);
+    // The slot may already hold another message, which the view must no longer show.
+    message->start = kReleasedView;
+    message->count = 0;
+    signal(header->released, header->waitingSenders);
+}
+
+extern "C" void sSharedRingRemove(runtime::ClassInfo*, String *name, runtime::Raiser *raiser) {
+    EJC_COND_RAISE_IO_VOID(unlinkShared(sharedMemoryPath(name)) == 0, raiser);
+}
+
+extern "C" void sSharedRingDestruct(SharedRing *ring) {
+    // The views of received messages keep the memory mapped.
+    ring->memory.release();
+    close(ring->descriptor);
+    ring->~SharedRing();
+}
+
+}  // namespace s
+
+SET_INFO_FOR(s::SharedRing, s, 1f48d)
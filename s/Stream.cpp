@@ -0,0 +1,198 @@
+//
+// Created by Theo Weidmann on 14.10.26.
+//
+
+#include "Stream.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+namespace s {
+
+InputStream* InputStream::standardInput() {
+    static InputStream *stream = InputStream::initStatic(STDIN_FILENO);
+    return stream;
+}
+
+bool InputStream::fill() {
+    if (exhausted_) {
+        return false;
+    }
+    if (fd_ == STDIN_FILENO && offset_ < 0) {
+        // Like std::cin is tied to std::cout, so that prompts are visible before waiting for input.
+        OutputStream::standardOutput()->flush();
+    }
+
+    auto pending = end_ - begin_;
+    if (capacity_ == 0) {
+        capacity_ = kBufferSize;
+        buffer_ = runtime::allocate<char>(capacity_);
+    }
+    else if (!buffer_.isOnlyReference() || pending == capacity_) {
+        auto capacity = pending == capacity_ ? capacity_ * 2 : capacity_;
+        auto buffer = runtime::allocate<char>(capacity);
+        std::memcpy(buffer.get(), buffer_.get() + begin_, pending);
+        buffer_.release();
+        buffer_ = buffer;
+        capacity_ = capacity;
+    }
+    else if (begin_ > 0) {
+        std::memmove(buffer_.get(), buffer_.get() + begin_, pending);
+    }
+    begin_ = 0;
+    end_ = pending;
+
+    ssize_t n;
+    do {
+        n = offset_ < 0 ? ::read(fd_, buffer_.get() + end_, capacity_ - end_) :
+                          ::pread(fd_, buffer_.get() + end_, capacity_ - end_, offset_);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+        exhausted_ = true;
+        failed_ = n < 0;
+        return false;
+    }
+    if (offset_ >= 0) {
+        offset_ += n;
+    }
+    end_ += n;
+    return true;
+}
+
+runtime::SimpleOptional<String *> InputStream::readUntil(char delimiter) {
+    size_t scanned = 0;
+    const char *newline;
+    while ((newline = static_cast<const char *>(std::memchr(buffer_.get() + begin_ + scanned, delimiter,
+                                                            end_ - begin_ - scanned))) == nullptr) {
+        scanned = end_ - begin_;
+        if (!fill()) {
+            if (begin_ == end_) {
+                return runtime::NoValue;
+            }
+            newline = buffer_.get() + end_;
+            break;
+        }
+    }
+
+    return slice(static_cast<size_t>(newline - (buffer_.get() + begin_)), 1);
+}
+
+runtime::SimpleOptional<String *> InputStream::readRecord(size_t size) {
+    while (end_ - begin_ < size && fill()) {}
+    if (begin_ == end_) {
+        return runtime::NoValue;
+    }
+    return slice(std::min(size, end_ - begin_), 0);
+}
+
+String* InputStream::slice(size_t count, size_t skip) {
+    String *string;
+    if (count <= 1) {
+        string = String::copy(buffer_.get() + begin_, count);
+    }
+    else {
+        string = String::init();
+        string->characters = buffer_;
+        string->start = begin_;
+        string->count = count;
+        buffer_.retain();
+    }
+    begin_ = std::min(end_, begin_ + count + skip);
+    return string;
+}
+
+OutputStream::OutputStream(int fd) : fd_(fd), lineBuffered_(isatty(fd) == 1) {
+    buffer_.reserve(kBufferSize);
+}
+
+OutputStream* OutputStream::standardOutput() {
+    static OutputStream *stream = []() {
+        auto stream = OutputStream::initStatic(STDOUT_FILENO);
+        std::atexit([]() { standardOutput()->flush(); });
+        return stream;
+    }();
+    return stream;
+}
+
+void OutputStream::write(const char *bytes, size_t count) {
+    if (buffer_.size() + count > kBufferSize) {
+        flush();
+        if (count >= kBufferSize) {
+            writeAll(bytes, count);
+            return;
+        }
+    }
+    buffer_.insert(buffer_.end(), bytes, bytes + count);
+    if (lineBuffered_ && std::memchr(bytes, '\n', count) != nullptr) {
+        flush();
+    }
+}
+
+void OutputStream::flush() {
+    writeAll(buffer_.data(), buffer_.size());
+    buffer_.clear();
+}
+
+void OutputStream::close() {
+    if (fd_ == -1) {
+        return;
+    }
+    flush();
+    ::close(fd_);
+    fd_ = -1;
+}
+
+void OutputStream::writeAll(const char *bytes, size_t count) {
+    while (count > 0 && fd_ != -1) {
+        auto n = ::write(fd_, bytes, count);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return;
+        }
+        bytes += n;
+        count -= n;
+    }
+}
+
+extern "C" void sFlushStandardOutput() {
+    OutputStream::standardOutput()->flush();
+}
+
+extern "C" InputStream* sInputStreamStandard(runtime::ClassInfo*) {
+    return InputStream::standardInput();
+}
+
+extern "C" runtime::SimpleOptional<String *> sInputStreamReadLine(InputStream *stream) {
+    return stream->readLine();
+}
+
+extern "C" void sInputStreamDestruct(InputStream *stream) {
+    stream->~InputStream();
+}
+
+extern "C" OutputStream* sOutputStreamStandard(runtime::ClassInfo*) {
+    return OutputStream::standardOutput();
+}
+
+extern "C" void sOutputStreamWrite(OutputStream *stream, String *string) {
+    stream->write(string->bytes(), string->count);
+}
+
+extern "C" void sOutputStreamWriteLine(OutputStream *stream, String *string) {
+    stream->write(string->bytes(), string->count);
+    stream->write("\n", 1);
+}
+
+extern "C" void sOutputStreamFlush(OutputStream *stream) {
+    stream->flush();
+}
+
+extern "C" void sOutputStreamDestruct(OutputStream *stream) {
+    stream->~OutputStream();
+}
+
+}  // namespace s
@@ -0,0 +1,119 @@
+//
+// Created by Theo Weidmann on 14.10.26.
+//
+
+#ifndef EMOJICODE_STREAM_HPP
+#define EMOJICODE_STREAM_HPP
+
+#include "../runtime/Runtime.h"
+#include "String.h"
+#include <sys/types.h>
+#include <unistd.h>
+#include <vector>
+
+namespace s {
+
+/// A stream that reads a file descriptor in large blocks and returns lines as slices of its buffer.
+///
+/// Reading never blocks longer than necessary to obtain the next line, so the stream works for interactive input too.
+/// Streams are not thread-safe.
+class InputStream : public runtime::Object<InputStream> {
+public:
+    explicit InputStream(int fd) : fd_(fd) {}
+    /// Creates a stream that reads *fd* with pread() starting at *offset*, so that the file offset of the descriptor
+    /// is neither used nor changed.
+    InputStream(int fd, off_t offset) : fd_(fd), offset_(offset) {}
+    InputStream(const InputStream&) = delete;
+    ~InputStream() {
+        if (capacity_ > 0) {
+            buffer_.release();
+        }
+        if (closesDescriptor_) {
+            ::close(fd_);
+        }
+    }
+
+    /// Makes the stream close its file descriptor when it is destroyed.
+    void closeDescriptorOnDestruction() { closesDescriptor_ = true; }
+
+    /// Returns the stream reading the standard input, which is never deallocated.
+    static InputStream* standardInput();
+
+    /// Reads the next line without the line feed that terminates it. The line is a slice of the buffer of this stream.
+    /// @returns NoValue if the end of the input was reached.
+    runtime::SimpleOptional<String *> readLine() { return readUntil('\n'); }
+    /// Like readLine() but lines are terminated by *delimiter*.
+    runtime::SimpleOptional<String *> readUntil(char delimiter);
+    /// Reads the next *size* bytes or the remaining bytes if fewer are left. The string is a slice of the buffer of
+    /// this stream.
+    /// @returns NoValue if the end of the input was reached.
+    runtime::SimpleOptional<String *> readRecord(size_t size);
+
+    /// Returns true if the stream ended because reading failed.
+    bool failed() const { return failed_; }
+
+    static constexpr size_t kBufferSize = 64 * 1024;
+private:
+    /// Reads at least one byte into the buffer, keeping the unconsumed bytes. A new buffer is allocated if strings still
+    /// share the current one, as their bytes must not change.
+    /// @returns False if the end of the input was reached.
+    bool fill();
+    /// Returns the next *count* bytes as a string and consumes them and the *skip* bytes following them.
+    String* slice(size_t count, size_t skip);
+
+    int fd_;
+    /// The offset to read from next with pread() or -1 if the stream reads with read().
+    off_t offset_ = -1;
+    runtime::MemoryPointer<char> buffer_;
+    size_t capacity_ = 0;
+    /// The index of the first unconsumed byte in buffer_.
+    size_t begin_ = 0;
+    /// The index after the last byte read into buffer_.
+    size_t end_ = 0;
+    bool exhausted_ = false;
+    bool failed_ = false;
+    bool closesDescriptor_ = false;
+};
+
+/// A stream that collects written bytes in a buffer and only writes them to a file descriptor when the buffer is full or
+/// when the stream is flushed. If the file descriptor refers to a terminal, the stream is also flushed after every line
+/// feed written, so that output appears line by line. Streams are not thread-safe.
+class OutputStream : public runtime::Object<OutputStream> {
+public:
+    explicit OutputStream(int fd);
+    OutputStream(const OutputStream&) = delete;
+    ~OutputStream() {
+        if (closesDescriptor_) {
+            close();
+        }
+    }
+
+    /// Returns the stream writing to the standard output, which is never deallocated and flushed when the program
+    /// exits normally.
+    static OutputStream* standardOutput();
+
+    void write(const char *bytes, size_t count);
+    /// Writes the buffered bytes to the file descriptor.
+    void flush();
+    /// Flushes the stream and closes its file descriptor. Bytes written afterwards are discarded.
+    void close();
+    /// Makes the stream close its file descriptor when it is destroyed.
+    void closeDescriptorOnDestruction() { closesDescriptor_ = true; }
+
+    static constexpr size_t kBufferSize = 64 * 1024;
+private:
+    /// Writes all *count* bytes to the file descriptor, retrying after interruptions and partial writes.
+    void writeAll(const char *bytes, size_t count);
+
+    int fd_;
+    bool lineBuffered_;
+    bool closesDescriptor_ = false;
+    std::vector<char> buffer_;
+};
+
+}  // namespace s
+
+SET_INFO_FOR(s::InputStream, s, 1f4e5)
+SET_INFO_FOR(s::OutputStream, s, 1f4e4)
+
+#endif //EMOJICODE_STREAM_HPP
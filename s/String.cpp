@@ -9,19 +9,29 @@
 #include "../runtime/Runtime.h"
 #include "../runtime/Internal.hpp"
 #include "Data.h"
+#include "Format.h"
+#include "Search.h"
+#include "Stream.h"
 #include "String.h"
+#include "Unicode.h"
 #include "utf8proc.h"
 #include <algorithm>
 #include <cctype>
 #include <cinttypes>
-#include <cmath>
+#include <cstdlib>
 #include <cstring>
-#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
 
 using s::String;
 
+static_assert(sizeof(String) == sizeof(runtime::StringView::Layout), "StringView::Layout must match s::String.");
+static_assert(std::atomic<runtime::Integer>::is_always_lock_free, "The cached hash must be stored like a 🔢.");
+
 std::string String::stdString() {
-    return std::string(characters.get(), count);
+    return std::string(bytes(), count);
 }
 
 String::String(const char *cstring) {
@@ -29,23 +39,249 @@ String::String(const char *cstring) {
 }
 
 void String::store(const char *cstring) {
-    count = strlen(cstring);
+    store(cstring, strlen(cstring));
+}
+
+void String::store(const char *bytes, size_t count) {
+    this->count = count;
+    hash.store(0, std::memory_order_relaxed);
+    ascii.store(AsciiState::Unknown, std::memory_order_relaxed);
+    start = 0;
+    graphemeCheckpoints.state.store(GraphemeCheckpoints::Missing, std::memory_order_relaxed);
     characters = runtime::allocate<char>(count);
-    std::memcpy(characters.get(), cstring, count);
+    std::memcpy(characters.get(), bytes, count);
+}
+
+namespace {
+
+/// The number of strings returned by sharedString().
+constexpr size_t kSharedStringCount = 129;
+
+/// Returns the shared string for the ASCII character `index` or the empty string if `index` is 128.
+String* sharedString(size_t index) {
+    static String *const *const strings = [] {
+        static String *strings[kSharedStringCount];
+        for (size_t i = 0; i < kSharedStringCount; i++) {
+            auto string = String::initStatic();
+            string->count = i < 128 ? 1 : 0;
+            string->ascii.store(String::AsciiState::Ascii, std::memory_order_relaxed);
+            string->characters = runtime::allocateStatic<char>(string->count);
+            if (string->count > 0) {
+                string->bytes()[0] = static_cast<char>(i);
+            }
+            strings[i] = string;
+        }
+        return strings;
+    }();
+    return strings[index];
+}
+
+}  // namespace
+
+String* String::copy(const char *bytes, size_t count) {
+    if (count == 0) {
+        return sharedString(128);
+    }
+    if (count == 1 && static_cast<unsigned char>(bytes[0]) < 128) {
+        return sharedString(static_cast<unsigned char>(bytes[0]));
+    }
+    auto string = String::init();
+    string->count = count;
+    string->characters = runtime::allocate<char>(count);
+    std::memcpy(string->bytes(), bytes, count);
+    return string;
+}
+
+String* String::slice(size_t from, size_t count) {
+    if (count <= 1) {
+        return copy(bytes() + from, count);
+    }
+    auto string = String::init();
+    string->count = count;
+    string->start = start + from;
+    string->characters = characters;
+    if (ascii.load(std::memory_order_relaxed) == AsciiState::Ascii) {
+        string->ascii.store(AsciiState::Ascii, std::memory_order_relaxed);
+    }
+    characters.retain();
+    return string;
+}
+
+void String::compact() {
+    if (characters.controlBlock() == &ejcIgnoreBlock || (start == 0 && characters.isOnlyReference())) {
+        return;
+    }
+    auto memory = runtime::allocate<char>(count);
+    std::memcpy(memory.get(), bytes(), count);
+    characters.release();
+    characters = memory;
+    start = 0;
+}
+
+bool String::equals(String *other) {
+    if (this == other || (count == other->count && bytes() == other->bytes())) {
+        return true;
+    }
+    if (count != other->count) {
+        return false;
+    }
+    auto ownHash = hash.load(std::memory_order_relaxed);
+    auto otherHash = other->hash.load(std::memory_order_relaxed);
+    if (ownHash != 0 && otherHash != 0 && ownHash != otherHash) {
+        return false;
+    }
+    return std::memcmp(bytes(), other->bytes(), count) == 0;
+}
+
+int String::compare(String *other) {
+    if (this == other) {
+        return 0;
+    }
+    if (count != other->count) {
+        return count < other->count ? -1 : 1;
+    }
+    if (bytes() == other->bytes()) {
+        return 0;
+    }
+    auto result = std::memcmp(bytes(), other->bytes(), count);
+    return (result > 0) - (result < 0);
+}
+
+EJC_MULTIVERSIONED bool String::isAscii() {
+    auto state = ascii.load(std::memory_order_relaxed);
+    if (state == AsciiState::Unknown) {
+        auto bytes = reinterpret_cast<const uint8_t *>(this->bytes());
+        uint64_t high = 0;
+        runtime::Integer i = 0;
+        for (; i + 8 <= count; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, bytes + i, sizeof(word));
+            high |= word;
+        }
+        for (; i < count; i++) {
+            high |= bytes[i];
+        }
+        state = (high & 0x8080808080808080ull) == 0 ? AsciiState::Ascii : AsciiState::NotAscii;
+        ascii.store(state, std::memory_order_relaxed);
+    }
+    return state == AsciiState::Ascii;
+}
+
+namespace {
+
+/// Returns the offset of the grapheme that follows the grapheme beginning at `offset` or `count` if that grapheme is the
+/// last.
+/// @param state The state of the grapheme break algorithm, which is updated.
+size_t nextGraphemeBoundary(const utf8proc_uint8_t *bytes, size_t count, size_t offset, utf8proc_int32_t *state) {
+    utf8proc_int32_t prev, cp;
+    auto c = utf8proc_iterate(bytes + offset, count - offset, &prev);
+    if (c < 0) return count;
+    for (offset += c; offset < count; offset += c) {
+        if (bytes[offset] < 0x80) {
+            cp = bytes[offset];
+            c = 1;
+        }
+        else {
+            c = utf8proc_iterate(bytes + offset, count - offset, &cp);
+            if (c < 0) return count;
+        }
+        if (s::isGraphemeBreak(prev, cp, state)) return offset;
+        prev = cp;
+    }
+    return count;
+}
+
+/// Returns the checkpoints of every String::kGraphemeCheckpointInterval-th grapheme of `string` preceded by an entry
+/// whose offset is the number of checkpoints.
+runtime::MemoryPointer<s::GraphemeCheckpoint> buildGraphemeCheckpoints(String *string) {
+    auto bytes = reinterpret_cast<const utf8proc_uint8_t *>(string->bytes());
+    auto count = static_cast<size_t>(string->count);
+    std::vector<s::GraphemeCheckpoint> checkpoints;
+    utf8proc_int32_t state = 0;
+    runtime::Integer grapheme = 0;
+    for (size_t offset = 0; offset < count; grapheme++) {
+        if (grapheme % String::kGraphemeCheckpointInterval == 0) {
+            checkpoints.push_back({ static_cast<runtime::Integer>(offset), state });
+        }
+        offset = nextGraphemeBoundary(bytes, count, offset, &state);
+    }
+
+    auto memory = runtime::allocate<s::GraphemeCheckpoint>(checkpoints.size() + 1);
+    memory[0] = { static_cast<runtime::Integer>(checkpoints.size()), 0 };
+    std::copy(checkpoints.begin(), checkpoints.end(), memory.get() + 1);
+    return memory;
+}
+
+}  // namespace
+
+s::GraphemeCheckpoint String::graphemeCheckpoint(runtime::Integer index, runtime::Integer *graphemeIndex) {
+    if (index < kGraphemeCheckpointInterval) {
+        *graphemeIndex = 0;
+        return { 0, 0 };
+    }
+    runtime::MemoryPointer<GraphemeCheckpoint> checkpoints;
+    auto ownsCheckpoints = false;
+    if (graphemeCheckpoints.state.load(std::memory_order_acquire) == GraphemeCheckpoints::Ready) {
+        checkpoints = graphemeCheckpoints.memory;
+    }
+    else {
+        checkpoints = buildGraphemeCheckpoints(this);
+        runtime::Boolean state = GraphemeCheckpoints::Missing;
+        if (graphemeCheckpoints.state.compare_exchange_strong(state, GraphemeCheckpoints::Publishing,
+                                                              std::memory_order_acquire)) {
+            graphemeCheckpoints.memory = checkpoints;
+            graphemeCheckpoints.state.store(GraphemeCheckpoints::Ready, std::memory_order_release);
+        }
+        else if (state == GraphemeCheckpoints::Ready) {
+            checkpoints.release();
+            checkpoints = graphemeCheckpoints.memory;
+        }
+        else {
+            // Another thread is publishing its copy, which cannot be read yet.
+            ownsCheckpoints = true;
+        }
+    }
+
+    auto checkpoint = std::min(index / kGraphemeCheckpointInterval, checkpoints[0].offset - 1);
+    *graphemeIndex = checkpoint * kGraphemeCheckpointInterval;
+    auto result = checkpoints[checkpoint + 1];
+    if (ownsCheckpoints) {
+        checkpoints.release();
+    }
+    return result;
+}
+
+extern "C" void sStringCompact(String *string) {
+    string->compact();
+}
+
+extern "C" runtime::Boolean sStringEquals(String *string, String *other) {
+    return string->equals(other);
+}
+
+extern "C" runtime::Integer sStringCompare(String *string, String *other) {
+    return string->compare(other);
 }
 
 extern "C" void sStringPrint(String *string) {
-    std::cout.write(string->characters.get(), string->count) << '\n';
+    auto stream = s::OutputStream::standardOutput();
+    stream->write(string->bytes(), string->count);
+    stream->write("\n", 1);
 }
 
 extern "C" void sStringPrintNoLn(String *string) {
-    std::cout.write(string->characters.get(), string->count);
+    s::OutputStream::standardOutput()->write(string->bytes(), string->count);
 }
 
 extern "C" String* sStringReadLine(String *string) {
-    std::string str;
-    std::getline(std::cin, str);
-    string->store(str.c_str());
+    auto line = s::InputStream::standardInput()->readLine();
+    if (line == runtime::NoValue) {
+        string->store("", 0);
+        return string;
+    }
+    // Copied as this string is likely kept while more lines are read.
+    string->store((*line)->bytes(), (*line)->count);
+    (*line)->release();
     return string;
 }
 
@@ -53,51 +289,169 @@ extern "C" char sStringBeginsWith(String *string, String *beginning) {
     if (string->count < beginning->count) {
         return false;
     }
-    return std::memcmp(string->characters.get(), beginning->characters.get(), beginning->count) == 0;
+    return std::memcmp(string->bytes(), beginning->bytes(), beginning->count) == 0;
 }
 
 extern "C" char sStringEndsWith(String *string, String *ending) {
     if (string->count < ending->count) {
         return false;
     }
-    return std::memcmp(string->characters.get() + (string->count - ending->count), ending->characters.get(),
+    return std::memcmp(string->bytes() + (string->count - ending->count), ending->bytes(),
                        ending->count) == 0;
 }
 
-extern "C" String* sStringToLowercase(String *string) {
-    auto newString = String::init();
-    newString->count = string->count;
-    newString->characters = runtime::allocate<char>(string->count);
+namespace {
+
+constexpr uint64_t kOnes = 0x0101010101010101ull;
+constexpr uint64_t kHighBits = 0x8080808080808080ull;
+
+/// Changes the case of the letters in a word of eight ASCII characters. Each byte is offset so that its high bit is set
+/// if the byte is in the range of letters to convert, which then become the case bit 0x20.
+template <char First, char Last>
+uint64_t changeCase(uint64_t word) {
+    auto aboveFirst = word + kOnes * (0x80 - First);
+    auto aboveLast = word + kOnes * (0x80 - Last - 1);
+    return word ^ (((aboveFirst ^ aboveLast) & kHighBits) >> 2);
+}
+
+template <char First, char Last>
+char changeCase(char c) {
+    return First <= c && c <= Last ? c ^ 0x20 : c;
+}
+
+/// Changes the case of the letters in `count` ASCII characters.
+template <char First, char Last>
+void changeAsciiCase(const char *source, char *destination, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, source + i, sizeof(word));
+        word = changeCase<First, Last>(word);
+        std::memcpy(destination + i, &word, sizeof(word));
+    }
+    for (; i < count; i++) {
+        destination[i] = changeCase<First, Last>(source[i]);
+    }
+}
+
+/// Returns a new string with the case of all characters of `string` changed with `mapping`. `First` and `Last` are
+/// the ASCII letters that `mapping` changes.
+template <char First, char Last>
+String* changeCase(String *string, int32_t (*mapping)(int32_t)) {
+    if (string->isAscii()) {
+        auto newString = String::init();
+        newString->count = string->count;
+        newString->ascii.store(String::AsciiState::Ascii, std::memory_order_relaxed);
+        newString->characters = runtime::allocate<char>(string->count);
+        changeAsciiCase<First, Last>(string->bytes(), newString->bytes(), string->count);
+        return newString;
+    }
+
+    auto bytes = reinterpret_cast<const utf8proc_uint8_t *>(string->bytes());
+    std::string result;
+    result.reserve(string->count);
+    for (runtime::Integer off = 0; off < string->count;) {
+        auto run = off;
+        while (run < string->count && bytes[run] < 0x80) {
+            run++;
+        }
+        if (run > off) {
+            auto size = result.size();
+            result.resize(size + (run - off));
+            changeAsciiCase<First, Last>(string->bytes() + off, &result[size], run - off);
+            off = run;
+            continue;
+        }
 
-    size_t doff = 0;
-    for (size_t off = 0; off < string->count;) {
         utf8proc_int32_t codepoint;
-        auto state = utf8proc_iterate(reinterpret_cast<utf8proc_uint8_t *>(string->characters.get()) + off,
-                                      string->count, &codepoint);
+        auto state = utf8proc_iterate(bytes + off, string->count - off, &codepoint);
         if (state < 0) break;
-        doff += utf8proc_encode_char(utf8proc_tolower(codepoint),
-                                     reinterpret_cast<utf8proc_uint8_t *>(newString->characters.get()) + doff);
+        utf8proc_uint8_t buffer[4];
+        auto length = utf8proc_encode_char(mapping(codepoint), buffer);
+        result.append(reinterpret_cast<char *>(buffer), length);
         off += state;
     }
-    return newString;
+    return String::copy(result.data(), result.size());
+}
+
+/// Changes the case of the characters of `string` in place if neither the string nor its characters are referenced
+/// elsewhere and the string is ASCII. Otherwise, a new string is returned like from changeCase().
+template <char First, char Last>
+String* changeCaseInPlace(String *string, int32_t (*mapping)(int32_t)) {
+    if (string->isAscii() && string->isOnlyReference() && string->characters.isOnlyReference()) {
+        changeAsciiCase<First, Last>(string->bytes(), string->bytes(), string->count);
+        string->hash.store(0, std::memory_order_relaxed);
+        string->retain();
+        return string;
+    }
+    return changeCase<First, Last>(string, mapping);
+}
+
+}  // namespace
+
+extern "C" String* sStringToLowercase(String *string) {
+    return changeCase<'A', 'Z'>(string, s::toLowercase);
 }
 
 extern "C" String* sStringToUppercase(String *string) {
-    auto newString = String::init();
-    newString->count = string->count;
-    newString->characters = runtime::allocate<char>(string->count);
+    return changeCase<'a', 'z'>(string, s::toUppercase);
+}
 
-    size_t doff = 0;
-    for (size_t off = 0; off < string->count;) {
-        utf8proc_int32_t codepoint;
-        auto state = utf8proc_iterate(reinterpret_cast<utf8proc_uint8_t *>(string->characters.get()) + off,
-                                      string->count, &codepoint);
-        if (state < 0) break;
-        doff += utf8proc_encode_char(utf8proc_toupper(codepoint),
-                                     reinterpret_cast<utf8proc_uint8_t *>(newString->characters.get()) + doff);
-        off += state;
+extern "C" String* sStringToLowercaseInPlace(String *string) {
+    return changeCaseInPlace<'A', 'Z'>(string, s::toLowercase);
+}
+
+extern "C" String* sStringToUppercaseInPlace(String *string) {
+    return changeCaseInPlace<'a', 'z'>(string, s::toUppercase);
+}
+
+namespace {
+
+/// Returns `string` in Normalization Form C in memory allocated by malloc() and stores its length in `length`.
+/// Returns nullptr without normalizing if the quick check finds `string` to be in NFC already.
+utf8proc_uint8_t* normalizeNfc(String *string, utf8proc_ssize_t *length) {
+    auto bytes = reinterpret_cast<const utf8proc_uint8_t *>(string->bytes());
+    if (string->isAscii() || s::nfcQuickCheck(bytes, string->count) == s::QuickCheck::Yes) {
+        return nullptr;
+    }
+    utf8proc_uint8_t *normalized;
+    *length = utf8proc_map(bytes, string->count, &normalized,
+                           static_cast<utf8proc_option_t>(UTF8PROC_STABLE | UTF8PROC_COMPOSE));
+    return *length < 0 ? nullptr : normalized;
+}
+
+}  // namespace
+
+extern "C" String* sStringNormalize(String *string) {
+    utf8proc_ssize_t length;
+    auto normalized = normalizeNfc(string, &length);
+    if (normalized == nullptr ||
+        (length == string->count && std::memcmp(normalized, string->bytes(), length) == 0)) {
+        std::free(normalized);
+        string->retain();
+        return string;
+    }
+    auto result = String::copy(reinterpret_cast<char *>(normalized), length);
+    std::free(normalized);
+    return result;
+}
+
+extern "C" runtime::Boolean sStringCanonicallyEquals(String *string, String *other) {
+    if (string->equals(other)) {
+        return true;
     }
-    return newString;
+    utf8proc_ssize_t length = string->count, otherLength = other->count;
+    auto normalized = normalizeNfc(string, &length);
+    auto otherNormalized = normalizeNfc(other, &otherLength);
+    if (normalized == nullptr && otherNormalized == nullptr) {
+        return false;  // Different strings in NFC are never canonically equivalent.
+    }
+    const void *bytes = normalized != nullptr ? static_cast<void *>(normalized) : string->bytes();
+    const void *otherBytes = otherNormalized != nullptr ? static_cast<void *>(otherNormalized) : other->bytes();
+    auto equal = length == otherLength && std::memcmp(bytes, otherBytes, length) == 0;
+    std::free(normalized);
+    std::free(otherNormalized);
+    return equal;
 }
 
 extern "C" runtime::SimpleOptional<runtime::Integer> sStringFindFromIndex(String *string, String* search,
@@ -105,11 +459,38 @@ extern "C" runtime::SimpleOptional<runtime::Integer> sStringFindFromIndex(String
     if (offset >= string->count) {
         return runtime::NoValue;
     }
-    auto end = string->characters.get() + string->count;
-    auto pos = std::search(string->characters.get() + offset, end, search->characters.get(),
-                           search->characters.get() + search->count);
-    if (pos != end) {
-        return pos - string->characters.get();
+    auto pos = s::findBytes(string->bytes() + offset, string->count - offset, search->bytes(),
+                            search->count);
+    if (pos != nullptr) {
+        return pos - string->bytes();
+    }
+    return runtime::NoValue;
+}
+
+extern "C" runtime::SimpleOptional<runtime::Integer> sStringFind(String *string, String *search) {
+    auto bytes = reinterpret_cast<const utf8proc_uint8_t *>(string->bytes());
+    size_t count = string->count;
+    utf8proc_int32_t state = 0;
+    // The grapheme with the index `index` begins at `boundary`.
+    runtime::Integer index = 0;
+    size_t boundary = 0;
+
+    for (size_t from = 0; from < count;) {
+        auto match = s::findBytes(string->bytes() + from, count - from, search->bytes(), search->count);
+        if (match == nullptr) {
+            break;
+        }
+        size_t position = match - string->bytes();
+
+        // Only matches beginning at a grapheme boundary are occurrences.
+        while (boundary < position) {
+            boundary = nextGraphemeBoundary(bytes, count, boundary, &state);
+            index++;
+        }
+        if (boundary == position) {
+            return index;
+        }
+        from = position + 1;
     }
     return runtime::NoValue;
 }
@@ -117,7 +498,7 @@ extern "C" runtime::SimpleOptional<runtime::Integer> sStringFindFromIndex(String
 extern "C" void sStringCodepoints(String *string, runtime::Callable<void, runtime::Integer, runtime::Integer> cb) {
     for (size_t off = 0; off < string->count;) {
         utf8proc_int32_t codepoint;
-        auto state = utf8proc_iterate(reinterpret_cast<utf8proc_uint8_t *>(string->characters.get()) + off,
+        auto state = utf8proc_iterate(reinterpret_cast<utf8proc_uint8_t *>(string->bytes()) + off,
                                       string->count, &codepoint);
         if (state < 0) break;
         cb(codepoint, off);
@@ -130,254 +511,260 @@ extern "C" s::String* sStringTrim(String *string) {
 
     for (; begin < string->count;) {
         utf8proc_int32_t codepoint;
-        auto state = utf8proc_iterate(reinterpret_cast<utf8proc_uint8_t *>(string->characters.get()) + begin,
+        auto state = utf8proc_iterate(reinterpret_cast<utf8proc_uint8_t *>(string->bytes()) + begin,
                                       string->count, &codepoint);
         if (state < 0) break;
-        if (utf8proc_get_property(codepoint)->bidi_class != UTF8PROC_BIDI_CLASS_WS) break;
+        if (!(s::codepointProperties(codepoint).flags & s::kWhitespace)) break;
         begin += state;
     }
 
     size_t end = begin - 1;
     for (size_t i = begin; i < string->count;) {
         utf8proc_int32_t codepoint;
-        auto state = utf8proc_iterate(reinterpret_cast<utf8proc_uint8_t *>(string->characters.get()) + i,
+        auto state = utf8proc_iterate(reinterpret_cast<utf8proc_uint8_t *>(string->bytes()) + i,
                                       string->count, &codepoint);
         if (state < 0) break;
-        if (utf8proc_get_property(codepoint)->bidi_class != UTF8PROC_BIDI_CLASS_WS) {
+        if (!(s::codepointProperties(codepoint).flags & s::kWhitespace)) {
             end = i;
         }
         i += state;
     }
 
-    auto newString = String::init();
-    newString->count = end - begin + 1;
-    newString->characters = runtime::allocate<char>(string->count);
-    std::memcpy(newString->characters.get(), string->characters.get() + begin, newString->count);
-    return newString;
+    return string->slice(begin, end - begin + 1);
 }
 
 extern "C" void sStringGraphemes(String *string, runtime::Callable<void, s::String*> cb) {
-    auto bytes = reinterpret_cast<utf8proc_uint8_t *>(string->characters.get());
+    auto bytes = reinterpret_cast<const utf8proc_uint8_t *>(string->bytes());
+    size_t count = string->count;
     utf8proc_int32_t state = 0;
-    utf8proc_int32_t prev;
-
-    if (string->count == 0) {
-        return;
+    for (size_t begin = 0; begin < count;) {
+        auto end = nextGraphemeBoundary(bytes, count, begin, &state);
+        auto grapheme = string->slice(begin, end - begin);
+        cb(grapheme);
+        grapheme->release();
+        begin = end;
     }
+}
 
-    size_t lastCut = 0;
-    size_t off = utf8proc_iterate(bytes, string->count, &prev);
+extern "C" s::String* sStringGraphemeSubstring(String *string, runtime::Integer from, runtime::Integer length) {
+    auto bytes = reinterpret_cast<const utf8proc_uint8_t *>(string->bytes());
+    size_t count = string->count;
+    runtime::Integer index;
+    auto checkpoint = string->graphemeCheckpoint(from, &index);
+    size_t begin = checkpoint.offset;
+    auto state = static_cast<utf8proc_int32_t>(checkpoint.state);
+
+    for (; index < from && begin < count; index++) {
+        begin = nextGraphemeBoundary(bytes, count, begin, &state);
+    }
+    auto end = begin;
+    for (runtime::Integer i = 0; i < length && end < count; i++) {
+        end = nextGraphemeBoundary(bytes, count, end, &state);
+    }
+    return string->slice(begin, end - begin);
+}
 
-    while (off < string->count) {
-        utf8proc_int32_t cp;
-        auto c = utf8proc_iterate(bytes + off, string->count, &cp);
+/// The layout of 🎠, which iterates over the graphemes of a string.
+class GraphemeIterator : public runtime::Object<GraphemeIterator> {
+public:
+    String *string;
+    runtime::Integer position;
+    runtime::Integer state;
+};
+
+extern "C" String* sStringGraphemeIteratorNext(GraphemeIterator *iterator) {
+    auto string = iterator->string;
+    auto state = static_cast<utf8proc_int32_t>(iterator->state);
+    size_t begin = iterator->position;
+    auto end = nextGraphemeBoundary(reinterpret_cast<const utf8proc_uint8_t *>(string->bytes()), string->count, begin,
+                                    &state);
+    iterator->position = end;
+    iterator->state = state;
+    return string->slice(begin, end - begin);
+}
 
-        if (utf8proc_grapheme_break_stateful(prev, cp, &state)) {
-            auto newString = String::init();
-            newString->count = off - lastCut;
-            newString->characters = runtime::allocate<char>(newString->count);
-            std::memcpy(newString->characters.get(), string->characters.get() + lastCut, newString->count);
-            lastCut = off;
-            cb(newString);
-            newString->release();
+extern "C" void sStringSplit(String *string, String *separator, runtime::Callable<void, s::String*> cb) {
+    auto characters = string->bytes();
+    size_t last = 0;
+    if (separator->count > 0) {
+        while (auto match = s::findBytes(characters + last, string->count - last, separator->bytes(),
+                                         separator->count)) {
+            auto part = string->slice(last, match - (characters + last));
+            cb(part);
+            part->release();
+            last = match - characters + separator->count;
         }
-        prev = cp;
-        off += c;
     }
-
-    auto newString = String::init();
-    newString->count = off - lastCut;
-    newString->characters = runtime::allocate<char>(newString->count);
-    std::memcpy(newString->characters.get(), string->characters.get() + lastCut, newString->count);
-    lastCut = off;
-    cb(newString);
-    newString->release();
+    auto part = string->slice(last, string->count - last);
+    cb(part);
+    part->release();
 }
 
-extern "C" s::String* sStringGraphemeSubstring(String *string, runtime::Integer from, runtime::Integer length) {
-    auto bytes = reinterpret_cast<utf8proc_uint8_t *>(string->characters.get());
-    utf8proc_int32_t state = 0;
-    utf8proc_int32_t prev, cp;
-    size_t beginCut = 0, off = utf8proc_iterate(bytes, string->count, &prev);
+extern "C" runtime::SimpleOptional<runtime::Integer> sStringToInt(String *string, runtime::Integer base) {
+    return s::parseInteger(string->bytes(), string->bytes() + string->count, base);
+}
 
-    if (length == 0) {
-        auto newString = String::init();
-        newString->count = 0;
-        newString->characters = runtime::allocate<char>(0);
-        return newString;
-    }
+extern "C" runtime::SimpleOptional<runtime::Real> sStringToReal(String *string) {
+    return s::parseReal(string->bytes(), string->bytes() + string->count);
+}
 
-    while (off < string->count && from > 0) {
-        auto c = utf8proc_iterate(bytes + off, string->count, &cp);
+namespace {
 
-        if (utf8proc_grapheme_break_stateful(prev, cp, &state) && --from == 0) {
-            beginCut = off;
-            prev = cp;
-            off += c;
-            break;
-        }
-        prev = cp;
-        off += c;
-    }
-    while (off < string->count) {
-        auto c = utf8proc_iterate(bytes + off, string->count, &cp);
+uint64_t mix(uint64_t a, uint64_t b) {
+    auto r = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+}
 
-        if (utf8proc_grapheme_break_stateful(prev, cp, &state) && --length == 0) {
-            break;
-        }
-        prev = cp;
-        off += c;
-    }
+uint64_t read64(const uint8_t *p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
 
-    auto newString = String::init();
-    newString->count = off - beginCut;
-    newString->characters = runtime::allocate<char>(newString->count);
-    std::memcpy(newString->characters.get(), string->characters.get() + beginCut, newString->count);
-    return newString;
+uint64_t read32(const uint8_t *p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
 }
 
-runtime::SimpleOptional<runtime::Integer> sStringToIntLength(const char *characters,
-                                                             runtime::Integer length, runtime::Integer base) {
-    if (length == 0) {
-        return runtime::NoValue;
-    }
-    runtime::Integer x = 0;
-    for (decltype(length) i = 0; i < length; i++) {
-        if (i == 0 && (characters[i] == '-' || characters[i] == '+')) {
-            if (length < 2) {
-                return runtime::NoValue;
-            }
-            continue;
+/// Hashes the bytes using the algorithm of wyhash (final version 4). Inputs longer than 48 bytes are processed in
+/// three independent lanes so that the multiplications can execute in parallel.
+uint64_t hashBytes(const uint8_t *p, size_t len, uint64_t seed) {
+    const uint64_t s0 = 0xa0761d6478bd642full, s1 = 0xe7037ed1a0b428dbull, s2 = 0x8ebc6af09c88c6e3ull,
+        s3 = 0x589965cc75374cc3ull;
+    seed ^= mix(seed ^ s0, s1);
+    uint64_t a, b;
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (read32(p) << 32) | read32(p + ((len >> 3) << 2));
+            b = (read32(p + len - 4) << 32) | read32(p + len - 4 - ((len >> 3) << 2));
         }
-
-        auto b = base;
-        if ('0' <= characters[i] && characters[i] <= '9') {
-            b = characters[i] - '0';
+        else if (len > 0) {
+            a = (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[len >> 1]) << 8) | p[len - 1];
+            b = 0;
         }
-        else if ('A' <= characters[i] && characters[i] <= 'Z') {
-            b = characters[i] - 'A' + 10;
+        else {
+            a = b = 0;
         }
-        else if ('a' <= characters[i] && characters[i] <= 'z') {
-            b = characters[i] - 'a' + 10;
+    }
+    else {
+        auto i = len;
+        if (i > 48) {
+            auto seed1 = seed, seed2 = seed;
+            do {
+                seed = mix(read64(p) ^ s1, read64(p + 8) ^ seed);
+                seed1 = mix(read64(p + 16) ^ s2, read64(p + 24) ^ seed1);
+                seed2 = mix(read64(p + 32) ^ s3, read64(p + 40) ^ seed2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= seed1 ^ seed2;
         }
-
-        if (b >= base) {
-            return runtime::NoValue;
+        while (i > 16) {
+            seed = mix(read64(p) ^ s1, read64(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
         }
-
-        x *= base;
-        x += b;
-    }
-
-    if (characters[0] == '-') {
-        x *= -1;
+        a = read64(p + i - 16);
+        b = read64(p + i - 8);
     }
-    return x;
+    auto r = static_cast<__uint128_t>(a ^ s1) * (b ^ seed);
+    return mix(static_cast<uint64_t>(r) ^ s0 ^ len, static_cast<uint64_t>(r >> 64) ^ s1);
 }
 
-extern "C" runtime::SimpleOptional<runtime::Integer> sStringToInt(String *string, runtime::Integer base) {
-    return sStringToIntLength(string->characters.get(), string->count, base);
+/// Returns the value of 🔡’s ⚗️ for the `count` bytes at `bytes`, which is never 0.
+runtime::Integer hashString(const char *bytes, size_t count) {
+    auto hash = static_cast<runtime::Integer>(hashBytes(reinterpret_cast<const uint8_t *>(bytes), count,
+                                                        runtime::internal::hashSeed()));
+    return hash != 0 ? hash : 1;  // 0 marks that no hash was cached
 }
 
-extern "C" runtime::SimpleOptional<runtime::Real> sStringToReal(String *string) {
-    if (string->count == 0) {
-        return runtime::NoValue;
-    }
-
-    runtime::Real d = 0.0;
-    bool sign = true;
-    bool foundSeparator = false;
-    bool foundDigit = false;
-    size_t decimalPlace = 0;
-    decltype(string->count) i = 0;
-
-    if (string->characters[0] == '-') {
-        sign = false;
-        i++;
-    }
-    else if (string->characters[0] == '+') {
-        i++;
-    }
-
-    for (; i < string->count; i++) {
-        if (string->characters[i] == '.') {
-            if (foundSeparator) {
-                return runtime::NoValue;
+/// Interned strings are distributed over shards by their hash so that threads interning different strings rarely
+/// contend for the same lock.
+constexpr size_t kInternShardCount = 64;
+
+/// Keys are only interned by String::internKey() if they are at most this long and fewer than kMaxInternedKeys strings
+/// have been interned, so that documents with arbitrary keys, like identifiers, cannot grow the table without bounds.
+constexpr size_t kMaxInternedKeyLength = 64;
+constexpr size_t kMaxInternedKeys = 1 << 16;
+
+struct InternShard {
+    std::shared_mutex mutex;
+    /// The interned strings by their hash.
+    std::unordered_multimap<runtime::Integer, String *> strings;
+
+    String* find(const char *bytes, size_t count, runtime::Integer hash) {
+        auto range = strings.equal_range(hash);
+        for (auto it = range.first; it != range.second; it++) {
+            auto string = it->second;
+            if (static_cast<size_t>(string->count) == count && std::memcmp(string->bytes(), bytes, count) == 0) {
+                return string;
             }
-            foundSeparator = true;
-            continue;
-        }
-        if (string->characters[i] == 'e' || string->characters[i] == 'E') {
-            auto exponent = sStringToIntLength(string->characters.get() + i + 1, string->count - i - 1, 10);
-            if (exponent == runtime::NoValue) {
-                return runtime::NoValue;
-            }
-            d *= std::pow(10, *exponent);
-            break;
-        }
-        if ('0' <= string->characters[i] && string->characters[i] <= '9') {
-            d *= 10;
-            d += string->characters[i] - '0';
-            if (foundSeparator) {
-                decimalPlace++;
-            }
-            foundDigit = true;
-        }
-        else {
-            return runtime::NoValue;
         }
+        return nullptr;
     }
-
-    if (!foundDigit) {
-        return runtime::NoValue;
+};
+
+InternShard internShards[kInternShardCount];
+std::atomic<size_t> internedCount{0};
+
+/// Returns the interned string with the `count` bytes at `bytes` or, if there is none, the string created by
+/// *create*, which is interned unless it returns a string that is not static.
+template <typename Create>
+String* intern(const char *bytes, size_t count, Create create) {
+    auto hash = hashString(bytes, count);
+    auto &shard = internShards[static_cast<uint64_t>(hash) % kInternShardCount];
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        if (auto string = shard.find(bytes, count, hash)) return string;
     }
-
-    d /= std::pow(10, decimalPlace);
-
-    if (!sign) {
-        d *= -1;
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    if (auto string = shard.find(bytes, count, hash)) return string;
+    auto string = create();
+    if (string->controlBlock() == &ejcIgnoreBlock) {
+        string->hash.store(hash, std::memory_order_relaxed);
+        shard.strings.emplace(hash, string);
+        internedCount.fetch_add(1, std::memory_order_relaxed);
     }
-    return d;
+    return string;
 }
 
-extern "C" runtime::Integer sStringHash(String *string) {
-    auto len = string->count;
-    const unsigned int m = 0x5bd1e995;
-    const int r = 24;
-
-    unsigned int h = runtime::internal::seed ^ len;
-
-    const unsigned char * data = reinterpret_cast<const unsigned char *>(string->characters.get());
-
-    while(len >= 4) {
-        unsigned int k;
-
-        k  = data[0];
-        k |= data[1] << 8;
-        k |= data[2] << 16;
-        k |= data[3] << 24;
+/// Returns a string with a copy of the `count` bytes at `bytes` that is never deallocated.
+String* staticCopy(const char *bytes, size_t count) {
+    auto string = String::initStatic();
+    string->count = count;
+    string->characters = runtime::allocateStatic<char>(count);
+    std::memcpy(string->characters.get(), bytes, count);
+    return string;
+}
 
-        k *= m;
-        k ^= k >> r;
-        k *= m;
+}  // namespace
 
-        h *= m;
-        h ^= k;
+String* String::intern(const char *bytes, size_t count) {
+    return ::intern(bytes, count, [&] { return staticCopy(bytes, count); });
+}
 
-        data += 4;
-        len -= 4;
+String* String::internKey(const char *bytes, size_t count) {
+    if (count > kMaxInternedKeyLength) {
+        return copy(bytes, count);
     }
+    return ::intern(bytes, count, [&] {
+        return internedCount.load(std::memory_order_relaxed) < kMaxInternedKeys ? staticCopy(bytes, count)
+                                                                                  : copy(bytes, count);
+    });
+}
 
-    switch(len) {
-        case 3: h ^= data[2] << 16;
-        case 2: h ^= data[1] << 8;
-        case 1: h ^= data[0];
-                h *= m;
+extern "C" runtime::Integer sStringHash(String *string) {
+    // Strings are immutable, so the hash can be cached. Racing threads store the same value.
+    auto cached = string->hash.load(std::memory_order_relaxed);
+    if (cached != 0) {
+        return cached;
     }
+    auto hash = hashString(string->bytes(), string->count);
+    string->hash.store(hash, std::memory_order_relaxed);
+    return hash;
+}
 
-    h ^= h >> 13;
-    h *= m;
-    h ^= h >> 15;
-
-    return h;
+extern "C" String* sStringIntern(String *string) {
+    return String::intern(string->bytes(), string->count);
 }
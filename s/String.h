@@ -9,12 +9,29 @@
 #ifndef String_hpp
 #define String_hpp
 
+#include <atomic>
 #include <cstdint>
 #include <string>
 #include "../runtime/Runtime.h"
 
 namespace s {
 
+/// The offset of a grapheme in a string and the state of the grapheme break algorithm at its beginning.
+struct GraphemeCheckpoint {
+    runtime::Integer offset;
+    runtime::Integer state;
+};
+
+/// The checkpoints of a string, which have the layout of a 🍬🧠 whose flag is one of the values of State. Threads that
+/// index the same string at the same time build a copy each and publish it by a compare-and-swap on the flag.
+struct GraphemeCheckpoints {
+    enum State : runtime::Boolean { Missing = 0, Ready = 1, Publishing = 2 };
+
+    std::atomic<runtime::Boolean> state{Missing};
+    /// Valid once state is Ready.
+    runtime::MemoryPointer<GraphemeCheckpoint> memory;
+};
+
 class String : public runtime::Object<String>  {
 public:
     String(const char *string);
@@ -25,11 +42,62 @@ public:
     /// This method can be used to make a newly constructed string represent the value of the provided string.
     /// @warning Do not use this method to modify an existing string, i.e. one that has a value already.
     void store(const char *cstring);
+    /// Like store(const char *) but stores the `count` bytes at `bytes`.
+    void store(const char *bytes, size_t count);
+
+    /// Returns a new string consisting of a copy of the `count` bytes at `bytes`.
+    /// The empty string and strings of a single ASCII character are shared instances that are never deallocated, so
+    /// that no memory is allocated for them.
+    static String* copy(const char *bytes, size_t count);
+    /// Returns the canonical string consisting of the `count` bytes at `bytes`, i.e. every call with the same bytes
+    /// returns the same instance. Interned strings are never deallocated.
+    static String* intern(const char *bytes, size_t count);
+    /// Like intern() but meant for the keys of parsed documents, which are usually drawn from a small set but may be
+    /// arbitrary. Long keys and, once the table of interned strings has grown large, keys that have not been interned
+    /// yet are copied like copy() does.
+    static String* internKey(const char *bytes, size_t count);
+    /// Returns a new string consisting of the `count` bytes of this string beginning at index `from`. The new string
+    /// shares the characters of this string unless it is one of the instances returned by copy().
+    String* slice(size_t from, size_t count);
+    /// Copies the characters into a memory area of their own if they are shared with another string, so that a slice
+    /// does not keep the characters of a longer string alive.
+    void compact();
 
     runtime::MemoryPointer<char> characters;
     runtime::Integer count;
+    /// The cached hash of this string or 0 if it has not been calculated yet. Threads that hash the same string at the
+    /// same time store the same value, so relaxed loads and stores suffice.
+    std::atomic<runtime::Integer> hash{0};
+    /// Caches the result of isAscii(). One of the values of AsciiState. Like the hash, it is idempotent and accessed
+    /// with relaxed loads and stores.
+    std::atomic<runtime::Integer> ascii{AsciiState::Unknown};
+    /// The index in `characters` of the first byte of this string. Slices share the characters of another string and
+    /// begin at an arbitrary index.
+    runtime::Integer start = 0;
+    /// Checkpoints for every kGraphemeCheckpointInterval-th grapheme preceded by an entry whose offset is the number of
+    /// checkpoints. Built by graphemeCheckpoint() when needed.
+    GraphemeCheckpoints graphemeCheckpoints;
+
+    static constexpr runtime::Integer kGraphemeCheckpointInterval = 64;
+
+    enum AsciiState : runtime::Integer { Unknown = 0, Ascii = 1, NotAscii = 2 };
+
+    /// Returns a pointer to the first byte of this string.
+    char* bytes() const { return characters.get() + start; }
+
+    /// Returns true if all characters in this string are ASCII characters and therefore take up one byte each.
+    /// The result is calculated once and cached.
+    bool isAscii();
+    /// Returns the checkpoint of the grapheme with the greatest index not greater than `index` that a checkpoint is
+    /// available for and stores the index of that grapheme in `graphemeIndex`. Graphemes with an index that is a
+    /// multiple of kGraphemeCheckpointInterval can have checkpoints, which are found in constant time after the first
+    /// call has indexed this string in linear time.
+    GraphemeCheckpoint graphemeCheckpoint(runtime::Integer index, runtime::Integer *graphemeIndex);
 
     std::string stdString();
+    /// Returns true if `other` has the same bytes as this string. Identical strings, strings of different lengths and
+    /// strings whose cached hashes differ are told apart without comparing their bytes.
+    bool equals(String *other);
     int compare(String *other);
 };
 
@@ -4,9 +4,25 @@
 
 #include "../runtime/Runtime.h"
 #include "../runtime/Internal.hpp"
+#include "../runtime/Allocator.hpp"
+#include "../runtime/Collector.hpp"
+#include "../runtime/Pool.hpp"
 #include "String.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 
 extern "C" [[noreturn]] void sSystemExit(runtime::ClassInfo*, runtime::Integer code) {
     std::exit(code);
@@ -16,15 +32,98 @@ extern "C" runtime::Integer sSystemUnixTimestamp(runtime::ClassInfo*) {
     return std::time(0);
 }
 
+extern "C" runtime::Integer sSystemUnixTimestampNanoseconds(runtime::ClassInfo*) {
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+extern "C" runtime::Integer sSystemMonotonicNanoseconds(runtime::ClassInfo*) {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+extern "C" runtime::Integer sSystemCycles(runtime::ClassInfo *info) {
+#if defined(__x86_64__) || defined(__i386__)
+    return static_cast<runtime::Integer>(__rdtsc());
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return static_cast<runtime::Integer>(ticks);
+#else
+    return sSystemMonotonicNanoseconds(info);
+#endif
+}
+
+namespace {
+
+/// Returns a string that is never deallocated with the bytes of *value*.
+s::String* staticString(const char *value, size_t count) {
+    auto string = s::String::initStatic();
+    string->count = count;
+    string->characters = runtime::allocateStatic<char>(count);
+    std::memcpy(string->characters.get(), value, count);
+    return string;
+}
+
+/// Returns the arguments of the program as strings that are never deallocated. They are created on the first call and
+/// share one memory area.
+const std::vector<s::String *>& arguments() {
+    static const std::vector<s::String *> arguments = [] {
+        std::vector<size_t> counts;
+        size_t total = 0;
+        for (int i = 0; i < runtime::internal::argc; i++) {
+            counts.emplace_back(std::strlen(runtime::internal::argv[i]));
+            total += counts.back();
+        }
+        auto characters = runtime::allocateStatic<char>(total);
+        std::vector<s::String *> arguments;
+        size_t start = 0;
+        for (int i = 0; i < runtime::internal::argc; i++) {
+            std::memcpy(characters.get() + start, runtime::internal::argv[i], counts[i]);
+            auto string = s::String::initStatic();
+            string->characters = characters;
+            string->start = start;
+            string->count = counts[i];
+            arguments.emplace_back(string);
+            start += counts[i];
+        }
+        return arguments;
+    }();
+    return arguments;
+}
+
+/// The strings returned for environment variables by the calling thread, indexed by the address of the value that
+/// getenv() returned.
+thread_local std::unordered_map<const char *, s::String *> environmentStrings;
+
+}  // namespace
+
 extern "C" runtime::SimpleOptional<s::String*> sSystemGetEnv(runtime::ClassInfo*, s::String *name) {
-    auto var = std::getenv(name->stdString().c_str());
-    if (var != nullptr) {
-        return s::String::init(var);
+    char buffer[256];
+    const char *var;
+    if (static_cast<size_t>(name->count) < sizeof(buffer)) {
+        std::memcpy(buffer, name->bytes(), name->count);
+        buffer[name->count] = '\0';
+        var = std::getenv(buffer);
     }
-    return runtime::NoValue;
+    else {
+        var = std::getenv(name->stdString().c_str());
+    }
+    if (var == nullptr) {
+        return runtime::NoValue;
+    }
+
+    // The value can have been changed in place since it was cached.
+    auto count = std::strlen(var);
+    auto &string = environmentStrings[var];
+    if (string == nullptr || static_cast<size_t>(string->count) != count ||
+        std::memcmp(string->bytes(), var, count) != 0) {
+        string = staticString(var, count);
+    }
+    return string;
 }
 
-extern "C" [[noreturn]] void sPanic(runtime::ClassInfo*, s::String *message) {
+extern "C" [[noreturn]] __attribute__((cold)) void sPanic(runtime::ClassInfo*, s::String *message) {
     ejcPanic(message->stdString().c_str());
 }
 
@@ -32,9 +131,108 @@ extern "C" runtime::SimpleOptional<s::String*> sSystemArg(runtime::ClassInfo*, r
     if (i >= runtime::internal::argc) {
         return runtime::NoValue;
     }
-    return s::String::init(runtime::internal::argv[i]);
+    return arguments()[i];
+}
+
+extern "C" runtime::Integer sSystemArgCount(runtime::ClassInfo*) {
+    return runtime::internal::argc;
 }
 
 extern "C" void sSystemSystem(runtime::ClassInfo*, s::String *string) {
     std::system(string->stdString().c_str());
 }
+
+extern "C" void sSystemTrimMemory(runtime::ClassInfo*) {
+    runtime::internal::trimObjectPools();
+    runtime::internal::trimAllocationCaches();
+}
+
+extern "C" void sSystemTrackCycles(runtime::ClassInfo*) {
+    runtime::internal::collectorEnabled.store(true, std::memory_order_relaxed);
+}
+
+extern "C" runtime::Integer sSystemCollectCycles(runtime::ClassInfo*) {
+    return static_cast<runtime::Integer>(runtime::internal::collectCycles());
+}
+
+extern "C" runtime::Integer sSystemLiveBytes(runtime::ClassInfo*) {
+    return runtime::internal::liveMemory().bytes;
+}
+
+extern "C" runtime::Integer sSystemLiveAllocations(runtime::ClassInfo*) {
+    return runtime::internal::liveMemory().allocations;
+}
+
+extern "C" runtime::SimpleOptional<runtime::Integer> sSystemResidentBytes(runtime::ClassInfo*) {
+    auto file = std::fopen("/proc/self/statm", "r");
+    if (file == nullptr) {
+        return runtime::NoValue;
+    }
+    long long size, resident;
+    auto read = std::fscanf(file, "%lld %lld", &size, &resident);
+    std::fclose(file);
+    if (read != 2) {
+        return runtime::NoValue;
+    }
+    return static_cast<runtime::Integer>(resident) * sysconf(_SC_PAGESIZE);
+}
+
+extern "C" void sSystemSetMemoryLimit(runtime::ClassInfo*, runtime::Integer bytes) {
+    runtime::internal::setMemoryLimit(bytes);
+}
+
+namespace {
+
+std::mutex pressureMutex;
+std::condition_variable pressureCondition;
+bool pressurePending = false;
+std::vector<runtime::Callable<void>> pressureHandlers;
+
+void callPressureHandlers() {
+    std::vector<runtime::Callable<void>> handlers;
+    {
+        std::lock_guard<std::mutex> lock(pressureMutex);
+        handlers = pressureHandlers;
+    }
+    // Handlers are never removed, so that they remain retained while they are called.
+    for (auto &handler : handlers) {
+        handler();
+    }
+}
+
+/// The memory pressure handler of the runtime. It is called while memory is allocated and therefore only wakes the
+/// thread that calls the handlers registered by the program.
+void notifyMemoryPressure() {
+    {
+        std::lock_guard<std::mutex> lock(pressureMutex);
+        pressurePending = true;
+    }
+    pressureCondition.notify_one();
+}
+
+}  // namespace
+
+extern "C" void sSystemOnMemoryPressure(runtime::ClassInfo*, runtime::Callable<void> handler) {
+    handler.retain();
+    std::lock_guard<std::mutex> lock(pressureMutex);
+    pressureHandlers.emplace_back(handler);
+    if (pressureHandlers.size() > 1) {
+        return;
+    }
+    runtime::internal::becomeMultithreaded();
+    std::thread([]() {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(pressureMutex);
+                pressureCondition.wait(lock, []() { return pressurePending; });
+                pressurePending = false;
+            }
+            callPressureHandlers();
+        }
+    }).detach();
+    runtime::internal::memoryPressureHandler.store(notifyMemoryPressure, std::memory_order_release);
+}
+
+extern "C" void sSystemSignalMemoryPressure(runtime::ClassInfo*) {
+    callPressureHandlers();
+}
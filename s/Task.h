@@ -0,0 +1,42 @@
+//
+// Created by Theo Weidmann on 14.10.26.
+//
+
+#ifndef EMOJICODE_TASK_H
+#define EMOJICODE_TASK_H
+
+#include "../runtime/Runtime.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace s {
+
+class Task : public runtime::Object<Task> {
+public:
+    runtime::Callable<void> callable;
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::atomic<bool> done{false};
+    /// Tasks that are submitted once this task is done. Guarded by mutex.
+    std::vector<Task *> continuations;
+};
+
+/// Creates a task that calls *callable* once it was passed to submitTask(). The task is retained for the scheduler,
+/// which releases it after execution.
+Task* newTask(runtime::Callable<void> callable);
+
+/// Schedules *task*, which was created by newTask(), for execution on the threads of the scheduler. Can be called
+/// from any thread.
+void submitTask(Task *task);
+
+/// Schedules *task*, which was created by newTask(), for execution once at least *nanoseconds* have passed. The
+/// deadlines are kept in a timer wheel that is advanced by one thread. Can be called from any thread.
+void submitTaskAfter(Task *task, runtime::Integer nanoseconds);
+
+}  // namespace s
+
+SET_INFO_FOR(s::Task, s, 1f3ab)
+
+#endif //EMOJICODE_TASK_H
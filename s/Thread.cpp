@@ -3,8 +3,30 @@
 //
 
 #include "../runtime/Runtime.h"
+#include "../runtime/Allocator.hpp"
+#include "../runtime/Arena.hpp"
+#include "../runtime/Internal.hpp"
+#include "String.h"
+#include "Task.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <memory>
 #include <mutex>
+#include <pthread.h>
+#include <shared_mutex>
+#include <string>
 #include <thread>
+#include <unistd.h>
+#include <vector>
+#ifdef __linux__
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
 
 namespace s {
 
@@ -18,13 +40,42 @@ public:
     std::mutex mutex;
 };
 
+class ThreadLocal : public runtime::Object<ThreadLocal> {
+public:
+    size_t key = runtime::internal::newThreadLocalKey();
+};
+
+class ReadWriteLock : public runtime::Object<ReadWriteLock> {
+public:
+    std::shared_mutex mutex;
+};
+
+class Condition : public runtime::Object<Condition> {
+public:
+    std::condition_variable condition;
+};
+
+class Semaphore : public runtime::Object<Semaphore> {
+public:
+    std::mutex mutex;
+    std::condition_variable available;
+    runtime::Integer count;
+};
+
+/// The number of times sMutexLock() tries to acquire a locked mutex before the thread is suspended. Most critical
+/// sections are short, so that spinning briefly avoids the cost of suspending and waking the thread.
+constexpr int kMutexSpins = 64;
+
+
 extern "C" Thread* sThreadNew(runtime::Callable<void> callable) {
     auto thread = Thread::init();
     callable.retain();
     thread->retain();
+    runtime::internal::becomeMultithreaded();
     thread->thread = std::thread([thread, callable]() {
         callable();
         callable.release();
+        runtime::internal::releaseThreadLocals();
         thread->release();
     });
     return thread;
@@ -42,16 +93,556 @@ extern "C" void sThreadDelay(runtime::ClassInfo *, runtime::Integer mcs) {
     std::this_thread::sleep_for(std::chrono::microseconds(mcs));
 }
 
+/// The processors of the system and the NUMA nodes they belong to. Nodes are numbered from 0 in the order in which
+/// the system lists them and only nodes with processors are included. The nodes are read from sysfs on Linux. On
+/// other systems, or if sysfs is not available, all processors belong to node 0.
+class Topology {
+public:
+    static const Topology& shared() {
+        static Topology topology;
+        return topology;
+    }
+
+    size_t processorCount() const { return nodeOfProcessor_.size(); }
+    size_t nodeCount() const { return processorsOfNode_.size(); }
+
+    /// Returns the node of *processor* or -1 if there is no such processor.
+    runtime::Integer nodeOf(runtime::Integer processor) const {
+        if (processor < 0 || static_cast<size_t>(processor) >= nodeOfProcessor_.size()) return -1;
+        return nodeOfProcessor_[processor];
+    }
+
+    const std::vector<int>& processorsOf(size_t node) const { return processorsOfNode_[node]; }
+
+    /// The processors the process was allowed to run on when the topology was first accessed.
+    const std::vector<int>& allowed() const { return allowed_; }
+
+    /// The processors of *node* that are in allowed().
+    std::vector<int> allowedProcessorsOf(size_t node) const {
+        std::vector<int> processors;
+        std::set_intersection(processorsOfNode_[node].begin(), processorsOfNode_[node].end(), allowed_.begin(),
+                              allowed_.end(), std::back_inserter(processors));
+        return processors;
+    }
+
+private:
+    Topology() {
+        nodeOfProcessor_.assign(std::max(1L, sysconf(_SC_NPROCESSORS_CONF)), 0);
+#ifdef __linux__
+        for (auto node : parseList(readFile("/sys/devices/system/node/online"))) {
+            auto processors = parseList(readFile("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"));
+            if (processors.empty()) continue;
+            for (auto processor : processors) {
+                if (static_cast<size_t>(processor) >= nodeOfProcessor_.size()) {
+                    nodeOfProcessor_.resize(processor + 1, 0);
+                }
+                nodeOfProcessor_[processor] = static_cast<int>(processorsOfNode_.size());
+            }
+            processorsOfNode_.emplace_back(std::move(processors));
+        }
+        cpu_set_t set;
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int processor = 0; processor < CPU_SETSIZE; processor++) {
+                if (CPU_ISSET(processor, &set)) allowed_.emplace_back(processor);
+            }
+        }
+#endif
+        if (processorsOfNode_.empty()) {
+            processorsOfNode_.emplace_back();
+            for (size_t i = 0; i < nodeOfProcessor_.size(); i++) {
+                processorsOfNode_.front().emplace_back(static_cast<int>(i));
+            }
+        }
+        if (allowed_.empty()) {
+            for (size_t i = 0; i < nodeOfProcessor_.size(); i++) {
+                allowed_.emplace_back(static_cast<int>(i));
+            }
+        }
+    }
+
+    static std::string readFile(const std::string &path) {
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        return line;
+    }
+
+    /// Parses a list like "0-3,8-11" of the format used by sysfs into the numbers it includes in ascending order.
+    static std::vector<int> parseList(const std::string &list) {
+        std::vector<int> numbers;
+        size_t i = 0;
+        auto parseNumber = [&list, &i]() {
+            int number = 0;
+            for (; i < list.size() && list[i] >= '0' && list[i] <= '9'; i++) {
+                number = number * 10 + (list[i] - '0');
+            }
+            return number;
+        };
+        while (i < list.size() && list[i] >= '0' && list[i] <= '9') {
+            auto first = parseNumber();
+            auto last = first;
+            if (i < list.size() && list[i] == '-') {
+                i++;
+                last = parseNumber();
+            }
+            for (auto number = first; number <= last; number++) {
+                numbers.emplace_back(number);
+            }
+            if (i < list.size() && list[i] == ',') i++;
+        }
+        std::sort(numbers.begin(), numbers.end());
+        numbers.erase(std::unique(numbers.begin(), numbers.end()), numbers.end());
+        return numbers;
+    }
+
+    std::vector<int> nodeOfProcessor_;
+    std::vector<std::vector<int>> processorsOfNode_;
+    std::vector<int> allowed_;
+};
+
+/// Restricts the calling thread to *processors*. Returns false if this is not supported by the system or failed.
+bool pinCallingThread(const std::vector<int> &processors) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto processor : processors) {
+        if (processor < CPU_SETSIZE) CPU_SET(processor, &set);
+    }
+    return !processors.empty() && pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+/// Pins the calling thread, the *index*th of *count* threads of a pool, to the processors of a node, so that the
+/// threads are spread evenly across the nodes the process may run on, and lets it cache memory local to this node.
+/// The system places memory on the node of the thread that first touches it. Does nothing if the process only runs
+/// on one node.
+void placeWorker(size_t index, size_t count) {
+    auto &topology = Topology::shared();
+    std::vector<std::vector<int>> nodes;
+    std::vector<size_t> nodeIndices;
+    for (size_t node = 0; node < topology.nodeCount(); node++) {
+        auto processors = topology.allowedProcessorsOf(node);
+        if (processors.empty()) continue;
+        nodes.emplace_back(std::move(processors));
+        nodeIndices.emplace_back(node);
+    }
+    if (nodes.size() < 2) return;
+    auto node = index * nodes.size() / count;
+    if (pinCallingThread(nodes[node])) {
+        runtime::internal::setAllocationNode(static_cast<int>(nodeIndices[node]));
+    }
+}
+
+extern "C" runtime::Integer sThreadProcessorCount(runtime::ClassInfo *) {
+    return static_cast<runtime::Integer>(Topology::shared().processorCount());
+}
+
+extern "C" runtime::Integer sThreadNodeCount(runtime::ClassInfo *) {
+    return static_cast<runtime::Integer>(Topology::shared().nodeCount());
+}
+
+extern "C" runtime::Integer sThreadNodeOfProcessor(runtime::ClassInfo *, runtime::Integer processor) {
+    return Topology::shared().nodeOf(processor);
+}
+
+extern "C" runtime::Integer sThreadCurrentProcessor(runtime::ClassInfo *) {
+#ifdef __linux__
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+extern "C" bool sThreadPin(runtime::ClassInfo *, runtime::Integer processor) {
+    auto &topology = Topology::shared();
+    auto node = topology.nodeOf(processor);
+    if (node < 0 || !pinCallingThread({ static_cast<int>(processor) })) return false;
+    runtime::internal::setAllocationNode(static_cast<int>(node));
+    return true;
+}
+
+extern "C" bool sThreadPinNode(runtime::ClassInfo *, runtime::Integer node) {
+    auto &topology = Topology::shared();
+    if (node < 0 || static_cast<size_t>(node) >= topology.nodeCount() ||
+        !pinCallingThread(topology.processorsOf(node))) return false;
+    runtime::internal::setAllocationNode(static_cast<int>(node));
+    return true;
+}
+
+extern "C" bool sThreadUnpin(runtime::ClassInfo *) {
+    if (!pinCallingThread(Topology::shared().allowed())) return false;
+    runtime::internal::setAllocationNode(-1);
+    return true;
+}
+
+extern "C" bool sThreadSetPriority(runtime::ClassInfo *, runtime::Integer niceness) {
+#ifdef __linux__
+    // On Linux, the niceness of a thread ID only applies to this thread.
+    return setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), static_cast<int>(niceness)) == 0;
+#else
+    return false;
+#endif
+}
+
+extern "C" void sThreadSetName(runtime::ClassInfo *, String *name) {
+    auto string = name->stdString();
+    // Linux limits names to 15 bytes. The name is not cut off in the middle of a character.
+    size_t length = std::min<size_t>(string.size(), 15);
+    while (length > 0 && length < string.size() && (static_cast<uint8_t>(string[length]) & 0xC0) == 0x80) {
+        length--;
+    }
+    string.resize(length);
+#if defined(__linux__)
+    pthread_setname_np(pthread_self(), string.c_str());
+#elif defined(__APPLE__)
+    pthread_setname_np(string.c_str());
+#endif
+}
+
+using ChunkCallable = runtime::Callable<void, runtime::Integer, runtime::Integer, runtime::Integer>;
+
+/// The number of chunks per thread into which WorkerPool::run() splits work, so that threads that finish early can
+/// take over chunks from slower ones.
+constexpr runtime::Integer kChunksPerThread = 4;
+
+/// A fixed set of threads, one less than the hardware concurrency, that execute the chunks of parallel operations
+/// together with the thread that started the operation. The threads are started when the pool is first used.
+class WorkerPool {
+public:
+    static WorkerPool& shared() {
+        static WorkerPool pool;
+        return pool;
+    }
+
+    /// Returns the number of chunks into which run() splits *count* items.
+    runtime::Integer chunkCount(runtime::Integer count) const {
+        return std::max<runtime::Integer>(0, std::min(count, static_cast<runtime::Integer>(workers_.size() + 1) *
+                                                              kChunksPerThread));
+    }
+
+    /// Calls *callable* with the index, start and end of each chunk of *count* items and returns after all chunks
+    /// were processed. If the pool is already running an operation, for instance because run() is called from a
+    /// chunk, all chunks are processed on the calling thread.
+    void run(runtime::Integer count, ChunkCallable callable) {
+        auto job = std::make_shared<Job>(callable, count, chunkCount(count));
+        std::unique_lock<std::mutex> runLock(runMutex_, std::try_to_lock);
+        if (workers_.empty() || job->chunks < 2 || !runLock.owns_lock()) {
+            for (runtime::Integer i = 0; i < job->chunks; i++) {
+                job->process(i);
+            }
+            return;
+        }
+        runtime::internal::becomeMultithreaded();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = job;
+        }
+        wake_.notify_all();
+        job->work();
+        std::unique_lock<std::mutex> lock(job->mutex);
+        job->done.wait(lock, [&job] { return job->pending.load(std::memory_order_acquire) == 0; });
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto &worker : workers_) {
+            worker.join();
+        }
+    }
+
+private:
+    struct Job {
+        Job(ChunkCallable callable, runtime::Integer count, runtime::Integer chunks)
+            : callable(callable), count(count), chunks(chunks), pending(chunks) {}
+
+        /// Processes chunks until no chunk is left.
+        void work() {
+            runtime::Integer chunk;
+            while ((chunk = next.fetch_add(1, std::memory_order_relaxed)) < chunks) {
+                process(chunk);
+                if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    done.notify_all();
+                }
+            }
+        }
+
+        void process(runtime::Integer chunk) {
+            auto size = count / chunks, remainder = count % chunks;
+            auto start = chunk * size + std::min(chunk, remainder);
+            callable(chunk, start, start + size + (chunk < remainder ? 1 : 0));
+        }
+
+        ChunkCallable callable;
+        runtime::Integer count;
+        runtime::Integer chunks;
+        std::atomic<runtime::Integer> next{0};
+        std::atomic<runtime::Integer> pending;
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+
+    WorkerPool() {
+        auto threads = std::thread::hardware_concurrency();
+        for (unsigned int i = 1; i < threads; i++) {
+            workers_.emplace_back([this, i, threads] {
+                placeWorker(i - 1, threads - 1);
+                workerLoop();
+            });
+        }
+    }
+
+    void workerLoop() {
+        std::shared_ptr<Job> last;
+        while (true) {
+            std::shared_ptr<Job> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this, &last] { return stop_ || job_ != last; });
+                if (stop_) return;
+                job = last = job_;
+            }
+            job->work();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    /// Held while an operation runs so that only one operation uses the workers at a time.
+    std::mutex runMutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::shared_ptr<Job> job_;
+    bool stop_ = false;
+};
+
+extern "C" runtime::Integer sThreadChunkCount(runtime::ClassInfo *, runtime::Integer count) {
+    return WorkerPool::shared().chunkCount(count);
+}
+
+extern "C" void sThreadParallel(runtime::ClassInfo *, runtime::Integer count, ChunkCallable callable) {
+    WorkerPool::shared().run(count, callable);
+}
+
+extern "C" void sThreadArena(runtime::ClassInfo *, runtime::Callable<void> callable) {
+    runtime::internal::Arena arena;
+    arena.activate();
+    callable();
+    arena.deactivate();
+}
+
+/// Executes tasks on one thread per processor. Every thread has its own deque of tasks. Tasks submitted from a
+/// scheduler thread are pushed to the back of its deque and it takes tasks from there, so that related tasks run in
+/// succession. Threads whose deque is empty steal tasks from the front of the deques of the other threads.
+class Scheduler {
+public:
+    static Scheduler& shared() {
+        static Scheduler scheduler;
+        return scheduler;
+    }
+
+    /// Schedules *task*, which must have been retained for the scheduler, for execution.
+    void submit(Task *task) {
+        runtime::internal::becomeMultithreaded();
+        auto index = current_ >= 0 ? static_cast<size_t>(current_) :
+                next_.fetch_add(1, std::memory_order_relaxed) % deques_.size();
+        deques_[index]->pushBack(task);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queued_++;
+        }
+        wake_.notify_one();
+    }
+
+    /// Returns after *task* was executed. If called from a scheduler thread, the thread executes other tasks while
+    /// waiting so that tasks can wait for tasks they submitted.
+    void wait(Task *task) {
+        if (current_ < 0) {
+            std::unique_lock<std::mutex> lock(task->mutex);
+            task->finished.wait(lock, [task] { return task->done.load(std::memory_order_acquire); });
+            return;
+        }
+        while (!task->done.load(std::memory_order_acquire)) {
+            if (auto other = take(current_)) {
+                execute(other);
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    ~Scheduler() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto &thread : threads_) {
+            thread.join();
+        }
+    }
+
+private:
+    class Deque {
+    public:
+        void pushBack(Task *task) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(task);
+        }
+
+        Task* popBack() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (tasks_.empty()) return nullptr;
+            auto task = tasks_.back();
+            tasks_.pop_back();
+            return task;
+        }
+
+        Task* popFront() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (tasks_.empty()) return nullptr;
+            auto task = tasks_.front();
+            tasks_.pop_front();
+            return task;
+        }
+
+    private:
+        std::mutex mutex_;
+        std::deque<Task *> tasks_;
+    };
+
+    Scheduler() {
+        auto count = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int i = 0; i < count; i++) {
+            deques_.emplace_back(std::make_unique<Deque>());
+        }
+        for (unsigned int i = 0; i < count; i++) {
+            threads_.emplace_back([this, i, count] {
+                placeWorker(i, count);
+                workerLoop(i);
+            });
+        }
+    }
+
+    /// Takes a task from the back of the deque of thread *index* or steals one from the front of another deque.
+    Task* take(size_t index) {
+        auto task = deques_[index]->popBack();
+        for (size_t i = 1; task == nullptr && i < deques_.size(); i++) {
+            task = deques_[(index + i) % deques_.size()]->popFront();
+        }
+        if (task != nullptr) {
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return task;
+    }
+
+    void execute(Task *task) {
+        task->callable();
+        task->callable.release();
+        std::vector<Task *> continuations;
+        {
+            std::lock_guard<std::mutex> lock(task->mutex);
+            task->done.store(true, std::memory_order_release);
+            continuations.swap(task->continuations);
+        }
+        task->finished.notify_all();
+        for (auto continuation : continuations) {
+            submit(continuation);
+        }
+        task->release();
+    }
+
+    void workerLoop(size_t index) {
+        current_ = static_cast<std::ptrdiff_t>(index);
+        while (true) {
+            if (auto task = take(index)) {
+                execute(task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this] { return stop_ || queued_.load(std::memory_order_relaxed) > 0; });
+            if (stop_) return;
+        }
+    }
+
+    /// The index of the deque of the calling thread or -1 if it is not a scheduler thread.
+    static thread_local std::ptrdiff_t current_;
+
+    std::vector<std::unique_ptr<Deque>> deques_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> next_{0};
+    /// The number of tasks in all deques. Only incremented while mutex_ is held so that no wake-up is lost.
+    std::atomic<runtime::Integer> queued_{0};
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+};
+
+thread_local std::ptrdiff_t Scheduler::current_ = -1;
+
+Task* newTask(runtime::Callable<void> callable) {
+    auto task = Task::init();
+    callable.retain();
+    task->callable = callable;
+    task->retain();
+    return task;
+}
+
+void submitTask(Task *task) {
+    Scheduler::shared().submit(task);
+}
+
+extern "C" Task* sTaskNew(runtime::Callable<void> callable) {
+    auto task = newTask(callable);
+    submitTask(task);
+    return task;
+}
+
+extern "C" Task* sTaskNewAfter(Task *previous, runtime::Callable<void> callable) {
+    auto task = newTask(callable);
+    {
+        std::lock_guard<std::mutex> lock(previous->mutex);
+        if (!previous->done.load(std::memory_order_relaxed)) {
+            previous->continuations.push_back(task);
+            return task;
+        }
+    }
+    submitTask(task);
+    return task;
+}
+
+extern "C" void sTaskWait(Task *task) {
+    Scheduler::shared().wait(task);
+}
+
+extern "C" runtime::Boolean sTaskIsDone(Task *task) {
+    return task->done.load(std::memory_order_acquire);
+}
+
+extern "C" void sTaskDestruct(Task *task) {
+    task->~Task();
+}
+
 extern "C" Mutex* sMutexNew() {
     return Mutex::init();
 }
 
 extern "C" void sMutexLock(Mutex *mutex) {
+    for (int i = 0; i < kMutexSpins; i++) {
+        if (mutex->mutex.try_lock()) return;
+        std::this_thread::yield();
+    }
     mutex->mutex.lock();
 }
 
-extern "C" void sMutexTryLock(Mutex *mutex) {
-    mutex->mutex.try_lock();
+extern "C" runtime::Boolean sMutexTryLock(Mutex *mutex) {
+    return mutex->mutex.try_lock();
 }
 
 extern "C" void sMutexUnlock(Mutex *mutex) {
@@ -62,7 +653,133 @@ extern "C" void sMutexDestruct(Mutex *mutex) {
     mutex->~Mutex();
 }
 
+extern "C" ThreadLocal* sThreadLocalNew() {
+    return ThreadLocal::init();
+}
+
+extern "C" runtime::SimpleOptional<runtime::Object<void>*> sThreadLocalGet(ThreadLocal *local) {
+    auto object = runtime::internal::threadLocal(local->key);
+    if (object == nullptr) {
+        return runtime::NoValue;
+    }
+    object->retain();
+    return object;
+}
+
+extern "C" void sThreadLocalSet(ThreadLocal *local, runtime::Object<void> *object) {
+    object->retain();
+    auto &slot = runtime::internal::threadLocal(local->key);
+    auto old = slot;
+    slot = object;
+    if (old != nullptr) old->release();
+}
+
+/// Only the value of the calling thread can be released. The values of other threads are released when they finish.
+extern "C" void sThreadLocalDestruct(ThreadLocal *local) {
+    auto &slot = runtime::internal::threadLocal(local->key);
+    auto old = slot;
+    slot = nullptr;
+    if (old != nullptr) old->release();
+    local->~ThreadLocal();
+}
+
+extern "C" ReadWriteLock* sReadWriteLockNew() {
+    return ReadWriteLock::init();
+}
+
+extern "C" void sReadWriteLockLock(ReadWriteLock *lock) {
+    lock->mutex.lock();
+}
+
+extern "C" runtime::Boolean sReadWriteLockTryLock(ReadWriteLock *lock) {
+    return lock->mutex.try_lock();
+}
+
+extern "C" void sReadWriteLockUnlock(ReadWriteLock *lock) {
+    lock->mutex.unlock();
+}
+
+extern "C" void sReadWriteLockLockShared(ReadWriteLock *lock) {
+    lock->mutex.lock_shared();
+}
+
+extern "C" runtime::Boolean sReadWriteLockTryLockShared(ReadWriteLock *lock) {
+    return lock->mutex.try_lock_shared();
+}
+
+extern "C" void sReadWriteLockUnlockShared(ReadWriteLock *lock) {
+    lock->mutex.unlock_shared();
+}
+
+extern "C" void sReadWriteLockDestruct(ReadWriteLock *lock) {
+    lock->~ReadWriteLock();
+}
+
+extern "C" Condition* sConditionNew() {
+    return Condition::init();
+}
+
+extern "C" void sConditionWait(Condition *condition, Mutex *mutex) {
+    std::unique_lock<std::mutex> lock(mutex->mutex, std::adopt_lock);
+    condition->condition.wait(lock);
+    lock.release();
+}
+
+extern "C" runtime::Boolean sConditionWaitFor(Condition *condition, Mutex *mutex, runtime::Integer mcs) {
+    std::unique_lock<std::mutex> lock(mutex->mutex, std::adopt_lock);
+    auto status = condition->condition.wait_for(lock, std::chrono::microseconds(mcs));
+    lock.release();
+    return status == std::cv_status::no_timeout;
+}
+
+extern "C" void sConditionNotifyOne(Condition *condition) {
+    condition->condition.notify_one();
+}
+
+extern "C" void sConditionNotifyAll(Condition *condition) {
+    condition->condition.notify_all();
+}
+
+extern "C" void sConditionDestruct(Condition *condition) {
+    condition->~Condition();
+}
+
+extern "C" Semaphore* sSemaphoreNew(runtime::Integer count) {
+    auto semaphore = Semaphore::init();
+    semaphore->count = count;
+    return semaphore;
+}
+
+extern "C" void sSemaphoreWait(Semaphore *semaphore) {
+    std::unique_lock<std::mutex> lock(semaphore->mutex);
+    semaphore->available.wait(lock, [semaphore] { return semaphore->count > 0; });
+    semaphore->count--;
+}
+
+extern "C" runtime::Boolean sSemaphoreTryWait(Semaphore *semaphore) {
+    std::lock_guard<std::mutex> lock(semaphore->mutex);
+    if (semaphore->count <= 0) return false;
+    semaphore->count--;
+    return true;
+}
+
+extern "C" void sSemaphoreSignal(Semaphore *semaphore) {
+    {
+        std::lock_guard<std::mutex> lock(semaphore->mutex);
+        semaphore->count++;
+    }
+    semaphore->available.notify_one();
+}
+
+extern "C" void sSemaphoreDestruct(Semaphore *semaphore) {
+    semaphore->~Semaphore();
+}
+
 }  // namespace s
 
 SET_INFO_FOR(s::Thread, s, 1f9f5)
 SET_INFO_FOR(s::Mutex, s, 1f510)
+SET_INFO_FOR(s::ThreadLocal, s, 1f9f3_1f538_1f511)
+SET_INFO_FOR(s::ReadWriteLock, s, 1f4d6)
+SET_INFO_FOR(s::Condition, s, 1f6ce)
+SET_INFO_FOR(s::Semaphore, s, 1f6a6)
@@ -0,0 +1,218 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "../runtime/Runtime.h"
+#include "../runtime/Internal.hpp"
+#include "Task.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace s {
+
+namespace {
+
+/// Schedules tasks after a delay. The deadlines are kept in a hierarchical timer wheel with kLevels levels of kSlots
+/// slots each. A slot of level 0 holds the deadlines of one tick, a slot of level n the deadlines of kSlots^n ticks.
+/// Inserting a deadline takes constant time. Once the wheel reaches the first tick of a slot of a higher level, its
+/// deadlines are moved down to the lower levels.
+///
+/// The wheel is advanced by a thread that sleeps until the next tick at which a slot must be processed, so that no
+/// thread wakes up periodically while deadlines are far away. The thread is started when the wheel is first used.
+class TimerWheel {
+public:
+    static TimerWheel& shared() {
+        static TimerWheel wheel;
+        return wheel;
+    }
+
+    void schedule(Task *task, runtime::Integer nanoseconds) {
+        // Rounding up ensures that no task is executed before its deadline.
+        auto deadline = (now() + static_cast<uint64_t>(nanoseconds) + kTickNanoseconds - 1) >> kTickShift;
+        std::vector<Task *> expired;
+        bool wake;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            insert({deadline, task}, expired);
+            wake = wakeTick_ != 0 && deadline < wakeTick_;
+        }
+        for (auto task : expired) {
+            submitTask(task);
+        }
+        if (wake) {
+            wake_.notify_one();
+        }
+    }
+
+    ~TimerWheel() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+    }
+
+private:
+    struct Timer {
+        uint64_t tick;
+        Task *task;
+    };
+
+    static constexpr int kTickShift = 20;
+    static constexpr uint64_t kTickNanoseconds = uint64_t(1) << kTickShift;
+    static constexpr int kSlotBits = 6;
+    static constexpr uint64_t kSlots = uint64_t(1) << kSlotBits;
+    static constexpr int kLevels = 4;
+    static constexpr uint64_t kNever = std::numeric_limits<uint64_t>::max();
+
+    TimerWheel() : current_(now() >> kTickShift) {
+        // The thread submits tasks that the creating thread still references.
+        runtime::internal::becomeMultithreaded();
+        thread_ = std::thread([this] { loop(); });
+    }
+
+    static uint64_t now() {
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+    }
+
+    /// Returns the index of the slot of level *level* that contains *tick*.
+    static uint64_t slot(uint64_t tick, int level) {
+        return (tick >> (kSlotBits * level)) & (kSlots - 1);
+    }
+
+    /// Returns true if *tick* is the first tick of a slot of level *level*.
+    static bool startsSlot(uint64_t tick, int level) {
+        return (tick & ((uint64_t(1) << (kSlotBits * level)) - 1)) == 0;
+    }
+
+    /// Stores *timer* in the slot of the lowest level that can represent the distance to its deadline. Timers whose
+    /// deadline was reached are added to *expired*.
+    void insert(Timer timer, std::vector<Task *> &expired) {
+        if (timer.tick <= current_) {
+            expired.emplace_back(timer.task);
+            return;
+        }
+        auto distance = timer.tick - current_;
+        for (int level = 0; level < kLevels; level++) {
+            if (distance < uint64_t(1) << (kSlotBits * (level + 1))) {
+                slots_[level][slot(timer.tick, level)].emplace_back(timer);
+                return;
+            }
+        }
+        overflow_.emplace_back(timer);
+    }
+
+    /// Moves *timers*, the timers of a slot that starts at the current tick, down to lower levels.
+    void cascade(std::vector<Timer> &timers, std::vector<Task *> &expired) {
+        std::vector<Timer> moved;
+        moved.swap(timers);
+        for (auto &timer : moved) {
+            insert(timer, expired);
+        }
+    }
+
+    /// Returns the next tick after the current tick at which a slot must be processed or kNever.
+    uint64_t nextTick() const {
+        auto next = kNever;
+        for (int level = 0; level < kLevels; level++) {
+            auto start = current_ >> (kSlotBits * level);
+            for (uint64_t i = 1; i <= kSlots; i++) {
+                if (!slots_[level][(start + i) & (kSlots - 1)].empty()) {
+                    next = std::min(next, (start + i) << (kSlotBits * level));
+                    break;
+                }
+            }
+        }
+        if (!overflow_.empty()) {
+            auto start = current_ >> (kSlotBits * kLevels);
+            next = std::min(next, (start + 1) << (kSlotBits * kLevels));
+        }
+        return next;
+    }
+
+    /// Processes all slots up to *tick* and adds the tasks whose deadline was reached to *expired*.
+    void advance(uint64_t tick, std::vector<Task *> &expired) {
+        for (auto next = nextTick(); next <= tick; next = nextTick()) {
+            current_ = next;
+            if (startsSlot(current_, kLevels)) {
+                cascade(overflow_, expired);
+            }
+            // Higher levels first, as their timers can move into the slots of the lower levels that start now.
+            for (int level = kLevels - 1; level > 0; level--) {
+                if (startsSlot(current_, level)) {
+                    cascade(slots_[level][slot(current_, level)], expired);
+                }
+            }
+            for (auto &timer : slots_[0][slot(current_, 0)]) {
+                expired.emplace_back(timer.task);
+            }
+            slots_[0][slot(current_, 0)].clear();
+        }
+        current_ = std::max(current_, tick);
+    }
+
+    void loop() {
+        std::vector<Task *> expired;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_) {
+            advance(now() >> kTickShift, expired);
+            if (!expired.empty()) {
+                lock.unlock();
+                for (auto task : expired) {
+                    submitTask(task);
+                }
+                expired.clear();
+                lock.lock();
+                continue;
+            }
+            wakeTick_ = nextTick();
+            if (wakeTick_ == kNever) {
+                wake_.wait(lock);
+            }
+            else {
+                auto deadline = std::chrono::nanoseconds(wakeTick_ << kTickShift);
+                wake_.wait_until(lock, std::chrono::steady_clock::time_point(
+                        std::chrono::duration_cast<std::chrono::steady_clock::duration>(deadline)));
+            }
+            wakeTick_ = 0;
+        }
+    }
+
+    std::vector<Timer> slots_[kLevels][kSlots];
+    /// Timers whose deadline is too far away for the highest level.
+    std::vector<Timer> overflow_;
+    /// The tick up to which all slots were processed.
+    uint64_t current_;
+    /// The tick until which the thread sleeps or 0 if it is awake. Deadlines before it must wake the thread.
+    uint64_t wakeTick_ = 0;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+}  // namespace
+
+void submitTaskAfter(Task *task, runtime::Integer nanoseconds) {
+    if (nanoseconds <= 0) {
+        submitTask(task);
+        return;
+    }
+    TimerWheel::shared().schedule(task, nanoseconds);
+}
+
+extern "C" Task* sTaskNewDelayed(runtime::ClassInfo *, runtime::Integer nanoseconds, runtime::Callable<void> callable) {
+    auto task = newTask(callable);
+    submitTaskAfter(task, nanoseconds);
+    return task;
+}
+
+}  // namespace s
@@ -0,0 +1,33 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "../runtime/Runtime.h"
+#include "../runtime/Tracer.hpp"
+#include "String.h"
+
+using s::String;
+
+extern "C" runtime::Boolean sTracingStart(String *path) {
+    return runtime::internal::startTracing(path->stdString().c_str());
+}
+
+extern "C" void sTracingStop() {
+    runtime::internal::stopTracing();
+}
+
+extern "C" void sTracingBegin(String *name) {
+    runtime::internal::traceBegin(name->bytes(), name->count);
+}
+
+extern "C" void sTracingEnd() {
+    runtime::internal::traceEnd();
+}
+
+extern "C" void sTracingArgument(String *key, String *value) {
+    runtime::internal::traceArgument(key->bytes(), key->count, value->bytes(), value->count);
+}
+
+extern "C" void sTracingInstant(String *name) {
+    runtime::internal::traceInstant(name->bytes(), name->count);
+}
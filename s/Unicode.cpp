@@ -0,0 +1,131 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "Unicode.h"
+#include "UnicodeTables.h"
+#include "utf8proc.h"
+
+namespace s {
+
+namespace {
+
+/// Implements the rules of UAX #29 that can be decided from the classes of two code points like
+/// grapheme_break_simple() in utf8proc.c.
+bool isBreak(int previous, int next) {
+    if (previous == UTF8PROC_BOUNDCLASS_START) return true;  // GB1
+    if (previous == UTF8PROC_BOUNDCLASS_CR && next == UTF8PROC_BOUNDCLASS_LF) return false;  // GB3
+    if (previous >= UTF8PROC_BOUNDCLASS_CR && previous <= UTF8PROC_BOUNDCLASS_CONTROL) return true;  // GB4
+    if (next >= UTF8PROC_BOUNDCLASS_CR && next <= UTF8PROC_BOUNDCLASS_CONTROL) return true;  // GB5
+    switch (previous) {
+        case UTF8PROC_BOUNDCLASS_L:  // GB6
+            if (next == UTF8PROC_BOUNDCLASS_L || next == UTF8PROC_BOUNDCLASS_V || next == UTF8PROC_BOUNDCLASS_LV ||
+                next == UTF8PROC_BOUNDCLASS_LVT) return false;
+            break;
+        case UTF8PROC_BOUNDCLASS_LV:  // GB7
+        case UTF8PROC_BOUNDCLASS_V:
+            if (next == UTF8PROC_BOUNDCLASS_V || next == UTF8PROC_BOUNDCLASS_T) return false;
+            break;
+        case UTF8PROC_BOUNDCLASS_LVT:  // GB8
+        case UTF8PROC_BOUNDCLASS_T:
+            if (next == UTF8PROC_BOUNDCLASS_T) return false;
+            break;
+    }
+    if (next == UTF8PROC_BOUNDCLASS_EXTEND || next == UTF8PROC_BOUNDCLASS_ZWJ ||  // GB9
+        next == UTF8PROC_BOUNDCLASS_SPACINGMARK || previous == UTF8PROC_BOUNDCLASS_PREPEND) return false;  // GB9a/b
+    if (previous == UTF8PROC_BOUNDCLASS_E_ZWG && next == UTF8PROC_BOUNDCLASS_EXTENDED_PICTOGRAPHIC) return false;
+    if (previous == UTF8PROC_BOUNDCLASS_REGIONAL_INDICATOR && next == UTF8PROC_BOUNDCLASS_REGIONAL_INDICATOR) {
+        return false;  // GB12/13
+    }
+    return true;  // GB999
+}
+
+int32_t asciiBoundclass(int32_t c) {
+    if (c == '\r') return UTF8PROC_BOUNDCLASS_CR;
+    if (c == '\n') return UTF8PROC_BOUNDCLASS_LF;
+    if (c < 0x20 || c == 0x7F) return UTF8PROC_BOUNDCLASS_CONTROL;
+    return UTF8PROC_BOUNDCLASS_OTHER;
+}
+
+}  // namespace
+
+const CodepointProperties& codepointProperties(int32_t codepoint) {
+    if (static_cast<uint32_t>(codepoint) >= 0x110000) {
+        codepoint = 0x10FFFF;  // Like all unassigned code points
+    }
+    auto block = unicode::kStage1[codepoint >> unicode::kBlockShift];
+    auto index = (static_cast<size_t>(block) << unicode::kBlockShift) | (codepoint & ((1 << unicode::kBlockShift) - 1));
+    return unicode::kProperties[unicode::kStage2[index]];
+}
+
+int32_t toLowercase(int32_t c) {
+    if (c < 0x80) return 'A' <= c && c <= 'Z' ? c + 0x20 : c;
+    if (c < 0x100) return 0xC0 <= c && c <= 0xDE && c != 0xD7 ? c + 0x20 : c;
+    return c + codepointProperties(c).lowercase;
+}
+
+int32_t toUppercase(int32_t c) {
+    if (c < 0x80) return 'a' <= c && c <= 'z' ? c - 0x20 : c;
+    if (c < 0x100) {
+        if (0xE0 <= c && c <= 0xFE && c != 0xF7) return c - 0x20;
+        if (c == 0xFF) return 0x178;  // ÿ → Ÿ
+        if (c == 0xB5) return 0x39C;  // µ → Μ
+        if (c == 0xDF) return 0x1E9E;  // ß → ẞ like utf8proc
+        return c;
+    }
+    return c + codepointProperties(c).uppercase;
+}
+
+bool isGraphemeBreak(int32_t previous, int32_t codepoint, int32_t *state) {
+    if ((previous | codepoint) < 0x80) {
+        // The state before an ASCII character can only be its own class, so that it need not be considered.
+        *state = asciiBoundclass(codepoint);
+        return previous != '\r' || codepoint != '\n';
+    }
+
+    int previousClass = *state != UTF8PROC_BOUNDCLASS_START ? *state : codepointProperties(previous).boundclass;
+    int nextClass = codepointProperties(codepoint).boundclass;
+    auto isBreakPermitted = isBreak(previousClass, nextClass);
+    if (*state == nextClass && nextClass == UTF8PROC_BOUNDCLASS_REGIONAL_INDICATOR) {
+        // Forces a break after a pair of regional indicators by GB999.
+        *state = UTF8PROC_BOUNDCLASS_OTHER;
+    }
+    else if (*state == UTF8PROC_BOUNDCLASS_EXTENDED_PICTOGRAPHIC) {
+        // Keeps track of emoji followed by extending code points and a ZWJ for GB11.
+        if (nextClass == UTF8PROC_BOUNDCLASS_EXTEND) *state = UTF8PROC_BOUNDCLASS_EXTENDED_PICTOGRAPHIC;
+        else if (nextClass == UTF8PROC_BOUNDCLASS_ZWJ) *state = UTF8PROC_BOUNDCLASS_E_ZWG;
+        else *state = nextClass;
+    }
+    else {
+        *state = nextClass;
+    }
+    return isBreakPermitted;
+}
+
+QuickCheck nfcQuickCheck(const uint8_t *bytes, size_t count) {
+    auto result = QuickCheck::Yes;
+    uint8_t lastCombiningClass = 0;
+    for (size_t i = 0; i < count;) {
+        if (bytes[i] < 0xCC) {
+            // All code points below U+0300 have the combining class 0 and are in NFC.
+            lastCombiningClass = 0;
+            i++;
+            while (i < count && (bytes[i] & 0xC0) == 0x80) i++;
+            continue;
+        }
+        utf8proc_int32_t codepoint;
+        auto length = utf8proc_iterate(bytes + i, count - i, &codepoint);
+        if (length < 0) return QuickCheck::Maybe;
+        i += length;
+        auto &properties = codepointProperties(codepoint);
+        if (properties.combiningClass != 0 && lastCombiningClass > properties.combiningClass) {
+            return QuickCheck::No;
+        }
+        if (properties.flags & kNfcNo) return QuickCheck::No;
+        if (properties.flags & kNfcMaybe) result = QuickCheck::Maybe;
+        lastCombiningClass = properties.combiningClass;
+    }
+    return result;
+}
+
+}  // namespace s
@@ -0,0 +1,52 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#ifndef EMOJICODE_UNICODE_H
+#define EMOJICODE_UNICODE_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace s {
+
+/// The properties of a code point that s uses, looked up in the two-stage tables generated into UnicodeTables.h by
+/// tools/unicodetables.cpp. utf8proc is only consulted for the full normalization of strings.
+struct CodepointProperties {
+    /// The grapheme cluster break class, numbered like UTF8PROC_BOUNDCLASS_*.
+    uint8_t boundclass;
+    uint8_t combiningClass;
+    /// A combination of kNfcMaybe or kNfcNo and kWhitespace.
+    uint8_t flags;
+    /// The difference between the simple lowercase mapping of the code point and the code point.
+    int32_t lowercase;
+    /// The difference between the simple uppercase mapping of the code point and the code point.
+    int32_t uppercase;
+};
+
+constexpr uint8_t kNfcMaybe = 1;
+constexpr uint8_t kNfcNo = 2;
+/// Set if the bidirectional class of the code point is WS.
+constexpr uint8_t kWhitespace = 4;
+
+const CodepointProperties& codepointProperties(int32_t codepoint);
+
+/// Returns the simple lowercase mapping of `codepoint`. ASCII and Latin-1 code points are mapped without a lookup.
+int32_t toLowercase(int32_t codepoint);
+/// Returns the simple uppercase mapping of `codepoint`. ASCII and Latin-1 code points are mapped without a lookup.
+int32_t toUppercase(int32_t codepoint);
+
+/// Returns true if there is a grapheme cluster boundary between `previous` and `codepoint`. Works exactly like
+/// utf8proc_grapheme_break_stateful(), including the values stored in `state`, which must be 0 at the beginning of a
+/// string, but decides between ASCII characters without a lookup.
+bool isGraphemeBreak(int32_t previous, int32_t codepoint, int32_t *state);
+
+enum class QuickCheck { Yes, Maybe, No };
+
+/// Checks whether the `count` bytes of valid UTF-8 at `bytes` are in Normalization Form C with the quick check
+/// algorithm of UAX #15. If the answer is QuickCheck::Maybe, only normalizing the string can tell.
+QuickCheck nfcQuickCheck(const uint8_t *bytes, size_t count);
+
+}  // namespace s
+
+#endif //EMOJICODE_UNICODE_H
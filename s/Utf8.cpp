@@ -0,0 +1,82 @@
+//
+// Created by Theo Weidmann on 14.10.26.
+//
+
+#include "Utf8.h"
+#include "../runtime/Runtime.h"
+#include <cstdint>
+#include <cstring>
+
+namespace s {
+
+namespace {
+
+constexpr uint64_t kHighBits = 0x8080808080808080ull;
+
+/// Checks the multi-byte sequence beginning at `bytes` with the lead byte `lead`.
+/// @returns The length of the sequence or 0 if it is invalid.
+size_t sequenceLength(const uint8_t *bytes, size_t available, uint8_t lead) {
+    size_t length;
+    uint8_t min = 0x80, max = 0xBF;
+    if (lead < 0xC2) {
+        return 0;  // A continuation byte or the lead byte of an overlong encoding of an ASCII character
+    }
+    if (lead < 0xE0) {
+        length = 2;
+    }
+    else if (lead < 0xF0) {
+        length = 3;
+        if (lead == 0xE0) min = 0xA0;  // Overlong encodings
+        else if (lead == 0xED) max = 0x9F;  // Surrogates
+    }
+    else if (lead < 0xF5) {
+        length = 4;
+        if (lead == 0xF0) min = 0x90;  // Overlong encodings
+        else if (lead == 0xF4) max = 0x8F;  // Code points above U+10FFFF
+    }
+    else {
+        return 0;
+    }
+
+    if (available < length || bytes[1] < min || bytes[1] > max) {
+        return 0;
+    }
+    for (size_t i = 2; i < length; i++) {
+        if ((bytes[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+    }
+    return length;
+}
+
+}  // namespace
+
+EJC_MULTIVERSIONED bool validateUtf8(const char *chars, size_t count, bool *ascii) {
+    auto bytes = reinterpret_cast<const uint8_t *>(chars);
+    bool onlyAscii = true;
+    size_t i = 0;
+    while (i < count) {
+        if (i + 8 <= count) {
+            uint64_t word;
+            std::memcpy(&word, bytes + i, sizeof(word));
+            if ((word & kHighBits) == 0) {
+                i += 8;
+                continue;
+            }
+        }
+        if (bytes[i] < 0x80) {
+            i++;
+            continue;
+        }
+        onlyAscii = false;
+        auto length = sequenceLength(bytes + i, count - i, bytes[i]);
+        if (length == 0) {
+            return false;
+        }
+        i += length;
+    }
+    *ascii = onlyAscii;
+    return true;
+}
+
+}  // namespace s
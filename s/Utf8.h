@@ -0,0 +1,21 @@
+//
+// Created by Theo Weidmann on 14.10.26.
+//
+
+#ifndef EMOJICODE_UTF8_HPP
+#define EMOJICODE_UTF8_HPP
+
+#include <cstddef>
+
+namespace s {
+
+/// Returns true if the `count` bytes at `bytes` are valid UTF-8, i.e. they do not contain overlong encodings, encoded
+/// surrogates, code points above U+10FFFF or truncated sequences. If they are valid, whether they consist of ASCII
+/// characters only is stored in `ascii`.
+///
+/// ASCII characters, which make up most text, are checked eight bytes at a time.
+bool validateUtf8(const char *bytes, size_t count, bool *ascii);
+
+}  // namespace s
+
+#endif //EMOJICODE_UTF8_HPP
@@ -3,17 +3,43 @@
 //
 
 #include "../runtime/Runtime.h"
+#include "../runtime/Internal.hpp"
 #include "../s/Data.h"
 #include "../s/String.h"
 #include "../s/Error.h"
+#include "../s/Task.h"
+#include "../s/IoUring.hpp"
+#include <algorithm>
 #include <arpa/inet.h>
 #include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstddef>
 #include <csignal>
 #include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <mutex>
 #include <netdb.h>
+#include <poll.h>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/sendfile.h>
+#else
+#include <sys/event.h>
+#endif
 #include <unistd.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 
 using s::String;
 using s::Data;
@@ -25,26 +51,503 @@ public:
     int socket_;
 };
 
+/// A 📬, which is declared in Emojicode. The layout must match the instance variables declared there.
+class Buffer : public runtime::Object<Buffer> {
+public:
+    runtime::MemoryPointer<runtime::Byte> data;
+    runtime::Integer count;
+    runtime::Integer capacity;
+    /// The address of the sender of the datagram last received into this buffer.
+    runtime::MemoryPointer<sockaddr_storage> peer;
+    runtime::Integer peerLength;
+};
+
+static_assert(sizeof(sockaddr_storage) <= 128, "📬 allocates 128 bytes for the peer address.");
+
+class Datagram : public runtime::Object<Datagram> {
+public:
+    int socket_;
+};
+
 class Server : public runtime::Object<Server> {
 public:
     int socket_;
+    /// Buffers returned with 📥, each of which holds a reference. Guarded by poolMutex_.
+    std::vector<Buffer *> pool_;
+    std::mutex poolMutex_;
+    /// Whether TCP_NODELAY is set on accepted sockets.
+    bool noDelay_ = false;
 };
 
+/// Waits on a single thread for any number of sockets to become ready and for timers to expire and then submits the
+/// tasks waiting for them to the scheduler of s, so that many operations can be in flight without a blocked thread
+/// for each of them.
+///
+/// Descriptors are watched with io_uring on Linux, falling back to epoll if io_uring is not available, and with
+/// kqueue on other platforms. Every descriptor is registered as one shot and only re-armed while tasks are waiting
+/// for it, so that a wait costs time proportional to the number of ready descriptors rather than the number of
+/// watched ones. With io_uring, the descriptors re-armed after a wakeup are submitted in a single system call.
+class Reactor {
+public:
+    static Reactor& shared() {
+        static Reactor reactor;
+        return reactor;
+    }
+
+    /// Submits *task*, which was created by s::newTask(), once *descriptor* is ready for *events*, which is a
+    /// combination of POLLIN and POLLOUT.
+    void watch(int descriptor, short events, s::Task *task) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto &entry = watches_[descriptor];
+        entry.watches.emplace_back(Watch{events, task});
+        if ((events & ~entry.armed) != 0) {
+            entry.armed |= events;
+            arm(descriptor, entry.armed);
+            submit();
+        }
+    }
+
+    /// Submits *task*, which was created by s::newTask(), once *milliseconds* have passed.
+    void after(runtime::Integer milliseconds, s::Task *task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            timers_.push(Timer{Clock::now() + std::chrono::milliseconds(std::max<runtime::Integer>(0, milliseconds)),
+                               task});
+        }
+        wake();
+    }
+
+    ~Reactor() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake();
+        thread_.join();
+        if (wakePipe_[0] != -1) {
+            close(wakePipe_[0]);
+            close(wakePipe_[1]);
+        }
+        if (queue_ != -1) {
+            close(queue_);
+        }
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Watch {
+        short events;
+        s::Task *task;
+    };
+
+    struct Entry {
+        std::vector<Watch> watches;
+        /// The events for which the descriptor is currently registered.
+        short armed = 0;
+    };
+
+    struct Timer {
+        Clock::time_point deadline;
+        s::Task *task;
+
+        bool operator>(const Timer &other) const { return deadline > other.deadline; }
+    };
+
+    Reactor() {
+#ifdef __linux__
+        usesRing_ = ring_.init(kMaxEvents);
+        if (!usesRing_) {
+            openQueue();
+        }
+#else
+        openQueue();
+#endif
+        // The thread submits tasks that the creating thread still references.
+        runtime::internal::becomeMultithreaded();
+        thread_ = std::thread([this] { loop(); });
+    }
+
+    /// Creates the epoll or kqueue instance and registers a pipe with it that is used to wake the reactor thread.
+    void openQueue() {
+        if (pipe(wakePipe_) == -1) {
+            wakePipe_[0] = wakePipe_[1] = -1;
+        }
+        fcntl(wakePipe_[0], F_SETFL, O_NONBLOCK);
+#ifdef __linux__
+        queue_ = epoll_create1(EPOLL_CLOEXEC);
+        epoll_event event{};
+        event.events = static_cast<uint32_t>(EPOLLIN);
+        event.data.fd = wakePipe_[0];
+        epoll_ctl(queue_, EPOLL_CTL_ADD, wakePipe_[0], &event);
+#else
+        queue_ = kqueue();
+        struct kevent event{};
+        EV_SET(&event, wakePipe_[0], EVFILT_READ, EV_ADD, 0, 0, nullptr);
+        kevent(queue_, &event, 1, nullptr, 0, nullptr);
+#endif
+    }
+
+    void wake() {
+#ifdef __linux__
+        if (usesRing_) {
+            // A no-op completes immediately and thereby ends the wait of the reactor thread.
+            std::lock_guard<std::mutex> lock(mutex_);
+            ring_.prepare()->opcode = IORING_OP_NOP;
+            submit();
+            return;
+        }
+#endif
+        char byte = 0;
+        write(wakePipe_[1], &byte, 1);
+    }
+
+    /// Registers *descriptor* to be reported once when it is ready for *events*. Must be called with mutex_ locked.
+    void arm(int descriptor, short events) {
+#ifdef __linux__
+        if (usesRing_) {
+            auto sqe = ring_.prepare();
+            sqe->opcode = IORING_OP_POLL_ADD;
+            sqe->fd = descriptor;
+            sqe->poll32_events = static_cast<unsigned>(events);
+            sqe->user_data = static_cast<uint64_t>(descriptor) + 1;
+            return;
+        }
+        epoll_event event{};
+        event.events = static_cast<uint32_t>(EPOLLONESHOT);
+        if ((events & POLLIN) != 0) event.events |= static_cast<uint32_t>(EPOLLIN);
+        if ((events & POLLOUT) != 0) event.events |= static_cast<uint32_t>(EPOLLOUT);
+        event.data.fd = descriptor;
+        // A descriptor that was closed and reopened is no longer registered, the closed one was removed implicitly.
+        if (epoll_ctl(queue_, EPOLL_CTL_MOD, descriptor, &event) == -1 && errno == ENOENT) {
+            epoll_ctl(queue_, EPOLL_CTL_ADD, descriptor, &event);
+        }
+#else
+        struct kevent changes[2];
+        int count = 0;
+        if ((events & POLLIN) != 0) {
+            EV_SET(&changes[count++], descriptor, EVFILT_READ, EV_ADD | EV_ONESHOT, 0, 0, nullptr);
+        }
+        if ((events & POLLOUT) != 0) {
+            EV_SET(&changes[count++], descriptor, EVFILT_WRITE, EV_ADD | EV_ONESHOT, 0, 0, nullptr);
+        }
+        kevent(queue_, changes, count, nullptr, 0, nullptr);
+#endif
+    }
+
+    /// Submits the registrations prepared by arm() if io_uring is used. Must be called with mutex_ locked.
+    void submit() {
+#ifdef __linux__
+        if (usesRing_) {
+            ring_.submit();
+        }
+#endif
+    }
+
+    /// Submits the tasks waiting for *descriptor*, which is ready for *events*, and re-arms it for the remaining
+    /// tasks. Errors and hang-ups are reported as readiness, the operation performed by the task then fails. Must be
+    /// called with mutex_ locked.
+    void ready(int descriptor, short events) {
+        auto it = watches_.find(descriptor);
+        if (it == watches_.end()) {
+            return;
+        }
+        auto &entry = it->second;
+        short remaining = 0;
+        size_t kept = 0;
+        for (auto &watch : entry.watches) {
+            if ((watch.events & events) != 0) {
+                s::submitTask(watch.task);
+            }
+            else {
+                remaining |= watch.events;
+                entry.watches[kept++] = watch;
+            }
+        }
+        entry.watches.resize(kept);
+        entry.armed = remaining;
+        if (kept == 0) {
+            watches_.erase(it);
+        }
+        else {
+            arm(descriptor, remaining);
+        }
+    }
+
+    /// Submits all expired timers and returns the number of milliseconds until the next one expires or -1.
+    int expireTimers() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto now = Clock::now();
+        while (!timers_.empty() && timers_.top().deadline <= now) {
+            s::submitTask(timers_.top().task);
+            timers_.pop();
+        }
+        if (timers_.empty()) {
+            return -1;
+        }
+        auto remaining = std::chrono::ceil<std::chrono::milliseconds>(timers_.top().deadline - now).count();
+        return static_cast<int>(std::min<decltype(remaining)>(remaining, std::numeric_limits<int>::max()));
+    }
+
+    void loop() {
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (stop_) return;
+            }
+            auto timeout = expireTimers();
+#ifdef __linux__
+            if (usesRing_) {
+                if (ring_.wait(timeout) < 0 && errno != EINTR) {
+                    return;
+                }
+                std::lock_guard<std::mutex> lock(mutex_);
+                ring_.reap([this](const io_uring_cqe &cqe) {
+                    if (cqe.user_data != 0) {
+                        auto events = cqe.res < 0 ? POLLIN | POLLOUT : cqe.res;
+                        if ((events & (POLLERR | POLLHUP)) != 0) events |= POLLIN | POLLOUT;
+                        ready(static_cast<int>(cqe.user_data - 1), static_cast<short>(events));
+                    }
+                });
+                submit();
+                continue;
+            }
+            epoll_event events[kMaxEvents];
+            auto count = epoll_wait(queue_, events, kMaxEvents, timeout);
+#else
+            struct kevent events[kMaxEvents];
+            timespec timeoutSpec{timeout / 1000, (timeout % 1000) * 1000000};
+            auto count = kevent(queue_, nullptr, 0, events, kMaxEvents, timeout < 0 ? nullptr : &timeoutSpec);
+#endif
+            if (count == -1) {
+                if (errno == EINTR) continue;
+                return;
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (int i = 0; i < count; i++) {
+#ifdef __linux__
+                auto descriptor = events[i].data.fd;
+                short ready = 0;
+                if ((events[i].events & static_cast<uint32_t>(EPOLLIN | EPOLLERR | EPOLLHUP)) != 0) ready |= POLLIN;
+                if ((events[i].events & static_cast<uint32_t>(EPOLLOUT | EPOLLERR | EPOLLHUP)) != 0) ready |= POLLOUT;
+#else
+                auto descriptor = static_cast<int>(events[i].ident);
+                short ready = events[i].filter == EVFILT_WRITE ? POLLOUT : POLLIN;
+                if ((events[i].flags & (EV_EOF | EV_ERROR)) != 0) ready = POLLIN | POLLOUT;
+#endif
+                if (descriptor == wakePipe_[0]) {
+                    char buffer[64];
+                    while (read(wakePipe_[0], buffer, sizeof(buffer)) > 0) {}
+                    continue;
+                }
+                this->ready(descriptor, ready);
+            }
+        }
+    }
+
+    static constexpr int kMaxEvents = 256;
+
+    int wakePipe_[2] = {-1, -1};
+    int queue_ = -1;
+#ifdef __linux__
+    s::IoUring ring_;
+    bool usesRing_ = false;
+#endif
+    std::thread thread_;
+    std::mutex mutex_;
+    std::unordered_map<int, Entry> watches_;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<>> timers_;
+    bool stop_ = false;
+};
+
+/// Caches the addresses of hosts so that connecting to the same host repeatedly does not resolve its name every time.
+/// getaddrinfo() does not report the TTL of the records, so entries expire after a fixed time.
+class ResolverCache {
+public:
+    static ResolverCache& shared() {
+        static ResolverCache cache;
+        return cache;
+    }
+
+    /// Returns the addresses of *host* for *port*, IPv6 and IPv4 addresses alternating as recommended by RFC 8305.
+    /// Returns an empty vector and sets errno if the host cannot be resolved.
+    std::vector<sockaddr_storage> resolve(const std::string &host, runtime::Integer port) {
+        auto key = host + ":" + std::to_string(port);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = entries_.find(key);
+            if (it != entries_.end() && it->second.expiry > std::chrono::steady_clock::now()) {
+                return it->second.addresses;
+            }
+        }
+
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_ADDRCONFIG;
+        addrinfo *result = nullptr;
+        if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &result) != 0) {
+            errno = EHOSTUNREACH;
+            return {};
+        }
+        std::vector<sockaddr_storage> v6, v4;
+        for (auto info = result; info != nullptr; info = info->ai_next) {
+            sockaddr_storage address{};
+            std::memcpy(&address, info->ai_addr, info->ai_addrlen);
+            (info->ai_family == AF_INET6 ? v6 : v4).push_back(address);
+        }
+        freeaddrinfo(result);
+
+        std::vector<sockaddr_storage> addresses;
+        for (size_t i = 0; i < std::max(v6.size(), v4.size()); i++) {
+            if (i < v6.size()) addresses.push_back(v6[i]);
+            if (i < v4.size()) addresses.push_back(v4[i]);
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_[key] = Entry{std::chrono::steady_clock::now() + kTimeToLive, addresses};
+        return addresses;
+    }
+
+private:
+    static constexpr std::chrono::seconds kTimeToLive{30};
+
+    struct Entry {
+        std::chrono::steady_clock::time_point expiry;
+        std::vector<sockaddr_storage> addresses;
+    };
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+};
+
+socklen_t addressLength(const sockaddr_storage &address) {
+    return address.ss_family == AF_INET6 ? sizeof(sockaddr_in6) : sizeof(sockaddr_in);
+}
+
+/// Connects to the first of *addresses* that accepts the connection. As described by RFC 8305, an attempt to connect
+/// to the next address is started whenever an attempt has not succeeded within 250 milliseconds, while the earlier
+/// attempts continue. Returns the connected descriptor or -1.
+int connectHappyEyeballs(const std::vector<sockaddr_storage> &addresses) {
+    constexpr int kAttemptDelay = 250;
+    std::vector<pollfd> attempts;
+    size_t next = 0;
+    int connected = -1;
+    int error = ECONNREFUSED;
+    while (connected == -1 && (next < addresses.size() || !attempts.empty())) {
+        if (next < addresses.size()) {
+            auto &address = addresses[next++];
+            int descriptor = socket(address.ss_family, SOCK_STREAM, 0);
+            if (descriptor != -1) {
+                fcntl(descriptor, F_SETFL, fcntl(descriptor, F_GETFL) | O_NONBLOCK);
+                if (connect(descriptor, reinterpret_cast<const sockaddr *>(&address), addressLength(address)) == 0) {
+                    connected = descriptor;
+                    break;
+                }
+                if (errno == EINPROGRESS) {
+                    attempts.push_back(pollfd{descriptor, POLLOUT, 0});
+                }
+                else {
+                    error = errno;
+                    close(descriptor);
+                }
+            }
+        }
+        if (attempts.empty()) {
+            continue;
+        }
+        auto ready = poll(attempts.data(), attempts.size(), next < addresses.size() ? kAttemptDelay : -1);
+        if (ready == -1 && errno != EINTR) {
+            error = errno;
+            break;
+        }
+        size_t kept = 0;
+        for (auto &attempt : attempts) {
+            if (attempt.revents == 0 || connected != -1) {
+                attempts[kept++] = attempt;
+                continue;
+            }
+            int result = 0;
+            socklen_t length = sizeof(result);
+            getsockopt(attempt.fd, SOL_SOCKET, SO_ERROR, &result, &length);
+            if (result == 0) {
+                connected = attempt.fd;
+            }
+            else {
+                error = result;
+                close(attempt.fd);
+            }
+        }
+        attempts.resize(kept);
+    }
+    for (auto &attempt : attempts) {
+        close(attempt.fd);
+    }
+    if (connected == -1) {
+        errno = error;
+        return -1;
+    }
+    fcntl(connected, F_SETFL, fcntl(connected, F_GETFL) & ~O_NONBLOCK);
+    return connected;
+}
+
+/// Stores the Unix domain socket address for *path* in *address* and its length in *length*. A path starting with @
+/// denotes a name in the abstract namespace of Linux, which is not visible in the file system and disappears once no
+/// socket is bound to it anymore. Returns false and sets errno if *path* cannot be used as an address.
+bool localAddress(String *path, sockaddr_un *address, socklen_t *length) {
+    auto string = path->stdString();
+    *address = sockaddr_un{};
+    address->sun_family = AF_UNIX;
+    bool abstract = !string.empty() && string[0] == '@';
+#ifndef __linux__
+    if (abstract) {
+        errno = EAFNOSUPPORT;
+        return false;
+    }
+#endif
+    // Names in the abstract namespace are not terminated, all others must leave room for the terminating null.
+    if (string.empty() || string.size() + (abstract ? 0 : 1) > sizeof(address->sun_path)) {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    std::memcpy(address->sun_path, string.data(), string.size());
+    if (abstract) {
+        address->sun_path[0] = '\0';
+    }
+    *length = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + string.size() + (abstract ? 0 : 1));
+    return true;
+}
+
+/// Creates a Unix domain socket of *type* bound to *path*. A socket left at *path* by a process that did not remove
+/// it is removed first, other files are not. Returns the descriptor or -1.
+int bindLocal(String *path, int type) {
+    sockaddr_un address{};
+    socklen_t length;
+    if (!localAddress(path, &address, &length)) {
+        return -1;
+    }
+    int descriptor = socket(AF_UNIX, type, 0);
+    if (descriptor == -1) {
+        return -1;
+    }
+    struct stat status{};
+    if (address.sun_path[0] != '\0' && lstat(address.sun_path, &status) == 0 && S_ISSOCK(status.st_mode)) {
+        unlink(address.sun_path);
+    }
+    if (bind(descriptor, reinterpret_cast<sockaddr *>(&address), length) == -1) {
+        close(descriptor);
+        return -1;
+    }
+    return descriptor;
+}
+
 extern "C" Socket* socketsSocketNewHost(String *host, runtime::Integer port, runtime::Raiser *raiser) {
-    struct hostent *server = gethostbyname(host->stdString().c_str());
-    if (server == nullptr) {
+    auto addresses = ResolverCache::shared().resolve(host->stdString(), port);
+    if (addresses.empty()) {
         EJC_RAISE(raiser, s::IOError::init());
     }
 
-    struct sockaddr_in address{};
-    std::memset(&address, 0, sizeof(address));
-    std::memcpy(&address.sin_addr.s_addr, server->h_addr_list[0], server->h_length);
-    address.sin_family = PF_INET;
-    address.sin_port = htons(port);
-
-    int socketDescriptor = socket(AF_INET, SOCK_STREAM, 0);
-    if (socketDescriptor == -1 || connect(socketDescriptor, reinterpret_cast<struct sockaddr *>(&address),
-                                          sizeof(address)) == -1) {
+    int socketDescriptor = connectHappyEyeballs(addresses);
+    if (socketDescriptor == -1) {
         EJC_RAISE(raiser, s::IOError::init());
     }
 
@@ -53,12 +556,119 @@ extern "C" Socket* socketsSocketNewHost(String *host, runtime::Integer port, run
     return socket;
 }
 
+extern "C" Socket* socketsSocketNewLocal(String *path, runtime::Raiser *raiser) {
+    sockaddr_un address{};
+    socklen_t length;
+    if (!localAddress(path, &address, &length)) {
+        EJC_RAISE(raiser, s::IOError::init());
+    }
+    int descriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (descriptor == -1) {
+        EJC_RAISE(raiser, s::IOError::init());
+    }
+    if (connect(descriptor, reinterpret_cast<sockaddr *>(&address), length) == -1) {
+        close(descriptor);
+        EJC_RAISE(raiser, s::IOError::init());
+    }
+    auto socket = Socket::init();
+    socket->socket_ = descriptor;
+    return socket;
+}
+
 extern "C" void socketsSocketClose(Socket *socket) {
-    close(socket->socket_);
+    // The deinitializer closes the socket too, which must not close a descriptor that was reused in the meantime.
+    if (socket->socket_ != -1) {
+        close(socket->socket_);
+        socket->socket_ = -1;
+    }
+}
+
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+/// Sends the bytes described by *vectors* with as few calls to sendmsg as possible, continuing after partial writes
+/// and interruptions. *vectors* is modified. Returns false if an error occurred.
+bool sendVectors(int socket, std::vector<iovec> &vectors) {
+    size_t first = 0;
+    while (first < vectors.size()) {
+        msghdr message{};
+        message.msg_iov = &vectors[first];
+        message.msg_iovlen = std::min<size_t>(vectors.size() - first, IOV_MAX);
+        auto sent = sendmsg(socket, &message, kSendFlags);
+        if (sent == -1) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        while (first < vectors.size() && static_cast<size_t>(sent) >= vectors[first].iov_len) {
+            sent -= vectors[first++].iov_len;
+        }
+        if (sent > 0) {
+            vectors[first].iov_base = static_cast<char *>(vectors[first].iov_base) + sent;
+            vectors[first].iov_len -= sent;
+        }
+    }
+    return true;
 }
 
 extern "C" void socketsSocketSend(Socket *socket, Data *data, runtime::Raiser *raiser) {
-    EJC_COND_RAISE_IO_VOID(send(socket->socket_, data->data.get(), data->count, 0) != -1, raiser);
+    std::vector<iovec> vectors{iovec{data->bytes(), static_cast<size_t>(data->count)}};
+    EJC_COND_RAISE_IO_VOID(sendVectors(socket->socket_, vectors), raiser);
+}
+
+extern "C" void socketsSocketSendPieces(Socket *socket, runtime::MemoryPointer<Data *> pieces, runtime::Integer count,
+                                        runtime::Raiser *raiser) {
+    std::vector<iovec> vectors;
+    vectors.reserve(count);
+    for (runtime::Integer i = 0; i < count; i++) {
+        if (pieces[i]->count > 0) {
+            vectors.emplace_back(iovec{pieces[i]->bytes(), static_cast<size_t>(pieces[i]->count)});
+        }
+    }
+    auto success = sendVectors(socket->socket_, vectors);
+    for (runtime::Integer i = 0; i < count; i++) {
+        pieces[i]->release();
+    }
+    EJC_COND_RAISE_IO_VOID(success, raiser);
+}
+
+extern "C" void socketsSocketSendFile(Socket *socket, String *path, runtime::Raiser *raiser) {
+    auto file = open(path->stdString().c_str(), O_RDONLY | O_CLOEXEC);
+    EJC_COND_RAISE_IO_VOID(file != -1, raiser);
+    struct stat status{};
+    if (fstat(file, &status) == -1) {
+        close(file);
+        EJC_RAISE_VOID(raiser, s::IOError::init());
+    }
+#ifdef __linux__
+    // The kernel copies the file to the socket directly, the bytes are never copied to user space.
+    off_t offset = 0;
+    while (offset < status.st_size) {
+        if (sendfile(socket->socket_, file, &offset, status.st_size - offset) == -1 && errno != EINTR) {
+            close(file);
+            EJC_RAISE_VOID(raiser, s::IOError::init());
+        }
+    }
+#else
+    char buffer[65536];
+    while (true) {
+        auto read = ::read(file, buffer, sizeof(buffer));
+        if (read == 0) break;
+        if (read == -1) {
+            if (errno == EINTR) continue;
+            close(file);
+            EJC_RAISE_VOID(raiser, s::IOError::init());
+        }
+        std::vector<iovec> vectors{iovec{buffer, static_cast<size_t>(read)}};
+        if (!sendVectors(socket->socket_, vectors)) {
+            close(file);
+            EJC_RAISE_VOID(raiser, s::IOError::init());
+        }
+    }
+#endif
+    close(file);
 }
 
 extern "C" Data* socketsSocketRead(Socket *socket, runtime::Integer count, runtime::Raiser *raiser) {
@@ -75,11 +685,157 @@ extern "C" Data* socketsSocketRead(Socket *socket, runtime::Integer count, runti
     return data;
 }
 
+extern "C" runtime::Integer socketsSocketReadInto(Socket *socket, Buffer *buffer, runtime::Integer offset,
+                                                  runtime::Raiser *raiser) {
+    if (offset < 0 || offset > buffer->capacity) {
+        ejcPanic("Offset out of bounds in 📞👂🔸📬");
+    }
+    auto read = recv(socket->socket_, buffer->data.get() + offset, buffer->capacity - offset, 0);
+    if (read == -1) {
+        EJC_RAISE(raiser, s::IOError::init());
+    }
+    buffer->count = offset + read;
+    return read;
+}
+
+extern "C" s::Task* socketsSocketWhenReadable(Socket *socket, runtime::Callable<void> callable) {
+    auto task = s::newTask(callable);
+    Reactor::shared().watch(socket->socket_, POLLIN, task);
+    return task;
+}
+
+/// Sends *descriptor* over the Unix domain socket *socket* as SCM_RIGHTS ancillary data. Ancillary data cannot be sent
+/// without data on stream sockets, so a single byte is sent along. Returns false if an error occurred.
+bool sendDescriptor(int socket, int descriptor) {
+    char byte = 0;
+    iovec vector{&byte, 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{};
+    msghdr message{};
+    message.msg_iov = &vector;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    auto header = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(header), &descriptor, sizeof(int));
+    ssize_t sent;
+    do {
+        sent = sendmsg(socket, &message, kSendFlags);
+    } while (sent == -1 && errno == EINTR);
+    return sent == 1;
+}
+
+/// Receives the byte sent by sendDescriptor() from *socket* and returns the descriptor that came with it, which is
+/// closed on exec. Returns -1 and sets errno if an error occurred or no descriptor was received.
+int receiveDescriptor(int socket) {
+    char byte;
+    iovec vector{&byte, 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{};
+    msghdr message{};
+    message.msg_iov = &vector;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+#ifdef __linux__
+    constexpr int kFlags = MSG_CMSG_CLOEXEC;
+#else
+    constexpr int kFlags = 0;
+#endif
+    ssize_t received;
+    do {
+        received = recvmsg(socket, &message, kFlags);
+    } while (received == -1 && errno == EINTR);
+    if (received <= 0) {
+        if (received == 0) errno = ECONNRESET;
+        return -1;
+    }
+    for (auto header = CMSG_FIRSTHDR(&message); header != nullptr; header = CMSG_NXTHDR(&message, header)) {
+        if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS &&
+            header->cmsg_len >= CMSG_LEN(sizeof(int))) {
+            int descriptor;
+            std::memcpy(&descriptor, CMSG_DATA(header), sizeof(int));
+#ifndef __linux__
+            fcntl(descriptor, F_SETFD, FD_CLOEXEC);
+#endif
+            return descriptor;
+        }
+    }
+    errno = EBADMSG;
+    return -1;
+}
+
+extern "C" void socketsSocketSendDescriptor(Socket *socket, runtime::Integer descriptor, runtime::Raiser *raiser) {
+    EJC_COND_RAISE_IO_VOID(sendDescriptor(socket->socket_, static_cast<int>(descriptor)), raiser);
+}
+
+extern "C" void socketsSocketSendSocket(Socket *socket, Socket *connection, runtime::Raiser *raiser) {
+    EJC_COND_RAISE_IO_VOID(connection->socket_ != -1 && sendDescriptor(socket->socket_, connection->socket_), raiser);
+}
+
+extern "C" runtime::Integer socketsSocketReceiveDescriptor(Socket *socket, runtime::Raiser *raiser) {
+    auto descriptor = receiveDescriptor(socket->socket_);
+    if (descriptor == -1) {
+        EJC_RAISE(raiser, s::IOError::init());
+    }
+    return descriptor;
+}
+
+extern "C" Socket* socketsSocketReceiveSocket(Socket *socket, runtime::Raiser *raiser) {
+    std::signal(SIGPIPE, SIG_IGN);
+    auto descriptor = receiveDescriptor(socket->socket_);
+    if (descriptor == -1) {
+        EJC_RAISE(raiser, s::IOError::init());
+    }
+    auto connection = Socket::init();
+    connection->socket_ = descriptor;
+    return connection;
+}
+
 extern "C" void socketsServerClose(Server *server) {
-    close(server->socket_);
+    if (server->socket_ != -1) {
+        close(server->socket_);
+        server->socket_ = -1;
+    }
 }
 
-extern "C" Server* socketsServerNewPort(runtime::Integer port, runtime::Raiser *raiser) {
+extern "C" void socketsServerDestruct(Server *server) {
+    for (auto buffer : server->pool_) {
+        buffer->release();
+    }
+    server->~Server();
+}
+
+extern "C" Buffer* socketsServerTakeBuffer(Server *server, runtime::Integer capacity) {
+    {
+        std::lock_guard<std::mutex> lock(server->poolMutex_);
+        auto it = std::find_if(server->pool_.rbegin(), server->pool_.rend(), [capacity](Buffer *buffer) {
+            return buffer->capacity >= capacity;
+        });
+        if (it != server->pool_.rend()) {
+            auto buffer = *it;
+            server->pool_.erase(std::next(it).base());
+            buffer->count = 0;
+            return buffer;
+        }
+    }
+    auto buffer = Buffer::init();
+    buffer->data = runtime::allocate<runtime::Byte>(capacity);
+    buffer->count = 0;
+    buffer->capacity = capacity;
+    buffer->peer = runtime::allocate<sockaddr_storage>();
+    buffer->peerLength = 0;
+    return buffer;
+}
+
+extern "C" void socketsServerReturnBuffer(Server *server, Buffer *buffer) {
+    buffer->retain();
+    std::lock_guard<std::mutex> lock(server->poolMutex_);
+    server->pool_.push_back(buffer);
+}
+
+Server* newServer(runtime::Integer port, runtime::Integer backlog, bool reusePort, runtime::Raiser *raiser) {
     int listenerDescriptor = socket(PF_INET, SOCK_STREAM, 0);
     if (listenerDescriptor == -1) {
         EJC_RAISE(raiser, s::IOError::init());
@@ -92,8 +848,10 @@ extern "C" Server* socketsServerNewPort(runtime::Integer port, runtime::Raiser *
 
     int reuse = 1;
     if (setsockopt(listenerDescriptor, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<char *>(&reuse), sizeof(int)) == -1 ||
+        (reusePort && setsockopt(listenerDescriptor, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(int)) == -1) ||
         bind(listenerDescriptor, reinterpret_cast<struct sockaddr *>(&name), sizeof(name)) == -1 ||
-        listen(listenerDescriptor, 10) == -1) {
+        listen(listenerDescriptor, static_cast<int>(std::min<runtime::Integer>(backlog, INT_MAX))) == -1) {
+        close(listenerDescriptor);
         EJC_RAISE(raiser, s::IOError::init());
     }
 
@@ -102,6 +860,70 @@ extern "C" Server* socketsServerNewPort(runtime::Integer port, runtime::Raiser *
     return server;
 }
 
+extern "C" Server* socketsServerNewLocal(String *path, runtime::Raiser *raiser) {
+    int descriptor = bindLocal(path, SOCK_STREAM);
+    if (descriptor == -1) {
+        EJC_RAISE(raiser, s::IOError::init());
+    }
+    if (listen(descriptor, SOMAXCONN) == -1) {
+        close(descriptor);
+        EJC_RAISE(raiser, s::IOError::init());
+    }
+    auto server = Server::init();
+    server->socket_ = descriptor;
+    return server;
+}
+
+extern "C" Server* socketsServerNewPort(runtime::Integer port, runtime::Raiser *raiser) {
+    return newServer(port, SOMAXCONN, false, raiser);
+}
+
+extern "C" Server* socketsServerNewOptions(runtime::Integer port, runtime::Integer backlog,
+                                           runtime::Boolean reusePort, runtime::Raiser *raiser) {
+    return newServer(port, backlog, reusePort, raiser);
+}
+
+/// Sets an integer option on *descriptor* and raises an error if it cannot be set.
+void setOption(int descriptor, int level, int option, int value, runtime::Raiser *raiser) {
+    EJC_COND_RAISE_IO_VOID(setsockopt(descriptor, level, option, &value, sizeof(value)) != -1, raiser);
+}
+
+extern "C" void socketsServerSetNoDelay(Server *server, runtime::Boolean enabled) {
+    server->noDelay_ = enabled;
+}
+
+extern "C" void socketsServerSetFastOpen(Server *server, runtime::Integer queueLength, runtime::Raiser *raiser) {
+#ifdef TCP_FASTOPEN
+    setOption(server->socket_, IPPROTO_TCP, TCP_FASTOPEN, static_cast<int>(queueLength), raiser);
+#else
+    errno = ENOPROTOOPT;
+    EJC_RAISE_VOID(raiser, s::IOError::init());
+#endif
+}
+
+extern "C" void socketsServerSetReceiveBuffer(Server *server, runtime::Integer bytes, runtime::Raiser *raiser) {
+    setOption(server->socket_, SOL_SOCKET, SO_RCVBUF, static_cast<int>(bytes), raiser);
+}
+
+extern "C" void socketsServerSetSendBuffer(Server *server, runtime::Integer bytes, runtime::Raiser *raiser) {
+    setOption(server->socket_, SOL_SOCKET, SO_SNDBUF, static_cast<int>(bytes), raiser);
+}
+
+extern "C" void socketsSocketSetNoDelay(Socket *socket, runtime::Boolean enabled, runtime::Raiser *raiser) {
+    setOption(socket->socket_, IPPROTO_TCP, TCP_NODELAY, enabled ? 1 : 0, raiser);
+}
+
+/// Creates a 📞 for the connection *descriptor* accepted by *server* and applies the options of the server.
+Socket* acceptedSocket(Server *server, int descriptor) {
+    if (server->noDelay_) {
+        int value = 1;
+        setsockopt(descriptor, IPPROTO_TCP, TCP_NODELAY, &value, sizeof(value));
+    }
+    auto socket = Socket::init();
+    socket->socket_ = descriptor;
+    return socket;
+}
+
 extern "C" Socket* socketsServerAccept(Server *server, runtime::Raiser *raiser) {
     std::signal(SIGPIPE, SIG_IGN);
 
@@ -113,12 +935,338 @@ extern "C" Socket* socketsServerAccept(Server *server, runtime::Raiser *raiser)
         EJC_RAISE(raiser, s::IOError::init());
     }
 
-    auto socket = Socket::init();
-    socket->socket_ = connectionAddress;
-    return socket;
+    return acceptedSocket(server, connectionAddress);
+}
+
+extern "C" runtime::SimpleOptional<Socket*> socketsServerAcceptPending(Server *server) {
+    std::signal(SIGPIPE, SIG_IGN);
+    pollfd descriptor{server->socket_, POLLIN, 0};
+    if (poll(&descriptor, 1, 0) != 1 || (descriptor.revents & POLLIN) == 0) {
+        return runtime::NoValue;
+    }
+#ifdef __linux__
+    int connection = accept4(server->socket_, nullptr, nullptr, SOCK_CLOEXEC);
+#else
+    int connection = accept(server->socket_, nullptr, nullptr);
+#endif
+    if (connection == -1) {
+        return runtime::NoValue;
+    }
+    return acceptedSocket(server, connection);
+}
+
+extern "C" s::Task* socketsServerWhenReadable(Server *server, runtime::Callable<void> callable) {
+    std::signal(SIGPIPE, SIG_IGN);
+    auto task = s::newTask(callable);
+    Reactor::shared().watch(server->socket_, POLLIN, task);
+    return task;
+}
+
+extern "C" s::Task* socketsTimerAfter(runtime::ClassInfo*, runtime::Integer milliseconds,
+                                      runtime::Callable<void> callable) {
+    auto task = s::newTask(callable);
+    Reactor::shared().after(milliseconds, task);
+    return task;
+}
+
+extern "C" s::Task* socketsTimerWhenReadable(runtime::ClassInfo*, runtime::Integer descriptor,
+                                             runtime::Callable<void> callable) {
+    auto task = s::newTask(callable);
+    Reactor::shared().watch(static_cast<int>(descriptor), POLLIN, task);
+    return task;
+}
+
+#ifdef __APPLE__
+// macOS has no system calls to send and receive several datagrams at once, so they are emulated.
+#define MSG_WAITFORONE 0
+
+struct mmsghdr {
+    msghdr msg_hdr;
+    unsigned msg_len;
+};
+
+int sendmmsg(int socket, mmsghdr *messages, unsigned count, int flags) {
+    for (unsigned i = 0; i < count; i++) {
+        auto sent = sendmsg(socket, &messages[i].msg_hdr, flags);
+        if (sent == -1) {
+            return i > 0 ? static_cast<int>(i) : -1;
+        }
+        messages[i].msg_len = static_cast<unsigned>(sent);
+    }
+    return static_cast<int>(count);
+}
+
+int recvmmsg(int socket, mmsghdr *messages, unsigned count, int flags, timespec *) {
+    for (unsigned i = 0; i < count; i++) {
+        auto received = recvmsg(socket, &messages[i].msg_hdr, i == 0 ? flags : flags | MSG_DONTWAIT);
+        if (received == -1) {
+            return i > 0 ? static_cast<int>(i) : -1;
+        }
+        messages[i].msg_len = static_cast<unsigned>(received);
+    }
+    return static_cast<int>(count);
+}
+#endif
+
+extern "C" Datagram* socketsDatagramNew(runtime::Integer port, runtime::Raiser *raiser) {
+    int descriptor = socket(PF_INET, SOCK_DGRAM, 0);
+    if (descriptor == -1) {
+        EJC_RAISE(raiser, s::IOError::init());
+    }
+    struct sockaddr_in name{};
+    name.sin_family = PF_INET;
+    name.sin_port = htons(port);
+    name.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(descriptor, reinterpret_cast<struct sockaddr *>(&name), sizeof(name)) == -1) {
+        close(descriptor);
+        EJC_RAISE(raiser, s::IOError::init());
+    }
+    auto datagram = Datagram::init();
+    datagram->socket_ = descriptor;
+    return datagram;
+}
+
+extern "C" Datagram* socketsDatagramNewLocal(String *path, runtime::Raiser *raiser) {
+    int descriptor = bindLocal(path, SOCK_DGRAM);
+    if (descriptor == -1) {
+        EJC_RAISE(raiser, s::IOError::init());
+    }
+    auto datagram = Datagram::init();
+    datagram->socket_ = descriptor;
+    return datagram;
+}
+
+/// Returns the first IPv4 address of *host*, as datagram sockets are IPv4 sockets.
+bool resolveIPv4(String *host, runtime::Integer port, sockaddr_storage *address) {
+    for (auto &candidate : ResolverCache::shared().resolve(host->stdString(), port)) {
+        if (candidate.ss_family == AF_INET) {
+            *address = candidate;
+            return true;
+        }
+    }
+    errno = EHOSTUNREACH;
+    return false;
+}
+
+extern "C" void socketsDatagramConnect(Datagram *datagram, String *host, runtime::Integer port,
+                                       runtime::Raiser *raiser) {
+    sockaddr_storage address{};
+    EJC_COND_RAISE_IO_VOID(resolveIPv4(host, port, &address) &&
+                           connect(datagram->socket_, reinterpret_cast<sockaddr *>(&address),
+                                   sizeof(sockaddr_in)) != -1, raiser);
+}
+
+extern "C" void socketsDatagramSendTo(Datagram *datagram, Data *message, String *host, runtime::Integer port,
+                                      runtime::Raiser *raiser) {
+    sockaddr_storage address{};
+    EJC_COND_RAISE_IO_VOID(resolveIPv4(host, port, &address) &&
+                           sendto(datagram->socket_, message->bytes(), message->count, kSendFlags,
+                                  reinterpret_cast<sockaddr *>(&address), sizeof(sockaddr_in)) != -1, raiser);
+}
+
+extern "C" void socketsDatagramConnectLocal(Datagram *datagram, String *path, runtime::Raiser *raiser) {
+    sockaddr_un address{};
+    socklen_t length;
+    EJC_COND_RAISE_IO_VOID(localAddress(path, &address, &length) &&
+                           connect(datagram->socket_, reinterpret_cast<sockaddr *>(&address), length) != -1, raiser);
+}
+
+extern "C" void socketsDatagramSendToLocal(Datagram *datagram, Data *message, String *path,
+                                           runtime::Raiser *raiser) {
+    sockaddr_un address{};
+    socklen_t length;
+    EJC_COND_RAISE_IO_VOID(localAddress(path, &address, &length) &&
+                           sendto(datagram->socket_, message->bytes(), message->count, kSendFlags,
+                                  reinterpret_cast<sockaddr *>(&address), length) != -1, raiser);
+}
+
+extern "C" void socketsDatagramReply(Datagram *datagram, Data *message, Buffer *to, runtime::Raiser *raiser) {
+    EJC_COND_RAISE_IO_VOID(to->peerLength > 0 &&
+                           sendto(datagram->socket_, message->bytes(), message->count, kSendFlags,
+                                  reinterpret_cast<sockaddr *>(to->peer.get()),
+                                  static_cast<socklen_t>(to->peerLength)) != -1, raiser);
+}
+
+extern "C" runtime::Integer socketsDatagramSendBatch(Datagram *datagram, runtime::MemoryPointer<Data *> messages,
+                                                     runtime::Integer count, runtime::Raiser *raiser) {
+    std::vector<iovec> vectors(count);
+    std::vector<mmsghdr> headers(count);
+    for (runtime::Integer i = 0; i < count; i++) {
+        vectors[i] = iovec{messages[i]->bytes(), static_cast<size_t>(messages[i]->count)};
+        headers[i] = mmsghdr{};
+        headers[i].msg_hdr.msg_iov = &vectors[i];
+        headers[i].msg_hdr.msg_iovlen = 1;
+    }
+    runtime::Integer sent = 0;
+    while (sent < count) {
+        auto result = sendmmsg(datagram->socket_, &headers[sent], static_cast<unsigned>(count - sent), kSendFlags);
+        if (result == -1) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        sent += result;
+    }
+    auto error = errno;
+    for (runtime::Integer i = 0; i < count; i++) {
+        messages[i]->release();
+    }
+    if (sent == 0 && count > 0) {
+        errno = error;
+        EJC_RAISE(raiser, s::IOError::init());
+    }
+    return sent;
+}
+
+extern "C" runtime::Integer socketsDatagramReceiveBatch(Datagram *datagram, runtime::MemoryPointer<Buffer *> buffers,
+                                                        runtime::Integer count, runtime::Raiser *raiser) {
+    std::vector<iovec> vectors(count);
+    std::vector<mmsghdr> headers(count);
+    for (runtime::Integer i = 0; i < count; i++) {
+        vectors[i] = iovec{buffers[i]->data.get(), static_cast<size_t>(buffers[i]->capacity)};
+        headers[i] = mmsghdr{};
+        headers[i].msg_hdr.msg_iov = &vectors[i];
+        headers[i].msg_hdr.msg_iovlen = 1;
+        headers[i].msg_hdr.msg_name = buffers[i]->peer.get();
+        headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+    }
+    int received;
+    do {
+        // Blocks until the first datagram arrives and then takes all datagrams that are already queued.
+        received = recvmmsg(datagram->socket_, headers.data(), static_cast<unsigned>(count), MSG_WAITFORONE, nullptr);
+    } while (received == -1 && errno == EINTR);
+    auto error = errno;
+    for (int i = 0; i < std::max(received, 0); i++) {
+        buffers[i]->count = headers[i].msg_len;
+        buffers[i]->peerLength = headers[i].msg_hdr.msg_namelen;
+    }
+    for (runtime::Integer i = 0; i < count; i++) {
+        buffers[i]->release();
+    }
+    if (received == -1) {
+        errno = error;
+        EJC_RAISE(raiser, s::IOError::init());
+    }
+    return received;
+}
+
+extern "C" s::Task* socketsDatagramWhenReadable(Datagram *datagram, runtime::Callable<void> callable) {
+    auto task = s::newTask(callable);
+    Reactor::shared().watch(datagram->socket_, POLLIN, task);
+    return task;
+}
+
+extern "C" void socketsDatagramClose(Datagram *datagram) {
+    if (datagram->socket_ != -1) {
+        close(datagram->socket_);
+        datagram->socket_ = -1;
+    }
+}
+
+/// A 🏊 of idle connections to hosts, which are handed out again instead of connecting anew.
+class Pool : public runtime::Object<Pool> {
+public:
+    struct Idle {
+        Socket *socket;
+        std::chrono::steady_clock::time_point since;
+    };
+
+    runtime::Integer maxIdle_;
+    std::chrono::milliseconds idleTimeout_;
+    /// Idle connections by host and port, the most recently returned last. Every connection holds a reference.
+    /// Guarded by mutex_.
+    std::unordered_map<std::string, std::vector<Idle>> idle_;
+    std::mutex mutex_;
+};
+
+/// Returns true if *socket* is still connected and the peer has not sent anything unexpectedly while it was idle.
+bool isHealthy(Socket *socket) {
+    pollfd descriptor{socket->socket_, POLLIN, 0};
+    auto ready = poll(&descriptor, 1, 0);
+    // Data, a hang-up or an error all make the connection unusable. A closed socket is reported as POLLNVAL.
+    return ready == 0;
+}
+
+extern "C" Pool* socketsPoolNew(runtime::Integer maxIdle, runtime::Integer idleTimeout) {
+    auto pool = Pool::init();
+    pool->maxIdle_ = maxIdle;
+    pool->idleTimeout_ = std::chrono::milliseconds(idleTimeout);
+    return pool;
+}
+
+extern "C" Socket* socketsPoolTake(Pool *pool, String *host, runtime::Integer port, runtime::Raiser *raiser) {
+    auto key = host->stdString() + ":" + std::to_string(port);
+    std::vector<Socket *> discarded;
+    Socket *reused = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex_);
+        auto it = pool->idle_.find(key);
+        if (it != pool->idle_.end()) {
+            auto now = std::chrono::steady_clock::now();
+            auto &connections = it->second;
+            while (!connections.empty()) {
+                auto idle = connections.back();
+                connections.pop_back();
+                if (now - idle.since <= pool->idleTimeout_ && isHealthy(idle.socket)) {
+                    reused = idle.socket;
+                    break;
+                }
+                discarded.push_back(idle.socket);
+            }
+        }
+    }
+    // Releasing closes the connection, which is done outside of the lock.
+    for (auto socket : discarded) {
+        socket->release();
+    }
+    if (reused != nullptr) {
+        return reused;
+    }
+    return socketsSocketNewHost(host, port, raiser);
+}
+
+extern "C" void socketsPoolReturn(Pool *pool, Socket *socket, String *host, runtime::Integer port) {
+    if (socket->socket_ == -1 || !isHealthy(socket)) {
+        return;
+    }
+    auto key = host->stdString() + ":" + std::to_string(port);
+    socket->retain();
+    std::vector<Socket *> discarded;
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex_);
+        auto &connections = pool->idle_[key];
+        connections.push_back(Pool::Idle{socket, std::chrono::steady_clock::now()});
+        auto now = std::chrono::steady_clock::now();
+        // The least recently returned connections are closed first as they are the most likely to be closed by the
+        // peer due to inactivity.
+        size_t expired = 0;
+        while (expired < connections.size() && now - connections[expired].since > pool->idleTimeout_) {
+            expired++;
+        }
+        auto excess = connections.size() - expired > static_cast<size_t>(std::max<runtime::Integer>(0, pool->maxIdle_))
+            ? connections.size() - expired - pool->maxIdle_ : 0;
+        for (size_t i = 0; i < expired + excess; i++) {
+            discarded.push_back(connections[i].socket);
+        }
+        connections.erase(connections.begin(), connections.begin() + expired + excess);
+    }
+    for (auto discardedSocket : discarded) {
+        discardedSocket->release();
+    }
+}
+
+extern "C" void socketsPoolDestruct(Pool *pool) {
+    for (auto &pair : pool->idle_) {
+        for (auto &idle : pair.second) {
+            idle.socket->release();
+        }
+    }
+    pool->~Pool();
 }
 
 }  // namespace sockets
 
 SET_INFO_FOR(sockets::Socket, sockets, 1f4de)
 SET_INFO_FOR(sockets::Server, sockets, 1f3c4)
+SET_INFO_FOR(sockets::Buffer, sockets, 1f4ec)
+SET_INFO_FOR(sockets::Pool, sockets, 1f3ca)
+SET_INFO_FOR(sockets::Datagram, sockets, 1f4e1)
@@ -4,9 +4,18 @@ import os
 import dist
 import sys
 import re
+import json
+import tempfile
+import threading
+from concurrent.futures import ThreadPoolExecutor
 
 quick = len(sys.argv) > 1 and sys.argv[1] == 'quick'
 valgrind = len(sys.argv) > 1 and sys.argv[1] == 'valgrind'
+bench = len(sys.argv) > 1 and sys.argv[1] == 'bench'
+compiler_bench = len(sys.argv) > 1 and sys.argv[1] == 'compilerbench'
+update_baseline = bench and len(sys.argv) > 2 and sys.argv[2] == 'update'
+# The number of test programs that are compiled and run at the same time.
+jobs = int(os.environ.get("EMOJICODE_TEST_JOBS", os.cpu_count() or 1))
 
 compilation_tests = [
     "hello",
@@ -23,6 +32,7 @@ compilation_tests = [
     "assignmentMethod",
     "assignmentByCall",
     "repeatWhile",
+    "forIn",
     "conditionalProduce",
     "stringConcat",
     "babyBottleInitializer",
@@ -98,6 +108,7 @@ compilation_tests = [
     "rcTempOrder",
     "rcInstanceVariable",
     "rcOnlyReference",
+    "rcMove",
     "rcIvarArgMut",
     "rcEscaping",
     "classEscapingParamOverride",
@@ -106,8 +117,18 @@ compilation_tests = [
     "shortCircuit",
     "errorReraisePrefix",
     "weak",
+    "weakBorrow",
     "superMemoryFlow",
-    "interpolationDereference"
+    "interpolationDereference",
+    "constantEvaluation",
+    "constantListLiteral",
+    "match",
+    "largeValueType",
+    "errorChain",
+    "tailCall",
+    "inliningAttributes",
+    "optionalBorrow",
+    "exportedFunction"
 ]
 
 if not (quick or valgrind):
@@ -121,29 +142,106 @@ if not (quick or valgrind):
 library_tests = [
     "primitives",
     "mathTest",
+    "vectorTest",
+    "bitTest",
+    "bigIntegerTest",
     "rangeTest",
     "stringTest",
     "dataTest",
+    "hashTest",
     "systemTest",
     "listTest",
     "enumerator",
     "dictionaryTest",
+    "mapTest",
+    "cacheTest",
+    "dequeTest",
+    "priorityQueueTest",
+    "setTest",
+    "lazySequenceTest",
+    "parallelTest",
+    "columnTest",
+    "taskTest",
+    "synchronizationTest",
+    "atomicTest",
+    "channelTest",
+    "sharedRingTest",
+    "persistentTest",
+    "concurrentMapTest",
+    "bitsetTest",
+    "radixTreeTest",
+    "threadLocalTest",
+    "threadPlacementTest",
+    "arenaTest",
+    "cycleCollectorTest",
+    "poolTest",
+    "memoryUsageTest",
+    "prngTest",
     "jsonTest",
-    "fileTest"
+    "jsonTypedTest",
+    "jsonEventsTest",
+    "regexTest",
+    "metricsTest",
+    "tracingTest",
+    "benchmarkTest",
+    "concurrentSuitesTest",
+    "fileTest",
+    "processTest",
+    "binaryTest",
+    "memoryTest",
+    "byteBufferTest",
+    "socketsTest",
+    "httpTest"
 ]
+# Tests of packages that are only built if their dependencies are available, see dist.optional_packages.
+optional_library_tests = {
+    "tls": ["tlsTest"],
+    "compression": ["compressionTest"]
+}
+for package, tests in optional_library_tests.items():
+    if os.path.exists(os.path.join(package, "lib" + package + ".a")):
+        library_tests.extend(tests)
+# Environment variables that library tests need in addition to those of this script.
+library_test_environments = {
+    # Lets the clients of the test trust the certificate its server presents.
+    "tlsTest": {"SSL_CERT_FILE": os.path.join(dist.source, "tests", "s", "tlsTest_certificate.pem")},
+}
+benchmarks = [
+    "collectionBenchmark",
+    "textBenchmark",
+    "threadBenchmark"
+]
+# A benchmark regressed if its median is this much slower than in the baseline.
+bench_threshold = 0.15
+bench_baseline = os.path.join(dist.source, "tests", "bench", "baseline.json")
+# The synthetic package compiled by compiler benchmarks is this many times larger at each step.
+compiler_bench_scales = [1, 2, 4, 8]
+# A phase scales super-linearly if its time grows by more than the size of the package to this power.
+compiler_bench_exponent = 1.3
+
 reject_tests = glob.glob(os.path.join(dist.source, "tests", "reject",
                                       "*.emojic"))
 
 failed_tests = []
+output_lock = threading.Lock()
 
 emojicodec = os.path.abspath("Compiler/emojicodec")
 os.environ["EMOJICODE_PACKAGES_PATH"] = os.path.abspath(".")
 
 
-def fail_test(name):
-    global failed_tests
-    print("🛑 {0} failed".format(name))
-    failed_tests.append(name)
+def fail_test(name, output=None):
+    with output_lock:
+        if output is not None:
+            print(output)
+        print("🛑 {0} failed".format(name))
+        failed_tests.append(name)
+
+
+def run_parallel(function, items):
+    """Calls function with each of items on up to jobs threads and returns once all calls returned."""
+    with ThreadPoolExecutor(max_workers=jobs) as executor:
+        for _ in executor.map(function, items):
+            pass
 
 
 def test_paths(name, kind):
@@ -155,10 +253,10 @@ def library_test(name):
     source_path, binary_path = test_paths(name, 's')
 
     run([emojicodec, source_path, '-O'], check=True)
-    completed = run([binary_path], stdout=PIPE)
+    environment = dict(os.environ, **library_test_environments.get(name, {}))
+    completed = run([binary_path], stdout=PIPE, env=environment)
     if completed.returncode != 0:
-        fail_test(name)
-        print(completed.stdout.decode('utf-8'))
+        fail_test(name, completed.stdout.decode('utf-8'))
 
 
 def compilation_test(name):
@@ -168,16 +266,14 @@ def compilation_test(name):
     exp_path = os.path.join(dist.source, "tests", "compilation", name + ".txt")
     output = completed.stdout.decode('utf-8')
     if output != open(exp_path, "r", encoding='utf-8').read():
-        print(output)
-        fail_test(name)
+        fail_test(name, output)
 
 
 def reject_test(filename):
     completed = run([emojicodec, filename], stderr=PIPE)
     output = completed.stderr.decode('utf-8')
     if completed.returncode != 1 or len(re.findall(r"🚨 error:", output)) != 1:
-        print(output)
-        fail_test(filename)
+        fail_test(filename, output)
 
 
 def available_compilation_tests():
@@ -193,6 +289,12 @@ def available_compilation_tests():
 avl_compilation_tests = available_compilation_tests()
 
 
+def restore_original(source_path):
+    # --format only keeps the original of a file whose formatting it changed.
+    if os.path.exists(source_path + '_original'):
+        os.rename(source_path + '_original', source_path)
+
+
 def prettyprint_test(name):
     source_path = test_paths(name, 'compilation')[0]
     run([emojicodec, '--format', source_path], check=True)
@@ -200,32 +302,29 @@ def prettyprint_test(name):
         compilation_test(name)
     except CalledProcessError:
         fail_test(name)
-    os.rename(source_path + '_original', source_path)
+    restore_original(source_path)
 
 
 def test():
     for test in compilation_tests:
         avl_compilation_tests.remove(test)
-        compilation_test(test)
+    run_parallel(compilation_test, compilation_tests)
 
     if not quick:
-        for test in compilation_tests:
-            prettyprint_test(test)
+        run_parallel(prettyprint_test, compilation_tests)
 
         included = os.path.join(dist.source, "tests", "compilation", "included.emojic")
-        os.rename(included + '_original', included)
+        restore_original(included)
 
         source_path = test_paths('included', 'compilation')[0]
         run([emojicodec, '--format', source_path], check=True)
         compilation_test('includer')
-        os.rename(source_path + '_original', source_path)
+        restore_original(source_path)
 
-    for test in reject_tests:
-        reject_test(test)
+    run_parallel(reject_test, reject_tests)
     os.chdir(os.path.join(dist.source, "tests", "s"))
     os.environ["TEST_ENV_1"] = "The day starts like the rest I've seen"
-    for test in library_tests:
-        library_test(test)
+    run_parallel(library_test, library_tests)
 
     for file in avl_compilation_tests:
         print("☢️  {0} is not in compilation test list.".format(file))
@@ -239,18 +338,97 @@ def test():
         sys.exit(1)
 
 
+def valgrind_test(name):
+    source_path, binary_path = test_paths(name, 'compilation')
+    run([emojicodec, source_path, '-O'], check=True)
+    completed = run(['valgrind', '--error-exitcode=22', '--leak-check=full', binary_path], stdout=PIPE, stderr=PIPE)
+    if completed.returncode == 22:
+        fail_test(name, completed.stdout.decode('utf-8') + completed.stderr.decode('utf-8'))
+
+
 def run_valgrind():
-    for test in compilation_tests:
-        source_path, binary_path = test_paths(test, 'compilation')
+    run_parallel(valgrind_test, compilation_tests)
+
+
+def run_benchmarks():
+    results = {}
+    os.chdir(os.path.join(dist.source, "tests", "bench"))
+    for name in benchmarks:
+        source_path, binary_path = test_paths(name, 'bench')
         run([emojicodec, source_path, '-O'], check=True)
-        completed = run(['valgrind', '--error-exitcode=22', '--leak-check=full', binary_path], stdout=PIPE, stderr=PIPE)
-        if completed.returncode == 22:
-            print(completed.stdout.decode('utf-8'))
-            print(completed.stderr.decode('utf-8'))
-            fail_test(test)
+        completed = run([binary_path], stdout=PIPE, check=True)
+        for result in json.loads(completed.stdout.decode('utf-8'))["benchmarks"]:
+            results["{0}: {1}".format(name, result["name"])] = result
+
+    if update_baseline or not os.path.exists(bench_baseline):
+        with open(bench_baseline, "w", encoding='utf-8') as file:
+            json.dump(results, file, indent=2, ensure_ascii=False, sort_keys=True)
+        print("📏 Baseline written to {0}.".format(bench_baseline))
+        sys.exit(0)
+
+    with open(bench_baseline, "r", encoding='utf-8') as file:
+        baseline = json.load(file)
+    for name, result in sorted(results.items()):
+        if name not in baseline:
+            print("☢️  {0} is not in the baseline.".format(name))
+            continue
+        change = result["median"] / baseline[name]["median"] - 1
+        print("{0}: {1:.0f} ns ({2:+.1%})".format(name, result["median"], change))
+        if change > bench_threshold:
+            fail_test(name)
+
+    if len(failed_tests) == 0:
+        print("✅ ✅  No benchmark regressed.")
+        sys.exit(0)
+    else:
+        print("🛑 🛑  {0} benchmarks regressed: {1}".format(len(failed_tests),
+                                                          ", ".join(failed_tests)))
+        sys.exit(1)
+
+
+def run_compiler_benchmarks():
+    sys.path.append(os.path.join(dist.source, "tests", "bench"))
+    from synthesize import synthesize
+
+    os.chdir(tempfile.mkdtemp())
+    times = {}
+    for scale in compiler_bench_scales:
+        source_path = "synthetic{0}.emojic".format(scale)
+        with open(source_path, "w", encoding='utf-8') as file:
+            file.write(synthesize(classes=200 * scale, instantiations=100 * scale, depth=8, statements=60))
+        completed = run([emojicodec, source_path, '-c', '--time-phases', '--json'], stdout=PIPE, check=True)
+        measurements = [m for m in json.loads(completed.stdout.decode('utf-8')) if m["type"] == "measurement"]
+        print("📦 {0}x: peak memory {1:.1f} MiB".format(scale, max(m["peakMemory"] for m in measurements) /
+                                                     (1024 * 1024)))
+        for measurement in measurements:
+            name = "  " * measurement["depth"] + measurement["name"]
+            times.setdefault(measurement["name"], {})[scale] = measurement["wallTime"]
+            print("{0:<40}{1:10.3f} s".format(name, measurement["wallTime"]))
+
+    smallest, largest = compiler_bench_scales[0], compiler_bench_scales[-1]
+    for name, scaled in times.items():
+        # Phases that are too fast to be measured reliably are not compared.
+        if smallest not in scaled or largest not in scaled or scaled[smallest] < 0.01:
+            continue
+        limit = (largest / smallest) ** compiler_bench_exponent
+        if scaled[largest] / scaled[smallest] > limit:
+            fail_test(name)
+
+    if len(failed_tests) == 0:
+        print("✅ ✅  All phases scale linearly.")
+        sys.exit(0)
+    else:
+        print("🛑 🛑  {0} phases scale super-linearly: {1}".format(len(failed_tests),
+                                                               ", ".join(failed_tests)))
+        sys.exit(1)
+
 
 if valgrind:
     run_valgrind()
+elif compiler_bench:
+    run_compiler_benchmarks()
+elif bench:
+    run_benchmarks()
 else:
     test()
 
@@ -0,0 +1,105 @@
+"""Generates synthetic Emojicode programs to measure how the compiler scales with the size of a package."""
+
+import sys
+
+# Digits of the names of the generated types and methods, which consist of emojis joined by 🔸.
+digits = ["🐶", "🐱", "🐭", "🐹", "🐰", "🦊", "🐻", "🐼", "🐨", "🐯"]
+
+
+def name(prefix, number):
+    return prefix + "".join("🔸" + digits[int(digit)] for digit in str(number))
+
+
+def protocol(index):
+    return name("🔌", index)
+
+
+def klass(index):
+    return name("🏛", index)
+
+
+def generic(index):
+    return name("🎁", index)
+
+
+def getter(index):
+    return name("🔎", index)
+
+
+def synthesize(classes, instantiations, depth, statements):
+    """Returns the source of a program with *classes* classes in inheritance chains of *depth* classes, each of which
+    conforms to one of *depth* protocols, a function of *statements* statements for every chain, and a function that
+    creates *instantiations* distinct instantiations of generic classes. The functions use the classes in ways that
+    require the common types of list literals and generic arguments to be inferred."""
+    lines = []
+    for level in range(depth):
+        lines += ["🐊 {0} 🍇".format(protocol(level)),
+                  "  ❗️ {0} ➡️ 🔢".format(getter(level)),
+                  "🍉", ""]
+
+    for index in range(classes):
+        level = index % depth
+        superclass = "" if level == 0 else " " + klass(index - 1)
+        lines += ["🐇 {0}{1} 🍇".format(klass(index), superclass),
+                  "  🐊 {0}".format(protocol(level))]
+        if level == 0:
+            lines += ["  🖍🆕 value 🔢", "", "  🆕 🍼value 🔢 🍇🍉"]
+        lines += ["", "  ❗️ {0} ➡️ 🔢 🍇".format(getter(level)),
+                  "    ↩️ value ➕ {0}".format(index),
+                  "  🍉", "🍉", ""]
+
+    generics = max(1, (instantiations + classes - 1) // classes)
+    for index in range(generics):
+        lines += ["🐇 {0}🐚T ⚪️🍆 🍇".format(generic(index)),
+                  "  🖍🆕 content T", "",
+                  "  🆕 🍼content T 🍇🍉", "",
+                  "  ❗️ 🎀 ➡️ T 🍇",
+                  "    ↩️ content",
+                  "  🍉", "🍉", ""]
+
+    chains = (classes + depth - 1) // depth
+    lines += ["🐇 🧮 🍇"]
+    for chain in range(chains):
+        first = chain * depth
+        last = min(first + depth, classes) - 1
+        lines += ["  🐇❗️ {0} ➡️ 🔢 🍇".format(name("🏃", chain)), "    0 ➡️ 🖍🆕total"]
+        for statement in range(statements):
+            index = first + statement % (last - first + 1)
+            other = first + (statement * 7) % (last - first + 1)
+            level = index - first
+            variable = "v{0}".format(statement)
+            kind = statement % 3
+            if kind == 0:
+                lines += ["    🆕{0} {1}❗️ ➡️ {2}".format(klass(index), statement, variable),
+                          "    total ⬅️➕ {0} {1}❗️".format(getter(level), variable)]
+            elif kind == 1:
+                lines += ["    🍿 🆕{0} 1❗️ 🆕{1} 2❗️ 🍆 ➡️ {2}".format(klass(index), klass(other), variable),
+                          "    total ⬅️➕ 📏{0}❓".format(variable)]
+            else:
+                lines += ["    ↪️ total ▶️ {0} 🍇".format(statement),
+                          "      total ⬅️➖ {0}".format(statement),
+                          "    🍉"]
+        lines += ["    ↩️ total", "  🍉", ""]
+
+    lines += ["  🐇❗️ 🎡 ➡️ 🔢 🍇", "    0 ➡️ 🖍🆕total"]
+    for instantiation in range(instantiations):
+        index = instantiation % classes
+        variable = "box{0}".format(instantiation)
+        lines += ["    🆕{0} 🆕{1} {2}❗️❗️ ➡️ {3}".format(generic(instantiation // classes), klass(index),
+                                                     instantiation, variable),
+                  "    total ⬅️➕ {0} 🎀{1}❗️❗️".format(getter(index % depth), variable)]
+    lines += ["    ↩️ total", "  🍉", "🍉", ""]
+
+    lines += ["🏁 🍇", "  🎡🐇🧮❗️ ➡️ 🖍🆕total"]
+    for chain in range(chains):
+        lines += ["  total ⬅️➕ {0}🐇🧮❗️".format(name("🏃", chain))]
+    lines += ["  😀 🔡total❗️❗️", "🍉", ""]
+    return "\n".join(lines)
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 6:
+        print("Usage: synthesize.py classes instantiations depth statements path")
+        sys.exit(1)
+    with open(sys.argv[5], "w", encoding="utf-8") as file:
+        file.write(synthesize(*(int(argument) for argument in sys.argv[1:5])))
@@ -0,0 +1,354 @@
+//
+// Created by Theo Weidmann on 14.10.26.
+//
+
+#include "../runtime/Runtime.h"
+#include "../s/Data.h"
+#include "../s/String.h"
+#include "../s/Error.h"
+#include "../s/Task.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using s::String;
+using s::Data;
+
+namespace tls {
+
+/// A 📞 of the sockets package. The layout must match the class declared there.
+class Socket : public runtime::Object<Socket> {
+public:
+    int socket_;
+};
+
+/// A 📬 of the sockets package. The layout must match the instance variables declared there.
+class Buffer : public runtime::Object<Buffer> {
+public:
+    runtime::MemoryPointer<runtime::Byte> data;
+    runtime::Integer count;
+    runtime::Integer capacity;
+    runtime::MemoryPointer<runtime::Byte> peer;
+    runtime::Integer peerLength;
+};
+
+}  // namespace tls
+
+extern "C" s::Task* socketsSocketWhenReadable(tls::Socket *socket, runtime::Callable<void> callable);
+extern "C" void socketsSocketClose(tls::Socket *socket);
+
+namespace tls {
+
+class Context : public runtime::Object<Context> {
+public:
+    SSL_CTX *context_;
+    /// The protocols offered or accepted with ALPN in wire format, i.e. each preceded by its length.
+    std::vector<unsigned char> protocols_;
+    /// The sessions of the clients created with this context by host name, which are resumed by the next
+    /// connection to the same host. Guarded by sessionsMutex_.
+    std::map<std::string, SSL_SESSION *> sessions_;
+    std::mutex sessionsMutex_;
+};
+
+class TlsSocket : public runtime::Object<TlsSocket> {
+public:
+    SSL *ssl_;
+    Socket *socket_;
+};
+
+/// The index of the ex data of an SSL_CTX that points to its Context.
+int contextIndex() {
+    static int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+
+/// Returns an IOError for the error of OpenSSL. The error queue is cleared, so that it does not leak into the next
+/// operation on this thread.
+s::IOError* sslError() {
+    ERR_clear_error();
+    if (errno == 0) {
+        errno = EPROTO;
+    }
+    return s::IOError::init();
+}
+
+/// Stores the sessions, which TLS 1.3 servers send after the handshake, for resumption.
+int storeSession(SSL *ssl, SSL_SESSION *session) {
+    auto context = static_cast<Context *>(SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), contextIndex()));
+    auto host = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+    if (host == nullptr || !SSL_SESSION_is_resumable(session)) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(context->sessionsMutex_);
+    auto &stored = context->sessions_[host];
+    if (stored != nullptr) {
+        SSL_SESSION_free(stored);
+    }
+    stored = session;
+    return 1;
+}
+
+int selectProtocol(SSL *, const unsigned char **out, unsigned char *outLength, const unsigned char *in,
+                   unsigned int inLength, void *arg) {
+    auto context = static_cast<Context *>(arg);
+    if (SSL_select_next_proto(const_cast<unsigned char **>(out), outLength, context->protocols_.data(),
+                              context->protocols_.size(), in, inLength) != OPENSSL_NPN_NEGOTIATED) {
+        return SSL_TLSEXT_ERR_NOACK;
+    }
+    return SSL_TLSEXT_ERR_OK;
+}
+
+Context* newContext(const SSL_METHOD *method, runtime::Raiser *raiser) {
+    auto sslContext = SSL_CTX_new(method);
+    if (sslContext == nullptr) {
+        EJC_RAISE(raiser, sslError());
+    }
+    SSL_CTX_set_min_proto_version(sslContext, TLS1_2_VERSION);
+#ifdef SSL_OP_ENABLE_KTLS
+    // Lets the kernel encrypt and decrypt the records where it supports the cipher, so that SSL_sendfile() does not
+    // copy the file into user space.
+    SSL_CTX_set_options(sslContext, SSL_OP_ENABLE_KTLS);
+#endif
+    auto context = Context::init();
+    context->context_ = sslContext;
+    SSL_CTX_set_ex_data(sslContext, contextIndex(), context);
+    return context;
+}
+
+extern "C" Context* tlsContextNewClient(runtime::Raiser *raiser) {
+    auto context = newContext(TLS_client_method(), raiser);
+    if (context == nullptr) {
+        return nullptr;
+    }
+    SSL_CTX_set_verify(context->context_, SSL_VERIFY_PEER, nullptr);
+    SSL_CTX_set_default_verify_paths(context->context_);
+    SSL_CTX_set_session_cache_mode(context->context_, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(context->context_, storeSession);
+    return context;
+}
+
+extern "C" Context* tlsContextNewServer(String *certificate, String *key, runtime::Raiser *raiser) {
+    auto context = newContext(TLS_server_method(), raiser);
+    if (context == nullptr) {
+        return nullptr;
+    }
+    if (SSL_CTX_use_certificate_chain_file(context->context_, certificate->stdString().c_str()) != 1 ||
+        SSL_CTX_use_PrivateKey_file(context->context_, key->stdString().c_str(), SSL_FILETYPE_PEM) != 1 ||
+        SSL_CTX_check_private_key(context->context_) != 1) {
+        SSL_CTX_free(context->context_);
+        context->context_ = nullptr;
+        context->release();
+        EJC_RAISE(raiser, sslError());
+    }
+    // Resumption with session tickets, which the server does not need to store, and with the session IDs of clients
+    // that do not support tickets.
+    SSL_CTX_set_session_cache_mode(context->context_, SSL_SESS_CACHE_SERVER);
+    SSL_CTX_set_num_tickets(context->context_, 2);
+    SSL_CTX_set_alpn_select_cb(context->context_, selectProtocol, context);
+    return context;
+}
+
+extern "C" void tlsContextSetProtocols(Context *context, runtime::MemoryPointer<String *> protocols,
+                                       runtime::Integer count, runtime::Raiser *raiser) {
+    std::vector<unsigned char> wire;
+    for (runtime::Integer i = 0; i < count; i++) {
+        auto protocol = protocols.get()[i];
+        if (protocol->count > 0 && protocol->count < 256) {
+            wire.push_back(static_cast<unsigned char>(protocol->count));
+            wire.insert(wire.end(), protocol->bytes(), protocol->bytes() + protocol->count);
+        }
+        protocol->release();
+    }
+    context->protocols_ = std::move(wire);
+    // The client offers the protocols, the server selects one of them in selectProtocol().
+    if (SSL_CTX_set_alpn_protos(context->context_, context->protocols_.data(), context->protocols_.size()) != 0) {
+        errno = EINVAL;
+        EJC_RAISE_VOID(raiser, s::IOError::init());
+    }
+}
+
+extern "C" void tlsContextDestruct(Context *context) {
+    for (auto &pair : context->sessions_) {
+        SSL_SESSION_free(pair.second);
+    }
+    if (context->context_ != nullptr) {
+        SSL_CTX_free(context->context_);
+    }
+    context->~Context();
+}
+
+/// Completes the handshake of *ssl* on *socket* and returns a 🛡 for it. Frees *ssl* on error.
+TlsSocket* handshake(SSL *ssl, Socket *socket, Context *context, bool client, runtime::Raiser *raiser) {
+    // OpenSSL writes to the socket with write(), which cannot be told not to raise SIGPIPE.
+    std::signal(SIGPIPE, SIG_IGN);
+    SSL_set_fd(ssl, socket->socket_);
+    errno = 0;
+    auto result = client ? SSL_connect(ssl) : SSL_accept(ssl);
+    if (result != 1) {
+        SSL_free(ssl);
+        EJC_RAISE(raiser, sslError());
+    }
+    auto tlsSocket = TlsSocket::init();
+    tlsSocket->ssl_ = ssl;
+    socket->retain();
+    tlsSocket->socket_ = socket;
+    context->retain();
+    return tlsSocket;
+}
+
+extern "C" TlsSocket* tlsSocketConnect(Socket *socket, Context *context, String *host, runtime::Raiser *raiser) {
+    auto ssl = SSL_new(context->context_);
+    auto hostName = host->stdString();
+    SSL_set_tlsext_host_name(ssl, hostName.c_str());
+    SSL_set1_host(ssl, hostName.c_str());
+    {
+        std::lock_guard<std::mutex> lock(context->sessionsMutex_);
+        auto it = context->sessions_.find(hostName);
+        if (it != context->sessions_.end()) {
+            SSL_set_session(ssl, it->second);
+        }
+    }
+    return handshake(ssl, socket, context, true, raiser);
+}
+
+extern "C" TlsSocket* tlsSocketAccept(Socket *socket, Context *context, runtime::Raiser *raiser) {
+    return handshake(SSL_new(context->context_), socket, context, false, raiser);
+}
+
+extern "C" void tlsSocketSend(TlsSocket *socket, Data *data, runtime::Raiser *raiser) {
+    size_t written;
+    errno = 0;
+    if (data->count > 0 && SSL_write_ex(socket->ssl_, data->bytes(), data->count, &written) != 1) {
+        EJC_RAISE_VOID(raiser, sslError());
+    }
+}
+
+extern "C" void tlsSocketSendFile(TlsSocket *socket, String *path, runtime::Raiser *raiser) {
+    auto file = open(path->stdString().c_str(), O_RDONLY);
+    if (file == -1) {
+        EJC_RAISE_VOID(raiser, s::IOError::init());
+    }
+    struct stat status{};
+    fstat(file, &status);
+    off_t offset = 0;
+#ifdef SSL_OP_ENABLE_KTLS
+    if (BIO_get_ktls_send(SSL_get_wbio(socket->ssl_))) {
+        while (offset < status.st_size) {
+            auto sent = SSL_sendfile(socket->ssl_, file, offset, status.st_size - offset, 0);
+            if (sent <= 0) {
+                close(file);
+                EJC_RAISE_VOID(raiser, sslError());
+            }
+            offset += sent;
+        }
+        close(file);
+        return;
+    }
+#endif
+    std::vector<char> chunk(16384);
+    while (offset < status.st_size) {
+        auto read = pread(file, chunk.data(), chunk.size(), offset);
+        size_t written;
+        errno = 0;
+        if (read <= 0 || SSL_write_ex(socket->ssl_, chunk.data(), read, &written) != 1) {
+            close(file);
+            EJC_RAISE_VOID(raiser, sslError());
+        }
+        offset += read;
+    }
+    close(file);
+}
+
+extern "C" Data* tlsSocketRead(TlsSocket *socket, runtime::Integer count, runtime::Raiser *raiser) {
+    auto bytes = runtime::allocate<runtime::Byte>(count);
+    size_t read = 0;
+    errno = 0;
+    if (SSL_read_ex(socket->ssl_, bytes.get(), count, &read) != 1 &&
+        SSL_get_error(socket->ssl_, 0) != SSL_ERROR_ZERO_RETURN) {
+        EJC_RAISE(raiser, sslError());
+    }
+    auto data = Data::init();
+    data->count = read;
+    data->data = bytes;
+    return data;
+}
+
+extern "C" runtime::Integer tlsSocketReadInto(TlsSocket *socket, Buffer *buffer, runtime::Integer offset,
+                                              runtime::Raiser *raiser) {
+    if (offset < 0 || offset > buffer->capacity) {
+        ejcPanic("Offset out of bounds in 🛡👂🔸📬");
+    }
+    size_t read = 0;
+    errno = 0;
+    if (offset < buffer->capacity &&
+        SSL_read_ex(socket->ssl_, buffer->data.get() + offset, buffer->capacity - offset, &read) != 1 &&
+        SSL_get_error(socket->ssl_, 0) != SSL_ERROR_ZERO_RETURN) {
+        EJC_RAISE(raiser, sslError());
+    }
+    buffer->count = offset + read;
+    return read;
+}
+
+extern "C" s::Task* tlsSocketWhenReadable(TlsSocket *socket, runtime::Callable<void> callable) {
+    // Records that were already decrypted can be read without waiting for the socket.
+    if (SSL_pending(socket->ssl_) > 0) {
+        auto task = s::newTask(callable);
+        s::submitTask(task);
+        return task;
+    }
+    return socketsSocketWhenReadable(socket->socket_, callable);
+}
+
+extern "C" runtime::SimpleOptional<String*> tlsSocketProtocol(TlsSocket *socket) {
+    const unsigned char *protocol;
+    unsigned int length;
+    SSL_get0_alpn_selected(socket->ssl_, &protocol, &length);
+    if (length == 0) {
+        return runtime::NoValue;
+    }
+    return String::copy(reinterpret_cast<const char *>(protocol), length);
+}
+
+extern "C" runtime::Boolean tlsSocketResumed(TlsSocket *socket) {
+    return SSL_session_reused(socket->ssl_);
+}
+
+extern "C" runtime::Boolean tlsSocketKernelOffload(TlsSocket *socket) {
+#ifdef SSL_OP_ENABLE_KTLS
+    return BIO_get_ktls_send(SSL_get_wbio(socket->ssl_)) && BIO_get_ktls_recv(SSL_get_rbio(socket->ssl_));
+#else
+    return false;
+#endif
+}
+
+extern "C" void tlsSocketClose(TlsSocket *socket) {
+    if (socket->socket_->socket_ != -1) {
+        SSL_shutdown(socket->ssl_);
+        ERR_clear_error();
+        socketsSocketClose(socket->socket_);
+    }
+}
+
+extern "C" void tlsSocketDestruct(TlsSocket *socket) {
+    auto context = static_cast<Context *>(SSL_CTX_get_ex_data(SSL_get_SSL_CTX(socket->ssl_), contextIndex()));
+    SSL_free(socket->ssl_);
+    socket->socket_->release();
+    context->release();
+    socket->~TlsSocket();
+}
+
+}  // namespace tls
+
+SET_INFO_FOR(tls::Context, tls, 1f3f0)
+SET_INFO_FOR(tls::TlsSocket, tls, 1f6e1)
@@ -0,0 +1,55 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "../runtime/Demangler.hpp"
+#include <cctype>
+#include <iostream>
+#include <string>
+
+namespace {
+
+bool isSymbolCharacter(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.' || c == '$' || c == '-';
+}
+
+/// Demangles the symbol, which may be prefixed with an underscore as on Darwin. (Symbols beginning with _. belong to
+/// the package _.)
+std::string demangleSymbol(const std::string &symbol) {
+    if (symbol.size() > 2 && symbol[0] == '_' && symbol[1] != '.') {
+        auto unprefixed = symbol.substr(1);
+        auto demangled = runtime::demangle(unprefixed);
+        if (demangled != unprefixed) return demangled;
+    }
+    return runtime::demangle(symbol);
+}
+
+}  // namespace
+
+/// Demangles the symbols given as arguments or, like c++filt, all symbols in the text read from the standard input,
+/// e.g. the output of nm or perf script.
+int main(int argc, char *argv[]) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            std::cout << demangleSymbol(argv[i]) << "\n";
+        }
+        return 0;
+    }
+
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        std::string output;
+        size_t i = 0;
+        while (i < line.size()) {
+            if (!isSymbolCharacter(line[i])) {
+                output.push_back(line[i++]);
+                continue;
+            }
+            auto start = i;
+            while (i < line.size() && isSymbolCharacter(line[i])) i++;
+            output.append(demangleSymbol(line.substr(start, i - start)));
+        }
+        std::cout << output << "\n";
+    }
+    return 0;
+}
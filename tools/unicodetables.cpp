@@ -0,0 +1,117 @@
+//
+// Created by Theo Weidmann on 15.10.26.
+//
+
+#include "../s/utf8proc.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+constexpr int32_t kCodepoints = 0x110000;
+constexpr int kBlockShift = 7;
+constexpr int32_t kBlockSize = 1 << kBlockShift;
+
+// Must match the flags in s/Unicode.h.
+constexpr int kNfcMaybe = 1;
+constexpr int kNfcNo = 2;
+constexpr int kWhitespace = 4;
+
+using Properties = std::tuple<int, int, int, int32_t, int32_t>;
+
+std::vector<int32_t> decode(const utf8proc_uint8_t *string) {
+    std::vector<int32_t> codepoints;
+    utf8proc_int32_t codepoint;
+    for (utf8proc_ssize_t length; *string && (length = utf8proc_iterate(string, -1, &codepoint)) > 0;
+         string += length) {
+        codepoints.push_back(codepoint);
+    }
+    return codepoints;
+}
+
+/// Derives the NFC_Quick_Check property: A code point is No if NFC changes it on its own and Maybe if it is the last
+/// code point of the canonical decomposition of a character that NFC composes, as it may then combine with the code
+/// points before it.
+std::vector<int> nfcQuickCheck() {
+    std::vector<int> flags(kCodepoints, 0);
+    for (int32_t codepoint = 0; codepoint < kCodepoints; codepoint++) {
+        if (codepoint >= 0xD800 && codepoint < 0xE000) continue;
+        utf8proc_uint8_t encoded[5] = {};
+        utf8proc_encode_char(codepoint, encoded);
+        auto nfc = utf8proc_NFC(encoded);
+        auto nfd = utf8proc_NFD(encoded);
+        if (std::strcmp(reinterpret_cast<char *>(nfc), reinterpret_cast<char *>(encoded)) != 0) {
+            flags[codepoint] |= kNfcNo;
+        }
+        else {
+            auto decomposition = decode(nfd);
+            if (decomposition.size() > 1) {
+                flags[decomposition.back()] |= kNfcMaybe;
+            }
+        }
+        std::free(nfc);
+        std::free(nfd);
+    }
+    return flags;
+}
+
+}  // namespace
+
+/// Writes s/UnicodeTables.h, the two-stage tables of the code point properties used by s, to the standard output.
+/// The properties are taken from utf8proc, which must be regenerated first when moving to a new Unicode version.
+int main() {
+    auto quickCheck = nfcQuickCheck();
+    std::vector<Properties> records;
+    std::map<Properties, uint16_t> recordIndices;
+    std::vector<std::vector<uint16_t>> blocks;
+    std::map<std::vector<uint16_t>, size_t> blockIndices;
+    std::vector<size_t> stage1;
+
+    for (int32_t start = 0; start < kCodepoints; start += kBlockSize) {
+        std::vector<uint16_t> block;
+        for (auto codepoint = start; codepoint < start + kBlockSize; codepoint++) {
+            auto property = utf8proc_get_property(codepoint);
+            auto flags = quickCheck[codepoint];
+            if (property->bidi_class == UTF8PROC_BIDI_CLASS_WS) flags |= kWhitespace;
+            Properties properties{ property->boundclass, property->combining_class, flags,
+                                   utf8proc_tolower(codepoint) - codepoint, utf8proc_toupper(codepoint) - codepoint };
+            auto record = recordIndices.emplace(properties, records.size());
+            if (record.second) records.push_back(properties);
+            block.push_back(record.first->second);
+        }
+        auto index = blockIndices.emplace(block, blocks.size());
+        if (index.second) blocks.push_back(block);
+        stage1.push_back(index.first->second);
+    }
+
+    std::printf("//\n// Generated by tools/unicodetables.cpp from the tables of utf8proc. Do not edit.\n//\n\n");
+    std::printf("#ifndef EMOJICODE_UNICODETABLES_H\n#define EMOJICODE_UNICODETABLES_H\n\n");
+    std::printf("#include \"Unicode.h\"\n\nnamespace s {\nnamespace unicode {\n\n");
+    std::printf("constexpr int kBlockShift = %d;\n\n", kBlockShift);
+
+    std::printf("constexpr CodepointProperties kProperties[] = {\n");
+    for (auto &record : records) {
+        std::printf("    { %d, %d, %d, %d, %d },\n", std::get<0>(record), std::get<1>(record), std::get<2>(record),
+                    std::get<3>(record), std::get<4>(record));
+    }
+    std::printf("};\n\n");
+
+    std::printf("constexpr %s kStage1[] = {", blocks.size() <= 0x100 ? "uint8_t" : "uint16_t");
+    for (size_t i = 0; i < stage1.size(); i++) {
+        std::printf(i % 16 == 0 ? "\n    %zu," : " %zu,", stage1[i]);
+    }
+    std::printf("\n};\n\n");
+
+    std::printf("constexpr %s kStage2[] = {", records.size() <= 0x100 ? "uint8_t" : "uint16_t");
+    for (auto &block : blocks) {
+        for (size_t i = 0; i < block.size(); i++) {
+            std::printf(i % 16 == 0 ? "\n    %u," : " %u,", static_cast<unsigned>(block[i]));
+        }
+    }
+    std::printf("\n};\n\n}  // namespace unicode\n}  // namespace s\n\n#endif //EMOJICODE_UNICODETABLES_H\n");
+    return 0;
+}